@@ -138,12 +138,23 @@ target_link_libraries (
  libyasm dl
 )
 
-set(CMAKE_ASM_NASM_COMPILER "${SLIB_BIN_PATH}/yasm")
-if (NOT EXISTS "${SLIB_BIN_PATH}/yasm")
+# use the installed assembler when there is one. Otherwise the bundled yasm is built before
+# the assembly sources (see vpx.cmake), but enable_language() needs an existing compiler at
+# configure time, so it is invoked through a launcher kept in the build directory
+find_program (SLIB_YASM_COMMAND NAMES yasm nasm)
+if (SLIB_YASM_COMMAND)
+ set (CMAKE_ASM_NASM_COMPILER "${SLIB_YASM_COMMAND}")
+else ()
  file (
-  WRITE "${SLIB_BIN_PATH}/yasm"
-  "# DummyFile to bypass CMake error"
+  WRITE "${CMAKE_BINARY_DIR}/yasm-launcher/yasm"
+  "#!/bin/sh\nexec \"${SLIB_BIN_PATH}/yasm\" \"$@\"\n"
  )
+ file (
+  COPY "${CMAKE_BINARY_DIR}/yasm-launcher/yasm"
+  DESTINATION "${CMAKE_BINARY_DIR}/yasm-bin"
+  FILE_PERMISSIONS OWNER_READ OWNER_WRITE OWNER_EXECUTE GROUP_READ GROUP_EXECUTE WORLD_READ WORLD_EXECUTE
+ )
+ set (CMAKE_ASM_NASM_COMPILER "${CMAKE_BINARY_DIR}/yasm-bin/yasm")
 endif ()
 enable_language(ASM_NASM)
 set (
@@ -0,0 +1,243 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/*
+	Read-mostly contention benchmark of `AtomicRef`, `BorrowedRef`, `AtomicList` and `AtomicString`.
+	N reader threads load the shared value in a loop while one writer replaces it every millisecond.
+	A spin-locked reference (the previous implementation of `AtomicRef`) is measured for comparison.
+
+	Usage: BenchmarkAtomicRef [readers (default: processors count)] [milliseconds per case (default: 2000)]
+
+	Also checks that a thread replacing the object it is borrowing, and a writer racing a
+	blocked borrower, do not wait. Exits with 1 when any check fails.
+*/
+
+#include <slib/core.h>
+
+using namespace slib;
+
+namespace {
+
+	sl_int32 g_countAlive = 0;
+
+	class Item : public Referable
+	{
+	public:
+		sl_int32 value;
+
+	public:
+		Item(sl_int32 _value): value(_value)
+		{
+			Base::interlockedIncrement32(&g_countAlive);
+		}
+
+		~Item()
+		{
+			Base::interlockedDecrement32(&g_countAlive);
+		}
+
+	};
+
+	class SpinLockedRef
+	{
+	public:
+		Ref<Item> get()
+		{
+			SpinLocker lock(&m_lock);
+			return m_ref;
+		}
+
+		void set(const Ref<Item>& ref)
+		{
+			Ref<Item> before;
+			{
+				SpinLocker lock(&m_lock);
+				before = m_ref;
+				m_ref = ref;
+			}
+		}
+
+	private:
+		Ref<Item> m_ref;
+		SpinLock m_lock;
+
+	};
+
+	enum class Mode
+	{
+		SpinLock,
+		AtomicRef,
+		BorrowedRef,
+		AtomicList,
+		AtomicString
+	};
+
+	struct ReaderCounter
+	{
+		sl_uint64 count;
+		sl_uint8 padding[64 - sizeof(sl_uint64)];
+	};
+
+	void Measure(Mode mode, const char* name, sl_uint32 nReaders, sl_uint32 duration)
+	{
+		SpinLockedRef refLocked;
+		AtomicRef<Item> ref = new Item(0);
+		AtomicList<sl_int32> list = List<sl_int32>::create(16);
+		AtomicString str = String("value");
+		refLocked.set(new Item(0));
+
+		Array<ReaderCounter> counters = Array<ReaderCounter>::create(nReaders);
+		List< Ref<Thread> > threads;
+		for (sl_uint32 i = 0; i < nReaders; i++) {
+			ReaderCounter* counter = counters.getPointerAt(i);
+			counter->count = 0;
+			threads.add_NoLock(Thread::start([mode, counter, &refLocked, &ref, &list, &str]() {
+				sl_uint64 n = 0;
+				sl_int32 sum = 0;
+				while (!(Thread::isStoppingCurrent())) {
+					for (sl_uint32 k = 0; k < 1000; k++) {
+						switch (mode) {
+							case Mode::SpinLock:
+								sum += refLocked.get()->value;
+								break;
+							case Mode::AtomicRef:
+								sum += Ref<Item>(ref)->value;
+								break;
+							case Mode::BorrowedRef:
+								{
+									BorrowedRef<Item> item(ref);
+									sum += item->value;
+								}
+								break;
+							case Mode::AtomicList:
+								sum += list.getValueAt(k & 15);
+								break;
+							case Mode::AtomicString:
+								sum += (sl_int32)(String(str).getLength());
+								break;
+						}
+					}
+					n += 1000;
+				}
+				counter->count = n + (sum == 0x7fffffff);
+			}));
+		}
+		Ref<Thread> writer = Thread::start([mode, &refLocked, &ref, &list, &str]() {
+			sl_int32 n = 0;
+			while (!(Thread::isStoppingCurrent())) {
+				n++;
+				switch (mode) {
+					case Mode::SpinLock:
+						refLocked.set(new Item(n));
+						break;
+					case Mode::AtomicRef:
+					case Mode::BorrowedRef:
+						ref = new Item(n);
+						break;
+					case Mode::AtomicList:
+						list = List<sl_int32>::create(16);
+						break;
+					case Mode::AtomicString:
+						str = String::fromInt32(n);
+						break;
+				}
+				Thread::sleep(1);
+			}
+		});
+
+		Time t = Time::now();
+		Thread::sleep(duration);
+		for (auto& thread : threads) {
+			thread->finish();
+		}
+		writer->finish();
+		for (auto& thread : threads) {
+			thread->finishAndWait();
+		}
+		writer->finishAndWait();
+		double elapsed = (Time::now() - t).getSecondsCountf();
+
+		sl_uint64 total = 0;
+		for (sl_uint32 i = 0; i < nReaders; i++) {
+			total += counters[i].count;
+		}
+		Println("%s: %d readers + 1 writer (1/ms): %s M reads/s", name, nReaders, String::fromDouble((double)total / elapsed / 1000000.0, 1));
+	}
+
+	sl_bool CheckNoWait()
+	{
+		sl_bool flagSuccess = sl_true;
+		{
+			Item* item = new Item(1);
+			AtomicRef<Item> a = item;
+			AtomicRef<Item> b = item;
+			{
+				BorrowedRef<Item> borrowed(a);
+				// replaces the borrowed object in the same thread
+				b = new Item(2);
+				a = new Item(3);
+				if (borrowed->value != 1) {
+					flagSuccess = sl_false;
+				}
+			}
+		}
+		{
+			AtomicRef<Item> a = new Item(4);
+			Mutex mutex;
+			mutex.lock();
+			volatile sl_bool flagBorrowed = sl_false;
+			Ref<Thread> thread = Thread::start([&a, &mutex, &flagBorrowed]() {
+				BorrowedRef<Item> borrowed(a);
+				flagBorrowed = sl_true;
+				// waits for the writer
+				MutexLocker lock(&mutex);
+			});
+			while (!flagBorrowed) {
+				Thread::sleep(1);
+			}
+			a = new Item(5);
+			mutex.unlock();
+			thread->finishAndWait();
+			a.setNull();
+		}
+		if (g_countAlive) {
+			Println("%d objects are not released", g_countAlive);
+			flagSuccess = sl_false;
+		}
+		return flagSuccess;
+	}
+
+}
+
+int main(int argc, const char * argv[])
+{
+	sl_uint32 nReaders = System::getProcessorsCount();
+	sl_uint32 duration = 2000;
+	if (argc > 1) {
+		nReaders = String(argv[1]).parseUint32(10, nReaders);
+	}
+	if (argc > 2) {
+		duration = String(argv[2]).parseUint32(10, duration);
+	}
+	if (!nReaders) {
+		nReaders = 1;
+	}
+
+	sl_bool flagSuccess = CheckNoWait();
+	Println("Writers without waiting: %s", flagSuccess ? "OK" : "FAILED");
+
+	Measure(Mode::SpinLock, "SpinLock + Ref", nReaders, duration);
+	Measure(Mode::AtomicRef, "AtomicRef -> Ref", nReaders, duration);
+	Measure(Mode::BorrowedRef, "BorrowedRef", nReaders, duration);
+	Measure(Mode::AtomicList, "AtomicList::getValueAt", nReaders, duration);
+	Measure(Mode::AtomicString, "AtomicString -> String", nReaders, duration);
+
+	return flagSuccess ? 0 : 1;
+}
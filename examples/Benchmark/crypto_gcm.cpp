@@ -0,0 +1,239 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/*
+	Known-answer tests for AES-GCM on the AES-NI/PCLMULQDQ path and on the
+	portable path, a randomized cross-check between both paths, and the MB/s
+	of AES-CTR and AES-GCM on each path.
+
+	Exits with 1 when any check fails.
+*/
+
+#include <slib/core.h>
+#include <slib/crypto/aes.h>
+
+using namespace slib;
+
+namespace {
+
+	struct GcmVector
+	{
+		const char* key;
+		const char* iv;
+		const char* aad;
+		const char* plain;
+		const char* cipher;
+		const char* tag;
+	};
+
+	// NIST GCM specification, test cases 2, 3, 4, 6 and 16
+	const GcmVector g_vectors[] = {
+		{
+			"00000000000000000000000000000000",
+			"000000000000000000000000",
+			"",
+			"00000000000000000000000000000000",
+			"0388dace60b6a392f328c2b971b2fe78",
+			"ab6e47d42cec13bdf53a67b21257bddf"
+		},
+		{
+			"feffe9928665731c6d6a8f9467308308",
+			"cafebabefacedbaddecaf888",
+			"",
+			"d9313225f88406e5a55909c5aff5269a86a7a9531534f7da2e4c303d8a318a721c3c0c95956809532fcf0e2449a6b525b16aedf5aa0de657ba637b391aafd255",
+			"42831ec2217774244b7221b784d0d49ce3aa212f2c02a4e035c17e2329aca12e21d514b25466931c7d8f6a5aac84aa051ba30b396a0aac973d58e091473f5985",
+			"4d5c2af327cd64a62cf35abd2ba6fab4"
+		},
+		{
+			"feffe9928665731c6d6a8f9467308308",
+			"cafebabefacedbaddecaf888",
+			"feedfacedeadbeeffeedfacedeadbeefabaddad2",
+			"d9313225f88406e5a55909c5aff5269a86a7a9531534f7da2e4c303d8a318a721c3c0c95956809532fcf0e2449a6b525b16aedf5aa0de657ba637b39",
+			"42831ec2217774244b7221b784d0d49ce3aa212f2c02a4e035c17e2329aca12e21d514b25466931c7d8f6a5aac84aa051ba30b396a0aac973d58e091",
+			"5bc94fbc3221a5db94fae95ae7121a47"
+		},
+		{
+			"feffe9928665731c6d6a8f9467308308",
+			"9313225df88406e555909c5aff5269aa6a7a9538534f7da1e4c303d2a318a728c3c0c95156809539fcf0e2429a6b525416aedbf5a0de6a57a637b39b",
+			"feedfacedeadbeeffeedfacedeadbeefabaddad2",
+			"d9313225f88406e5a55909c5aff5269a86a7a9531534f7da2e4c303d8a318a721c3c0c95956809532fcf0e2449a6b525b16aedf5aa0de657ba637b39",
+			"8ce24998625615b603a033aca13fb894be9112a5c3a211a8ba262a3cca7e2ca701e4a9a4fba43c90ccdcb281d48c7c6fd62875d2aca417034c34aee5",
+			"619cc5aefffe0bfa462af43c1699d050"
+		},
+		{
+			"feffe9928665731c6d6a8f9467308308feffe9928665731c6d6a8f9467308308",
+			"cafebabefacedbaddecaf888",
+			"feedfacedeadbeeffeedfacedeadbeefabaddad2",
+			"d9313225f88406e5a55909c5aff5269a86a7a9531534f7da2e4c303d8a318a721c3c0c95956809532fcf0e2449a6b525b16aedf5aa0de657ba637b39",
+			"522dc1f099567d07f47f37a32a84427d643a8cdcbfe5c0c97598a2bd2555d1aa8cb08e48590dbb3da7b08b1056828838c5f61e6393ba7a0abcc9f662",
+			"76fc6ece0f4e1768cddf8853bb2d551b"
+		}
+	};
+
+	Memory ParseHex(const char* str)
+	{
+		String s(str);
+		Memory mem = Memory::create(s.getLength() / 2 + 1);
+		if (mem.isNotNull()) {
+			s.parseHexString(mem.getData());
+		}
+		return mem;
+	}
+
+	sl_bool CheckVector(const GcmVector& v, sl_bool flagHardware)
+	{
+		Memory key = ParseHex(v.key);
+		Memory iv = ParseHex(v.iv);
+		Memory aad = ParseHex(v.aad);
+		Memory plain = ParseHex(v.plain);
+		Memory cipher = ParseHex(v.cipher);
+		Memory tag = ParseHex(v.tag);
+		sl_size lenKey = Base::getStringLength(v.key) / 2;
+		sl_size lenIV = Base::getStringLength(v.iv) / 2;
+		sl_size lenA = Base::getStringLength(v.aad) / 2;
+		sl_size len = Base::getStringLength(v.plain) / 2;
+
+		AES_GCM gcm;
+		gcm.setKey(key.getData(), (sl_uint32)lenKey);
+		gcm.setHardwareEnabled(flagHardware);
+
+		Memory output = Memory::create(len + 1);
+		sl_uint8 outTag[16];
+		if (!(gcm.encrypt(iv.getData(), lenIV, aad.getData(), lenA, plain.getData(), output.getData(), len, outTag))) {
+			return sl_false;
+		}
+		if (!(Base::equalsMemory(output.getData(), cipher.getData(), len)) || !(Base::equalsMemory(outTag, tag.getData(), 16))) {
+			return sl_false;
+		}
+		if (!(gcm.decrypt(iv.getData(), lenIV, aad.getData(), lenA, cipher.getData(), output.getData(), len, tag.getData()))) {
+			return sl_false;
+		}
+		if (!(Base::equalsMemory(output.getData(), plain.getData(), len))) {
+			return sl_false;
+		}
+		// a corrupted tag must be rejected
+		outTag[0] ^= 1;
+		return !(gcm.decrypt(iv.getData(), lenIV, aad.getData(), lenA, cipher.getData(), output.getData(), len, outTag));
+	}
+
+	void FillRandom(void* buf, sl_size size, sl_uint32& seed)
+	{
+		sl_uint8* p = (sl_uint8*)buf;
+		for (sl_size i = 0; i < size; i++) {
+			seed = seed * 1103515245 + 12345;
+			p[i] = (sl_uint8)(seed >> 16);
+		}
+	}
+
+	sl_bool CrossCheck(sl_uint32 nIterations)
+	{
+		sl_uint32 seed = 1;
+		sl_uint8 key[32], iv[64], aad[128];
+		Memory input = Memory::create(8192);
+		Memory output1 = Memory::create(8192);
+		Memory output2 = Memory::create(8192);
+		for (sl_uint32 i = 0; i < nIterations; i++) {
+			sl_uint32 lenKey = 16 + 8 * (i % 3);
+			sl_uint32 lenIV = (i % 4) ? 12 : (1 + i % 64);
+			sl_uint32 lenA = i % 128;
+			sl_uint32 len = (i * 37) % 8192;
+			FillRandom(key, lenKey, seed);
+			FillRandom(iv, lenIV, seed);
+			FillRandom(aad, lenA, seed);
+			FillRandom(input.getData(), len, seed);
+
+			AES_GCM gcm1, gcm2;
+			gcm1.setKey(key, lenKey);
+			gcm2.setKey(key, lenKey);
+			gcm2.setHardwareEnabled(sl_false);
+			sl_uint8 tag1[16], tag2[16];
+			gcm1.encrypt(iv, lenIV, aad, lenA, input.getData(), output1.getData(), len, tag1);
+			gcm2.encrypt(iv, lenIV, aad, lenA, input.getData(), output2.getData(), len, tag2);
+			if (!(Base::equalsMemory(output1.getData(), output2.getData(), len)) || !(Base::equalsMemory(tag1, tag2, 16))) {
+				Println("GCM mismatch: iteration=%d, key=%d, iv=%d, aad=%d, len=%d", i, lenKey, lenIV, lenA, len);
+				return sl_false;
+			}
+
+			// CTR with a counter close to the 32-bit wrap, starting in the middle of a block
+			AES aes1, aes2;
+			aes1.setKey(key, lenKey);
+			aes2.setKey(key, lenKey);
+			aes2.setHardwareEnabled(sl_false);
+			sl_uint8 counter1[16], counter2[16];
+			FillRandom(counter1, 12, seed);
+			Base::resetMemory(counter1 + 12, 0xff, 4);
+			Base::copyMemory(counter2, counter1, 16);
+			sl_uint32 offset = i % 16;
+			aes1.encrypt_CTR(input.getData(), len, output1.getData(), counter1, offset);
+			aes2.encrypt_CTR(input.getData(), len, output2.getData(), counter2, offset);
+			if (!(Base::equalsMemory(output1.getData(), output2.getData(), len)) || !(Base::equalsMemory(counter1, counter2, 16))) {
+				Println("CTR mismatch: iteration=%d, key=%d, len=%d, offset=%d", i, lenKey, len, offset);
+				return sl_false;
+			}
+		}
+		return sl_true;
+	}
+
+	void Measure(sl_bool flagHardware, sl_size size)
+	{
+		sl_uint8 key[16] = {0};
+		sl_uint8 iv[12] = {0};
+		Memory mem = Memory::create(size);
+		Base::zeroMemory(mem.getData(), size);
+
+		AES aes;
+		aes.setKey(key, 16);
+		aes.setHardwareEnabled(flagHardware);
+		sl_uint8 counter[16] = {0};
+		Time t = Time::now();
+		aes.encrypt_CTR(mem.getData(), size, mem.getData(), counter);
+		double dtCTR = (Time::now() - t).getMillisecondsCountf();
+
+		AES_GCM gcm;
+		gcm.setKey(key, 16);
+		gcm.setHardwareEnabled(flagHardware);
+		sl_uint8 tag[16];
+		t = Time::now();
+		gcm.encrypt(iv, 12, sl_null, 0, mem.getData(), mem.getData(), size, tag);
+		double dtGCM = (Time::now() - t).getMillisecondsCountf();
+
+		double mb = (double)size / 1000000.0;
+		Println("%s: AES-128-CTR %d MB/s, AES-128-GCM %d MB/s", flagHardware ? "AES-NI/PCLMULQDQ" : "Portable", (sl_int32)(mb * 1000.0 / dtCTR), (sl_int32)(mb * 1000.0 / dtGCM));
+	}
+
+}
+
+int main(int argc, const char * argv[])
+{
+	Println("AES-NI: %s, PCLMULQDQ: %s", AES::isHardwareSupported() ? "yes" : "no", GCM_Table::isHardwareSupported() ? "yes" : "no");
+
+	sl_bool flagSuccess = sl_true;
+	for (sl_size i = 0; i < sizeof(g_vectors) / sizeof(g_vectors[0]); i++) {
+		for (int hw = 0; hw < 2; hw++) {
+			if (!(CheckVector(g_vectors[i], hw != 0))) {
+				Println("Known-answer test %d failed on the %s path", (sl_int32)i, hw ? "hardware" : "portable");
+				flagSuccess = sl_false;
+			}
+		}
+	}
+	if (!(CrossCheck(2000))) {
+		flagSuccess = sl_false;
+	}
+	Println("Correctness: %s", flagSuccess ? "OK" : "FAILED");
+
+	sl_size size = 64 << 20;
+	if (argc > 1) {
+		size = (sl_size)(String(argv[1]).parseUint64() << 20);
+	}
+	Measure(sl_true, size);
+	Measure(sl_false, size);
+
+	return flagSuccess ? 0 : 1;
+}
@@ -0,0 +1,254 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/*
+	Point lookups and range scans of `FileBTree<sl_int64, sl_int64>` with 4KB pages over a large file
+	(100M entries by default, about 4.6GB), reopened before measuring so that the page cache starts cold.
+
+	Also checks `FileBTree` against the in-memory `BTree` through random puts and removes with small
+	pages, the contents after reopening, and the recovery from a torn write-ahead log.
+	Exits with 1 when any check fails.
+
+	Usage: BenchmarkFileBTree [entries (default: 100000000)] [lookups (default: 1000000)] [file (default: temp directory)]
+*/
+
+#include <slib/core.h>
+
+using namespace slib;
+
+namespace {
+
+	void DeleteTreeFile(const String& path)
+	{
+		File::deleteFile(path);
+		File::deleteFile(path + ".wal");
+	}
+
+	sl_bool CompareTrees(FileBTree<sl_int64, sl_int64>& tree, BTree<sl_int64, sl_int64>& reference)
+	{
+		if (tree.getCount() != reference.getCount()) {
+			Println("count: %d != %d", (sl_uint32)(tree.getCount()), (sl_uint32)(reference.getCount()));
+			return sl_false;
+		}
+		BTreePosition pos, posReference;
+		sl_int64 key, value, keyReference, valueReference;
+		sl_bool flagNext = tree.moveToFirst(pos, &key, &value);
+		sl_bool flagNextReference = reference.moveToFirst(posReference, &keyReference, &valueReference);
+		while (flagNext && flagNextReference) {
+			if (key != keyReference || value != valueReference) {
+				Println("scan: different item");
+				return sl_false;
+			}
+			flagNext = tree.moveToNext(pos, &key, &value);
+			flagNextReference = reference.moveToNext(posReference, &keyReference, &valueReference);
+		}
+		if (flagNext != flagNextReference) {
+			Println("scan: different count");
+			return sl_false;
+		}
+		return sl_true;
+	}
+
+	sl_bool CheckTree(const String& path)
+	{
+		DeleteTreeFile(path);
+		BTree<sl_int64, sl_int64> reference;
+		{
+			// small pages and cache, so that the tree gets deep and the pages are evicted
+			FileBTree<sl_int64, sl_int64> tree(512);
+			if (!(tree.open(path, 32))) {
+				Println("failed to open %s", path);
+				return sl_false;
+			}
+			sl_uint32 seed = 1;
+			for (sl_uint32 i = 0; i < 200000; i++) {
+				seed = seed * 1103515245 + 12345;
+				sl_int64 key = (seed >> 8) % 50000;
+				if ((seed >> 4) % 3) {
+					tree.put(key, key * 7 + i);
+					reference.put(key, key * 7 + i);
+				} else {
+					if (tree.remove(key) != reference.remove(key)) {
+						Println("remove: different result at %d", i);
+						return sl_false;
+					}
+				}
+				if (i % 20000 == 0) {
+					tree.flush();
+				}
+			}
+			if (!(CompareTrees(tree, reference))) {
+				return sl_false;
+			}
+		}
+		{
+			FileBTree<sl_int64, sl_int64> tree(512);
+			if (!(tree.open(path, 32)) || !(CompareTrees(tree, reference))) {
+				Println("reopen: different contents");
+				return sl_false;
+			}
+			tree.put(123456789, 1);
+			reference.put(123456789, 1);
+		}
+		{
+			// a torn log must be discarded
+			Ref<File> file = File::openForWrite(path + ".wal");
+			if (file.isNotNull()) {
+				file->write("garbage", 7);
+			}
+		}
+		{
+			FileBTree<sl_int64, sl_int64> tree(512);
+			if (!(tree.open(path, 32)) || !(CompareTrees(tree, reference))) {
+				Println("torn log: different contents");
+				return sl_false;
+			}
+		}
+		DeleteTreeFile(path);
+		return sl_true;
+	}
+
+	sl_bool Measure(const String& path, sl_uint64 n, sl_uint32 nLookups)
+	{
+		DeleteTreeFile(path);
+		// keys: 0, 2, 4, ... (odd keys are missing)
+		{
+			FileBTree<sl_int64, sl_int64> tree;
+			if (!(tree.open(path))) {
+				Println("failed to open %s", path);
+				return sl_false;
+			}
+			Time t = Time::now();
+			for (sl_uint64 i = 0; i < n; i++) {
+				if (!(tree.put((sl_int64)(i * 2), (sl_int64)i))) {
+					Println("failed to insert %d", (sl_uint32)i);
+					return sl_false;
+				}
+			}
+			tree.flush();
+			double dt = (Time::now() - t).getSecondsCountf();
+			Println("Build: %s M entries in %s s (%s MB)", String::fromDouble((double)n / 1000000.0, 1), String::fromDouble(dt, 1), String::fromUint64(File::getSize(path) >> 20));
+		}
+
+		FileBTree<sl_int64, sl_int64> tree;
+		if (!(tree.open(path)) || tree.getCount() != n) {
+			Println("reopen: wrong count");
+			return sl_false;
+		}
+		sl_bool flagSuccess = sl_true;
+		sl_uint64 seed = 1;
+		sl_int64 value;
+
+		Time t = Time::now();
+		for (sl_uint32 i = 0; i < nLookups; i++) {
+			seed = seed * SLIB_UINT64(6364136223846793005) + SLIB_UINT64(1442695040888963407);
+			sl_uint64 k = (seed >> 16) % n;
+			if (!(tree.get((sl_int64)(k * 2), &value)) || value != (sl_int64)k) {
+				flagSuccess = sl_false;
+			}
+		}
+		double dtHit = (Time::now() - t).getMicrosecondsCountf() / nLookups;
+
+		t = Time::now();
+		for (sl_uint32 i = 0; i < nLookups; i++) {
+			seed = seed * SLIB_UINT64(6364136223846793005) + SLIB_UINT64(1442695040888963407);
+			sl_uint64 k = (seed >> 16) % n;
+			if (tree.get((sl_int64)(k * 2 + 1), &value)) {
+				flagSuccess = sl_false;
+			}
+		}
+		double dtMiss = (Time::now() - t).getMicrosecondsCountf() / nLookups;
+
+		// ranges of 100 entries from random keys
+		sl_uint32 nRanges = nLookups / 100 + 1;
+		t = Time::now();
+		for (sl_uint32 i = 0; i < nRanges; i++) {
+			seed = seed * SLIB_UINT64(6364136223846793005) + SLIB_UINT64(1442695040888963407);
+			sl_int64 start = (sl_int64)((seed >> 16) % n) * 2 - 1;
+			BTreePosition pos;
+			sl_int64 key;
+			tree.getNearest(start, sl_null, &pos);
+			sl_int64 expected = start + 1;
+			if (pos.isNotNull() && tree.getAt(pos, &key, &value)) {
+				sl_uint32 m = 0;
+				do {
+					if (key != expected) {
+						flagSuccess = sl_false;
+						break;
+					}
+					expected += 2;
+					m++;
+				} while (m < 100 && tree.moveToNext(pos, &key, &value));
+			} else {
+				flagSuccess = sl_false;
+			}
+		}
+		double dtRange = (Time::now() - t).getMicrosecondsCountf() / nRanges;
+
+		t = Time::now();
+		sl_uint64 nScanned = 0;
+		{
+			BTreePosition pos;
+			sl_int64 key;
+			if (tree.moveToFirst(pos, &key, &value)) {
+				do {
+					if (key != (sl_int64)(nScanned * 2)) {
+						flagSuccess = sl_false;
+					}
+					nScanned++;
+				} while (tree.moveToNext(pos, &key, &value));
+			}
+		}
+		double dtScan = (Time::now() - t).getSecondsCountf();
+		if (nScanned != n) {
+			flagSuccess = sl_false;
+		}
+
+		Println("Point lookups: hit %s us, miss %s us", String::fromDouble(dtHit, 2), String::fromDouble(dtMiss, 2));
+		Println("Range of 100 entries: %s us", String::fromDouble(dtRange, 1));
+		Println("Full scan: %s M entries/s", String::fromDouble((double)nScanned / dtScan / 1000000.0, 2));
+
+		tree.close();
+		DeleteTreeFile(path);
+		return flagSuccess;
+	}
+
+}
+
+int main(int argc, const char * argv[])
+{
+	sl_uint64 n = 100000000;
+	sl_uint32 nLookups = 1000000;
+	String path = System::getTempDirectory() + "/benchmark_file_btree.db";
+	if (argc > 1) {
+		n = String(argv[1]).parseUint64(10, n);
+	}
+	if (argc > 2) {
+		nLookups = String(argv[2]).parseUint32(10, nLookups);
+	}
+	if (argc > 3) {
+		path = argv[3];
+	}
+	if (!n) {
+		n = 1;
+	}
+	if (!nLookups) {
+		nLookups = 1;
+	}
+
+	sl_bool flagSuccess = CheckTree(path);
+	if (!(Measure(path, n, nLookups))) {
+		Println("Wrong result in the measured lookups or scans");
+		flagSuccess = sl_false;
+	}
+	Println("Correctness: %s", flagSuccess ? "OK" : "FAILED");
+
+	return flagSuccess ? 0 : 1;
+}
@@ -0,0 +1,193 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/*
+	Insertion, lookup (hits in random order and misses), and removal time of `FlatHashMap`,
+	compared with `HashTable` and `CHashMap`, for 64-bit integer keys and short string keys.
+
+	Also checks that `FlatHashMap` keeps the same contents as `HashTable` through random puts,
+	replaces and removes. Exits with 1 when any check fails.
+
+	Usage: BenchmarkFlatHashMap [count of keys (default: 1000000)]
+*/
+
+#include <slib/core.h>
+
+using namespace slib;
+
+namespace {
+
+	sl_int64 GetKey(sl_uint32 index)
+	{
+		sl_uint64 x = (sl_uint64)index * SLIB_UINT64(0xD1B54A32D192ED03);
+		return (sl_int64)(x ^ (x >> 29));
+	}
+
+	// adapters for the common measure
+	template <class KT, class VT>
+	class CHashMapAdapter : public CHashMap<KT, VT>
+	{
+	public:
+		void put(const KT& key, const VT& value)
+		{
+			this->put_NoLock(key, value);
+		}
+
+		sl_bool get(const KT& key, VT* value)
+		{
+			return this->get_NoLock(key, value);
+		}
+
+		sl_bool remove(const KT& key)
+		{
+			return this->remove_NoLock(key);
+		}
+
+	};
+
+	template <class MAP, class KT>
+	void Measure(const char* name, const KT* keys, const KT* keysMissing, const sl_uint32* order, sl_uint32 n)
+	{
+		MAP map;
+		Time t = Time::now();
+		for (sl_uint32 i = 0; i < n; i++) {
+			map.put(keys[i], (sl_int64)i);
+		}
+		double dtInsert = (Time::now() - t).getMillisecondsCountf();
+
+		sl_int64 sum = 0;
+		sl_int64 value;
+		t = Time::now();
+		for (sl_uint32 i = 0; i < n; i++) {
+			if (map.get(keys[order[i]], &value)) {
+				sum += value;
+			}
+		}
+		double dtHit = (Time::now() - t).getMillisecondsCountf();
+
+		sl_uint32 nFound = 0;
+		t = Time::now();
+		for (sl_uint32 i = 0; i < n; i++) {
+			if (map.get(keysMissing[i], &value)) {
+				nFound++;
+			}
+		}
+		double dtMiss = (Time::now() - t).getMillisecondsCountf();
+
+		t = Time::now();
+		for (sl_uint32 i = 0; i < n; i += 2) {
+			map.remove(keys[order[i]]);
+		}
+		double dtRemove = (Time::now() - t).getMillisecondsCountf();
+
+		sl_bool flagValid = sum == (sl_int64)n * (n - 1) / 2 && !nFound;
+		Println("  %s insert %d ms, hits %d ms, misses %d ms, remove half %d ms%s", name, (sl_int32)dtInsert, (sl_int32)dtHit, (sl_int32)dtMiss, (sl_int32)dtRemove, flagValid ? "" : " (WRONG RESULT)");
+	}
+
+	template <class KT>
+	void MeasureAll(const char* title, const KT* keys, const KT* keysMissing, const sl_uint32* order, sl_uint32 n)
+	{
+		Println("%s, %d keys:", title, n);
+		Measure< FlatHashMap<KT, sl_int64> >("FlatHashMap:", keys, keysMissing, order, n);
+		Measure< HashTable<KT, sl_int64> >("HashTable:  ", keys, keysMissing, order, n);
+		Measure< CHashMapAdapter<KT, sl_int64> >("CHashMap:   ", keys, keysMissing, order, n);
+	}
+
+	sl_bool CheckContents(sl_uint32 nOperations)
+	{
+		FlatHashMap<sl_int64, sl_int64> flat;
+		HashTable<sl_int64, sl_int64> table;
+		sl_uint32 seed = 1;
+		for (sl_uint32 i = 0; i < nOperations; i++) {
+			seed = seed * 1103515245 + 12345;
+			// small key range, so the operations hit the existing keys
+			sl_int64 key = GetKey((seed >> 8) % 5000);
+			switch ((seed >> 4) & 3) {
+				case 0:
+				case 1:
+					flat.put(key, (sl_int64)i);
+					table.put(key, (sl_int64)i);
+					break;
+				case 2:
+					flat.replace(key, -(sl_int64)i);
+					table.replace(key, -(sl_int64)i);
+					break;
+				case 3:
+					if (flat.remove(key) != table.remove(key)) {
+						Println("remove: different results at %d", i);
+						return sl_false;
+					}
+					break;
+			}
+			if (flat.getCount() != table.getCount()) {
+				Println("count: %d != %d at %d", (sl_uint32)(flat.getCount()), (sl_uint32)(table.getCount()), i);
+				return sl_false;
+			}
+		}
+		sl_size n = 0;
+		for (auto& item : flat) {
+			sl_int64 value;
+			if (!(table.get(item.key, &value)) || value != item.value) {
+				Println("enumeration: different value");
+				return sl_false;
+			}
+			n++;
+		}
+		if (n != table.getCount()) {
+			Println("enumeration: %d items of %d", (sl_uint32)n, (sl_uint32)(table.getCount()));
+			return sl_false;
+		}
+		flat.removeAll();
+		return flat.isEmpty() && !(flat.find(GetKey(0)));
+	}
+
+}
+
+int main(int argc, const char * argv[])
+{
+	sl_uint32 n = 1000000;
+	if (argc > 1) {
+		n = String(argv[1]).parseUint32(10, n);
+	}
+	if (!n) {
+		n = 1;
+	}
+
+	sl_bool flagSuccess = CheckContents(1000000);
+	Println("Correctness: %s", flagSuccess ? "OK" : "FAILED");
+
+	Array<sl_uint32> order = Array<sl_uint32>::create(n);
+	for (sl_uint32 i = 0; i < n; i++) {
+		order[i] = i;
+	}
+	sl_uint32 seed = 7;
+	for (sl_uint32 i = n - 1; i > 0; i--) {
+		seed = seed * 1103515245 + 12345;
+		Swap(order[i], order[(seed >> 4) % (i + 1)]);
+	}
+
+	Array<sl_int64> keys = Array<sl_int64>::create(n);
+	Array<sl_int64> keysMissing = Array<sl_int64>::create(n);
+	for (sl_uint32 i = 0; i < n; i++) {
+		keys[i] = GetKey(i);
+		keysMissing[i] = GetKey(n + i);
+	}
+	MeasureAll("sl_int64", keys.getData(), keysMissing.getData(), order.getData(), n);
+
+	Array<String> strings = Array<String>::create(n);
+	Array<String> stringsMissing = Array<String>::create(n);
+	for (sl_uint32 i = 0; i < n; i++) {
+		strings[i] = String::format("key-%d", i);
+		stringsMissing[i] = String::format("missing-%d", i);
+	}
+	MeasureAll("String", strings.getData(), stringsMissing.getData(), order.getData(), n);
+
+	return flagSuccess ? 0 : 1;
+}
@@ -0,0 +1,203 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/*
+	Hashes per second and GB/s of `HashBytes` (seeded wyhash) and `HashBytesFNV64` (FNV-1a, the previous
+	implementation), and of `String::getHashCode` / `getHashCodeIgnoreCase`, for keys from 4 bytes to 4KB.
+
+	Also checks that the hash does not depend on the alignment of the buffer, that the seed changes the
+	hash, the avalanche of single-bit flips, the distribution of sequential keys over the buckets, and that
+	`getHashCodeIgnoreCase` matches across case variants. Exits with 1 when any check fails.
+
+	Usage: BenchmarkHashBytes [MB hashed per case (default: 400)]
+*/
+
+#include <slib/core.h>
+
+using namespace slib;
+
+namespace {
+
+	sl_uint32 g_seed = 1;
+
+	sl_uint32 Random()
+	{
+		g_seed = g_seed * 1103515245 + 12345;
+		return g_seed >> 8;
+	}
+
+	sl_bool CheckHash()
+	{
+		sl_bool flagSuccess = sl_true;
+		sl_uint8 buf[600];
+		sl_uint8 copy[600 + 16];
+		for (sl_uint32 i = 0; i < sizeof(buf); i++) {
+			buf[i] = (sl_uint8)Random();
+		}
+		for (sl_uint32 len = 0; len <= 512 && flagSuccess; len++) {
+			sl_uint64 h = HashBytes64(buf, len, 1);
+			for (sl_uint32 offset = 1; offset < 16; offset++) {
+				Base::copyMemory(copy + offset, buf, len);
+				if (HashBytes64(copy + offset, len, 1) != h || HashBytes(copy + offset, len) != HashBytes(buf, len)) {
+					Println("length %d: the hash depends on the alignment", len);
+					flagSuccess = sl_false;
+					break;
+				}
+			}
+			if (len && HashBytes64(buf, len, 2) == h) {
+				Println("length %d: the seed does not change the hash", len);
+				flagSuccess = sl_false;
+			}
+		}
+
+		// avalanche: each input bit flips each output bit with the probability of 1/2
+		const sl_uint32 nTrials = 1000;
+		const sl_uint32 lengths[] = {3, 8, 13, 24, 40, 100};
+		double worst = 0;
+		for (sl_uint32 len : lengths) {
+			sl_uint32 nBits = len * 8;
+			Array<sl_uint32> counts = Array<sl_uint32>::create(nBits * 64);
+			Base::zeroMemory(counts.getData(), nBits * 64 * sizeof(sl_uint32));
+			for (sl_uint32 t = 0; t < nTrials; t++) {
+				for (sl_uint32 i = 0; i < len; i++) {
+					buf[i] = (sl_uint8)Random();
+				}
+				sl_uint64 h0 = HashBytes64(buf, len, 0);
+				for (sl_uint32 bit = 0; bit < nBits; bit++) {
+					buf[bit >> 3] ^= (sl_uint8)(1 << (bit & 7));
+					sl_uint64 d = h0 ^ HashBytes64(buf, len, 0);
+					buf[bit >> 3] ^= (sl_uint8)(1 << (bit & 7));
+					for (sl_uint32 k = 0; k < 64; k++) {
+						counts[bit * 64 + k] += (sl_uint32)((d >> k) & 1);
+					}
+				}
+			}
+			for (sl_uint32 i = 0; i < nBits * 64; i++) {
+				double bias = Math::abs((double)(counts[i]) / nTrials - 0.5);
+				if (bias > worst) {
+					worst = bias;
+				}
+			}
+		}
+		Println("Avalanche: worst bias %s", String::fromDouble(worst, 3));
+		if (worst > 0.1) {
+			flagSuccess = sl_false;
+		}
+
+		// 2^20 sequential keys into 2^16 buckets (mean 16)
+		Array<sl_uint32> buckets = Array<sl_uint32>::create(65536);
+		Base::zeroMemory(buckets.getData(), 65536 * sizeof(sl_uint32));
+		sl_uint32 maxBucket = 0;
+		for (sl_uint32 i = 0; i < (1 << 20); i++) {
+			String key = String::format("key%d", i);
+			sl_uint32& bucket = buckets[key.getHashCode() & 65535];
+			bucket++;
+			if (bucket > maxBucket) {
+				maxBucket = bucket;
+			}
+		}
+		Println("Sequential keys: max bucket %d (mean 16)", maxBucket);
+		if (maxBucket > 48) {
+			flagSuccess = sl_false;
+		}
+
+		for (sl_uint32 i = 0; i < 100000; i++) {
+			sl_uint32 len = Random() % 200;
+			String s1 = String::allocate(len);
+			String s2 = String::allocate(len);
+			sl_char8* p1 = s1.getData();
+			sl_char8* p2 = s2.getData();
+			for (sl_uint32 k = 0; k < len; k++) {
+				sl_char8 c = (sl_char8)(32 + Random() % 95);
+				p1[k] = c;
+				p2[k] = (Random() & 1) ? SLIB_CHAR_LOWER_TO_UPPER(c) : SLIB_CHAR_UPPER_TO_LOWER(c);
+			}
+			if (s1.getHashCodeIgnoreCase() != s2.getHashCodeIgnoreCase()) {
+				Println("getHashCodeIgnoreCase: different for \"%s\" and \"%s\"", s1, s2);
+				flagSuccess = sl_false;
+				break;
+			}
+		}
+		return flagSuccess;
+	}
+
+	enum class Mode
+	{
+		WyHash,
+		FNV,
+		StringHash,
+		StringHashIgnoreCase
+	};
+
+	double Measure(Mode mode, const sl_uint8* buf, sl_size len, sl_size nIterations)
+	{
+		sl_size sum = 0;
+		Time t = Time::now();
+		for (sl_size i = 0; i < nIterations; i++) {
+			const sl_uint8* p = buf + (i & 63);
+			switch (mode) {
+				case Mode::WyHash:
+					sum += HashBytes(p, len);
+					break;
+				case Mode::FNV:
+					sum += (sl_size)(HashBytesFNV64(p, len));
+					break;
+				case Mode::StringHash:
+					sum += String::fromStatic((const sl_char8*)p, len).getHashCode();
+					break;
+				case Mode::StringHashIgnoreCase:
+					sum += String::fromStatic((const sl_char8*)p, len).getHashCodeIgnoreCase();
+					break;
+			}
+		}
+		double dt = (Time::now() - t).getSecondsCountf();
+		if (sum == 1) {
+			Println("");
+		}
+		return (double)nIterations / dt;
+	}
+
+	String FormatRate(double rate, sl_size len)
+	{
+		return String::format("%s M/s %s GB/s", String::fromDouble(rate / 1000000.0, 1), String::fromDouble(rate * len / 1000000000.0, 2));
+	}
+
+}
+
+int main(int argc, const char * argv[])
+{
+	sl_uint32 mb = 400;
+	if (argc > 1) {
+		mb = String(argv[1]).parseUint32(10, mb);
+	}
+	if (!mb) {
+		mb = 1;
+	}
+
+	sl_bool flagSuccess = CheckHash();
+	Println("Correctness: %s", flagSuccess ? "OK" : "FAILED");
+
+	sl_uint8 buf[4096 + 64];
+	for (sl_uint32 i = 0; i < sizeof(buf); i++) {
+		// printable, for the string hashes
+		buf[i] = (sl_uint8)(32 + (i * 131 + 7) % 95);
+	}
+	const sl_size lengths[] = {4, 8, 16, 32, 64, 256, 1024, 4096};
+	for (sl_size len : lengths) {
+		sl_size nIterations = (sl_size)mb * 1000000 / (len + 16);
+		Println("%d bytes:", (sl_uint32)len);
+		Println("  HashBytes (wyhash):     %s", FormatRate(Measure(Mode::WyHash, buf, len, nIterations), len));
+		Println("  HashBytesFNV64:         %s", FormatRate(Measure(Mode::FNV, buf, len, nIterations), len));
+		Println("  getHashCode:            %s", FormatRate(Measure(Mode::StringHash, buf, len, nIterations), len));
+		Println("  getHashCodeIgnoreCase:  %s", FormatRate(Measure(Mode::StringHashIgnoreCase, buf, len, nIterations), len));
+	}
+
+	return flagSuccess ? 0 : 1;
+}
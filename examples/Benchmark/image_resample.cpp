@@ -0,0 +1,196 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/*
+	Throughput of `Image::draw` in megapixels of the source per second, for the Linear, Box, Bicubic and
+	Lanczos stretch modes on large downscales and an upscale, and for the same-size SrcAlpha blend.
+	The kernels (scalar, SSE4.1 or AVX2) are selected for the running CPU.
+
+	Also checks that a flat color stays exactly flat in every mode, that a 2:1 box downscale is the
+	average of 2x2 pixels, that the corners are kept by the linear upscale, and the SrcAlpha
+	blend of opaque and transparent pixels. Exits with 1 when any check fails.
+
+	Usage: BenchmarkImageResample [repeats per case (default: 5)]
+*/
+
+#include <slib/core.h>
+#include <slib/graphics/image.h>
+
+using namespace slib;
+
+namespace {
+
+	const StretchMode g_modes[] = {StretchMode::Linear, StretchMode::Box, StretchMode::Bicubic, StretchMode::Lanczos};
+	const char* g_modeNames[] = {"Linear", "Box", "Bicubic", "Lanczos"};
+
+	void FillPattern(const Ref<Image>& image)
+	{
+		sl_uint32 width = image->getWidth();
+		sl_uint32 height = image->getHeight();
+		for (sl_uint32 y = 0; y < height; y++) {
+			Color* row = image->getColorsAt(0, y);
+			for (sl_uint32 x = 0; x < width; x++) {
+				row[x] = Color((sl_uint8)(x * 3 + y), (sl_uint8)(y * 5), (sl_uint8)(x ^ y), 255);
+			}
+		}
+	}
+
+	sl_bool IsFlat(const Ref<Image>& image, const Color& color)
+	{
+		sl_uint32 width = image->getWidth();
+		sl_uint32 height = image->getHeight();
+		for (sl_uint32 y = 0; y < height; y++) {
+			Color* row = image->getColorsAt(0, y);
+			for (sl_uint32 x = 0; x < width; x++) {
+				if (row[x] != color) {
+					return sl_false;
+				}
+			}
+		}
+		return sl_true;
+	}
+
+	void Draw(const Ref<Image>& dst, const Ref<Image>& src, BlendMode blend, StretchMode stretch)
+	{
+		ImageDesc descDst, descSrc;
+		dst->getDesc(descDst);
+		src->getDesc(descSrc);
+		Image::draw(descDst, descSrc, blend, stretch);
+	}
+
+	sl_bool CheckResample()
+	{
+		sl_bool flagSuccess = sl_true;
+		const sl_uint32 sizes[][4] = {{640, 480, 333, 217}, {333, 217, 640, 480}, {100, 100, 7, 9}, {7, 9, 100, 101}, {1, 50, 40, 3}, {64, 64, 64, 32}};
+		Color flat(37, 150, 201, 255);
+		for (auto& size : sizes) {
+			Ref<Image> src = Image::create(size[0], size[1]);
+			Ref<Image> dst = Image::create(size[2], size[3]);
+			src->fillColor(flat);
+			for (sl_uint32 m = 0; m < 4; m++) {
+				dst->fillColor(Color::zero());
+				Draw(dst, src, BlendMode::Copy, g_modes[m]);
+				if (!(IsFlat(dst, flat))) {
+					Println("%s %dx%d -> %dx%d: flat color is not kept", g_modeNames[m], size[0], size[1], size[2], size[3]);
+					flagSuccess = sl_false;
+				}
+			}
+		}
+		{
+			Ref<Image> src = Image::create(64, 48);
+			Ref<Image> dst = Image::create(32, 24);
+			FillPattern(src);
+			Draw(dst, src, BlendMode::Copy, StretchMode::Box);
+			for (sl_uint32 y = 0; y < 24 && flagSuccess; y++) {
+				for (sl_uint32 x = 0; x < 32; x++) {
+					Color* s0 = src->getColorsAt(x * 2, y * 2);
+					Color* s1 = src->getColorsAt(x * 2, y * 2 + 1);
+					Color* d = dst->getColorsAt(x, y);
+					// the horizontal and vertical passes round separately: off by 1 at most
+					sl_int32 r = (s0[0].r + s0[1].r + s1[0].r + s1[1].r + 2) >> 2;
+					sl_int32 g = (s0[0].g + s0[1].g + s1[0].g + s1[1].g + 2) >> 2;
+					sl_int32 b = (s0[0].b + s0[1].b + s1[0].b + s1[1].b + 2) >> 2;
+					if (Math::abs(d->r - r) > 1 || Math::abs(d->g - g) > 1 || Math::abs(d->b - b) > 1 || d->a != 255) {
+						Println("Box 2:1: (%d, %d) is not the average", x, y);
+						flagSuccess = sl_false;
+						break;
+					}
+				}
+			}
+		}
+		{
+			Ref<Image> src = Image::create(16, 12);
+			Ref<Image> dst = Image::create(61, 45);
+			FillPattern(src);
+			Draw(dst, src, BlendMode::Copy, StretchMode::Linear);
+			if (*(dst->getColorsAt(0, 0)) != *(src->getColorsAt(0, 0)) || *(dst->getColorsAt(60, 0)) != *(src->getColorsAt(15, 0)) || *(dst->getColorsAt(0, 44)) != *(src->getColorsAt(0, 11)) || *(dst->getColorsAt(60, 44)) != *(src->getColorsAt(15, 11))) {
+				Println("Linear upscale: corners are not kept");
+				flagSuccess = sl_false;
+			}
+		}
+		{
+			Ref<Image> src = Image::create(67, 5);
+			Ref<Image> dst = Image::create(67, 5);
+			FillPattern(src);
+			Color background(10, 20, 30, 255);
+			dst->fillColor(background);
+			for (sl_uint32 y = 0; y < 5; y++) {
+				Color* row = src->getColorsAt(0, y);
+				for (sl_uint32 x = 0; x < 67; x++) {
+					row[x].a = (x & 1) ? 255 : 0;
+				}
+			}
+			Draw(dst, src, BlendMode::SrcAlpha, StretchMode::Box);
+			for (sl_uint32 y = 0; y < 5 && flagSuccess; y++) {
+				for (sl_uint32 x = 0; x < 67; x++) {
+					Color expected = (x & 1) ? *(src->getColorsAt(x, y)) : background;
+					if (*(dst->getColorsAt(x, y)) != expected) {
+						Println("SrcAlpha: (%d, %d) is wrong", x, y);
+						flagSuccess = sl_false;
+						break;
+					}
+				}
+			}
+		}
+		return flagSuccess;
+	}
+
+	double MeasureDraw(const Ref<Image>& dst, const Ref<Image>& src, BlendMode blend, StretchMode stretch, sl_uint32 nRepeats)
+	{
+		Time t = Time::now();
+		for (sl_uint32 i = 0; i < nRepeats; i++) {
+			Draw(dst, src, blend, stretch);
+		}
+		double dt = (Time::now() - t).getSecondsCountf();
+		return (double)(src->getWidth()) * (double)(src->getHeight()) * nRepeats / dt / 1000000.0;
+	}
+
+	void Measure(sl_uint32 nRepeats)
+	{
+		const sl_uint32 cases[][4] = {{4000, 3000, 320, 240}, {4000, 3000, 1333, 1000}, {1000, 750, 2000, 1500}};
+		for (auto& c : cases) {
+			Ref<Image> src = Image::create(c[0], c[1]);
+			Ref<Image> dst = Image::create(c[2], c[3]);
+			FillPattern(src);
+			Println("%dx%d -> %dx%d (source MP/s)", c[0], c[1], c[2], c[3]);
+			for (sl_uint32 m = 0; m < 4; m++) {
+				Println("  %s: %s", g_modeNames[m], String::fromDouble(MeasureDraw(dst, src, BlendMode::Copy, g_modes[m], nRepeats), 1));
+			}
+		}
+		Ref<Image> src = Image::create(4000, 3000);
+		Ref<Image> dst = Image::create(4000, 3000);
+		FillPattern(src);
+		sl_uint32 n = 4000 * 3000;
+		Color* colors = src->getColors();
+		for (sl_uint32 i = 0; i < n; i++) {
+			colors[i].a = (sl_uint8)(i * 3);
+		}
+		Println("Same-size SrcAlpha blend: %s MP/s", String::fromDouble(MeasureDraw(dst, src, BlendMode::SrcAlpha, StretchMode::Box, nRepeats), 1));
+	}
+
+}
+
+int main(int argc, const char * argv[])
+{
+	sl_uint32 nRepeats = 5;
+	if (argc > 1) {
+		nRepeats = String(argv[1]).parseUint32(10, nRepeats);
+	}
+	if (!nRepeats) {
+		nRepeats = 1;
+	}
+
+	sl_bool flagSuccess = CheckResample();
+	Println("Correctness: %s", flagSuccess ? "OK" : "FAILED");
+
+	Measure(nRepeats);
+
+	return flagSuccess ? 0 : 1;
+}
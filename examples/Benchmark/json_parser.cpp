@@ -0,0 +1,278 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/*
+	Parsing speed (MB/s and GB/s) of a large pretty-printed array of log records by `Json::parseJson`,
+	`JsonParser` (whole buffer and 64KB reads from an `IReader`), and `JsonDocument`.
+
+	Also checks that the event stream of `JsonParser` does not depend on the chunking (whole buffer,
+	random chunks, 1-byte chunks), that `JsonDocument` reads the same records as `Json::parseJson`,
+	and that truncated documents are rejected. Exits with 1 when any check fails.
+
+	Usage: BenchmarkJsonParser [records (default: 400000, about 100MB)] [repeats (default: 3)]
+*/
+
+#include <slib/core.h>
+
+using namespace slib;
+
+namespace {
+
+	// hashes the events, and counts the values
+	class EventHasher : public IJsonParseListener
+	{
+	public:
+		sl_uint64 hash;
+		sl_size countValues;
+
+	public:
+		EventHasher(): hash(SLIB_UINT64(14695981039346656037)), countValues(0)
+		{
+		}
+
+	public:
+		void onStartObject(JsonParser* parser) override
+		{
+			add('{', sl_null, 0);
+		}
+
+		void onEndObject(JsonParser* parser) override
+		{
+			add('}', sl_null, 0);
+		}
+
+		void onStartArray(JsonParser* parser) override
+		{
+			add('[', sl_null, 0);
+		}
+
+		void onEndArray(JsonParser* parser) override
+		{
+			add(']', sl_null, 0);
+		}
+
+		void onKey(JsonParser* parser, const sl_char8* key, sl_size len) override
+		{
+			add('K', key, len);
+		}
+
+		void onString(JsonParser* parser, const sl_char8* value, sl_size len) override
+		{
+			add('S', value, len);
+			countValues++;
+		}
+
+		void onInt64(JsonParser* parser, sl_int64 value) override
+		{
+			add('I', &value, sizeof(value));
+			countValues++;
+		}
+
+		void onDouble(JsonParser* parser, double value) override
+		{
+			add('D', &value, sizeof(value));
+			countValues++;
+		}
+
+		void onBoolean(JsonParser* parser, sl_bool value) override
+		{
+			add(value ? 'T' : 'F', sl_null, 0);
+			countValues++;
+		}
+
+		void onNull(JsonParser* parser) override
+		{
+			add('N', sl_null, 0);
+			countValues++;
+		}
+
+	private:
+		void add(sl_uint8 type, const void* data, sl_size size)
+		{
+			hash = (hash ^ type) * SLIB_UINT64(1099511628211);
+			const sl_uint8* p = (const sl_uint8*)data;
+			for (sl_size i = 0; i < size; i++) {
+				hash = (hash ^ p[i]) * SLIB_UINT64(1099511628211);
+			}
+			hash = (hash ^ size) * SLIB_UINT64(1099511628211);
+		}
+
+	};
+
+	sl_uint32 g_seed = 7;
+
+	sl_uint32 Random()
+	{
+		g_seed = g_seed * 1103515245 + 12345;
+		return g_seed >> 8;
+	}
+
+	Memory BuildRecords(sl_uint32 nRecords)
+	{
+		StringBuffer buf;
+		buf.addStatic("[\n", 2);
+		for (sl_uint32 i = 0; i < nRecords; i++) {
+			if (i) {
+				buf.addStatic(",\n", 2);
+			}
+			buf.add(String::format("  {\"id\": %d, \"ts\": \"2024-05-01T12:34:56.%03dZ\", \"level\": \"info\", \"latency_ms\": %s, \"ok\": true, \"msg\": \"request handled by worker %d for path /api/v1/items\\n\", \"tags\": [\"a\", \"bb\", \"ccc\"], \"meta\": {\"region\": \"us-east-1\", \"retries\": %d, \"user\": null}}", i, Random() % 1000, String::fromDouble((double)(Random() % 100000) / 100.0), Random() % 64, Random() % 4));
+		}
+		buf.addStatic("\n]\n", 3);
+		String str = buf.merge();
+		return Memory::create(str.getData(), str.getLength());
+	}
+
+	sl_bool ParseEvents(const Memory& mem, sl_size sizeChunk, EventHasher& hasher)
+	{
+		JsonParserParam param;
+		param.listener = &hasher;
+		param.flagLogError = sl_false;
+		Ref<JsonParser> parser = JsonParser::create(param);
+		if (parser.isNull()) {
+			return sl_false;
+		}
+		const sl_uint8* data = (const sl_uint8*)(mem.getData());
+		sl_size size = mem.getSize();
+		if (!sizeChunk) {
+			return parser->parse(data, size);
+		}
+		sl_size pos = 0;
+		while (pos < size) {
+			// `-1`: random chunks
+			sl_size n = sizeChunk == (sl_size)-1 ? 1 + Random() % 4099 : sizeChunk;
+			if (n > size - pos) {
+				n = size - pos;
+			}
+			if (!(parser->feed(data + pos, n))) {
+				return sl_false;
+			}
+			pos += n;
+		}
+		return parser->finish();
+	}
+
+	sl_bool CheckParser()
+	{
+		sl_bool flagSuccess = sl_true;
+		Memory mem = BuildRecords(300);
+		EventHasher whole, random, bytes;
+		if (!(ParseEvents(mem, 0, whole)) || !(ParseEvents(mem, (sl_size)-1, random)) || !(ParseEvents(mem, 1, bytes))) {
+			Println("JsonParser: failed to parse");
+			return sl_false;
+		}
+		if (whole.hash != random.hash || whole.hash != bytes.hash || whole.countValues != 300 * 12) {
+			Println("JsonParser: the events depend on the chunking");
+			flagSuccess = sl_false;
+		}
+
+		Json json = Json::parseJson((const sl_char8*)(mem.getData()), mem.getSize());
+		Ref<JsonDocument> doc = JsonDocument::parse(mem);
+		if (doc.isNull() || !(json.isJsonList())) {
+			Println("JsonDocument: failed to parse");
+			return sl_false;
+		}
+		JsonValue root = doc->getRoot();
+		JsonList list = json.getJsonList();
+		if (root.getCount() != list.getCount()) {
+			Println("JsonDocument: wrong count");
+			return sl_false;
+		}
+		for (sl_size i = 0; i < root.getCount(); i++) {
+			JsonValue record = root[i];
+			Json expected = list.getValueAt(i);
+			if (record["id"].getInt64() != expected["id"].getInt64() || record["ts"].getString() != expected["ts"].getString() || record["msg"].getString() != expected["msg"].getString() || Math::abs(record["latency_ms"].getDouble() - expected["latency_ms"].getDouble()) > 1e-9 || record["meta"]["retries"].getInt32() != expected["meta"]["retries"].getInt32() || !(record["meta"]["user"].isNull()) || record["tags"][2].getString() != "ccc") {
+				Println("JsonDocument: record %d is different from Json::parseJson", (sl_uint32)i);
+				flagSuccess = sl_false;
+				break;
+			}
+		}
+
+		const char* truncated[] = {"[1, 2", "{\"a\": 1", "\"abc", "{\"a\": [{}]", "[1 2]", "{\"a\" 1}"};
+		for (auto& str : truncated) {
+			EventHasher hasher;
+			Memory m = Memory::create(str, Base::getStringLength(str));
+			if (ParseEvents(m, 0, hasher) || ParseEvents(m, 1, hasher)) {
+				Println("JsonParser: '%s' is accepted", str);
+				flagSuccess = sl_false;
+			}
+		}
+		return flagSuccess;
+	}
+
+	void PrintSpeed(const char* name, double mb, double seconds)
+	{
+		Println("  %s %s MB/s (%s GB/s)", name, String::fromDouble(mb / seconds, 0), String::fromDouble(mb / seconds / 1000.0, 2));
+	}
+
+	void Measure(sl_uint32 nRecords, sl_uint32 nRepeats)
+	{
+		Memory mem = BuildRecords(nRecords);
+		double mb = (double)(mem.getSize()) / 1000000.0;
+		Println("Document: %s MB, %d records", String::fromDouble(mb, 1), nRecords);
+		for (sl_uint32 i = 0; i < nRepeats; i++) {
+			Time t = Time::now();
+			{
+				Json json = Json::parseJson((const sl_char8*)(mem.getData()), mem.getSize());
+				if (json.isNull()) {
+					Println("Json::parseJson failed");
+				}
+			}
+			PrintSpeed("Json::parseJson:          ", mb, (Time::now() - t).getSecondsCountf());
+
+			t = Time::now();
+			EventHasher hasher;
+			ParseEvents(mem, 0, hasher);
+			PrintSpeed("JsonParser, whole buffer: ", mb, (Time::now() - t).getSecondsCountf());
+
+			t = Time::now();
+			{
+				EventHasher hasherReader;
+				JsonParserParam param;
+				param.listener = &hasherReader;
+				Ref<JsonParser> parser = JsonParser::create(param);
+				MemoryReader reader(mem);
+				parser->parse(&reader);
+			}
+			PrintSpeed("JsonParser, IReader:      ", mb, (Time::now() - t).getSecondsCountf());
+
+			t = Time::now();
+			{
+				Ref<JsonDocument> doc = JsonDocument::parse(mem);
+				if (doc.isNull() || doc->getRoot().getCount() != nRecords) {
+					Println("JsonDocument failed");
+				}
+			}
+			PrintSpeed("JsonDocument:             ", mb, (Time::now() - t).getSecondsCountf());
+		}
+	}
+
+}
+
+int main(int argc, const char * argv[])
+{
+	sl_uint32 nRecords = 400000;
+	sl_uint32 nRepeats = 3;
+	if (argc > 1) {
+		nRecords = String(argv[1]).parseUint32(10, nRecords);
+	}
+	if (argc > 2) {
+		nRepeats = String(argv[2]).parseUint32(10, nRepeats);
+	}
+	if (!nRecords) {
+		nRecords = 1;
+	}
+
+	sl_bool flagSuccess = CheckParser();
+	Println("Correctness: %s", flagSuccess ? "OK" : "FAILED");
+
+	Measure(nRecords, nRepeats);
+
+	return flagSuccess ? 0 : 1;
+}
@@ -0,0 +1,204 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/*
+	Packets per second of `NatTable` translating TCP and UDP packets (64 and 1500 bytes) in both directions,
+	over 1024 flows. Each measured packet is copied from a template before the translation.
+
+	Also checks that the translated packets keep valid IP/TCP/UDP checksums, and that the
+	non-first fragments are not rewritten. Exits with 1 when any check fails.
+
+	Usage: BenchmarkNetworkNat [packets per case (default: 2000000)]
+*/
+
+#include <slib/core.h>
+#include <slib/network/nat.h>
+#include <slib/network/tcpip.h>
+
+using namespace slib;
+
+namespace {
+
+	const IPv4Address g_addressInternal(192, 168, 0, 2);
+	const IPv4Address g_addressExternal(10, 0, 0, 1);
+	const IPv4Address g_addressRemote(8, 8, 8, 8);
+
+	// returns the size of IP content
+	sl_uint32 BuildPacket(sl_uint8* buf, sl_bool flagTcp, sl_uint32 sizeTotal, const IPv4Address& source, sl_uint16 portSource, const IPv4Address& destination, sl_uint16 portDestination)
+	{
+		for (sl_uint32 i = 0; i < sizeTotal; i++) {
+			buf[i] = (sl_uint8)(i * 7 + 3);
+		}
+		IPv4Packet* ip = (IPv4Packet*)buf;
+		ip->setVersion(4);
+		ip->setHeaderSize(sizeof(IPv4Packet));
+		ip->setTypeOfService(0);
+		ip->setTotalSize((sl_uint16)sizeTotal);
+		ip->setIdentification(1);
+		ip->setDF(sl_false);
+		ip->setMF(sl_false);
+		ip->setFragmentOffset(0);
+		ip->setTTL(64);
+		ip->setProtocol(flagTcp ? NetworkInternetProtocol::TCP : NetworkInternetProtocol::UDP);
+		ip->setSourceAddress(source);
+		ip->setDestinationAddress(destination);
+		ip->updateChecksum();
+		sl_uint32 sizeContent = sizeTotal - sizeof(IPv4Packet);
+		sl_uint8* content = buf + sizeof(IPv4Packet);
+		if (flagTcp) {
+			TcpSegment* tcp = (TcpSegment*)content;
+			tcp->setSourcePort(portSource);
+			tcp->setDestinationPort(portDestination);
+			tcp->setHeaderSize(sizeof(TcpSegment));
+			tcp->updateChecksum(ip, sizeContent);
+		} else {
+			UdpDatagram* udp = (UdpDatagram*)content;
+			udp->setSourcePort(portSource);
+			udp->setDestinationPort(portDestination);
+			udp->setTotalSize((sl_uint16)sizeContent);
+			udp->updateChecksum(ip);
+		}
+		return sizeContent;
+	}
+
+	sl_bool CheckPacket(sl_uint8* buf, sl_bool flagTcp, sl_uint32 sizeContent)
+	{
+		IPv4Packet* ip = (IPv4Packet*)buf;
+		if (!(ip->checkChecksum())) {
+			return sl_false;
+		}
+		sl_uint8* content = buf + sizeof(IPv4Packet);
+		if (flagTcp) {
+			return ((TcpSegment*)content)->checkChecksum(ip, sizeContent);
+		} else {
+			return ((UdpDatagram*)content)->checkChecksum(ip);
+		}
+	}
+
+	sl_bool CheckTranslation(sl_bool flagTcp)
+	{
+		NatTableParam param;
+		param.targetAddress = g_addressExternal;
+		Ref<NatTable> nat = new NatTable;
+		nat->setup(param);
+
+		sl_uint8 buf[1500];
+		sl_uint32 sizeContent = BuildPacket(buf, flagTcp, sizeof(buf), g_addressInternal, 5555, g_addressRemote, 80);
+		IPv4Packet* ip = (IPv4Packet*)buf;
+		sl_uint8* content = buf + sizeof(IPv4Packet);
+		if (!(nat->translateOutgoingPacket(ip, content, sizeContent))) {
+			return sl_false;
+		}
+		if (!(CheckPacket(buf, flagTcp, sizeContent)) || ip->getSourceAddress() != g_addressExternal) {
+			return sl_false;
+		}
+		sl_uint16 portExternal = flagTcp ? ((TcpSegment*)content)->getSourcePort() : ((UdpDatagram*)content)->getSourcePort();
+
+		sizeContent = BuildPacket(buf, flagTcp, sizeof(buf), g_addressRemote, 80, g_addressExternal, portExternal);
+		if (!(nat->translateIncomingPacket(ip, content, sizeContent))) {
+			return sl_false;
+		}
+		if (!(CheckPacket(buf, flagTcp, sizeContent)) || ip->getDestinationAddress() != g_addressInternal) {
+			return sl_false;
+		}
+		sl_uint16 portInternal = flagTcp ? ((TcpSegment*)content)->getDestinationPort() : ((UdpDatagram*)content)->getDestinationPort();
+		if (portInternal != 5555) {
+			return sl_false;
+		}
+
+		// the payload of a non-first fragment can look like a transport header
+		sizeContent = BuildPacket(buf, flagTcp, sizeof(buf), g_addressInternal, 6666, g_addressRemote, 80);
+		ip->setFragmentOffset(185);
+		ip->updateChecksum();
+		sl_uint8 original[1500];
+		Base::copyMemory(original, buf, sizeof(buf));
+		if (nat->translateOutgoingPacket(ip, content, sizeContent) || !(Base::equalsMemory(original, buf, sizeof(buf)))) {
+			return sl_false;
+		}
+		sizeContent = BuildPacket(buf, flagTcp, sizeof(buf), g_addressRemote, 80, g_addressExternal, portExternal);
+		ip->setFragmentOffset(185);
+		ip->updateChecksum();
+		Base::copyMemory(original, buf, sizeof(buf));
+		if (nat->translateIncomingPacket(ip, content, sizeContent) || !(Base::equalsMemory(original, buf, sizeof(buf)))) {
+			return sl_false;
+		}
+		return sl_true;
+	}
+
+	void Measure(sl_bool flagTcp, sl_uint32 size, sl_uint32 nPackets)
+	{
+		const sl_uint32 nFlows = 1024;
+		NatTableParam param;
+		param.targetAddress = g_addressExternal;
+		Ref<NatTable> nat = new NatTable;
+		nat->setup(param);
+
+		Memory memOutgoing = Memory::create(nFlows * size);
+		Memory memIncoming = Memory::create(nFlows * size);
+		sl_uint8* outgoing = (sl_uint8*)(memOutgoing.getData());
+		sl_uint8* incoming = (sl_uint8*)(memIncoming.getData());
+		sl_uint32 sizeContent = 0;
+		for (sl_uint32 i = 0; i < nFlows; i++) {
+			sl_uint8* packet = outgoing + i * size;
+			sizeContent = BuildPacket(packet, flagTcp, size, g_addressInternal, (sl_uint16)(10000 + i), g_addressRemote, 80);
+			// creates the mapping, and builds the reply
+			sl_uint8 buf[1500];
+			Base::copyMemory(buf, packet, size);
+			nat->translateOutgoingPacket((IPv4Packet*)buf, buf + sizeof(IPv4Packet), sizeContent);
+			sl_uint8* content = buf + sizeof(IPv4Packet);
+			sl_uint16 portExternal = flagTcp ? ((TcpSegment*)content)->getSourcePort() : ((UdpDatagram*)content)->getSourcePort();
+			BuildPacket(incoming + i * size, flagTcp, size, g_addressRemote, 80, g_addressExternal, portExternal);
+		}
+
+		sl_uint8 buf[1500];
+		sl_uint32 nTranslated = 0;
+		Time t = Time::now();
+		for (sl_uint32 i = 0; i < nPackets; i++) {
+			Base::copyMemory(buf, outgoing + (i & (nFlows - 1)) * size, size);
+			nTranslated += nat->translateOutgoingPacket((IPv4Packet*)buf, buf + sizeof(IPv4Packet), sizeContent) ? 1 : 0;
+		}
+		double dtOutgoing = (Time::now() - t).getSecondsCountf();
+		t = Time::now();
+		for (sl_uint32 i = 0; i < nPackets; i++) {
+			Base::copyMemory(buf, incoming + (i & (nFlows - 1)) * size, size);
+			nTranslated += nat->translateIncomingPacket((IPv4Packet*)buf, buf + sizeof(IPv4Packet), sizeContent) ? 1 : 0;
+		}
+		double dtIncoming = (Time::now() - t).getSecondsCountf();
+
+		Println("%s %d bytes: outgoing %s Mpps, incoming %s Mpps (translated %d/%d)", flagTcp ? "TCP" : "UDP", size, String::fromDouble((double)nPackets / dtOutgoing / 1000000.0, 2), String::fromDouble((double)nPackets / dtIncoming / 1000000.0, 2), nTranslated, nPackets * 2);
+	}
+
+}
+
+int main(int argc, const char * argv[])
+{
+	sl_uint32 nPackets = 2000000;
+	if (argc > 1) {
+		nPackets = String(argv[1]).parseUint32(10, nPackets);
+	}
+
+	sl_bool flagSuccess = sl_true;
+	if (!(CheckTranslation(sl_true))) {
+		Println("TCP translation check failed");
+		flagSuccess = sl_false;
+	}
+	if (!(CheckTranslation(sl_false))) {
+		Println("UDP translation check failed");
+		flagSuccess = sl_false;
+	}
+	Println("Correctness: %s", flagSuccess ? "OK" : "FAILED");
+
+	Measure(sl_true, 64, nPackets);
+	Measure(sl_true, 1500, nPackets);
+	Measure(sl_false, 64, nPackets);
+	Measure(sl_false, 1500, nPackets);
+
+	return flagSuccess ? 0 : 1;
+}
@@ -0,0 +1,198 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/*
+	Packets per second of `AsyncUdpSocket` over the loopback, receiving one datagram per system call,
+	batches of `recvmmsg`, and the coalesced datagrams of UDP_GRO (sent by UDP_SEGMENT).
+
+	Also checks that the coalesced datagrams are delivered complete when `packetSize` is smaller
+	than the coalesced message. Exits with 1 when any check fails.
+
+	Usage: BenchmarkNetworkUdp [milliseconds per case (default: 2000)] [datagram size (default: 64)]
+*/
+
+#include <slib/core.h>
+#include <slib/network.h>
+
+using namespace slib;
+
+namespace {
+
+	struct ReceiveCounter
+	{
+		sl_uint64 countDatagrams;
+		sl_uint64 countCallbacks;
+		sl_uint64 countBad;
+		sl_uint32 sizeExpected;
+	};
+
+	void CountDatagrams(ReceiveCounter* counter, AsyncUdpDatagram* datagrams, sl_uint32 count)
+	{
+		counter->countCallbacks++;
+		for (sl_uint32 i = 0; i < count; i++) {
+			AsyncUdpDatagram& datagram = datagrams[i];
+			counter->countDatagrams++;
+			if (datagram.size != counter->sizeExpected || ((sl_uint8*)(datagram.data))[datagram.size - 1] != (sl_uint8)(datagram.size)) {
+				counter->countBad++;
+			}
+		}
+	}
+
+	class UdpPair
+	{
+	public:
+		Ref<AsyncIoLoop> loopReceiver;
+		Ref<AsyncIoLoop> loopSender;
+		Ref<AsyncUdpSocket> receiver;
+		Ref<AsyncUdpSocket> sender;
+		SocketAddress addressReceiver;
+		ReceiveCounter counter;
+
+	public:
+		sl_bool open(sl_uint32 nBatch, sl_bool flagGRO, sl_uint32 sizePacket, sl_uint32 sizeDatagram)
+		{
+			Base::zeroMemory(&counter, sizeof(counter));
+			counter.sizeExpected = sizeDatagram;
+			loopReceiver = AsyncIoLoop::create();
+			loopSender = AsyncIoLoop::create();
+			if (loopReceiver.isNull() || loopSender.isNull()) {
+				return sl_false;
+			}
+			ReceiveCounter* pCounter = &counter;
+			AsyncUdpSocketParam param;
+			param.bindAddress = SocketAddress(IPv4Address(127, 0, 0, 1), 0);
+			param.packetSize = sizePacket;
+			param.batchCount = nBatch;
+			param.flagGRO = flagGRO;
+			param.ioLoop = loopReceiver;
+			param.onReceiveFromBatch = [pCounter](AsyncUdpSocket*, AsyncUdpDatagram* datagrams, sl_uint32 count) {
+				CountDatagrams(pCounter, datagrams, count);
+			};
+			receiver = AsyncUdpSocket::create(param);
+			if (receiver.isNull()) {
+				return sl_false;
+			}
+			receiver->setReceiveBufferSize(8 << 20);
+			receiver->getSocket()->getLocalAddress(addressReceiver);
+
+			AsyncUdpSocketParam paramSender;
+			paramSender.bindAddress = SocketAddress(IPv4Address(127, 0, 0, 1), 0);
+			paramSender.ioLoop = loopSender;
+			sender = AsyncUdpSocket::create(paramSender);
+			if (sender.isNull()) {
+				return sl_false;
+			}
+			sender->setSendBufferSize(8 << 20);
+			return sl_true;
+		}
+
+		void close()
+		{
+			receiver->close();
+			sender->close();
+			loopReceiver->release();
+			loopSender->release();
+		}
+
+	};
+
+	// every byte is the size of the datagram
+	Memory CreatePayload(sl_uint32 sizeDatagram, sl_uint32 nDatagrams)
+	{
+		sl_size size = (sl_size)sizeDatagram * nDatagrams;
+		Memory mem = Memory::create(size);
+		if (mem.isNotNull()) {
+			Base::resetMemory(mem.getData(), (sl_uint8)sizeDatagram, size);
+		}
+		return mem;
+	}
+
+	sl_bool CheckCoalescedDatagrams()
+	{
+		// 32 datagrams of 1000 bytes per send, received by the buffers of 1500 bytes
+		const sl_uint32 sizeDatagram = 1000;
+		const sl_uint32 nSegments = 32;
+		const sl_uint32 nSends = 64;
+		UdpPair pair;
+		if (!(pair.open(8, sl_true, 1500, sizeDatagram))) {
+			return sl_false;
+		}
+		Memory payload = CreatePayload(sizeDatagram, nSegments);
+		for (sl_uint32 i = 0; i < nSends; i++) {
+			pair.sender->sendTo(pair.addressReceiver, payload, sizeDatagram);
+			Thread::sleep(1);
+		}
+		for (sl_uint32 i = 0; i < 100 && pair.counter.countDatagrams < nSends * nSegments; i++) {
+			Thread::sleep(10);
+		}
+		pair.close();
+		Println("Coalesced datagrams: received %d/%d, bad %d", (sl_uint32)(pair.counter.countDatagrams), nSends * nSegments, (sl_uint32)(pair.counter.countBad));
+		return pair.counter.countDatagrams == nSends * nSegments && !(pair.counter.countBad);
+	}
+
+	void Measure(const char* name, sl_uint32 nBatch, sl_bool flagGRO, sl_bool flagGSO, sl_uint32 size, sl_uint32 duration)
+	{
+		const sl_uint32 nSegments = 32;
+		UdpPair pair;
+		if (!(pair.open(nBatch, flagGRO, 65536, size))) {
+			Println("%s: failed to open the sockets", name);
+			return;
+		}
+		Memory payload = CreatePayload(size, 1);
+		Memory payloadSegments = CreatePayload(size, nSegments);
+		sl_uint64 nSent = 0;
+		Time t = Time::now();
+		while ((Time::now() - t).getMillisecondsCount() < duration) {
+			for (sl_uint32 i = 0; i < 256; i++) {
+				if (flagGSO) {
+					pair.sender->sendTo(pair.addressReceiver, payloadSegments, size);
+					nSent += nSegments;
+				} else {
+					pair.sender->sendTo(pair.addressReceiver, payload);
+					nSent++;
+				}
+			}
+			Thread::sleep(0);
+		}
+		double elapsed = (Time::now() - t).getSecondsCountf();
+		// receives the remaining datagrams
+		Thread::sleep(200);
+		pair.close();
+		ReceiveCounter& counter = pair.counter;
+		Println("%s: %s Mpps received, %s datagrams per callback (queued %s M, bad %d)", name, String::fromDouble((double)(counter.countDatagrams) / elapsed / 1000000.0, 3), String::fromDouble(counter.countCallbacks ? (double)(counter.countDatagrams) / (double)(counter.countCallbacks) : 0.0, 1), String::fromDouble((double)nSent / 1000000.0, 2), (sl_uint32)(counter.countBad));
+	}
+
+}
+
+int main(int argc, const char * argv[])
+{
+	sl_uint32 duration = 2000;
+	sl_uint32 size = 64;
+	if (argc > 1) {
+		duration = String(argv[1]).parseUint32(10, duration);
+	}
+	if (argc > 2) {
+		size = String(argv[2]).parseUint32(10, size);
+	}
+	if (!size) {
+		size = 1;
+	}
+
+	sl_bool flagSuccess = CheckCoalescedDatagrams();
+	Println("Correctness: %s", flagSuccess ? "OK" : "FAILED");
+
+	Println("Datagrams of %d bytes over the loopback", size);
+	Measure("recvfrom", 1, sl_false, sl_false, size, duration);
+	Measure("recvmmsg x32", 32, sl_false, sl_false, size, duration);
+	Measure("recvmmsg x32, GSO send", 32, sl_false, sl_true, size, duration);
+	Measure("recvmmsg x32 + GRO, GSO send", 32, sl_true, sl_true, size, duration);
+
+	return flagSuccess ? 0 : 1;
+}
@@ -0,0 +1,165 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/*
+	Tasks per second of the classic `ThreadPool` (one shared queue) and of the work-stealing pool,
+	for tiny tasks added from an outside thread, added in batches, and spawned by the tasks themselves.
+
+	Also checks that every task runs exactly once and that the delayed tasks run after their delay.
+	Exits with 1 when any check fails.
+
+	Usage: BenchmarkThreadPool [threads (default: processors count)] [tasks per case (default: 1000000)]
+*/
+
+#include <slib/core.h>
+
+using namespace slib;
+
+namespace {
+
+	enum class Mode
+	{
+		Single,
+		Batch,
+		Nested
+	};
+
+	void WaitCount(sl_int32* count, sl_int32 target)
+	{
+		sl_uint32 n = 0;
+		while (Base::interlockedAdd32(count, 0) < target) {
+			System::yield(n);
+			n++;
+		}
+	}
+
+	double Measure(const Ref<ThreadPool>& pool, Mode mode, sl_uint32 nTasks)
+	{
+		sl_int32 count = 0;
+		sl_int32* pCount = &count;
+		Function<void()> task = [pCount]() {
+			Base::interlockedIncrement32(pCount);
+		};
+		Time t = Time::now();
+		switch (mode) {
+			case Mode::Single:
+				for (sl_uint32 i = 0; i < nTasks; i++) {
+					pool->addTask(task);
+				}
+				break;
+			case Mode::Batch:
+				{
+					const sl_uint32 sizeBatch = 256;
+					Function<void()> batch[sizeBatch];
+					for (sl_uint32 i = 0; i < sizeBatch; i++) {
+						batch[i] = task;
+					}
+					for (sl_uint32 i = 0; i < nTasks; i += sizeBatch) {
+						sl_uint32 n = nTasks - i;
+						pool->addTasks(batch, n < sizeBatch ? n : sizeBatch);
+					}
+				}
+				break;
+			case Mode::Nested:
+				{
+					const sl_uint32 nChildren = 1000;
+					ThreadPool* p = pool.get();
+					for (sl_uint32 i = 0; i < nTasks; i += nChildren) {
+						sl_uint32 n = nTasks - i;
+						if (n > nChildren) {
+							n = nChildren;
+						}
+						p->addTask([p, task, n]() {
+							for (sl_uint32 k = 0; k < n; k++) {
+								p->addTask(task);
+							}
+						});
+					}
+				}
+				break;
+		}
+		WaitCount(pCount, (sl_int32)nTasks);
+		double elapsed = (Time::now() - t).getSecondsCountf();
+		if (count != (sl_int32)nTasks) {
+			return -1;
+		}
+		return (double)nTasks / elapsed;
+	}
+
+	sl_bool CheckDelayed(const Ref<ThreadPool>& pool)
+	{
+		sl_int32 count = 0;
+		sl_int32* pCount = &count;
+		Time t = Time::now();
+		double elapsed[2] = {0, 0};
+		double* pElapsed = elapsed;
+		pool->dispatch([pCount, pElapsed, t]() {
+			pElapsed[0] = (Time::now() - t).getMillisecondsCountf();
+			Base::interlockedIncrement32(pCount);
+		}, 100);
+		pool->dispatch([pCount, pElapsed, t]() {
+			pElapsed[1] = (Time::now() - t).getMillisecondsCountf();
+			Base::interlockedIncrement32(pCount);
+		}, 20);
+		for (sl_uint32 i = 0; i < 2000 && Base::interlockedAdd32(pCount, 0) < 2; i++) {
+			Thread::sleep(1);
+		}
+		return count == 2 && elapsed[0] >= 99 && elapsed[1] >= 19 && elapsed[1] < elapsed[0];
+	}
+
+	sl_bool Run(const char* name, const Ref<ThreadPool>& pool, sl_uint32 nTasks)
+	{
+		if (pool.isNull()) {
+			Println("%s: failed to create the pool", name);
+			return sl_false;
+		}
+		sl_bool flagSuccess = sl_true;
+		const char* names[] = {"single", "batch of 256", "spawned by tasks"};
+		Mode modes[] = {Mode::Single, Mode::Batch, Mode::Nested};
+		for (sl_uint32 i = 0; i < 3; i++) {
+			double rate = Measure(pool, modes[i], nTasks);
+			if (rate < 0) {
+				Println("%s, %s: wrong count of executed tasks", name, names[i]);
+				flagSuccess = sl_false;
+			} else {
+				Println("%s, %s: %s M tasks/s", name, names[i], String::fromDouble(rate / 1000000.0, 2));
+			}
+		}
+		if (!(CheckDelayed(pool))) {
+			Println("%s: delayed tasks failed", name);
+			flagSuccess = sl_false;
+		}
+		pool->release();
+		return flagSuccess;
+	}
+
+}
+
+int main(int argc, const char * argv[])
+{
+	sl_uint32 nThreads = System::getProcessorsCount();
+	sl_uint32 nTasks = 1000000;
+	if (argc > 1) {
+		nThreads = String(argv[1]).parseUint32(10, nThreads);
+	}
+	if (argc > 2) {
+		nTasks = String(argv[2]).parseUint32(10, nTasks);
+	}
+	if (!nThreads) {
+		nThreads = 1;
+	}
+
+	sl_bool flagSuccess = sl_true;
+	flagSuccess = Run("Classic", ThreadPool::create(nThreads, nThreads), nTasks) && flagSuccess;
+	flagSuccess = Run("Work-stealing", ThreadPool::createWorkStealing(nThreads), nTasks) && flagSuccess;
+	Println("Correctness: %s", flagSuccess ? "OK" : "FAILED");
+
+	return flagSuccess ? 0 : 1;
+}
@@ -0,0 +1,175 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/*
+	Lookup time of `WebRouter` with thousands of routes (exact, `:name` and `*name` patterns) in random order,
+	compared with the "METHOD path" signature map used by WebController before the router (exact paths only).
+
+	Also checks the parameter captures and the escapes of the literal ':' and '*'. Exits with 1 when any check fails.
+
+	Usage: BenchmarkWebRouter [groups of 4 routes (default: 1500)] [lookups (default: 2000000)]
+*/
+
+#include <slib/core.h>
+#include <slib/web/router.h>
+
+using namespace slib;
+
+namespace {
+
+	Variant Handler(const Ref<HttpServiceContext>& context, HttpMethod method, const String& path)
+	{
+		return sl_null;
+	}
+
+	String GetParam(const String& path, const WebRouterMatch& match, sl_uint32 index)
+	{
+		if (index >= match.countParams) {
+			return sl_null;
+		}
+		sl_size start = match.params[index].start;
+		return path.substring(start, start + match.params[index].length);
+	}
+
+	sl_bool CheckMatch(WebRouter& router, HttpMethod method, const String& path, sl_bool flagExpected, const char* param0 = sl_null, const char* param1 = sl_null)
+	{
+		WebRouterMatch match;
+		sl_bool flagMatched = router.match(method, path, match);
+		if (flagMatched != flagExpected) {
+			Println("%s %s: %s", HttpMethods::toString(method), path, flagMatched ? "unexpected match" : "not matched");
+			return sl_false;
+		}
+		if (!flagMatched) {
+			return sl_true;
+		}
+		sl_uint32 nParams = param1 ? 2 : (param0 ? 1 : 0);
+		if (match.countParams != nParams || (param0 && GetParam(path, match, 0) != param0) || (param1 && GetParam(path, match, 1) != param1)) {
+			Println("%s %s: wrong parameters (%d)", HttpMethods::toString(method), path, match.countParams);
+			return sl_false;
+		}
+		return sl_true;
+	}
+
+	sl_bool CheckRouter()
+	{
+		WebRouter router;
+		router.add(HttpMethod::GET, "/user/list", &Handler);
+		router.add(HttpMethod::GET, "/user/:id", &Handler);
+		router.add(HttpMethod::GET, "/user/:id/posts/:post", &Handler);
+		router.add(HttpMethod::POST, "/user/:id", &Handler);
+		router.add(HttpMethod::Unknown, "/static/*file", &Handler);
+		router.add(HttpMethod::GET, "/time/12\\:00", &Handler);
+		router.add(HttpMethod::GET, "/glob/\\*.txt", &Handler);
+		router.add(HttpMethod::GET, "/back\\\\slash", &Handler);
+
+		sl_bool flagSuccess = sl_true;
+		flagSuccess = CheckMatch(router, HttpMethod::GET, "/user/list", sl_true) && flagSuccess;
+		flagSuccess = CheckMatch(router, HttpMethod::GET, "/user/42", sl_true, "42") && flagSuccess;
+		flagSuccess = CheckMatch(router, HttpMethod::POST, "/user/42", sl_true, "42") && flagSuccess;
+		flagSuccess = CheckMatch(router, HttpMethod::DELETE, "/user/42", sl_false) && flagSuccess;
+		flagSuccess = CheckMatch(router, HttpMethod::GET, "/user/42/posts/7", sl_true, "42", "7") && flagSuccess;
+		flagSuccess = CheckMatch(router, HttpMethod::GET, "/user/42/posts", sl_false) && flagSuccess;
+		flagSuccess = CheckMatch(router, HttpMethod::PUT, "/static/css/main.css", sl_true, "css/main.css") && flagSuccess;
+		flagSuccess = CheckMatch(router, HttpMethod::GET, "/time/12:00", sl_true) && flagSuccess;
+		flagSuccess = CheckMatch(router, HttpMethod::GET, "/time/12:30", sl_false) && flagSuccess;
+		flagSuccess = CheckMatch(router, HttpMethod::GET, "/glob/*.txt", sl_true) && flagSuccess;
+		flagSuccess = CheckMatch(router, HttpMethod::GET, "/glob/a.txt", sl_false) && flagSuccess;
+		flagSuccess = CheckMatch(router, HttpMethod::GET, "/back\\slash", sl_true) && flagSuccess;
+		return flagSuccess;
+	}
+
+	void Measure(sl_uint32 nGroups, sl_uint32 nLookups)
+	{
+		WebRouter router;
+		CHashMap<String, WebHandler> signatures;
+		List<String> pathsExact;
+		List<String> pathsParam;
+		for (sl_uint32 i = 0; i < nGroups; i++) {
+			String prefix = String::format("/api/v1/resource%d", i);
+			router.add(HttpMethod::GET, prefix + "/list", &Handler);
+			router.add(HttpMethod::GET, prefix + "/:id", &Handler);
+			router.add(HttpMethod::POST, prefix + "/:id/items/:item", &Handler);
+			router.add(HttpMethod::GET, String::format("/static%d/*file", i), &Handler);
+			signatures.put_NoLock("GET " + prefix + "/list", &Handler);
+			pathsExact.add_NoLock(prefix + "/list");
+			pathsParam.add_NoLock(String::format("%s/%d/items/%d", prefix, i * 7, i * 13));
+		}
+
+		// random order
+		sl_uint32 nPaths = nGroups;
+		Array<sl_uint32> order = Array<sl_uint32>::create(nLookups);
+		sl_uint32 seed = 1;
+		for (sl_uint32 i = 0; i < nLookups; i++) {
+			seed = seed * 1103515245 + 12345;
+			order[i] = (seed >> 8) % nPaths;
+		}
+		String* exact = pathsExact.getData();
+		String* param = pathsParam.getData();
+		WebRouterMatch match;
+		sl_uint32 nMatched = 0;
+
+		// compiles the tree
+		router.match(HttpMethod::GET, exact[0], match);
+
+		Time t = Time::now();
+		for (sl_uint32 i = 0; i < nLookups; i++) {
+			String sig = HttpMethods::toString(HttpMethod::GET) + " " + exact[order[i]];
+			nMatched += signatures.find_NoLock(sig) ? 1 : 0;
+		}
+		double dtSignature = (Time::now() - t).getMicrosecondsCountf() * 1000.0 / nLookups;
+
+		t = Time::now();
+		for (sl_uint32 i = 0; i < nLookups; i++) {
+			nMatched += router.match(HttpMethod::GET, exact[order[i]], match) ? 1 : 0;
+		}
+		double dtExact = (Time::now() - t).getMicrosecondsCountf() * 1000.0 / nLookups;
+
+		t = Time::now();
+		for (sl_uint32 i = 0; i < nLookups; i++) {
+			nMatched += router.match(HttpMethod::POST, param[order[i]], match) ? 1 : 0;
+		}
+		double dtParam = (Time::now() - t).getMicrosecondsCountf() * 1000.0 / nLookups;
+
+		t = Time::now();
+		for (sl_uint32 i = 0; i < nLookups; i++) {
+			nMatched += router.match(HttpMethod::GET, exact[i & 7], match) ? 1 : 0;
+		}
+		double dtHot = (Time::now() - t).getMicrosecondsCountf() * 1000.0 / nLookups;
+
+		Println("%d routes, %d lookups (matched %d/%d)", nGroups * 4, nLookups, nMatched, nLookups * 4);
+		Println("  signature map (exact):  %d ns", (sl_int32)dtSignature);
+		Println("  router, exact:          %d ns", (sl_int32)dtExact);
+		Println("  router, 2 parameters:   %d ns", (sl_int32)dtParam);
+		Println("  router, 8 hot paths:    %d ns", (sl_int32)dtHot);
+	}
+
+}
+
+int main(int argc, const char * argv[])
+{
+	sl_uint32 nGroups = 1500;
+	sl_uint32 nLookups = 2000000;
+	if (argc > 1) {
+		nGroups = String(argv[1]).parseUint32(10, nGroups);
+	}
+	if (argc > 2) {
+		nLookups = String(argv[2]).parseUint32(10, nLookups);
+	}
+	if (!nGroups) {
+		nGroups = 1;
+	}
+
+	sl_bool flagSuccess = CheckRouter();
+	Println("Correctness: %s", flagSuccess ? "OK" : "FAILED");
+
+	Measure(nGroups, nLookups);
+
+	return flagSuccess ? 0 : 1;
+}
@@ -55,6 +55,7 @@
 #include "core/map.h"
 #include "core/hash_map.h"
 #include "core/hash_table.h"
+#include "core/flat_hash_map.h"
 #include "core/linked_list.h"
 #include "core/queue.h"
 #include "core/queue_channel.h"
@@ -62,6 +63,7 @@
 #include "core/loop_queue.h"
 #include "core/expire.h"
 #include "core/btree.h"
+#include "core/file_btree.h"
 
 #include "core/math.h"
 #include "core/interpolation.h"
@@ -94,6 +96,7 @@
 #include "core/setting.h"
 
 #include "core/json.h"
+#include "core/json_parser.h"
 #include "core/xml.h"
 #include "core/base64.h"
 
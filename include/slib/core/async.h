@@ -230,6 +230,10 @@ namespace slib
 		Function<void(AsyncStreamResult*)> callback;
 		sl_bool flagRead;
 
+		// source of the write request from file (`data` is null)
+		Ref<File> file;
+		sl_uint64 offsetFile;
+
 	protected:
 		AsyncStreamRequest(const void* data, sl_uint32 size, Referable* userObject, const Function<void(AsyncStreamResult*)>& callback, sl_bool flagRead);
 	
@@ -238,6 +242,8 @@ namespace slib
 
 		static Ref<AsyncStreamRequest> createWrite(const void* data, sl_uint32 size, Referable* userObject, const Function<void(AsyncStreamResult*)>& callback);
 
+		static Ref<AsyncStreamRequest> createWriteFromFile(const Ref<File>& file, sl_uint64 offset, sl_uint32 size, Referable* userObject, const Function<void(AsyncStreamResult*)>& callback);
+
 	public:
 		void runCallback(AsyncStream* stream, sl_uint32 resultSize, sl_bool flagError);
 
@@ -258,6 +264,10 @@ namespace slib
 
 		virtual sl_bool write(const void* data, sl_uint32 size, const Function<void(AsyncStreamResult*)>& callback, Referable* userObject);
 
+		virtual sl_bool isWritingFromFileSupported();
+
+		virtual sl_bool writeFromFile(const Ref<File>& file, sl_uint64 offset, sl_uint32 size, const Function<void(AsyncStreamResult*)>& callback, Referable* userObject);
+
 		virtual sl_bool isSeekable();
 
 		virtual sl_bool seek(sl_uint64 pos);
@@ -309,6 +319,11 @@ namespace slib
 
 		virtual sl_bool write(const void* data, sl_uint32 size, const Function<void(AsyncStreamResult*)>& callback, Referable* userObject = sl_null) = 0;
 
+		// zero-copy transfer from the file to the stream (sendfile), without changing the file position
+		virtual sl_bool isWritingFromFileSupported();
+
+		virtual sl_bool writeFromFile(const Ref<File>& file, sl_uint64 offset, sl_uint32 size, const Function<void(AsyncStreamResult*)>& callback, Referable* userObject = sl_null);
+
 		virtual sl_bool isSeekable();
 
 		virtual sl_bool seek(sl_uint64 pos);
@@ -339,6 +354,10 @@ namespace slib
 
 		sl_bool write(const void* data, sl_uint32 size, const Function<void(AsyncStreamResult*)>& callback, Referable* userObject = sl_null) override;
 
+		sl_bool isWritingFromFileSupported() override;
+
+		sl_bool writeFromFile(const Ref<File>& file, sl_uint64 offset, sl_uint32 size, const Function<void(AsyncStreamResult*)>& callback, Referable* userObject = sl_null) override;
+
 		sl_bool isSeekable() override;
 
 		sl_bool seek(sl_uint64 pos) override;
@@ -658,17 +677,28 @@ namespace slib
 		sl_bool addHeader(const Memory& header);
 
 		void setBody(AsyncStream* stream, sl_uint64 size);
+
+		void setBodyFile(const Ref<File>& file, sl_uint64 offset, sl_uint64 size);
 	
 		MemoryQueue& getHeader();
 	
 		Ref<AsyncStream> getBody();
+
+		Ref<File> getBodyFile();
+
+		sl_uint64 getBodyFileOffset();
 	
 		sl_uint64 getBodySize();
+
+		// consumes the beginning of the file body
+		void skipBodyFile(sl_uint64 size);
 	
 	protected:
 		MemoryQueue m_header;
 		sl_uint64 m_sizeBody;
 		AtomicRef<AsyncStream> m_body;
+		AtomicRef<File> m_bodyFile;
+		sl_uint64 m_offsetBodyFile;
 
 	};
 	
@@ -692,6 +722,9 @@ namespace slib
 
 		sl_bool copyFromFile(const String& path, const Ref<Dispatcher>& dispatcher);
 
+		// the range of the file is sent by AsyncStream::writeFromFile() if the output stream supports it. `file` can be shared by the outputs in that case.
+		sl_bool sendFile(const Ref<File>& file, sl_uint64 offset, sl_uint64 size);
+
 		sl_uint64 getOutputLength() const;
 	
 	protected:
@@ -71,7 +71,41 @@ namespace slib
 	};
 	
 	typedef Atomic<sl_int32> AtomicInt32;
-	
+
+
+	/*
+		Hazard pointers for the lock-free loads of the reference-counted pointers (`Atomic< Ref<T> >`, `Atomic<String>`).
+		A reader publishes the loaded pointer in the slot of its thread while it increases the reference count,
+		and a writer retires the replaced pointer: its reference is released at once when no thread publishes it,
+		otherwise it is kept in the retired list of the writer's thread and released by a later scan of that thread.
+		Neither readers nor writers wait. Readers write only to their own slots (separated by cache lines).
+		Note that a load returning `Ref<T>` still increases the reference count of the object shared by all readers.
+		`BorrowedRef` reads the object of `Atomic< Ref<T> >` without it, keeping the pointer published instead.
+	*/
+	class SLIB_EXPORT _priv_HazardPointer
+	{
+	public:
+		typedef void (*ReleaseFunction)(void* ptr);
+
+	public:
+		// returns the value of `*ptr` published in the first slot of the current thread (not published when null)
+		static void* protect(void* const volatile* ptr) noexcept;
+
+		// clears the first slot of the current thread
+		static void release() noexcept;
+
+		// publishes the value of `*ptr` in a free slot of the current thread until `giveBack(outSlot)`. returns false if no slot is free. `outSlot` is 0 when the value is null
+		static sl_bool borrow(void* const volatile* ptr, void*& outValue, sl_uint32& outSlot) noexcept;
+
+		static void giveBack(sl_uint32 slot) noexcept;
+
+		static void* exchange(void* volatile* ptr, void* value) noexcept;
+
+		// calls `release(ptr)` when `ptr` (already replaced) is not published by any thread. never waits: a published pointer is released later by `retire()` or `giveBack()` of this thread (or of another thread after this thread exits)
+		static void retire(void* ptr, ReleaseFunction release) noexcept;
+
+	};
+
 	
 	template <class T>
 	struct RemoveAtomic;
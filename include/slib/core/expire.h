@@ -28,6 +28,7 @@ namespace slib
 		HashMap<KT, VT> m_mapBackup;
 
 		sl_uint32 m_duration;
+		sl_size m_maxCount;
 
 		Ref<Timer> m_timer;
 		WeakRef<DispatchLoop> m_dispatchLoop;
@@ -45,6 +46,11 @@ namespace slib
 		void clearTimer();
 
 		void setupTimer(sl_uint32 period_ms);
+
+		sl_size getMaximumCount() const;
+
+		// limits the number of the items (0: no limit). the older half is dropped when the limit is reached
+		void setMaximumCount(sl_size count);
 	
 		sl_bool get(const KT& key, VT* _out = sl_null, sl_bool flagUpdateLifetime = sl_true);
 
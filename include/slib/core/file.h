@@ -157,11 +157,22 @@ namespace slib
 		sl_int32 read32(void* buf, sl_uint32 size) override;
 
 		sl_int32 write32(const void* buf, sl_uint32 size) override;
+
+		// reads at `offset` regardless of the file position, so it can be used on a file shared by several readers.
+		// the position is not moved on unix (pread), but is moved to the end of the read data on Windows.
+		sl_int32 readAt32(sl_uint64 offset, void* buf, sl_uint32 size);
+
+		sl_reg readAt(sl_uint64 offset, void* buf, sl_size size);
+
+		sl_reg readFullyAt(sl_uint64 offset, void* buf, sl_size size);
 	
 	
 		// works only if the file is already opened
 		sl_bool setSize(sl_uint64 size) override;
 
+		// writes the buffered data of the file to the storage device
+		sl_bool flush();
+
 		
 		static sl_uint64 getSize(sl_file fd);
 		
@@ -306,7 +317,136 @@ namespace slib
 		static sl_bool _deleteDirectory(const String& dirPath);
 
 	};
-	
+
+	enum class MappedFileMode
+	{
+		// read-only view
+		ReadOnly = 0,
+		// writable view, the modifications are private to the process and not written to the file
+		CopyOnWrite = 1,
+		// writable view, the modifications are written to the file and shared with the other processes
+		SharedWrite = 2
+	};
+
+	enum class MappedFileAdvice
+	{
+		Normal = 0,
+		Sequential = 1,
+		Random = 2,
+		// prefetches the pages
+		WillNeed = 3,
+		// the pages can be discarded, and are reloaded from the file on next access (the modifications of `CopyOnWrite` are lost)
+		DontNeed = 4
+	};
+
+	class SLIB_EXPORT MappedFileParam
+	{
+	public:
+		String filePath;
+		// maps the opened file instead of `filePath`. the file should be opened for reading (and writing on `SharedWrite`)
+		Ref<File> file;
+
+		MappedFileMode mode; // default: ReadOnly
+
+		// offset in the file (need not be aligned)
+		sl_uint64 offset; // default: 0
+		// 0: to the end of the file. on `SharedWrite`, the file is extended to `offset + size`
+		sl_uint64 size; // default: 0
+
+		MappedFileAdvice advice; // default: Normal
+
+		// requests the transparent huge pages for the view (Linux). the mappings of the files on hugetlbfs always use the huge pages
+		sl_bool flagHugePages; // default: false
+
+		// reads all pages of the view on opening (Linux), or prefetches them
+		sl_bool flagPopulate; // default: false
+
+	public:
+		MappedFileParam();
+
+		~MappedFileParam();
+
+	};
+
+	class _priv_MappedFile_View;
+
+	/*
+		View of a file mapped into the memory.
+		`getData()` is valid until the view is closed or released. The memory returned by `getMemory()` keeps the view
+		mapped until the last reference to it is released, even after `close()`.
+		When the file is truncated by other processes, the access to the removed pages may crash the process (SIGBUS).
+	*/
+	class SLIB_EXPORT MappedFile : public Object
+	{
+		SLIB_DECLARE_OBJECT
+
+	private:
+		MappedFile();
+
+		~MappedFile();
+
+	public:
+		// returns null if the range is empty
+		static Ref<MappedFile> open(const MappedFileParam& param);
+
+		static Ref<MappedFile> openForRead(const String& filePath);
+
+		static Ref<MappedFile> openForWrite(const String& filePath, sl_uint64 size);
+
+	public:
+		void close();
+
+		sl_bool isOpened() const;
+
+		void* getData() const;
+
+		sl_size getSize() const;
+
+		// offset of the view in the file
+		sl_uint64 getOffset() const;
+
+		MappedFileMode getMode() const;
+
+		Ref<File> getFile() const;
+
+		// the memory keeps the view mapped (not this object)
+		Memory getMemory();
+
+		// `offset` and `size` are relative to the view, and are extended to the page boundaries
+		sl_bool advise(MappedFileAdvice advice, sl_size offset = 0, sl_size size = SLIB_SIZE_MAX);
+
+		// writes the modified pages to the file (`SharedWrite`). `flagAsync`: schedules the writing and returns immediately
+		sl_bool flush(sl_bool flagAsync = sl_false);
+
+	private:
+		sl_bool _map(const MappedFileParam& param, sl_uint64 offset, sl_size size);
+
+		static void _unmap(void* base, sl_size sizeMapped, void* handle);
+
+		sl_bool _advise(MappedFileAdvice advice, void* start, sl_size size);
+
+		static sl_size _getGranularity();
+
+	private:
+		Ref<File> m_file;
+		MappedFileMode m_mode;
+		sl_uint64 m_offset;
+
+		void* m_data;
+		sl_size m_size;
+
+		// view aligned to the allocation granularity
+		void* m_base;
+		sl_size m_sizeMapped;
+		// file mapping object (Win32)
+		void* m_handle;
+		// unmaps the view on the last reference
+		Ref<_priv_MappedFile_View> m_view;
+
+		friend class _priv_MappedFile_View;
+
+	};
+
 	// FilePathSegments is not thread-safe
 	class SLIB_EXPORT FilePathSegments
 	{
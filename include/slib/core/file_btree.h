@@ -0,0 +1,194 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef CHECKHEADER_SLIB_CORE_FILE_BTREE
+#define CHECKHEADER_SLIB_CORE_FILE_BTREE
+
+#include "definition.h"
+
+#include <type_traits>
+
+#include "btree.h"
+#include "file.h"
+#include "flat_hash_map.h"
+
+#define SLIB_FILE_BTREE_DEFAULT_PAGE_SIZE 4096
+#define SLIB_FILE_BTREE_DEFAULT_CACHE_PAGES 4096
+
+/*
+	FileBTree stores the nodes of BTree in fixed-size pages of a file.
+
+	- Keys and values are stored by copying their memory, so KT and VT must be trivially copyable types.
+	- Recently used pages are kept in a page cache of `maxCachedPages`. When the modified pages fill the cache, they are
+	  written to the write-ahead log (`<path>.wal`) as uncommitted records, and are read back from the log until flush().
+	  The log grows until flush(), so the long bulk updates should call flush() periodically.
+	- flush() appends the rest of the modified pages and the trailer to the log and syncs it before updating the file,
+	  so the file is always restored to the last flush() after a crash (the log is replayed by open()).
+*/
+
+namespace slib
+{
+
+	class _priv_BTreePageFile_Page;
+
+	class SLIB_EXPORT BTreePageFile
+	{
+	public:
+		BTreePageFile();
+
+		~BTreePageFile();
+
+	public:
+		// `format` identifies the layout of the pages. Opening the existing file of different page size or format fails.
+		sl_bool open(const String& path, sl_uint32 pageSize, sl_uint64 format, sl_uint32 maxCachedPages = SLIB_FILE_BTREE_DEFAULT_CACHE_PAGES);
+
+		// commits the modified pages before closing
+		void close();
+
+		sl_bool isOpened() const;
+
+		sl_uint32 getPageSize() const;
+
+		sl_uint64 getPagesCount() const;
+
+		sl_uint64 getRootPage() const;
+
+		void setRootPage(sl_uint64 page);
+
+		// returned memory is valid until next call on this object
+		const sl_uint8* readPage(sl_uint64 page);
+
+		sl_bool writePage(sl_uint64 page, const void* data);
+
+		// returns 0 on failure (page 0 is the header)
+		sl_uint64 allocatePage();
+
+		void freePage(sl_uint64 page);
+
+		// writes the modified pages through the write-ahead log
+		sl_bool flush();
+
+	private:
+		BTreePageFile(const BTreePageFile& other) = delete;
+
+		BTreePageFile& operator=(const BTreePageFile& other) = delete;
+
+	private:
+		_priv_BTreePageFile_Page* _getPage(sl_uint64 page, sl_bool flagRead);
+
+		void _insertLru(_priv_BTreePageFile_Page* page);
+
+		void _removeLru(_priv_BTreePageFile_Page* page);
+
+		void _evictPages();
+
+		sl_bool _writeLogRecords();
+
+		sl_bool _replayLog();
+
+		sl_bool _writeHeader();
+
+		void _clearCache();
+
+	private:
+		Ref<File> m_file;
+		Ref<File> m_log;
+		sl_uint32 m_pageSize;
+		sl_uint64 m_format;
+		sl_uint64 m_countPages;
+		sl_uint64 m_pageRoot;
+		sl_uint64 m_pageFree;
+		sl_bool m_flagHeaderChanged;
+
+		FlatHashMap<sl_uint64, _priv_BTreePageFile_Page*> m_pages;
+		// clean pages, most recently used first
+		_priv_BTreePageFile_Page* m_lruFirst;
+		_priv_BTreePageFile_Page* m_lruLast;
+		sl_uint32 m_countLru;
+		sl_uint32 m_maxCachedPages;
+		List<_priv_BTreePageFile_Page*> m_dirtyPages;
+
+		// pages written to the log after the last flush: page index -> offset of the record in the log
+		FlatHashMap<sl_uint64, sl_uint64> m_loggedPages;
+		// end of the records in the log (0: the log is empty)
+		sl_uint64 m_sizeLog;
+		sl_uint64 m_countLogRecords;
+		sl_uint64 m_checksumLog;
+
+	};
+
+	template < class KT, class VT, class KEY_COMPARE = Compare<KT> >
+	class SLIB_EXPORT FileBTree : public BTree<KT, VT, KEY_COMPARE>
+	{
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ < 5
+		static_assert(__has_trivial_copy(KT) && __has_trivial_copy(VT), "FileBTree: KT and VT must be trivially copyable");
+#else
+		static_assert(std::is_trivially_copyable<KT>::value && std::is_trivially_copyable<VT>::value, "FileBTree: KT and VT must be trivially copyable");
+#endif
+
+	protected:
+		typedef typename BTree<KT, VT, KEY_COMPARE>::NodeData NodeData;
+
+	public:
+		FileBTree(sl_uint32 pageSize = SLIB_FILE_BTREE_DEFAULT_PAGE_SIZE);
+
+		FileBTree(const KEY_COMPARE& compare, sl_uint32 pageSize = SLIB_FILE_BTREE_DEFAULT_PAGE_SIZE);
+
+		~FileBTree();
+
+	public:
+		sl_bool open(const String& path, sl_uint32 maxCachedPages = SLIB_FILE_BTREE_DEFAULT_CACHE_PAGES);
+
+		void close();
+
+		sl_bool isOpened() const;
+
+		sl_bool flush();
+
+		static sl_uint32 getOrderForPageSize(sl_uint32 pageSize);
+
+	protected:
+		BTreeNode getRootNode() const override;
+
+		sl_bool setRootNode(BTreeNode node) override;
+
+		BTreeNode createNode(NodeData* data) override;
+
+		sl_bool deleteNode(BTreeNode node) override;
+
+		NodeData* readNodeData(const BTreeNode& node) const override;
+
+		sl_bool writeNodeData(const BTreeNode& node, NodeData* data) override;
+
+		void releaseNodeData(NodeData* data) override;
+
+	private:
+		NodeData* _newNodeData() const;
+
+		void _deleteNodeData(NodeData* data) const;
+
+		void _loadNodeData(NodeData* data, const sl_uint8* page) const;
+
+		void _storeNodeData(sl_uint8* page, const NodeData* data) const;
+
+	private:
+		sl_uint32 m_pageSize;
+		mutable BTreePageFile m_storage;
+		Memory m_bufPage;
+		// recycled node data
+		mutable List<NodeData*> m_nodeDataPool;
+
+	};
+
+}
+
+#include "detail/file_btree.inc"
+
+#endif
@@ -0,0 +1,171 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef CHECKHEADER_SLIB_CORE_FLAT_HASH_MAP
+#define CHECKHEADER_SLIB_CORE_FLAT_HASH_MAP
+
+#include "definition.h"
+
+#include "map_common.h"
+#include "hash.h"
+#include "compare.h"
+#include "list.h"
+
+/*
+	Open-addressing hash map storing the entries in one contiguous slot array.
+	Each slot has a control byte (7 bits of the hash, or empty/deleted mark), and the control bytes are probed by groups of 16.
+	Node pointers are invalidated when the table grows or shrinks.
+*/
+
+namespace slib
+{
+
+	template <class KT, class VT>
+	class FlatHashMapNode
+	{
+	public:
+		KT key;
+		VT value;
+
+	public:
+		template <class KEY, class... VALUE_ARGS>
+		FlatHashMapNode(KEY&& _key, VALUE_ARGS&&... value_args) noexcept;
+
+	};
+
+	template <class KT, class VT>
+	class SLIB_EXPORT FlatHashMapPosition
+	{
+	public:
+		typedef FlatHashMapNode<KT, VT> NODE;
+
+	public:
+		FlatHashMapPosition(const sl_int8* ctrl, const sl_int8* ctrl_end, NODE* node) noexcept;
+
+		FlatHashMapPosition(const FlatHashMapPosition& other) noexcept = default;
+
+	public:
+		FlatHashMapPosition& operator=(const FlatHashMapPosition& other) noexcept = default;
+
+		NODE& operator*() const noexcept;
+
+		sl_bool operator==(const FlatHashMapPosition& other) const noexcept;
+
+		sl_bool operator!=(const FlatHashMapPosition& other) const noexcept;
+
+		FlatHashMapPosition& operator++() noexcept;
+
+	public:
+		const sl_int8* ctrl;
+		const sl_int8* ctrl_end;
+		NODE* node;
+
+	};
+
+	template < class KT, class VT, class HASH = Hash<KT>, class KEY_COMPARE = Compare<KT> >
+	class SLIB_EXPORT FlatHashMap
+	{
+	public:
+		typedef FlatHashMapNode<KT, VT> NODE;
+
+	public:
+		FlatHashMap(sl_size capacity = 0, const HASH& hash = HASH(), const KEY_COMPARE& compare = KEY_COMPARE()) noexcept;
+
+		FlatHashMap(const FlatHashMap& other) = delete;
+
+		FlatHashMap(FlatHashMap&& other) noexcept;
+
+		~FlatHashMap() noexcept;
+
+	public:
+		FlatHashMap& operator=(const FlatHashMap& other) = delete;
+
+		FlatHashMap& operator=(FlatHashMap&& other) noexcept;
+
+	public:
+		sl_size getCount() const noexcept;
+
+		sl_bool isEmpty() const noexcept;
+
+		sl_bool isNotEmpty() const noexcept;
+
+		// number of slots
+		sl_size getCapacity() const noexcept;
+
+		// prepares the slots to hold `count` items without rehashing
+		sl_bool reserve(sl_size count) noexcept;
+
+		NODE* find(const KT& key) const noexcept;
+
+		VT* getItemPointer(const KT& key) const noexcept;
+
+		sl_bool get(const KT& key, VT* outValue = sl_null) const noexcept;
+
+		VT getValue(const KT& key) const noexcept;
+
+		VT getValue(const KT& key, const VT& def) const noexcept;
+
+		template <class KEY, class VALUE>
+		NODE* put(KEY&& key, VALUE&& value, sl_bool* isInsertion = sl_null) noexcept;
+
+		template <class KEY, class VALUE>
+		NODE* replace(const KEY& key, VALUE&& value) noexcept;
+
+		template <class KEY, class... VALUE_ARGS>
+		MapEmplaceReturn<NODE> emplace(KEY&& key, VALUE_ARGS&&... value_args) noexcept;
+
+		sl_bool removeAt(const NODE* node) noexcept;
+
+		sl_bool remove(const KT& key, VT* outValue = sl_null) noexcept;
+
+		sl_size removeAll() noexcept;
+
+		void shrink() noexcept;
+
+		sl_bool copyFrom(const FlatHashMap<KT, VT, HASH, KEY_COMPARE>& other) noexcept;
+
+		List<KT> getAllKeys() const noexcept;
+
+		List<VT> getAllValues() const noexcept;
+
+		// range-based for loop
+		FlatHashMapPosition<KT, VT> begin() const noexcept;
+
+		FlatHashMapPosition<KT, VT> end() const noexcept;
+
+	private:
+		sl_size _hash(const KT& key) const noexcept;
+
+		NODE* _find(const KT& key, sl_size hash) const noexcept;
+
+		sl_size _prepareInsert(sl_size hash) noexcept;
+
+		sl_bool _rehash(sl_size capacity) noexcept;
+
+		void _free() noexcept;
+
+	private:
+		// `capacity + 16` control bytes, the last 16 bytes mirror the first 16 bytes
+		sl_int8* m_ctrl;
+		NODE* m_slots;
+		sl_size m_capacity;
+		sl_size m_count;
+		// number of slots that can be filled (including deleted marks) before rehashing
+		sl_size m_growthLeft;
+		HASH m_hashFunc;
+		KEY_COMPARE m_compare;
+
+	};
+
+}
+
+#include "detail/flat_hash_map.inc"
+
+#endif
@@ -57,12 +57,28 @@ namespace slib
 #endif
 	}
 	
+	/*
+		HashBytes32/HashBytes64 (wyhash): fixed result for the same seed on the same platform.
+		HashBytes: seeded by `GetHashSeed()`, for the hash tables (e.g. `Hash<String>`).
+		HashBytesFNV32/HashBytesFNV64 (FNV-1a): the previous implementation, for the hashes stored persistently.
+	*/
 	sl_uint32 HashBytes32(const void* buf, sl_size n) noexcept;
-	
+
+	sl_uint32 HashBytes32(const void* buf, sl_size n, sl_uint64 seed) noexcept;
+
 	sl_uint64 HashBytes64(const void* buf, sl_size n) noexcept;
-	
+
+	sl_uint64 HashBytes64(const void* buf, sl_size n, sl_uint64 seed) noexcept;
+
 	sl_size HashBytes(const void* buf, sl_size n) noexcept;
 
+	sl_uint32 HashBytesFNV32(const void* buf, sl_size n) noexcept;
+
+	sl_uint64 HashBytesFNV64(const void* buf, sl_size n) noexcept;
+
+	// random per process against hash flooding. defining `SLIB_HASH_NO_SEED` (library build) fixes it to 0, for the reproducible hash codes and orders
+	sl_uint64 GetHashSeed() noexcept;
+
 	template <>
 	class Hash<char>
 	{
@@ -16,6 +16,8 @@
 #include "object.h"
 #include "memory.h"
 #include "time.h"
+#include "ptr.h"
+#include "mio.h"
 
 #include "../math/bigint.h"
 
@@ -439,6 +441,229 @@ namespace slib
 	
 	};
 	
+	/*
+		BufferedReader and BufferedWriter read and write the underlying stream in the large chunks.
+		The fixed-size and CVLI reads/writes are inlined and access the buffer directly when they are called on
+		`BufferedReader`/`BufferedWriter` (not through `IReader`/`IWriter`), and call the stream only when the buffer is empty or full.
+		They are not thread-safe.
+	*/
+	class SLIB_EXPORT BufferedReader : public Object, public IReader, public ISeekable, public IClosable
+	{
+		SLIB_DECLARE_OBJECT
+
+	public:
+		BufferedReader();
+
+		~BufferedReader();
+
+	public:
+		// `bufferSize`: 0 for the default size (64KB)
+		static Ref<BufferedReader> create(const Ptr<IReader>& reader, sl_size bufferSize = 0);
+
+		// `seekable` should be the same stream as `reader`. `seek()` within the buffer does not seek the stream
+		static Ref<BufferedReader> create(const Ptr<IReader>& reader, const Ptr<ISeekable>& seekable, sl_size bufferSize = 0);
+
+		static Ref<BufferedReader> openFile(const String& filePath, sl_size bufferSize = 0);
+
+	public:
+		sl_reg read(void* buf, sl_size size) override;
+
+		sl_int32 read32(void* buf, sl_uint32 size) override;
+
+		// returns the position in the stream of the next byte to read
+		sl_uint64 getPosition() override;
+
+		// returns 0 if the stream is not seekable
+		sl_uint64 getSize() override;
+
+		// skips forward by reading the stream if it is not seekable
+		sl_bool seek(sl_int64 offset, SeekPosition pos) override;
+
+		void close() override;
+
+		// returns the line without the line break (CR, LF or CRLF). returns null at the end of the stream
+		String readLine();
+
+	public:
+		sl_bool readInt8(sl_int8* output);
+
+		sl_int8 readInt8(sl_int8 def = 0);
+
+		sl_bool readUint8(sl_uint8* output);
+
+		sl_uint8 readUint8(sl_uint8 def = 0);
+
+		sl_bool readInt16(sl_int16* output, sl_bool flagBigEndian = sl_false);
+
+		sl_int16 readInt16(sl_int16 def = 0, sl_bool flagBigEndian = sl_false);
+
+		sl_bool readUint16(sl_uint16* output, sl_bool flagBigEndian = sl_false);
+
+		sl_uint16 readUint16(sl_uint16 def = 0, sl_bool flagBigEndian = sl_false);
+
+		sl_bool readInt32(sl_int32* output, sl_bool flagBigEndian = sl_false);
+
+		sl_int32 readInt32(sl_int32 def = 0, sl_bool flagBigEndian = sl_false);
+
+		sl_bool readUint32(sl_uint32* output, sl_bool flagBigEndian = sl_false);
+
+		sl_uint32 readUint32(sl_uint32 def = 0, sl_bool flagBigEndian = sl_false);
+
+		sl_bool readInt64(sl_int64* output, sl_bool flagBigEndian = sl_false);
+
+		sl_int64 readInt64(sl_int64 def = 0, sl_bool flagBigEndian = sl_false);
+
+		sl_bool readUint64(sl_uint64* output, sl_bool flagBigEndian = sl_false);
+
+		sl_uint64 readUint64(sl_uint64 def = 0, sl_bool flagBigEndian = sl_false);
+
+		sl_bool readFloat(float* output, sl_bool flagBigEndian = sl_false);
+
+		float readFloat(float def = 0, sl_bool flagBigEndian = sl_false);
+
+		sl_bool readDouble(double* output, sl_bool flagBigEndian = sl_false);
+
+		double readDouble(double def = 0, sl_bool flagBigEndian = sl_false);
+
+		sl_bool readUint32CVLI(sl_uint32* output);
+
+		sl_uint32 readUint32CVLI(sl_uint32 def = 0);
+
+		sl_bool readInt32CVLI(sl_int32* output);
+
+		sl_int32 readInt32CVLI(sl_int32 def = 0);
+
+		sl_bool readUint64CVLI(sl_uint64* output);
+
+		sl_uint64 readUint64CVLI(sl_uint64 def = 0);
+
+		sl_bool readInt64CVLI(sl_int64* output);
+
+		sl_int64 readInt64CVLI(sl_int64 def = 0);
+
+		sl_bool readSizeCVLI(sl_size* output);
+
+		sl_size readSizeCVLI(sl_size def = 0);
+
+	protected:
+		sl_bool _init(const Ptr<IReader>& reader, const Ptr<ISeekable>& seekable, sl_size bufferSize);
+
+		// returns the pointer to `size` bytes in the buffer, and moves the position. returns null at the end of the stream
+		const sl_uint8* _read(sl_size size);
+
+		// fills the buffer to have `size` bytes available (`size` <= buffer size)
+		sl_bool _prepare(sl_size size);
+
+		// reads the stream into the free space of the buffer. returns sl_false at the end of the stream
+		sl_bool _fill();
+
+		sl_bool _readUint32CVLI(sl_uint32* output);
+
+		sl_bool _readUint64CVLI(sl_uint64* output);
+
+	protected:
+		Ptr<IReader> m_reader;
+		Ptr<ISeekable> m_seekable;
+
+		Memory m_buffer;
+		sl_uint8* m_buf;
+		sl_size m_sizeBuffer;
+		// unread data: [m_pos, m_end)
+		sl_uint8* m_pos;
+		sl_uint8* m_end;
+		// position of `m_end` in the stream
+		sl_uint64 m_positionEnd;
+
+	};
+
+	class SLIB_EXPORT BufferedWriter : public Object, public IWriter, public IClosable
+	{
+		SLIB_DECLARE_OBJECT
+
+	public:
+		BufferedWriter();
+
+		// flushes the buffer
+		~BufferedWriter();
+
+	public:
+		// `bufferSize`: 0 for the default size (64KB)
+		static Ref<BufferedWriter> create(const Ptr<IWriter>& writer, sl_size bufferSize = 0);
+
+		static Ref<BufferedWriter> openFile(const String& filePath, sl_size bufferSize = 0);
+
+		static Ref<BufferedWriter> openFileForAppend(const String& filePath, sl_size bufferSize = 0);
+
+	public:
+		// returns -1 on error. the data is written to the buffer if it fits
+		sl_reg write(const void* buf, sl_size size) override;
+
+		sl_int32 write32(const void* buf, sl_uint32 size) override;
+
+		// writes the buffered data to the stream
+		sl_bool flush();
+
+		// flushes the buffer, and releases the stream
+		void close() override;
+
+		// bytes written to this writer, including the buffered data
+		sl_uint64 getWrittenSize();
+
+	public:
+		sl_bool writeInt8(sl_int8 value);
+
+		sl_bool writeUint8(sl_uint8 value);
+
+		sl_bool writeInt16(sl_int16 value, sl_bool flagBigEndian = sl_false);
+
+		sl_bool writeUint16(sl_uint16 value, sl_bool flagBigEndian = sl_false);
+
+		sl_bool writeInt32(sl_int32 value, sl_bool flagBigEndian = sl_false);
+
+		sl_bool writeUint32(sl_uint32 value, sl_bool flagBigEndian = sl_false);
+
+		sl_bool writeInt64(sl_int64 value, sl_bool flagBigEndian = sl_false);
+
+		sl_bool writeUint64(sl_uint64 value, sl_bool flagBigEndian = sl_false);
+
+		sl_bool writeFloat(float value, sl_bool flagBigEndian = sl_false);
+
+		sl_bool writeDouble(double value, sl_bool flagBigEndian = sl_false);
+
+		sl_bool writeUint32CVLI(sl_uint32 value);
+
+		sl_bool writeInt32CVLI(sl_int32 value);
+
+		sl_bool writeUint64CVLI(sl_uint64 value);
+
+		sl_bool writeInt64CVLI(sl_int64 value);
+
+		sl_bool writeSizeCVLI(sl_size value);
+
+	protected:
+		sl_bool _init(const Ptr<IWriter>& writer, sl_size bufferSize);
+
+		// returns the pointer to the free space of `size` bytes in the buffer (`size` <= buffer size). returns null on error
+		sl_uint8* _prepare(sl_size size);
+
+		sl_bool _flush();
+
+	protected:
+		Ptr<IWriter> m_writer;
+
+		Memory m_buffer;
+		sl_uint8* m_buf;
+		sl_size m_sizeBuffer;
+		// buffered data: [m_buf, m_pos)
+		sl_uint8* m_pos;
+		sl_uint8* m_end;
+		// bytes written to the stream
+		sl_uint64 m_sizeWritten;
+
+	};
+	
 }
 
+#include "detail/io.inc"
+
 #endif
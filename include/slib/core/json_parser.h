@@ -0,0 +1,345 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef CHECKHEADER_SLIB_CORE_JSON_PARSER
+#define CHECKHEADER_SLIB_CORE_JSON_PARSER
+
+#include "definition.h"
+
+#include "json.h"
+#include "object.h"
+#include "memory.h"
+#include "function.h"
+
+/*
+	Streaming JSON parser and read-only JSON document
+ ------------------------------------------------------
+
+ JsonParser is a push (SAX) parser: the document can be fed in the chunks of any size,
+ and the events are sent to `IJsonParseListener` without building any `Json` value.
+ The parser keeps only the incomplete token at the end of a chunk, so the memory usage
+ does not depend on the document size.
+
+ JsonDocument is a read-only DOM built on the parser. The values are stored in the arena
+ of the document, the elements and the members are stored in the flat arrays in the order
+ of the source, and the strings without escapes refer to the source memory.
+
+ Both accept the same syntax as `Json::parseJson()`: the comments (optional),
+ the single-quoted strings, the unquoted keys and the empty elements (parsed as null).
+
+*/
+
+namespace slib
+{
+
+	class JsonParser;
+	class IReader;
+	class AsyncStream;
+	struct AsyncStreamResult;
+
+	class SLIB_EXPORT IJsonParseListener
+	{
+	public:
+		IJsonParseListener();
+
+		virtual ~IJsonParseListener();
+
+	public:
+		virtual void onStartObject(JsonParser* parser);
+
+		virtual void onEndObject(JsonParser* parser);
+
+		virtual void onStartArray(JsonParser* parser);
+
+		virtual void onEndArray(JsonParser* parser);
+
+		// `key` (UTF-8, not null-terminated) is valid only in the callback
+		virtual void onKey(JsonParser* parser, const sl_char8* key, sl_size len);
+
+		// `value` (UTF-8, not null-terminated) is valid only in the callback
+		virtual void onString(JsonParser* parser, const sl_char8* value, sl_size len);
+
+		virtual void onInt64(JsonParser* parser, sl_int64 value);
+
+		// the numbers with fraction or exponent, and the integers out of `sl_int64` range
+		virtual void onDouble(JsonParser* parser, double value);
+
+		virtual void onBoolean(JsonParser* parser, sl_bool value);
+
+		virtual void onNull(JsonParser* parser);
+
+	};
+
+	class SLIB_EXPORT JsonParserParam
+	{
+	public:
+		IJsonParseListener* listener;
+
+		sl_bool flagSupportComments; // default: true
+
+		// accepts the sequence of the values at top level (e.g. JSON Lines)
+		sl_bool flagMultipleValues; // default: false
+
+		// bytes read at once from `IReader` and `AsyncStream`
+		sl_uint32 chunkSize; // default: 64KB
+
+		sl_bool flagLogError; // default: true
+
+	public:
+		JsonParserParam();
+
+		~JsonParserParam();
+
+	};
+
+	class SLIB_EXPORT JsonParser : public Object
+	{
+		SLIB_DECLARE_OBJECT
+
+	protected:
+		JsonParser();
+
+		~JsonParser();
+
+	public:
+		static Ref<JsonParser> create(const JsonParserParam& param);
+
+	public:
+		// parses the chunk, and keeps the incomplete token at the end for the next chunk. returns `sl_false` on error or stop
+		sl_bool feed(const void* data, sl_size size);
+
+		// ends the stream, and checks that the document is complete
+		sl_bool finish();
+
+		// parses the whole content at once (`finish()` is called)
+		sl_bool parse(const void* data, sl_size size);
+
+		// reads and parses the stream until the end (`finish()` is called)
+		sl_bool parse(IReader* reader);
+
+		sl_bool parseFile(const String& filePath);
+
+		// `onComplete` is called after the stream is read and parsed to the end, or on error or stop
+		sl_bool parseAsync(const Ref<AsyncStream>& stream, const Function<void(JsonParser*)>& onComplete);
+
+		// stops the parsing. can be called in the listener
+		void stop();
+
+		void reset();
+
+		sl_bool isStopped();
+
+		sl_bool isError();
+
+		String getErrorMessage();
+
+		// offset of the error in the stream
+		sl_uint64 getErrorPosition();
+
+		String getErrorText();
+
+		// count of the containers enclosing the current event
+		sl_size getDepth();
+
+	protected:
+		sl_size _parse(const sl_char8* buf, sl_size len, sl_bool flagEnd);
+
+		sl_bool _finish();
+
+		sl_bool _pushContainer(sl_uint8 type);
+
+		void _setError(const char* message, sl_size offset);
+
+		sl_bool _reserveBuffer(Memory& mem, sl_size size, sl_size sizeKeep);
+
+		sl_bool _shiftPending(sl_size sizeConsumed);
+
+		void _onReadStream(AsyncStreamResult* result, const Function<void(JsonParser*)>& onComplete);
+
+	protected:
+		IJsonParseListener* m_listener;
+		sl_bool m_flagSupportComments;
+		sl_bool m_flagMultipleValues;
+		sl_uint32 m_chunkSize;
+		sl_bool m_flagLogError;
+
+		sl_uint32 m_state;
+		// container types (object/array) from the outermost
+		Memory m_stack;
+		sl_size m_depth;
+
+		// the incomplete token of the previous chunk, and the chunks read from streams
+		Memory m_pending;
+		sl_size m_sizePending;
+		// offset of the parsing buffer in the stream
+		sl_uint64 m_offsetBuffer;
+		// bytes of the incomplete token which are already scanned
+		sl_size m_sizeScanned;
+		sl_bool m_flagScannedEscapes;
+
+		// unescaped strings
+		Memory m_bufString;
+
+		sl_bool m_flagStop;
+		sl_bool m_flagError;
+		String m_errorMessage;
+		sl_uint64 m_errorPosition;
+
+	};
+
+
+	enum class JsonValueType
+	{
+		Null = 0,
+		Boolean = 1,
+		Int64 = 2,
+		Double = 3,
+		String = 4,
+		Array = 5,
+		Object = 6
+	};
+
+	// storage of a value in `JsonDocument`
+	struct SLIB_EXPORT JsonNode
+	{
+		sl_uint32 type;
+		// length of the string, count of the elements or the members
+		sl_uint32 count;
+		union {
+			sl_bool boolean;
+			sl_int64 int64;
+			double real;
+			const sl_char8* string;
+			// elements, or the pairs of the key (string) and the value
+			const JsonNode* children;
+		};
+	};
+
+	// view of a value in `JsonDocument`, valid while the document is alive
+	class SLIB_EXPORT JsonValue
+	{
+	public:
+		JsonValue();
+
+		JsonValue(const JsonNode* node);
+
+	public:
+		JsonValueType getType() const;
+
+		sl_bool isNull() const;
+
+		sl_bool isBoolean() const;
+
+		sl_bool isInt64() const;
+
+		sl_bool isNumber() const;
+
+		sl_bool isString() const;
+
+		sl_bool isArray() const;
+
+		sl_bool isObject() const;
+
+		sl_bool getBoolean(sl_bool def = sl_false) const;
+
+		sl_int32 getInt32(sl_int32 def = 0) const;
+
+		sl_int64 getInt64(sl_int64 def = 0) const;
+
+		double getDouble(double def = 0) const;
+
+		// UTF-8, not null-terminated
+		const sl_char8* getStringData() const;
+
+		sl_size getStringLength() const;
+
+		sl_bool equalsString(const sl_char8* str, sl_size len) const;
+
+		String getString() const;
+
+		// count of the elements or the members
+		sl_size getCount() const;
+
+		JsonValue getElement(sl_size index) const;
+
+		JsonValue getKey(sl_size index) const;
+
+		JsonValue getValue(sl_size index) const;
+
+		// returns the first member of the key (linear search)
+		JsonValue getItem(const sl_char8* key, sl_size len) const;
+
+		JsonValue getItem(const String& key) const;
+
+		JsonValue operator[](sl_size index) const;
+
+		JsonValue operator[](const String& key) const;
+
+		Json toJson() const;
+
+	protected:
+		const JsonNode* m_node;
+
+	};
+
+	class SLIB_EXPORT JsonDocument : public Object
+	{
+		SLIB_DECLARE_OBJECT
+
+	protected:
+		JsonDocument();
+
+		~JsonDocument();
+
+	public:
+		// the strings refer to `content`
+		static Ref<JsonDocument> parse(const Memory& content, JsonParseParam& param);
+
+		static Ref<JsonDocument> parse(const Memory& content);
+
+		static Ref<JsonDocument> parse(const String& json, JsonParseParam& param);
+
+		static Ref<JsonDocument> parse(const String& json);
+
+		// copies the content
+		static Ref<JsonDocument> parse(const void* data, sl_size size, JsonParseParam& param);
+
+		static Ref<JsonDocument> parse(const void* data, sl_size size);
+
+		static Ref<JsonDocument> parseFile(const String& filePath, JsonParseParam& param);
+
+		static Ref<JsonDocument> parseFile(const String& filePath);
+
+	public:
+		JsonValue getRoot();
+
+		// bytes allocated for the values and the unescaped strings
+		sl_size getArenaSize();
+
+	protected:
+		void* _allocate(sl_size size);
+
+	protected:
+		Memory m_source;
+		String m_sourceString;
+		JsonNode m_root;
+
+		List<Memory> m_blocks;
+		sl_uint8* m_posBlock;
+		sl_size m_sizeBlockRemain;
+		sl_size m_sizeArena;
+
+		friend class _priv_JsonDocument_Builder;
+
+	};
+
+}
+
+#endif
@@ -22,6 +22,8 @@ namespace slib
 {
 
 	class LoggerSet;
+	class Thread;
+	class File;
 	
 	class SLIB_EXPORT Console
 	{
@@ -63,6 +65,8 @@ namespace slib
 
 		static Ref<Logger> createFileLogger(const String& fileName);
 
+		static Ref<Logger> createAsyncFileLogger(const String& fileName);
+
 		static void logGlobal(const String& tag, const String& content);
 
 		static void logGlobalError(const String& tag, const String& content);
@@ -86,6 +90,82 @@ namespace slib
 	
 	};
 	
+	enum class LogOverflowPolicy
+	{
+		// discards the new lines while the buffer is full
+		Drop = 0,
+		// waits until the flusher makes a room
+		Block = 1
+	};
+	
+	class SLIB_EXPORT AsyncFileLoggerParam
+	{
+	public:
+		String fileName;
+		
+		sl_uint32 bufferSize; // maximum count of pending lines (rounded up to power of 2), default: 8192
+		LogOverflowPolicy overflowPolicy; // default: Drop
+		sl_uint32 flushInterval; // milliseconds, default: 500
+		
+		// rotation: "file" is moved to "file.1", "file.1" to "file.2", ...
+		sl_uint64 maxFileSize; // bytes, 0 means no size-based rotation. default: 0
+		sl_uint32 rotationInterval; // seconds, 0 means no time-based rotation. default: 0
+		sl_uint32 maxBackupFilesCount; // default: 5
+		
+	public:
+		AsyncFileLoggerParam();
+		
+		~AsyncFileLoggerParam();
+		
+	};
+	
+	class _priv_AsyncFileLogger_Queue;
+	
+	class SLIB_EXPORT AsyncFileLogger : public Logger
+	{
+		SLIB_DECLARE_OBJECT
+		
+	protected:
+		AsyncFileLogger();
+		
+		~AsyncFileLogger();
+		
+	public:
+		static Ref<AsyncFileLogger> create(const AsyncFileLoggerParam& param);
+		
+	public:
+		void log(const String& tag, const String& content) override;
+		
+		// waits until the lines logged before this call are written
+		void flush();
+		
+		// stops the flusher after writing the pending lines. The lines logged after this call are written synchronously
+		void release();
+		
+		sl_uint64 getDroppedLinesCount();
+		
+	protected:
+		void _run();
+		
+		// pops and writes the pending lines, called in the object lock
+		void _writeQueue();
+		
+		sl_bool _openFile();
+		
+		void _rotate();
+		
+		void _write(const String& text);
+		
+	protected:
+		AsyncFileLoggerParam m_param;
+		_priv_AsyncFileLogger_Queue* m_queue;
+		Ref<Thread> m_thread;
+		Ref<File> m_file;
+		sl_uint64 m_sizeFile;
+		sl_uint64 m_timeFileOpened;
+		
+	};
+	
 	class SLIB_EXPORT LoggerSet : public Logger
 	{
 	public:
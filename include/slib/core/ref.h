@@ -385,18 +385,59 @@ namespace slib
 
 		void _replaceObject(T* other) noexcept;
 
+		static void _releaseObject(void* object) noexcept;
+
 		void _move_init(void* other) noexcept;
 
 		void _move_assign(void* other) noexcept;
 
 	public:
 		T* _ptr;
-	private:
-		SpinLock m_lock;
 	
 	};
 
 	
+	/*
+		Reads the object of `Atomic< Ref<T> >` without increasing its reference count.
+		The object is published as the hazard pointer of the current thread, so the writers replacing it keep their
+		reference in the retired list until this borrower is destroyed. Keep it on the stack for a short read.
+		Holds a reference instead when the thread borrows more than 3 objects at once.
+	*/
+	template <class T>
+	class SLIB_EXPORT BorrowedRef
+	{
+	public:
+		BorrowedRef(const AtomicRef<T>& ref) noexcept;
+
+		~BorrowedRef() noexcept;
+
+	public:
+		T* get() const noexcept;
+
+		sl_bool isNull() const noexcept;
+
+		sl_bool isNotNull() const noexcept;
+
+	public:
+		T& operator*() const noexcept;
+
+		T* operator->() const noexcept;
+
+		explicit operator sl_bool() const noexcept;
+
+	private:
+		BorrowedRef(const BorrowedRef& other) = delete;
+
+		BorrowedRef& operator=(const BorrowedRef& other) = delete;
+
+	private:
+		T* m_ptr;
+		// 0: not borrowed (null, or holding a reference)
+		sl_uint32 m_slot;
+
+	};
+
+	
 	template <class T>
 	class SLIB_EXPORT WeakRef
 	{
@@ -74,6 +74,8 @@ namespace slib
 	};
 	
 #define SLIB_SPINLOCK_POOL_SIZE 971
+// each lock of the pool takes a cache line (64 bytes), so the unrelated objects do not share the line
+#define SLIB_SPINLOCK_POOL_STRIDE 16
 	
 	template <int CATEGORY>
 	class SLIB_EXPORT SpinLockPool
@@ -82,7 +84,7 @@ namespace slib
 		static SpinLock* get(const void* ptr) noexcept;
 
 	private:
-		static sl_int32 m_locks[SLIB_SPINLOCK_POOL_SIZE];
+		static sl_int32 m_locks[SLIB_SPINLOCK_POOL_SIZE * SLIB_SPINLOCK_POOL_STRIDE];
 
 	};
 
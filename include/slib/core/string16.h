@@ -1210,7 +1210,6 @@ namespace slib
 	{
 	private:
 		StringContainer16* volatile m_container;
-		SpinLock m_lock;
 		
 	public:
 		
@@ -1223,7 +1223,6 @@ namespace slib
 	{
 	private:
 		StringContainer* volatile m_container;
-		SpinLock m_lock;
 		
 	public:
 		/**
@@ -16,10 +16,14 @@
 #include "queue.h"
 #include "thread.h"
 #include "dispatch.h"
+#include "list.h"
 
 namespace slib
 {
 	
+	class _priv_ThreadPool_StealingContext;
+	class _priv_ThreadPool_TimerWheel;
+	
 	class SLIB_EXPORT ThreadPool : public Dispatcher
 	{
 		SLIB_DECLARE_OBJECT
@@ -31,15 +35,24 @@ namespace slib
 
 	public:
 		static Ref<ThreadPool> create(sl_uint32 minThreads = 0, sl_uint32 maxThreads = 30);
+		
+		// runs fixed workers owning lock-free local deques, and idle workers steal tasks from their peers. `nThreads = 0` means the number of processors
+		static Ref<ThreadPool> createWorkStealing(sl_uint32 nThreads = 0);
 	
 	public:
 		void release();
 
 		sl_bool isRunning();
+		
+		sl_bool isWorkStealing();
 
 		sl_uint32 getThreadsCount();
 	
 		sl_bool addTask(const Function<void()>& task);
+		
+		sl_bool addTasks(const Function<void()>* tasks, sl_size count);
+		
+		sl_bool addTasks(const List< Function<void()> >& tasks);
 
 		sl_bool dispatch(const Function<void()>& callback, sl_uint64 delay_ms = 0) override;
 	
@@ -50,6 +63,13 @@ namespace slib
 	
 	protected:
 		void onRunWorker();
+		
+		void onRunStealingWorker(sl_uint32 index);
+		
+	protected:
+		sl_bool _addTask_NoLock(const Function<void()>& task);
+		
+		sl_bool _addTasksStealing(const Function<void()>* tasks, sl_size count);
 	
 	protected:
 		CList< Ref<Thread> > m_threadWorkers;
@@ -57,6 +77,9 @@ namespace slib
 		LinkedQueue< Function<void()> > m_tasks;
 
 		sl_bool m_flagRunning;
+		
+		_priv_ThreadPool_StealingContext* m_stealing;
+		_priv_ThreadPool_TimerWheel* m_timerWheel;
 
 	};
 
@@ -20,7 +20,7 @@
  XML 1.1 => http://www.w3.org/TR/2006/REC-xml11-20060816/
  
  
- Supports DOM & SAX parsers
+ Supports DOM & SAX parsers, and the pull parser (XmlReader) for the streams
  
 ************************************************************/
 
@@ -28,6 +28,9 @@
 
 #include "variant.h"
 #include "ptr.h"
+#include "object.h"
+#include "memory.h"
+#include "function.h"
 
 namespace slib
 {
@@ -40,6 +43,9 @@ namespace slib
 	class XmlComment;
 	class XmlParseControl;
 	class StringBuffer;
+	class IReader;
+	class AsyncStream;
+	struct AsyncStreamResult;
 	
 	enum class XmlNodeType
 	{
@@ -701,6 +707,205 @@ namespace slib
 
 	};
 
+
+	enum class XmlReaderEvent
+	{
+		// no complete event in the fed data (feeding mode)
+		NeedMoreData = 0,
+		StartElement = 1,
+		EndElement = 2,
+		Text = 3,
+		CDATA = 4,
+		Comment = 5,
+		ProcessingInstruction = 6,
+		DocumentType = 7,
+		EndDocument = 8,
+		Error = 9
+	};
+
+	// UTF-8 view into the buffer of `XmlReader`, valid until the next `read()`. not null-terminated
+	class SLIB_EXPORT XmlReaderString
+	{
+	public:
+		const sl_char8* data;
+		sl_size length;
+
+	public:
+		sl_bool isEmpty() const;
+
+		sl_bool equals(const sl_char8* str, sl_size len) const;
+
+		sl_bool equals(const String& str) const;
+
+		String toString() const;
+
+	};
+
+	class SLIB_EXPORT XmlReaderAttribute
+	{
+	public:
+		XmlReaderString name;
+		XmlReaderString value;
+
+	};
+
+	class SLIB_EXPORT XmlReaderParam
+	{
+	public:
+		// bytes read at once from the stream
+		sl_uint32 chunkSize; // default: 64KB
+
+		// limit of a single token (tag, text, comment, ...), which bounds the memory usage
+		sl_size maxTokenSize; // default: 16MB
+
+		sl_bool flagLogError; // default: true
+
+	public:
+		XmlReaderParam();
+
+		~XmlReaderParam();
+
+	};
+
+	/*
+		XmlReader is a pull parser reading the document in the chunks.
+		Only the current token is kept in the memory, and the names, attributes and texts
+		of the current event are returned as the views into the reading buffer.
+
+		The texts are trimmed and the entities are decoded, like `Xml::parseXml()`.
+		An empty-element tag (<a/>) yields `StartElement` and `EndElement`.
+		The namespaces are not processed: the names contain the prefixes.
+	*/
+	class SLIB_EXPORT XmlReader : public Object
+	{
+		SLIB_DECLARE_OBJECT
+
+	protected:
+		XmlReader();
+
+		~XmlReader();
+
+	public:
+		static Ref<XmlReader> create(const Ptr<IReader>& reader, const XmlReaderParam& param);
+
+		static Ref<XmlReader> create(const Ptr<IReader>& reader);
+
+		static Ref<XmlReader> openFile(const String& filePath, const XmlReaderParam& param);
+
+		static Ref<XmlReader> openFile(const String& filePath);
+
+		// feeding mode: the data is given by `feed()` or `feedAsync()`
+		static Ref<XmlReader> create(const XmlReaderParam& param);
+
+		static Ref<XmlReader> create();
+
+	public:
+		// returns the next event. in feeding mode, returns `NeedMoreData` when the fed data is consumed
+		XmlReaderEvent read();
+
+		// fails when the incomplete token left by `read()` reaches `maxTokenSize`
+		sl_bool feed(const void* data, sl_size size);
+
+		// the end of the data in feeding mode
+		void finish();
+
+		// reads the next chunk from `stream` in feeding mode. `read()` can be called in `onReady` until `NeedMoreData` is returned
+		sl_bool feedAsync(const Ref<AsyncStream>& stream, const Function<void(XmlReader*)>& onReady);
+
+		XmlReaderEvent getEvent();
+
+		// element name, or the target of the processing instruction
+		const XmlReaderString& getName();
+
+		// text, CDATA, comment, content of the processing instruction or the document type
+		const XmlReaderString& getText();
+
+		sl_bool isEmptyElement();
+
+		sl_size getAttributesCount();
+
+		const XmlReaderAttribute& getAttribute(sl_size index);
+
+		// returns an empty view if not found
+		XmlReaderString getAttribute(const String& name);
+
+		// count of the open elements, including the current start element
+		sl_size getDepth();
+
+		// offset of the current event in the stream
+		sl_uint64 getPosition();
+
+		sl_bool isError();
+
+		String getErrorMessage();
+
+		sl_uint64 getErrorPosition();
+
+		String getErrorText();
+
+	protected:
+		XmlReaderEvent _parse();
+
+		XmlReaderEvent _parseElement(sl_size posStart);
+
+		XmlReaderEvent _parseEndElement(sl_size posStart);
+
+		XmlReaderEvent _parseMarkup(sl_size posStart);
+
+		XmlReaderEvent _parseText(sl_size posStart);
+
+		sl_bool _findTerminator(sl_size posStart, sl_size posSearch, const char* terminator, sl_size lenTerminator, sl_size& posFound);
+
+		sl_bool _decodeEntities(sl_char8* s, sl_size len, sl_size& lenOutput);
+
+		sl_bool _pushName(const sl_char8* name, sl_size len);
+
+		sl_bool _readMore();
+
+		sl_bool _prepareSpace();
+
+		XmlReaderEvent _setError(const String& message, sl_size pos);
+
+		void _onReadStream(AsyncStreamResult* result, const Function<void(XmlReader*)>& onReady);
+
+	protected:
+		Ptr<IReader> m_reader;
+		sl_uint32 m_chunkSize;
+		sl_size m_maxTokenSize;
+		sl_bool m_flagLogError;
+
+		Memory m_buffer;
+		sl_char8* m_buf;
+		sl_size m_sizeBuffer;
+		// unconsumed data: [m_pos, m_end)
+		sl_size m_pos;
+		sl_size m_end;
+		sl_bool m_flagEndOfInput;
+		// offset of `m_buf` in the stream
+		sl_uint64 m_offsetBuffer;
+		// bytes of the incomplete token which are already scanned
+		sl_size m_sizeScanned;
+
+		// names of the open elements
+		Memory m_stackNames;
+		sl_size m_sizeStackNames;
+		Memory m_stackOffsets;
+		sl_size m_depth;
+		sl_bool m_flagPendingEndElement;
+
+		XmlReaderEvent m_event;
+		sl_uint64 m_positionEvent;
+		XmlReaderString m_name;
+		XmlReaderString m_text;
+		sl_bool m_flagEmptyElement;
+		Memory m_attributes;
+		sl_size m_nAttributes;
+
+		String m_errorMessage;
+		sl_uint64 m_errorPosition;
+
+	};
+
 }
 
 #endif
@@ -23,6 +23,8 @@
 
 	User Key Size - 128 bits (16 bytes), 192 bits (24 bytes), 256 bits (32 bytes)
 	Block Size - 128 bits (16 bytes)
+
+	On x86/x64, AES-NI instructions are used when the CPU supports them.
 */
 
 namespace slib
@@ -52,6 +54,14 @@ namespace slib
 		// 128 bit (16 byte) block
 		void decryptBlock(const void* src, void* dst) const;
 
+		// returns true when the CPU supports AES-NI
+		static sl_bool isHardwareSupported();
+
+		sl_bool isHardwareEnabled() const;
+
+		// enabled by default when supported. Disable to use the portable implementation
+		void setHardwareEnabled(sl_bool flag);
+
 	public: /* common functions for block ciphers */
 		sl_size encryptBlocks(const void* src, void* dst, sl_size size) const;
 
@@ -87,6 +97,11 @@ namespace slib
 		sl_uint32 m_roundKeyEnc[64];
 		sl_uint32 m_roundKeyDec[64];
 		sl_uint32 m_nCountRounds;
+		
+		// round keys in byte order, for AES-NI
+		SLIB_ALIGN(16) sl_uint8 m_roundKeyEncHW[240];
+		SLIB_ALIGN(16) sl_uint8 m_roundKeyDecHW[240];
+		sl_bool m_flagHardware;
 
 	};
 	
@@ -102,6 +117,9 @@ namespace slib
 	
 		void setKey_SHA256(const String& key);
 
+		// AES-NI and PCLMULQDQ are used when supported. Disable to use the portable implementation
+		void setHardwareEnabled(sl_bool flag);
+
 	private:
 		AES m_cipher;
 
@@ -34,8 +34,16 @@ namespace slib
 	{
 	public:
 		Uint128 M[16]; // Shoup's, 4-bit table
+
+		// H, H^2, H^3, H^4 (byte-reflected), for PCLMULQDQ
+		SLIB_ALIGN(16) sl_uint8 HP[64];
+		// uses PCLMULQDQ instead of the 4-bit table
+		sl_bool flagHardware;
 	
 	public:
+		// returns true when the CPU supports PCLMULQDQ
+		static sl_bool isHardwareSupported();
+
 		void generateTable(const void* H /* 16 bytes */);
 
 		void multiplyH(const void* X /* 16 bytes */, void* O /* 16 bytes */) const;
@@ -119,6 +127,10 @@ namespace slib
 			const void* tag, sl_size lenTag = 16 /* 4 <= lenTag <= 16 */
 		);
 
+	protected:
+		// encrypts the full blocks in CTR mode, and returns the processed size
+		sl_size _encryptCounterBlocks(const void* src, void* dst, sl_size size);
+
 	protected:
 		const BlockCipher* m_cipher;
 
@@ -34,6 +34,12 @@ namespace slib
 	public:
 		sl_uint32 getLength() const;
 
+	private:
+		// Montgomery context of N, created by the first operation
+		mutable AtomicRef<CBigIntMontgomery> m_montgomeryN;
+
+		friend class RSA;
+
 	};
 	
 	class SLIB_EXPORT RSAPrivateKey
@@ -59,6 +65,14 @@ namespace slib
 	public:
 		sl_uint32 getLength() const;
 
+	private:
+		// Montgomery contexts of N, P, Q, created by the first operation and reused by the next ones
+		mutable AtomicRef<CBigIntMontgomery> m_montgomeryN;
+		mutable AtomicRef<CBigIntMontgomery> m_montgomeryP;
+		mutable AtomicRef<CBigIntMontgomery> m_montgomeryQ;
+
+		friend class RSA;
+
 	};
 	
 	class SLIB_EXPORT RSA
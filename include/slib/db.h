@@ -12,6 +12,7 @@
 #define CHECKHEADER_SLIB_DB_HEADER
 
 #include "db/database.h"
+#include "db/database_pool.h"
 
 #include "db/sqlite.h"
 #include "db/mysql.h"
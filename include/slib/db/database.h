@@ -15,12 +15,24 @@
 
 #include "../core/object.h"
 #include "../core/variant.h"
+#include "../core/function.h"
 
 namespace slib
 {
 	
 	class Database;
 	
+	enum class DatabaseColumnType
+	{
+		Null = 0,
+		Integer = 1,
+		Float = 2,
+		Text = 3,
+		Blob = 4,
+		// 64-bit unsigned integer (e.g. `BIGINT UNSIGNED` of MySQL), which may not fit in `Integer`
+		UnsignedInteger = 5
+	};
+	
 	class SLIB_EXPORT DatabaseCursor : public Object
 	{
 		SLIB_DECLARE_OBJECT
@@ -97,6 +109,12 @@ namespace slib
 
 		virtual Memory getBlob(const String& name);
 	
+		// type of the value in the current row
+		virtual DatabaseColumnType getColumnType(sl_uint32 index);
+
+		// text or blob data of the current row without copying, valid until next `moveNext()`. returns null when not supported
+		virtual const void* getColumnData(sl_uint32 index, sl_size* outSize);
+
 
 		virtual sl_bool moveNext() = 0;
 	
@@ -105,6 +123,106 @@ namespace slib
 
 	};
 	
+	struct _priv_DatabaseResultSet_Cell;
+	
+	/*
+		DatabaseResultSet holds all rows of a query result in memory.
+	 
+		The values are stored by columns in typed arrays, and texts and blobs are stored in a shared buffer,
+		so reading a large result does not allocate any object per row or per value.
+	*/
+	class SLIB_EXPORT DatabaseResultSet : public Referable
+	{
+		SLIB_DECLARE_OBJECT
+		
+	protected:
+		DatabaseResultSet();
+		
+		~DatabaseResultSet();
+		
+	public:
+		// reads all remaining rows of the cursor
+		static Ref<DatabaseResultSet> create(DatabaseCursor* cursor);
+		
+	public:
+		sl_uint32 getColumnsCount();
+		
+		String getColumnName(sl_uint32 index);
+		
+		// returns -1 when the column name not found
+		sl_int32 getColumnIndex(const String& name);
+		
+		sl_size getRowsCount();
+		
+		DatabaseColumnType getType(sl_size row, sl_uint32 column);
+		
+		sl_bool isNull(sl_size row, sl_uint32 column);
+		
+		Variant getValue(sl_size row, sl_uint32 column);
+		
+		sl_int64 getInt64(sl_size row, sl_uint32 column, sl_int64 defaultValue = 0);
+		
+		sl_uint64 getUint64(sl_size row, sl_uint32 column, sl_uint64 defaultValue = 0);
+		
+		sl_int32 getInt32(sl_size row, sl_uint32 column, sl_int32 defaultValue = 0);
+		
+		sl_uint32 getUint32(sl_size row, sl_uint32 column, sl_uint32 defaultValue = 0);
+		
+		float getFloat(sl_size row, sl_uint32 column, float defaultValue = 0);
+		
+		double getDouble(sl_size row, sl_uint32 column, double defaultValue = 0);
+		
+		String getString(sl_size row, sl_uint32 column);
+		
+		// returns the text (not null-terminated) stored in this object, without copying. returns null for non-text values
+		const sl_char8* getStringData(sl_size row, sl_uint32 column, sl_size* outLength = sl_null);
+		
+		Memory getBlob(sl_size row, sl_uint32 column);
+		
+		// returns the text or blob stored in this object, without copying
+		const void* getBlobData(sl_size row, sl_uint32 column, sl_size* outSize = sl_null);
+		
+		HashMap<String, Variant> getRow(sl_size row);
+		
+	private:
+		sl_uint32 m_nColumns;
+		sl_size m_nRows;
+		String* m_columnNames;
+		CHashMap<String, sl_int32> m_mapColumnIndexes;
+		// column-major
+		_priv_DatabaseResultSet_Cell* m_cells;
+		sl_uint8* m_data;
+		
+	};
+	
+	class SLIB_EXPORT DatabaseBatchParam
+	{
+	public:
+		// parameters of all rows in column-major order: `params[column * countRows + row]`
+		const Variant* params;
+		sl_uint32 countColumns;
+		sl_size countRows;
+		
+		// used when `params` is null: fills `countColumns` parameters of the next row, and returns false when there is no more row.
+		// called without locking the database, between the batches
+		Function<sl_bool(Variant* row)> onGetRow;
+		
+		// rows executed in one transaction. default: 10000
+		sl_size rowsPerBatch;
+		
+		// default: true
+		sl_bool flagTransaction;
+		
+		// called after each batch is committed, without locking the database
+		Function<void(sl_size countCompletedRows, sl_size countBatchRows, sl_uint64 elapsedMilliseconds)> onBatchCompleted;
+		
+	public:
+		DatabaseBatchParam();
+		
+		~DatabaseBatchParam();
+		
+	};
+	
 	class SLIB_EXPORT DatabaseStatement : public Object
 	{
 		SLIB_DECLARE_OBJECT
@@ -131,6 +249,17 @@ namespace slib
 			return executeBy(params, sizeof...(args));
 		}
 
+		// `params`: `nRows` rows of `nParamsPerRow` parameters in row-major order. returns the total count of affected rows, or -1 on error
+		virtual sl_int64 executeRows(const Variant* params, sl_uint32 nParamsPerRow, sl_size nRows);
+		
+		/*
+			Executes all rows of the parameters, reusing this statement.
+			Each batch of rows is executed in a transaction. When a batch fails, the batch is rolled back
+			(the batches committed before are kept) and -1 is returned.
+			Returns the total count of affected rows.
+		*/
+		virtual sl_int64 executeBatch(const DatabaseBatchParam& param);
+
 		virtual Ref<DatabaseCursor> queryBy(const Variant* params = sl_null, sl_uint32 nParams = 0) = 0;
 	
 		SLIB_INLINE Ref<DatabaseCursor> query()
@@ -159,6 +288,20 @@ namespace slib
 			return getListForQueryResultBy(params, sizeof...(args));
 		}
 
+		virtual Ref<DatabaseResultSet> getResultSetBy(const Variant* params = sl_null, sl_uint32 nParams = 0);
+
+		SLIB_INLINE Ref<DatabaseResultSet> getResultSet()
+		{
+			return getResultSetBy();
+		}
+
+		template <class... ARGS>
+		SLIB_INLINE Ref<DatabaseResultSet> getResultSet(ARGS&&... args)
+		{
+			Variant params[] = {Forward<ARGS>(args)...};
+			return getResultSetBy(params, sizeof...(args));
+		}
+
 		virtual HashMap<String, Variant> getRecordForQueryResultBy(const Variant* params = sl_null, sl_uint32 nParams = 0);
 
 		SLIB_INLINE HashMap<String, Variant> getRecordForQueryResult()
@@ -208,9 +351,17 @@ namespace slib
 
 		virtual Ref<DatabaseCursor> query(const String& sql);
 	
+		virtual sl_bool startTransaction();
+	
+		virtual sl_bool commitTransaction();
+	
+		virtual sl_bool rollbackTransaction();
+	
 
 		virtual List< HashMap<String, Variant> > getListForQueryResult(const String& sql);
 
+		virtual Ref<DatabaseResultSet> getResultSet(const String& sql);
+
 		virtual HashMap<String, Variant> getRecordForQueryResult(const String& sql);
 
 		virtual Variant getValueForQueryResult(const String& sql);
@@ -225,6 +376,8 @@ namespace slib
 			return executeBy(sql, params, sizeof...(args));
 		}
 
+		virtual sl_int64 executeBatch(const String& sql, const DatabaseBatchParam& param);
+
 		virtual Ref<DatabaseCursor> queryBy(const String& sql, const Variant* params, sl_uint32 nParams);
 	
 		template <class... ARGS>
@@ -243,6 +396,15 @@ namespace slib
 			return getListForQueryResultBy(sql, params, sizeof...(args));
 		}
 	
+		virtual Ref<DatabaseResultSet> getResultSetBy(const String& sql, const Variant* params, sl_uint32 nParams);
+
+		template <class... ARGS>
+		SLIB_INLINE Ref<DatabaseResultSet> getResultSet(const String& sql, ARGS&&... args)
+		{
+			Variant params[] = {Forward<ARGS>(args)...};
+			return getResultSetBy(sql, params, sizeof...(args));
+		}
+
 		virtual HashMap<String, Variant> getRecordForQueryResultBy(const String& sql, const Variant* params, sl_uint32 nParams);
 
 		template <class... ARGS>
@@ -0,0 +1,120 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef CHECKHEADER_SLIB_DB_DATABASE_POOL
+#define CHECKHEADER_SLIB_DB_DATABASE_POOL
+
+#include "definition.h"
+
+#include "database.h"
+
+#include "../core/function.h"
+#include "../core/mutex.h"
+#include "../core/event.h"
+
+/*
+	DatabasePool hands out the connections to the threads.
+
+	Each connection is used by only one thread until it is returned, so the threads are not
+	serialized on a single connection. The connections are created on demand up to the limit.
+	The write connections and the read connections can be created by different connectors
+	(for example, a single writer and multiple WAL-mode readers of SQLite).
+	If there is no read connector, the read connections are taken from the write connections.
+*/
+
+namespace slib
+{
+
+	class _priv_DatabasePool_Group;
+
+	class SLIB_EXPORT DatabasePoolParam
+	{
+	public:
+		Function<Ref<Database>()> connect;
+		sl_uint32 maxConnections; // default: 8
+
+		Function<Ref<Database>()> connectReader; // optional
+		sl_uint32 maxReaders; // default: 8
+
+	public:
+		DatabasePoolParam();
+
+		~DatabasePoolParam();
+
+	};
+
+	class SLIB_EXPORT DatabasePool : public Object
+	{
+		SLIB_DECLARE_OBJECT
+
+	protected:
+		DatabasePool();
+
+		~DatabasePool();
+
+	public:
+		static Ref<DatabasePool> create(const DatabasePoolParam& param);
+
+	public:
+		// timeout: milliseconds, negative means INFINITE. returns null on timeout or connection failure
+		Ref<Database> getConnection(sl_int32 timeout = -1);
+
+		// timeout: milliseconds, negative means INFINITE. returns null on timeout or connection failure
+		Ref<Database> getReadConnection(sl_int32 timeout = -1);
+
+		// returns the connection taken by `getConnection()` or `getReadConnection()`
+		void releaseConnection(const Ref<Database>& db);
+
+		// closes the connection (for example, broken) instead of returning it
+		void discardConnection(const Ref<Database>& db);
+
+	private:
+		Ref<Database> _getConnection(_priv_DatabasePool_Group* group, sl_int32 timeout);
+
+		void _returnConnection(const Ref<Database>& db, sl_bool flagDiscard);
+
+	private:
+		Mutex m_lock;
+		_priv_DatabasePool_Group* m_writers;
+		_priv_DatabasePool_Group* m_readers;
+
+	};
+
+	// returns the connection to the pool on destruction
+	class SLIB_EXPORT DatabasePoolConnection
+	{
+	public:
+		DatabasePoolConnection(const Ref<DatabasePool>& pool, sl_bool flagReadOnly = sl_false, sl_int32 timeout = -1);
+
+		~DatabasePoolConnection();
+
+	public:
+		sl_bool isNull() const;
+
+		sl_bool isNotNull() const;
+
+		const Ref<Database>& get() const;
+
+		Database* operator->() const;
+
+	private:
+		DatabasePoolConnection(const DatabasePoolConnection& other) = delete;
+
+		DatabasePoolConnection& operator=(const DatabasePoolConnection& other) = delete;
+
+	private:
+		Ref<DatabasePool> m_pool;
+		Ref<Database> m_db;
+
+	};
+
+}
+
+#endif
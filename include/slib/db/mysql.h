@@ -12,6 +12,7 @@
 #define CHECKHEADER_SLIB_DB_MYSQL
 
 #include "database.h"
+#include "database_pool.h"
 
 #if defined(SLIB_PLATFORM_IS_DESKTOP)
 #define SLIB_DATABASE_SUPPORT_MYSQL
@@ -54,6 +55,8 @@ namespace slib
 		static Ref<MySQL_Database> connect(const MySQL_Param& param);
 
 		static Ref<MySQL_Database> connect(const MySQL_Param& param, String& outErrorMessage);
+
+		static Ref<DatabasePool> createPool(const MySQL_Param& param, sl_uint32 maxConnections = 8);
 	
 	public:
 		virtual sl_bool ping() = 0;
@@ -12,6 +12,7 @@
 #define CHECKHEADER_SLIB_DB_SQLITE
 
 #include "database.h"
+#include "database_pool.h"
 
 namespace slib
 {
@@ -28,6 +29,9 @@ namespace slib
 	public:
 		static Ref<SQLiteDatabase> connect(const String& filePath);
 
+		// a writer and `maxReaders` read-only connections, in WAL journal mode
+		static Ref<DatabasePool> createPool(const String& filePath, sl_uint32 maxReaders = 8);
+
 	};
 
 }
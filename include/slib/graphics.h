@@ -26,6 +26,7 @@
 #include "graphics/drawable.h"
 #include "graphics/bitmap.h"
 #include "graphics/image.h"
+#include "graphics/image_pipeline.h"
 
 #include "graphics/canvas.h"
 
@@ -97,6 +97,8 @@ namespace slib
 		Nearest = 0,
 		Linear = 1,
 		Box = 2,
+		Bicubic = 3,
+		Lanczos = 4,
 		
 		Default = Box
 	};
@@ -161,6 +161,9 @@ namespace slib
 
 		static Ref<Image> loadJPEG(const void* content, sl_size size);
 
+		// decodes at 1/2, 1/4 or 1/8 scale (in the DCT domain), as long as the result is not smaller than (width, height)
+		static Ref<Image> loadJPEG(const void* content, sl_size size, sl_uint32 width, sl_uint32 height);
+
 		static Memory saveJPEG(const Ref<Image>& image, float quality = 0.5f);
 
 		Memory saveJPEG(float quality = 0.5f);
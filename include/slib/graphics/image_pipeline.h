@@ -0,0 +1,124 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef CHECKHEADER_SLIB_GRAPHICS_IMAGE_PIPELINE
+#define CHECKHEADER_SLIB_GRAPHICS_IMAGE_PIPELINE
+
+#include "definition.h"
+
+#include "image.h"
+
+#include "../core/thread_pool.h"
+#include "../core/function.h"
+#include "../core/list.h"
+#include "../core/spin_lock.h"
+
+/*
+	ImagePipeline decodes and encodes the batches of the images in parallel on a thread pool.
+
+	The JPEG decoders/encoders are kept in the pipeline and reused by the next images.
+	The pixel buffers of the decoded images are also pooled: a buffer returns to the pool
+	when its image is released, and is reused by the next decoding of the same or smaller size.
+	The JPEG images are decoded at the reduced scale (in the DCT domain) for the size hints,
+	and for the memory limit of a single image.
+*/
+
+namespace slib
+{
+
+	class _priv_ImageJpeg_Decoder;
+	class _priv_ImageJpeg_Encoder;
+
+	class SLIB_EXPORT ImagePipelineParam
+	{
+	public:
+		// runs the tasks on this pool. if null, creates a work-stealing pool
+		Ref<ThreadPool> threadPool;
+		// threads of the created pool. 0 means the number of processors
+		sl_uint32 countThreads;
+
+		// bytes of the decoded pixels of a single image. 0 means unlimited
+		sl_size maxImageMemory;
+		// count of the pixel buffers kept in the pool
+		sl_uint32 maxPooledBuffers; // default: 16
+
+	public:
+		ImagePipelineParam();
+
+		~ImagePipelineParam();
+
+	};
+
+	class SLIB_EXPORT ImagePipeline : public Object
+	{
+		SLIB_DECLARE_OBJECT
+
+	protected:
+		ImagePipeline();
+
+		~ImagePipeline();
+
+	public:
+		static Ref<ImagePipeline> create(const ImagePipelineParam& param);
+
+		static Ref<ImagePipeline> create();
+
+	public:
+		// decodes on the calling thread. width, height: size hints (see `Image::loadFromMemory()`)
+		Ref<Image> decode(const void* content, sl_size size, sl_uint32 width = 0, sl_uint32 height = 0);
+
+		Ref<Image> decode(const Memory& content, sl_uint32 width = 0, sl_uint32 height = 0);
+
+		// decodes in parallel, and returns the images in the same order (null for the failures)
+		List< Ref<Image> > decode(const List<Memory>& contents, sl_uint32 width = 0, sl_uint32 height = 0);
+
+		void decodeAsync(const Memory& content, const Function<void(Ref<Image>&)>& onComplete, sl_uint32 width = 0, sl_uint32 height = 0);
+
+		// encodes on the calling thread. quality is used by JPEG
+		Memory encode(const Ref<Image>& image, ImageFileType type, float quality = 0.5f);
+
+		// encodes in parallel, and returns the contents in the same order (null for the failures)
+		List<Memory> encode(const List< Ref<Image> >& images, ImageFileType type, float quality = 0.5f);
+
+		void encodeAsync(const Ref<Image>& image, ImageFileType type, const Function<void(Memory&)>& onComplete, float quality = 0.5f);
+
+		const Ref<ThreadPool>& getThreadPool();
+
+	protected:
+		Memory _allocateBuffer(sl_size size);
+
+		_priv_ImageJpeg_Decoder* _takeJpegDecoder();
+
+		void _returnJpegDecoder(_priv_ImageJpeg_Decoder* decoder);
+
+		_priv_ImageJpeg_Encoder* _takeJpegEncoder();
+
+		void _returnJpegEncoder(_priv_ImageJpeg_Encoder* encoder);
+
+		void _runBatch(sl_size count, const Function<void(sl_size)>& task);
+
+	protected:
+		Ref<ThreadPool> m_threadPool;
+		sl_uint32 m_countThreads;
+		sl_size m_maxImageMemory;
+		sl_uint32 m_maxPooledBuffers;
+
+		SpinLock m_lockBuffers;
+		List<Memory> m_buffers;
+
+		SpinLock m_lockCoders;
+		List<_priv_ImageJpeg_Decoder*> m_jpegDecoders;
+		List<_priv_ImageJpeg_Encoder*> m_jpegEncoders;
+
+	};
+
+}
+
+#endif
@@ -959,6 +959,55 @@ namespace slib
 	BigInt operator>>(const BigInt& a, sl_size n) noexcept;
 
 
+	/*
+		Precomputed values of Montgomery Reduction (R mod M, R^2 mod M, -M^-1 mod 2^64) for a modulus,
+		reused by the exponentiations of the same modulus (RSA keys, for example).
+		The values are stored in 64-bit limbs on 64-bit platforms.
+	
+		The instance is not modified by the exponentiations, so it can be shared by the threads.
+	*/
+	class SLIB_EXPORT CBigIntMontgomery : public Referable
+	{
+		SLIB_DECLARE_OBJECT
+		
+	public:
+		CBigIntMontgomery() noexcept;
+		
+		~CBigIntMontgomery() noexcept;
+		
+	public:
+		/*
+			Available Input:
+				M - an odd value (M%2=1), M>0
+		*/
+		static Ref<CBigIntMontgomery> create(const CBigInt& M) noexcept;
+		
+		static Ref<CBigIntMontgomery> create(const BigInt& M) noexcept;
+		
+	public:
+		const CBigInt& getModulus() const noexcept;
+		
+		sl_bool isModulus(const BigInt& M) const noexcept;
+		
+		/*
+			C = A^E mod M (fixed-window exponentiation)
+			Available Input:
+				E >= 0
+		*/
+		sl_bool pow(CBigInt& C, const CBigInt& A, const CBigInt& E) const noexcept;
+		
+		BigInt pow(const BigInt& A, const BigInt& E) const noexcept;
+		
+	protected:
+		CBigInt m_M;
+		sl_size m_nLimbs;
+		// M, R mod M, R^2 mod M
+		Memory m_limbs;
+		sl_uint64 m_MI;
+		
+	};
+
+
 }
 
 #endif
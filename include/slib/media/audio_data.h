@@ -19,6 +19,8 @@
 
 namespace slib
 {
+	class AudioResampler;
+	
 	class SLIB_EXPORT AudioChannelBuffer
 	{
 	public:
@@ -61,6 +63,9 @@ namespace slib
 		
 		void copySamplesFrom(const AudioData& other) const;
 		
+		// converts the sample rate by `resampler`, and returns the count of samples written to this
+		sl_size copySamplesFrom(const AudioData& other, AudioResampler* resampler) const;
+		
 	public:
 		AudioData& operator=(const AudioData& other);
 		
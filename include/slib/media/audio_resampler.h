@@ -0,0 +1,129 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef CHECKHEADER_SLIB_MEDIA_AUDIO_RESAMPLER
+#define CHECKHEADER_SLIB_MEDIA_AUDIO_RESAMPLER
+
+#include "definition.h"
+
+#include "audio_data.h"
+
+#include "../core/object.h"
+#include "../core/memory.h"
+
+/*
+	Streaming sample-rate converter (polyphase Kaiser-windowed sinc)
+ -------------------------------------------------------------------
+
+ The filter bank has one phase per output sample of the reduced rate ratio
+ (e.g. 147 phases for 48000 => 44100). When the ratio needs more than 256 phases,
+ the nearest two phases are interpolated.
+ The input samples are buffered between the calls, so the stream can be fed in any chunk size.
+
+*/
+
+namespace slib
+{
+	enum class AudioResampleQuality
+	{
+		// 16 taps, ~50dB stop-band
+		Fast = 0,
+		// 32 taps, ~70dB stop-band
+		Medium = 1,
+		// 64 taps, ~95dB stop-band
+		High = 2
+	};
+
+	class SLIB_EXPORT AudioResamplerParam
+	{
+	public:
+		sl_uint32 samplesPerSecondInput;
+		sl_uint32 samplesPerSecondOutput;
+
+		// channels of the resampled stream (1~8). `AudioData` input/output are mixed to/from this count
+		sl_uint32 channelsCount;
+
+		AudioResampleQuality quality;
+
+	public:
+		AudioResamplerParam();
+
+		~AudioResamplerParam();
+
+	};
+
+	class SLIB_EXPORT AudioResampler : public Object
+	{
+		SLIB_DECLARE_OBJECT
+
+	protected:
+		AudioResampler();
+
+		~AudioResampler();
+
+	public:
+		static Ref<AudioResampler> create(const AudioResamplerParam& param);
+
+	public:
+		sl_uint32 getSamplesCountPerSecondInput() const;
+
+		sl_uint32 getSamplesCountPerSecondOutput() const;
+
+		sl_uint32 getChannelsCount() const;
+
+		// count of the samples which will be available after `countInput` samples are fed
+		sl_size getOutputCount(sl_size countInput) const;
+
+		/*
+			Consumes all the input samples, and returns the count of samples written to `output`.
+			The samples not fitting in `output` are kept for the next call (input can be empty).
+		*/
+		sl_size process(const AudioData& input, const AudioData& output);
+
+		// non-interleaved float samples of `getChannelsCount()` channels
+		sl_size process(const float* const* input, sl_size countInput, float* const* output, sl_size countOutput);
+
+		void reset();
+
+	protected:
+		sl_bool _appendInput(sl_size count);
+
+		sl_size _resample(float* const* output, sl_size count);
+
+		void _removeConsumedInput();
+
+	protected:
+		sl_uint32 m_nSamplesPerSecondInput;
+		sl_uint32 m_nSamplesPerSecondOutput;
+		sl_uint32 m_nChannels;
+
+		// output position advances `m_step / m_countPhases` input samples per output sample
+		sl_uint32 m_countPhases;
+		sl_uint32 m_step;
+		sl_uint32 m_phase;
+
+		// filter bank: (m_countFilters + 1) phases of m_countTaps coefficients
+		Memory m_filters;
+		sl_uint32 m_countFilters;
+		sl_uint32 m_countTaps;
+
+		// non-interleaved input history
+		Memory m_input;
+		sl_size m_capacityInput;
+		sl_size m_countInput;
+		sl_size m_posInput;
+
+		Memory m_output;
+
+	};
+
+}
+
+#endif
@@ -161,6 +161,21 @@ namespace slib
 		
 		static void mixSamples(float in1, float in2, float& _out);
 		
+		
+		/*
+			Channel layouts (1~8 channels) follow the WAVE order:
+				1: C,  2: L R,  3: L R C,  4: L R SL SR,  5: L R C SL SR,
+				6: L R C LFE SL SR,  7: L R C LFE BC SL SR,  8: L R C LFE BL BR SL SR
+			`matrix` has `nChannelsOut` rows of `nChannelsIn` coefficients.
+		*/
+		static sl_bool getMixMatrix(sl_uint32 nChannelsIn, sl_uint32 nChannelsOut, float* matrix);
+		
+		// `output` must not overlap `input`
+		static void mixChannels(sl_size count, const float* const* input, sl_uint32 nChannelsIn, float* const* output, sl_uint32 nChannelsOut, const float* matrix);
+		
+		// mixes by the matrix of `getMixMatrix()`
+		static sl_bool mixChannels(sl_size count, const float* const* input, sl_uint32 nChannelsIn, float* const* output, sl_uint32 nChannelsOut);
+		
 	};
 	
 }
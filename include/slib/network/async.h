@@ -135,6 +135,7 @@ namespace slib
 		sl_bool flagIPv6; // default: false
 		sl_bool flagAutoStart; // default: true
 		sl_bool flagLogError; // default: true
+		sl_bool flagReusePort; // default: false, allows multiple servers to listen on the same port (unix)
 		Ref<AsyncIoLoop> ioLoop;
 		
 		Ptr<IAsyncTcpServerListener> listener;
@@ -194,6 +195,14 @@ namespace slib
 	class AsyncUdpSocket;
 	class AsyncUdpSocketInstance;
 	
+	class SLIB_EXPORT AsyncUdpDatagram
+	{
+	public:
+		SocketAddress address;
+		void* data; // valid only in the callback
+		sl_uint32 size;
+	};
+	
 	class SLIB_EXPORT IAsyncUdpSocketListener
 	{
 	public:
@@ -204,6 +213,9 @@ namespace slib
 	public:
 		virtual void onReceiveFrom(AsyncUdpSocket* socket, const SocketAddress& address, void* data, sl_uint32 sizeReceived) = 0;
 		
+		// called with the datagrams received at once. default implementation calls `onReceiveFrom()` for each datagram
+		virtual void onReceiveFromBatch(AsyncUdpSocket* socket, AsyncUdpDatagram* datagrams, sl_uint32 count);
+		
 	};
 	
 	
@@ -215,13 +227,19 @@ namespace slib
 		SocketAddress bindAddress;
 		sl_bool flagIPv6; // default: false
 		sl_bool flagBroadcast; // default: false
+		sl_bool flagReusePort; // default: false, allows multiple sockets to bind to the same port (unix)
 		sl_bool flagAutoStart; // default: true
 		sl_bool flagLogError; // default: true
 		sl_uint32 packetSize; // default: 65536
+		// datagrams received or sent by a system call (`recvmmsg`/`sendmmsg` on Linux)
+		sl_uint32 batchCount; // default: 1
+		// receives the coalesced datagrams (UDP_GRO on Linux), delivered as separated datagrams. Each message of the batch gets the buffer of 64KB at least
+		sl_bool flagGRO; // default: false
 		Ref<AsyncIoLoop> ioLoop;
 		
 		Ptr<IAsyncUdpSocketListener> listener;
 		Function<void(AsyncUdpSocket*, const SocketAddress&, void*, sl_uint32)> onReceiveFrom;
+		Function<void(AsyncUdpSocket*, AsyncUdpDatagram*, sl_uint32)> onReceiveFromBatch;
 		
 	public:
 		AsyncUdpSocketParam();
@@ -264,17 +282,23 @@ namespace slib
 		
 		sl_bool sendTo(const SocketAddress& addressTo, const Memory& mem);
 		
+		// sends `mem` as the datagrams of `segmentSize` bytes (the last one can be shorter), by a single UDP_SEGMENT (GSO) send when supported
+		sl_bool sendTo(const SocketAddress& addressTo, const Memory& mem, sl_uint32 segmentSize);
+		
 	protected:
 		Ref<AsyncUdpSocketInstance> _getIoInstance();
 		
 		void _onReceive(const SocketAddress& address, void* data, sl_uint32 sizeReceived);
 		
+		void _onReceive(AsyncUdpDatagram* datagrams, sl_uint32 count);
+		
 	protected:
-		static Ref<AsyncUdpSocketInstance> _createInstance(const Ref<Socket>& socket, sl_uint32 packetSize);
+		static Ref<AsyncUdpSocketInstance> _createInstance(const Ref<Socket>& socket, const AsyncUdpSocketParam& param);
 		
 	protected:
 		Ptr<IAsyncUdpSocketListener> m_listener;
 		Function<void(AsyncUdpSocket*, const SocketAddress&, void*, sl_uint32)> m_onReceiveFrom;
+		Function<void(AsyncUdpSocket*, AsyncUdpDatagram*, sl_uint32)> m_onReceiveFromBatch;
 		
 		friend class AsyncUdpSocketInstance;
 		
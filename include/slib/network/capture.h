@@ -75,6 +75,7 @@ namespace slib
 		virtual ~INetCaptureListener();
 
 	public:
+		// `packet->data` is valid only during the call. In fanout mode, called from multiple threads concurrently
 		virtual void onCapturePacket(NetCapture* capture, NetCapturePacket* packet) = 0;
 		
 	};
@@ -90,6 +91,12 @@ namespace slib
 		
 		NetworkLinkDeviceType preferedLinkDeviceType; // NetworkLinkDeviceType, used in Packet Socket mode. now supported Ethernet and Raw
 		
+		sl_bool flagUseRingBuffer; // receives the packets from the memory-mapped ring (TPACKET_V3) without copying, used in Packet Socket mode (linux). default: true
+		sl_uint32 sizeRingBlock; // size of a block in the ring, used in ring mode. default: 1MB
+		sl_uint32 countRingBlocks; // number of the blocks in the ring, used in ring mode. default: 32
+		sl_uint32 timeoutRingBlock; // timeout (in milliseconds) to retire a partially filled block, used in ring mode. default: 10
+		sl_uint32 countFanoutThreads; // number of the capturing threads in the PACKET_FANOUT group, distributing the packets by flow hash. used in ring mode. default: 1
+		
 		sl_bool flagAutoStart; // default: true
 		
 		Ptr<INetCaptureListener> listener;
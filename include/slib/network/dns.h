@@ -269,6 +269,18 @@ namespace slib
 		
 	};
 	
+	// RDATA of SOA record
+	struct SLIB_EXPORT DnsSOA
+	{
+		String primaryServer; // MNAME
+		String mailbox; // RNAME
+		sl_uint32 serial;
+		sl_uint32 refresh;
+		sl_uint32 retry;
+		sl_uint32 expire;
+		sl_uint32 minimum;
+	};
+	
 	class SLIB_EXPORT DnsRecord
 	{
 	public:
@@ -369,6 +381,12 @@ namespace slib
 		// A <domain-name> which specifies a host which should be authoritative for the specified class and domain.
 		sl_uint32 buildRecord_PTR(void* buf, sl_uint32 offset, sl_uint32 size, const String& dname);
 		
+		// Start of a zone of authority: MNAME, RNAME, SERIAL, REFRESH, RETRY, EXPIRE, MINIMUM
+		sl_bool parseData_SOA(DnsSOA& soa) const;
+		
+		// Start of a zone of authority: MNAME, RNAME, SERIAL, REFRESH, RETRY, EXPIRE, MINIMUM
+		sl_uint32 buildRecord_SOA(void* buf, sl_uint32 offset, sl_uint32 size, const DnsSOA& soa);
+		
 		String toString() const;
 		
 	private:
@@ -392,6 +410,8 @@ namespace slib
 		
 		sl_uint16 id;
 		
+		DnsResponseCode responseCode;
+		
 		struct Question
 		{
 			String name;
@@ -403,6 +423,7 @@ namespace slib
 		{
 			String name;
 			IPAddress address;
+			sl_uint32 TTL;
 		};
 		List<Address> addresses;
 		
@@ -410,6 +431,7 @@ namespace slib
 		{
 			String name;
 			String alias;
+			sl_uint32 TTL;
 		};
 		List<Alias> aliases;
 		
@@ -427,12 +449,29 @@ namespace slib
 		};
 		List<NamePointer> pointers;
 		
+		struct Authority
+		{
+			sl_bool flagSOA; // false if no SOA record
+			String name; // zone, empty for the root
+			DnsSOA soa;
+			sl_uint32 TTL;
+		};
+		// SOA record in the authority section of the negative answer
+		Authority authority;
+		
+		// TTL of the negative answer (RFC 2308: minimum of the TTL and MINIMUM field of the SOA record in the authority section), 0 if no SOA record
+		sl_uint32 negativeTTL;
+		
 	public:
 		sl_bool parsePacket(const void* packet, sl_uint32 len);
 		
 		static Memory buildQuestionPacket(sl_uint16 id, const String& host);
 		
-		static Memory buildHostAddressAnswerPacket(sl_uint16 id, const String& hostName, const IPv4Address& hostAddress);
+		// answers `NameError` if `hostAddress` is zero
+		static Memory buildHostAddressAnswerPacket(sl_uint16 id, const String& hostName, const IPv4Address& hostAddress, sl_uint32 TTL = 0);
+		
+		// answers without address: `NoError` for existing host without A record (NODATA), `NameError` for not existing host (NXDOMAIN). SOA record of `authority` is added if exists
+		static Memory buildNegativeAnswerPacket(sl_uint16 id, const String& hostName, DnsResponseCode responseCode, const Authority& authority);
 		
 	};
 	
@@ -555,6 +594,24 @@ namespace slib
 		sl_bool flagAutoStart;
 		
 		Ref<AsyncIoLoop> ioLoop;
+		/*
+			Count of the workers. Each worker runs on its own AsyncIoLoop (`ioLoop` is not used when more than one),
+			and the workers share the ports by SO_REUSEPORT (Linux). 0 means the number of processors
+		*/
+		sl_uint32 ioLoopsCount; // default: 1
+		
+		// count of the host names kept in the answer cache of the forwarded questions. 0 disables the cache
+		sl_uint32 cacheCapacity; // default: 10000
+		// seconds, the range of the TTL of the cached answers
+		sl_uint32 cacheMinimumTTL; // default: 0
+		sl_uint32 cacheMaximumTTL; // default: 86400
+		// seconds, used for the negative answers (not existing hosts) without SOA record
+		sl_uint32 cacheNegativeTTL; // default: 60
+		// the cached answer used in the last `prefetchPercent`% of its TTL is refreshed by forwarding the question again. 0 disables the prefetch
+		sl_uint32 prefetchPercent; // default: 10
+		
+		// milliseconds, the forwarded questions without answer are discarded after this time
+		sl_uint32 forwardTimeout; // default: 5000
 		
 		Ptr<IDnsServerListener> listener;
 		
@@ -569,6 +626,9 @@ namespace slib
 	};
 	
 	
+	class _priv_DnsServer_Cache;
+	class _priv_DnsServer_Worker;
+	
 	class SLIB_EXPORT DnsServer : public Object, public IAsyncUdpSocketListener
 	{
 		SLIB_DECLARE_OBJECT
@@ -589,23 +649,32 @@ namespace slib
 		sl_bool isRunning();
 		
 	protected:
-		void _processReceivedDnsQuestion(const SocketAddress& clientAddress, sl_uint16 id, const String& hostName, sl_bool flagEncryptedRequest);
+		void _processReceivedDnsQuestion(_priv_DnsServer_Worker* worker, const SocketAddress& clientAddress, sl_uint16 id, const String& hostName, sl_bool flagEncryptedRequest);
+		
+		void _processReceivedDnsAnswer(_priv_DnsServer_Worker* worker, sl_uint32 indexForwarder, const SocketAddress& addressFrom, const DnsPacket& packet);
 		
-		void _processReceivedDnsAnswer(const DnsPacket& packet);
+		void _processReceivedProxyQuestion(_priv_DnsServer_Worker* worker, const SocketAddress& clientAddress, void* data, sl_uint32 size, sl_bool flagEncryptedRequest);
 		
-		void _processReceivedProxyQuestion(const SocketAddress& clientAddress, void* data, sl_uint32 size, sl_bool flagEncryptedRequest);
+		void _processReceivedProxyAnswer(_priv_DnsServer_Worker* worker, sl_uint32 indexForwarder, const SocketAddress& addressFrom, void* data, sl_uint32 size);
 		
-		void _processReceivedProxyAnswer(void* data, sl_uint32 size);
+		void _forwardQuestion(_priv_DnsServer_Worker* worker, const SocketAddress& clientAddress, sl_uint16 id, const String& hostName, sl_bool flagEncryptedRequest, const SocketAddress& forwardAddress, sl_bool flagEncryptForward);
 		
-		void _sendPacket(sl_bool flagEncrypted, const SocketAddress& targetAddress, const Memory& packet);
+		void _sendPacket(_priv_DnsServer_Worker* worker, sl_bool flagEncrypted, const SocketAddress& targetAddress, const Memory& packet);
 		
 		Memory _buildQuestionPacket(sl_uint16 id, const String& host, sl_bool flagEncrypt);
 		
-		Memory _buildHostAddressAnswerPacket(sl_uint16 id, const String& hostName, const IPv4Address& hostAddress, sl_bool flagEncrypt);
+		Memory _buildHostAddressAnswerPacket(sl_uint16 id, const String& hostName, const IPv4Address& hostAddress, sl_uint32 TTL, sl_bool flagEncrypt);
+		
+		Memory _buildNegativeAnswerPacket(sl_uint16 id, const String& hostName, DnsResponseCode responseCode, const DnsPacket::Authority& authority, sl_bool flagEncrypt);
 		
 	protected:
+		// dispatches the datagram to the worker owning `socket`
 		void onReceiveFrom(AsyncUdpSocket* socket, const SocketAddress& address, void* data, sl_uint32 sizeReceive) override;
 		
+		void _onReceiveQuestion(_priv_DnsServer_Worker* worker, sl_bool flagEncrypted, const SocketAddress& address, void* data, sl_uint32 size);
+		
+		void _onReceiveAnswer(_priv_DnsServer_Worker* worker, sl_uint32 indexForwarder, const SocketAddress& addressFrom, void* data, sl_uint32 size);
+		
 	protected:
 		void _resolveDnsHost(DnsResolveHostParam& param);
 		
@@ -615,9 +684,10 @@ namespace slib
 		sl_bool m_flagInit;
 		sl_bool m_flagRunning;
 		
-		Ref<AsyncUdpSocket> m_udpDns;
+		List< Ref<_priv_DnsServer_Worker> > m_workers;
+		// created by the server for the multiple workers
+		List< Ref<AsyncIoLoop> > m_ioLoops;
 		
-		Ref<AsyncUdpSocket> m_udpEncrypt;
 		AES m_encrypt;
 		
 		sl_bool m_flagProxy;
@@ -625,19 +695,17 @@ namespace slib
 		SocketAddress m_defaultForwardAddress;
 		sl_bool m_flagEncryptDefaultForward;
 		
-		sl_uint16 m_lastForwardId;
-		
-		struct ForwardElement
-		{
-			SocketAddress clientAddress;
-			sl_uint16 requestedId;
-			String requestedHostName;
-			sl_bool flagEncrypted;
-		};
-		CHashMap<sl_uint16, ForwardElement> m_mapForward;
+		Ref<_priv_DnsServer_Cache> m_cache;
+		sl_uint32 m_cacheMinimumTTL;
+		sl_uint32 m_cacheMaximumTTL;
+		sl_uint32 m_cacheNegativeTTL;
+		sl_uint32 m_prefetchPercent;
+		sl_uint32 m_forwardTimeout;
 		
 		Ptr<IDnsServerListener> m_listener;
 		
+		friend class _priv_DnsServer_Worker;
+		
 	};
 
 }
@@ -43,6 +43,8 @@ namespace slib
 		
 		void copyFromFile(const String& path, const Ref<Dispatcher>& dispatcher);
 		
+		void sendFile(const Ref<File>& file, sl_uint64 offset, sl_uint64 size);
+		
 		sl_uint64 getOutputLength() const;
 		
 	protected:
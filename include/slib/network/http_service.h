@@ -18,6 +18,7 @@
 #include "socket_address.h"
 
 #include "../core/thread_pool.h"
+#include "../core/expire.h"
 
 namespace slib
 {
@@ -66,6 +67,13 @@ namespace slib
 		
 		void completeResponse();
 		
+		// parameters captured from the request path by the router (`/user/:id`)
+		const HashMap<String, String>& getPathParameters() const;
+		
+		String getPathParameter(const String& name) const;
+		
+		void setPathParameter(const String& name, const String& value);
+		
 	public:
 		SLIB_BOOLEAN_PROPERTY(ClosingConnection);
 		SLIB_BOOLEAN_PROPERTY(ProcessingByThread);
@@ -77,6 +85,7 @@ namespace slib
 		MemoryQueue m_requestBodyBuffer;
 		AtomicMemory m_requestBody;
 		sl_bool m_flagAsynchronousResponse;
+		HashMap<String, String> m_pathParameters;
 		
 	private:
 		WeakRef<HttpServiceConnection> m_connection;
@@ -201,6 +210,9 @@ namespace slib
 		sl_uint32 maxThreadsCount;
 		sl_bool flagProcessByThreads;
 		
+		// number of I/O loops (default: 1). 0 means the number of processors
+		sl_uint32 ioLoopsCount;
+		
 		sl_bool flagUseAsset;
 		String prefixAsset;
 		
@@ -210,6 +222,13 @@ namespace slib
 		sl_bool flagAllowCrossOrigin;
 		sl_bool flagAlwaysRespondAcceptRangesHeader;
 		
+		// sends the files by zero-copy transfer (sendfile) when the connection supports it (default: true)
+		sl_bool flagUseSendFile;
+		// milliseconds to keep the opened files used by zero-copy transfer, 0 disables the cache (default: 10000)
+		sl_uint32 fileCacheDuration;
+		// maximum number of the opened files kept by the cache (default: 256)
+		sl_uint32 maxCachedFiles;
+		
 		sl_bool flagLogDebug;
 		
 		Ptr<IHttpServiceProcessor> processor;
@@ -224,6 +243,8 @@ namespace slib
 		
 	};
 	
+	class _priv_HttpService_CachedFile;
+	
 	class SLIB_EXPORT HttpService : public Object
 	{
 		SLIB_DECLARE_OBJECT
@@ -243,6 +264,11 @@ namespace slib
 		
 		Ref<AsyncIoLoop> getAsyncIoLoop();
 		
+		List< Ref<AsyncIoLoop> > getAsyncIoLoops();
+		
+		// selects the I/O loop for a new connection in round-robin order
+		Ref<AsyncIoLoop> getNextAsyncIoLoop();
+		
 		Ref<ThreadPool> getThreadPool();
 		
 		const HttpServiceParam& getParam();
@@ -290,8 +316,13 @@ namespace slib
 	protected:
 		sl_bool _init(const HttpServiceParam& param);
 		
+		// opened file for zero-copy transfer, validated by the modified time
+		Ref<File> _openFileForSending(const String& path, sl_uint64& outSize);
+		
 	protected:
 		AtomicRef<AsyncIoLoop> m_ioLoop;
+		AtomicList< Ref<AsyncIoLoop> > m_ioLoops;
+		sl_uint32 m_indexNextIoLoop;
 		AtomicRef<ThreadPool> m_threadPool;
 		sl_bool m_flagRunning;
 		
@@ -303,6 +334,8 @@ namespace slib
 		
 		HttpServiceParam m_param;
 		
+		ExpiringMap< String, Ref<_priv_HttpService_CachedFile> > m_cachedFiles;
+		
 	};
 
 }
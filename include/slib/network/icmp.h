@@ -188,6 +188,9 @@ namespace slib
 		
 		sl_bool checkChecksum(sl_uint32 sizeContent) const;
 		
+		// checks only the header size, without the checksum
+		sl_bool checkSize(sl_uint32 sizeContent) const;
+		
 		sl_bool check(sl_uint32 sizeContent) const;
 		
 		sl_uint16 getEchoIdentifier() const;
@@ -97,6 +97,12 @@ namespace slib
 
 		static sl_uint16 calculateChecksum(const void* data, sl_size size);
 
+		// incremental update (RFC 1624) of the checksum when a 16-bit word of the data is changed
+		static sl_uint16 adjustChecksum(sl_uint16 checksum, sl_uint16 oldValue, sl_uint16 newValue);
+
+		// incremental update (RFC 1624) of the checksum when a 32-bit aligned value (IPv4 address) of the data is changed
+		static sl_uint16 adjustChecksum32(sl_uint16 checksum, sl_uint32 oldValue, sl_uint32 newValue);
+
 	};
 
 	class SLIB_EXPORT IPv4Packet
@@ -325,6 +331,9 @@ namespace slib
 		
 		sl_bool checkChecksum(const IPv4Packet* ipv4, sl_uint32 sizeContent) const;
 
+		// checks only the header size, without the checksum
+		sl_bool checkSize(sl_uint32 sizeContent) const;
+
 		sl_bool check(IPv4Packet* ip, sl_uint32 sizeContent) const;
 
 		sl_uint16 getUrgentPointer() const;
@@ -384,6 +393,9 @@ namespace slib
 		
 		sl_bool checkChecksum(const IPv4Packet* ipv4) const;
 
+		// checks only the header and total size, without the checksum
+		sl_bool checkSize(sl_uint32 sizeContent) const;
+
 		sl_bool check(IPv4Packet* ip, sl_uint32 sizeContent) const;
 		
 		const sl_uint8* getContent() const;
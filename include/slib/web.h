@@ -14,5 +14,6 @@
 #include "web/constants.h"
 #include "web/service.h"
 #include "web/controller.h"
+#include "web/router.h"
 
 #endif
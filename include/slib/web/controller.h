@@ -13,17 +13,11 @@
 
 #include "definition.h"
 
-#include "../core/function.h"
-#include "../core/variant.h"
-#include "../network/http_service.h"
-
-#define SWEB_HANDLER_PARAMS_LIST const slib::Ref<slib::HttpServiceContext>& context, HttpMethod method, const slib::String& path
+#include "router.h"
 
 namespace slib
 {
 
-	typedef Function<Variant(SWEB_HANDLER_PARAMS_LIST)> WebHandler;
-
 	class WebController : public Object, public IHttpServiceProcessor
 	{
 		SLIB_DECLARE_OBJECT
@@ -35,16 +29,14 @@ namespace slib
 		static Ref<WebController> create();
 		
 	public:
+		// `path` can contain parameters (`/user/:id`) and wildcard (`/static/*file`). Literal ':' and '*' are escaped by '\\', see router.h
 		void registerHandler(HttpMethod method, const String& path, const WebHandler& handler);
 		
 	protected:
 		sl_bool onHttpRequest(const Ref<HttpServiceContext>& context) override;
 		
 	protected:
-		static String _getHandlerSignature(HttpMethod method, const String& path);
-		
-	protected:
-		CMap<String, WebHandler> m_handlers;
+		WebRouter m_router;
 		
 		friend class WebModule;
 		
@@ -95,4 +87,8 @@ namespace SWEB_MODULE_##NAME { \
 #define SWEB_FLOAT_PARAM(NAME, ...) float NAME = context->getParameter(#NAME).parseFloat(##__VA_ARGS__);
 #define SWEB_DOUBLE_PARAM(NAME, ...) double NAME = context->getParameter(#NAME).parseDouble(##__VA_ARGS__);
 
+#define SWEB_STRING_PATH_PARAM(NAME) slib::String NAME = context->getPathParameter(#NAME);
+#define SWEB_INT_PATH_PARAM(NAME, ...) sl_int32 NAME = context->getPathParameter(#NAME).parseInt32(10, ##__VA_ARGS__);
+#define SWEB_INT64_PATH_PARAM(NAME, ...) sl_int64 NAME = context->getPathParameter(#NAME).parseInt64(10, ##__VA_ARGS__);
+
 #endif
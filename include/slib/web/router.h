@@ -0,0 +1,98 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef CHECKHEADER_SLIB_WEB_ROUTER
+#define CHECKHEADER_SLIB_WEB_ROUTER
+
+#include "definition.h"
+
+#include "../core/function.h"
+#include "../core/variant.h"
+#include "../core/rw_lock.h"
+#include "../network/http_service.h"
+
+#define SWEB_HANDLER_PARAMS_LIST const slib::Ref<slib::HttpServiceContext>& context, HttpMethod method, const slib::String& path
+
+#define SLIB_WEB_ROUTER_MAX_PARAMS 16
+
+// Radix tree of the route patterns
+//
+// "/user/list"          exact path
+// "/user/:id"           `:name` matches one path segment (up to the next '/')
+// "/user/:id/posts"
+// "/static/*file"       `*name` matches the rest of the path (must be the last part)
+// "/time/12\:00"        `\:`, `\*` and `\\` match the literal characters ("\\:" in C++ string literals)
+//
+// ':' and '*' always start a parameter. The paths containing them literally (matched exactly before the router)
+// must be registered with the escapes.
+// Static parts have higher priority than `:name`, and `:name` has higher priority than `*name`.
+// Routes registered with HttpMethod::Unknown match any method.
+// The tree is flattened into arrays on the first match after the changes.
+// Matching does not allocate memory; the captured parameters are returned as ranges of the path.
+
+namespace slib
+{
+
+	typedef Function<Variant(SWEB_HANDLER_PARAMS_LIST)> WebHandler;
+
+	class _priv_WebRouter_Node;
+	class _priv_WebRouter_Table;
+
+	class SLIB_EXPORT WebRouterMatch
+	{
+	public:
+		WebHandler handler;
+		// names of the parameters, in order of the pattern
+		List<String> names;
+		sl_uint32 countParams;
+		struct Param
+		{
+			sl_size start;
+			sl_size length;
+		} params[SLIB_WEB_ROUTER_MAX_PARAMS];
+
+	public:
+		WebRouterMatch();
+
+		~WebRouterMatch();
+
+	};
+
+	class SLIB_EXPORT WebRouter
+	{
+	public:
+		WebRouter();
+
+		~WebRouter();
+
+	public:
+		sl_bool add(HttpMethod method, const String& pattern, const WebHandler& handler);
+
+		sl_bool match(HttpMethod method, const String& path, WebRouterMatch& result) const;
+
+		sl_bool match(HttpMethod method, const sl_char8* path, sl_size lenPath, WebRouterMatch& result) const;
+
+		void removeAll();
+
+	private:
+		WebRouter(const WebRouter& other) = delete;
+
+		WebRouter& operator=(const WebRouter& other) = delete;
+
+	protected:
+		_priv_WebRouter_Node* m_root;
+		_priv_WebRouter_Table* m_table;
+		ReadWriteLock m_lock;
+
+	};
+
+}
+
+#endif
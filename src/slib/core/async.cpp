@@ -384,7 +384,7 @@ namespace slib
 		Referable* _userObject,
 		const Function<void(AsyncStreamResult*)>& _callback,
 		sl_bool _flagRead)
-	 : data((void*)_data), size(_size), userObject(_userObject), callback(_callback), flagRead(_flagRead)
+	 : data((void*)_data), size(_size), userObject(_userObject), callback(_callback), flagRead(_flagRead), offsetFile(0)
 	{
 	}
 
@@ -406,6 +406,24 @@ namespace slib
 		return new AsyncStreamRequest(data, size, userObject, callback, sl_false);
 	}
 
+	Ref<AsyncStreamRequest> AsyncStreamRequest::createWriteFromFile(
+		const Ref<File>& file,
+		sl_uint64 offset,
+		sl_uint32 size,
+		Referable* userObject,
+		const Function<void(AsyncStreamResult*)>& callback)
+	{
+		if (file.isNull()) {
+			return sl_null;
+		}
+		Ref<AsyncStreamRequest> ret = new AsyncStreamRequest(sl_null, size, userObject, callback, sl_false);
+		if (ret.isNotNull()) {
+			ret->file = file;
+			ret->offsetFile = offset;
+		}
+		return ret;
+	}
+
 	void AsyncStreamRequest::runCallback(AsyncStream* stream, sl_uint32 resultSize, sl_bool flagError)
 	{
 		if (callback.isNotNull()) {
@@ -451,6 +469,16 @@ namespace slib
 		return sl_false;
 	}
 
+	sl_bool AsyncStreamInstance::isWritingFromFileSupported()
+	{
+		return sl_false;
+	}
+
+	sl_bool AsyncStreamInstance::writeFromFile(const Ref<File>& file, sl_uint64 offset, sl_uint32 size, const Function<void(AsyncStreamResult*)>& callback, Referable* userObject)
+	{
+		return sl_false;
+	}
+
 	sl_bool AsyncStreamInstance::isSeekable()
 	{
 		return sl_false;
@@ -545,6 +573,16 @@ namespace slib
 		return sl_null;
 	}
 
+	sl_bool AsyncStream::isWritingFromFileSupported()
+	{
+		return sl_false;
+	}
+
+	sl_bool AsyncStream::writeFromFile(const Ref<File>& file, sl_uint64 offset, sl_uint32 size, const Function<void(AsyncStreamResult*)>& callback, Referable* userObject)
+	{
+		return sl_false;
+	}
+
 	sl_bool AsyncStream::isSeekable()
 	{
 		return sl_false;
@@ -658,6 +696,31 @@ namespace slib
 		return sl_false;
 	}
 
+	sl_bool AsyncStreamBase::isWritingFromFileSupported()
+	{
+		Ref<AsyncStreamInstance> instance = getIoInstance();
+		if (instance.isNotNull()) {
+			return instance->isWritingFromFileSupported();
+		}
+		return sl_false;
+	}
+
+	sl_bool AsyncStreamBase::writeFromFile(const Ref<File>& file, sl_uint64 offset, sl_uint32 size, const Function<void(AsyncStreamResult*)>& callback, Referable* userObject)
+	{
+		Ref<AsyncIoLoop> loop = getIoLoop();
+		if (loop.isNull()) {
+			return sl_false;
+		}
+		Ref<AsyncStreamInstance> instance = getIoInstance();
+		if (instance.isNotNull()) {
+			if (instance->writeFromFile(file, offset, size, callback, userObject)) {
+				loop->requestOrder(instance.get());
+				return sl_true;
+			}
+		}
+		return sl_false;
+	}
+
 	sl_bool AsyncStreamBase::isSeekable()
 	{
 		Ref<AsyncStreamInstance> instance = getIoInstance();
@@ -1444,18 +1507,21 @@ namespace slib
 	AsyncOutputBufferElement::AsyncOutputBufferElement()
 	{
 		m_sizeBody = 0;
+		m_offsetBodyFile = 0;
 	}
 
 	AsyncOutputBufferElement::AsyncOutputBufferElement(const Memory& header)
 	{
 		m_header.add(header);
 		m_sizeBody = 0;
+		m_offsetBodyFile = 0;
 	}
 
 	AsyncOutputBufferElement::AsyncOutputBufferElement(AsyncStream* stream, sl_uint64 size)
 	{
 		m_body = stream;
 		m_sizeBody = size;
+		m_offsetBodyFile = 0;
 	}
 
 	AsyncOutputBufferElement::~AsyncOutputBufferElement()
@@ -1464,7 +1530,7 @@ namespace slib
 
 	sl_bool AsyncOutputBufferElement::isEmpty() const
 	{
-		if (m_header.getSize() == 0 && (m_sizeBody == 0 || m_body.isNull())) {
+		if (m_header.getSize() == 0 && isEmptyBody()) {
 			return sl_true;
 		}
 		return sl_false;
@@ -1472,7 +1538,7 @@ namespace slib
 
 	sl_bool AsyncOutputBufferElement::isEmptyBody() const
 	{
-		if (m_sizeBody == 0 || m_body.isNull()) {
+		if (m_sizeBody == 0 || (m_body.isNull() && m_bodyFile.isNull())) {
 			return sl_true;
 		}
 		return sl_false;
@@ -1489,6 +1555,13 @@ namespace slib
 		m_sizeBody = size;
 	}
 
+	void AsyncOutputBufferElement::setBodyFile(const Ref<File>& file, sl_uint64 offset, sl_uint64 size)
+	{
+		m_bodyFile = file;
+		m_offsetBodyFile = offset;
+		m_sizeBody = size;
+	}
+
 	MemoryQueue& AsyncOutputBufferElement::getHeader()
 	{
 		return m_header;
@@ -1499,11 +1572,32 @@ namespace slib
 		return m_body;
 	}
 
+	Ref<File> AsyncOutputBufferElement::getBodyFile()
+	{
+		return m_bodyFile;
+	}
+
+	sl_uint64 AsyncOutputBufferElement::getBodyFileOffset()
+	{
+		return m_offsetBodyFile;
+	}
+
 	sl_uint64 AsyncOutputBufferElement::getBodySize()
 	{
 		return m_sizeBody;
 	}
 
+	void AsyncOutputBufferElement::skipBodyFile(sl_uint64 size)
+	{
+		if (size >= m_sizeBody) {
+			m_sizeBody = 0;
+			m_bodyFile.setNull();
+		} else {
+			m_sizeBody -= size;
+			m_offsetBodyFile += size;
+		}
+	}
+
 
 /**********************************************
 		AsyncOutputBuffer
@@ -1617,6 +1711,35 @@ namespace slib
 		return sl_true;
 	}
 
+	sl_bool AsyncOutputBuffer::sendFile(const Ref<File>& file, sl_uint64 offset, sl_uint64 size)
+	{
+		if (size == 0) {
+			return sl_true;
+		}
+		if (file.isNull()) {
+			return sl_false;
+		}
+		ObjectLocker lock(this);
+		Link< Ref<AsyncOutputBufferElement> >* link = m_queueOutput.getBack();
+		if (link && link->value->isEmptyBody()) {
+			link->value->setBodyFile(file, offset, size);
+			m_lengthOutput += size;
+		} else {
+			Ref<AsyncOutputBufferElement> data = new AsyncOutputBufferElement;
+			if (data.isNotNull()) {
+				data->setBodyFile(file, offset, size);
+				if (m_queueOutput.push(data)) {
+					m_lengthOutput += size;
+				} else {
+					return sl_false;
+				}
+			} else {
+				return sl_false;
+			}
+		}
+		return sl_true;
+	}
+
 	sl_uint64 AsyncOutputBuffer::getOutputLength() const
 	{
 		return m_lengthOutput;
@@ -1625,6 +1748,8 @@ namespace slib
 /**********************************************
 				AsyncOutput
 **********************************************/
+#define ASYNC_OUTPUT_SEND_FILE_SIZE 0x1000000
+
 	IAsyncOutputListener::IAsyncOutputListener()
 	{
 	}
@@ -1752,6 +1877,35 @@ namespace slib
 			}
 		} else {
 			sl_uint64 sizeBody = m_elementWriting->getBodySize();
+			Ref<File> file = m_elementWriting->getBodyFile();
+			if (sizeBody != 0 && file.isNotNull()) {
+				sl_uint64 offset = m_elementWriting->getBodyFileOffset();
+				if (m_streamOutput->isWritingFromFileSupported()) {
+					sl_uint32 size = sizeBody > ASYNC_OUTPUT_SEND_FILE_SIZE ? ASYNC_OUTPUT_SEND_FILE_SIZE : (sl_uint32)sizeBody;
+					m_elementWriting->skipBodyFile(size);
+					m_flagWriting = sl_true;
+					if (!(m_streamOutput->writeFromFile(file, offset, size, SLIB_FUNCTION_WEAKREF(AsyncOutput, onWriteStream, this)))) {
+						m_flagWriting = sl_false;
+						_onError();
+					}
+				} else {
+					sl_uint32 size = (sl_uint32)(m_bufWrite.getSize());
+					if (sizeBody < size) {
+						size = (sl_uint32)sizeBody;
+					}
+					if (file->readFullyAt(offset, m_bufWrite.getData(), size) == (sl_reg)size) {
+						m_elementWriting->skipBodyFile(size);
+						m_flagWriting = sl_true;
+						if (!(m_streamOutput->write(m_bufWrite.getData(), size, SLIB_FUNCTION_WEAKREF(AsyncOutput, onWriteStream, this), m_bufWrite.ref.get()))) {
+							m_flagWriting = sl_false;
+							_onError();
+						}
+					} else {
+						_onError();
+					}
+				}
+				return;
+			}
 			Ref<AsyncStream> body = m_elementWriting->getBody();
 			if (sizeBody != 0 && body.isNotNull()) {
 				m_flagWriting = sl_true;
@@ -13,6 +13,18 @@
 #include "slib/core/base.h"
 #include "slib/core/time.h"
 #include "slib/core/system.h"
+#include "slib/core/spin_lock.h"
+
+#if defined(SLIB_PLATFORM_IS_WINDOWS)
+#define USE_CPP_ATOMIC
+#endif
+
+#if defined(USE_CPP_ATOMIC)
+#include <atomic>
+#endif
+
+#define PRIV_HAZARD_POINTER_CACHE_LINE 64
+#define PRIV_HAZARD_POINTER_SLOTS 4
 
 namespace slib
 {
@@ -66,4 +78,308 @@ namespace slib
 		return sl_false;
 	}
 
+
+	SLIB_INLINE static void* _priv_HazardPointer_load(void* const volatile* ptr) noexcept
+	{
+#if defined(USE_CPP_ATOMIC)
+		return ((std::atomic<void*>*)(ptr))->load(std::memory_order_seq_cst);
+#else
+		return __atomic_load_n((void**)ptr, __ATOMIC_SEQ_CST);
+#endif
+	}
+
+	SLIB_INLINE static void _priv_HazardPointer_store(void* volatile* ptr, void* value) noexcept
+	{
+#if defined(USE_CPP_ATOMIC)
+		((std::atomic<void*>*)(ptr))->store(value, std::memory_order_seq_cst);
+#else
+		__atomic_store_n((void**)ptr, value, __ATOMIC_SEQ_CST);
+#endif
+	}
+
+	SLIB_INLINE static void _priv_HazardPointer_clear(void* volatile* ptr) noexcept
+	{
+#if defined(USE_CPP_ATOMIC)
+		((std::atomic<void*>*)(ptr))->store(sl_null, std::memory_order_release);
+#else
+		__atomic_store_n((void**)ptr, sl_null, __ATOMIC_RELEASE);
+#endif
+	}
+
+	struct _priv_HazardPointer_Record
+	{
+		// slot 0 is used by `protect()`, and the others by `borrow()`
+		void* volatile hazards[PRIV_HAZARD_POINTER_SLOTS];
+		sl_int32 flagUsed;
+		_priv_HazardPointer_Record* next;
+		// allocated block containing the aligned record, null for the shared record
+		void* memory;
+	};
+
+	// used under the lock by the threads failed to allocate their records
+	SLIB_ALIGN(PRIV_HAZARD_POINTER_CACHE_LINE) static _priv_HazardPointer_Record _g_priv_HazardPointer_recordShared = { { sl_null }, 1, sl_null, sl_null };
+	static SpinLock _g_priv_HazardPointer_lockShared;
+
+	// records are reused by the next threads, and never freed because any thread (also while exiting) can walk the list
+	static _priv_HazardPointer_Record* volatile _g_priv_HazardPointer_head = &_g_priv_HazardPointer_recordShared;
+
+	struct _priv_HazardPointer_Retired
+	{
+		void* ptr;
+		_priv_HazardPointer::ReleaseFunction release;
+		_priv_HazardPointer_Retired* next;
+	};
+
+	// retired pointers left by the exited threads, taken by the next scan of any thread
+	static _priv_HazardPointer_Retired* volatile _g_priv_HazardPointer_orphans = sl_null;
+
+	static sl_bool _priv_HazardPointer_isPublished(const void* ptr) noexcept
+	{
+		_priv_HazardPointer_Record* record = (_priv_HazardPointer_Record*)(_priv_HazardPointer_load((void* const volatile*)&_g_priv_HazardPointer_head));
+		while (record) {
+			for (sl_uint32 i = 0; i < PRIV_HAZARD_POINTER_SLOTS; i++) {
+				if (_priv_HazardPointer_load(&(record->hazards[i])) == ptr) {
+					return sl_true;
+				}
+			}
+			record = record->next;
+		}
+		return sl_false;
+	}
+
+	static void _priv_HazardPointer_addOrphans(_priv_HazardPointer_Retired* first) noexcept
+	{
+		_priv_HazardPointer_Retired* last = first;
+		while (last->next) {
+			last = last->next;
+		}
+		do {
+			last->next = (_priv_HazardPointer_Retired*)(_priv_HazardPointer_load((void* const volatile*)&_g_priv_HazardPointer_orphans));
+		} while (!(Base::interlockedCompareExchangePtr((void**)&_g_priv_HazardPointer_orphans, first, last->next)));
+	}
+
+	class _priv_HazardPointer_ThreadRecord
+	{
+	public:
+		_priv_HazardPointer_Record* record;
+		// slots used by `borrow()`
+		sl_uint32 maskBorrowed;
+		// replaced pointers still published by any thread
+		_priv_HazardPointer_Retired* retired;
+		sl_bool flagExited;
+
+	public:
+		_priv_HazardPointer_ThreadRecord() noexcept: record(sl_null), maskBorrowed(0), retired(sl_null), flagExited(sl_false) {}
+
+		~_priv_HazardPointer_ThreadRecord() noexcept
+		{
+			if (record) {
+				for (sl_uint32 i = 0; i < PRIV_HAZARD_POINTER_SLOTS; i++) {
+					_priv_HazardPointer_clear(&(record->hazards[i]));
+				}
+			}
+			maskBorrowed = 0;
+			scan();
+			// `retire()` called by the destructors of the other thread-local objects adds to the orphans from now on
+			flagExited = sl_true;
+			if (retired) {
+				_priv_HazardPointer_addOrphans(retired);
+				retired = sl_null;
+			}
+			if (record) {
+				for (sl_uint32 i = 0; i < PRIV_HAZARD_POINTER_SLOTS; i++) {
+					_priv_HazardPointer_clear(&(record->hazards[i]));
+				}
+				Base::interlockedCompareExchange32(&(record->flagUsed), 0, 1);
+				record = sl_null;
+			}
+		}
+
+	public:
+		// releases the retired pointers not published any more
+		void scan() noexcept
+		{
+			if (_priv_HazardPointer_load((void* const volatile*)&_g_priv_HazardPointer_orphans)) {
+				_priv_HazardPointer_Retired* orphans = (_priv_HazardPointer_Retired*)(_priv_HazardPointer::exchange((void* volatile*)&_g_priv_HazardPointer_orphans, sl_null));
+				while (orphans) {
+					_priv_HazardPointer_Retired* next = orphans->next;
+					orphans->next = retired;
+					retired = orphans;
+					orphans = next;
+				}
+			}
+			// detached from the thread, because releasing an object can retire other pointers
+			_priv_HazardPointer_Retired* item = retired;
+			retired = sl_null;
+			while (item) {
+				_priv_HazardPointer_Retired* next = item->next;
+				if (_priv_HazardPointer_isPublished(item->ptr)) {
+					item->next = retired;
+					retired = item;
+				} else {
+					void* ptr = item->ptr;
+					_priv_HazardPointer::ReleaseFunction release = item->release;
+					Base::freeMemory(item);
+					release(ptr);
+				}
+				item = next;
+			}
+		}
+
+	};
+
+	SLIB_THREAD _priv_HazardPointer_ThreadRecord _gt_priv_HazardPointer_record;
+
+	// returns null on lack of memory
+	static _priv_HazardPointer_Record* _priv_HazardPointer_getRecord(_priv_HazardPointer_ThreadRecord& thread) noexcept
+	{
+		_priv_HazardPointer_Record* record = thread.record;
+		if (record) {
+			return record;
+		}
+		record = (_priv_HazardPointer_Record*)(_priv_HazardPointer_load((void* const volatile*)&_g_priv_HazardPointer_head));
+		while (record) {
+			if (!(record->flagUsed) && Base::interlockedCompareExchange32(&(record->flagUsed), 1, 0)) {
+				thread.record = record;
+				return record;
+			}
+			record = record->next;
+		}
+		// one record per cache line
+		sl_uint8* mem = (sl_uint8*)(Base::createMemory(PRIV_HAZARD_POINTER_CACHE_LINE * 2));
+		if (!mem) {
+			return sl_null;
+		}
+		record = (_priv_HazardPointer_Record*)(mem + PRIV_HAZARD_POINTER_CACHE_LINE - ((sl_size)mem & (PRIV_HAZARD_POINTER_CACHE_LINE - 1)));
+		for (sl_uint32 i = 0; i < PRIV_HAZARD_POINTER_SLOTS; i++) {
+			record->hazards[i] = sl_null;
+		}
+		record->flagUsed = 1;
+		record->memory = mem;
+		do {
+			record->next = (_priv_HazardPointer_Record*)(_priv_HazardPointer_load((void* const volatile*)&_g_priv_HazardPointer_head));
+		} while (!(Base::interlockedCompareExchangePtr((void**)&_g_priv_HazardPointer_head, record, record->next)));
+		thread.record = record;
+		return record;
+	}
+
+	// publishes the value of `*ptr` in `slot`. returns null (not published) if the value is null
+	static void* _priv_HazardPointer_publish(void* volatile* slot, void* const volatile* ptr) noexcept
+	{
+		void* value = _priv_HazardPointer_load(ptr);
+		while (value) {
+			_priv_HazardPointer_store(slot, value);
+			// validates that the value was not replaced before publishing
+			void* check = _priv_HazardPointer_load(ptr);
+			if (check == value) {
+				return value;
+			}
+			value = check;
+		}
+		_priv_HazardPointer_clear(slot);
+		return sl_null;
+	}
+
+	void* _priv_HazardPointer::protect(void* const volatile* ptr) noexcept
+	{
+		if (!(_priv_HazardPointer_load(ptr))) {
+			return sl_null;
+		}
+		_priv_HazardPointer_Record* record = _priv_HazardPointer_getRecord(_gt_priv_HazardPointer_record);
+		if (record) {
+			return _priv_HazardPointer_publish(&(record->hazards[0]), ptr);
+		}
+		// the lock is kept until `release()`
+		_g_priv_HazardPointer_lockShared.lock();
+		void* value = _priv_HazardPointer_publish(&(_g_priv_HazardPointer_recordShared.hazards[0]), ptr);
+		if (!value) {
+			_g_priv_HazardPointer_lockShared.unlock();
+		}
+		return value;
+	}
+
+	void _priv_HazardPointer::release() noexcept
+	{
+		_priv_HazardPointer_Record* record = _gt_priv_HazardPointer_record.record;
+		if (record) {
+			_priv_HazardPointer_clear(&(record->hazards[0]));
+		} else {
+			_priv_HazardPointer_clear(&(_g_priv_HazardPointer_recordShared.hazards[0]));
+			_g_priv_HazardPointer_lockShared.unlock();
+		}
+	}
+
+	sl_bool _priv_HazardPointer::borrow(void* const volatile* ptr, void*& outValue, sl_uint32& outSlot) noexcept
+	{
+		_priv_HazardPointer_ThreadRecord& thread = _gt_priv_HazardPointer_record;
+		_priv_HazardPointer_Record* record = _priv_HazardPointer_getRecord(thread);
+		if (!record) {
+			return sl_false;
+		}
+		sl_uint32 slot = 1;
+		while (thread.maskBorrowed & (1 << slot)) {
+			slot++;
+			if (slot >= PRIV_HAZARD_POINTER_SLOTS) {
+				return sl_false;
+			}
+		}
+		void* value = _priv_HazardPointer_publish(&(record->hazards[slot]), ptr);
+		if (value) {
+			thread.maskBorrowed |= 1 << slot;
+			outSlot = slot;
+		} else {
+			outSlot = 0;
+		}
+		outValue = value;
+		return sl_true;
+	}
+
+	void _priv_HazardPointer::giveBack(sl_uint32 slot) noexcept
+	{
+		_priv_HazardPointer_ThreadRecord& thread = _gt_priv_HazardPointer_record;
+		_priv_HazardPointer_clear(&(thread.record->hazards[slot]));
+		thread.maskBorrowed &= ~(1 << slot);
+		if (thread.retired) {
+			// this thread may have replaced the object it borrowed
+			thread.scan();
+		}
+	}
+
+	void* _priv_HazardPointer::exchange(void* volatile* ptr, void* value) noexcept
+	{
+#if defined(USE_CPP_ATOMIC)
+		return ((std::atomic<void*>*)(ptr))->exchange(value, std::memory_order_seq_cst);
+#else
+		return __atomic_exchange_n((void**)ptr, value, __ATOMIC_SEQ_CST);
+#endif
+	}
+
+	void _priv_HazardPointer::retire(void* ptr, ReleaseFunction release) noexcept
+	{
+		_priv_HazardPointer_ThreadRecord& thread = _gt_priv_HazardPointer_record;
+		if (!(thread.flagExited)) {
+			if (thread.retired || _priv_HazardPointer_load((void* const volatile*)&_g_priv_HazardPointer_orphans)) {
+				thread.scan();
+			}
+		}
+		if (!(_priv_HazardPointer_isPublished(ptr))) {
+			release(ptr);
+			return;
+		}
+		_priv_HazardPointer_Retired* item = (_priv_HazardPointer_Retired*)(Base::createMemory(sizeof(_priv_HazardPointer_Retired)));
+		if (!item) {
+			// the reference is leaked instead of waiting for the readers
+			return;
+		}
+		item->ptr = ptr;
+		item->release = release;
+		if (thread.flagExited) {
+			item->next = sl_null;
+			_priv_HazardPointer_addOrphans(item);
+		} else {
+			item->next = thread.retired;
+			thread.retired = item;
+		}
+	}
+
 }
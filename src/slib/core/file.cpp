@@ -120,6 +120,40 @@ namespace slib
 		return m_file;
 	}
 
+	sl_reg File::readAt(sl_uint64 offset, void* _buf, sl_size size)
+	{
+		char* buf = (char*)_buf;
+		if (size == 0) {
+			return 0;
+		}
+		sl_size n = size;
+		if (n > 0x40000000) {
+			n = 0x40000000; // 1GB
+		}
+		return readAt32(offset, buf, (sl_uint32)n);
+	}
+
+	sl_reg File::readFullyAt(sl_uint64 offset, void* _buf, sl_size size)
+	{
+		char* buf = (char*)_buf;
+		if (size == 0) {
+			return 0;
+		}
+		sl_size nRead = 0;
+		while (nRead < size) {
+			sl_reg m = readAt(offset + nRead, buf + nRead, size - nRead);
+			if (m <= 0) {
+				if (nRead) {
+					return nRead;
+				} else {
+					return m;
+				}
+			}
+			nRead += m;
+		}
+		return nRead;
+	}
+
 	sl_uint64 File::getSize()
 	{
 		return getSize(m_file);
@@ -599,6 +633,207 @@ namespace slib
 	}
 
 
+	MappedFileParam::MappedFileParam()
+	{
+		mode = MappedFileMode::ReadOnly;
+		offset = 0;
+		size = 0;
+		advice = MappedFileAdvice::Normal;
+		flagHugePages = sl_false;
+		flagPopulate = sl_false;
+	}
+
+	MappedFileParam::~MappedFileParam()
+	{
+	}
+
+
+	class _priv_MappedFile_View : public Referable
+	{
+	public:
+		void* base;
+		sl_size sizeMapped;
+		void* handle;
+
+	public:
+		_priv_MappedFile_View(void* _base, sl_size _sizeMapped, void* _handle): base(_base), sizeMapped(_sizeMapped), handle(_handle)
+		{
+		}
+
+		~_priv_MappedFile_View()
+		{
+			MappedFile::_unmap(base, sizeMapped, handle);
+		}
+
+	};
+
+	SLIB_DEFINE_OBJECT(MappedFile, Object)
+
+	MappedFile::MappedFile()
+	{
+		m_mode = MappedFileMode::ReadOnly;
+		m_offset = 0;
+		m_data = sl_null;
+		m_size = 0;
+		m_base = sl_null;
+		m_sizeMapped = 0;
+		m_handle = sl_null;
+	}
+
+	MappedFile::~MappedFile()
+	{
+		close();
+	}
+
+	Ref<MappedFile> MappedFile::open(const MappedFileParam& param)
+	{
+		Ref<File> file = param.file;
+		if (file.isNull()) {
+			if (param.mode == MappedFileMode::SharedWrite) {
+				file = File::open(param.filePath, FileMode::ReadWrite | FileMode::NotTruncate, FilePermissions::All | FilePermissions::ShareReadWrite);
+			} else {
+				file = File::openForRead(param.filePath);
+			}
+			if (file.isNull()) {
+				return sl_null;
+			}
+		}
+		sl_uint64 offset = param.offset;
+		sl_uint64 size = param.size;
+		sl_uint64 sizeFile = file->getSize();
+		if (size) {
+			if (offset + size > sizeFile) {
+				if (param.mode == MappedFileMode::SharedWrite) {
+					if (!(file->setSize(offset + size))) {
+						return sl_null;
+					}
+				} else {
+					// the pages after the end of the file are not accessible
+					if (offset >= sizeFile) {
+						return sl_null;
+					}
+					size = sizeFile - offset;
+				}
+			}
+		} else {
+			if (offset >= sizeFile) {
+				return sl_null;
+			}
+			size = sizeFile - offset;
+		}
+		if (size > SLIB_SIZE_MAX) {
+			return sl_null;
+		}
+		Ref<MappedFile> ret = new MappedFile;
+		if (ret.isNotNull()) {
+			ret->m_file = file;
+			ret->m_mode = param.mode;
+			ret->m_offset = offset;
+			if (ret->_map(param, offset, (sl_size)size)) {
+				ret->m_view = new _priv_MappedFile_View(ret->m_base, ret->m_sizeMapped, ret->m_handle);
+				if (ret->m_view.isNull()) {
+					_unmap(ret->m_base, ret->m_sizeMapped, ret->m_handle);
+					return sl_null;
+				}
+				if (param.advice != MappedFileAdvice::Normal) {
+					ret->advise(param.advice);
+				}
+				return ret;
+			}
+			ret->m_file.setNull();
+		}
+		return sl_null;
+	}
+
+	Ref<MappedFile> MappedFile::openForRead(const String& filePath)
+	{
+		MappedFileParam param;
+		param.filePath = filePath;
+		return open(param);
+	}
+
+	Ref<MappedFile> MappedFile::openForWrite(const String& filePath, sl_uint64 size)
+	{
+		MappedFileParam param;
+		param.filePath = filePath;
+		param.mode = MappedFileMode::SharedWrite;
+		param.size = size;
+		return open(param);
+	}
+
+	void MappedFile::close()
+	{
+		ObjectLocker lock(this);
+		if (m_base) {
+			// the view is unmapped when the memories from `getMemory()` are released
+			m_view.setNull();
+			m_base = sl_null;
+			m_sizeMapped = 0;
+			m_handle = sl_null;
+			m_data = sl_null;
+			m_size = 0;
+		}
+		m_file.setNull();
+	}
+
+	sl_bool MappedFile::isOpened() const
+	{
+		return m_base != sl_null;
+	}
+
+	void* MappedFile::getData() const
+	{
+		return m_data;
+	}
+
+	sl_size MappedFile::getSize() const
+	{
+		return m_size;
+	}
+
+	sl_uint64 MappedFile::getOffset() const
+	{
+		return m_offset;
+	}
+
+	MappedFileMode MappedFile::getMode() const
+	{
+		return m_mode;
+	}
+
+	Ref<File> MappedFile::getFile() const
+	{
+		return m_file;
+	}
+
+	Memory MappedFile::getMemory()
+	{
+		ObjectLocker lock(this);
+		if (m_data) {
+			return Memory::createStatic(m_data, m_size, m_view.get());
+		}
+		return sl_null;
+	}
+
+	sl_bool MappedFile::advise(MappedFileAdvice advice, sl_size offset, sl_size size)
+	{
+		if (!m_data) {
+			return sl_false;
+		}
+		if (offset >= m_size) {
+			return sl_false;
+		}
+		if (size > m_size - offset) {
+			size = m_size - offset;
+		}
+		sl_size pageSize = _getGranularity();
+		sl_size start = (sl_size)((sl_uint8*)m_data - (sl_uint8*)m_base) + offset;
+		sl_size end = start + size;
+		start -= start % pageSize;
+		return _advise(advice, (sl_uint8*)m_base + start, end - start);
+	}
+
+
 	FilePathSegments::FilePathSegments()
 	{
 		parentLevel = 0;
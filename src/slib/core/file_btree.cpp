@@ -0,0 +1,611 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "slib/core/file_btree.h"
+
+#include "slib/core/mio.h"
+#include "slib/core/hash.h"
+
+/*
+	Header page (page 0)
+
+	0: magic (4 bytes)
+	4: version (4 bytes)
+	8: page size (4 bytes)
+	16: format (8 bytes)
+	24: count of pages (8 bytes)
+	32: first free page (8 bytes)
+	40: root page (8 bytes)
+
+	Free pages are linked through their first 8 bytes.
+
+
+	Write-ahead log (<path>.wal)
+
+	0: magic (4 bytes)
+	4: page size (4 bytes)
+	8: records { page index (8 bytes), page data }
+	   trailer { 0xFFFFFFFFFFFFFFFF (8 bytes), count of records (8 bytes), checksum (8 bytes) }
+
+	The log is applied only when the trailer is complete and the checksum matches.
+	The records of the same page are applied in order, so the last one wins. The records written before flush()
+	(when the modified pages fill the cache) have no trailer, so they are discarded after a crash.
+*/
+
+#define PRIV_BTREE_PAGE_FILE_MAGIC 0x46544253 // SBTF
+#define PRIV_BTREE_PAGE_FILE_VERSION 1
+#define PRIV_BTREE_PAGE_FILE_HEADER_SIZE 48
+#define PRIV_BTREE_PAGE_FILE_LOG_MAGIC 0x57544253 // SBTW
+#define PRIV_BTREE_PAGE_FILE_LOG_HEADER_SIZE 8
+#define PRIV_BTREE_PAGE_FILE_LOG_TRAILER_MARK 0xFFFFFFFFFFFFFFFFULL
+#define PRIV_BTREE_PAGE_FILE_MIN_CACHED_PAGES 16
+
+namespace slib
+{
+
+	class _priv_BTreePageFile_Page
+	{
+	public:
+		sl_uint64 index;
+		sl_bool flagDirty;
+		_priv_BTreePageFile_Page* prev;
+		_priv_BTreePageFile_Page* next;
+		sl_uint8* data;
+
+	public:
+		static _priv_BTreePageFile_Page* create(sl_uint64 index, sl_uint32 pageSize)
+		{
+			_priv_BTreePageFile_Page* page = (_priv_BTreePageFile_Page*)(Base::createMemory(sizeof(_priv_BTreePageFile_Page) + pageSize));
+			if (page) {
+				page->index = index;
+				page->flagDirty = sl_false;
+				page->prev = sl_null;
+				page->next = sl_null;
+				page->data = (sl_uint8*)(page + 1);
+			}
+			return page;
+		}
+
+		static void free(_priv_BTreePageFile_Page* page)
+		{
+			Base::freeMemory(page);
+		}
+
+	};
+
+	class _priv_BTreePageFile_PageIndexCompare
+	{
+	public:
+		int operator()(_priv_BTreePageFile_Page* const& a, _priv_BTreePageFile_Page* const& b) const
+		{
+			return Compare<sl_uint64>()(a->index, b->index);
+		}
+	};
+
+	static sl_uint64 _priv_BTreePageFile_checksum(sl_uint64 checksum, const sl_uint8* record, sl_size size)
+	{
+		return (checksum * 0x100000001B3ULL) ^ HashBytesFNV64(record, size);
+	}
+
+	BTreePageFile::BTreePageFile()
+	{
+		m_pageSize = 0;
+		m_format = 0;
+		m_countPages = 0;
+		m_pageRoot = 0;
+		m_pageFree = 0;
+		m_flagHeaderChanged = sl_false;
+		m_lruFirst = sl_null;
+		m_lruLast = sl_null;
+		m_countLru = 0;
+		m_maxCachedPages = SLIB_FILE_BTREE_DEFAULT_CACHE_PAGES;
+		m_sizeLog = 0;
+		m_countLogRecords = 0;
+		m_checksumLog = 0;
+	}
+
+	BTreePageFile::~BTreePageFile()
+	{
+		close();
+	}
+
+	sl_bool BTreePageFile::open(const String& path, sl_uint32 pageSize, sl_uint64 format, sl_uint32 maxCachedPages)
+	{
+		close();
+		if (pageSize < PRIV_BTREE_PAGE_FILE_HEADER_SIZE) {
+			return sl_false;
+		}
+		Ref<File> file = File::openForRandomAccess(path);
+		if (file.isNull()) {
+			return sl_false;
+		}
+		Ref<File> log = File::openForRandomAccess(path + ".wal");
+		if (log.isNull()) {
+			return sl_false;
+		}
+		m_file = file;
+		m_log = log;
+		m_pageSize = pageSize;
+		m_format = format;
+		if (maxCachedPages < PRIV_BTREE_PAGE_FILE_MIN_CACHED_PAGES) {
+			maxCachedPages = PRIV_BTREE_PAGE_FILE_MIN_CACHED_PAGES;
+		}
+		m_maxCachedPages = maxCachedPages;
+		if (_replayLog()) {
+			if (file->getSize() < pageSize) {
+				// new file
+				m_countPages = 1;
+				m_pageRoot = 0;
+				m_pageFree = 0;
+				m_flagHeaderChanged = sl_true;
+				if (flush()) {
+					return sl_true;
+				}
+			} else {
+				sl_uint8 header[PRIV_BTREE_PAGE_FILE_HEADER_SIZE];
+				if (file->seek(0, SeekPosition::Begin)) {
+					if (file->readFully(header, sizeof(header)) == sizeof(header)) {
+						if (MIO::readUint32LE(header) == PRIV_BTREE_PAGE_FILE_MAGIC && MIO::readUint32LE(header + 4) == PRIV_BTREE_PAGE_FILE_VERSION && MIO::readUint32LE(header + 8) == pageSize && MIO::readUint64LE(header + 16) == format) {
+							m_countPages = MIO::readUint64LE(header + 24);
+							m_pageFree = MIO::readUint64LE(header + 32);
+							m_pageRoot = MIO::readUint64LE(header + 40);
+							m_flagHeaderChanged = sl_false;
+							return sl_true;
+						}
+					}
+				}
+			}
+		}
+		_clearCache();
+		m_file.setNull();
+		m_log.setNull();
+		return sl_false;
+	}
+
+	void BTreePageFile::close()
+	{
+		if (m_file.isNotNull()) {
+			flush();
+			_clearCache();
+			m_file.setNull();
+			m_log.setNull();
+		}
+	}
+
+	sl_bool BTreePageFile::isOpened() const
+	{
+		return m_file.isNotNull();
+	}
+
+	sl_uint32 BTreePageFile::getPageSize() const
+	{
+		return m_pageSize;
+	}
+
+	sl_uint64 BTreePageFile::getPagesCount() const
+	{
+		return m_countPages;
+	}
+
+	sl_uint64 BTreePageFile::getRootPage() const
+	{
+		return m_pageRoot;
+	}
+
+	void BTreePageFile::setRootPage(sl_uint64 page)
+	{
+		if (m_pageRoot != page) {
+			m_pageRoot = page;
+			m_flagHeaderChanged = sl_true;
+		}
+	}
+
+	const sl_uint8* BTreePageFile::readPage(sl_uint64 index)
+	{
+		if (!index || index >= m_countPages) {
+			return sl_null;
+		}
+		_priv_BTreePageFile_Page* page = _getPage(index, sl_true);
+		if (page) {
+			return page->data;
+		}
+		return sl_null;
+	}
+
+	sl_bool BTreePageFile::writePage(sl_uint64 index, const void* data)
+	{
+		if (!index || index >= m_countPages) {
+			return sl_false;
+		}
+		_priv_BTreePageFile_Page* page = _getPage(index, sl_false);
+		if (!page) {
+			return sl_false;
+		}
+		if (!(page->flagDirty)) {
+			if (!(m_dirtyPages.add_NoLock(page))) {
+				return sl_false;
+			}
+			_removeLru(page);
+			page->flagDirty = sl_true;
+		}
+		Base::copyMemory(page->data, data, m_pageSize);
+		_evictPages();
+		return sl_true;
+	}
+
+	sl_uint64 BTreePageFile::allocatePage()
+	{
+		if (m_file.isNull()) {
+			return 0;
+		}
+		if (m_pageFree) {
+			sl_uint64 index = m_pageFree;
+			_priv_BTreePageFile_Page* page = _getPage(index, sl_true);
+			if (!page) {
+				return 0;
+			}
+			m_pageFree = MIO::readUint64LE(page->data);
+			m_flagHeaderChanged = sl_true;
+			return index;
+		}
+		sl_uint64 index = m_countPages;
+		m_countPages++;
+		m_flagHeaderChanged = sl_true;
+		return index;
+	}
+
+	void BTreePageFile::freePage(sl_uint64 index)
+	{
+		if (!index || index >= m_countPages) {
+			return;
+		}
+		sl_uint8 link[8];
+		MIO::writeUint64LE(link, m_pageFree);
+		_priv_BTreePageFile_Page* page = _getPage(index, sl_false);
+		if (!page) {
+			return;
+		}
+		if (!(page->flagDirty)) {
+			if (!(m_dirtyPages.add_NoLock(page))) {
+				return;
+			}
+			_removeLru(page);
+			page->flagDirty = sl_true;
+		}
+		Base::copyMemory(page->data, link, 8);
+		m_pageFree = index;
+		m_flagHeaderChanged = sl_true;
+		_evictPages();
+	}
+
+	sl_bool BTreePageFile::flush()
+	{
+		if (m_file.isNull()) {
+			return sl_false;
+		}
+		if (m_flagHeaderChanged) {
+			if (!(_writeHeader())) {
+				return sl_false;
+			}
+		}
+		if (!(_writeLogRecords())) {
+			return sl_false;
+		}
+		if (!m_sizeLog) {
+			return sl_true;
+		}
+
+		// commit the log
+		sl_uint8 trailer[24];
+		MIO::writeUint64LE(trailer, PRIV_BTREE_PAGE_FILE_LOG_TRAILER_MARK);
+		MIO::writeUint64LE(trailer + 8, m_countLogRecords);
+		MIO::writeUint64LE(trailer + 16, m_checksumLog);
+		if (!(m_log->seek(m_sizeLog, SeekPosition::Begin))) {
+			return sl_false;
+		}
+		if (m_log->writeFully(trailer, sizeof(trailer)) != sizeof(trailer)) {
+			return sl_false;
+		}
+		if (!(m_log->flush())) {
+			return sl_false;
+		}
+
+		// apply to the file in the order of the pages. the pages not in the cache are read from the log
+		List<sl_uint64> indices;
+		for (auto& item : m_loggedPages) {
+			if (!(indices.add_NoLock(item.key))) {
+				return sl_false;
+			}
+		}
+		indices.sort_NoLock();
+		Memory mem = Memory::create(m_pageSize);
+		if (mem.isNull()) {
+			return sl_false;
+		}
+		sl_uint8* buf = (sl_uint8*)(mem.getData());
+		ListElements<sl_uint64> listIndices(indices);
+		for (sl_size i = 0; i < listIndices.count; i++) {
+			sl_uint64 index = listIndices[i];
+			const sl_uint8* data;
+			_priv_BTreePageFile_Page* page;
+			if (m_pages.get(index, &page)) {
+				data = page->data;
+			} else {
+				sl_uint64 offset = 0;
+				m_loggedPages.get(index, &offset);
+				if (!(m_log->seek(offset + 8, SeekPosition::Begin) && m_log->readFully(buf, m_pageSize) == (sl_reg)m_pageSize)) {
+					return sl_false;
+				}
+				data = buf;
+			}
+			if (!(m_file->seek(index * m_pageSize, SeekPosition::Begin))) {
+				return sl_false;
+			}
+			if (m_file->writeFully(data, m_pageSize) != (sl_reg)m_pageSize) {
+				return sl_false;
+			}
+		}
+		if (!(m_file->flush())) {
+			return sl_false;
+		}
+		m_log->setSize(0);
+		m_loggedPages.removeAll();
+		m_sizeLog = 0;
+		m_countLogRecords = 0;
+		m_checksumLog = 0;
+		_evictPages();
+		return sl_true;
+	}
+
+	sl_bool BTreePageFile::_writeLogRecords()
+	{
+		ListElements<_priv_BTreePageFile_Page*> pages(m_dirtyPages);
+		if (!(pages.count)) {
+			return sl_true;
+		}
+		m_dirtyPages.sort_NoLock(_priv_BTreePageFile_PageIndexCompare());
+		sl_size sizeRecord = 8 + m_pageSize;
+		sl_size sizeHeader = m_sizeLog ? 0 : PRIV_BTREE_PAGE_FILE_LOG_HEADER_SIZE;
+		Memory mem = Memory::create(sizeHeader + sizeRecord * pages.count);
+		if (mem.isNull()) {
+			return sl_false;
+		}
+		sl_uint8* buf = (sl_uint8*)(mem.getData());
+		sl_uint8* p = buf;
+		if (sizeHeader) {
+			MIO::writeUint32LE(p, PRIV_BTREE_PAGE_FILE_LOG_MAGIC);
+			MIO::writeUint32LE(p + 4, m_pageSize);
+			p += sizeHeader;
+		}
+		sl_uint64 checksum = m_checksumLog;
+		sl_size i;
+		for (i = 0; i < pages.count; i++) {
+			MIO::writeUint64LE(p, pages[i]->index);
+			Base::copyMemory(p + 8, pages[i]->data, m_pageSize);
+			checksum = _priv_BTreePageFile_checksum(checksum, p, sizeRecord);
+			p += sizeRecord;
+		}
+		if (!(m_log->seek(m_sizeLog, SeekPosition::Begin))) {
+			return sl_false;
+		}
+		if (m_log->writeFully(buf, mem.getSize()) != (sl_reg)(mem.getSize())) {
+			return sl_false;
+		}
+		sl_uint64 offset = m_sizeLog + sizeHeader;
+		for (i = 0; i < pages.count; i++) {
+			_priv_BTreePageFile_Page* page = pages[i];
+			if (!(m_loggedPages.put(page->index, offset))) {
+				return sl_false;
+			}
+			offset += sizeRecord;
+			page->flagDirty = sl_false;
+			_insertLru(page);
+		}
+		m_dirtyPages.removeAll_NoLock();
+		m_sizeLog = offset;
+		m_countLogRecords += pages.count;
+		m_checksumLog = checksum;
+		return sl_true;
+	}
+
+	_priv_BTreePageFile_Page* BTreePageFile::_getPage(sl_uint64 index, sl_bool flagRead)
+	{
+		_priv_BTreePageFile_Page* page;
+		if (m_pages.get(index, &page)) {
+			if (!(page->flagDirty) && page != m_lruFirst) {
+				_removeLru(page);
+				_insertLru(page);
+			}
+			return page;
+		}
+		page = _priv_BTreePageFile_Page::create(index, m_pageSize);
+		if (!page) {
+			return sl_null;
+		}
+		if (flagRead) {
+			IO* io = m_file.get();
+			sl_uint64 offset = 0;
+			if (m_loggedPages.get(index, &offset)) {
+				io = m_log.get();
+				offset += 8;
+			} else {
+				offset = index * m_pageSize;
+			}
+			if (!(io->seek(offset, SeekPosition::Begin) && io->readFully(page->data, m_pageSize) == (sl_reg)m_pageSize)) {
+				_priv_BTreePageFile_Page::free(page);
+				return sl_null;
+			}
+		} else {
+			Base::zeroMemory(page->data, m_pageSize);
+		}
+		// makes room before inserting, not to evict the new page
+		_evictPages();
+		if (!(m_pages.put(index, page))) {
+			_priv_BTreePageFile_Page::free(page);
+			return sl_null;
+		}
+		_insertLru(page);
+		return page;
+	}
+
+	void BTreePageFile::_insertLru(_priv_BTreePageFile_Page* page)
+	{
+		page->prev = sl_null;
+		page->next = m_lruFirst;
+		if (m_lruFirst) {
+			m_lruFirst->prev = page;
+		} else {
+			m_lruLast = page;
+		}
+		m_lruFirst = page;
+		m_countLru++;
+	}
+
+	void BTreePageFile::_removeLru(_priv_BTreePageFile_Page* page)
+	{
+		if (page->prev) {
+			page->prev->next = page->next;
+		} else {
+			m_lruFirst = page->next;
+		}
+		if (page->next) {
+			page->next->prev = page->prev;
+		} else {
+			m_lruLast = page->prev;
+		}
+		page->prev = sl_null;
+		page->next = sl_null;
+		m_countLru--;
+	}
+
+	void BTreePageFile::_evictPages()
+	{
+		if (m_dirtyPages.getCount() >= m_maxCachedPages) {
+			// the modified pages are kept in the log until flush()
+			_writeLogRecords();
+		}
+		while (m_countLru && m_countLru + m_dirtyPages.getCount() > m_maxCachedPages) {
+			_priv_BTreePageFile_Page* page = m_lruLast;
+			_removeLru(page);
+			m_pages.remove(page->index);
+			_priv_BTreePageFile_Page::free(page);
+		}
+	}
+
+	sl_bool BTreePageFile::_replayLog()
+	{
+		sl_uint64 sizeLog = m_log->getSize();
+		if (!sizeLog) {
+			return sl_true;
+		}
+		sl_uint32 pageSize = m_pageSize;
+		sl_size sizeRecord = 8 + pageSize;
+		sl_bool flagValid = sl_false;
+		sl_uint64 countRecords = 0;
+		Memory mem = Memory::create(sizeRecord);
+		if (mem.isNull()) {
+			return sl_false;
+		}
+		sl_uint8* record = (sl_uint8*)(mem.getData());
+		// verify
+		sl_uint8 header[PRIV_BTREE_PAGE_FILE_LOG_HEADER_SIZE];
+		if (m_log->seek(0, SeekPosition::Begin) && m_log->readFully(header, sizeof(header)) == sizeof(header)) {
+			if (MIO::readUint32LE(header) == PRIV_BTREE_PAGE_FILE_LOG_MAGIC && MIO::readUint32LE(header + 4) == pageSize) {
+				sl_uint64 checksum = 0;
+				for (;;) {
+					if (m_log->readFully(record, 8) != 8) {
+						break;
+					}
+					if (MIO::readUint64LE(record) == PRIV_BTREE_PAGE_FILE_LOG_TRAILER_MARK) {
+						sl_uint8 trailer[16];
+						if (m_log->readFully(trailer, 16) == 16) {
+							if (MIO::readUint64LE(trailer) == countRecords && MIO::readUint64LE(trailer + 8) == checksum) {
+								flagValid = sl_true;
+							}
+						}
+						break;
+					}
+					if (m_log->readFully(record + 8, pageSize) != (sl_reg)pageSize) {
+						break;
+					}
+					checksum = _priv_BTreePageFile_checksum(checksum, record, sizeRecord);
+					countRecords++;
+				}
+			}
+		}
+		if (flagValid) {
+			// redo
+			if (!(m_log->seek(PRIV_BTREE_PAGE_FILE_LOG_HEADER_SIZE, SeekPosition::Begin))) {
+				return sl_false;
+			}
+			for (sl_uint64 i = 0; i < countRecords; i++) {
+				if (m_log->readFully(record, sizeRecord) != (sl_reg)sizeRecord) {
+					return sl_false;
+				}
+				sl_uint64 index = MIO::readUint64LE(record);
+				if (!(m_file->seek(index * pageSize, SeekPosition::Begin))) {
+					return sl_false;
+				}
+				if (m_file->writeFully(record + 8, pageSize) != (sl_reg)pageSize) {
+					return sl_false;
+				}
+			}
+			if (!(m_file->flush())) {
+				return sl_false;
+			}
+		}
+		// incomplete log is discarded: the file was not touched by the interrupted flush
+		return m_log->setSize(0);
+	}
+
+	sl_bool BTreePageFile::_writeHeader()
+	{
+		sl_uint8 header[PRIV_BTREE_PAGE_FILE_HEADER_SIZE];
+		Base::zeroMemory(header, sizeof(header));
+		MIO::writeUint32LE(header, PRIV_BTREE_PAGE_FILE_MAGIC);
+		MIO::writeUint32LE(header + 4, PRIV_BTREE_PAGE_FILE_VERSION);
+		MIO::writeUint32LE(header + 8, m_pageSize);
+		MIO::writeUint64LE(header + 16, m_format);
+		MIO::writeUint64LE(header + 24, m_countPages);
+		MIO::writeUint64LE(header + 32, m_pageFree);
+		MIO::writeUint64LE(header + 40, m_pageRoot);
+		_priv_BTreePageFile_Page* page = _getPage(0, sl_false);
+		if (!page) {
+			return sl_false;
+		}
+		if (!(page->flagDirty)) {
+			if (!(m_dirtyPages.add_NoLock(page))) {
+				return sl_false;
+			}
+			_removeLru(page);
+			page->flagDirty = sl_true;
+		}
+		Base::copyMemory(page->data, header, sizeof(header));
+		m_flagHeaderChanged = sl_false;
+		return sl_true;
+	}
+
+	void BTreePageFile::_clearCache()
+	{
+		for (auto& item : m_pages) {
+			_priv_BTreePageFile_Page::free(item.value);
+		}
+		m_pages.removeAll();
+		m_lruFirst = sl_null;
+		m_lruLast = sl_null;
+		m_countLru = 0;
+		m_dirtyPages.setNull();
+		m_loggedPages.removeAll();
+		m_sizeLog = 0;
+		m_countLogRecords = 0;
+		m_checksumLog = 0;
+	}
+
+}
@@ -19,6 +19,7 @@
 #include <fcntl.h>
 #include <sys/stat.h>
 #include <sys/time.h>
+#include <sys/mman.h>
 #if defined(SLIB_PLATFORM_IS_DESKTOP)
 #	include <sys/ioctl.h>
 #	if defined(SLIB_PLATFORM_IS_MACOS)
@@ -166,6 +167,32 @@ namespace slib
 		return -1;
 	}
 
+	sl_int32 File::readAt32(sl_uint64 offset, void* buf, sl_uint32 size)
+	{
+		if (isOpened()) {
+			if (size == 0) {
+				return 0;
+			}
+			int fd = (int)m_file;
+#if defined(SLIB_PLATFORM_IS_LINUX)
+			ssize_t n = ::pread64(fd, buf, size, (off64_t)offset);
+#else
+			ssize_t n = ::pread(fd, buf, size, (off_t)offset);
+#endif
+			if (n >= 0) {
+				if (n > 0) {
+					return (sl_int32)n;
+				}
+			} else {
+				int err = errno;
+				if (err == EAGAIN || err == EWOULDBLOCK) {
+					return 0;
+				}
+			}
+		}
+		return -1;
+	}
+
 	sl_int32 File::write32(const void* buf, sl_uint32 size)
 	{
 		if (isOpened()) {
@@ -197,6 +224,15 @@ namespace slib
 		return sl_false;
 	}
 
+	sl_bool File::flush()
+	{
+		if (isOpened()) {
+			int fd = (int)m_file;
+			return 0 == ::fsync(fd);
+		}
+		return sl_false;
+	}
+
 	sl_uint64 File::getSize(sl_file _fd)
 	{
 		int fd = (int)_fd;
@@ -546,6 +582,101 @@ namespace slib
 		}
 	}
 
+	sl_bool MappedFile::_map(const MappedFileParam& param, sl_uint64 offset, sl_size size)
+	{
+		int fd = (int)(m_file->getHandle());
+		if (fd < 0) {
+			return sl_false;
+		}
+		sl_size granularity = _getGranularity();
+		sl_size delta = (sl_size)(offset % granularity);
+		if (size > SLIB_SIZE_MAX - delta) {
+			return sl_false;
+		}
+		sl_size sizeMapped = size + delta;
+		int prot = PROT_READ;
+		int flags = MAP_SHARED;
+		if (param.mode == MappedFileMode::CopyOnWrite) {
+			prot |= PROT_WRITE;
+			flags = MAP_PRIVATE;
+		} else if (param.mode == MappedFileMode::SharedWrite) {
+			prot |= PROT_WRITE;
+		}
+#if defined(MAP_POPULATE)
+		if (param.flagPopulate) {
+			flags |= MAP_POPULATE;
+		}
+#endif
+		void* base = ::mmap(sl_null, sizeMapped, prot, flags, fd, (off_t)(offset - delta));
+		if (base == MAP_FAILED) {
+			return sl_false;
+		}
+#if defined(MADV_HUGEPAGE)
+		if (param.flagHugePages) {
+			::madvise(base, sizeMapped, MADV_HUGEPAGE);
+		}
+#endif
+#if !defined(MAP_POPULATE)
+		if (param.flagPopulate) {
+			::madvise(base, sizeMapped, MADV_WILLNEED);
+		}
+#endif
+		m_base = base;
+		m_sizeMapped = sizeMapped;
+		m_data = (sl_uint8*)base + delta;
+		m_size = size;
+		return sl_true;
+	}
+
+	void MappedFile::_unmap(void* base, sl_size sizeMapped, void* handle)
+	{
+		::munmap(base, sizeMapped);
+	}
+
+	sl_bool MappedFile::_advise(MappedFileAdvice advice, void* start, sl_size size)
+	{
+		int n;
+		switch (advice) {
+			case MappedFileAdvice::Sequential:
+				n = MADV_SEQUENTIAL;
+				break;
+			case MappedFileAdvice::Random:
+				n = MADV_RANDOM;
+				break;
+			case MappedFileAdvice::WillNeed:
+				n = MADV_WILLNEED;
+				break;
+			case MappedFileAdvice::DontNeed:
+				n = MADV_DONTNEED;
+				break;
+			default:
+				n = MADV_NORMAL;
+				break;
+		}
+		return ::madvise(start, size, n) == 0;
+	}
+
+	sl_bool MappedFile::flush(sl_bool flagAsync)
+	{
+		if (!m_base) {
+			return sl_false;
+		}
+		if (m_mode != MappedFileMode::SharedWrite) {
+			return sl_true;
+		}
+		return ::msync(m_base, m_sizeMapped, flagAsync ? MS_ASYNC : MS_SYNC) == 0;
+	}
+
+	sl_size MappedFile::_getGranularity()
+	{
+		static sl_size granularity = 0;
+		if (!granularity) {
+			long n = ::sysconf(_SC_PAGESIZE);
+			granularity = n > 0 ? (sl_size)n : 4096;
+		}
+		return granularity;
+	}
+
 }
 
 #endif
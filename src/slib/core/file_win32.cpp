@@ -153,6 +153,27 @@ namespace slib
 		return -1;
 	}
 
+	sl_int32 File::readAt32(sl_uint64 offset, void* buf, sl_uint32 size)
+	{
+		if (isOpened()) {
+			if (size == 0) {
+				return 0;
+			}
+			sl_uint32 ret = 0;
+			HANDLE handle = (HANDLE)m_file;
+			OVERLAPPED overlapped;
+			Base::zeroMemory(&overlapped, sizeof(overlapped));
+			overlapped.Offset = (DWORD)offset;
+			overlapped.OffsetHigh = (DWORD)(offset >> 32);
+			if (::ReadFile(handle, buf, size, (DWORD*)&ret, &overlapped)) {
+				if (ret > 0) {
+					return ret;
+				}
+			}
+		}
+		return -1;
+	}
+
 	sl_int32 File::write32(const void* buf, sl_uint32 size)
 	{
 		if (isOpened()) {
@@ -184,6 +205,15 @@ namespace slib
 		return sl_false;
 	}
 
+	sl_bool File::flush()
+	{
+		if (isOpened()) {
+			HANDLE handle = (HANDLE)m_file;
+			return ::FlushFileBuffers(handle) != 0;
+		}
+		return sl_false;
+	}
+
 	sl_uint64 File::getSize(sl_file fd)
 	{
 		HANDLE handle = (HANDLE)fd;
@@ -545,6 +575,108 @@ namespace slib
 		return ret != 0;
 	}
 
+	sl_bool MappedFile::_map(const MappedFileParam& param, sl_uint64 offset, sl_size size)
+	{
+		HANDLE hFile = (HANDLE)(m_file->getHandle());
+		if (hFile == INVALID_HANDLE_VALUE) {
+			return sl_false;
+		}
+		DWORD dwProtect = PAGE_READONLY;
+		DWORD dwAccess = FILE_MAP_READ;
+		if (param.mode == MappedFileMode::CopyOnWrite) {
+			dwProtect = PAGE_WRITECOPY;
+			dwAccess = FILE_MAP_COPY;
+		} else if (param.mode == MappedFileMode::SharedWrite) {
+			dwProtect = PAGE_READWRITE;
+			dwAccess = FILE_MAP_WRITE;
+		}
+		sl_size granularity = _getGranularity();
+		sl_size delta = (sl_size)(offset % granularity);
+		if (size > SLIB_SIZE_MAX - delta) {
+			return sl_false;
+		}
+		sl_size sizeMapped = size + delta;
+		sl_uint64 offsetMapped = offset - delta;
+		// the size of the mapping object is the size of the file
+		HANDLE hMapping = ::CreateFileMappingW(hFile, NULL, dwProtect, 0, 0, NULL);
+		if (!hMapping) {
+			return sl_false;
+		}
+		void* base = ::MapViewOfFile(hMapping, dwAccess, (DWORD)(offsetMapped >> 32), (DWORD)offsetMapped, sizeMapped);
+		if (!base) {
+			::CloseHandle(hMapping);
+			return sl_false;
+		}
+		m_base = base;
+		m_sizeMapped = sizeMapped;
+		m_handle = hMapping;
+		m_data = (sl_uint8*)base + delta;
+		m_size = size;
+		if (param.flagPopulate) {
+			_advise(MappedFileAdvice::WillNeed, base, sizeMapped);
+		}
+		return sl_true;
+	}
+
+	void MappedFile::_unmap(void* base, sl_size sizeMapped, void* handle)
+	{
+		::UnmapViewOfFile(base);
+		::CloseHandle((HANDLE)handle);
+	}
+
+	sl_bool MappedFile::_advise(MappedFileAdvice advice, void* start, sl_size size)
+	{
+		if (advice == MappedFileAdvice::WillNeed) {
+			// PrefetchVirtualMemory: Windows 8 or later
+			typedef BOOL(WINAPI *FUNC_PrefetchVirtualMemory)(HANDLE, ULONG_PTR, PVOID, ULONG);
+			static FUNC_PrefetchVirtualMemory func = (FUNC_PrefetchVirtualMemory)(::GetProcAddress(::GetModuleHandleW(L"kernel32.dll"), "PrefetchVirtualMemory"));
+			if (func) {
+				struct {
+					PVOID VirtualAddress;
+					SIZE_T NumberOfBytes;
+				} range;
+				range.VirtualAddress = start;
+				range.NumberOfBytes = size;
+				return func(::GetCurrentProcess(), 1, &range, 0) != 0;
+			}
+			return sl_false;
+		} else if (advice == MappedFileAdvice::DontNeed) {
+			// removes the unmodified pages from the working set
+			::VirtualUnlock(start, size);
+			return sl_true;
+		}
+		// the access pattern is given by `FileMode::HintRandomAccess` on opening the file
+		return sl_true;
+	}
+
+	sl_bool MappedFile::flush(sl_bool flagAsync)
+	{
+		if (!m_base) {
+			return sl_false;
+		}
+		if (m_mode != MappedFileMode::SharedWrite) {
+			return sl_true;
+		}
+		if (!(::FlushViewOfFile(m_base, m_sizeMapped))) {
+			return sl_false;
+		}
+		if (flagAsync) {
+			return sl_true;
+		}
+		return m_file->flush();
+	}
+
+	sl_size MappedFile::_getGranularity()
+	{
+		static sl_size granularity = 0;
+		if (!granularity) {
+			SYSTEM_INFO si;
+			::GetSystemInfo(&si);
+			granularity = (sl_size)(si.dwAllocationGranularity);
+		}
+		return granularity;
+	}
+
 }
 
 #endif
@@ -12,6 +12,9 @@
 #include "slib/core/hash_table.h"
 
 #include "slib/core/math.h"
+#include "slib/core/mio.h"
+#include "slib/core/time.h"
+#include "slib/core/system.h"
 
 namespace slib
 {
@@ -24,7 +27,7 @@ namespace slib
 	 http://www.isthe.com/chongo/tech/comp/fnv/index.html
 	 
 	****************************************************/
-	sl_uint32 HashBytes32(const void* _buf, sl_size n) noexcept
+	sl_uint32 HashBytesFNV32(const void* _buf, sl_size n) noexcept
 	{
 		sl_uint8* buf = (sl_uint8*)_buf;
 		sl_uint32 hash = 0x811c9dc5;
@@ -36,7 +39,7 @@ namespace slib
 		return hash;
 	}
 	
-	sl_uint64 HashBytes64(const void* _buf, sl_size n) noexcept
+	sl_uint64 HashBytesFNV64(const void* _buf, sl_size n) noexcept
 	{
 		sl_uint8* buf = (sl_uint8*)_buf;
 		sl_uint64 hash = SLIB_UINT64(0xcbf29ce484222325);
@@ -47,15 +50,156 @@ namespace slib
 		}
 		return hash;
 	}
+
+
+	/****************************************************
+	 
+		based on wyhash (final version 4)
+	 
+	 https://github.com/wangyi-fudan/wyhash
+	 
+	 Reads 8 or 16 bytes per multiplication (64x64=>128 bits),
+	 and 48 bytes per loop in three independent lanes.
+	 The words are read in little-endian on all platforms.
+	 
+	****************************************************/
+	
+	static const sl_uint64 _g_priv_Hash_secret[4] = {
+		SLIB_UINT64(0x2d358dccaa6c78a5),
+		SLIB_UINT64(0x8bb84b93962eacc9),
+		SLIB_UINT64(0x4b33a62ed433d4a3),
+		SLIB_UINT64(0x4d5a2da51de1aa47)
+	};
+	
+	SLIB_INLINE static sl_uint64 _priv_Hash_mix(sl_uint64 a, sl_uint64 b) noexcept
+	{
+		sl_uint64 high, low;
+		Math::mul64(a, b, high, low);
+		return high ^ low;
+	}
+	
+	SLIB_INLINE static sl_uint64 _priv_Hash_mixSeed(sl_uint64 seed) noexcept
+	{
+		return seed ^ _priv_Hash_mix(seed ^ _g_priv_Hash_secret[0], _g_priv_Hash_secret[1]);
+	}
+
+	// `seed` is mixed by `_priv_Hash_mixSeed()`
+	SLIB_INLINE static sl_uint64 _priv_Hash_wyhash(const void* _buf, sl_size n, sl_uint64 seed) noexcept
+	{
+		const sl_uint64* secret = _g_priv_Hash_secret;
+		const sl_uint8* p = (const sl_uint8*)_buf;
+		sl_uint64 a, b;
+		if (n <= 16) {
+			if (n >= 4) {
+				sl_size k = (n >> 3) << 2;
+				a = ((sl_uint64)MIO::readUint32LE(p) << 32) | (sl_uint64)MIO::readUint32LE(p + k);
+				b = ((sl_uint64)MIO::readUint32LE(p + n - 4) << 32) | (sl_uint64)MIO::readUint32LE(p + n - 4 - k);
+			} else if (n > 0) {
+				a = (((sl_uint64)(p[0])) << 16) | (((sl_uint64)(p[n >> 1])) << 8) | p[n - 1];
+				b = 0;
+			} else {
+				a = 0;
+				b = 0;
+			}
+		} else {
+			sl_size i = n;
+			if (i >= 48) {
+				sl_uint64 seed1 = seed;
+				sl_uint64 seed2 = seed;
+				do {
+					seed = _priv_Hash_mix(MIO::readUint64LE(p) ^ secret[1], MIO::readUint64LE(p + 8) ^ seed);
+					seed1 = _priv_Hash_mix(MIO::readUint64LE(p + 16) ^ secret[2], MIO::readUint64LE(p + 24) ^ seed1);
+					seed2 = _priv_Hash_mix(MIO::readUint64LE(p + 32) ^ secret[3], MIO::readUint64LE(p + 40) ^ seed2);
+					p += 48;
+					i -= 48;
+				} while (i >= 48);
+				seed ^= seed1 ^ seed2;
+			}
+			while (i > 16) {
+				seed = _priv_Hash_mix(MIO::readUint64LE(p) ^ secret[1], MIO::readUint64LE(p + 8) ^ seed);
+				i -= 16;
+				p += 16;
+			}
+			a = MIO::readUint64LE(p + i - 16);
+			b = MIO::readUint64LE(p + i - 8);
+		}
+		a ^= secret[1];
+		b ^= seed;
+		Math::mul64(a, b, b, a);
+		return _priv_Hash_mix(a ^ secret[0] ^ n, b ^ secret[1]);
+	}
+	
+	static sl_uint64 _priv_Hash_generateSeed() noexcept
+	{
+#if defined(SLIB_HASH_NO_SEED)
+		return 0;
+#else
+		// the addresses are randomized by ASLR
+		sl_uint64 stackAddress = (sl_uint64)(sl_size)((void*)(&stackAddress));
+		sl_uint64 imageAddress = (sl_uint64)(sl_size)((void*)(&_g_priv_Hash_secret));
+		sl_uint64 seed = _priv_Hash_mix(stackAddress ^ _g_priv_Hash_secret[0], imageAddress ^ _g_priv_Hash_secret[1]);
+		seed = _priv_Hash_mix(seed ^ (sl_uint64)(Time::now().toInt()), ((sl_uint64)(System::getTickCount()) << 32 | System::getProcessId()) ^ _g_priv_Hash_secret[2]);
+		return seed;
+#endif
+	}
+	
+	class _priv_Hash_Seed
+	{
+	public:
+		sl_uint64 seed;
+		sl_uint64 mixed;
+		
+	public:
+		_priv_Hash_Seed() noexcept
+		{
+			seed = _priv_Hash_generateSeed();
+			mixed = _priv_Hash_mixSeed(seed);
+		}
+		
+	};
+	
+	SLIB_INLINE static const _priv_Hash_Seed& _priv_Hash_getSeed() noexcept
+	{
+		// thread-safe initialization of the local static (C++11)
+		static _priv_Hash_Seed seed;
+		return seed;
+	}
+	
+	sl_uint64 HashBytes64(const void* buf, sl_size n, sl_uint64 seed) noexcept
+	{
+		return _priv_Hash_wyhash(buf, n, _priv_Hash_mixSeed(seed));
+	}
+	
+	sl_uint64 HashBytes64(const void* buf, sl_size n) noexcept
+	{
+		return HashBytes64(buf, n, 0);
+	}
+	
+	sl_uint32 HashBytes32(const void* buf, sl_size n, sl_uint64 seed) noexcept
+	{
+		sl_uint64 h = HashBytes64(buf, n, seed);
+		return (sl_uint32)(h ^ (h >> 32));
+	}
+	
+	sl_uint32 HashBytes32(const void* buf, sl_size n) noexcept
+	{
+		return HashBytes32(buf, n, 0);
+	}
 	
 	sl_size HashBytes(const void* buf, sl_size n) noexcept
 	{
+		sl_uint64 h = _priv_Hash_wyhash(buf, n, _priv_Hash_getSeed().mixed);
 #ifdef SLIB_ARCH_IS_64BIT
-		return HashBytes64(buf, n);
+		return (sl_size)h;
 #else
-		return HashBytes32(buf, n);
+		return (sl_size)(h ^ (h >> 32));
 #endif
 	}
+	
+	sl_uint64 GetHashSeed() noexcept
+	{
+		return _priv_Hash_getSeed().seed;
+	}
 
 	
 	#define PRIV_SLIB_HASHTABLE_MIN_CAPACITY 16
@@ -10,6 +10,7 @@
 
 #include "slib/core/io.h"
 
+#include "slib/core/file.h"
 #include "slib/core/mio.h"
 #include "slib/core/string_buffer.h"
 #include "slib/core/thread.h"
@@ -1373,7 +1374,7 @@ namespace slib
 						return sb.merge();
 					}
 				}
-				if (!(sb.add(String(buf, IO_READLINE_BUF_SIZE)))) {
+				if (!(sb.add(String(buf, n)))) {
 					return String::null();
 				}
 			} else {
@@ -1956,4 +1957,481 @@ namespace slib
 		return getOffset();
 	}
 
+
+/***************
+	BufferedReader
+***************/
+
+#define PRIV_BUFFERED_IO_DEFAULT_SIZE 0x10000
+// enough for the fixed-size and CVLI values
+#define PRIV_BUFFERED_IO_MIN_SIZE 64
+
+	SLIB_DEFINE_OBJECT(BufferedReader, Object)
+
+	BufferedReader::BufferedReader()
+	{
+		m_buf = sl_null;
+		m_sizeBuffer = 0;
+		m_pos = sl_null;
+		m_end = sl_null;
+		m_positionEnd = 0;
+	}
+
+	BufferedReader::~BufferedReader()
+	{
+	}
+
+	Ref<BufferedReader> BufferedReader::create(const Ptr<IReader>& reader, sl_size bufferSize)
+	{
+		return create(reader, sl_null, bufferSize);
+	}
+
+	Ref<BufferedReader> BufferedReader::create(const Ptr<IReader>& reader, const Ptr<ISeekable>& seekable, sl_size bufferSize)
+	{
+		if (reader.isNotNull()) {
+			Ref<BufferedReader> ret = new BufferedReader;
+			if (ret.isNotNull()) {
+				if (ret->_init(reader, seekable, bufferSize)) {
+					return ret;
+				}
+			}
+		}
+		return sl_null;
+	}
+
+	Ref<BufferedReader> BufferedReader::openFile(const String& filePath, sl_size bufferSize)
+	{
+		Ref<File> file = File::openForRead(filePath);
+		if (file.isNotNull()) {
+			return create(file, file, bufferSize);
+		}
+		return sl_null;
+	}
+
+	sl_bool BufferedReader::_init(const Ptr<IReader>& reader, const Ptr<ISeekable>& seekable, sl_size bufferSize)
+	{
+		if (!bufferSize) {
+			bufferSize = PRIV_BUFFERED_IO_DEFAULT_SIZE;
+		} else if (bufferSize < PRIV_BUFFERED_IO_MIN_SIZE) {
+			bufferSize = PRIV_BUFFERED_IO_MIN_SIZE;
+		}
+		Memory buffer = Memory::create(bufferSize);
+		if (buffer.isNull()) {
+			return sl_false;
+		}
+		m_reader = reader;
+		m_seekable = seekable;
+		m_buffer = buffer;
+		m_buf = (sl_uint8*)(buffer.getData());
+		m_sizeBuffer = bufferSize;
+		m_pos = m_buf;
+		m_end = m_buf;
+		if (seekable.isNotNull()) {
+			m_positionEnd = seekable->getPosition();
+		} else {
+			m_positionEnd = 0;
+		}
+		return sl_true;
+	}
+
+	sl_reg BufferedReader::read(void* _buf, sl_size size)
+	{
+		if (!size) {
+			return 0;
+		}
+		if (!m_buf) {
+			return -1;
+		}
+		sl_uint8* buf = (sl_uint8*)_buf;
+		sl_size sizeRemain = m_end - m_pos;
+		if (sizeRemain) {
+			if (size > sizeRemain) {
+				size = sizeRemain;
+			}
+			Base::copyMemory(buf, m_pos, size);
+			m_pos += size;
+			return size;
+		}
+		m_pos = m_buf;
+		m_end = m_buf;
+		if (size >= m_sizeBuffer) {
+			// reads directly
+			sl_reg n = m_reader->read(buf, size);
+			if (n > 0) {
+				m_positionEnd += n;
+			}
+			return n;
+		}
+		sl_reg n = m_reader->read(m_buf, m_sizeBuffer);
+		if (n <= 0) {
+			return n;
+		}
+		m_end = m_buf + n;
+		m_positionEnd += n;
+		if (size > (sl_size)n) {
+			size = n;
+		}
+		Base::copyMemory(buf, m_buf, size);
+		m_pos = m_buf + size;
+		return size;
+	}
+
+	sl_int32 BufferedReader::read32(void* buf, sl_uint32 size)
+	{
+		return (sl_int32)(read(buf, size));
+	}
+
+	sl_uint64 BufferedReader::getPosition()
+	{
+		return m_positionEnd - (sl_uint64)(m_end - m_pos);
+	}
+
+	sl_uint64 BufferedReader::getSize()
+	{
+		if (m_seekable.isNotNull()) {
+			return m_seekable->getSize();
+		}
+		return 0;
+	}
+
+	sl_bool BufferedReader::seek(sl_int64 offset, SeekPosition pos)
+	{
+		if (!m_buf) {
+			return sl_false;
+		}
+		sl_uint64 base;
+		if (pos == SeekPosition::Current) {
+			base = getPosition();
+		} else if (pos == SeekPosition::Begin) {
+			base = 0;
+		} else {
+			if (m_seekable.isNull()) {
+				return sl_false;
+			}
+			base = m_seekable->getSize();
+		}
+		if (offset < 0 && (sl_uint64)(-offset) > base) {
+			return sl_false;
+		}
+		sl_uint64 target = base + offset;
+		// data of the buffer: [m_buf, m_end)
+		sl_uint64 begin = m_positionEnd - (sl_uint64)(m_end - m_buf);
+		if (target >= begin && target <= m_positionEnd) {
+			m_pos = m_buf + (sl_size)(target - begin);
+			return sl_true;
+		}
+		if (m_seekable.isNotNull()) {
+			if (m_seekable->seek(target, SeekPosition::Begin)) {
+				m_pos = m_buf;
+				m_end = m_buf;
+				m_positionEnd = target;
+				return sl_true;
+			}
+			return sl_false;
+		}
+		if (target < m_positionEnd) {
+			return sl_false;
+		}
+		// skips forward
+		do {
+			m_pos = m_buf;
+			m_end = m_buf;
+			if (!(_fill())) {
+				return sl_false;
+			}
+		} while (m_positionEnd < target);
+		m_pos = m_end - (sl_size)(m_positionEnd - target);
+		return sl_true;
+	}
+
+	void BufferedReader::close()
+	{
+		m_reader.setNull();
+		m_seekable.setNull();
+		m_buffer.setNull();
+		m_buf = sl_null;
+		m_sizeBuffer = 0;
+		m_pos = sl_null;
+		m_end = sl_null;
+	}
+
+	String BufferedReader::readLine()
+	{
+		StringBuffer sb;
+		for (;;) {
+			sl_uint8* start = m_pos;
+			sl_uint8* end = m_end;
+			sl_uint8* p = start;
+			while (p < end) {
+				sl_uint8 ch = *p;
+				if (ch == '\r' || ch == '\n') {
+					break;
+				}
+				p++;
+			}
+			if (p < end) {
+				String line;
+				if (p > start) {
+					line = String((sl_char8*)start, p - start);
+				} else {
+					line = String::getEmpty();
+				}
+				m_pos = p + 1;
+				if (*p == '\r') {
+					if (m_pos < m_end || _prepare(1)) {
+						if (*m_pos == '\n') {
+							m_pos++;
+						}
+					}
+				}
+				if (sb.getLength()) {
+					sb.add(line);
+					return sb.merge();
+				}
+				return line;
+			}
+			if (p > start) {
+				if (!(sb.add(String((sl_char8*)start, p - start)))) {
+					return sl_null;
+				}
+				m_pos = p;
+			}
+			if (!(_prepare(1))) {
+				break;
+			}
+		}
+		if (sb.getLength()) {
+			return sb.merge();
+		}
+		return sl_null;
+	}
+
+	sl_bool BufferedReader::_prepare(sl_size size)
+	{
+		if (!m_buf) {
+			return sl_false;
+		}
+		sl_size sizeRemain = m_end - m_pos;
+		if ((sl_size)(m_buf + m_sizeBuffer - m_pos) < size) {
+			Base::moveMemory(m_buf, m_pos, sizeRemain);
+			m_pos = m_buf;
+			m_end = m_buf + sizeRemain;
+		}
+		while ((sl_size)(m_end - m_pos) < size) {
+			if (!(_fill())) {
+				return sl_false;
+			}
+		}
+		return sl_true;
+	}
+
+	sl_bool BufferedReader::_fill()
+	{
+		sl_size sizeFree = m_buf + m_sizeBuffer - m_end;
+		for (;;) {
+			sl_reg n = m_reader->read(m_end, sizeFree);
+			if (n > 0) {
+				m_end += n;
+				m_positionEnd += n;
+				return sl_true;
+			}
+			if (n < 0) {
+				return sl_false;
+			}
+			// no data available in the non-blocking stream
+			Thread::sleep(1);
+			if (Thread::isStoppingCurrent()) {
+				return sl_false;
+			}
+		}
+	}
+
+	sl_bool BufferedReader::_readUint32CVLI(sl_uint32* output)
+	{
+		sl_uint32 v = 0;
+		int m = 0;
+		for (;;) {
+			sl_uint8 n;
+			if (readUint8(&n)) {
+				v += (((sl_uint32)(n & 127)) << m);
+				m += 7;
+				if ((n & 128) == 0) {
+					break;
+				}
+			} else {
+				return sl_false;
+			}
+		}
+		*output = v;
+		return sl_true;
+	}
+
+	sl_bool BufferedReader::_readUint64CVLI(sl_uint64* output)
+	{
+		sl_uint64 v = 0;
+		int m = 0;
+		for (;;) {
+			sl_uint8 n;
+			if (readUint8(&n)) {
+				v += (((sl_uint64)(n & 127)) << m);
+				m += 7;
+				if ((n & 128) == 0) {
+					break;
+				}
+			} else {
+				return sl_false;
+			}
+		}
+		*output = v;
+		return sl_true;
+	}
+
+
+/***************
+	BufferedWriter
+***************/
+
+	SLIB_DEFINE_OBJECT(BufferedWriter, Object)
+
+	BufferedWriter::BufferedWriter()
+	{
+		m_buf = sl_null;
+		m_sizeBuffer = 0;
+		m_pos = sl_null;
+		m_end = sl_null;
+		m_sizeWritten = 0;
+	}
+
+	BufferedWriter::~BufferedWriter()
+	{
+		_flush();
+	}
+
+	Ref<BufferedWriter> BufferedWriter::create(const Ptr<IWriter>& writer, sl_size bufferSize)
+	{
+		if (writer.isNotNull()) {
+			Ref<BufferedWriter> ret = new BufferedWriter;
+			if (ret.isNotNull()) {
+				if (ret->_init(writer, bufferSize)) {
+					return ret;
+				}
+			}
+		}
+		return sl_null;
+	}
+
+	Ref<BufferedWriter> BufferedWriter::openFile(const String& filePath, sl_size bufferSize)
+	{
+		Ref<File> file = File::openForWrite(filePath);
+		if (file.isNotNull()) {
+			return create(file, bufferSize);
+		}
+		return sl_null;
+	}
+
+	Ref<BufferedWriter> BufferedWriter::openFileForAppend(const String& filePath, sl_size bufferSize)
+	{
+		Ref<File> file = File::openForAppend(filePath);
+		if (file.isNotNull()) {
+			return create(file, bufferSize);
+		}
+		return sl_null;
+	}
+
+	sl_bool BufferedWriter::_init(const Ptr<IWriter>& writer, sl_size bufferSize)
+	{
+		if (!bufferSize) {
+			bufferSize = PRIV_BUFFERED_IO_DEFAULT_SIZE;
+		} else if (bufferSize < PRIV_BUFFERED_IO_MIN_SIZE) {
+			bufferSize = PRIV_BUFFERED_IO_MIN_SIZE;
+		}
+		Memory buffer = Memory::create(bufferSize);
+		if (buffer.isNull()) {
+			return sl_false;
+		}
+		m_writer = writer;
+		m_buffer = buffer;
+		m_buf = (sl_uint8*)(buffer.getData());
+		m_sizeBuffer = bufferSize;
+		m_pos = m_buf;
+		m_end = m_buf + bufferSize;
+		return sl_true;
+	}
+
+	sl_reg BufferedWriter::write(const void* buf, sl_size size)
+	{
+		if (!size) {
+			return 0;
+		}
+		if (!m_buf) {
+			return -1;
+		}
+		if ((sl_size)(m_end - m_pos) >= size) {
+			Base::copyMemory(m_pos, buf, size);
+			m_pos += size;
+			return size;
+		}
+		if (!(_flush())) {
+			return -1;
+		}
+		if (size >= m_sizeBuffer) {
+			// writes directly
+			sl_reg n = m_writer->writeFully(buf, size);
+			if (n > 0) {
+				m_sizeWritten += n;
+			}
+			return n;
+		}
+		Base::copyMemory(m_pos, buf, size);
+		m_pos += size;
+		return size;
+	}
+
+	sl_int32 BufferedWriter::write32(const void* buf, sl_uint32 size)
+	{
+		return (sl_int32)(write(buf, size));
+	}
+
+	sl_bool BufferedWriter::flush()
+	{
+		return _flush();
+	}
+
+	void BufferedWriter::close()
+	{
+		_flush();
+		m_writer.setNull();
+		m_buffer.setNull();
+		m_buf = sl_null;
+		m_sizeBuffer = 0;
+		m_pos = sl_null;
+		m_end = sl_null;
+	}
+
+	sl_uint64 BufferedWriter::getWrittenSize()
+	{
+		return m_sizeWritten + (sl_uint64)(m_pos - m_buf);
+	}
+
+	sl_bool BufferedWriter::_flush()
+	{
+		sl_size size = m_pos - m_buf;
+		if (!size) {
+			return sl_true;
+		}
+		sl_reg n = m_writer->writeFully(m_buf, size);
+		if (n == (sl_reg)size) {
+			m_sizeWritten += size;
+			m_pos = m_buf;
+			return sl_true;
+		}
+		if (n > 0) {
+			// keeps the data not written
+			Base::moveMemory(m_buf, m_buf + n, size - n);
+			m_pos -= n;
+			m_sizeWritten += n;
+		}
+		return sl_false;
+	}
+
 }
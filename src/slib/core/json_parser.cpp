@@ -0,0 +1,1612 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "slib/core/json_parser.h"
+
+#include "slib/core/io.h"
+#include "slib/core/file.h"
+#include "slib/core/async.h"
+#include "slib/core/parse.h"
+#include "slib/core/log.h"
+
+#if defined(SLIB_ARCH_IS_X64) && (defined(SLIB_COMPILER_IS_VC) || defined(SLIB_COMPILER_IS_GCC))
+#	define PRIV_JSON_SUPPORT_SSE2
+#	include <emmintrin.h>
+#	if defined(SLIB_COMPILER_IS_VC)
+#		include <intrin.h>
+#	endif
+#endif
+
+#define PRIV_JSON_STATE_VALUE 0
+#define PRIV_JSON_STATE_VALUE_OR_END 1
+#define PRIV_JSON_STATE_KEY 2
+#define PRIV_JSON_STATE_COLON 3
+#define PRIV_JSON_STATE_COMMA_OR_END 4
+#define PRIV_JSON_STATE_END 5
+
+#define PRIV_JSON_CONTAINER_ARRAY 0
+#define PRIV_JSON_CONTAINER_OBJECT 1
+
+#define PRIV_JSON_NUMBER_INT64 1
+#define PRIV_JSON_NUMBER_DOUBLE 2
+
+#define PRIV_JSON_DEFAULT_CHUNK_SIZE 0x10000
+
+namespace slib
+{
+
+#if defined(PRIV_JSON_SUPPORT_SSE2)
+	SLIB_INLINE static sl_uint32 _priv_JsonParser_getLowestBit(sl_uint32 mask)
+	{
+#	if defined(SLIB_COMPILER_IS_VC)
+		unsigned long index;
+		_BitScanForward(&index, mask);
+		return (sl_uint32)index;
+#	else
+		return (sl_uint32)(__builtin_ctz(mask));
+#	endif
+	}
+#endif
+
+	static const sl_char8* _priv_JsonParser_skipWhiteSpaces(const sl_char8* p, const sl_char8* end)
+	{
+		if (p < end && !(SLIB_CHAR_IS_WHITE_SPACE(*p))) {
+			return p;
+		}
+#if defined(PRIV_JSON_SUPPORT_SSE2)
+		// the indentations of the pretty-printed documents
+		__m128i space = _mm_set1_epi8(' ');
+		__m128i tab = _mm_set1_epi8('\t');
+		__m128i cr = _mm_set1_epi8('\r');
+		__m128i lf = _mm_set1_epi8('\n');
+		while (end - p >= 16) {
+			__m128i v = _mm_loadu_si128((const __m128i*)p);
+			__m128i ws = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, space), _mm_cmpeq_epi8(v, tab)), _mm_or_si128(_mm_cmpeq_epi8(v, cr), _mm_cmpeq_epi8(v, lf)));
+			sl_uint32 mask = (~(sl_uint32)(_mm_movemask_epi8(ws))) & 0xffff;
+			if (mask) {
+				return p + _priv_JsonParser_getLowestBit(mask);
+			}
+			p += 16;
+		}
+#endif
+		while (p < end) {
+			sl_char8 ch = *p;
+			if (!(SLIB_CHAR_IS_WHITE_SPACE(ch))) {
+				break;
+			}
+			p++;
+		}
+		return p;
+	}
+
+	// returns the position of `quote` or backslash, or `end`
+	static const sl_char8* _priv_JsonParser_findQuoteOrEscape(const sl_char8* p, const sl_char8* end, sl_char8 quote)
+	{
+#if defined(PRIV_JSON_SUPPORT_SSE2)
+		__m128i q = _mm_set1_epi8(quote);
+		__m128i b = _mm_set1_epi8('\\');
+		while (end - p >= 16) {
+			__m128i v = _mm_loadu_si128((const __m128i*)p);
+			sl_uint32 mask = (sl_uint32)(_mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(v, q), _mm_cmpeq_epi8(v, b))));
+			if (mask) {
+				return p + _priv_JsonParser_getLowestBit(mask);
+			}
+			p += 16;
+		}
+#endif
+		while (p < end) {
+			sl_char8 ch = *p;
+			if (ch == quote || ch == '\\') {
+				return p;
+			}
+			p++;
+		}
+		return end;
+	}
+
+	SLIB_INLINE static sl_bool _priv_JsonParser_isDelimiter(sl_char8 ch)
+	{
+		return SLIB_CHAR_IS_WHITE_SPACE(ch) || ch == ',' || ch == ']' || ch == '}' || ch == '/';
+	}
+
+	static sl_int32 _priv_JsonParser_parseHex4(const sl_char8* p, const sl_char8* end)
+	{
+		if (end - p < 4) {
+			return -1;
+		}
+		sl_int32 v = 0;
+		for (sl_uint32 i = 0; i < 4; i++) {
+			sl_uint32 h = SLIB_CHAR_HEX_TO_INT(p[i]);
+			if (h >= 16) {
+				return -1;
+			}
+			v = (v << 4) | h;
+		}
+		return v;
+	}
+
+	static sl_char8* _priv_JsonParser_encodeUtf8(sl_char8* out, sl_uint32 code)
+	{
+		if (code < 0x80) {
+			*(out++) = (sl_char8)code;
+		} else if (code < 0x800) {
+			*(out++) = (sl_char8)(0xC0 | (code >> 6));
+			*(out++) = (sl_char8)(0x80 | (code & 0x3F));
+		} else if (code < 0x10000) {
+			*(out++) = (sl_char8)(0xE0 | (code >> 12));
+			*(out++) = (sl_char8)(0x80 | ((code >> 6) & 0x3F));
+			*(out++) = (sl_char8)(0x80 | (code & 0x3F));
+		} else {
+			*(out++) = (sl_char8)(0xF0 | (code >> 18));
+			*(out++) = (sl_char8)(0x80 | ((code >> 12) & 0x3F));
+			*(out++) = (sl_char8)(0x80 | ((code >> 6) & 0x3F));
+			*(out++) = (sl_char8)(0x80 | (code & 0x3F));
+		}
+		return out;
+	}
+
+	// `out` should have `end - p` bytes at least (escape sequences are not shorter than their UTF-8 output). returns the output length
+	static sl_size _priv_JsonParser_unescape(const sl_char8* p, const sl_char8* end, sl_char8* out)
+	{
+		sl_char8* start = out;
+		while (p < end) {
+			sl_char8 ch = *p;
+			if (ch != '\\') {
+				*(out++) = ch;
+				p++;
+				continue;
+			}
+			p++;
+			if (p == end) {
+				break;
+			}
+			ch = *(p++);
+			switch (ch) {
+				case 'b':
+					*(out++) = '\b';
+					break;
+				case 'f':
+					*(out++) = '\f';
+					break;
+				case 'n':
+					*(out++) = '\n';
+					break;
+				case 'r':
+					*(out++) = '\r';
+					break;
+				case 't':
+					*(out++) = '\t';
+					break;
+				case 'v':
+					*(out++) = '\v';
+					break;
+				case '0':
+					*(out++) = 0;
+					break;
+				case 'u':
+					{
+						sl_int32 code = _priv_JsonParser_parseHex4(p, end);
+						if (code < 0) {
+							*(out++) = 'u';
+							break;
+						}
+						p += 4;
+						if (code >= 0xD800 && code < 0xDC00) {
+							if (end - p >= 6 && p[0] == '\\' && p[1] == 'u') {
+								sl_int32 low = _priv_JsonParser_parseHex4(p + 2, end);
+								if (low >= 0xDC00 && low < 0xE000) {
+									code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+									p += 6;
+								}
+							}
+						}
+						out = _priv_JsonParser_encodeUtf8(out, (sl_uint32)code);
+						break;
+					}
+				default:
+					*(out++) = ch;
+					break;
+			}
+		}
+		return out - start;
+	}
+
+
+	static const double _priv_JsonParser_pow10[] = {
+		1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15
+	};
+
+	static sl_uint32 _priv_JsonParser_parseNumber(const sl_char8* p, const sl_char8* end, sl_int64& outInt, double& outDouble)
+	{
+		const sl_char8* s = p;
+		sl_bool flagNegative = sl_false;
+		if (*s == '-') {
+			flagNegative = sl_true;
+			s++;
+		}
+		// 19 digits can not overflow `sl_uint64`
+		sl_uint64 v = 0;
+		const sl_char8* e = s;
+		while (e < end && e - s < 19) {
+			sl_uint32 digit = (sl_uint32)(*e - '0');
+			if (digit > 9) {
+				break;
+			}
+			v = v * 10 + digit;
+			e++;
+		}
+		sl_size nDigits = e - s;
+		if (nDigits) {
+			if (e == end) {
+				if (v <= (sl_uint64)SLIB_INT64_MAX + (flagNegative ? 1 : 0)) {
+					outInt = flagNegative ? (sl_int64)((sl_uint64)0 - v) : (sl_int64)v;
+					return PRIV_JSON_NUMBER_INT64;
+				}
+			} else if (*e == '.') {
+				// exact when the mantissa is below 2^53, and the divisor is a power of 10 below 2^53
+				const sl_char8* f = e + 1;
+				while (f < end && nDigits < 15) {
+					sl_uint32 digit = (sl_uint32)(*f - '0');
+					if (digit > 9) {
+						break;
+					}
+					v = v * 10 + digit;
+					f++;
+					nDigits++;
+				}
+				sl_size nFraction = f - (e + 1);
+				if (f == end && nFraction) {
+					double d = (double)v / _priv_JsonParser_pow10[nFraction];
+					outDouble = flagNegative ? -d : d;
+					return PRIV_JSON_NUMBER_DOUBLE;
+				}
+			}
+		}
+		sl_size n = end - p;
+		if (String::parseDouble(&outDouble, p, 0, n) == (sl_reg)n) {
+			return PRIV_JSON_NUMBER_DOUBLE;
+		}
+		return 0;
+	}
+
+
+	IJsonParseListener::IJsonParseListener()
+	{
+	}
+
+	IJsonParseListener::~IJsonParseListener()
+	{
+	}
+
+	void IJsonParseListener::onStartObject(JsonParser* parser)
+	{
+	}
+
+	void IJsonParseListener::onEndObject(JsonParser* parser)
+	{
+	}
+
+	void IJsonParseListener::onStartArray(JsonParser* parser)
+	{
+	}
+
+	void IJsonParseListener::onEndArray(JsonParser* parser)
+	{
+	}
+
+	void IJsonParseListener::onKey(JsonParser* parser, const sl_char8* key, sl_size len)
+	{
+	}
+
+	void IJsonParseListener::onString(JsonParser* parser, const sl_char8* value, sl_size len)
+	{
+	}
+
+	void IJsonParseListener::onInt64(JsonParser* parser, sl_int64 value)
+	{
+	}
+
+	void IJsonParseListener::onDouble(JsonParser* parser, double value)
+	{
+	}
+
+	void IJsonParseListener::onBoolean(JsonParser* parser, sl_bool value)
+	{
+	}
+
+	void IJsonParseListener::onNull(JsonParser* parser)
+	{
+	}
+
+
+	JsonParserParam::JsonParserParam()
+	{
+		listener = sl_null;
+		flagSupportComments = sl_true;
+		flagMultipleValues = sl_false;
+		chunkSize = PRIV_JSON_DEFAULT_CHUNK_SIZE;
+		flagLogError = sl_true;
+	}
+
+	JsonParserParam::~JsonParserParam()
+	{
+	}
+
+
+	SLIB_DEFINE_OBJECT(JsonParser, Object)
+
+	JsonParser::JsonParser()
+	{
+		m_listener = sl_null;
+		m_flagSupportComments = sl_true;
+		m_flagMultipleValues = sl_false;
+		m_chunkSize = PRIV_JSON_DEFAULT_CHUNK_SIZE;
+		m_flagLogError = sl_true;
+
+		m_state = PRIV_JSON_STATE_VALUE;
+		m_depth = 0;
+
+		m_sizePending = 0;
+		m_offsetBuffer = 0;
+		m_sizeScanned = 0;
+		m_flagScannedEscapes = sl_false;
+
+		m_flagStop = sl_false;
+		m_flagError = sl_false;
+		m_errorPosition = 0;
+	}
+
+	JsonParser::~JsonParser()
+	{
+	}
+
+	Ref<JsonParser> JsonParser::create(const JsonParserParam& param)
+	{
+		if (!(param.listener)) {
+			return sl_null;
+		}
+		Ref<JsonParser> ret = new JsonParser;
+		if (ret.isNotNull()) {
+			ret->m_listener = param.listener;
+			ret->m_flagSupportComments = param.flagSupportComments;
+			ret->m_flagMultipleValues = param.flagMultipleValues;
+			if (param.chunkSize) {
+				ret->m_chunkSize = param.chunkSize;
+			}
+			ret->m_flagLogError = param.flagLogError;
+		}
+		return ret;
+	}
+
+	sl_bool JsonParser::feed(const void* data, sl_size size)
+	{
+		if (m_flagError || m_flagStop) {
+			return sl_false;
+		}
+		if (!size) {
+			return sl_true;
+		}
+		if (m_sizePending) {
+			if (!(_reserveBuffer(m_pending, m_sizePending + size, m_sizePending))) {
+				return sl_false;
+			}
+			Base::copyMemory((sl_uint8*)(m_pending.getData()) + m_sizePending, data, size);
+			m_sizePending += size;
+			sl_size n = _parse((sl_char8*)(m_pending.getData()), m_sizePending, sl_false);
+			if (m_flagError || m_flagStop) {
+				return sl_false;
+			}
+			return _shiftPending(n);
+		} else {
+			sl_size n = _parse((sl_char8*)data, size, sl_false);
+			if (m_flagError || m_flagStop) {
+				return sl_false;
+			}
+			m_offsetBuffer += n;
+			sl_size sizeRemain = size - n;
+			if (sizeRemain) {
+				if (!(_reserveBuffer(m_pending, sizeRemain, 0))) {
+					return sl_false;
+				}
+				Base::copyMemory(m_pending.getData(), (sl_uint8*)data + n, sizeRemain);
+				m_sizePending = sizeRemain;
+			}
+			return sl_true;
+		}
+	}
+
+	sl_bool JsonParser::finish()
+	{
+		if (m_flagError || m_flagStop) {
+			return sl_false;
+		}
+		if (m_sizePending) {
+			sl_size n = _parse((sl_char8*)(m_pending.getData()), m_sizePending, sl_true);
+			if (m_flagError || m_flagStop) {
+				return sl_false;
+			}
+			m_offsetBuffer += n;
+			m_sizePending = 0;
+		}
+		return _finish();
+	}
+
+	sl_bool JsonParser::parse(const void* data, sl_size size)
+	{
+		if (m_sizePending) {
+			if (feed(data, size)) {
+				return finish();
+			}
+			return sl_false;
+		}
+		if (m_flagError || m_flagStop) {
+			return sl_false;
+		}
+		sl_size n = _parse((sl_char8*)data, size, sl_true);
+		if (m_flagError || m_flagStop) {
+			return sl_false;
+		}
+		m_offsetBuffer += n;
+		return _finish();
+	}
+
+	sl_bool JsonParser::parse(IReader* reader)
+	{
+		if (!reader) {
+			return sl_false;
+		}
+		for (;;) {
+			if (m_flagError || m_flagStop) {
+				return sl_false;
+			}
+			if (!(_reserveBuffer(m_pending, m_sizePending + m_chunkSize, m_sizePending))) {
+				return sl_false;
+			}
+			sl_reg nRead = reader->read((sl_uint8*)(m_pending.getData()) + m_sizePending, m_chunkSize);
+			if (nRead <= 0) {
+				break;
+			}
+			m_sizePending += nRead;
+			sl_size n = _parse((sl_char8*)(m_pending.getData()), m_sizePending, sl_false);
+			if (m_flagError || m_flagStop) {
+				return sl_false;
+			}
+			if (!(_shiftPending(n))) {
+				return sl_false;
+			}
+		}
+		return finish();
+	}
+
+	sl_bool JsonParser::parseFile(const String& filePath)
+	{
+		Ref<File> file = File::openForRead(filePath);
+		if (file.isNull()) {
+			_setError("Failed to open the file", 0);
+			return sl_false;
+		}
+		return parse(file.get());
+	}
+
+	sl_bool JsonParser::parseAsync(const Ref<AsyncStream>& stream, const Function<void(JsonParser*)>& onComplete)
+	{
+		if (stream.isNull()) {
+			return sl_false;
+		}
+		if (m_flagError || m_flagStop) {
+			return sl_false;
+		}
+		if (!(_reserveBuffer(m_pending, m_sizePending + m_chunkSize, m_sizePending))) {
+			return sl_false;
+		}
+		Ref<JsonParser> thiz = this;
+		return stream->read((sl_uint8*)(m_pending.getData()) + m_sizePending, m_chunkSize, [thiz, onComplete](AsyncStreamResult* result) {
+			thiz->_onReadStream(result, onComplete);
+		});
+	}
+
+	void JsonParser::stop()
+	{
+		m_flagStop = sl_true;
+	}
+
+	void JsonParser::reset()
+	{
+		m_state = PRIV_JSON_STATE_VALUE;
+		m_depth = 0;
+		m_sizePending = 0;
+		m_offsetBuffer = 0;
+		m_sizeScanned = 0;
+		m_flagScannedEscapes = sl_false;
+		m_flagStop = sl_false;
+		m_flagError = sl_false;
+		m_errorMessage.setNull();
+		m_errorPosition = 0;
+	}
+
+	sl_bool JsonParser::isStopped()
+	{
+		return m_flagStop;
+	}
+
+	sl_bool JsonParser::isError()
+	{
+		return m_flagError;
+	}
+
+	String JsonParser::getErrorMessage()
+	{
+		return m_errorMessage;
+	}
+
+	sl_uint64 JsonParser::getErrorPosition()
+	{
+		return m_errorPosition;
+	}
+
+	String JsonParser::getErrorText()
+	{
+		if (m_flagError) {
+			return "(" + String::fromUint64(m_errorPosition) + ") " + m_errorMessage;
+		}
+		return sl_null;
+	}
+
+	sl_size JsonParser::getDepth()
+	{
+		return m_depth;
+	}
+
+	sl_size JsonParser::_parse(const sl_char8* buf, sl_size len, sl_bool flagEnd)
+	{
+		IJsonParseListener* listener = m_listener;
+		const sl_char8* end = buf + len;
+		const sl_char8* p = buf;
+		sl_uint32 state = m_state;
+
+#define PRIV_JSON_SET_STATE_AFTER_VALUE \
+		state = m_depth ? PRIV_JSON_STATE_COMMA_OR_END : PRIV_JSON_STATE_END; \
+		m_state = state;
+
+#define PRIV_JSON_CHECK_STOP \
+		if (m_flagStop) { \
+			return p - buf; \
+		}
+
+#define PRIV_JSON_ERROR(MSG) \
+		_setError(MSG, p - buf); \
+		return p - buf;
+
+		for (;;) {
+
+			p = _priv_JsonParser_skipWhiteSpaces(p, end);
+			if (p == end) {
+				return len;
+			}
+			sl_char8 ch = *p;
+
+			if (ch == '/' && m_flagSupportComments) {
+				if (p + 1 == end) {
+					if (flagEnd) {
+						PRIV_JSON_ERROR("Invalid token")
+					}
+					return p - buf;
+				}
+				if (p[1] == '/') {
+					const sl_char8* q = p + 2;
+					while (q < end && *q != '\r' && *q != '\n') {
+						q++;
+					}
+					if (q == end && !flagEnd) {
+						return p - buf;
+					}
+					p = q;
+					continue;
+				} else if (p[1] == '*') {
+					const sl_char8* q = p + 2;
+					for (;;) {
+						q = (const sl_char8*)(Base::findMemory(q, '*', end - q));
+						if (!q || q + 1 >= end) {
+							q = sl_null;
+							break;
+						}
+						if (q[1] == '/') {
+							q += 2;
+							break;
+						}
+						q++;
+					}
+					if (!q) {
+						if (!flagEnd) {
+							return p - buf;
+						}
+						// unterminated comment is ignored, like `Json::parseJson()`
+						q = end;
+					}
+					p = q;
+					continue;
+				}
+			}
+
+			if (state == PRIV_JSON_STATE_COMMA_OR_END) {
+				sl_uint8 container = ((sl_uint8*)(m_stack.getData()))[m_depth - 1];
+				if (ch == ',') {
+					p++;
+					state = container == PRIV_JSON_CONTAINER_OBJECT ? PRIV_JSON_STATE_KEY : PRIV_JSON_STATE_VALUE;
+					m_state = state;
+					continue;
+				}
+				if (ch == ']') {
+					if (container != PRIV_JSON_CONTAINER_ARRAY) {
+						PRIV_JSON_ERROR("Object: Missing character } ")
+					}
+					p++;
+					m_depth--;
+					PRIV_JSON_SET_STATE_AFTER_VALUE
+					listener->onEndArray(this);
+					PRIV_JSON_CHECK_STOP
+					continue;
+				}
+				if (ch == '}') {
+					if (container != PRIV_JSON_CONTAINER_OBJECT) {
+						PRIV_JSON_ERROR("Array: Missing character ] ")
+					}
+					p++;
+					m_depth--;
+					PRIV_JSON_SET_STATE_AFTER_VALUE
+					listener->onEndObject(this);
+					PRIV_JSON_CHECK_STOP
+					continue;
+				}
+				if (container == PRIV_JSON_CONTAINER_OBJECT) {
+					PRIV_JSON_ERROR("Object: Missing character , ")
+				} else {
+					PRIV_JSON_ERROR("Array: Missing character ] ")
+				}
+			}
+
+			if (state == PRIV_JSON_STATE_COLON) {
+				if (ch == ':') {
+					p++;
+					state = PRIV_JSON_STATE_VALUE;
+					m_state = state;
+					continue;
+				}
+				PRIV_JSON_ERROR("Object: Missing character : ")
+			}
+
+			if (state == PRIV_JSON_STATE_END) {
+				if (!m_flagMultipleValues) {
+					PRIV_JSON_ERROR("Invalid token")
+				}
+				state = PRIV_JSON_STATE_VALUE;
+				m_state = state;
+			}
+
+			// string, or key
+			const sl_char8* strData = sl_null;
+			sl_size strLen = 0;
+			if (ch == '"' || ch == '\'') {
+				const sl_char8* s = p + 1;
+				const sl_char8* q = s;
+				sl_bool flagEscapes = sl_false;
+				if (p == buf && m_sizeScanned) {
+					// resumes scanning of the long string
+					q = buf + m_sizeScanned;
+					flagEscapes = m_flagScannedEscapes;
+				}
+				m_sizeScanned = 0;
+				for (;;) {
+					q = _priv_JsonParser_findQuoteOrEscape(q, end, ch);
+					if (q == end) {
+						break;
+					}
+					if (*q == ch) {
+						break;
+					}
+					flagEscapes = sl_true;
+					if (q + 1 == end) {
+						break;
+					}
+					q += 2;
+					if (q >= end) {
+						q = end;
+						break;
+					}
+				}
+				if (q >= end || *q != ch) {
+					if (flagEnd) {
+						if (state == PRIV_JSON_STATE_KEY) {
+							PRIV_JSON_ERROR("Object Item Name: Missing terminating character \" or ' ")
+						} else {
+							PRIV_JSON_ERROR("String: Missing character  \" or ' ")
+						}
+					}
+					// `q` is at the end, or at the incomplete escape sequence
+					m_sizeScanned = q - p;
+					m_flagScannedEscapes = flagEscapes;
+					return p - buf;
+				}
+				if (flagEscapes) {
+					if (!(_reserveBuffer(m_bufString, q - s, 0))) {
+						return p - buf;
+					}
+					strData = (sl_char8*)(m_bufString.getData());
+					strLen = _priv_JsonParser_unescape(s, q, (sl_char8*)strData);
+				} else {
+					strData = s;
+					strLen = q - s;
+				}
+				p = q + 1;
+				if (state == PRIV_JSON_STATE_KEY) {
+					state = PRIV_JSON_STATE_COLON;
+					m_state = state;
+					listener->onKey(this, strData, strLen);
+				} else {
+					PRIV_JSON_SET_STATE_AFTER_VALUE
+					listener->onString(this, strData, strLen);
+				}
+				PRIV_JSON_CHECK_STOP
+				continue;
+			}
+
+			if (state == PRIV_JSON_STATE_KEY) {
+				if (ch == '}') {
+					p++;
+					m_depth--;
+					PRIV_JSON_SET_STATE_AFTER_VALUE
+					listener->onEndObject(this);
+					PRIV_JSON_CHECK_STOP
+					continue;
+				}
+				const sl_char8* q = p;
+				while (q < end) {
+					sl_char8 c = *q;
+					if ((c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || c == '_' || (q != p && c >= '0' && c <= '9')) {
+						q++;
+					} else {
+						break;
+					}
+				}
+				if (q == end) {
+					if (flagEnd) {
+						PRIV_JSON_ERROR("Object: Missing character : ")
+					}
+					return p - buf;
+				}
+				if (q == p) {
+					PRIV_JSON_ERROR("Object: Missing character } ")
+				}
+				strData = p;
+				strLen = q - p;
+				p = q;
+				state = PRIV_JSON_STATE_COLON;
+				m_state = state;
+				listener->onKey(this, strData, strLen);
+				PRIV_JSON_CHECK_STOP
+				continue;
+			}
+
+			// value
+			if (ch == '{') {
+				if (!(_pushContainer(PRIV_JSON_CONTAINER_OBJECT))) {
+					return p - buf;
+				}
+				p++;
+				state = PRIV_JSON_STATE_KEY;
+				m_state = state;
+				listener->onStartObject(this);
+				PRIV_JSON_CHECK_STOP
+				continue;
+			}
+			if (ch == '[') {
+				if (!(_pushContainer(PRIV_JSON_CONTAINER_ARRAY))) {
+					return p - buf;
+				}
+				p++;
+				state = PRIV_JSON_STATE_VALUE_OR_END;
+				m_state = state;
+				listener->onStartArray(this);
+				PRIV_JSON_CHECK_STOP
+				continue;
+			}
+			if (ch == ']' || ch == '}' || ch == ',') {
+				if (!m_depth) {
+					PRIV_JSON_ERROR("Invalid token")
+				}
+				if (ch == ']' && state == PRIV_JSON_STATE_VALUE_OR_END) {
+					p++;
+					m_depth--;
+					PRIV_JSON_SET_STATE_AFTER_VALUE
+					listener->onEndArray(this);
+					PRIV_JSON_CHECK_STOP
+					continue;
+				}
+				// empty element
+				state = PRIV_JSON_STATE_COMMA_OR_END;
+				m_state = state;
+				listener->onNull(this);
+				PRIV_JSON_CHECK_STOP
+				continue;
+			}
+
+			// number, or literal
+			{
+				const sl_char8* q = p;
+				if (p == buf && m_sizeScanned) {
+					q = buf + m_sizeScanned;
+				}
+				m_sizeScanned = 0;
+				while (q < end && !(_priv_JsonParser_isDelimiter(*q))) {
+					q++;
+				}
+				if (q == end && !flagEnd) {
+					m_sizeScanned = q - p;
+					return p - buf;
+				}
+				sl_size n = q - p;
+				if (ch == 'n' && n == 4 && p[1] == 'u' && p[2] == 'l' && p[3] == 'l') {
+					p = q;
+					PRIV_JSON_SET_STATE_AFTER_VALUE
+					listener->onNull(this);
+					PRIV_JSON_CHECK_STOP
+					continue;
+				}
+				if (ch == 't' && n == 4 && p[1] == 'r' && p[2] == 'u' && p[3] == 'e') {
+					p = q;
+					PRIV_JSON_SET_STATE_AFTER_VALUE
+					listener->onBoolean(this, sl_true);
+					PRIV_JSON_CHECK_STOP
+					continue;
+				}
+				if (ch == 'f' && n == 5 && p[1] == 'a' && p[2] == 'l' && p[3] == 's' && p[4] == 'e') {
+					p = q;
+					PRIV_JSON_SET_STATE_AFTER_VALUE
+					listener->onBoolean(this, sl_false);
+					PRIV_JSON_CHECK_STOP
+					continue;
+				}
+				sl_int64 vi64;
+				double vf;
+				sl_uint32 typeNumber = _priv_JsonParser_parseNumber(p, q, vi64, vf);
+				if (typeNumber == PRIV_JSON_NUMBER_INT64) {
+					p = q;
+					PRIV_JSON_SET_STATE_AFTER_VALUE
+					listener->onInt64(this, vi64);
+					PRIV_JSON_CHECK_STOP
+					continue;
+				}
+				if (typeNumber == PRIV_JSON_NUMBER_DOUBLE) {
+					p = q;
+					PRIV_JSON_SET_STATE_AFTER_VALUE
+					listener->onDouble(this, vf);
+					PRIV_JSON_CHECK_STOP
+					continue;
+				}
+				PRIV_JSON_ERROR("Invalid token")
+			}
+		}
+
+#undef PRIV_JSON_SET_STATE_AFTER_VALUE
+#undef PRIV_JSON_CHECK_STOP
+#undef PRIV_JSON_ERROR
+
+	}
+
+	sl_bool JsonParser::_finish()
+	{
+		if (m_depth) {
+			if (((sl_uint8*)(m_stack.getData()))[m_depth - 1] == PRIV_JSON_CONTAINER_OBJECT) {
+				_setError("Object: Missing character } ", 0);
+			} else {
+				_setError("Array: Missing character ] ", 0);
+			}
+			return sl_false;
+		}
+		if (m_state == PRIV_JSON_STATE_COLON) {
+			_setError("Object: Missing character : ", 0);
+			return sl_false;
+		}
+		return sl_true;
+	}
+
+	sl_bool JsonParser::_pushContainer(sl_uint8 type)
+	{
+		if (m_depth >= m_stack.getSize()) {
+			if (!(_reserveBuffer(m_stack, m_depth + 1, m_depth))) {
+				return sl_false;
+			}
+		}
+		((sl_uint8*)(m_stack.getData()))[m_depth] = type;
+		m_depth++;
+		return sl_true;
+	}
+
+	void JsonParser::_setError(const char* message, sl_size offset)
+	{
+		m_flagError = sl_true;
+		m_errorMessage = message;
+		m_errorPosition = m_offsetBuffer + offset;
+		if (m_flagLogError) {
+			LogError("JsonParser", getErrorText());
+		}
+	}
+
+	sl_bool JsonParser::_reserveBuffer(Memory& mem, sl_size size, sl_size sizeKeep)
+	{
+		sl_size sizeOld = mem.getSize();
+		if (size <= sizeOld) {
+			return sl_true;
+		}
+		sl_size sizeNew = sizeOld + (sizeOld >> 1);
+		if (sizeNew < size) {
+			sizeNew = size;
+		}
+		if (sizeNew < 64) {
+			sizeNew = 64;
+		}
+		Memory memNew = Memory::create(sizeNew);
+		if (memNew.isNull()) {
+			m_flagError = sl_true;
+			m_errorMessage = "Out of memory";
+			m_errorPosition = m_offsetBuffer;
+			return sl_false;
+		}
+		if (sizeKeep) {
+			Base::copyMemory(memNew.getData(), mem.getData(), sizeKeep);
+		}
+		mem = memNew;
+		return sl_true;
+	}
+
+	sl_bool JsonParser::_shiftPending(sl_size sizeConsumed)
+	{
+		m_offsetBuffer += sizeConsumed;
+		sl_size sizeRemain = m_sizePending - sizeConsumed;
+		if (sizeConsumed && sizeRemain) {
+			sl_uint8* data = (sl_uint8*)(m_pending.getData());
+			Base::moveMemory(data, data + sizeConsumed, sizeRemain);
+		}
+		m_sizePending = sizeRemain;
+		return sl_true;
+	}
+
+	void JsonParser::_onReadStream(AsyncStreamResult* result, const Function<void(JsonParser*)>& onComplete)
+	{
+		if (result->size) {
+			m_sizePending += result->size;
+			sl_size n = _parse((sl_char8*)(m_pending.getData()), m_sizePending, sl_false);
+			if (m_flagError || m_flagStop) {
+				onComplete(this);
+				return;
+			}
+			_shiftPending(n);
+		}
+		if (result->flagError || !(result->size)) {
+			finish();
+			onComplete(this);
+			return;
+		}
+		if (!(parseAsync(result->stream, onComplete))) {
+			if (!m_flagError) {
+				_setError("Failed to read the stream", m_sizePending);
+			}
+			onComplete(this);
+		}
+	}
+
+
+	JsonValue::JsonValue(): m_node(sl_null)
+	{
+	}
+
+	JsonValue::JsonValue(const JsonNode* node): m_node(node)
+	{
+	}
+
+	JsonValueType JsonValue::getType() const
+	{
+		if (m_node) {
+			return (JsonValueType)(m_node->type);
+		}
+		return JsonValueType::Null;
+	}
+
+	sl_bool JsonValue::isNull() const
+	{
+		return !m_node || m_node->type == (sl_uint32)(JsonValueType::Null);
+	}
+
+	sl_bool JsonValue::isBoolean() const
+	{
+		return m_node && m_node->type == (sl_uint32)(JsonValueType::Boolean);
+	}
+
+	sl_bool JsonValue::isInt64() const
+	{
+		return m_node && m_node->type == (sl_uint32)(JsonValueType::Int64);
+	}
+
+	sl_bool JsonValue::isNumber() const
+	{
+		return m_node && (m_node->type == (sl_uint32)(JsonValueType::Int64) || m_node->type == (sl_uint32)(JsonValueType::Double));
+	}
+
+	sl_bool JsonValue::isString() const
+	{
+		return m_node && m_node->type == (sl_uint32)(JsonValueType::String);
+	}
+
+	sl_bool JsonValue::isArray() const
+	{
+		return m_node && m_node->type == (sl_uint32)(JsonValueType::Array);
+	}
+
+	sl_bool JsonValue::isObject() const
+	{
+		return m_node && m_node->type == (sl_uint32)(JsonValueType::Object);
+	}
+
+	sl_bool JsonValue::getBoolean(sl_bool def) const
+	{
+		if (isBoolean()) {
+			return m_node->boolean;
+		}
+		return def;
+	}
+
+	sl_int32 JsonValue::getInt32(sl_int32 def) const
+	{
+		if (m_node) {
+			if (m_node->type == (sl_uint32)(JsonValueType::Int64)) {
+				return (sl_int32)(m_node->int64);
+			}
+			if (m_node->type == (sl_uint32)(JsonValueType::Double)) {
+				return (sl_int32)(m_node->real);
+			}
+		}
+		return def;
+	}
+
+	sl_int64 JsonValue::getInt64(sl_int64 def) const
+	{
+		if (m_node) {
+			if (m_node->type == (sl_uint32)(JsonValueType::Int64)) {
+				return m_node->int64;
+			}
+			if (m_node->type == (sl_uint32)(JsonValueType::Double)) {
+				return (sl_int64)(m_node->real);
+			}
+		}
+		return def;
+	}
+
+	double JsonValue::getDouble(double def) const
+	{
+		if (m_node) {
+			if (m_node->type == (sl_uint32)(JsonValueType::Double)) {
+				return m_node->real;
+			}
+			if (m_node->type == (sl_uint32)(JsonValueType::Int64)) {
+				return (double)(m_node->int64);
+			}
+		}
+		return def;
+	}
+
+	const sl_char8* JsonValue::getStringData() const
+	{
+		if (isString()) {
+			return m_node->string;
+		}
+		return sl_null;
+	}
+
+	sl_size JsonValue::getStringLength() const
+	{
+		if (isString()) {
+			return m_node->count;
+		}
+		return 0;
+	}
+
+	sl_bool JsonValue::equalsString(const sl_char8* str, sl_size len) const
+	{
+		if (isString()) {
+			return m_node->count == len && Base::equalsMemory(m_node->string, str, len);
+		}
+		return sl_false;
+	}
+
+	String JsonValue::getString() const
+	{
+		if (isString()) {
+			return String(m_node->string, m_node->count);
+		}
+		return sl_null;
+	}
+
+	sl_size JsonValue::getCount() const
+	{
+		if (isArray() || isObject()) {
+			return m_node->count;
+		}
+		return 0;
+	}
+
+	JsonValue JsonValue::getElement(sl_size index) const
+	{
+		if (isArray() && index < m_node->count) {
+			return m_node->children + index;
+		}
+		return sl_null;
+	}
+
+	JsonValue JsonValue::getKey(sl_size index) const
+	{
+		if (isObject() && index < m_node->count) {
+			return m_node->children + (index << 1);
+		}
+		return sl_null;
+	}
+
+	JsonValue JsonValue::getValue(sl_size index) const
+	{
+		if (isObject() && index < m_node->count) {
+			return m_node->children + ((index << 1) + 1);
+		}
+		return sl_null;
+	}
+
+	JsonValue JsonValue::getItem(const sl_char8* key, sl_size len) const
+	{
+		if (isObject()) {
+			const JsonNode* node = m_node->children;
+			sl_size n = m_node->count;
+			for (sl_size i = 0; i < n; i++) {
+				if (node->count == len && Base::equalsMemory(node->string, key, len)) {
+					return node + 1;
+				}
+				node += 2;
+			}
+		}
+		return sl_null;
+	}
+
+	JsonValue JsonValue::getItem(const String& key) const
+	{
+		return getItem(key.getData(), key.getLength());
+	}
+
+	JsonValue JsonValue::operator[](sl_size index) const
+	{
+		return getElement(index);
+	}
+
+	JsonValue JsonValue::operator[](const String& key) const
+	{
+		return getItem(key.getData(), key.getLength());
+	}
+
+	Json JsonValue::toJson() const
+	{
+		if (!m_node) {
+			return sl_null;
+		}
+		switch ((JsonValueType)(m_node->type)) {
+			case JsonValueType::Boolean:
+				return Json::fromBoolean(m_node->boolean);
+			case JsonValueType::Int64:
+				{
+					sl_int64 v = m_node->int64;
+					if (v >= SLIB_INT64(-0x80000000) && v < SLIB_INT64(0x7fffffff)) {
+						return (sl_int32)v;
+					} else {
+						return v;
+					}
+				}
+			case JsonValueType::Double:
+				return m_node->real;
+			case JsonValueType::String:
+				return String(m_node->string, m_node->count);
+			case JsonValueType::Array:
+				{
+					JsonList list = JsonList::create(m_node->count);
+					if (list.isNull()) {
+						return sl_null;
+					}
+					Json* elements = list.getData();
+					for (sl_uint32 i = 0; i < m_node->count; i++) {
+						elements[i] = JsonValue(m_node->children + i).toJson();
+					}
+					return list;
+				}
+			case JsonValueType::Object:
+				{
+					JsonMap map = JsonMap::create();
+					if (map.isNull()) {
+						return sl_null;
+					}
+					const JsonNode* node = m_node->children;
+					for (sl_uint32 i = 0; i < m_node->count; i++) {
+						map.put_NoLock(String(node->string, node->count), JsonValue(node + 1).toJson());
+						node += 2;
+					}
+					return map;
+				}
+			default:
+				break;
+		}
+		return sl_null;
+	}
+
+
+	class _priv_JsonDocument_Builder : public IJsonParseListener
+	{
+	public:
+		JsonDocument* document;
+		const sl_char8* source;
+		sl_size sizeSource;
+
+		// values of the open containers
+		JsonNode* nodes;
+		sl_size countNodes;
+		sl_size capacityNodes;
+		Memory memNodes;
+
+		// start indices of the open containers in `nodes`
+		sl_size* frames;
+		sl_size countFrames;
+		Memory memFrames;
+
+		const char* errorMessage;
+
+	public:
+		_priv_JsonDocument_Builder()
+		{
+			document = sl_null;
+			source = sl_null;
+			sizeSource = 0;
+			nodes = sl_null;
+			countNodes = 0;
+			capacityNodes = 0;
+			frames = sl_null;
+			countFrames = 0;
+			errorMessage = sl_null;
+		}
+
+	public:
+		void setError(JsonParser* parser, const char* message)
+		{
+			errorMessage = message;
+			parser->stop();
+		}
+
+		JsonNode* pushNode(JsonParser* parser, sl_uint32 type)
+		{
+			if (countNodes >= capacityNodes) {
+				sl_size n = capacityNodes ? capacityNodes << 1 : 256;
+				Memory mem = Memory::create(n * sizeof(JsonNode));
+				if (mem.isNull()) {
+					setError(parser, "Out of memory");
+					return sl_null;
+				}
+				if (countNodes) {
+					Base::copyMemory(mem.getData(), nodes, countNodes * sizeof(JsonNode));
+				}
+				memNodes = mem;
+				nodes = (JsonNode*)(mem.getData());
+				capacityNodes = n;
+			}
+			JsonNode* node = nodes + countNodes;
+			countNodes++;
+			node->type = type;
+			node->count = 0;
+			node->int64 = 0;
+			return node;
+		}
+
+		void pushString(JsonParser* parser, const sl_char8* str, sl_size len)
+		{
+			if (len > 0xFFFFFFFF) {
+				setError(parser, "String: Too long");
+				return;
+			}
+			JsonNode* node = pushNode(parser, (sl_uint32)(JsonValueType::String));
+			if (!node) {
+				return;
+			}
+			node->count = (sl_uint32)len;
+			if (str >= source && str + len <= source + sizeSource) {
+				node->string = str;
+			} else {
+				sl_char8* s = (sl_char8*)(document->_allocate(len + 1));
+				if (!s) {
+					setError(parser, "Out of memory");
+					return;
+				}
+				Base::copyMemory(s, str, len);
+				s[len] = 0;
+				node->string = s;
+			}
+		}
+
+		void startContainer(JsonParser* parser)
+		{
+			if (countFrames >= (memFrames.getSize() / sizeof(sl_size))) {
+				sl_size n = countFrames ? countFrames << 1 : 64;
+				Memory mem = Memory::create(n * sizeof(sl_size));
+				if (mem.isNull()) {
+					setError(parser, "Out of memory");
+					return;
+				}
+				if (countFrames) {
+					Base::copyMemory(mem.getData(), frames, countFrames * sizeof(sl_size));
+				}
+				memFrames = mem;
+				frames = (sl_size*)(mem.getData());
+			}
+			frames[countFrames] = countNodes;
+			countFrames++;
+		}
+
+		void endContainer(JsonParser* parser, JsonValueType type)
+		{
+			countFrames--;
+			sl_size start = frames[countFrames];
+			sl_size n = countNodes - start;
+			sl_size count = type == JsonValueType::Object ? (n >> 1) : n;
+			if (count > 0xFFFFFFFF) {
+				setError(parser, "Container: Too many items");
+				return;
+			}
+			JsonNode* children = sl_null;
+			if (n) {
+				children = (JsonNode*)(document->_allocate(n * sizeof(JsonNode)));
+				if (!children) {
+					setError(parser, "Out of memory");
+					return;
+				}
+				Base::copyMemory(children, nodes + start, n * sizeof(JsonNode));
+			}
+			countNodes = start;
+			JsonNode* node = pushNode(parser, (sl_uint32)type);
+			if (node) {
+				node->count = (sl_uint32)count;
+				node->children = children;
+			}
+		}
+
+	public:
+		void onStartObject(JsonParser* parser) override
+		{
+			startContainer(parser);
+		}
+
+		void onEndObject(JsonParser* parser) override
+		{
+			endContainer(parser, JsonValueType::Object);
+		}
+
+		void onStartArray(JsonParser* parser) override
+		{
+			startContainer(parser);
+		}
+
+		void onEndArray(JsonParser* parser) override
+		{
+			endContainer(parser, JsonValueType::Array);
+		}
+
+		void onKey(JsonParser* parser, const sl_char8* key, sl_size len) override
+		{
+			pushString(parser, key, len);
+		}
+
+		void onString(JsonParser* parser, const sl_char8* value, sl_size len) override
+		{
+			pushString(parser, value, len);
+		}
+
+		void onInt64(JsonParser* parser, sl_int64 value) override
+		{
+			JsonNode* node = pushNode(parser, (sl_uint32)(JsonValueType::Int64));
+			if (node) {
+				node->int64 = value;
+			}
+		}
+
+		void onDouble(JsonParser* parser, double value) override
+		{
+			JsonNode* node = pushNode(parser, (sl_uint32)(JsonValueType::Double));
+			if (node) {
+				node->real = value;
+			}
+		}
+
+		void onBoolean(JsonParser* parser, sl_bool value) override
+		{
+			JsonNode* node = pushNode(parser, (sl_uint32)(JsonValueType::Boolean));
+			if (node) {
+				node->boolean = value;
+			}
+		}
+
+		void onNull(JsonParser* parser) override
+		{
+			pushNode(parser, (sl_uint32)(JsonValueType::Null));
+		}
+
+	public:
+		sl_bool run(const sl_char8* data, sl_size size, JsonParseParam& param)
+		{
+			param.flagError = sl_false;
+			source = data;
+			sizeSource = size;
+
+			JsonParserParam pp;
+			pp.listener = this;
+			pp.flagSupportComments = param.flagSupportComments;
+			pp.flagLogError = sl_false;
+			Ref<JsonParser> parser = JsonParser::create(pp);
+			if (parser.isNull()) {
+				return sl_false;
+			}
+			if (parser->parse(data, size)) {
+				if (countNodes) {
+					document->m_root = nodes[0];
+				}
+				return sl_true;
+			}
+
+			param.flagError = sl_true;
+			param.errorPosition = (sl_size)(parser->getErrorPosition());
+			if (param.errorPosition > size) {
+				param.errorPosition = size;
+			}
+			if (errorMessage) {
+				param.errorMessage = errorMessage;
+			} else {
+				param.errorMessage = parser->getErrorMessage();
+			}
+			param.errorLine = ParseUtil::countLineNumber(data, param.errorPosition, &(param.errorColumn));
+			if (param.flagLogError) {
+				LogError("Json", param.getErrorText());
+			}
+			return sl_false;
+		}
+
+	};
+
+
+	SLIB_DEFINE_OBJECT(JsonDocument, Object)
+
+	JsonDocument::JsonDocument()
+	{
+		m_root.type = (sl_uint32)(JsonValueType::Null);
+		m_root.count = 0;
+		m_root.int64 = 0;
+		m_posBlock = sl_null;
+		m_sizeBlockRemain = 0;
+		m_sizeArena = 0;
+	}
+
+	JsonDocument::~JsonDocument()
+	{
+	}
+
+	Ref<JsonDocument> JsonDocument::parse(const Memory& content, JsonParseParam& param)
+	{
+		Ref<JsonDocument> ret = new JsonDocument;
+		if (ret.isNotNull()) {
+			ret->m_source = content;
+			_priv_JsonDocument_Builder builder;
+			builder.document = ret.get();
+			if (builder.run((sl_char8*)(content.getData()), content.getSize(), param)) {
+				return ret;
+			}
+		}
+		return sl_null;
+	}
+
+	Ref<JsonDocument> JsonDocument::parse(const Memory& content)
+	{
+		JsonParseParam param;
+		return parse(content, param);
+	}
+
+	Ref<JsonDocument> JsonDocument::parse(const String& json, JsonParseParam& param)
+	{
+		Ref<JsonDocument> ret = new JsonDocument;
+		if (ret.isNotNull()) {
+			ret->m_sourceString = json;
+			_priv_JsonDocument_Builder builder;
+			builder.document = ret.get();
+			if (builder.run(json.getData(), json.getLength(), param)) {
+				return ret;
+			}
+		}
+		return sl_null;
+	}
+
+	Ref<JsonDocument> JsonDocument::parse(const String& json)
+	{
+		JsonParseParam param;
+		return parse(json, param);
+	}
+
+	Ref<JsonDocument> JsonDocument::parse(const void* data, sl_size size, JsonParseParam& param)
+	{
+		return parse(Memory::create(data, size), param);
+	}
+
+	Ref<JsonDocument> JsonDocument::parse(const void* data, sl_size size)
+	{
+		JsonParseParam param;
+		return parse(data, size, param);
+	}
+
+	Ref<JsonDocument> JsonDocument::parseFile(const String& filePath, JsonParseParam& param)
+	{
+		Memory mem = File::readAllBytes(filePath);
+		if (mem.isNull()) {
+			return sl_null;
+		}
+		return parse(mem, param);
+	}
+
+	Ref<JsonDocument> JsonDocument::parseFile(const String& filePath)
+	{
+		JsonParseParam param;
+		return parseFile(filePath, param);
+	}
+
+	JsonValue JsonDocument::getRoot()
+	{
+		return &m_root;
+	}
+
+	sl_size JsonDocument::getArenaSize()
+	{
+		return m_sizeArena;
+	}
+
+	void* JsonDocument::_allocate(sl_size size)
+	{
+		size = (size + 7) & ~((sl_size)7);
+		if (size > m_sizeBlockRemain) {
+			// the blocks grow with the document, up to 4MB
+			sl_size sizeBlock = m_sizeArena;
+			if (sizeBlock < 0x10000) {
+				sizeBlock = 0x10000;
+			} else if (sizeBlock > 0x400000) {
+				sizeBlock = 0x400000;
+			}
+			if (sizeBlock < size) {
+				sizeBlock = size;
+			}
+			Memory mem = Memory::create(sizeBlock);
+			if (mem.isNull()) {
+				return sl_null;
+			}
+			if (!(m_blocks.add_NoLock(mem))) {
+				return sl_null;
+			}
+			m_posBlock = (sl_uint8*)(mem.getData());
+			m_sizeBlockRemain = sizeBlock;
+			m_sizeArena += sizeBlock;
+		}
+		void* ret = m_posBlock;
+		m_posBlock += size;
+		m_sizeBlockRemain -= size;
+		return ret;
+	}
+
+}
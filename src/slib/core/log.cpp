@@ -13,6 +13,11 @@
 #include "slib/core/file.h"
 #include "slib/core/variant.h"
 #include "slib/core/safe_static.h"
+#include "slib/core/thread.h"
+#include "slib/core/string_buffer.h"
+#include "slib/core/system.h"
+
+#include <atomic>
 
 #if defined(SLIB_PLATFORM_IS_ANDROID)
 #include <android/log.h>
@@ -54,9 +59,14 @@ namespace slib
 		log(tag, content);
 	}
 
+	static String _priv_Log_getLineString(const Time& time, const String& tag, const String& content)
+	{
+		return String::format("%s [%s] %s", time, tag, content);
+	}
+
 	static String _priv_Log_getLineString(const String& tag, const String& content)
 	{
-		return String::format("%s [%s] %s", Time::now(), tag, content);
+		return _priv_Log_getLineString(Time::now(), tag, content);
 	}
 
 	FileLogger::FileLogger()
@@ -85,6 +95,320 @@ namespace slib
 		}
 	}
 	
+
+	AsyncFileLoggerParam::AsyncFileLoggerParam()
+	{
+		bufferSize = 8192;
+		overflowPolicy = LogOverflowPolicy::Drop;
+		flushInterval = 500;
+		
+		maxFileSize = 0;
+		rotationInterval = 0;
+		maxBackupFilesCount = 5;
+	}
+
+	AsyncFileLoggerParam::~AsyncFileLoggerParam()
+	{
+	}
+
+	// bounded multi-producer single-consumer ring
+	class _priv_AsyncFileLogger_Queue
+	{
+	public:
+		struct Cell
+		{
+			std::atomic<sl_size> sequence;
+			Time time;
+			String tag;
+			String content;
+		};
+		
+		Cell* cells;
+		sl_size mask;
+		std::atomic<sl_size> posEnqueue;
+		std::atomic<sl_size> posDequeue;
+		std::atomic<sl_uint64> nDropped;
+		
+	public:
+		_priv_AsyncFileLogger_Queue(sl_size size): posEnqueue(0), posDequeue(0), nDropped(0)
+		{
+			sl_size capacity = 2;
+			while (capacity < size) {
+				capacity <<= 1;
+			}
+			cells = new Cell[capacity];
+			mask = capacity - 1;
+			for (sl_size i = 0; i < capacity; i++) {
+				cells[i].sequence.store(i, std::memory_order_relaxed);
+			}
+		}
+		
+		~_priv_AsyncFileLogger_Queue()
+		{
+			delete[] cells;
+		}
+		
+	public:
+		sl_bool push(const Time& time, const String& tag, const String& content)
+		{
+			sl_size pos = posEnqueue.load(std::memory_order_relaxed);
+			Cell* cell;
+			for (;;) {
+				cell = cells + (pos & mask);
+				sl_size seq = cell->sequence.load(std::memory_order_acquire);
+				sl_reg diff = (sl_reg)seq - (sl_reg)pos;
+				if (diff == 0) {
+					if (posEnqueue.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+						break;
+					}
+				} else if (diff < 0) {
+					return sl_false;
+				} else {
+					pos = posEnqueue.load(std::memory_order_relaxed);
+				}
+			}
+			cell->time = time;
+			cell->tag = tag;
+			cell->content = content;
+			cell->sequence.store(pos + 1, std::memory_order_release);
+			return sl_true;
+		}
+		
+		// called only by the flusher thread
+		sl_bool pop(Time& time, String& tag, String& content)
+		{
+			sl_size pos = posDequeue.load(std::memory_order_relaxed);
+			Cell* cell = cells + (pos & mask);
+			if (cell->sequence.load(std::memory_order_acquire) != pos + 1) {
+				return sl_false;
+			}
+			time = cell->time;
+			tag = Move(cell->tag);
+			content = Move(cell->content);
+			cell->sequence.store(pos + mask + 1, std::memory_order_release);
+			posDequeue.store(pos + 1, std::memory_order_release);
+			return sl_true;
+		}
+		
+		sl_size getPendingCount()
+		{
+			return posEnqueue.load(std::memory_order_relaxed) - posDequeue.load(std::memory_order_relaxed);
+		}
+		
+	};
+
+	SLIB_DEFINE_OBJECT(AsyncFileLogger, Logger)
+
+	AsyncFileLogger::AsyncFileLogger()
+	{
+		m_queue = sl_null;
+		m_sizeFile = 0;
+		m_timeFileOpened = 0;
+	}
+
+	AsyncFileLogger::~AsyncFileLogger()
+	{
+		release();
+		if (m_queue) {
+			delete m_queue;
+		}
+	}
+
+	Ref<AsyncFileLogger> AsyncFileLogger::create(const AsyncFileLoggerParam& param)
+	{
+		if (param.fileName.isEmpty()) {
+			return sl_null;
+		}
+		Ref<AsyncFileLogger> ret = new AsyncFileLogger;
+		if (ret.isNotNull()) {
+			ret->m_param = param;
+			if (ret->m_param.bufferSize < 2) {
+				ret->m_param.bufferSize = 2;
+			}
+			ret->m_queue = new _priv_AsyncFileLogger_Queue(ret->m_param.bufferSize);
+			if (ret->m_queue) {
+				ret->m_thread = Thread::start(SLIB_FUNCTION_CLASS(AsyncFileLogger, _run, ret.get()));
+				if (ret->m_thread.isNotNull()) {
+					return ret;
+				}
+			}
+		}
+		return sl_null;
+	}
+
+	void AsyncFileLogger::log(const String& tag, const String& content)
+	{
+		_priv_AsyncFileLogger_Queue* queue = m_queue;
+		Time now = Time::now();
+		if (queue->push(now, tag, content)) {
+			if (!(m_thread->isRunning())) {
+				// released: writes by the caller
+				ObjectLocker lock(this);
+				_writeQueue();
+				return;
+			}
+			// wakes the flusher early only when the buffer is getting full
+			if (queue->getPendingCount() > (queue->mask >> 1)) {
+				m_thread->wakeSelfEvent();
+			}
+			return;
+		}
+		if (m_param.overflowPolicy == LogOverflowPolicy::Block) {
+			sl_uint32 count = 0;
+			while (m_thread->isRunning()) {
+				m_thread->wakeSelfEvent();
+				System::yield(count);
+				count++;
+				if (queue->push(now, tag, content)) {
+					return;
+				}
+			}
+		}
+		if (!(m_thread->isRunning())) {
+			ObjectLocker lock(this);
+			_writeQueue();
+			if (queue->push(now, tag, content)) {
+				_writeQueue();
+				return;
+			}
+		}
+		queue->nDropped++;
+	}
+
+	void AsyncFileLogger::flush()
+	{
+		_priv_AsyncFileLogger_Queue* queue = m_queue;
+		sl_size target = queue->posEnqueue.load(std::memory_order_relaxed);
+		while ((sl_reg)(target - queue->posDequeue.load(std::memory_order_acquire)) > 0) {
+			if (!(m_thread->isRunning())) {
+				return;
+			}
+			m_thread->wakeSelfEvent();
+			Thread::sleep(1);
+		}
+		// the last batch may be still in writing
+		ObjectLocker lock(this);
+	}
+
+	void AsyncFileLogger::release()
+	{
+		Ref<Thread> thread = m_thread;
+		if (thread.isNotNull()) {
+			thread->finishAndWait();
+		}
+		if (m_queue) {
+			// the lines pushed while the flusher was exiting
+			ObjectLocker lock(this);
+			_writeQueue();
+			m_file.setNull();
+		}
+	}
+
+	sl_uint64 AsyncFileLogger::getDroppedLinesCount()
+	{
+		return m_queue->nDropped.load(std::memory_order_relaxed);
+	}
+
+	void AsyncFileLogger::_run()
+	{
+		for (;;) {
+			sl_bool flagStopping = Thread::isStoppingCurrent();
+			{
+				ObjectLocker lock(this);
+				_writeQueue();
+			}
+			if (flagStopping) {
+				break;
+			}
+			Thread::getCurrent()->wait(m_param.flushInterval);
+		}
+		ObjectLocker lock(this);
+		m_file.setNull();
+	}
+
+	void AsyncFileLogger::_writeQueue()
+	{
+		_priv_AsyncFileLogger_Queue* queue = m_queue;
+		Time time;
+		String tag;
+		String content;
+		StringBuffer buf;
+		sl_size n = 0;
+		while (queue->pop(time, tag, content)) {
+			buf.add(_priv_Log_getLineString(time, tag, content));
+			SLIB_STATIC_STRING(lineEnd, "\r\n")
+			buf.addStatic(lineEnd.getData(), lineEnd.getLength());
+			n++;
+			// writes large bursts in several batches
+			if (n >= 1024) {
+				_write(buf.merge());
+				buf.clear();
+				n = 0;
+			}
+		}
+		if (n) {
+			_write(buf.merge());
+		}
+	}
+
+	sl_bool AsyncFileLogger::_openFile()
+	{
+		m_file = File::openForAppend(m_param.fileName);
+		if (m_file.isNotNull()) {
+			m_sizeFile = m_file->getSize();
+			m_timeFileOpened = Time::now().toInt() / 1000000;
+			return sl_true;
+		}
+		return sl_false;
+	}
+
+	void AsyncFileLogger::_rotate()
+	{
+		m_file.setNull();
+		String& fileName = m_param.fileName;
+		sl_uint32 nBackups = m_param.maxBackupFilesCount;
+		if (nBackups) {
+			File::deleteFile(fileName + "." + String::fromUint32(nBackups));
+			for (sl_uint32 i = nBackups - 1; i > 0; i--) {
+				String pathOld = fileName + "." + String::fromUint32(i);
+				if (File::exists(pathOld)) {
+					File::rename(pathOld, fileName + "." + String::fromUint32(i + 1));
+				}
+			}
+			File::rename(fileName, fileName + ".1");
+		} else {
+			File::deleteFile(fileName);
+		}
+		_openFile();
+	}
+
+	void AsyncFileLogger::_write(const String& text)
+	{
+		sl_size len = text.getLength();
+		if (!len) {
+			return;
+		}
+		if (m_file.isNull()) {
+			if (!(_openFile())) {
+				return;
+			}
+		}
+		if (m_sizeFile) {
+			if (m_param.maxFileSize && m_sizeFile + len > m_param.maxFileSize) {
+				_rotate();
+			} else if (m_param.rotationInterval && (sl_uint64)(Time::now().toInt() / 1000000) >= m_timeFileOpened + m_param.rotationInterval) {
+				_rotate();
+			}
+			if (m_file.isNull()) {
+				return;
+			}
+		}
+		sl_reg n = m_file->writeFully(text.getData(), len);
+		if (n > 0) {
+			m_sizeFile += n;
+		}
+	}
+
 	class ConsoleLogger : public Logger
 	{
 	public:
@@ -214,6 +538,13 @@ namespace slib
 		return new FileLogger(fileName);
 	}
 
+	Ref<Logger> Logger::createAsyncFileLogger(const String& fileName)
+	{
+		AsyncFileLoggerParam param;
+		param.fileName = fileName;
+		return AsyncFileLogger::create(param);
+	}
+
 	void Logger::logGlobal(const String& tag, const String& content)
 	{
 		Ref<LoggerSet> log = global();
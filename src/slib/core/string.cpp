@@ -900,10 +900,10 @@ namespace slib
 	SLIB_INLINE StringContainer* Atomic<String>::_retainContainer() const noexcept
 	{
 		if (m_container) {
-			SpinLocker lock(&m_lock);
-			StringContainer* container = m_container;
+			StringContainer* container = (StringContainer*)(_priv_HazardPointer::protect((void* const volatile*)((void*)&m_container)));
 			if (container) {
 				container->increaseReference();
+				_priv_HazardPointer::release();
 			}
 			return container;
 		}
@@ -913,10 +913,10 @@ namespace slib
 	SLIB_INLINE StringContainer16* Atomic<String16>::_retainContainer() const noexcept
 	{
 		if (m_container) {
-			SpinLocker lock(&m_lock);
-			StringContainer16* container = m_container;
+			StringContainer16* container = (StringContainer16*)(_priv_HazardPointer::protect((void* const volatile*)((void*)&m_container)));
 			if (container) {
 				container->increaseReference();
+				_priv_HazardPointer::release();
 			}
 			return container;
 		}
@@ -940,29 +940,29 @@ namespace slib
 		m_container = container;
 	}
 
+	static void _priv_AtomicString_release(void* container) noexcept
+	{
+		((StringContainer*)container)->decreaseReference();
+	}
+
+	static void _priv_AtomicString16_release(void* container) noexcept
+	{
+		((StringContainer16*)container)->decreaseReference();
+	}
+
 	SLIB_INLINE void Atomic<String>::_replaceContainer(StringContainer* container) noexcept
 	{
-		StringContainer* before;
-		{
-			SpinLocker lock(&m_lock);
-			before = m_container;
-			m_container = container;
-		}
+		StringContainer* before = (StringContainer*)(_priv_HazardPointer::exchange((void* volatile*)((void*)&m_container), container));
 		if (before) {
-			before->decreaseReference();
+			_priv_HazardPointer::retire(before, &_priv_AtomicString_release);
 		}
 	}
 
 	SLIB_INLINE void Atomic<String16>::_replaceContainer(StringContainer16* container) noexcept
 	{
-		StringContainer16* before;
-		{
-			SpinLocker lock(&m_lock);
-			before = m_container;
-			m_container = container;
-		}
+		StringContainer16* before = (StringContainer16*)(_priv_HazardPointer::exchange((void* volatile*)((void*)&m_container), container));
 		if (before) {
-			before->decreaseReference();
+			_priv_HazardPointer::retire(before, &_priv_AtomicString16_release);
 		}
 	}
 
@@ -1836,13 +1836,7 @@ namespace slib
 	template <class CT>
 	SLIB_INLINE static sl_size _priv_String_calcHash(const CT* buf, sl_size len) noexcept
 	{
-		sl_size hash = 0;
-		for (sl_size i = 0; i < len; i++) {
-			sl_uint32 ch = buf[i];
-			hash = hash * 31 + ch;
-		}
-		hash = Rehash(hash);
-		return hash;
+		return HashBytes(buf, len * sizeof(CT));
 	}
 	
 	sl_size String::getHashCode() const noexcept
@@ -1905,17 +1899,56 @@ namespace slib
 	}
 
 
+#define PRIV_STRING_HASH_IGNORE_CASE_BLOCK 64
+
 	template <class CT>
-	SLIB_INLINE static sl_size _priv_String_calcHashIgnoreCase(const CT* buf, sl_size len) noexcept
+	SLIB_INLINE static void _priv_String_copyUpperCase(CT* dst, const CT* src, sl_size n) noexcept
 	{
-		sl_size hash = 0;
-		for (sl_size i = 0; i < len; i++) {
-			sl_uint32 ch = buf[i];
-			ch = SLIB_CHAR_LOWER_TO_UPPER(ch);
-			hash = hash * 31 + ch;
+		for (sl_size i = 0; i < n; i++) {
+			CT ch = src[i];
+			dst[i] = (CT)(SLIB_CHAR_LOWER_TO_UPPER(ch));
 		}
-		hash = Rehash(hash);
-		return hash;
+	}
+
+	SLIB_INLINE static void _priv_String_copyUpperCase(sl_char8* dst, const sl_char8* src, sl_size n) noexcept
+	{
+		sl_size i = 0;
+		for (; i + 8 <= n; i += 8) {
+			// sets the high bit of each byte in 'a'~'z', and subtracts 0x20 from those bytes
+			sl_uint64 x = MIO::readUint64LE(src + i);
+			sl_uint64 low = x & SLIB_UINT64(0x7F7F7F7F7F7F7F7F);
+			sl_uint64 fromA = low + SLIB_UINT64(0x1F1F1F1F1F1F1F1F);
+			sl_uint64 overZ = low + SLIB_UINT64(0x0505050505050505);
+			sl_uint64 mask = fromA & ~overZ & ~x & SLIB_UINT64(0x8080808080808080);
+			MIO::writeUint64LE(dst + i, x - (mask >> 2));
+		}
+		for (; i < n; i++) {
+			sl_char8 ch = src[i];
+			dst[i] = (sl_char8)(SLIB_CHAR_LOWER_TO_UPPER(ch));
+		}
+	}
+
+	template <class CT>
+	static sl_size _priv_String_calcHashIgnoreCase(const CT* buf, sl_size len) noexcept
+	{
+		// hashes the upper-cased blocks, chaining the hash as the seed of the next block
+		CT upper[PRIV_STRING_HASH_IGNORE_CASE_BLOCK];
+		sl_uint64 hash = GetHashSeed();
+		do {
+			sl_size n = len;
+			if (n > PRIV_STRING_HASH_IGNORE_CASE_BLOCK) {
+				n = PRIV_STRING_HASH_IGNORE_CASE_BLOCK;
+			}
+			_priv_String_copyUpperCase(upper, buf, n);
+			hash = HashBytes64(upper, n * sizeof(CT), hash);
+			buf += n;
+			len -= n;
+		} while (len);
+#ifdef SLIB_ARCH_IS_64BIT
+		return (sl_size)hash;
+#else
+		return (sl_size)(hash ^ (hash >> 32));
+#endif
 	}
 	
 	sl_size String::getHashCodeIgnoreCase() const noexcept
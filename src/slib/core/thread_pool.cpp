@@ -10,20 +10,373 @@
 
 #include "slib/core/thread_pool.h"
 
+#include "slib/core/system.h"
+#include "slib/core/time.h"
+
+#include <atomic>
+
+// must be power of 2
+#define PRIV_STEALING_DEQUE_SIZE 4096
+// milliseconds per slot is 1, must be power of 2
+#define PRIV_TIMER_WHEEL_SIZE 512
+#define PRIV_CACHE_LINE_SIZE 64
+
 namespace slib
 {
 
+	SLIB_THREAD ThreadPool* _gt_threadPoolCurrent = sl_null;
+	SLIB_THREAD sl_uint32 _gt_threadPoolWorkerIndex = 0;
+
+	// Chase-Lev deque: only the owner worker pushes and pops at the bottom, the other workers steal from the top
+	class _priv_ThreadPool_Deque
+	{
+	public:
+		std::atomic<sl_int64> top;
+		char _padding1[PRIV_CACHE_LINE_SIZE - sizeof(sl_int64)];
+		std::atomic<sl_int64> bottom;
+		char _padding2[PRIV_CACHE_LINE_SIZE - sizeof(sl_int64)];
+		std::atomic< Callable<void()>* > items[PRIV_STEALING_DEQUE_SIZE];
+
+	public:
+		_priv_ThreadPool_Deque(): top(0), bottom(0)
+		{
+		}
+
+		~_priv_ThreadPool_Deque()
+		{
+			Callable<void()>* callable;
+			while ((callable = pop())) {
+				callable->decreaseReference();
+			}
+		}
+
+	public:
+		// the reference of `callable` is transferred to the deque
+		sl_bool push(Callable<void()>* callable)
+		{
+			sl_int64 b = bottom.load(std::memory_order_relaxed);
+			sl_int64 t = top.load(std::memory_order_acquire);
+			if (b - t >= PRIV_STEALING_DEQUE_SIZE) {
+				return sl_false;
+			}
+			items[b & (PRIV_STEALING_DEQUE_SIZE - 1)].store(callable, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_release);
+			bottom.store(b + 1, std::memory_order_relaxed);
+			return sl_true;
+		}
+
+		Callable<void()>* pop()
+		{
+			sl_int64 b = bottom.load(std::memory_order_relaxed) - 1;
+			bottom.store(b, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			sl_int64 t = top.load(std::memory_order_relaxed);
+			if (t <= b) {
+				Callable<void()>* callable = items[b & (PRIV_STEALING_DEQUE_SIZE - 1)].load(std::memory_order_relaxed);
+				if (t == b) {
+					// last item: race against the thieves
+					if (!(top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))) {
+						callable = sl_null;
+					}
+					bottom.store(b + 1, std::memory_order_relaxed);
+				}
+				return callable;
+			} else {
+				bottom.store(b + 1, std::memory_order_relaxed);
+				return sl_null;
+			}
+		}
+
+		Callable<void()>* steal()
+		{
+			sl_int64 t = top.load(std::memory_order_acquire);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			sl_int64 b = bottom.load(std::memory_order_acquire);
+			if (t < b) {
+				Callable<void()>* callable = items[t & (PRIV_STEALING_DEQUE_SIZE - 1)].load(std::memory_order_relaxed);
+				if (top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+					return callable;
+				}
+			}
+			return sl_null;
+		}
+
+	};
+
+	class _priv_ThreadPool_Worker
+	{
+	public:
+		_priv_ThreadPool_Deque deque;
+		// tasks added from the threads out of this pool
+		LinkedQueue< Function<void()> > inbox;
+		// count of the tasks in `inbox`, updated in the lock of `inbox`. read without the lock as a hint
+		std::atomic<sl_size> nInbox;
+		Ref<Thread> thread;
+		std::atomic<sl_bool> flagSleeping;
+		char _padding[PRIV_CACHE_LINE_SIZE];
+
+	public:
+		_priv_ThreadPool_Worker(): nInbox(0), flagSleeping(sl_false)
+		{
+		}
+
+	};
+
+	class _priv_ThreadPool_StealingContext
+	{
+	public:
+		_priv_ThreadPool_Worker* workers;
+		sl_uint32 nWorkers;
+		std::atomic<sl_uint32> indexInbox;
+		std::atomic<sl_uint32> indexWake;
+		std::atomic<sl_int32> nSleeping;
+
+	public:
+		_priv_ThreadPool_StealingContext(sl_uint32 n): indexInbox(0), indexWake(0), nSleeping(0)
+		{
+			workers = new _priv_ThreadPool_Worker[n];
+			nWorkers = n;
+		}
+
+		~_priv_ThreadPool_StealingContext()
+		{
+			delete[] workers;
+		}
+
+	public:
+		sl_bool popTask(sl_uint32 index, Function<void()>* _out)
+		{
+			_priv_ThreadPool_Worker& worker = workers[index];
+			Callable<void()>* callable = worker.deque.pop();
+			if (callable) {
+				*_out = callable;
+				callable->decreaseReference();
+				return sl_true;
+			}
+			if (popInbox(worker, _out)) {
+				return sl_true;
+			}
+			for (sl_uint32 k = 1; k < nWorkers; k++) {
+				_priv_ThreadPool_Worker& victim = workers[(index + k) % nWorkers];
+				callable = victim.deque.steal();
+				if (callable) {
+					*_out = callable;
+					callable->decreaseReference();
+					return sl_true;
+				}
+				if (popInbox(victim, _out)) {
+					return sl_true;
+				}
+			}
+			return sl_false;
+		}
+
+		static sl_bool popInbox(_priv_ThreadPool_Worker& worker, Function<void()>* _out)
+		{
+			if (!(worker.nInbox.load(std::memory_order_relaxed))) {
+				return sl_false;
+			}
+			ObjectLocker lock(&(worker.inbox));
+			if (worker.inbox.pop_NoLock(_out)) {
+				worker.nInbox.fetch_sub(1, std::memory_order_relaxed);
+				return sl_true;
+			}
+			return sl_false;
+		}
+
+		void wake(sl_size count)
+		{
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			if (nSleeping.load(std::memory_order_relaxed) <= 0) {
+				return;
+			}
+			sl_uint32 start = indexWake.fetch_add(1, std::memory_order_relaxed);
+			for (sl_uint32 k = 0; k < nWorkers && count > 0; k++) {
+				_priv_ThreadPool_Worker& worker = workers[(start + k) % nWorkers];
+				sl_bool flagExpected = sl_true;
+				if (worker.flagSleeping.compare_exchange_strong(flagExpected, sl_false)) {
+					nSleeping--;
+					worker.thread->wakeSelfEvent();
+					count--;
+				}
+			}
+		}
+
+		// returns sl_true when the flag was set by this worker, not by a waker
+		sl_bool clearSleeping(sl_uint32 index)
+		{
+			sl_bool flagExpected = sl_true;
+			if (workers[index].flagSleeping.compare_exchange_strong(flagExpected, sl_false)) {
+				nSleeping--;
+				return sl_true;
+			}
+			return sl_false;
+		}
+
+	};
+
+	// hashed timing wheel for the delayed tasks, slots are advanced by the elapsed milliseconds
+	class _priv_ThreadPool_TimerWheel
+	{
+	public:
+		struct Task
+		{
+			sl_uint64 time;
+			Function<void()> callback;
+			Task* next;
+		};
+
+		ThreadPool* pool;
+		Ref<Thread> thread;
+		TimeCounter timeCounter;
+		Mutex lock;
+		Task* slots[PRIV_TIMER_WHEEL_SIZE];
+		sl_size nTasks;
+		sl_uint64 tickNext;
+		sl_uint64 timeWake;
+
+	public:
+		_priv_ThreadPool_TimerWheel(ThreadPool* _pool)
+		{
+			pool = _pool;
+			Base::zeroMemory(slots, sizeof(slots));
+			nTasks = 0;
+			tickNext = 0;
+			timeWake = SLIB_UINT64_MAX;
+		}
+
+		~_priv_ThreadPool_TimerWheel()
+		{
+			for (sl_size i = 0; i < PRIV_TIMER_WHEEL_SIZE; i++) {
+				Task* task = slots[i];
+				while (task) {
+					Task* next = task->next;
+					delete task;
+					task = next;
+				}
+			}
+		}
+
+	public:
+		sl_bool add(const Function<void()>& callback, sl_uint64 delay_ms)
+		{
+			MutexLocker locker(&lock);
+			if (thread.isNull()) {
+				thread = Thread::create(SLIB_FUNCTION_CLASS(_priv_ThreadPool_TimerWheel, run, this));
+				if (thread.isNull()) {
+					return sl_false;
+				}
+				if (!(thread->start())) {
+					thread.setNull();
+					return sl_false;
+				}
+			}
+			Task* task = new Task;
+			if (!task) {
+				return sl_false;
+			}
+			task->time = timeCounter.getElapsedMilliseconds() + delay_ms;
+			task->callback = callback;
+			Task*& slot = slots[task->time & (PRIV_TIMER_WHEEL_SIZE - 1)];
+			task->next = slot;
+			slot = task;
+			nTasks++;
+			if (task->time < timeWake) {
+				timeWake = task->time;
+				thread->wakeSelfEvent();
+			}
+			return sl_true;
+		}
+
+		void release()
+		{
+			MutexLocker locker(&lock);
+			Ref<Thread> t = thread;
+			locker.unlock();
+			if (t.isNotNull()) {
+				t->finishAndWait();
+			}
+		}
+
+		void run()
+		{
+			Ref<Thread> current = Thread::getCurrent();
+			if (current.isNull()) {
+				return;
+			}
+			while (current->isNotStopping()) {
+				LinkedQueue< Function<void()> > expired;
+				sl_int32 timeout = -1;
+				{
+					MutexLocker locker(&lock);
+					sl_uint64 now = timeCounter.getElapsedMilliseconds();
+					if (now + 1 - tickNext >= PRIV_TIMER_WHEEL_SIZE) {
+						for (sl_size i = 0; i < PRIV_TIMER_WHEEL_SIZE; i++) {
+							_processSlot(slots[i], now, expired);
+						}
+					} else {
+						for (sl_uint64 tick = tickNext; tick <= now; tick++) {
+							_processSlot(slots[tick & (PRIV_TIMER_WHEEL_SIZE - 1)], now, expired);
+						}
+					}
+					tickNext = now + 1;
+					timeWake = SLIB_UINT64_MAX;
+					if (nTasks) {
+						for (sl_uint64 tick = tickNext; tick < tickNext + PRIV_TIMER_WHEEL_SIZE; tick++) {
+							if (slots[tick & (PRIV_TIMER_WHEEL_SIZE - 1)]) {
+								timeWake = tick;
+								break;
+							}
+						}
+						timeout = (sl_int32)(timeWake - now);
+					}
+				}
+				Function<void()> callback;
+				while (expired.pop_NoLock(&callback)) {
+					pool->addTask(callback);
+				}
+				current->wait(timeout);
+			}
+		}
+
+	private:
+		void _processSlot(Task*& slot, sl_uint64 now, LinkedQueue< Function<void()> >& expired)
+		{
+			Task** link = &slot;
+			while (Task* task = *link) {
+				if (task->time <= now) {
+					expired.push_NoLock(task->callback);
+					*link = task->next;
+					delete task;
+					nTasks--;
+				} else {
+					link = &(task->next);
+				}
+			}
+		}
+
+	};
+
+
 	SLIB_DEFINE_OBJECT(ThreadPool, Dispatcher)
 
 	ThreadPool::ThreadPool()
 	{
 		setThreadStackSize(SLIB_THREAD_DEFAULT_STACK_SIZE);
 		m_flagRunning = sl_true;
+		m_stealing = sl_null;
+		m_timerWheel = sl_null;
 	}
 
 	ThreadPool::~ThreadPool()
 	{
 		release();
+		if (m_timerWheel) {
+			delete m_timerWheel;
+		}
+		if (m_stealing) {
+			delete m_stealing;
+		}
 	}
 
 	Ref<ThreadPool> ThreadPool::create(sl_uint32 minThreads, sl_uint32 maxThreads)
@@ -36,6 +389,40 @@ namespace slib
 		return ret;
 	}
 
+	Ref<ThreadPool> ThreadPool::createWorkStealing(sl_uint32 nThreads)
+	{
+		if (nThreads == 0) {
+			nThreads = System::getProcessorsCount();
+		}
+		Ref<ThreadPool> ret = new ThreadPool();
+		if (ret.isNull()) {
+			return sl_null;
+		}
+		ret->setMinimumThreadsCount(nThreads);
+		ret->setMaximumThreadsCount(nThreads);
+		_priv_ThreadPool_StealingContext* stealing = new _priv_ThreadPool_StealingContext(nThreads);
+		if (!stealing) {
+			return sl_null;
+		}
+		ret->m_stealing = stealing;
+		sl_uint32 i;
+		for (i = 0; i < nThreads; i++) {
+			Ref<Thread> thread = Thread::create(SLIB_BIND_CLASS(void(), ThreadPool, onRunStealingWorker, ret.get(), i));
+			if (thread.isNull()) {
+				return sl_null;
+			}
+			stealing->workers[i].thread = thread;
+			ret->m_threadWorkers.add_NoLock(thread);
+		}
+		for (i = 0; i < nThreads; i++) {
+			if (!(stealing->workers[i].thread->start(ret->getThreadStackSize()))) {
+				ret->release();
+				return sl_null;
+			}
+		}
+		return ret;
+	}
+
 	void ThreadPool::release()
 	{
 		ObjectLocker lock(this);
@@ -43,8 +430,15 @@ namespace slib
 			return;
 		}
 		m_flagRunning = sl_false;
-		
-		ListElements< Ref<Thread> > threads(m_threadWorkers);
+
+		List< Ref<Thread> > list(m_threadWorkers.duplicate_NoLock());
+		_priv_ThreadPool_TimerWheel* timerWheel = m_timerWheel;
+		lock.unlock();
+		ListElements< Ref<Thread> > threads(list);
+
+		if (timerWheel) {
+			timerWheel->release();
+		}
 		sl_size i;
 		for (i = 0; i < threads.count; i++) {
 			threads[i]->finish();
@@ -59,6 +453,11 @@ namespace slib
 		return m_flagRunning;
 	}
 
+	sl_bool ThreadPool::isWorkStealing()
+	{
+		return m_stealing != sl_null;
+	}
+
 	sl_uint32 ThreadPool::getThreadsCount()
 	{
 		return (sl_uint32)(m_threadWorkers.getCount());
@@ -69,7 +468,40 @@ namespace slib
 		if (task.isNull()) {
 			return sl_false;
 		}
+		if (m_stealing) {
+			return _addTasksStealing(&task, 1);
+		}
+		ObjectLocker lock(this);
+		return _addTask_NoLock(task);
+	}
+
+	sl_bool ThreadPool::addTasks(const Function<void()>* tasks, sl_size count)
+	{
+		if (!count) {
+			return sl_true;
+		}
+		if (m_stealing) {
+			return _addTasksStealing(tasks, count);
+		}
 		ObjectLocker lock(this);
+		for (sl_size i = 0; i < count; i++) {
+			if (tasks[i].isNotNull()) {
+				if (!(_addTask_NoLock(tasks[i]))) {
+					return sl_false;
+				}
+			}
+		}
+		return sl_true;
+	}
+
+	sl_bool ThreadPool::addTasks(const List< Function<void()> >& tasks)
+	{
+		ListLocker< Function<void()> > list(tasks);
+		return addTasks(list.data, list.count);
+	}
+
+	sl_bool ThreadPool::_addTask_NoLock(const Function<void()>& task)
+	{
 		if (!m_flagRunning) {
 			return sl_false;
 		}
@@ -100,9 +532,79 @@ namespace slib
 		return sl_true;
 	}
 
+	sl_bool ThreadPool::_addTasksStealing(const Function<void()>* tasks, sl_size count)
+	{
+		if (!m_flagRunning) {
+			return sl_false;
+		}
+		_priv_ThreadPool_StealingContext* stealing = m_stealing;
+		sl_size nAdded = 0;
+		sl_size i = 0;
+		if (_gt_threadPoolCurrent == this) {
+			// added from the worker: push to its local deque
+			_priv_ThreadPool_Deque& deque = stealing->workers[_gt_threadPoolWorkerIndex].deque;
+			for (; i < count; i++) {
+				Callable<void()>* callable = tasks[i].ref.get();
+				if (callable) {
+					callable->increaseReference();
+					if (!(deque.push(callable))) {
+						callable->decreaseReference();
+						break;
+					}
+					nAdded++;
+				}
+			}
+		}
+		if (i < count) {
+			sl_uint32 index;
+			if (_gt_threadPoolCurrent == this) {
+				index = _gt_threadPoolWorkerIndex;
+			} else {
+				index = stealing->indexInbox.fetch_add(1, std::memory_order_relaxed) % stealing->nWorkers;
+			}
+			_priv_ThreadPool_Worker& worker = stealing->workers[index];
+			ObjectLocker lock(&(worker.inbox));
+			sl_size nPushed = 0;
+			for (; i < count; i++) {
+				if (tasks[i].isNotNull()) {
+					if (!(worker.inbox.push_NoLock(tasks[i]))) {
+						break;
+					}
+					nPushed++;
+				}
+			}
+			worker.nInbox.fetch_add(nPushed, std::memory_order_relaxed);
+			nAdded += nPushed;
+		}
+		if (nAdded) {
+			stealing->wake(nAdded);
+		}
+		return i == count;
+	}
+
 	sl_bool ThreadPool::dispatch(const Function<void()>& callback, sl_uint64 delay_ms)
 	{
-		return addTask(callback);
+		if (delay_ms == 0) {
+			return addTask(callback);
+		}
+		if (callback.isNull()) {
+			return sl_false;
+		}
+		ObjectLocker lock(this);
+		if (!m_flagRunning) {
+			return sl_false;
+		}
+		// created by the first delayed task
+		_priv_ThreadPool_TimerWheel* timerWheel = m_timerWheel;
+		if (!timerWheel) {
+			timerWheel = new _priv_ThreadPool_TimerWheel(this);
+			if (!timerWheel) {
+				return sl_false;
+			}
+			m_timerWheel = timerWheel;
+		}
+		lock.unlock();
+		return timerWheel->add(callback, delay_ms);
 	}
 
 	void ThreadPool::onRunWorker()
@@ -117,6 +619,12 @@ namespace slib
 				task();
 			} else {
 				ObjectLocker lock(this);
+				// the tasks are added in the lock: checks again not to miss the task added after the first check
+				if (m_tasks.pop(&task)) {
+					lock.unlock();
+					task();
+					continue;
+				}
 				sl_size nThreads = m_threadWorkers.getCount();
 				if (nThreads > getMinimumThreadsCount()) {
 					m_threadWorkers.remove_NoLock(thread);
@@ -130,4 +638,34 @@ namespace slib
 		}
 	}
 
+	void ThreadPool::onRunStealingWorker(sl_uint32 index)
+	{
+		Ref<Thread> thread = Thread::getCurrent();
+		if (thread.isNull()) {
+			return;
+		}
+		_gt_threadPoolCurrent = this;
+		_gt_threadPoolWorkerIndex = index;
+		_priv_ThreadPool_StealingContext* stealing = m_stealing;
+		_priv_ThreadPool_Worker& worker = stealing->workers[index];
+		while (m_flagRunning && thread->isNotStopping()) {
+			Function<void()> task;
+			if (stealing->popTask(index, &task)) {
+				task();
+				continue;
+			}
+			// announce sleeping, and check again not to miss the tasks added meanwhile
+			stealing->nSleeping++;
+			worker.flagSleeping.store(sl_true);
+			if (stealing->popTask(index, &task)) {
+				stealing->clearSleeping(index);
+				task();
+				continue;
+			}
+			thread->wait();
+			stealing->clearSleeping(index);
+		}
+		_gt_threadPoolCurrent = sl_null;
+	}
+
 }
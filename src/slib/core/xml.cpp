@@ -11,6 +11,9 @@
 #include "slib/core/xml.h"
 
 #include "slib/core/file.h"
+#include "slib/core/io.h"
+#include "slib/core/async.h"
+#include "slib/core/charset.h"
 #include "slib/core/log.h"
 #include "slib/core/string_buffer.h"
 
@@ -2551,4 +2554,912 @@ namespace slib
 		return checkName(tagName.getData(), tagName.getLength());
 	}
 
+
+	SLIB_STATIC_STRING(_g_xml_error_msg_token_too_long, "Token is longer than the limit of XmlReader")
+	SLIB_STATIC_STRING(_g_xml_error_msg_reader_missing, "Reader is not available")
+
+#define PRIV_XML_READER_DEFAULT_CHUNK_SIZE 0x10000
+#define PRIV_XML_READER_DEFAULT_MAX_TOKEN_SIZE 0x1000000
+
+	sl_bool XmlReaderString::isEmpty() const
+	{
+		return !length;
+	}
+
+	sl_bool XmlReaderString::equals(const sl_char8* str, sl_size len) const
+	{
+		return length == len && Base::equalsMemory(data, str, len);
+	}
+
+	sl_bool XmlReaderString::equals(const String& str) const
+	{
+		return equals(str.getData(), str.getLength());
+	}
+
+	String XmlReaderString::toString() const
+	{
+		return String(data, length);
+	}
+
+
+	XmlReaderParam::XmlReaderParam()
+	{
+		chunkSize = PRIV_XML_READER_DEFAULT_CHUNK_SIZE;
+		maxTokenSize = PRIV_XML_READER_DEFAULT_MAX_TOKEN_SIZE;
+		flagLogError = sl_true;
+	}
+
+	XmlReaderParam::~XmlReaderParam()
+	{
+	}
+
+
+	SLIB_DEFINE_OBJECT(XmlReader, Object)
+
+	XmlReader::XmlReader()
+	{
+		m_chunkSize = PRIV_XML_READER_DEFAULT_CHUNK_SIZE;
+		m_maxTokenSize = PRIV_XML_READER_DEFAULT_MAX_TOKEN_SIZE;
+		m_flagLogError = sl_true;
+
+		m_buf = sl_null;
+		m_sizeBuffer = 0;
+		m_pos = 0;
+		m_end = 0;
+		m_flagEndOfInput = sl_false;
+		m_offsetBuffer = 0;
+		m_sizeScanned = 0;
+
+		m_sizeStackNames = 0;
+		m_depth = 0;
+		m_flagPendingEndElement = sl_false;
+
+		m_event = XmlReaderEvent::NeedMoreData;
+		m_positionEvent = 0;
+		m_name.data = sl_null;
+		m_name.length = 0;
+		m_text.data = sl_null;
+		m_text.length = 0;
+		m_flagEmptyElement = sl_false;
+		m_nAttributes = 0;
+
+		m_errorPosition = 0;
+	}
+
+	XmlReader::~XmlReader()
+	{
+	}
+
+	Ref<XmlReader> XmlReader::create(const Ptr<IReader>& reader, const XmlReaderParam& param)
+	{
+		if (reader.isNull()) {
+			return sl_null;
+		}
+		Ref<XmlReader> ret = create(param);
+		if (ret.isNotNull()) {
+			ret->m_reader = reader;
+		}
+		return ret;
+	}
+
+	Ref<XmlReader> XmlReader::create(const Ptr<IReader>& reader)
+	{
+		XmlReaderParam param;
+		return create(reader, param);
+	}
+
+	Ref<XmlReader> XmlReader::openFile(const String& filePath, const XmlReaderParam& param)
+	{
+		Ref<File> file = File::openForRead(filePath);
+		if (file.isNull()) {
+			return sl_null;
+		}
+		return create(file, param);
+	}
+
+	Ref<XmlReader> XmlReader::openFile(const String& filePath)
+	{
+		XmlReaderParam param;
+		return openFile(filePath, param);
+	}
+
+	Ref<XmlReader> XmlReader::create(const XmlReaderParam& param)
+	{
+		Ref<XmlReader> ret = new XmlReader;
+		if (ret.isNotNull()) {
+			if (param.chunkSize) {
+				ret->m_chunkSize = param.chunkSize;
+			}
+			if (param.maxTokenSize) {
+				ret->m_maxTokenSize = param.maxTokenSize;
+			}
+			ret->m_flagLogError = param.flagLogError;
+		}
+		return ret;
+	}
+
+	Ref<XmlReader> XmlReader::create()
+	{
+		XmlReaderParam param;
+		return create(param);
+	}
+
+	XmlReaderEvent XmlReader::read()
+	{
+		if (m_event == XmlReaderEvent::Error || m_event == XmlReaderEvent::EndDocument) {
+			return m_event;
+		}
+		if (m_event == XmlReaderEvent::EndElement) {
+			m_depth--;
+		}
+		m_nAttributes = 0;
+		m_flagEmptyElement = sl_false;
+		m_text.data = sl_null;
+		m_text.length = 0;
+		if (m_flagPendingEndElement) {
+			// `m_name` is still the name of the empty element
+			m_flagPendingEndElement = sl_false;
+			m_sizeStackNames = ((sl_size*)(m_stackOffsets.getData()))[m_depth - 1];
+			m_event = XmlReaderEvent::EndElement;
+			return m_event;
+		}
+		m_name.data = sl_null;
+		m_name.length = 0;
+		for (;;) {
+			XmlReaderEvent event = _parse();
+			if (event != XmlReaderEvent::NeedMoreData) {
+				m_sizeScanned = 0;
+				m_event = event;
+				return event;
+			}
+			if (m_reader.isNull()) {
+				m_event = event;
+				return event;
+			}
+			if (!(_readMore())) {
+				return m_event;
+			}
+		}
+	}
+
+	sl_bool XmlReader::feed(const void* data, sl_size size)
+	{
+		if (m_flagEndOfInput || m_event == XmlReaderEvent::Error) {
+			return sl_false;
+		}
+		if (!size) {
+			return sl_true;
+		}
+		if (m_pos) {
+			Base::moveMemory(m_buf, m_buf + m_pos, m_end - m_pos);
+			m_offsetBuffer += m_pos;
+			m_end -= m_pos;
+			m_pos = 0;
+		}
+		// after `NeedMoreData`, the remaining data is the incomplete token
+		if (m_event == XmlReaderEvent::NeedMoreData && m_end >= m_maxTokenSize) {
+			_setError(_g_xml_error_msg_token_too_long, 0);
+			return sl_false;
+		}
+		if (m_sizeBuffer - m_end < size) {
+			sl_size sizeNew = m_sizeBuffer + (m_sizeBuffer >> 1);
+			if (sizeNew < m_end + size) {
+				sizeNew = m_end + size;
+			}
+			Memory mem = Memory::create(sizeNew);
+			if (mem.isNull()) {
+				_setError(_g_xml_error_msg_memory_lack, m_end);
+				return sl_false;
+			}
+			if (m_end) {
+				Base::copyMemory(mem.getData(), m_buf, m_end);
+			}
+			m_buffer = mem;
+			m_buf = (sl_char8*)(mem.getData());
+			m_sizeBuffer = sizeNew;
+		}
+		Base::copyMemory(m_buf + m_end, data, size);
+		m_end += size;
+		return sl_true;
+	}
+
+	void XmlReader::finish()
+	{
+		m_flagEndOfInput = sl_true;
+	}
+
+	sl_bool XmlReader::feedAsync(const Ref<AsyncStream>& stream, const Function<void(XmlReader*)>& onReady)
+	{
+		if (stream.isNull()) {
+			return sl_false;
+		}
+		if (m_flagEndOfInput || m_event == XmlReaderEvent::Error) {
+			return sl_false;
+		}
+		if (m_pos) {
+			Base::moveMemory(m_buf, m_buf + m_pos, m_end - m_pos);
+			m_offsetBuffer += m_pos;
+			m_end -= m_pos;
+			m_pos = 0;
+		}
+		if (!(_prepareSpace())) {
+			return sl_false;
+		}
+		sl_size size = m_sizeBuffer - m_end;
+		if (size > 0x40000000) {
+			size = 0x40000000;
+		}
+		Ref<XmlReader> thiz = this;
+		return stream->read(m_buf + m_end, (sl_uint32)size, [thiz, onReady](AsyncStreamResult* result) {
+			thiz->_onReadStream(result, onReady);
+		});
+	}
+
+	XmlReaderEvent XmlReader::getEvent()
+	{
+		return m_event;
+	}
+
+	const XmlReaderString& XmlReader::getName()
+	{
+		return m_name;
+	}
+
+	const XmlReaderString& XmlReader::getText()
+	{
+		return m_text;
+	}
+
+	sl_bool XmlReader::isEmptyElement()
+	{
+		return m_flagEmptyElement;
+	}
+
+	sl_size XmlReader::getAttributesCount()
+	{
+		return m_nAttributes;
+	}
+
+	const XmlReaderAttribute& XmlReader::getAttribute(sl_size index)
+	{
+		return ((XmlReaderAttribute*)(m_attributes.getData()))[index];
+	}
+
+	XmlReaderString XmlReader::getAttribute(const String& name)
+	{
+		XmlReaderAttribute* attrs = (XmlReaderAttribute*)(m_attributes.getData());
+		for (sl_size i = 0; i < m_nAttributes; i++) {
+			if (attrs[i].name.equals(name)) {
+				return attrs[i].value;
+			}
+		}
+		XmlReaderString ret;
+		ret.data = sl_null;
+		ret.length = 0;
+		return ret;
+	}
+
+	sl_size XmlReader::getDepth()
+	{
+		return m_depth;
+	}
+
+	sl_uint64 XmlReader::getPosition()
+	{
+		return m_positionEvent;
+	}
+
+	sl_bool XmlReader::isError()
+	{
+		return m_event == XmlReaderEvent::Error;
+	}
+
+	String XmlReader::getErrorMessage()
+	{
+		return m_errorMessage;
+	}
+
+	sl_uint64 XmlReader::getErrorPosition()
+	{
+		return m_errorPosition;
+	}
+
+	String XmlReader::getErrorText()
+	{
+		if (m_event == XmlReaderEvent::Error) {
+			return "(" + String::fromUint64(m_errorPosition) + ") " + m_errorMessage;
+		}
+		return sl_null;
+	}
+
+#define PRIV_XML_READER_INCOMPLETE(MSG, POS) \
+	if (m_flagEndOfInput) { \
+		return _setError(MSG, POS); \
+	} \
+	return XmlReaderEvent::NeedMoreData;
+
+	XmlReaderEvent XmlReader::_parse()
+	{
+		for (;;) {
+			sl_size pos = m_pos;
+			if (pos >= m_end) {
+				if (m_flagEndOfInput) {
+					if (m_depth) {
+						return _setError(_g_xml_error_msg_element_tag_not_matching_end_tag, pos);
+					}
+					return XmlReaderEvent::EndDocument;
+				}
+				return XmlReaderEvent::NeedMoreData;
+			}
+			if (!(m_offsetBuffer + pos)) {
+				// UTF-8 BOM
+				if (m_end - pos < 3 && !m_flagEndOfInput) {
+					return XmlReaderEvent::NeedMoreData;
+				}
+				if (m_end - pos >= 3 && (sl_uint8)(m_buf[pos]) == 0xEF && (sl_uint8)(m_buf[pos + 1]) == 0xBB && (sl_uint8)(m_buf[pos + 2]) == 0xBF) {
+					m_pos = pos + 3;
+					continue;
+				}
+			}
+			m_positionEvent = m_offsetBuffer + pos;
+			if (m_buf[pos] == '<') {
+				if (pos + 1 >= m_end) {
+					PRIV_XML_READER_INCOMPLETE(_g_xml_error_msg_invalid_markup, pos)
+				}
+				sl_char8 ch = m_buf[pos + 1];
+				if (ch == '/') {
+					return _parseEndElement(pos);
+				} else if (ch == '!' || ch == '?') {
+					return _parseMarkup(pos);
+				} else {
+					return _parseElement(pos);
+				}
+			} else {
+				XmlReaderEvent event = _parseText(pos);
+				if (event == XmlReaderEvent::Text && !(m_text.length)) {
+					// white spaces
+					m_sizeScanned = 0;
+					continue;
+				}
+				return event;
+			}
+		}
+	}
+
+	XmlReaderEvent XmlReader::_parseElement(sl_size posStart)
+	{
+		sl_char8* buf = m_buf;
+		sl_size end = m_end;
+		sl_size pos = posStart + 1;
+
+		// name
+		sl_size posName = pos;
+		sl_uint32 ch = (sl_uint8)(buf[pos]);
+		if (ch < 128 && _g_XML_check_name_pattern[ch] != 1) {
+			return _setError(_g_xml_error_msg_name_invalid_start, pos);
+		}
+		pos++;
+		while (pos < end) {
+			ch = (sl_uint8)(buf[pos]);
+			if (ch < 128 && _g_XML_check_name_pattern[ch] == 0) {
+				break;
+			}
+			pos++;
+		}
+		sl_size lenName = pos - posName;
+
+		// attributes
+		sl_size nAttrs = 0;
+		sl_bool flagEmpty = sl_false;
+		for (;;) {
+			sl_size posWhiteSpace = pos;
+			while (pos < end && SLIB_CHAR_IS_WHITE_SPACE(buf[pos])) {
+				pos++;
+			}
+			if (pos >= end) {
+				PRIV_XML_READER_INCOMPLETE(_g_xml_error_msg_element_tag_not_end, pos)
+			}
+			ch = (sl_uint8)(buf[pos]);
+			if (ch == '>') {
+				pos++;
+				break;
+			}
+			if (ch == '/') {
+				if (pos + 1 >= end) {
+					PRIV_XML_READER_INCOMPLETE(_g_xml_error_msg_element_tag_not_end, pos)
+				}
+				if (buf[pos + 1] != '>') {
+					return _setError(_g_xml_error_msg_element_tag_not_end, pos);
+				}
+				pos += 2;
+				flagEmpty = sl_true;
+				break;
+			}
+			if (pos == posWhiteSpace) {
+				if (nAttrs) {
+					return _setError(_g_xml_error_msg_element_attr_end_with_invalid_char, pos);
+				} else {
+					return _setError(_g_xml_error_msg_name_invalid_char, pos);
+				}
+			}
+			// attribute name
+			sl_size posAttrName = pos;
+			if (ch < 128 && _g_XML_check_name_pattern[ch] != 1) {
+				return _setError(_g_xml_error_msg_name_invalid_start, pos);
+			}
+			pos++;
+			while (pos < end) {
+				ch = (sl_uint8)(buf[pos]);
+				if (ch < 128 && _g_XML_check_name_pattern[ch] == 0) {
+					break;
+				}
+				pos++;
+			}
+			sl_size lenAttrName = pos - posAttrName;
+			while (pos < end && SLIB_CHAR_IS_WHITE_SPACE(buf[pos])) {
+				pos++;
+			}
+			if (pos >= end) {
+				PRIV_XML_READER_INCOMPLETE(_g_xml_error_msg_element_attr_required_assign, pos)
+			}
+			if (buf[pos] != '=') {
+				return _setError(_g_xml_error_msg_element_attr_required_assign, pos);
+			}
+			pos++;
+			while (pos < end && SLIB_CHAR_IS_WHITE_SPACE(buf[pos])) {
+				pos++;
+			}
+			if (pos >= end) {
+				PRIV_XML_READER_INCOMPLETE(_g_xml_error_msg_element_attr_required_quot, pos)
+			}
+			sl_char8 quot = buf[pos];
+			if (quot != '\"' && quot != '\'') {
+				return _setError(_g_xml_error_msg_element_attr_required_quot, pos);
+			}
+			pos++;
+			sl_size posValue = pos;
+			const sl_char8* pQuot = (const sl_char8*)(Base::findMemory(buf + pos, (sl_uint8)quot, end - pos));
+			if (!pQuot) {
+				PRIV_XML_READER_INCOMPLETE(_g_xml_error_msg_element_attr_not_end, pos)
+			}
+			pos = pQuot - buf;
+			if (Base::findMemory(buf + posValue, '<', pos - posValue)) {
+				return _setError(_g_xml_error_msg_content_include_lt, posValue);
+			}
+			sl_size lenValue = pos - posValue;
+			pos++;
+
+			XmlReaderAttribute* attrs = (XmlReaderAttribute*)(m_attributes.getData());
+			for (sl_size i = 0; i < nAttrs; i++) {
+				if (attrs[i].name.equals(buf + posAttrName, lenAttrName)) {
+					return _setError(_g_xml_error_msg_element_attr_duplicate, posAttrName);
+				}
+			}
+			if ((nAttrs + 1) * sizeof(XmlReaderAttribute) > m_attributes.getSize()) {
+				Memory mem = Memory::create((nAttrs + 8) * 2 * sizeof(XmlReaderAttribute));
+				if (mem.isNull()) {
+					return _setError(_g_xml_error_msg_memory_lack, pos);
+				}
+				if (nAttrs) {
+					Base::copyMemory(mem.getData(), attrs, nAttrs * sizeof(XmlReaderAttribute));
+				}
+				m_attributes = mem;
+				attrs = (XmlReaderAttribute*)(mem.getData());
+			}
+			XmlReaderAttribute& attr = attrs[nAttrs];
+			attr.name.data = buf + posAttrName;
+			attr.name.length = lenAttrName;
+			attr.value.data = buf + posValue;
+			attr.value.length = lenValue;
+			nAttrs++;
+		}
+
+		// the tag is complete. decodes the values in place
+		XmlReaderAttribute* attrs = (XmlReaderAttribute*)(m_attributes.getData());
+		for (sl_size i = 0; i < nAttrs; i++) {
+			sl_size lenValue;
+			if (!(_decodeEntities((sl_char8*)(attrs[i].value.data), attrs[i].value.length, lenValue))) {
+				return XmlReaderEvent::Error;
+			}
+			attrs[i].value.length = lenValue;
+		}
+		if (!(_pushName(buf + posName, lenName))) {
+			return XmlReaderEvent::Error;
+		}
+		m_name.data = buf + posName;
+		m_name.length = lenName;
+		m_nAttributes = nAttrs;
+		m_flagEmptyElement = flagEmpty;
+		m_flagPendingEndElement = flagEmpty;
+		m_pos = pos;
+		return XmlReaderEvent::StartElement;
+	}
+
+	XmlReaderEvent XmlReader::_parseEndElement(sl_size posStart)
+	{
+		sl_char8* buf = m_buf;
+		sl_size end = m_end;
+		sl_size pos = posStart + 2;
+		sl_size posName = pos;
+		while (pos < end) {
+			sl_uint32 ch = (sl_uint8)(buf[pos]);
+			if (ch < 128 && _g_XML_check_name_pattern[ch] == 0) {
+				break;
+			}
+			pos++;
+		}
+		sl_size lenName = pos - posName;
+		while (pos < end && SLIB_CHAR_IS_WHITE_SPACE(buf[pos])) {
+			pos++;
+		}
+		if (pos >= end) {
+			PRIV_XML_READER_INCOMPLETE(_g_xml_error_msg_element_tag_not_end, pos)
+		}
+		if (buf[pos] != '>') {
+			return _setError(_g_xml_error_msg_element_tag_not_end, pos);
+		}
+		if (!m_depth) {
+			return _setError(_g_xml_error_msg_element_tag_not_matching_end_tag, posStart);
+		}
+		sl_size offsetName = ((sl_size*)(m_stackOffsets.getData()))[m_depth - 1];
+		if (m_sizeStackNames - offsetName != lenName || !(Base::equalsMemory((sl_char8*)(m_stackNames.getData()) + offsetName, buf + posName, lenName))) {
+			return _setError(_g_xml_error_msg_element_tag_not_matching_end_tag, posStart);
+		}
+		m_sizeStackNames = offsetName;
+		m_name.data = buf + posName;
+		m_name.length = lenName;
+		m_pos = pos + 1;
+		return XmlReaderEvent::EndElement;
+	}
+
+	XmlReaderEvent XmlReader::_parseMarkup(sl_size posStart)
+	{
+		sl_char8* buf = m_buf;
+		sl_size end = m_end;
+		if (buf[posStart + 1] == '?') {
+			sl_size pos = posStart + 2;
+			if (pos >= end) {
+				PRIV_XML_READER_INCOMPLETE(_g_xml_error_msg_PI_not_end, pos)
+			}
+			sl_size posName = pos;
+			sl_uint32 ch = (sl_uint8)(buf[pos]);
+			if (ch < 128 && _g_XML_check_name_pattern[ch] != 1) {
+				return _setError(_g_xml_error_msg_name_invalid_start, pos);
+			}
+			pos++;
+			while (pos < end) {
+				ch = (sl_uint8)(buf[pos]);
+				if (ch < 128 && _g_XML_check_name_pattern[ch] == 0) {
+					break;
+				}
+				pos++;
+			}
+			if (pos >= end) {
+				PRIV_XML_READER_INCOMPLETE(_g_xml_error_msg_PI_not_end, pos)
+			}
+			sl_size lenName = pos - posName;
+			if (buf[pos] != '?') {
+				if (!(SLIB_CHAR_IS_WHITE_SPACE(buf[pos]))) {
+					return _setError(_g_xml_error_msg_name_invalid_char, pos);
+				}
+				while (pos < end && SLIB_CHAR_IS_WHITE_SPACE(buf[pos])) {
+					pos++;
+				}
+			}
+			sl_size posContent = pos;
+			sl_size posEnd;
+			if (!(_findTerminator(posStart, posContent, "?>", 2, posEnd))) {
+				PRIV_XML_READER_INCOMPLETE(_g_xml_error_msg_PI_not_end, posStart)
+			}
+			m_name.data = buf + posName;
+			m_name.length = lenName;
+			m_text.data = buf + posContent;
+			m_text.length = posEnd - posContent;
+			m_pos = posEnd + 2;
+			return XmlReaderEvent::ProcessingInstruction;
+		}
+		if (end - posStart < 9 && !m_flagEndOfInput) {
+			return XmlReaderEvent::NeedMoreData;
+		}
+		sl_size n = end - posStart;
+		const sl_char8* s = buf + posStart;
+		if (n >= 4 && s[2] == '-' && s[3] == '-') {
+			sl_size posContent = posStart + 4;
+			sl_size posEnd;
+			if (!(_findTerminator(posStart, posContent, "--", 2, posEnd)) || posEnd + 2 >= end) {
+				PRIV_XML_READER_INCOMPLETE(_g_xml_error_msg_comment_not_end, posStart)
+			}
+			if (buf[posEnd + 2] != '>') {
+				return _setError(_g_xml_error_msg_comment_double_hyphen, posEnd);
+			}
+			m_text.data = buf + posContent;
+			m_text.length = posEnd - posContent;
+			m_pos = posEnd + 3;
+			return XmlReaderEvent::Comment;
+		}
+		if (n >= 9 && Base::equalsMemory(s + 2, "[CDATA[", 7)) {
+			sl_size posContent = posStart + 9;
+			sl_size posEnd;
+			if (!(_findTerminator(posStart, posContent, "]]>", 3, posEnd))) {
+				PRIV_XML_READER_INCOMPLETE(_g_xml_error_msg_CDATA_not_end, posStart)
+			}
+			m_text.data = buf + posContent;
+			m_text.length = posEnd - posContent;
+			m_pos = posEnd + 3;
+			return XmlReaderEvent::CDATA;
+		}
+		if (n >= 9 && Base::equalsMemory(s + 2, "DOCTYPE", 7)) {
+			// skips the internal subset and the quoted literals
+			sl_size pos = posStart + 9;
+			sl_uint32 depth = 0;
+			sl_char8 quot = 0;
+			while (pos < end) {
+				sl_char8 ch = buf[pos];
+				if (quot) {
+					if (ch == quot) {
+						quot = 0;
+					}
+				} else if (ch == '\"' || ch == '\'') {
+					quot = ch;
+				} else if (ch == '[') {
+					depth++;
+				} else if (ch == ']') {
+					if (depth) {
+						depth--;
+					}
+				} else if (ch == '>' && !depth) {
+					break;
+				}
+				pos++;
+			}
+			if (pos >= end) {
+				PRIV_XML_READER_INCOMPLETE(_g_xml_error_msg_invalid_markup, posStart)
+			}
+			sl_size posContent = posStart + 9;
+			while (posContent < pos && SLIB_CHAR_IS_WHITE_SPACE(buf[posContent])) {
+				posContent++;
+			}
+			m_text.data = buf + posContent;
+			m_text.length = pos - posContent;
+			m_pos = pos + 1;
+			return XmlReaderEvent::DocumentType;
+		}
+		return _setError(_g_xml_error_msg_invalid_markup, posStart);
+	}
+
+	XmlReaderEvent XmlReader::_parseText(sl_size posStart)
+	{
+		sl_char8* buf = m_buf;
+		sl_size end = m_end;
+		sl_size posSearch = posStart + m_sizeScanned;
+		const sl_char8* pLt = (const sl_char8*)(Base::findMemory(buf + posSearch, '<', end - posSearch));
+		sl_size posEnd;
+		if (pLt) {
+			posEnd = pLt - buf;
+		} else {
+			if (!m_flagEndOfInput) {
+				m_sizeScanned = end - posStart;
+				return XmlReaderEvent::NeedMoreData;
+			}
+			posEnd = end;
+		}
+		m_pos = posEnd;
+		sl_size start = posStart;
+		while (start < posEnd && SLIB_CHAR_IS_WHITE_SPACE(buf[start])) {
+			start++;
+		}
+		sl_size last = posEnd;
+		while (last > start && SLIB_CHAR_IS_WHITE_SPACE(buf[last - 1])) {
+			last--;
+		}
+		sl_size len = 0;
+		if (last > start) {
+			if (!(_decodeEntities(buf + start, last - start, len))) {
+				return XmlReaderEvent::Error;
+			}
+		}
+		m_text.data = buf + start;
+		m_text.length = len;
+		return XmlReaderEvent::Text;
+	}
+
+	sl_bool XmlReader::_findTerminator(sl_size posStart, sl_size posSearch, const char* terminator, sl_size lenTerminator, sl_size& posFound)
+	{
+		sl_char8* buf = m_buf;
+		sl_size end = m_end;
+		sl_size pos = posStart + m_sizeScanned;
+		if (pos < posSearch) {
+			pos = posSearch;
+		}
+		while (pos + lenTerminator <= end) {
+			const sl_char8* p = (const sl_char8*)(Base::findMemory(buf + pos, (sl_uint8)(terminator[0]), end - pos));
+			if (!p) {
+				break;
+			}
+			pos = p - buf;
+			if (pos + lenTerminator > end) {
+				break;
+			}
+			if (Base::equalsMemory(p, terminator, lenTerminator)) {
+				posFound = pos;
+				return sl_true;
+			}
+			pos++;
+		}
+		// the terminator may be split by the end of the data
+		sl_size posResume = end >= lenTerminator ? end - lenTerminator + 1 : 0;
+		if (posResume < posSearch) {
+			posResume = posSearch;
+		}
+		m_sizeScanned = posResume - posStart;
+		return sl_false;
+	}
+
+	sl_bool XmlReader::_decodeEntities(sl_char8* s, sl_size len, sl_size& lenOutput)
+	{
+		sl_char8* p = (sl_char8*)(Base::findMemory(s, '&', len));
+		if (!p) {
+			lenOutput = len;
+			return sl_true;
+		}
+		sl_char8* end = s + len;
+		sl_char8* out = p;
+		while (p < end) {
+			sl_char8 ch = *p;
+			if (ch != '&') {
+				*(out++) = ch;
+				p++;
+				continue;
+			}
+			p++;
+			sl_char8* semicolon = (sl_char8*)(Base::findMemory(p, ';', end - p));
+			if (!semicolon) {
+				_setError(_g_xml_error_msg_escape_not_end, p - m_buf);
+				return sl_false;
+			}
+			sl_size n = semicolon - p;
+			if (n == 2 && p[0] == 'l' && p[1] == 't') {
+				*(out++) = '<';
+			} else if (n == 2 && p[0] == 'g' && p[1] == 't') {
+				*(out++) = '>';
+			} else if (n == 3 && p[0] == 'a' && p[1] == 'm' && p[2] == 'p') {
+				*(out++) = '&';
+			} else if (n == 4 && p[0] == 'a' && p[1] == 'p' && p[2] == 'o' && p[3] == 's') {
+				*(out++) = '\'';
+			} else if (n == 4 && p[0] == 'q' && p[1] == 'u' && p[2] == 'o' && p[3] == 't') {
+				*(out++) = '\"';
+			} else if (n >= 2 && p[0] == '#') {
+				sl_uint32 code;
+				sl_reg iRet;
+				if (p[1] == 'x') {
+					iRet = String::parseUint32(16, &code, p, 2, n);
+				} else {
+					iRet = String::parseUint32(10, &code, p, 1, n);
+				}
+				if (iRet != (sl_reg)n) {
+					_setError(_g_xml_error_msg_invalid_escape, p - m_buf);
+					return sl_false;
+				}
+				// a character reference is not shorter than its UTF-8 encoding
+				sl_char32 c = (sl_char32)code;
+				out += Charsets::utf32ToUtf8(&c, 1, out, 4);
+			} else {
+				_setError(_g_xml_error_msg_invalid_escape, p - m_buf);
+				return sl_false;
+			}
+			p = semicolon + 1;
+		}
+		lenOutput = out - s;
+		return sl_true;
+	}
+
+	sl_bool XmlReader::_pushName(const sl_char8* name, sl_size len)
+	{
+		if (m_sizeStackNames + len > m_stackNames.getSize()) {
+			sl_size size = (m_sizeStackNames + len) * 2 + 256;
+			Memory mem = Memory::create(size);
+			if (mem.isNull()) {
+				_setError(_g_xml_error_msg_memory_lack, m_pos);
+				return sl_false;
+			}
+			if (m_sizeStackNames) {
+				Base::copyMemory(mem.getData(), m_stackNames.getData(), m_sizeStackNames);
+			}
+			m_stackNames = mem;
+		}
+		if ((m_depth + 1) * sizeof(sl_size) > m_stackOffsets.getSize()) {
+			Memory mem = Memory::create((m_depth + 32) * 2 * sizeof(sl_size));
+			if (mem.isNull()) {
+				_setError(_g_xml_error_msg_memory_lack, m_pos);
+				return sl_false;
+			}
+			if (m_depth) {
+				Base::copyMemory(mem.getData(), m_stackOffsets.getData(), m_depth * sizeof(sl_size));
+			}
+			m_stackOffsets = mem;
+		}
+		((sl_size*)(m_stackOffsets.getData()))[m_depth] = m_sizeStackNames;
+		Base::copyMemory((sl_char8*)(m_stackNames.getData()) + m_sizeStackNames, name, len);
+		m_sizeStackNames += len;
+		m_depth++;
+		return sl_true;
+	}
+
+	sl_bool XmlReader::_readMore()
+	{
+		if (m_pos) {
+			Base::moveMemory(m_buf, m_buf + m_pos, m_end - m_pos);
+			m_offsetBuffer += m_pos;
+			m_end -= m_pos;
+			m_pos = 0;
+		}
+		if (!(_prepareSpace())) {
+			return sl_false;
+		}
+		PtrLocker<IReader> reader(m_reader);
+		if (reader.isNull()) {
+			_setError(_g_xml_error_msg_reader_missing, m_end);
+			return sl_false;
+		}
+		sl_reg n = reader->read(m_buf + m_end, m_sizeBuffer - m_end);
+		if (n > 0) {
+			m_end += n;
+		} else {
+			m_flagEndOfInput = sl_true;
+		}
+		return sl_true;
+	}
+
+	sl_bool XmlReader::_prepareSpace()
+	{
+		if (m_sizeBuffer - m_end >= m_chunkSize) {
+			return sl_true;
+		}
+		if (m_end >= m_maxTokenSize) {
+			_setError(_g_xml_error_msg_token_too_long, 0);
+			return sl_false;
+		}
+		sl_size sizeNew = m_sizeBuffer << 1;
+		if (sizeNew < m_end + m_chunkSize) {
+			sizeNew = m_end + m_chunkSize;
+		}
+		if (sizeNew > m_maxTokenSize + m_chunkSize) {
+			sizeNew = m_maxTokenSize + m_chunkSize;
+		}
+		Memory mem = Memory::create(sizeNew);
+		if (mem.isNull()) {
+			_setError(_g_xml_error_msg_memory_lack, m_end);
+			return sl_false;
+		}
+		if (m_end) {
+			Base::copyMemory(mem.getData(), m_buf, m_end);
+		}
+		m_buffer = mem;
+		m_buf = (sl_char8*)(mem.getData());
+		m_sizeBuffer = sizeNew;
+		return sl_true;
+	}
+
+	XmlReaderEvent XmlReader::_setError(const String& message, sl_size pos)
+	{
+		m_event = XmlReaderEvent::Error;
+		m_errorMessage = message;
+		m_errorPosition = m_offsetBuffer + pos;
+		if (m_flagLogError) {
+			LogError("XmlReader", getErrorText());
+		}
+		return XmlReaderEvent::Error;
+	}
+
+	void XmlReader::_onReadStream(AsyncStreamResult* result, const Function<void(XmlReader*)>& onReady)
+	{
+		if (result->size) {
+			m_end += result->size;
+		}
+		if (result->flagError || !(result->size)) {
+			m_flagEndOfInput = sl_true;
+		}
+		onReady(this);
+	}
+
 }
@@ -13,17 +13,24 @@
 #include "slib/crypto/sha2.h"
 #include "slib/core/mio.h"
 
+#include "crypto_x86.h"
+
 /*
 	AES - Advanced Encryption Standard
 
 	http://csrc.nist.gov/publications/fips/fips197/fips-197.pdf
+	https://software.intel.com/sites/default/files/article/165683/aes-wp-2012-09-22-v01.pdf
 */
 
 namespace slib
 {
 
+	extern template class BlockCipher_CTR<AES>;
+
 	AES::AES()
 	{
+		m_nCountRounds = 0;
+		m_flagHardware = isHardwareSupported();
 	}
 
 	AES::~AES()
@@ -353,9 +360,101 @@ static const sl_uint32 _priv_AES_RT3[256] = { RT };
 			W += 4;
 		}
 		Base::copyMemory(W, WE, 32);
+		
+		// AES-NI uses the same round keys (including InvMixColumns-ed decryption keys) in byte order
+		j = (nRounds + 1) << 2;
+		for (i = 0; i < j; i++) {
+			MIO::writeUint32BE(m_roundKeyEncHW + (i << 2), m_roundKeyEnc[i]);
+			MIO::writeUint32BE(m_roundKeyDecHW + (i << 2), m_roundKeyDec[i]);
+		}
 		return sl_true;
 	}
 
+#ifdef SLIB_CRYPTO_SUPPORT_X86_NI
+
+	SLIB_CRYPTO_X86_NI_FUNC static void _priv_AES_NI_encryptBlock(const sl_uint8* K, sl_uint32 nRounds, const void* src, void* dst)
+	{
+		const __m128i* W = (const __m128i*)K;
+		__m128i S = _mm_xor_si128(_mm_loadu_si128((const __m128i*)src), _mm_loadu_si128(W));
+		for (sl_uint32 i = 1; i < nRounds; i++) {
+			S = _mm_aesenc_si128(S, _mm_loadu_si128(W + i));
+		}
+		S = _mm_aesenclast_si128(S, _mm_loadu_si128(W + nRounds));
+		_mm_storeu_si128((__m128i*)dst, S);
+	}
+
+	SLIB_CRYPTO_X86_NI_FUNC static void _priv_AES_NI_decryptBlock(const sl_uint8* K, sl_uint32 nRounds, const void* src, void* dst)
+	{
+		const __m128i* W = (const __m128i*)K;
+		__m128i S = _mm_xor_si128(_mm_loadu_si128((const __m128i*)src), _mm_loadu_si128(W));
+		for (sl_uint32 i = 1; i < nRounds; i++) {
+			S = _mm_aesdec_si128(S, _mm_loadu_si128(W + i));
+		}
+		S = _mm_aesdeclast_si128(S, _mm_loadu_si128(W + nRounds));
+		_mm_storeu_si128((__m128i*)dst, S);
+	}
+
+#define AES_NI_CTR_BLOCKS 8
+
+	// keeps 8 blocks in flight to hide the latency of AESENC
+	SLIB_CRYPTO_X86_NI_FUNC static void _priv_AES_NI_encryptCTR(const sl_uint8* K, sl_uint32 nRounds, sl_uint8* counter, const sl_uint8* input, sl_uint8* output, sl_size nBlocks)
+	{
+		const __m128i* W = (const __m128i*)K;
+		const __m128i swap = _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+		sl_uint64 high = MIO::readUint64BE(counter);
+		sl_uint64 low = MIO::readUint64BE(counter + 8);
+		__m128i S[AES_NI_CTR_BLOCKS];
+		sl_uint32 i, k;
+		while (nBlocks) {
+			sl_uint32 n = nBlocks > AES_NI_CTR_BLOCKS ? AES_NI_CTR_BLOCKS : (sl_uint32)nBlocks;
+			__m128i key = _mm_loadu_si128(W);
+			for (k = 0; k < n; k++) {
+				S[k] = _mm_xor_si128(_mm_shuffle_epi8(_mm_set_epi64x((sl_int64)high, (sl_int64)low), swap), key);
+				low++;
+				if (!low) {
+					high++;
+				}
+			}
+			for (i = 1; i < nRounds; i++) {
+				key = _mm_loadu_si128(W + i);
+				for (k = 0; k < n; k++) {
+					S[k] = _mm_aesenc_si128(S[k], key);
+				}
+			}
+			key = _mm_loadu_si128(W + nRounds);
+			for (k = 0; k < n; k++) {
+				S[k] = _mm_aesenclast_si128(S[k], key);
+				_mm_storeu_si128((__m128i*)output, _mm_xor_si128(S[k], _mm_loadu_si128((const __m128i*)input)));
+				input += 16;
+				output += 16;
+			}
+			nBlocks -= n;
+		}
+		MIO::writeUint64BE(counter, high);
+		MIO::writeUint64BE(counter + 8, low);
+	}
+
+#endif
+
+	sl_bool AES::isHardwareSupported()
+	{
+#ifdef SLIB_CRYPTO_SUPPORT_X86_NI
+		return _priv_Crypto_isAESNISupported();
+#else
+		return sl_false;
+#endif
+	}
+
+	sl_bool AES::isHardwareEnabled() const
+	{
+		return m_flagHardware;
+	}
+
+	void AES::setHardwareEnabled(sl_bool flag)
+	{
+		m_flagHardware = flag && isHardwareSupported();
+	}
+
 /*
 	Encryption Rounds
 
@@ -434,6 +533,12 @@ Roundn (Last):
 	
 	void AES::encryptBlock(const void* _src, void *_dst) const
 	{
+#ifdef SLIB_CRYPTO_SUPPORT_X86_NI
+		if (m_flagHardware) {
+			_priv_AES_NI_encryptBlock(m_roundKeyEncHW, m_nCountRounds, _src, _dst);
+			return;
+		}
+#endif
 		const sl_uint8* IN = (const sl_uint8*)_src;
 		sl_uint8* OUT = (sl_uint8*)_dst;
 
@@ -530,6 +635,12 @@ Roundn (Last):
 	
 	void AES::decryptBlock(const void* _src, void *_dst) const
 	{
+#ifdef SLIB_CRYPTO_SUPPORT_X86_NI
+		if (m_flagHardware) {
+			_priv_AES_NI_decryptBlock(m_roundKeyDecHW, m_nCountRounds, _src, _dst);
+			return;
+		}
+#endif
 		const sl_uint8* IN = (const sl_uint8*)_src;
 		sl_uint8* OUT = (sl_uint8*)_dst;
 		
@@ -554,6 +665,52 @@ Roundn (Last):
 	}
 
 
+	sl_size AES::encrypt_CTR(const void* _input, sl_size _size, void* _output, void* _counter, sl_uint32 offset) const
+	{
+#ifdef SLIB_CRYPTO_SUPPORT_X86_NI
+		if (m_flagHardware && offset < 16) {
+			const sl_uint8* input = (const sl_uint8*)_input;
+			sl_uint8* output = (sl_uint8*)_output;
+			sl_uint8* counter = (sl_uint8*)_counter;
+			sl_size size = _size;
+			sl_uint8 mask[16];
+			sl_size i, n;
+			if (offset) {
+				n = 16 - offset;
+				if (size <= n) {
+					return BlockCipher_CTR<AES>::encrypt(this, input, size, output, counter, offset);
+				}
+				_priv_AES_NI_encryptBlock(m_roundKeyEncHW, m_nCountRounds, counter, mask);
+				for (i = 0; i < n; i++) {
+					output[i] = input[i] ^ mask[i + offset];
+				}
+				size -= n;
+				input += n;
+				output += n;
+				MIO::increaseBE(counter, 16);
+			}
+			n = size >> 4;
+			if (n) {
+				_priv_AES_NI_encryptCTR(m_roundKeyEncHW, m_nCountRounds, counter, input, output, n);
+				n <<= 4;
+				size -= n;
+				input += n;
+				output += n;
+			}
+			if (size) {
+				_priv_AES_NI_encryptBlock(m_roundKeyEncHW, m_nCountRounds, counter, mask);
+				for (i = 0; i < size; i++) {
+					output[i] = input[i] ^ mask[i];
+				}
+				MIO::increaseBE(counter, 16);
+			}
+			return _size;
+		}
+#endif
+		return BlockCipher_CTR<AES>::encrypt(this, _input, _size, _output, _counter, offset);
+	}
+
+
 	AES_GCM::AES_GCM()
 	{
 	}
@@ -566,12 +723,25 @@ Roundn (Last):
 	{
 		m_cipher.setKey(key, lenKey);
 		setCipher(&m_cipher);
+		flagHardware = flagHardware && m_cipher.isHardwareEnabled();
 	}
 
 	void AES_GCM::setKey_SHA256(const String& key)
 	{
 		m_cipher.setKey_SHA256(key);
 		setCipher(&m_cipher);
+		flagHardware = flagHardware && m_cipher.isHardwareEnabled();
+	}
+
+	void AES_GCM::setHardwareEnabled(sl_bool flag)
+	{
+		m_cipher.setHardwareEnabled(flag);
+		if (m_cipher.isHardwareEnabled()) {
+			// HP is generated together with the table when PCLMULQDQ is supported
+			flagHardware = GCM_Table::isHardwareSupported();
+		} else {
+			flagHardware = sl_false;
+		}
 	}
 
 }
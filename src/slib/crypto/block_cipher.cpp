@@ -355,7 +355,8 @@ namespace slib
 		sl_uint8 IV[SLIB_CRYPTO_BLOCK_CIPHER_BLOCK_MAX_LEN];
 		Base::copyMemory(IV, iv, sizeBlock - 8);
 		MIO::writeUint64BE(IV + sizeBlock - 8, counter);
-		return encrypt(crypto, input, size, output, IV, offset);
+		// through the cipher, to use the accelerated implementation (e.g. AES-NI)
+		return crypto->encrypt_CTR(input, size, output, IV, offset);
 	}
 
 	template <class BlockCipher>
@@ -394,14 +395,20 @@ namespace slib
 	{ return BlockCipher_CBC<CLASS, BlockCipherPadding_PKCS7>::encrypt(this, mem.getData(), mem.getSize()); } \
 	Memory CLASS::decrypt_CBC_PKCS7Padding(const Memory& mem) const \
 	{ return BlockCipher_CBC<CLASS, BlockCipherPadding_PKCS7>::decrypt(this, mem.getData(), mem.getSize()); } \
-	sl_size CLASS::encrypt_CTR(const void* input, sl_size size, void* output, void* counter, sl_uint32 offset) const \
-	{ return BlockCipher_CTR<CLASS>::encrypt(this, input, size, output, counter, offset); } \
 	sl_size CLASS::encrypt_CTR(const void* iv, sl_uint64 counter, sl_uint32 offset, const void* input, sl_size size, void* output) const \
 	{ return BlockCipher_CTR<CLASS>::encrypt(this, iv, counter, offset, input, size, output); } \
 	sl_size CLASS::encrypt_CTR(const void* iv, sl_uint64 pos, const void* input, sl_size size, void* output) const \
 	{ return BlockCipher_CTR<CLASS>::encrypt(this, iv, pos, input, size, output); }
 
+#define DEFINE_BLOCKCIPHER_CTR(CLASS) \
+	sl_size CLASS::encrypt_CTR(const void* input, sl_size size, void* output, void* counter, sl_uint32 offset) const \
+	{ return BlockCipher_CTR<CLASS>::encrypt(this, input, size, output, counter, offset); }
+
+	// AES::encrypt_CTR(input, size, output, counter, offset) is defined in aes.cpp, to use AES-NI
 	DEFINE_BLOCKCIPHER(AES);
+	template class BlockCipher_CTR<AES>;
+	
 	DEFINE_BLOCKCIPHER(Blowfish);
+	DEFINE_BLOCKCIPHER_CTR(Blowfish);
 
 }
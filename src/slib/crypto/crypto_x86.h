@@ -0,0 +1,83 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef CHECKHEADER_SLIB_CRYPTO_CRYPTO_X86
+#define CHECKHEADER_SLIB_CRYPTO_CRYPTO_X86
+
+#include "slib/crypto/definition.h"
+
+/*
+	AES-NI / PCLMULQDQ support for x86 and x64
+
+	The instructions are used only when CPUID reports them at runtime,
+	so the library is still built for the baseline instruction set.
+*/
+
+#if (defined(SLIB_ARCH_IS_X64) || defined(SLIB_ARCH_IS_X86)) && (defined(SLIB_COMPILER_IS_VC) || defined(SLIB_COMPILER_IS_GCC))
+#	define SLIB_CRYPTO_SUPPORT_X86_NI
+#endif
+
+#ifdef SLIB_CRYPTO_SUPPORT_X86_NI
+
+#include <emmintrin.h>
+#include <tmmintrin.h>
+#include <wmmintrin.h>
+
+#if defined(SLIB_COMPILER_IS_VC)
+#	include <intrin.h>
+#	define SLIB_CRYPTO_X86_NI_FUNC
+#else
+#	include <cpuid.h>
+#	define SLIB_CRYPTO_X86_NI_FUNC __attribute__((target("sse2,ssse3,aes,pclmul")))
+#endif
+
+namespace slib
+{
+
+	// ECX of CPUID leaf 1
+	static sl_uint32 _priv_Crypto_getCpuFeatures()
+	{
+		static sl_int32 features = -1;
+		if (features < 0) {
+			sl_uint32 ecx = 0;
+#if defined(SLIB_COMPILER_IS_VC)
+			int info[4];
+			__cpuid(info, 1);
+			ecx = (sl_uint32)(info[2]);
+#else
+			unsigned int eax, ebx, _ecx, edx;
+			if (__get_cpuid(1, &eax, &ebx, &_ecx, &edx)) {
+				ecx = _ecx;
+			}
+#endif
+			features = (sl_int32)(ecx & 0x7fffffff);
+		}
+		return (sl_uint32)features;
+	}
+
+	SLIB_INLINE static sl_bool _priv_Crypto_isAESNISupported()
+	{
+		// SSSE3 (bit 9), AES (bit 25)
+		sl_uint32 f = _priv_Crypto_getCpuFeatures();
+		return (f & (1 << 9)) && (f & (1 << 25));
+	}
+
+	SLIB_INLINE static sl_bool _priv_Crypto_isCLMULSupported()
+	{
+		// PCLMULQDQ (bit 1), SSSE3 (bit 9)
+		sl_uint32 f = _priv_Crypto_getCpuFeatures();
+		return (f & (1 << 1)) && (f & (1 << 9));
+	}
+
+}
+
+#endif
+
+#endif
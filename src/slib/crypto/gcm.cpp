@@ -11,12 +11,152 @@
 #include "slib/crypto/gcm.h"
 
 #include "slib/crypto/aes.h"
+#include "slib/core/mio.h"
+
+#include "crypto_x86.h"
+
+/*
+	Carry-less multiplication (PCLMULQDQ) for GHASH
+
+	https://software.intel.com/sites/default/files/managed/72/cc/clmul-wp-rev-2.02-2014-04-20.pdf
+*/
 
 namespace slib
 {
 
+#ifdef SLIB_CRYPTO_SUPPORT_X86_NI
+
+	SLIB_CRYPTO_X86_NI_FUNC SLIB_INLINE static __m128i _priv_GCM_CLMUL_swap(__m128i x)
+	{
+		return _mm_shuffle_epi8(x, _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15));
+	}
+
+	// 256-bit product (unreduced) of byte-reflected operands: (H:L) ^= A * B
+	SLIB_CRYPTO_X86_NI_FUNC SLIB_INLINE static void _priv_GCM_CLMUL_multiply(__m128i A, __m128i B, __m128i& L, __m128i& H)
+	{
+		__m128i T0 = _mm_clmulepi64_si128(A, B, 0x00);
+		__m128i T1 = _mm_clmulepi64_si128(A, B, 0x10);
+		__m128i T2 = _mm_clmulepi64_si128(A, B, 0x01);
+		__m128i T3 = _mm_clmulepi64_si128(A, B, 0x11);
+		T1 = _mm_xor_si128(T1, T2);
+		L = _mm_xor_si128(L, _mm_xor_si128(T0, _mm_slli_si128(T1, 8)));
+		H = _mm_xor_si128(H, _mm_xor_si128(T3, _mm_srli_si128(T1, 8)));
+	}
+
+	// shifts (H:L) left by 1 bit (bit-reflection) and reduces modulo x^128 + x^7 + x^2 + x + 1
+	SLIB_CRYPTO_X86_NI_FUNC SLIB_INLINE static __m128i _priv_GCM_CLMUL_reduce(__m128i L, __m128i H)
+	{
+		__m128i T0, T1, T2;
+		T0 = _mm_srli_epi32(L, 31);
+		T1 = _mm_srli_epi32(H, 31);
+		L = _mm_slli_epi32(L, 1);
+		H = _mm_slli_epi32(H, 1);
+		T2 = _mm_srli_si128(T0, 12);
+		T1 = _mm_slli_si128(T1, 4);
+		T0 = _mm_slli_si128(T0, 4);
+		L = _mm_or_si128(L, T0);
+		H = _mm_or_si128(H, T1);
+		H = _mm_or_si128(H, T2);
+
+		T0 = _mm_xor_si128(_mm_xor_si128(_mm_slli_epi32(L, 31), _mm_slli_epi32(L, 30)), _mm_slli_epi32(L, 25));
+		T1 = _mm_srli_si128(T0, 4);
+		T0 = _mm_slli_si128(T0, 12);
+		L = _mm_xor_si128(L, T0);
+		T2 = _mm_xor_si128(_mm_xor_si128(_mm_srli_epi32(L, 1), _mm_srli_epi32(L, 2)), _mm_srli_epi32(L, 7));
+		T2 = _mm_xor_si128(T2, T1);
+		L = _mm_xor_si128(L, T2);
+		return _mm_xor_si128(H, L);
+	}
+
+	SLIB_CRYPTO_X86_NI_FUNC static __m128i _priv_GCM_CLMUL_gfmul(__m128i A, __m128i B)
+	{
+		__m128i L = _mm_setzero_si128();
+		__m128i H = _mm_setzero_si128();
+		_priv_GCM_CLMUL_multiply(A, B, L, H);
+		return _priv_GCM_CLMUL_reduce(L, H);
+	}
+
+	SLIB_CRYPTO_X86_NI_FUNC static void _priv_GCM_CLMUL_generate(const void* H, sl_uint8* HP)
+	{
+		__m128i H1 = _priv_GCM_CLMUL_swap(_mm_loadu_si128((const __m128i*)H));
+		__m128i H2 = _priv_GCM_CLMUL_gfmul(H1, H1);
+		__m128i H3 = _priv_GCM_CLMUL_gfmul(H2, H1);
+		__m128i H4 = _priv_GCM_CLMUL_gfmul(H3, H1);
+		_mm_storeu_si128((__m128i*)HP, H1);
+		_mm_storeu_si128((__m128i*)(HP + 16), H2);
+		_mm_storeu_si128((__m128i*)(HP + 32), H3);
+		_mm_storeu_si128((__m128i*)(HP + 48), H4);
+	}
+
+	SLIB_CRYPTO_X86_NI_FUNC static void _priv_GCM_CLMUL_multiplyH(const sl_uint8* HP, const void* X, void* O)
+	{
+		__m128i V = _priv_GCM_CLMUL_swap(_mm_loadu_si128((const __m128i*)X));
+		V = _priv_GCM_CLMUL_gfmul(V, _mm_loadu_si128((const __m128i*)HP));
+		_mm_storeu_si128((__m128i*)O, _priv_GCM_CLMUL_swap(V));
+	}
+
+	// X = (((X ^ D1) * H ^ D2) * H ^ D3) * H ^ D4) * H = (X ^ D1) * H^4 ^ D2 * H^3 ^ D3 * H^2 ^ D4 * H
+	SLIB_CRYPTO_X86_NI_FUNC static void _priv_GCM_CLMUL_multiplyData(const sl_uint8* HP, void* _X, const sl_uint8* D, sl_size lenD)
+	{
+		const __m128i* P = (const __m128i*)HP;
+		__m128i X = _priv_GCM_CLMUL_swap(_mm_loadu_si128((const __m128i*)_X));
+		__m128i H1 = _mm_loadu_si128(P);
+		sl_size n = lenD >> 4;
+		if (n >= 4) {
+			__m128i H2 = _mm_loadu_si128(P + 1);
+			__m128i H3 = _mm_loadu_si128(P + 2);
+			__m128i H4 = _mm_loadu_si128(P + 3);
+			do {
+				__m128i L = _mm_setzero_si128();
+				__m128i H = _mm_setzero_si128();
+				__m128i D1 = _mm_xor_si128(X, _priv_GCM_CLMUL_swap(_mm_loadu_si128((const __m128i*)D)));
+				_priv_GCM_CLMUL_multiply(D1, H4, L, H);
+				_priv_GCM_CLMUL_multiply(_priv_GCM_CLMUL_swap(_mm_loadu_si128((const __m128i*)(D + 16))), H3, L, H);
+				_priv_GCM_CLMUL_multiply(_priv_GCM_CLMUL_swap(_mm_loadu_si128((const __m128i*)(D + 32))), H2, L, H);
+				_priv_GCM_CLMUL_multiply(_priv_GCM_CLMUL_swap(_mm_loadu_si128((const __m128i*)(D + 48))), H1, L, H);
+				X = _priv_GCM_CLMUL_reduce(L, H);
+				D += 64;
+				n -= 4;
+			} while (n >= 4);
+		}
+		while (n) {
+			X = _mm_xor_si128(X, _priv_GCM_CLMUL_swap(_mm_loadu_si128((const __m128i*)D)));
+			X = _priv_GCM_CLMUL_gfmul(X, H1);
+			D += 16;
+			n--;
+		}
+		n = lenD & 15;
+		if (n) {
+			SLIB_ALIGN(16) sl_uint8 last[16] = { 0 };
+			Base::copyMemory(last, D, n);
+			X = _mm_xor_si128(X, _priv_GCM_CLMUL_swap(_mm_load_si128((const __m128i*)last)));
+			X = _priv_GCM_CLMUL_gfmul(X, H1);
+		}
+		_mm_storeu_si128((__m128i*)_X, _priv_GCM_CLMUL_swap(X));
+	}
+
+#endif
+
+	sl_bool GCM_Table::isHardwareSupported()
+	{
+#ifdef SLIB_CRYPTO_SUPPORT_X86_NI
+		return _priv_Crypto_isCLMULSupported();
+#else
+		return sl_false;
+#endif
+	}
+
 	void GCM_Table::generateTable(const void* inH)
 	{
+#ifdef SLIB_CRYPTO_SUPPORT_X86_NI
+		flagHardware = isHardwareSupported();
+		if (flagHardware) {
+			_priv_GCM_CLMUL_generate(inH, HP);
+		}
+#else
+		flagHardware = sl_false;
+#endif
+
 		sl_uint32 i, j;
 		Uint128 H;
 
@@ -74,6 +214,12 @@ namespace slib
 
 	void GCM_Table::multiplyH(const void* inX, void* inO) const
 	{
+#ifdef SLIB_CRYPTO_SUPPORT_X86_NI
+		if (flagHardware) {
+			_priv_GCM_CLMUL_multiplyH(HP, inX, inO);
+			return;
+		}
+#endif
 		const sl_uint8* X = (const sl_uint8*)inX;
 		sl_uint8* O = (sl_uint8*)inO;
 		Uint128 Z;
@@ -115,6 +261,14 @@ namespace slib
 
 	void GCM_Table::multiplyData(void* inX, const void* inD, sl_size lenD) const
 	{
+#ifdef SLIB_CRYPTO_SUPPORT_X86_NI
+		if (flagHardware) {
+			if (lenD) {
+				_priv_GCM_CLMUL_multiplyData(HP, inX, (const sl_uint8*)inD, lenD);
+			}
+			return;
+		}
+#endif
 		sl_uint8* X = (sl_uint8*)inX;
 		const sl_uint8* D = (const sl_uint8*)inD;
 		sl_size i, k, n;
@@ -247,6 +401,8 @@ namespace slib
 	}
 
 
+#define PRIV_GCM_CHUNK_SIZE 4096
+
 	template <class BlockCipher>
 	GCM<BlockCipher>::GCM()
 	{
@@ -312,25 +468,19 @@ namespace slib
 	template <class BlockCipher>
 	void GCM<BlockCipher>::encrypt(const void* src, void *dst, sl_size len)
 	{
-		sl_uint8 GCTR[16];
-		sl_size i, k, n;
 		const sl_uint8* P = (const sl_uint8*)src;
 		sl_uint8* C = (sl_uint8*)dst;
-		
-		for (i = 0; i < len; i += 16) {
-			increaseCIV();
-			m_cipher->encryptBlock(CIV, GCTR);
-			n = len - i;
-			if (n > 16) {
-				n = 16;
-			}
-			for (k = 0; k < n; k++) {
-				*C = *P ^ GCTR[k];
-				GHASH_X[k] ^= *C;
-				C++;
-				P++;
-			}
-			multiplyH(GHASH_X, GHASH_X);
+		sl_size n = len & ~((sl_size)15);
+		while (n) {
+			sl_size m = _encryptCounterBlocks(P, C, n);
+			multiplyData(GHASH_X, C, m);
+			P += m;
+			C += m;
+			n -= m;
+		}
+		n = len & 15;
+		if (n) {
+			encryptBlock(P, C, (sl_uint32)n);
 		}
 	}
 
@@ -355,26 +505,50 @@ namespace slib
 	template <class BlockCipher>
 	void GCM<BlockCipher>::decrypt(const void* src, void *dst, sl_size len)
 	{
-		sl_uint8 GCTR[16];
-		sl_size i, k, n;
 		const sl_uint8* C = (const sl_uint8*)src;
 		sl_uint8* P = (sl_uint8*)dst;
-		
-		for (i = 0; i < len; i += 16) {
-			increaseCIV();
-			m_cipher->encryptBlock(CIV, GCTR);
-			n = len - i;
-			if (n > 16) {
-				n = 16;
+		sl_size n = len & ~((sl_size)15);
+		while (n) {
+			sl_size m = n;
+			if (m > PRIV_GCM_CHUNK_SIZE) {
+				m = PRIV_GCM_CHUNK_SIZE;
 			}
-			for (k = 0; k < n; k++) {
-				GHASH_X[k] ^= *C;
-				*P = *C ^ GCTR[k];
-				C++;
-				P++;
+			// hashes before decrypting, because `src` and `dst` can be the same
+			multiplyData(GHASH_X, C, m);
+			n -= m;
+			while (m) {
+				sl_size k = _encryptCounterBlocks(C, P, m);
+				C += k;
+				P += k;
+				m -= k;
 			}
-			multiplyH(GHASH_X, GHASH_X);
 		}
+		n = len & 15;
+		if (n) {
+			decryptBlock(C, P, (sl_uint32)n);
+		}
+	}
+
+	template <class BlockCipher>
+	sl_size GCM<BlockCipher>::_encryptCounterBlocks(const void* src, void* dst, sl_size size)
+	{
+		if (size > PRIV_GCM_CHUNK_SIZE) {
+			size = PRIV_GCM_CHUNK_SIZE;
+		}
+		sl_uint32 nBlocks = (sl_uint32)(size >> 4);
+		// only the lower 32 bits of the counter block are incremented (inc32)
+		sl_uint32 first = MIO::readUint32BE(CIV + 12) + 1;
+		sl_uint32 nToWrap = (sl_uint32)(0 - first);
+		if (nToWrap && nBlocks > nToWrap) {
+			nBlocks = nToWrap;
+		}
+		sl_uint8 counter[16];
+		Base::copyMemory(counter, CIV, 12);
+		MIO::writeUint32BE(counter + 12, first);
+		size = ((sl_size)nBlocks) << 4;
+		m_cipher->encrypt_CTR(src, size, dst, counter, 0);
+		MIO::writeUint32BE(CIV + 12, first + nBlocks - 1);
+		return size;
 	}
 
 	template <class BlockCipher>
@@ -46,6 +46,29 @@ namespace slib
 	}
 
 
+	// the context is recreated when the modulus of the key is changed
+	static Ref<CBigIntMontgomery> _rsa_get_montgomery(AtomicRef<CBigIntMontgomery>& cache, const BigInt& M)
+	{
+		Ref<CBigIntMontgomery> context = cache;
+		if (context.isNotNull() && context->isModulus(M)) {
+			return context;
+		}
+		context = CBigIntMontgomery::create(M);
+		if (context.isNotNull()) {
+			cache = context;
+		}
+		return context;
+	}
+
+	static BigInt _rsa_pow(AtomicRef<CBigIntMontgomery>& cache, const BigInt& A, const BigInt& E, const BigInt& M)
+	{
+		Ref<CBigIntMontgomery> context = _rsa_get_montgomery(cache, M);
+		if (context.isNotNull()) {
+			return context->pow(A, E);
+		}
+		return BigInt::pow_montgomery(A, E, M);
+	}
+
 	sl_bool RSA::executePublic(const RSAPublicKey& key, const void* src, void* dst)
 	{
 		sl_size n = key.N.getMostSignificantBytes();
@@ -53,7 +76,7 @@ namespace slib
 		if (T >= key.N) {
 			return sl_false;
 		}
-		T = T.pow_montgomery(key.E, key.N);
+		T = _rsa_pow(key.m_montgomeryN, T, key.E, key.N);
 		if (T.isNotNull()) {
 			if (T.getBytesBE(dst, n)) {
 				return sl_true;
@@ -70,11 +93,15 @@ namespace slib
 			return sl_false;
 		}
 		if (key.flagUseOnlyD) {
-			T = T.pow_montgomery(key.D, key.N);
+			T = _rsa_pow(key.m_montgomeryN, T, key.D, key.N);
 		} else {
-			BigInt TP = T.pow_montgomery(key.DP, key.P);
-			BigInt TQ = T.pow_montgomery(key.DQ, key.Q);
+			BigInt TP = _rsa_pow(key.m_montgomeryP, T, key.DP, key.P);
+			BigInt TQ = _rsa_pow(key.m_montgomeryQ, T, key.DQ, key.Q);
+			// (TP - TQ) can be negative
 			T = ((TP - TQ) * key.IQ) % key.P;
+			if (T < 0) {
+				T += key.P;
+			}
 			T = TQ + T * key.Q;
 		}
 		if (T.isNotNull()) {
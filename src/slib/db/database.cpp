@@ -32,6 +32,15 @@ namespace slib
 		return -1;
 	}
 
+	sl_int64 Database::executeBatch(const String& sql, const DatabaseBatchParam& param)
+	{
+		Ref<DatabaseStatement> statement = prepareStatement(sql);
+		if (statement.isNotNull()) {
+			return statement->executeBatch(param);
+		}
+		return -1;
+	}
+
 	Ref<DatabaseCursor> Database::queryBy(const String& sql, const Variant* params, sl_uint32 nParams)
 	{
 		Ref<DatabaseStatement> statement = prepareStatement(sql);
@@ -59,6 +68,15 @@ namespace slib
 		return sl_null;
 	}
 
+	Ref<DatabaseResultSet> Database::getResultSetBy(const String& sql, const Variant* params, sl_uint32 nParams)
+	{
+		Ref<DatabaseStatement> statement = prepareStatement(sql);
+		if (statement.isNotNull()) {
+			return statement->getResultSetBy(params, nParams);
+		}
+		return sl_null;
+	}
+
 	Variant Database::getValueForQueryResultBy(const String& sql, const Variant* params, sl_uint32 nParams)
 	{
 		Ref<DatabaseStatement> statement = prepareStatement(sql);
@@ -78,6 +96,21 @@ namespace slib
 		return queryBy(sql, sl_null, 0);
 	}
 
+	sl_bool Database::startTransaction()
+	{
+		return execute("BEGIN") >= 0;
+	}
+
+	sl_bool Database::commitTransaction()
+	{
+		return execute("COMMIT") >= 0;
+	}
+
+	sl_bool Database::rollbackTransaction()
+	{
+		return execute("ROLLBACK") >= 0;
+	}
+
 	List< HashMap<String, Variant> > Database::getListForQueryResult(const String& sql)
 	{
 		List< HashMap<String, Variant> > ret;
@@ -101,6 +134,15 @@ namespace slib
 		return sl_null;
 	}
 
+	Ref<DatabaseResultSet> Database::getResultSet(const String& sql)
+	{
+		Ref<DatabaseCursor> cursor = query(sql);
+		if (cursor.isNotNull()) {
+			return DatabaseResultSet::create(cursor.get());
+		}
+		return sl_null;
+	}
+
 	Variant Database::getValueForQueryResult(const String& sql)
 	{
 		Ref<DatabaseCursor> cursor = query(sql);
@@ -42,6 +42,32 @@ namespace slib
 		return sl_null;
 	}
 
+	DatabaseColumnType DatabaseCursor::getColumnType(sl_uint32 index)
+	{
+		Variant value = getValue(index);
+		if (value.isNull()) {
+			return DatabaseColumnType::Null;
+		}
+		if (value.isUint64()) {
+			return DatabaseColumnType::UnsignedInteger;
+		}
+		if (value.isInteger() || value.isBoolean()) {
+			return DatabaseColumnType::Integer;
+		}
+		if (value.isFloat() || value.isDouble()) {
+			return DatabaseColumnType::Float;
+		}
+		if (value.isMemory()) {
+			return DatabaseColumnType::Blob;
+		}
+		return DatabaseColumnType::Text;
+	}
+
+	const void* DatabaseCursor::getColumnData(sl_uint32 index, sl_size* outSize)
+	{
+		return sl_null;
+	}
+
 	String DatabaseCursor::getString(const String& name)
 	{
 		sl_int32 index = getColumnIndex(name);
@@ -67,7 +93,7 @@ namespace slib
 
 	sl_uint64 DatabaseCursor::getUint64(sl_uint32 index, sl_uint64 defaultValue)
 	{
-		return getInt64(index, defaultValue);
+		return getString(index).parseUint64(10, defaultValue);
 	}
 
 	sl_uint64 DatabaseCursor::getUint64(const String& name, sl_uint64 defaultValue)
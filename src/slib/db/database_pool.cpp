@@ -0,0 +1,223 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "slib/db/database_pool.h"
+
+#include "slib/core/time.h"
+
+namespace slib
+{
+
+	class _priv_DatabasePool_Group
+	{
+	public:
+		Function<Ref<Database>()> connect;
+		sl_uint32 maxConnections;
+		sl_uint32 countConnections;
+		List< Ref<Database> > idleConnections;
+		List<Database*> connections;
+		Ref<Event> eventReturned;
+
+	public:
+		_priv_DatabasePool_Group()
+		{
+			maxConnections = 0;
+			countConnections = 0;
+		}
+
+	};
+
+
+	DatabasePoolParam::DatabasePoolParam()
+	{
+		maxConnections = 8;
+		maxReaders = 8;
+	}
+
+	DatabasePoolParam::~DatabasePoolParam()
+	{
+	}
+
+
+	SLIB_DEFINE_OBJECT(DatabasePool, Object)
+
+	DatabasePool::DatabasePool()
+	{
+		m_writers = sl_null;
+		m_readers = sl_null;
+	}
+
+	DatabasePool::~DatabasePool()
+	{
+		if (m_readers) {
+			delete m_readers;
+		}
+		if (m_writers) {
+			delete m_writers;
+		}
+	}
+
+	Ref<DatabasePool> DatabasePool::create(const DatabasePoolParam& param)
+	{
+		if (param.connect.isNull() || !(param.maxConnections)) {
+			return sl_null;
+		}
+		Ref<DatabasePool> ret = new DatabasePool;
+		if (ret.isNull()) {
+			return sl_null;
+		}
+		ret->m_writers = new _priv_DatabasePool_Group;
+		if (!(ret->m_writers)) {
+			return sl_null;
+		}
+		ret->m_writers->connect = param.connect;
+		ret->m_writers->maxConnections = param.maxConnections;
+		ret->m_writers->eventReturned = Event::create();
+		if (ret->m_writers->eventReturned.isNull()) {
+			return sl_null;
+		}
+		if (param.connectReader.isNotNull() && param.maxReaders) {
+			ret->m_readers = new _priv_DatabasePool_Group;
+			if (!(ret->m_readers)) {
+				return sl_null;
+			}
+			ret->m_readers->connect = param.connectReader;
+			ret->m_readers->maxConnections = param.maxReaders;
+			ret->m_readers->eventReturned = Event::create();
+			if (ret->m_readers->eventReturned.isNull()) {
+				return sl_null;
+			}
+		}
+		return ret;
+	}
+
+	Ref<Database> DatabasePool::getConnection(sl_int32 timeout)
+	{
+		return _getConnection(m_writers, timeout);
+	}
+
+	Ref<Database> DatabasePool::getReadConnection(sl_int32 timeout)
+	{
+		if (m_readers) {
+			return _getConnection(m_readers, timeout);
+		}
+		return _getConnection(m_writers, timeout);
+	}
+
+	void DatabasePool::releaseConnection(const Ref<Database>& db)
+	{
+		_returnConnection(db, sl_false);
+	}
+
+	void DatabasePool::discardConnection(const Ref<Database>& db)
+	{
+		_returnConnection(db, sl_true);
+	}
+
+	Ref<Database> DatabasePool::_getConnection(_priv_DatabasePool_Group* group, sl_int32 timeout)
+	{
+		TimeCounter t;
+		for (;;) {
+			sl_bool flagConnect = sl_false;
+			{
+				MutexLocker lock(&m_lock);
+				Ref<Database> db;
+				if (group->idleConnections.popBack_NoLock(&db)) {
+					return db;
+				}
+				if (group->countConnections < group->maxConnections) {
+					group->countConnections++;
+					flagConnect = sl_true;
+				}
+			}
+			if (flagConnect) {
+				Ref<Database> db = group->connect();
+				MutexLocker lock(&m_lock);
+				if (db.isNotNull()) {
+					if (group->connections.add_NoLock(db.get())) {
+						return db;
+					}
+				}
+				group->countConnections--;
+				return sl_null;
+			}
+			sl_int32 timeWait = -1;
+			if (timeout >= 0) {
+				sl_uint64 elapsed = t.getElapsedMilliseconds();
+				if (elapsed >= (sl_uint64)timeout) {
+					return sl_null;
+				}
+				timeWait = (sl_int32)(timeout - elapsed);
+			}
+			group->eventReturned->wait(timeWait);
+		}
+	}
+
+	void DatabasePool::_returnConnection(const Ref<Database>& db, sl_bool flagDiscard)
+	{
+		if (db.isNull()) {
+			return;
+		}
+		MutexLocker lock(&m_lock);
+		_priv_DatabasePool_Group* group = m_writers;
+		if (m_readers && m_readers->connections.contains_NoLock(db.get())) {
+			group = m_readers;
+		} else if (!(m_writers->connections.contains_NoLock(db.get()))) {
+			return;
+		}
+		if (flagDiscard) {
+			group->connections.remove_NoLock(db.get());
+			group->countConnections--;
+		} else {
+			group->idleConnections.add_NoLock(db);
+		}
+		group->eventReturned->set();
+	}
+
+
+	DatabasePoolConnection::DatabasePoolConnection(const Ref<DatabasePool>& pool, sl_bool flagReadOnly, sl_int32 timeout): m_pool(pool)
+	{
+		if (pool.isNotNull()) {
+			if (flagReadOnly) {
+				m_db = pool->getReadConnection(timeout);
+			} else {
+				m_db = pool->getConnection(timeout);
+			}
+		}
+	}
+
+	DatabasePoolConnection::~DatabasePoolConnection()
+	{
+		if (m_db.isNotNull()) {
+			m_pool->releaseConnection(m_db);
+		}
+	}
+
+	sl_bool DatabasePoolConnection::isNull() const
+	{
+		return m_db.isNull();
+	}
+
+	sl_bool DatabasePoolConnection::isNotNull() const
+	{
+		return m_db.isNotNull();
+	}
+
+	const Ref<Database>& DatabasePoolConnection::get() const
+	{
+		return m_db;
+	}
+
+	Database* DatabasePoolConnection::operator->() const
+	{
+		return m_db.get();
+	}
+
+}
@@ -0,0 +1,463 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "slib/db/database.h"
+
+#include "slib/core/new_helper.h"
+
+namespace slib
+{
+
+	struct _priv_DatabaseResultSet_Cell
+	{
+		union {
+			// integer, or offset of text/blob in the data buffer
+			sl_uint64 value;
+			double valueDouble;
+		};
+		sl_uint32 size;
+		sl_uint32 type;
+	};
+
+	class _priv_DatabaseResultSet_Builder
+	{
+	public:
+		sl_uint32 nColumns;
+		sl_size nRows;
+		_priv_DatabaseResultSet_Cell* cells; // row-major
+		sl_size capacityCells;
+		sl_uint8* data;
+		sl_size sizeData;
+		sl_size capacityData;
+
+	public:
+		_priv_DatabaseResultSet_Builder(sl_uint32 _nColumns)
+		{
+			nColumns = _nColumns;
+			nRows = 0;
+			cells = sl_null;
+			capacityCells = 0;
+			data = sl_null;
+			sizeData = 0;
+			capacityData = 0;
+		}
+
+		~_priv_DatabaseResultSet_Builder()
+		{
+			if (cells) {
+				Base::freeMemory(cells);
+			}
+			if (data) {
+				Base::freeMemory(data);
+			}
+		}
+
+	public:
+		_priv_DatabaseResultSet_Cell* addRow()
+		{
+			sl_size n = (nRows + 1) * nColumns;
+			if (n > capacityCells) {
+				sl_size capacity = capacityCells ? capacityCells * 2 : nColumns * 64;
+				if (capacity < n) {
+					capacity = n;
+				}
+				_priv_DatabaseResultSet_Cell* p = (_priv_DatabaseResultSet_Cell*)(Base::reallocMemory(cells, capacity * sizeof(_priv_DatabaseResultSet_Cell)));
+				if (!p) {
+					return sl_null;
+				}
+				cells = p;
+				capacityCells = capacity;
+			}
+			_priv_DatabaseResultSet_Cell* row = cells + nRows * nColumns;
+			nRows++;
+			return row;
+		}
+
+		sl_bool addData(_priv_DatabaseResultSet_Cell& cell, const void* buf, sl_size size)
+		{
+			if (size > 0xFFFFFFFF) {
+				return sl_false;
+			}
+			sl_size n = sizeData + size;
+			if (n > capacityData) {
+				sl_size capacity = capacityData ? capacityData * 2 : 4096;
+				if (capacity < n) {
+					capacity = n;
+				}
+				sl_uint8* p = (sl_uint8*)(Base::reallocMemory(data, capacity));
+				if (!p) {
+					return sl_false;
+				}
+				data = p;
+				capacityData = capacity;
+			}
+			Base::copyMemory(data + sizeData, buf, size);
+			cell.value = sizeData;
+			cell.size = (sl_uint32)size;
+			sizeData = n;
+			return sl_true;
+		}
+
+		sl_bool readCell(DatabaseCursor* cursor, sl_uint32 index, _priv_DatabaseResultSet_Cell& cell)
+		{
+			DatabaseColumnType type = cursor->getColumnType(index);
+			cell.type = (sl_uint32)type;
+			cell.value = 0;
+			cell.size = 0;
+			switch (type) {
+				case DatabaseColumnType::Integer:
+					cell.value = (sl_uint64)(cursor->getInt64(index));
+					return sl_true;
+				case DatabaseColumnType::UnsignedInteger:
+					cell.value = cursor->getUint64(index);
+					return sl_true;
+				case DatabaseColumnType::Float:
+					cell.valueDouble = cursor->getDouble(index);
+					return sl_true;
+				case DatabaseColumnType::Text:
+				case DatabaseColumnType::Blob:
+					{
+						sl_size size = 0;
+						const void* buf = cursor->getColumnData(index, &size);
+						if (buf) {
+							return addData(cell, buf, size);
+						}
+						if (type == DatabaseColumnType::Text) {
+							String s = cursor->getString(index);
+							return addData(cell, s.getData(), s.getLength());
+						} else {
+							Memory mem = cursor->getBlob(index);
+							return addData(cell, mem.getData(), mem.getSize());
+						}
+					}
+				default:
+					cell.type = (sl_uint32)(DatabaseColumnType::Null);
+					return sl_true;
+			}
+		}
+
+	};
+
+
+	SLIB_DEFINE_ROOT_OBJECT(DatabaseResultSet)
+
+	DatabaseResultSet::DatabaseResultSet()
+	{
+		m_nColumns = 0;
+		m_nRows = 0;
+		m_columnNames = sl_null;
+		m_cells = sl_null;
+		m_data = sl_null;
+	}
+
+	DatabaseResultSet::~DatabaseResultSet()
+	{
+		if (m_columnNames) {
+			NewHelper<String>::free(m_columnNames, m_nColumns);
+		}
+		if (m_cells) {
+			Base::freeMemory(m_cells);
+		}
+		if (m_data) {
+			Base::freeMemory(m_data);
+		}
+	}
+
+	Ref<DatabaseResultSet> DatabaseResultSet::create(DatabaseCursor* cursor)
+	{
+		if (!cursor) {
+			return sl_null;
+		}
+		sl_uint32 nColumns = cursor->getColumnsCount();
+		Ref<DatabaseResultSet> ret = new DatabaseResultSet;
+		if (ret.isNull()) {
+			return sl_null;
+		}
+		if (nColumns) {
+			ret->m_columnNames = NewHelper<String>::create(nColumns);
+			if (!(ret->m_columnNames)) {
+				return sl_null;
+			}
+			ret->m_nColumns = nColumns;
+			for (sl_uint32 i = 0; i < nColumns; i++) {
+				String name = cursor->getColumnName(i);
+				ret->m_columnNames[i] = name;
+				ret->m_mapColumnIndexes.put_NoLock(name, i);
+			}
+		}
+		_priv_DatabaseResultSet_Builder builder(nColumns);
+		while (cursor->moveNext()) {
+			if (!nColumns) {
+				continue;
+			}
+			_priv_DatabaseResultSet_Cell* row = builder.addRow();
+			if (!row) {
+				return sl_null;
+			}
+			for (sl_uint32 i = 0; i < nColumns; i++) {
+				if (!(builder.readCell(cursor, i, row[i]))) {
+					return sl_null;
+				}
+			}
+		}
+		sl_size nRows = builder.nRows;
+		if (nRows) {
+			// transpose to column-major
+			_priv_DatabaseResultSet_Cell* cells = (_priv_DatabaseResultSet_Cell*)(Base::createMemory(nRows * nColumns * sizeof(_priv_DatabaseResultSet_Cell)));
+			if (!cells) {
+				return sl_null;
+			}
+			for (sl_uint32 iCol = 0; iCol < nColumns; iCol++) {
+				_priv_DatabaseResultSet_Cell* dst = cells + iCol * nRows;
+				_priv_DatabaseResultSet_Cell* src = builder.cells + iCol;
+				for (sl_size iRow = 0; iRow < nRows; iRow++) {
+					dst[iRow] = *src;
+					src += nColumns;
+				}
+			}
+			ret->m_cells = cells;
+			ret->m_nRows = nRows;
+			ret->m_data = builder.data;
+			builder.data = sl_null;
+		}
+		return ret;
+	}
+
+	sl_uint32 DatabaseResultSet::getColumnsCount()
+	{
+		return m_nColumns;
+	}
+
+	String DatabaseResultSet::getColumnName(sl_uint32 index)
+	{
+		if (index < m_nColumns) {
+			return m_columnNames[index];
+		}
+		return sl_null;
+	}
+
+	sl_int32 DatabaseResultSet::getColumnIndex(const String& name)
+	{
+		return m_mapColumnIndexes.getValue_NoLock(name, -1);
+	}
+
+	sl_size DatabaseResultSet::getRowsCount()
+	{
+		return m_nRows;
+	}
+
+#define PRIV_GET_CELL \
+	if (row >= m_nRows || column >= m_nColumns) { \
+		return defaultValue; \
+	} \
+	_priv_DatabaseResultSet_Cell& cell = m_cells[column * m_nRows + row];
+
+	DatabaseColumnType DatabaseResultSet::getType(sl_size row, sl_uint32 column)
+	{
+		DatabaseColumnType defaultValue = DatabaseColumnType::Null;
+		PRIV_GET_CELL
+		return (DatabaseColumnType)(cell.type);
+	}
+
+	sl_bool DatabaseResultSet::isNull(sl_size row, sl_uint32 column)
+	{
+		return getType(row, column) == DatabaseColumnType::Null;
+	}
+
+	Variant DatabaseResultSet::getValue(sl_size row, sl_uint32 column)
+	{
+		Variant defaultValue;
+		PRIV_GET_CELL
+		switch ((DatabaseColumnType)(cell.type)) {
+			case DatabaseColumnType::Integer:
+				{
+					sl_int64 v64 = (sl_int64)(cell.value);
+					sl_int32 v32 = (sl_int32)v64;
+					if (v64 == v32) {
+						return v32;
+					} else {
+						return v64;
+					}
+				}
+			case DatabaseColumnType::UnsignedInteger:
+				{
+					sl_uint64 v64 = cell.value;
+					sl_uint32 v32 = (sl_uint32)v64;
+					if (v64 == v32) {
+						return v32;
+					} else {
+						return v64;
+					}
+				}
+			case DatabaseColumnType::Float:
+				return cell.valueDouble;
+			case DatabaseColumnType::Text:
+				return String::fromUtf8(m_data + cell.value, cell.size);
+			case DatabaseColumnType::Blob:
+				return Memory::create(m_data + cell.value, cell.size);
+			default:
+				break;
+		}
+		return sl_null;
+	}
+
+	sl_int64 DatabaseResultSet::getInt64(sl_size row, sl_uint32 column, sl_int64 defaultValue)
+	{
+		PRIV_GET_CELL
+		switch ((DatabaseColumnType)(cell.type)) {
+			case DatabaseColumnType::Integer:
+			case DatabaseColumnType::UnsignedInteger:
+				return (sl_int64)(cell.value);
+			case DatabaseColumnType::Float:
+				return (sl_int64)(cell.valueDouble);
+			case DatabaseColumnType::Text:
+				{
+					sl_int64 v;
+					if (String::parseInt64(10, &v, (sl_char8*)(m_data + cell.value), 0, cell.size) == (sl_reg)(cell.size)) {
+						return v;
+					}
+				}
+				break;
+			default:
+				break;
+		}
+		return defaultValue;
+	}
+
+	sl_uint64 DatabaseResultSet::getUint64(sl_size row, sl_uint32 column, sl_uint64 defaultValue)
+	{
+		PRIV_GET_CELL
+		switch ((DatabaseColumnType)(cell.type)) {
+			case DatabaseColumnType::Integer:
+			case DatabaseColumnType::UnsignedInteger:
+				return cell.value;
+			case DatabaseColumnType::Float:
+				return (sl_uint64)(cell.valueDouble);
+			case DatabaseColumnType::Text:
+				{
+					sl_uint64 v;
+					if (String::parseUint64(10, &v, (sl_char8*)(m_data + cell.value), 0, cell.size) == (sl_reg)(cell.size)) {
+						return v;
+					}
+				}
+				break;
+			default:
+				break;
+		}
+		return defaultValue;
+	}
+
+	sl_int32 DatabaseResultSet::getInt32(sl_size row, sl_uint32 column, sl_int32 defaultValue)
+	{
+		return (sl_int32)(getInt64(row, column, defaultValue));
+	}
+
+	sl_uint32 DatabaseResultSet::getUint32(sl_size row, sl_uint32 column, sl_uint32 defaultValue)
+	{
+		return (sl_uint32)(getUint64(row, column, defaultValue));
+	}
+
+	float DatabaseResultSet::getFloat(sl_size row, sl_uint32 column, float defaultValue)
+	{
+		return (float)(getDouble(row, column, defaultValue));
+	}
+
+	double DatabaseResultSet::getDouble(sl_size row, sl_uint32 column, double defaultValue)
+	{
+		PRIV_GET_CELL
+		switch ((DatabaseColumnType)(cell.type)) {
+			case DatabaseColumnType::Integer:
+				return (double)((sl_int64)(cell.value));
+			case DatabaseColumnType::UnsignedInteger:
+				return (double)(cell.value);
+			case DatabaseColumnType::Float:
+				return cell.valueDouble;
+			case DatabaseColumnType::Text:
+				{
+					double v;
+					if (String::parseDouble(&v, (sl_char8*)(m_data + cell.value), 0, cell.size) == (sl_reg)(cell.size)) {
+						return v;
+					}
+				}
+				break;
+			default:
+				break;
+		}
+		return defaultValue;
+	}
+
+	String DatabaseResultSet::getString(sl_size row, sl_uint32 column)
+	{
+		String defaultValue;
+		PRIV_GET_CELL
+		switch ((DatabaseColumnType)(cell.type)) {
+			case DatabaseColumnType::Integer:
+				return String::fromInt64((sl_int64)(cell.value));
+			case DatabaseColumnType::UnsignedInteger:
+				return String::fromUint64(cell.value);
+			case DatabaseColumnType::Float:
+				return String::fromDouble(cell.valueDouble);
+			case DatabaseColumnType::Text:
+				return String::fromUtf8(m_data + cell.value, cell.size);
+			default:
+				break;
+		}
+		return sl_null;
+	}
+
+	const sl_char8* DatabaseResultSet::getStringData(sl_size row, sl_uint32 column, sl_size* outLength)
+	{
+		const sl_char8* defaultValue = sl_null;
+		PRIV_GET_CELL
+		if ((DatabaseColumnType)(cell.type) == DatabaseColumnType::Text) {
+			if (outLength) {
+				*outLength = cell.size;
+			}
+			return (sl_char8*)(m_data + cell.value);
+		}
+		return sl_null;
+	}
+
+	Memory DatabaseResultSet::getBlob(sl_size row, sl_uint32 column)
+	{
+		sl_size size;
+		const void* data = getBlobData(row, column, &size);
+		if (data && size) {
+			return Memory::create(data, size);
+		}
+		return sl_null;
+	}
+
+	const void* DatabaseResultSet::getBlobData(sl_size row, sl_uint32 column, sl_size* outSize)
+	{
+		const void* defaultValue = sl_null;
+		PRIV_GET_CELL
+		DatabaseColumnType type = (DatabaseColumnType)(cell.type);
+		if (type == DatabaseColumnType::Text || type == DatabaseColumnType::Blob) {
+			if (outSize) {
+				*outSize = cell.size;
+			}
+			return m_data + cell.value;
+		}
+		return sl_null;
+	}
+
+	HashMap<String, Variant> DatabaseResultSet::getRow(sl_size row)
+	{
+		HashMap<String, Variant> ret;
+		if (row < m_nRows) {
+			for (sl_uint32 i = 0; i < m_nColumns; i++) {
+				ret.put_NoLock(m_columnNames[i], getValue(row, i));
+			}
+		}
+		return ret;
+	}
+
+}
@@ -10,9 +10,26 @@
 
 #include "slib/db/database.h"
 
+#include "slib/core/scoped.h"
+#include "slib/core/time.h"
+
 namespace slib
 {
 
+	DatabaseBatchParam::DatabaseBatchParam()
+	{
+		params = sl_null;
+		countColumns = 0;
+		countRows = 0;
+		rowsPerBatch = 10000;
+		flagTransaction = sl_true;
+	}
+
+	DatabaseBatchParam::~DatabaseBatchParam()
+	{
+	}
+
+
 	SLIB_DEFINE_OBJECT(DatabaseStatement, Object)
 
 	DatabaseStatement::DatabaseStatement()
@@ -28,6 +45,111 @@ namespace slib
 		return m_db;
 	}
 
+	sl_int64 DatabaseStatement::executeRows(const Variant* params, sl_uint32 nParamsPerRow, sl_size nRows)
+	{
+		sl_int64 nTotal = 0;
+		for (sl_size i = 0; i < nRows; i++) {
+			sl_int64 n = executeBy(params, nParamsPerRow);
+			if (n < 0) {
+				return -1;
+			}
+			nTotal += n;
+			params += nParamsPerRow;
+		}
+		return nTotal;
+	}
+
+	sl_int64 DatabaseStatement::executeBatch(const DatabaseBatchParam& param)
+	{
+		Ref<Database> db = m_db;
+		if (db.isNull()) {
+			return -1;
+		}
+		if (!(param.params) && param.onGetRow.isNull()) {
+			return -1;
+		}
+		sl_uint32 nColumns = param.countColumns;
+		sl_size nRowsPerBatch = param.rowsPerBatch;
+		if (!nRowsPerBatch) {
+			nRowsPerBatch = 10000;
+		}
+		if (param.params && nRowsPerBatch > param.countRows) {
+			nRowsPerBatch = param.countRows;
+		}
+		// the rows of a batch are gathered in row-major order
+		SLIB_SCOPED_ARRAY(Variant, rows, nRowsPerBatch * nColumns)
+		if (nRowsPerBatch && nColumns && !rows) {
+			return -1;
+		}
+		
+		sl_int64 nTotal = 0;
+		sl_size nCompletedRows = 0;
+		sl_bool flagEnd = sl_false;
+		while (!flagEnd) {
+			TimeCounter t;
+			sl_size nRows = 0;
+			if (param.params) {
+				nRows = param.countRows - nCompletedRows;
+				if (nRows > nRowsPerBatch) {
+					nRows = nRowsPerBatch;
+				}
+				Variant* row = rows;
+				for (sl_size i = 0; i < nRows; i++) {
+					const Variant* src = param.params + (nCompletedRows + i);
+					for (sl_uint32 k = 0; k < nColumns; k++) {
+						row[k] = *src;
+						src += param.countRows;
+					}
+					row += nColumns;
+				}
+				if (nCompletedRows + nRows >= param.countRows) {
+					flagEnd = sl_true;
+				}
+			} else {
+				while (nRows < nRowsPerBatch) {
+					if (!(param.onGetRow(rows + nRows * nColumns))) {
+						flagEnd = sl_true;
+						break;
+					}
+					nRows++;
+				}
+			}
+			if (!nRows) {
+				break;
+			}
+			sl_int64 n;
+			{
+				// other threads can't run their statements in the middle of the transaction.
+				// the rows are gathered before locking, so `onGetRow` may use the database
+				ObjectLocker lock(db.get());
+				if (param.flagTransaction) {
+					if (!(db->startTransaction())) {
+						return -1;
+					}
+				}
+				n = executeRows(rows, nColumns, nRows);
+				if (n < 0) {
+					if (param.flagTransaction) {
+						db->rollbackTransaction();
+					}
+					return -1;
+				}
+				if (param.flagTransaction) {
+					if (!(db->commitTransaction())) {
+						db->rollbackTransaction();
+						return -1;
+					}
+				}
+			}
+			nTotal += n;
+			nCompletedRows += nRows;
+			if (param.onBatchCompleted.isNotNull()) {
+				param.onBatchCompleted(nCompletedRows, nRows, t.getElapsedMilliseconds());
+			}
+		}
+		return nTotal;
+	}
+
 	List< HashMap<String, Variant> > DatabaseStatement::getListForQueryResultBy(const Variant* params, sl_uint32 nParams)
 	{
 		List< HashMap<String, Variant> > ret;
@@ -52,6 +174,15 @@ namespace slib
 		return sl_null;
 	}
 
+	Ref<DatabaseResultSet> DatabaseStatement::getResultSetBy(const Variant* params, sl_uint32 nParams)
+	{
+		Ref<DatabaseCursor> cursor = queryBy(params, nParams);
+		if (cursor.isNotNull()) {
+			return DatabaseResultSet::create(cursor.get());
+		}
+		return sl_null;
+	}
+
 	Variant DatabaseStatement::getValueForQueryResultBy(const Variant* params, sl_uint32 nParams)
 	{
 		Ref<DatabaseCursor> cursor = queryBy(params, nParams);
@@ -0,0 +1,143 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef CHECKHEADER_SLIB_DB_DATABASE_STATEMENT_CACHE
+#define CHECKHEADER_SLIB_DB_DATABASE_STATEMENT_CACHE
+
+#include "slib/db/definition.h"
+
+#include "slib/core/string.h"
+#include "slib/core/flat_hash_map.h"
+
+#define SLIB_DATABASE_STATEMENT_CACHE_SIZE 64
+
+/*
+	LRU cache of the prepared statement handles of a connection, keyed by SQL text
+
+	A handle is taken out of the cache while a statement object is using it,
+	and is returned by the statement object when it is destroyed.
+	So a cached handle is never shared by two statement objects.
+	The cache is not thread-safe; it is accessed while the connection is locked.
+*/
+
+namespace slib
+{
+
+	template <class T, class FREE>
+	class _priv_DatabaseStatementCache
+	{
+	private:
+		struct Item
+		{
+			String sql;
+			T handle;
+			Item* before;
+			Item* after;
+		};
+
+	public:
+		_priv_DatabaseStatementCache(sl_uint32 capacity = SLIB_DATABASE_STATEMENT_CACHE_SIZE)
+		{
+			m_first = sl_null;
+			m_last = sl_null;
+			m_capacity = capacity;
+		}
+
+		~_priv_DatabaseStatementCache()
+		{
+			clear();
+		}
+
+	public:
+		sl_bool pop(const String& sql, T* _out)
+		{
+			Item* item;
+			if (m_map.remove(sql, &item)) {
+				_unlink(item);
+				*_out = item->handle;
+				delete item;
+				return sl_true;
+			}
+			return sl_false;
+		}
+
+		void push(const String& sql, T handle)
+		{
+			if (m_capacity && sql.isNotEmpty() && !(m_map.find(sql))) {
+				Item* item = new Item;
+				if (item) {
+					item->sql = sql;
+					item->handle = handle;
+					if (m_map.put(sql, item)) {
+						item->before = sl_null;
+						item->after = m_first;
+						if (m_first) {
+							m_first->before = item;
+						} else {
+							m_last = item;
+						}
+						m_first = item;
+						while (m_map.getCount() > m_capacity) {
+							Item* last = m_last;
+							m_map.remove(last->sql);
+							_unlink(last);
+							m_free(last->handle);
+							delete last;
+						}
+						return;
+					}
+					delete item;
+				}
+			}
+			m_free(handle);
+		}
+
+		void clear()
+		{
+			Item* item = m_first;
+			while (item) {
+				Item* next = item->after;
+				m_free(item->handle);
+				delete item;
+				item = next;
+			}
+			m_first = sl_null;
+			m_last = sl_null;
+			m_map.removeAll();
+		}
+
+	private:
+		void _unlink(Item* item)
+		{
+			if (item->before) {
+				item->before->after = item->after;
+			} else {
+				m_first = item->after;
+			}
+			if (item->after) {
+				item->after->before = item->before;
+			} else {
+				m_last = item->before;
+			}
+		}
+
+	private:
+		FlatHashMap<String, Item*> m_map;
+		// most recently returned first
+		Item* m_first;
+		Item* m_last;
+		sl_uint32 m_capacity;
+		FREE m_free;
+
+	};
+
+}
+
+#endif
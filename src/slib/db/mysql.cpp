@@ -19,6 +19,9 @@
 #include "slib/core/scoped.h"
 #include "slib/core/log.h"
 #include "slib/core/safe_static.h"
+#include "slib/core/string_buffer.h"
+
+#include "database_statement_cache.h"
 
 #define TAG "MySQL"
 
@@ -97,10 +100,112 @@ namespace slib
 		}
 	}
 
+	class _priv_MySQL_CloseStatement
+	{
+	public:
+		void operator()(MYSQL_STMT* statement)
+		{
+			::mysql_stmt_close(statement);
+		}
+	};
+
+	/*
+		Finds the parameter tuple of `INSERT ... VALUES (...)` (also `REPLACE`), which is at the end of the statement.
+		Such statements are packed into multi-row statements (`VALUES (...),(...),...`) when executing many rows.
+	*/
+	static sl_bool _priv_MySQL_findInsertValuesTuple(const String& sql, sl_size& outPos, sl_size& outLength)
+	{
+		const sl_char8* s = sql.getData();
+		sl_size len = sql.getLength();
+		sl_size pos = 0;
+		while (pos < len && SLIB_CHAR_IS_WHITE_SPACE(s[pos])) {
+			pos++;
+		}
+		static const char* keywords[] = {"insert", "replace"};
+		sl_bool flagInsert = sl_false;
+		for (sl_size k = 0; k < 2 && !flagInsert; k++) {
+			const char* keyword = keywords[k];
+			sl_size i = 0;
+			while (keyword[i] && pos + i < len && SLIB_CHAR_UPPER_TO_LOWER(s[pos + i]) == keyword[i]) {
+				i++;
+			}
+			if (!(keyword[i]) && pos + i < len && SLIB_CHAR_IS_WHITE_SPACE(s[pos + i])) {
+				flagInsert = sl_true;
+			}
+		}
+		if (!flagInsert) {
+			return sl_false;
+		}
+		// finds the last top-level parenthesized group
+		sl_size posOpen = 0;
+		sl_size posLastOpen = 0;
+		sl_size posLastClose = 0;
+		sl_bool flagGroup = sl_false;
+		sl_size depth = 0;
+		sl_char8 quote = 0;
+		for (sl_size i = pos; i < len; i++) {
+			sl_char8 ch = s[i];
+			if (quote) {
+				if (ch == '\\') {
+					i++;
+				} else if (ch == quote) {
+					quote = 0;
+				}
+			} else if (ch == '\'' || ch == '"' || ch == '`') {
+				quote = ch;
+			} else if (ch == '(') {
+				if (!depth) {
+					posOpen = i;
+				}
+				depth++;
+			} else if (ch == ')') {
+				if (!depth) {
+					return sl_false;
+				}
+				depth--;
+				if (!depth) {
+					posLastOpen = posOpen;
+					posLastClose = i;
+					flagGroup = sl_true;
+				}
+			}
+		}
+		if (!flagGroup || depth || quote) {
+			return sl_false;
+		}
+		for (sl_size i = posLastClose + 1; i < len; i++) {
+			if (!(SLIB_CHAR_IS_WHITE_SPACE(s[i]) || s[i] == ';')) {
+				return sl_false;
+			}
+		}
+		// the group should follow `VALUES`
+		sl_size i = posLastOpen;
+		while (i > 0 && SLIB_CHAR_IS_WHITE_SPACE(s[i - 1])) {
+			i--;
+		}
+		if (i < 7) {
+			return sl_false;
+		}
+		const char* keyword = "values";
+		for (sl_size k = 0; k < 6; k++) {
+			if (SLIB_CHAR_UPPER_TO_LOWER(s[i - 6 + k]) != keyword[k]) {
+				return sl_false;
+			}
+		}
+		sl_char8 ch = s[i - 7];
+		if (!(SLIB_CHAR_IS_WHITE_SPACE(ch) || ch == ')')) {
+			return sl_false;
+		}
+		outPos = posLastOpen;
+		outLength = posLastClose + 1 - posLastOpen;
+		return sl_true;
+	}
+
 	class _priv_MySQL_Database : public MySQL_Database
 	{
 	public:
 		MYSQL* m_mysql;
+		_priv_DatabaseStatementCache<MYSQL_STMT*, _priv_MySQL_CloseStatement> m_cachedStatements;
 
 	public:
 		_priv_MySQL_Database()
@@ -110,6 +215,7 @@ namespace slib
 
 		~_priv_MySQL_Database()
 		{
+			m_cachedStatements.clear();
 			::mysql_close(m_mysql);
 		}
 
@@ -290,6 +396,95 @@ namespace slib
 				return sl_null;
 			}
 
+			sl_int64 getInt64(sl_uint32 index, sl_int64 defaultValue) override
+			{
+				if (m_row) {
+					if (index < m_nColumnNames && m_row[index]) {
+						sl_int64 v;
+						sl_size n = (sl_size)(m_lengths[index]);
+						if (String::parseInt64(10, &v, m_row[index], 0, n) == (sl_reg)n) {
+							return v;
+						}
+					}
+				}
+				return defaultValue;
+			}
+
+			sl_uint64 getUint64(sl_uint32 index, sl_uint64 defaultValue) override
+			{
+				if (m_row) {
+					if (index < m_nColumnNames && m_row[index]) {
+						sl_uint64 v;
+						sl_size n = (sl_size)(m_lengths[index]);
+						if (String::parseUint64(10, &v, m_row[index], 0, n) == (sl_reg)n) {
+							return v;
+						}
+					}
+				}
+				return defaultValue;
+			}
+
+			double getDouble(sl_uint32 index, double defaultValue) override
+			{
+				if (m_row) {
+					if (index < m_nColumnNames && m_row[index]) {
+						double v;
+						sl_size n = (sl_size)(m_lengths[index]);
+						if (String::parseDouble(&v, m_row[index], 0, n) == (sl_reg)n) {
+							return v;
+						}
+					}
+				}
+				return defaultValue;
+			}
+
+			DatabaseColumnType getColumnType(sl_uint32 index) override
+			{
+				if (m_row) {
+					if (index < m_nColumnNames && m_row[index]) {
+						switch (m_fields[index].type) {
+						case MYSQL_TYPE_LONGLONG:
+							if (m_fields[index].flags & UNSIGNED_FLAG) {
+								return DatabaseColumnType::UnsignedInteger;
+							}
+							return DatabaseColumnType::Integer;
+						case MYSQL_TYPE_TINY:
+						case MYSQL_TYPE_SHORT:
+						case MYSQL_TYPE_INT24:
+						case MYSQL_TYPE_LONG:
+						case MYSQL_TYPE_YEAR:
+							return DatabaseColumnType::Integer;
+						case MYSQL_TYPE_FLOAT:
+						case MYSQL_TYPE_DOUBLE:
+							return DatabaseColumnType::Float;
+						case MYSQL_TYPE_TINY_BLOB:
+						case MYSQL_TYPE_MEDIUM_BLOB:
+						case MYSQL_TYPE_LONG_BLOB:
+						case MYSQL_TYPE_BLOB:
+							// 63: binary character set
+							if (m_fields[index].charsetnr == 63) {
+								return DatabaseColumnType::Blob;
+							}
+							return DatabaseColumnType::Text;
+						default:
+							return DatabaseColumnType::Text;
+						}
+					}
+				}
+				return DatabaseColumnType::Null;
+			}
+
+			const void* getColumnData(sl_uint32 index, sl_size* outSize) override
+			{
+				if (m_row) {
+					if (index < m_nColumnNames && m_row[index]) {
+						*outSize = (sl_size)(m_lengths[index]);
+						return m_row[index];
+					}
+				}
+				return sl_null;
+			}
+
 			sl_bool moveNext() override
 			{
 				m_row = ::mysql_fetch_row(m_result);
@@ -854,6 +1049,45 @@ namespace slib
 				return sl_null;
 			}
 
+			DatabaseColumnType getColumnType(sl_uint32 index) override
+			{
+				if (index < m_nColumnNames) {
+					if (!(m_fds[index].isNull)) {
+						switch (m_bind[index].buffer_type) {
+						case MYSQL_TYPE_LONGLONG:
+							if (m_bind[index].is_unsigned) {
+								return DatabaseColumnType::UnsignedInteger;
+							}
+							return DatabaseColumnType::Integer;
+						case MYSQL_TYPE_LONG:
+							return DatabaseColumnType::Integer;
+						case MYSQL_TYPE_FLOAT:
+						case MYSQL_TYPE_DOUBLE:
+							return DatabaseColumnType::Float;
+						case MYSQL_TYPE_BLOB:
+							return DatabaseColumnType::Blob;
+						default:
+							return DatabaseColumnType::Text;
+						}
+					}
+				}
+				return DatabaseColumnType::Null;
+			}
+
+			const void* getColumnData(sl_uint32 index, sl_size* outSize) override
+			{
+				if (index < m_nColumnNames) {
+					if (!(m_fds[index].isNull) && !(m_fds[index].isError)) {
+						enum_field_types type = m_bind[index].buffer_type;
+						if (type == MYSQL_TYPE_STRING || type == MYSQL_TYPE_BLOB) {
+							*outSize = (sl_size)(m_fds[index].length);
+							return m_fds[index].buf;
+						}
+					}
+				}
+				return sl_null;
+			}
+
 			sl_bool moveNext() override
 			{
 				int iRet = ::mysql_stmt_fetch(m_statement);
@@ -873,17 +1107,23 @@ namespace slib
 			MYSQL_STMT* m_statement;
 
 		public:
-			_priv_DatabaseStatement(_priv_MySQL_Database* db, const String& sql)
+			_priv_DatabaseStatement(_priv_MySQL_Database* db, const String& sql, MYSQL_STMT* statement)
 			{
 				m_db = db;
 				m_sql = sql;
 				m_mysql = db->m_mysql;
-				m_statement = sl_null;
+				m_statement = statement;
 			}
 
 			~_priv_DatabaseStatement()
 			{
-				close();
+				_priv_MySQL_Database* db = (_priv_MySQL_Database*)(m_db.get());
+				ObjectLocker lock(db);
+				if (m_statement) {
+					// keeps the prepared statement in the connection for the next use
+					db->m_cachedStatements.push(m_sql, m_statement);
+					m_statement = sl_null;
+				}
 			}
 
 			sl_bool prepare()
@@ -1048,6 +1288,56 @@ namespace slib
 				return -1;
 			}
 
+// limit of the placeholders in a statement
+#define PRIV_MAX_PACKED_PARAMS 65535
+#define PRIV_MAX_PACKED_ROWS 1000
+
+			sl_int64 executeRows(const Variant* params, sl_uint32 nParamsPerRow, sl_size nRows) override
+			{
+				initThread();
+				ObjectLocker lock(m_db.get());
+				sl_size posTuple, lenTuple;
+				if (nRows < 2 || !nParamsPerRow || nParamsPerRow * 2 > PRIV_MAX_PACKED_PARAMS || !(_priv_MySQL_findInsertValuesTuple(m_sql, posTuple, lenTuple))) {
+					return DatabaseStatement::executeRows(params, nParamsPerRow, nRows);
+				}
+				sl_size nMaxRows = PRIV_MAX_PACKED_PARAMS / nParamsPerRow;
+				if (nMaxRows > PRIV_MAX_PACKED_ROWS) {
+					nMaxRows = PRIV_MAX_PACKED_ROWS;
+				}
+				const sl_char8* sql = m_sql.getData();
+				sl_int64 nTotal = 0;
+				while (nRows > 0) {
+					sl_size n = nRows;
+					if (n > nMaxRows) {
+						n = nMaxRows;
+					}
+					Ref<DatabaseStatement> statement;
+					if (n > 1) {
+						StringBuffer sb;
+						sb.addStatic(sql, posTuple + lenTuple);
+						for (sl_size i = 1; i < n; i++) {
+							sb.addStatic(",", 1);
+							sb.addStatic(sql + posTuple, lenTuple);
+						}
+						// the packed statements are also kept in the statement cache of the connection
+						statement = m_db->prepareStatement(sb.merge());
+						if (statement.isNull()) {
+							return -1;
+						}
+					} else {
+						statement = this;
+					}
+					sl_int64 nRet = statement->executeBy(params, (sl_uint32)(n * nParamsPerRow));
+					if (nRet < 0) {
+						return -1;
+					}
+					nTotal += nRet;
+					params += n * nParamsPerRow;
+					nRows -= n;
+				}
+				return nTotal;
+			}
+
 			Ref<DatabaseCursor> queryBy(const Variant* params, sl_uint32 nParams) override
 			{
 				initThread();
@@ -1152,7 +1442,22 @@ namespace slib
 		{
 			initThread();
 			ObjectLocker lock(this);
-			Ref<_priv_DatabaseStatement> ret = new _priv_DatabaseStatement(this, sql);
+			MYSQL_STMT* statement;
+			if (m_cachedStatements.pop(sql, &statement)) {
+				// discards the pending result set and the long data of the last use, keeping the prepared statement
+				::mysql_stmt_free_result(statement);
+				if (0 == ::mysql_stmt_reset(statement)) {
+					Ref<_priv_DatabaseStatement> ret = new _priv_DatabaseStatement(this, sql, statement);
+					if (ret.isNotNull()) {
+						return ret;
+					}
+					::mysql_stmt_close(statement);
+					return sl_null;
+				}
+				// the statement is no longer valid on the server (e.g. reconnected), so it is prepared again
+				::mysql_stmt_close(statement);
+			}
+			Ref<_priv_DatabaseStatement> ret = new _priv_DatabaseStatement(this, sql, sl_null);
 			if (ret.isNotNull()) {
 				if (ret->prepare()) {
 					return ret;
@@ -1178,6 +1483,16 @@ namespace slib
 		return connect(param, err);
 	}
 
+	Ref<DatabasePool> MySQL_Database::createPool(const MySQL_Param& _param, sl_uint32 maxConnections)
+	{
+		DatabasePoolParam param;
+		param.connect = [_param]() -> Ref<Database> {
+			return MySQL_Database::connect(_param);
+		};
+		param.maxConnections = maxConnections;
+		return DatabasePool::create(param);
+	}
+
 }
 
 #endif
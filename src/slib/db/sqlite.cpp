@@ -14,6 +14,8 @@
 
 #include "slib/core/file.h"
 
+#include "database_statement_cache.h"
+
 namespace slib
 {	
 
@@ -27,10 +29,20 @@ namespace slib
 	{
 	}
 
+	class _priv_Sqlite3_FinalizeStatement
+	{
+	public:
+		void operator()(sqlite3_stmt* statement)
+		{
+			::sqlite3_finalize(statement);
+		}
+	};
+
 	class _priv_Sqlite3Database : public SQLiteDatabase
 	{
 	public:
 		sqlite3* m_db;
+		_priv_DatabaseStatementCache<sqlite3_stmt*, _priv_Sqlite3_FinalizeStatement> m_cachedStatements;
 
 		_priv_Sqlite3Database()
 		{
@@ -39,6 +51,7 @@ namespace slib
 
 		~_priv_Sqlite3Database()
 		{
+			m_cachedStatements.clear();
 			::sqlite3_close(m_db);
 		}
 
@@ -60,9 +73,57 @@ namespace slib
 			return ret;
 		}
 
+		// `outFlagSingle`: whether `sql` contains only one statement. Only single statements are cached
+		sqlite3_stmt* _prepare(const String& sql, sl_bool* outFlagSingle)
+		{
+			sqlite3_stmt* statement;
+			if (m_cachedStatements.pop(sql, &statement)) {
+				*outFlagSingle = sl_true;
+				return statement;
+			}
+			statement = sl_null;
+			const char* tail = sl_null;
+			if (SQLITE_OK == ::sqlite3_prepare_v2(m_db, sql.getData(), (int)(sql.getLength()), &statement, &tail)) {
+				if (statement) {
+					sl_bool flagSingle = sl_true;
+					if (tail) {
+						while (*tail) {
+							char c = *tail;
+							if (c != ' ' && c != '\t' && c != '\r' && c != '\n' && c != ';') {
+								flagSingle = sl_false;
+								break;
+							}
+							tail++;
+						}
+					}
+					*outFlagSingle = flagSingle;
+					return statement;
+				}
+			}
+			return sl_null;
+		}
+
 		sl_int64 execute(const String& sql) override
 		{
 			ObjectLocker lock(this);
+			sl_bool flagSingle = sl_false;
+			sqlite3_stmt* statement = _prepare(sql, &flagSingle);
+			if (statement) {
+				if (flagSingle) {
+					int iRet = ::sqlite3_step(statement);
+					while (iRet == SQLITE_ROW) {
+						iRet = ::sqlite3_step(statement);
+					}
+					::sqlite3_reset(statement);
+					m_cachedStatements.push(sql, statement);
+					if (iRet == SQLITE_DONE) {
+						return ::sqlite3_changes(m_db);
+					}
+					return -1;
+				}
+				::sqlite3_finalize(statement);
+			}
+			// multiple statements
 			char* zErrMsg = 0;
 			if (SQLITE_OK == ::sqlite3_exec(m_db, sql.getData(), 0, 0, &zErrMsg)) {
 				return ::sqlite3_changes(m_db);
@@ -72,16 +133,6 @@ namespace slib
 			return -1;
 		}
 
-		static HashMap<String, Variant> _getRow(sqlite3_stmt* stmt, String* columns, sl_uint32 nColumns)
-		{
-			HashMap<String, Variant> row;
-			for (sl_uint32 cIndex = 0; cIndex < nColumns; cIndex++) {
-				String cValue = String::fromUtf8(::sqlite3_column_text(stmt, (int)cIndex));
-				row.put_NoLock(columns[cIndex], cValue);
-			}
-			return row;
-		}
-
 		class _priv_DatabaseCursor : public DatabaseCursor
 		{
 		public:
@@ -201,6 +252,43 @@ namespace slib
 				return sl_null;
 			}
 
+			DatabaseColumnType getColumnType(sl_uint32 index) override
+			{
+				if (index < m_nColumnNames) {
+					int type = ::sqlite3_column_type(m_statement, index);
+					switch (type) {
+					case SQLITE_INTEGER:
+						return DatabaseColumnType::Integer;
+					case SQLITE_FLOAT:
+						return DatabaseColumnType::Float;
+					case SQLITE_TEXT:
+						return DatabaseColumnType::Text;
+					case SQLITE_BLOB:
+						return DatabaseColumnType::Blob;
+					}
+				}
+				return DatabaseColumnType::Null;
+			}
+
+			const void* getColumnData(sl_uint32 index, sl_size* outSize) override
+			{
+				if (index < m_nColumnNames) {
+					int type = ::sqlite3_column_type(m_statement, index);
+					const void* buf;
+					if (type == SQLITE_TEXT) {
+						buf = ::sqlite3_column_text(m_statement, index);
+					} else if (type == SQLITE_BLOB) {
+						buf = ::sqlite3_column_blob(m_statement, index);
+					} else {
+						return sl_null;
+					}
+					// empty blob is returned as null pointer
+					*outSize = (sl_size)(::sqlite3_column_bytes(m_statement, index));
+					return buf ? buf : "";
+				}
+				return sl_null;
+			}
+
 			String getString(sl_uint32 index) override
 			{
 				if (index < m_nColumnNames) {
@@ -342,18 +430,67 @@ namespace slib
 		public:
 			sqlite3* m_sqlite;
 			sqlite3_stmt* m_statement;
+			// null for the statements not to be cached
+			String m_sql;
 			Array<Variant> m_boundParams;
 
-			_priv_DatabaseStatement(_priv_Sqlite3Database* db, sqlite3_stmt* statement)
+			_priv_DatabaseStatement(_priv_Sqlite3Database* db, sqlite3_stmt* statement, const String& sql)
 			{
 				m_db = db;
 				m_sqlite = db->m_db;
 				m_statement = statement;
+				m_sql = sql;
 			}
 
 			~_priv_DatabaseStatement()
 			{
-				::sqlite3_finalize(m_statement);
+				if (m_sql.isNotNull()) {
+					_priv_Sqlite3Database* db = (_priv_Sqlite3Database*)(m_db.get());
+					ObjectLocker lock(db);
+					::sqlite3_reset(m_statement);
+					::sqlite3_clear_bindings(m_statement);
+					db->m_cachedStatements.push(m_sql, m_statement);
+				} else {
+					::sqlite3_finalize(m_statement);
+				}
+			}
+
+			// the texts and blobs of `var` are bound without copying, so `var` should be kept until the statement is reset
+			int _bindParam(sl_uint32 i, const Variant& var)
+			{
+				switch (var.getType()) {
+				case VariantType::Null:
+					return ::sqlite3_bind_null(m_statement, i + 1);
+				case VariantType::Boolean:
+				case VariantType::Int32:
+					return ::sqlite3_bind_int(m_statement, i + 1, var.getInt32());
+				case VariantType::Uint32:
+				case VariantType::Int64:
+				case VariantType::Uint64:
+					return ::sqlite3_bind_int64(m_statement, i + 1, var.getInt64());
+				case VariantType::Float:
+				case VariantType::Double:
+					return ::sqlite3_bind_double(m_statement, i + 1, var.getDouble());
+				case VariantType::String8:
+					{
+						// shares the buffer of `var`
+						String str = var.getString();
+						return ::sqlite3_bind_text(m_statement, i + 1, str.getData(), (sl_uint32)(str.getLength()), SQLITE_STATIC);
+					}
+				default:
+					if (var.isMemory()) {
+						Memory mem = var.getMemory();
+						sl_size size = mem.getSize();
+						if (size > 0x7fffffff) {
+							return ::sqlite3_bind_blob64(m_statement, i + 1, mem.getData(), size, SQLITE_STATIC);
+						} else {
+							return ::sqlite3_bind_blob(m_statement, i + 1, mem.getData(), (sl_uint32)size, SQLITE_STATIC);
+						}
+					} else {
+						String str = var.getString();
+						return ::sqlite3_bind_text(m_statement, i + 1, str.getData(), (sl_uint32)(str.getLength()), SQLITE_TRANSIENT);
+					}
+				}
 			}
 
 			sl_bool _execute(const Variant* _params, sl_uint32 nParams)
@@ -374,40 +511,7 @@ namespace slib
 				if (n == nParams) {
 					if (n > 0) {
 						for (sl_uint32 i = 0; i < n; i++) {
-							int iRet = SQLITE_ABORT;
-							Variant& var = (params.getData())[i];
-							switch (var.getType()) {
-							case VariantType::Null:
-								iRet = ::sqlite3_bind_null(m_statement, i);
-								break;
-							case VariantType::Boolean:
-							case VariantType::Int32:
-								iRet = ::sqlite3_bind_int(m_statement, i, var.getInt32());
-								break;
-							case VariantType::Uint32:
-							case VariantType::Int64:
-							case VariantType::Uint64:
-								iRet = ::sqlite3_bind_int64(m_statement, i, var.getInt64());
-								break;
-							case VariantType::Float:
-							case VariantType::Double:
-								iRet = ::sqlite3_bind_double(m_statement, i, var.getDouble());
-								break;
-							default:
-								if (var.isMemory()) {
-									Memory mem = var.getMemory();
-									sl_size size = mem.getSize();
-									if (size > 0x7fffffff) {
-										iRet = ::sqlite3_bind_blob64(m_statement, i, mem.getData(), size, SQLITE_STATIC);
-									} else {
-										iRet = ::sqlite3_bind_blob(m_statement, i, mem.getData(), (sl_uint32)size, SQLITE_STATIC);
-									}
-								} else {
-									String str = var.getString();
-									var = str;
-									iRet = ::sqlite3_bind_text(m_statement, i, str.getData(), (sl_uint32)(str.getLength()), SQLITE_STATIC);
-								}
-							}
+							int iRet = _bindParam(i, (params.getData())[i]);
 							if (iRet != SQLITE_OK) {
 								return sl_false;
 							}
@@ -432,6 +536,37 @@ namespace slib
 				return -1;
 			}
 
+			sl_int64 executeRows(const Variant* params, sl_uint32 nParamsPerRow, sl_size nRows) override
+			{
+				ObjectLocker lock(m_db.get());
+				::sqlite3_reset(m_statement);
+				::sqlite3_clear_bindings(m_statement);
+				m_boundParams.setNull();
+				if ((sl_uint32)(::sqlite3_bind_parameter_count(m_statement)) != nParamsPerRow) {
+					return -1;
+				}
+				// binds the parameters directly, without copying each row into a new array
+				sl_int64 nTotal = 0;
+				for (sl_size iRow = 0; iRow < nRows; iRow++) {
+					for (sl_uint32 i = 0; i < nParamsPerRow; i++) {
+						if (_bindParam(i, params[i]) != SQLITE_OK) {
+							::sqlite3_clear_bindings(m_statement);
+							return -1;
+						}
+					}
+					int iRet = ::sqlite3_step(m_statement);
+					::sqlite3_reset(m_statement);
+					if (iRet != SQLITE_DONE) {
+						::sqlite3_clear_bindings(m_statement);
+						return -1;
+					}
+					nTotal += ::sqlite3_changes(m_sqlite);
+					params += nParamsPerRow;
+				}
+				::sqlite3_clear_bindings(m_statement);
+				return nTotal;
+			}
+
 			Ref<DatabaseCursor> queryBy(const Variant* params, sl_uint32 nParams) override
 			{
 				ObjectLocker lock(m_db.get());
@@ -452,9 +587,10 @@ namespace slib
 		{
 			ObjectLocker lock(this);
 			Ref<DatabaseStatement> ret;
-			sqlite3_stmt* statement = sl_null;
-			if (SQLITE_OK == ::sqlite3_prepare_v2(m_db, sql.getData(), -1, &statement, sl_null)) {
-				ret = new _priv_DatabaseStatement(this, statement);
+			sl_bool flagSingle = sl_false;
+			sqlite3_stmt* statement = _prepare(sql, &flagSingle);
+			if (statement) {
+				ret = new _priv_DatabaseStatement(this, statement, flagSingle ? sql : String::null());
 				if (ret.isNotNull()) {
 					return ret;
 				}
@@ -474,4 +610,33 @@ namespace slib
 		return _priv_Sqlite3Database::connect(path);
 	}
 
+	static Ref<Database> _priv_Sqlite3Database_connectPool(const String& path, sl_bool flagReader)
+	{
+		Ref<_priv_Sqlite3Database> db = _priv_Sqlite3Database::connect(path);
+		if (db.isNotNull()) {
+			// waits for the lock held by other connections instead of failing with SQLITE_BUSY
+			::sqlite3_busy_timeout(db->m_db, 5000);
+			// readers do not block the writer in WAL mode (the mode is persistent in the file)
+			db->execute("PRAGMA journal_mode=WAL");
+			if (flagReader) {
+				db->execute("PRAGMA query_only=1");
+			}
+		}
+		return db;
+	}
+
+	Ref<DatabasePool> SQLiteDatabase::createPool(const String& path, sl_uint32 maxReaders)
+	{
+		DatabasePoolParam param;
+		param.connect = [path]() {
+			return _priv_Sqlite3Database_connectPool(path, sl_false);
+		};
+		param.maxConnections = 1;
+		param.connectReader = [path]() {
+			return _priv_Sqlite3Database_connectPool(path, sl_true);
+		};
+		param.maxReaders = maxReaders;
+		return DatabasePool::create(param);
+	}
+
 }
@@ -15,6 +15,10 @@
 namespace slib
 {
 
+	sl_bool _priv_BitmapData_convertPixels(sl_uint32 width, sl_uint32 height, BitmapFormat src_format, sl_uint8** src_planes, sl_int32* src_pitches, BitmapFormat dst_format, sl_uint8** dst_planes, sl_int32* dst_pitches);
+	sl_bool _priv_BitmapData_convertPixels_YUV420ToPacked(sl_uint32 width, sl_uint32 height, BitmapData& src, BitmapFormat dst_format, sl_uint8* dst, sl_int32 dst_pitch);
+	sl_bool _priv_BitmapData_convertPixels_PackedToYUV420(sl_uint32 width, sl_uint32 height, BitmapFormat src_format, sl_uint8* src, sl_int32 src_pitch, BitmapData& dst);
+
 	ColorComponentBuffer::ColorComponentBuffer()
 	{
 		width = 0;
@@ -784,8 +788,8 @@ namespace slib
 		{
 			sl_uint8* p = p0;
 			sl_uint32 s = r >> 3;
-			s = (s << 5) | (g >> 2);
-			s = (s << 6) | (b >> 3);
+			s = (s << 6) | (g >> 2);
+			s = (s << 5) | (b >> 3);
 			p[0] = (sl_uint8)(s >> 8);
 			p[1] = (sl_uint8)(s);
 			p0 += 2;
@@ -811,8 +815,8 @@ namespace slib
 		{
 			sl_uint8* p = p0;
 			sl_uint32 s = r >> 3;
-			s = (s << 5) | (g >> 2);
-			s = (s << 6) | (b >> 3);
+			s = (s << 6) | (g >> 2);
+			s = (s << 5) | (b >> 3);
 			p[1] = (sl_uint8)(s >> 8);
 			p[0] = (sl_uint8)(s);
 			p0 += 2;
@@ -838,8 +842,8 @@ namespace slib
 		{
 			sl_uint8* p = p0;
 			sl_uint32 s = b >> 3;
-			s = (s << 5) | (g >> 2);
-			s = (s << 6) | (r >> 3);
+			s = (s << 6) | (g >> 2);
+			s = (s << 5) | (r >> 3);
 			p[0] = (sl_uint8)(s >> 8);
 			p[1] = (sl_uint8)(s);
 			p0 += 2;
@@ -865,8 +869,8 @@ namespace slib
 		{
 			sl_uint8* p = p0;
 			sl_uint32 s = b >> 3;
-			s = (s << 5) | (g >> 2);
-			s = (s << 6) | (r >> 3);
+			s = (s << 6) | (g >> 2);
+			s = (s << 5) | (r >> 3);
 			p[1] = (sl_uint8)(s >> 8);
 			p[0] = (sl_uint8)(s);
 			p0 += 2;
@@ -1861,7 +1865,9 @@ namespace slib
 					_priv_BitmapData_copyPixels_YUV420ToYUV(width, height, src, dst.format, dst_planes, dst_pitches);
 				} else {
 					// yuv420 -> other normal
-					_priv_BitmapData_copyPixels_YUV420ToOther(width, height, src, dst.format, dst_planes, dst_pitches);
+					if (!(_priv_BitmapData_convertPixels_YUV420ToPacked(width, height, src, dst.format, dst_planes[0], dst_pitches[0]))) {
+						_priv_BitmapData_copyPixels_YUV420ToOther(width, height, src, dst.format, dst_planes, dst_pitches);
+					}
 				}
 			}
 		} else {
@@ -1871,7 +1877,9 @@ namespace slib
 					_priv_BitmapData_copyPixels_YUVToYUV420(width, height, src.format, src_planes, src_pitches, dst);
 				} else {
 					// other normal -> yuv420
-					_priv_BitmapData_copyPixels_OtherToYUV420(width, height, src.format, src_planes, src_pitches, dst);
+					if (!(_priv_BitmapData_convertPixels_PackedToYUV420(width, height, src.format, src_planes[0], src_pitches[0], dst))) {
+						_priv_BitmapData_copyPixels_OtherToYUV420(width, height, src.format, src_planes, src_pitches, dst);
+					}
 				}
 			} else {
 				// normal -> normal
@@ -1890,19 +1898,15 @@ namespace slib
 						sl_uint8* sr = (sl_uint8*)(src_planes[iPlane]);
 						sl_uint8* dr = (sl_uint8*)(dst_planes[iPlane]);
 						for (sl_uint32 i = 0; i < height; i++) {
-							sl_uint8* ss = sr;
-							sl_uint8* ds = dr;
-							for (sl_uint32 j = 0; j < row_size; j++) {
-								*ds = *ss;
-								ss++;
-								ds++;
-							}
+							Base::copyMemory(dr, sr, row_size);
 							sr += src_pitches[iPlane];
 							dr += dst_pitches[iPlane];
 						}
 					}
 				} else {
-					_priv_BitmapData_copyPixels_Normal(width, height, src.format, src_planes, src_pitches, dst.format, dst_planes, dst_pitches);
+					if (!(_priv_BitmapData_convertPixels(width, height, src.format, src_planes, src_pitches, dst.format, dst_planes, dst_pitches))) {
+						_priv_BitmapData_copyPixels_Normal(width, height, src.format, src_planes, src_pitches, dst.format, dst_planes, dst_pitches);
+					}
 				}
 			}
 		}
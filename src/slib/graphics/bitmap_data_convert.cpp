@@ -0,0 +1,697 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "slib/graphics/bitmap_data.h"
+
+#include "slib/graphics/yuv.h"
+
+#include "graphics_simd.h"
+
+/*
+	Row kernels of `BitmapData::copyPixelsFrom()` for the common format pairs
+
+	- between RGBA, BGRA, ARGB, ABGR (straight or premultiplied alpha), RGB565 and BGR565 (LE/BE)
+	- YUV420 (I420, YV12, NV12, NV21) to RGBA, BGRA, ARGB, ABGR
+	- RGBA, BGRA, ARGB, ABGR to YUV420
+
+	The kernels produce exactly the same samples as the generic per-pixel procedures,
+	and return false for the other pairs (or on the CPUs without SSE4.1), to fall back to the generic path.
+*/
+
+#define PRIV_BITMAP_CONVERT_KIND_32 0
+#define PRIV_BITMAP_CONVERT_KIND_565LE 1
+#define PRIV_BITMAP_CONVERT_KIND_565BE 2
+
+#define PRIV_BITMAP_CONVERT_OP_NONE 0
+#define PRIV_BITMAP_CONVERT_OP_PREMULTIPLY 1
+#define PRIV_BITMAP_CONVERT_OP_UNPREMULTIPLY 2
+
+// same as YUV::convertYUVToRGB()
+#define PRIV_BITMAP_CONVERT_YG 18997
+#define PRIV_BITMAP_CONVERT_BB (-128 * 128 - 1160)
+#define PRIV_BITMAP_CONVERT_BG (25 * 128 + 52 * 128 - 1160)
+#define PRIV_BITMAP_CONVERT_BR (-102 * 128 - 1160)
+
+namespace slib
+{
+
+	class _priv_BitmapConvert_Layout
+	{
+	public:
+		sl_uint32 kind;
+		sl_bool flagPA;
+		// byte offsets of R, G, B, A in the pixel (16-bit pixels are unpacked to 32-bit, by the order of the components)
+		sl_uint8 pos[4];
+
+	public:
+		sl_bool init(BitmapFormat format)
+		{
+			kind = PRIV_BITMAP_CONVERT_KIND_32;
+			flagPA = BitmapFormats::isPrecomputedAlpha(format);
+			switch (format) {
+				case BitmapFormat::RGBA:
+				case BitmapFormat::RGBA_PA:
+					_set(0, 1, 2, 3);
+					return sl_true;
+				case BitmapFormat::BGRA:
+				case BitmapFormat::BGRA_PA:
+					_set(2, 1, 0, 3);
+					return sl_true;
+				case BitmapFormat::ARGB:
+				case BitmapFormat::ARGB_PA:
+					_set(1, 2, 3, 0);
+					return sl_true;
+				case BitmapFormat::ABGR:
+				case BitmapFormat::ABGR_PA:
+					_set(3, 2, 1, 0);
+					return sl_true;
+				case BitmapFormat::RGB565LE:
+					kind = PRIV_BITMAP_CONVERT_KIND_565LE;
+					_set(0, 1, 2, 3);
+					return sl_true;
+				case BitmapFormat::RGB565BE:
+					kind = PRIV_BITMAP_CONVERT_KIND_565BE;
+					_set(0, 1, 2, 3);
+					return sl_true;
+				case BitmapFormat::BGR565LE:
+					kind = PRIV_BITMAP_CONVERT_KIND_565LE;
+					_set(2, 1, 0, 3);
+					return sl_true;
+				case BitmapFormat::BGR565BE:
+					kind = PRIV_BITMAP_CONVERT_KIND_565BE;
+					_set(2, 1, 0, 3);
+					return sl_true;
+				default:
+					break;
+			}
+			return sl_false;
+		}
+
+	private:
+		void _set(sl_uint8 r, sl_uint8 g, sl_uint8 b, sl_uint8 a)
+		{
+			pos[0] = r;
+			pos[1] = g;
+			pos[2] = b;
+			pos[3] = a;
+		}
+
+	};
+
+	class _priv_BitmapConvert_Param
+	{
+	public:
+		sl_uint32 op;
+		_priv_BitmapConvert_Layout src;
+		_priv_BitmapConvert_Layout dst;
+		// source pixels -> RGBA (or directly to target pixels when `op` is none)
+		sl_uint8 shuffleSrc[16];
+		// RGBA -> target pixels
+		sl_uint8 shuffleDst[16];
+
+	public:
+		void prepareShuffles()
+		{
+			for (sl_uint32 i = 0; i < 16; i += 4) {
+				for (sl_uint32 k = 0; k < 4; k++) {
+					if (op == PRIV_BITMAP_CONVERT_OP_NONE) {
+						shuffleSrc[i + dst.pos[k]] = (sl_uint8)(i + src.pos[k]);
+					} else {
+						shuffleSrc[i + k] = (sl_uint8)(i + src.pos[k]);
+					}
+					shuffleDst[i + dst.pos[k]] = (sl_uint8)(i + k);
+				}
+			}
+		}
+
+	};
+
+
+	static void _priv_BitmapConvert_packedRow(sl_uint8* dst, const sl_uint8* src, sl_uint32 width, const _priv_BitmapConvert_Param& param)
+	{
+		for (sl_uint32 i = 0; i < width; i++) {
+			sl_uint8 t[4];
+			if (param.src.kind == PRIV_BITMAP_CONVERT_KIND_32) {
+				t[0] = src[0];
+				t[1] = src[1];
+				t[2] = src[2];
+				t[3] = src[3];
+				src += 4;
+			} else {
+				sl_uint32 s;
+				if (param.src.kind == PRIV_BITMAP_CONVERT_KIND_565LE) {
+					s = src[0] | ((sl_uint32)(src[1]) << 8);
+				} else {
+					s = src[1] | ((sl_uint32)(src[0]) << 8);
+				}
+				t[0] = (sl_uint8)((s & 0xF800) >> 8);
+				t[1] = (sl_uint8)((s & 0x07E0) >> 3);
+				t[2] = (sl_uint8)((s & 0x001F) << 3);
+				t[3] = 255;
+				src += 2;
+			}
+			Color c(t[param.src.pos[0]], t[param.src.pos[1]], t[param.src.pos[2]], t[param.src.pos[3]]);
+			if (param.op == PRIV_BITMAP_CONVERT_OP_PREMULTIPLY) {
+				c.convertNPAtoPA();
+			} else if (param.op == PRIV_BITMAP_CONVERT_OP_UNPREMULTIPLY) {
+				c.convertPAtoNPA();
+			}
+			t[param.dst.pos[0]] = c.r;
+			t[param.dst.pos[1]] = c.g;
+			t[param.dst.pos[2]] = c.b;
+			t[param.dst.pos[3]] = c.a;
+			if (param.dst.kind == PRIV_BITMAP_CONVERT_KIND_32) {
+				dst[0] = t[0];
+				dst[1] = t[1];
+				dst[2] = t[2];
+				dst[3] = t[3];
+				dst += 4;
+			} else {
+				sl_uint32 s = ((sl_uint32)(t[0] >> 3) << 11) | ((sl_uint32)(t[1] >> 2) << 5) | (t[2] >> 3);
+				if (param.dst.kind == PRIV_BITMAP_CONVERT_KIND_565LE) {
+					dst[0] = (sl_uint8)s;
+					dst[1] = (sl_uint8)(s >> 8);
+				} else {
+					dst[0] = (sl_uint8)(s >> 8);
+					dst[1] = (sl_uint8)s;
+				}
+				dst += 2;
+			}
+		}
+	}
+
+	static void _priv_BitmapConvert_yuv420ToPackedRow(sl_uint8* dst, const sl_uint8* y, const sl_uint8* u, const sl_uint8* v, sl_uint32 strideUV, sl_uint32 width, const _priv_BitmapConvert_Param& param)
+	{
+		sl_uint8 t[4];
+		t[3] = 255;
+		for (sl_uint32 i = 0; i < width; i++) {
+			sl_uint32 k = (i >> 1) * strideUV;
+			YUV::convertYUVToRGB(y[i], u[k], v[k], t[0], t[1], t[2]);
+			dst[param.dst.pos[0]] = t[0];
+			dst[param.dst.pos[1]] = t[1];
+			dst[param.dst.pos[2]] = t[2];
+			dst[param.dst.pos[3]] = t[3];
+			dst += 4;
+		}
+	}
+
+	static void _priv_BitmapConvert_packedToYUV420Rows(sl_uint8* y0, sl_uint8* y1, sl_uint8* u, sl_uint8* v, sl_uint32 strideUV, const sl_uint8* src0, const sl_uint8* src1, sl_uint32 width, const _priv_BitmapConvert_Param& param)
+	{
+		sl_uint32 R = param.src.pos[0];
+		sl_uint32 G = param.src.pos[1];
+		sl_uint32 B = param.src.pos[2];
+		sl_uint8 U, V;
+		for (sl_uint32 i = 0; i < width; i += 2) {
+			sl_uint32 TU = 0;
+			sl_uint32 TV = 0;
+			YUV::convertRGBToYUV(src0[R], src0[G], src0[B], y0[i], U, V);
+			TU += U;
+			TV += V;
+			YUV::convertRGBToYUV(src0[4 + R], src0[4 + G], src0[4 + B], y0[i + 1], U, V);
+			TU += U;
+			TV += V;
+			YUV::convertRGBToYUV(src1[R], src1[G], src1[B], y1[i], U, V);
+			TU += U;
+			TV += V;
+			YUV::convertRGBToYUV(src1[4 + R], src1[4 + G], src1[4 + B], y1[i + 1], U, V);
+			TU += U;
+			TV += V;
+			*u = (sl_uint8)(TU >> 2);
+			*v = (sl_uint8)(TV >> 2);
+			u += strideUV;
+			v += strideUV;
+			src0 += 8;
+			src1 += 8;
+		}
+	}
+
+#if defined(PRIV_GRAPHICS_SUPPORT_SIMD)
+
+	PRIV_GRAPHICS_SSE41_FUNC
+	static __m128i _priv_BitmapConvert_premultiply_SSE41(__m128i p)
+	{
+		__m128i zero = _mm_setzero_si128();
+		__m128i one = _mm_set1_epi16(1);
+		__m128i lo = _mm_unpacklo_epi8(p, zero);
+		__m128i hi = _mm_unpackhi_epi8(p, zero);
+		__m128i alo = _mm_add_epi16(_mm_shufflehi_epi16(_mm_shufflelo_epi16(lo, 0xFF), 0xFF), one);
+		__m128i ahi = _mm_add_epi16(_mm_shufflehi_epi16(_mm_shufflelo_epi16(hi, 0xFF), 0xFF), one);
+		// (c * (a + 1)) >> 8, keeping the alpha
+		__m128i rlo = _mm_blend_epi16(_mm_srli_epi16(_mm_mullo_epi16(lo, alo), 8), lo, 0x88);
+		__m128i rhi = _mm_blend_epi16(_mm_srli_epi16(_mm_mullo_epi16(hi, ahi), 8), hi, 0x88);
+		return _mm_packus_epi16(rlo, rhi);
+	}
+
+	PRIV_GRAPHICS_SSE41_FUNC
+	static __m128i _priv_BitmapConvert_unpremultiplyPixel_SSE41(__m128i p)
+	{
+		__m128i c = _mm_cvtepu8_epi32(p);
+		__m128 f = _mm_cvtepi32_ps(c);
+		__m128 a = _mm_add_ps(_mm_shuffle_ps(f, f, 0xFF), _mm_set1_ps(1.0f));
+		// (c << 8) / (a + 1): the quotient of the exact operands is correctly rounded, and is never rounded up to the next integer
+		__m128i q = _mm_cvttps_epi32(_mm_div_ps(_mm_mul_ps(f, _mm_set1_ps(256.0f)), a));
+		q = _mm_min_epi32(q, _mm_set1_epi32(255));
+		return _mm_blend_epi16(q, c, 0xC0);
+	}
+
+	PRIV_GRAPHICS_SSE41_FUNC
+	static __m128i _priv_BitmapConvert_unpremultiply_SSE41(__m128i p)
+	{
+		__m128i q0 = _priv_BitmapConvert_unpremultiplyPixel_SSE41(p);
+		__m128i q1 = _priv_BitmapConvert_unpremultiplyPixel_SSE41(_mm_srli_si128(p, 4));
+		__m128i q2 = _priv_BitmapConvert_unpremultiplyPixel_SSE41(_mm_srli_si128(p, 8));
+		__m128i q3 = _priv_BitmapConvert_unpremultiplyPixel_SSE41(_mm_srli_si128(p, 12));
+		return _mm_packus_epi16(_mm_packus_epi32(q0, q1), _mm_packus_epi32(q2, q3));
+	}
+
+	template <sl_uint32 SRC_KIND, sl_uint32 DST_KIND, sl_uint32 OP>
+	PRIV_GRAPHICS_SSE41_FUNC
+	static void _priv_BitmapConvert_packedRow_SSE41(sl_uint8* dst, const sl_uint8* src, sl_uint32 width, const _priv_BitmapConvert_Param& param)
+	{
+		__m128i shuffleSrc = _mm_loadu_si128((const __m128i*)(param.shuffleSrc));
+		__m128i shuffleDst = _mm_loadu_si128((const __m128i*)(param.shuffleDst));
+		__m128i swap16 = _mm_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14);
+		sl_uint32 n = width >> 2;
+		for (sl_uint32 i = 0; i < n; i++) {
+			__m128i p;
+			if (SRC_KIND == PRIV_BITMAP_CONVERT_KIND_32) {
+				p = _mm_loadu_si128((const __m128i*)src);
+				src += 16;
+			} else {
+				__m128i s = _mm_loadl_epi64((const __m128i*)src);
+				if (SRC_KIND == PRIV_BITMAP_CONVERT_KIND_565BE) {
+					s = _mm_shuffle_epi8(s, swap16);
+				}
+				s = _mm_cvtepu16_epi32(s);
+				p = _mm_and_si128(_mm_srli_epi32(s, 8), _mm_set1_epi32(0xF8));
+				p = _mm_or_si128(p, _mm_and_si128(_mm_slli_epi32(s, 5), _mm_set1_epi32(0xFC00)));
+				p = _mm_or_si128(p, _mm_and_si128(_mm_slli_epi32(s, 19), _mm_set1_epi32(0xF80000)));
+				p = _mm_or_si128(p, _mm_set1_epi32((sl_int32)0xFF000000));
+				src += 8;
+			}
+			p = _mm_shuffle_epi8(p, shuffleSrc);
+			if (OP == PRIV_BITMAP_CONVERT_OP_PREMULTIPLY) {
+				p = _mm_shuffle_epi8(_priv_BitmapConvert_premultiply_SSE41(p), shuffleDst);
+			} else if (OP == PRIV_BITMAP_CONVERT_OP_UNPREMULTIPLY) {
+				p = _mm_shuffle_epi8(_priv_BitmapConvert_unpremultiply_SSE41(p), shuffleDst);
+			}
+			if (DST_KIND == PRIV_BITMAP_CONVERT_KIND_32) {
+				_mm_storeu_si128((__m128i*)dst, p);
+				dst += 16;
+			} else {
+				__m128i s = _mm_and_si128(_mm_slli_epi32(p, 8), _mm_set1_epi32(0xF800));
+				s = _mm_or_si128(s, _mm_and_si128(_mm_srli_epi32(p, 5), _mm_set1_epi32(0x07E0)));
+				s = _mm_or_si128(s, _mm_and_si128(_mm_srli_epi32(p, 19), _mm_set1_epi32(0x001F)));
+				s = _mm_packus_epi32(s, s);
+				if (DST_KIND == PRIV_BITMAP_CONVERT_KIND_565BE) {
+					s = _mm_shuffle_epi8(s, swap16);
+				}
+				_mm_storel_epi64((__m128i*)dst, s);
+				dst += 8;
+			}
+		}
+		_priv_BitmapConvert_packedRow(dst, src, width & 3, param);
+	}
+
+	typedef void (*_priv_BitmapConvert_PackedRowFunc)(sl_uint8* dst, const sl_uint8* src, sl_uint32 width, const _priv_BitmapConvert_Param& param);
+
+	template <sl_uint32 SRC_KIND, sl_uint32 DST_KIND>
+	static _priv_BitmapConvert_PackedRowFunc _priv_BitmapConvert_getPackedRow_SSE41(sl_uint32 op)
+	{
+		switch (op) {
+			case PRIV_BITMAP_CONVERT_OP_PREMULTIPLY:
+				return &(_priv_BitmapConvert_packedRow_SSE41<SRC_KIND, DST_KIND, PRIV_BITMAP_CONVERT_OP_PREMULTIPLY>);
+			case PRIV_BITMAP_CONVERT_OP_UNPREMULTIPLY:
+				return &(_priv_BitmapConvert_packedRow_SSE41<SRC_KIND, DST_KIND, PRIV_BITMAP_CONVERT_OP_UNPREMULTIPLY>);
+			default:
+				return &(_priv_BitmapConvert_packedRow_SSE41<SRC_KIND, DST_KIND, PRIV_BITMAP_CONVERT_OP_NONE>);
+		}
+	}
+
+	template <sl_uint32 SRC_KIND>
+	static _priv_BitmapConvert_PackedRowFunc _priv_BitmapConvert_getPackedRow_SSE41(sl_uint32 dstKind, sl_uint32 op)
+	{
+		switch (dstKind) {
+			case PRIV_BITMAP_CONVERT_KIND_565LE:
+				return _priv_BitmapConvert_getPackedRow_SSE41<SRC_KIND, PRIV_BITMAP_CONVERT_KIND_565LE>(op);
+			case PRIV_BITMAP_CONVERT_KIND_565BE:
+				return _priv_BitmapConvert_getPackedRow_SSE41<SRC_KIND, PRIV_BITMAP_CONVERT_KIND_565BE>(op);
+			default:
+				return _priv_BitmapConvert_getPackedRow_SSE41<SRC_KIND, PRIV_BITMAP_CONVERT_KIND_32>(op);
+		}
+	}
+
+	static _priv_BitmapConvert_PackedRowFunc _priv_BitmapConvert_getPackedRow_SSE41(sl_uint32 srcKind, sl_uint32 dstKind, sl_uint32 op)
+	{
+		switch (srcKind) {
+			case PRIV_BITMAP_CONVERT_KIND_565LE:
+				return _priv_BitmapConvert_getPackedRow_SSE41<PRIV_BITMAP_CONVERT_KIND_565LE>(dstKind, op);
+			case PRIV_BITMAP_CONVERT_KIND_565BE:
+				return _priv_BitmapConvert_getPackedRow_SSE41<PRIV_BITMAP_CONVERT_KIND_565BE>(dstKind, op);
+			default:
+				return _priv_BitmapConvert_getPackedRow_SSE41<PRIV_BITMAP_CONVERT_KIND_32>(dstKind, op);
+		}
+	}
+
+	// stores 8 pixels of the target order from 16-bit R, G, B samples
+	PRIV_GRAPHICS_SSE41_FUNC
+	static void _priv_BitmapConvert_storePixels_SSE41(sl_uint8* dst, __m128i R, __m128i G, __m128i B, const _priv_BitmapConvert_Param& param)
+	{
+		__m128i c[4];
+		c[param.dst.pos[0]] = _mm_packus_epi16(_mm_srai_epi16(R, 6), R);
+		c[param.dst.pos[1]] = _mm_packus_epi16(_mm_srai_epi16(G, 6), G);
+		c[param.dst.pos[2]] = _mm_packus_epi16(_mm_srai_epi16(B, 6), B);
+		c[param.dst.pos[3]] = _mm_set1_epi8((char)255);
+		__m128i t01 = _mm_unpacklo_epi8(c[0], c[1]);
+		__m128i t23 = _mm_unpacklo_epi8(c[2], c[3]);
+		_mm_storeu_si128((__m128i*)dst, _mm_unpacklo_epi16(t01, t23));
+		_mm_storeu_si128((__m128i*)(dst + 16), _mm_unpackhi_epi16(t01, t23));
+	}
+
+	PRIV_GRAPHICS_SSE41_FUNC
+	static void _priv_BitmapConvert_yuv420ToPackedRow_SSE41(sl_uint8* dst, const sl_uint8* y, const sl_uint8* u, const sl_uint8* v, sl_uint32 strideUV, sl_uint32 width, const _priv_BitmapConvert_Param& param)
+	{
+		__m128i yg = _mm_set1_epi16(PRIV_BITMAP_CONVERT_YG);
+		__m128i bb = _mm_set1_epi16(PRIV_BITMAP_CONVERT_BB);
+		__m128i bg = _mm_set1_epi16(PRIV_BITMAP_CONVERT_BG);
+		__m128i br = _mm_set1_epi16(PRIV_BITMAP_CONVERT_BR);
+		__m128i ug = _mm_set1_epi16(25);
+		__m128i vg = _mm_set1_epi16(52);
+		__m128i vr = _mm_set1_epi16(102);
+		__m128i zero = _mm_setzero_si128();
+		// duplicates the chroma samples for the 2 pixels
+		__m128i dupU, dupV;
+		if (strideUV == 1) {
+			dupU = dupV = _mm_setr_epi8(0, 0, 1, 1, 2, 2, 3, 3, -1, -1, -1, -1, -1, -1, -1, -1);
+		} else {
+			// loads the interleaved chroma from the first of U and V
+			char o = u < v ? 0 : 1;
+			dupU = _mm_setr_epi8(o, o, o + 2, o + 2, o + 4, o + 4, o + 6, o + 6, -1, -1, -1, -1, -1, -1, -1, -1);
+			o = 1 - o;
+			dupV = _mm_setr_epi8(o, o, o + 2, o + 2, o + 4, o + 4, o + 6, o + 6, -1, -1, -1, -1, -1, -1, -1, -1);
+		}
+		sl_uint32 n = width >> 3;
+		for (sl_uint32 i = 0; i < n; i++) {
+			__m128i U, V;
+			if (strideUV == 1) {
+				U = _mm_cvtsi32_si128(*((const sl_int32*)u));
+				V = _mm_cvtsi32_si128(*((const sl_int32*)v));
+				u += 4;
+				v += 4;
+			} else {
+				U = V = _mm_loadl_epi64((const __m128i*)(u < v ? u : v));
+				u += 8;
+				v += 8;
+			}
+			U = _mm_unpacklo_epi8(_mm_shuffle_epi8(U, dupU), zero);
+			V = _mm_unpacklo_epi8(_mm_shuffle_epi8(V, dupV), zero);
+			__m128i Y = _mm_loadl_epi64((const __m128i*)y);
+			// (y * 0x0101 * YG) >> 16
+			Y = _mm_mulhi_epu16(_mm_unpacklo_epi8(Y, Y), yg);
+			// saturation keeps the results over 255 (after shifting)
+			__m128i B = _mm_adds_epi16(_mm_add_epi16(bb, _mm_slli_epi16(U, 7)), Y);
+			__m128i G = _mm_add_epi16(_mm_sub_epi16(bg, _mm_add_epi16(_mm_mullo_epi16(V, vg), _mm_mullo_epi16(U, ug))), Y);
+			__m128i R = _mm_add_epi16(_mm_add_epi16(br, _mm_mullo_epi16(V, vr)), Y);
+			_priv_BitmapConvert_storePixels_SSE41(dst, R, G, B, param);
+			y += 8;
+			dst += 32;
+		}
+		if (width & 7) {
+			_priv_BitmapConvert_yuv420ToPackedRow(dst, y, u, v, strideUV, width & 7, param);
+		}
+	}
+
+	PRIV_GRAPHICS_AVX2_FUNC
+	static void _priv_BitmapConvert_yuv420ToPackedRow_AVX2(sl_uint8* dst, const sl_uint8* y, const sl_uint8* u, const sl_uint8* v, sl_uint32 strideUV, sl_uint32 width, const _priv_BitmapConvert_Param& param)
+	{
+		__m256i yg = _mm256_set1_epi16(PRIV_BITMAP_CONVERT_YG);
+		__m256i bb = _mm256_set1_epi16(PRIV_BITMAP_CONVERT_BB);
+		__m256i bg = _mm256_set1_epi16(PRIV_BITMAP_CONVERT_BG);
+		__m256i br = _mm256_set1_epi16(PRIV_BITMAP_CONVERT_BR);
+		__m256i ug = _mm256_set1_epi16(25);
+		__m256i vg = _mm256_set1_epi16(52);
+		__m256i vr = _mm256_set1_epi16(102);
+		__m128i dupU, dupV;
+		if (strideUV == 1) {
+			dupU = dupV = _mm_setr_epi8(0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7);
+		} else {
+			// loads the interleaved chroma from the first of U and V
+			char o = u < v ? 0 : 1;
+			dupU = _mm_setr_epi8(o, o, o + 2, o + 2, o + 4, o + 4, o + 6, o + 6, o + 8, o + 8, o + 10, o + 10, o + 12, o + 12, o + 14, o + 14);
+			o = 1 - o;
+			dupV = _mm_setr_epi8(o, o, o + 2, o + 2, o + 4, o + 4, o + 6, o + 6, o + 8, o + 8, o + 10, o + 10, o + 12, o + 12, o + 14, o + 14);
+		}
+		sl_uint32 posR = param.dst.pos[0];
+		sl_uint32 posG = param.dst.pos[1];
+		sl_uint32 posB = param.dst.pos[2];
+		sl_uint32 posA = param.dst.pos[3];
+		sl_uint32 n = width >> 4;
+		for (sl_uint32 i = 0; i < n; i++) {
+			__m128i u8, v8;
+			if (strideUV == 1) {
+				u8 = _mm_loadl_epi64((const __m128i*)u);
+				v8 = _mm_loadl_epi64((const __m128i*)v);
+				u += 8;
+				v += 8;
+			} else {
+				u8 = v8 = _mm_loadu_si128((const __m128i*)(u < v ? u : v));
+				u += 16;
+				v += 16;
+			}
+			__m256i U = _mm256_cvtepu8_epi16(_mm_shuffle_epi8(u8, dupU));
+			__m256i V = _mm256_cvtepu8_epi16(_mm_shuffle_epi8(v8, dupV));
+			__m256i Y = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)y));
+			Y = _mm256_mulhi_epu16(_mm256_or_si256(Y, _mm256_slli_epi16(Y, 8)), yg);
+			__m256i B = _mm256_adds_epi16(_mm256_add_epi16(bb, _mm256_slli_epi16(U, 7)), Y);
+			__m256i G = _mm256_add_epi16(_mm256_sub_epi16(bg, _mm256_add_epi16(_mm256_mullo_epi16(V, vg), _mm256_mullo_epi16(U, ug))), Y);
+			__m256i R = _mm256_add_epi16(_mm256_add_epi16(br, _mm256_mullo_epi16(V, vr)), Y);
+			__m256i c[4];
+			c[posR] = _mm256_packus_epi16(_mm256_srai_epi16(R, 6), R);
+			c[posG] = _mm256_packus_epi16(_mm256_srai_epi16(G, 6), G);
+			c[posB] = _mm256_packus_epi16(_mm256_srai_epi16(B, 6), B);
+			c[posA] = _mm256_set1_epi8((char)255);
+			// each 128-bit lane has 8 pixels
+			__m256i t01 = _mm256_unpacklo_epi8(c[0], c[1]);
+			__m256i t23 = _mm256_unpacklo_epi8(c[2], c[3]);
+			__m256i o0 = _mm256_unpacklo_epi16(t01, t23);
+			__m256i o1 = _mm256_unpackhi_epi16(t01, t23);
+			_mm256_storeu_si256((__m256i*)dst, _mm256_permute2x128_si256(o0, o1, 0x20));
+			_mm256_storeu_si256((__m256i*)(dst + 32), _mm256_permute2x128_si256(o0, o1, 0x31));
+			y += 16;
+			dst += 64;
+		}
+		if (width & 15) {
+			_priv_BitmapConvert_yuv420ToPackedRow_SSE41(dst, y, u, v, strideUV, width & 15, param);
+		}
+	}
+
+	// returns 4 samples (32-bit) of the 4 pixels, before shifting
+	PRIV_GRAPHICS_SSE41_FUNC
+	static __m128i _priv_BitmapConvert_dot_SSE41(__m128i lo, __m128i hi, __m128i coef)
+	{
+		return _mm_hadd_epi32(_mm_madd_epi16(lo, coef), _mm_madd_epi16(hi, coef));
+	}
+
+	PRIV_GRAPHICS_SSE41_FUNC
+	static void _priv_BitmapConvert_packedToYUV420Rows_SSE41(sl_uint8* y0, sl_uint8* y1, sl_uint8* u, sl_uint8* v, sl_uint32 strideUV, const sl_uint8* src0, const sl_uint8* src1, sl_uint32 width, const _priv_BitmapConvert_Param& param)
+	{
+		__m128i shuffle = _mm_loadu_si128((const __m128i*)(param.shuffleSrc));
+		__m128i cy = _mm_setr_epi16(66, 129, 25, 0, 66, 129, 25, 0);
+		__m128i cu = _mm_setr_epi16(-38, -74, 112, 0, -38, -74, 112, 0);
+		__m128i cv = _mm_setr_epi16(112, -94, -18, 0, 112, -94, -18, 0);
+		__m128i oy = _mm_set1_epi32(0x1080);
+		__m128i ouv = _mm_set1_epi32(0x8080);
+		__m128i zero = _mm_setzero_si128();
+		sl_uint32 n = width >> 3;
+		for (sl_uint32 i = 0; i < n; i++) {
+			__m128i su[2], sv[2];
+			for (sl_uint32 k = 0; k < 2; k++) {
+				__m128i Y[2];
+				for (sl_uint32 row = 0; row < 2; row++) {
+					const sl_uint8* s = (row ? src1 : src0) + (k << 4);
+					__m128i p = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)s), shuffle);
+					__m128i lo = _mm_cvtepu8_epi16(p);
+					__m128i hi = _mm_unpackhi_epi8(p, zero);
+					Y[row] = _mm_srli_epi32(_mm_add_epi32(_priv_BitmapConvert_dot_SSE41(lo, hi, cy), oy), 8);
+					__m128i U = _mm_srai_epi32(_mm_add_epi32(_priv_BitmapConvert_dot_SSE41(lo, hi, cu), ouv), 8);
+					__m128i V = _mm_srai_epi32(_mm_add_epi32(_priv_BitmapConvert_dot_SSE41(lo, hi, cv), ouv), 8);
+					if (row) {
+						su[k] = _mm_add_epi32(su[k], U);
+						sv[k] = _mm_add_epi32(sv[k], V);
+					} else {
+						su[k] = U;
+						sv[k] = V;
+					}
+				}
+				*((sl_int32*)(y0 + (k << 2))) = _mm_cvtsi128_si32(_mm_packus_epi16(_mm_packus_epi32(Y[0], Y[0]), zero));
+				*((sl_int32*)(y1 + (k << 2))) = _mm_cvtsi128_si32(_mm_packus_epi16(_mm_packus_epi32(Y[1], Y[1]), zero));
+			}
+			__m128i U = _mm_srli_epi32(_mm_hadd_epi32(su[0], su[1]), 2);
+			__m128i V = _mm_srli_epi32(_mm_hadd_epi32(sv[0], sv[1]), 2);
+			U = _mm_packus_epi16(_mm_packus_epi32(U, U), zero);
+			V = _mm_packus_epi16(_mm_packus_epi32(V, V), zero);
+			if (strideUV == 1) {
+				*((sl_int32*)u) = _mm_cvtsi128_si32(U);
+				*((sl_int32*)v) = _mm_cvtsi128_si32(V);
+				u += 4;
+				v += 4;
+			} else {
+				if (u < v) {
+					_mm_storel_epi64((__m128i*)u, _mm_unpacklo_epi8(U, V));
+				} else {
+					_mm_storel_epi64((__m128i*)v, _mm_unpacklo_epi8(V, U));
+				}
+				u += 8;
+				v += 8;
+			}
+			y0 += 8;
+			y1 += 8;
+			src0 += 32;
+			src1 += 32;
+		}
+		if (width & 7) {
+			_priv_BitmapConvert_packedToYUV420Rows(y0, y1, u, v, strideUV, src0, src1, width & 7, param);
+		}
+	}
+
+#endif
+
+	sl_bool _priv_BitmapData_convertPixels(sl_uint32 width, sl_uint32 height, BitmapFormat src_format, sl_uint8** src_planes, sl_int32* src_pitches, BitmapFormat dst_format, sl_uint8** dst_planes, sl_int32* dst_pitches)
+	{
+#if defined(PRIV_GRAPHICS_SUPPORT_SIMD)
+		if (!(_priv_Graphics_getSimdLevel())) {
+			return sl_false;
+		}
+		_priv_BitmapConvert_Param param;
+		if (!(param.src.init(src_format))) {
+			return sl_false;
+		}
+		if (!(param.dst.init(dst_format))) {
+			return sl_false;
+		}
+		param.op = PRIV_BITMAP_CONVERT_OP_NONE;
+		if (param.src.flagPA != param.dst.flagPA) {
+			if (param.src.flagPA) {
+				param.op = PRIV_BITMAP_CONVERT_OP_UNPREMULTIPLY;
+			} else {
+				param.op = PRIV_BITMAP_CONVERT_OP_PREMULTIPLY;
+			}
+		}
+		param.prepareShuffles();
+		_priv_BitmapConvert_PackedRowFunc func = _priv_BitmapConvert_getPackedRow_SSE41(param.src.kind, param.dst.kind, param.op);
+		sl_uint8* src = src_planes[0];
+		sl_uint8* dst = dst_planes[0];
+		for (sl_uint32 i = 0; i < height; i++) {
+			func(dst, src, width, param);
+			src += src_pitches[0];
+			dst += dst_pitches[0];
+		}
+		return sl_true;
+#else
+		return sl_false;
+#endif
+	}
+
+	sl_bool _priv_BitmapData_convertPixels_YUV420ToPacked(sl_uint32 width, sl_uint32 height, BitmapData& src, BitmapFormat dst_format, sl_uint8* dst, sl_int32 dst_pitch)
+	{
+#if defined(PRIV_GRAPHICS_SUPPORT_SIMD)
+		sl_uint32 level = _priv_Graphics_getSimdLevel();
+		if (!level) {
+			return sl_false;
+		}
+		_priv_BitmapConvert_Param param;
+		if (!(param.dst.init(dst_format))) {
+			return sl_false;
+		}
+		// premultiplied colors are same as the straight colors on the opaque pixels
+		if (param.dst.kind != PRIV_BITMAP_CONVERT_KIND_32) {
+			return sl_false;
+		}
+		ColorComponentBuffer src_cb[3];
+		if (src.getColorComponentBuffers(src_cb) != 3) {
+			return sl_false;
+		}
+		sl_uint32 strideUV = src_cb[1].sample_stride;
+		if (src_cb[2].sample_stride != (sl_int32)strideUV || (strideUV != 1 && strideUV != 2)) {
+			return sl_false;
+		}
+		if (strideUV == 2 && src_cb[1].pitch != src_cb[2].pitch) {
+			return sl_false;
+		}
+		sl_uint8* sry = (sl_uint8*)(src_cb[0].data);
+		sl_uint8* sru = (sl_uint8*)(src_cb[1].data);
+		sl_uint8* srv = (sl_uint8*)(src_cb[2].data);
+		if (strideUV == 2 && sru + 1 != srv && srv + 1 != sru) {
+			return sl_false;
+		}
+		for (sl_uint32 i = 0; i < height; i++) {
+			sl_uint32 k = i >> 1;
+			sl_uint8* u = sru + (sl_reg)(src_cb[1].pitch) * k;
+			sl_uint8* v = srv + (sl_reg)(src_cb[2].pitch) * k;
+			if (level >= 2) {
+				_priv_BitmapConvert_yuv420ToPackedRow_AVX2(dst, sry, u, v, strideUV, width, param);
+			} else {
+				_priv_BitmapConvert_yuv420ToPackedRow_SSE41(dst, sry, u, v, strideUV, width, param);
+			}
+			sry += src_cb[0].pitch;
+			dst += dst_pitch;
+		}
+		return sl_true;
+#else
+		return sl_false;
+#endif
+	}
+
+	sl_bool _priv_BitmapData_convertPixels_PackedToYUV420(sl_uint32 width, sl_uint32 height, BitmapFormat src_format, sl_uint8* src, sl_int32 src_pitch, BitmapData& dst)
+	{
+#if defined(PRIV_GRAPHICS_SUPPORT_SIMD)
+		if (!(_priv_Graphics_getSimdLevel())) {
+			return sl_false;
+		}
+		_priv_BitmapConvert_Param param;
+		if (!(param.src.init(src_format))) {
+			return sl_false;
+		}
+		if (param.src.kind != PRIV_BITMAP_CONVERT_KIND_32 || param.src.flagPA) {
+			return sl_false;
+		}
+		ColorComponentBuffer dst_cb[3];
+		if (dst.getColorComponentBuffers(dst_cb) != 3) {
+			return sl_false;
+		}
+		sl_uint32 strideUV = dst_cb[1].sample_stride;
+		if (dst_cb[2].sample_stride != (sl_int32)strideUV || (strideUV != 1 && strideUV != 2)) {
+			return sl_false;
+		}
+		sl_uint8* dry = (sl_uint8*)(dst_cb[0].data);
+		sl_uint8* dru = (sl_uint8*)(dst_cb[1].data);
+		sl_uint8* drv = (sl_uint8*)(dst_cb[2].data);
+		if (strideUV == 2 && ((dru + 1 != drv && drv + 1 != dru) || dst_cb[1].pitch != dst_cb[2].pitch)) {
+			return sl_false;
+		}
+		// shuffles to RGBA
+		param.op = PRIV_BITMAP_CONVERT_OP_NONE;
+		param.dst.init(BitmapFormat::RGBA);
+		param.prepareShuffles();
+		sl_uint32 H2 = height >> 1;
+		for (sl_uint32 i = 0; i < H2; i++) {
+			_priv_BitmapConvert_packedToYUV420Rows_SSE41(dry, dry + dst_cb[0].pitch, dru, drv, strideUV, src, src + src_pitch, width, param);
+			src += src_pitch + src_pitch;
+			dry += dst_cb[0].pitch + dst_cb[0].pitch;
+			dru += dst_cb[1].pitch;
+			drv += dst_cb[2].pitch;
+		}
+		return sl_true;
+#else
+		return sl_false;
+#endif
+	}
+
+}
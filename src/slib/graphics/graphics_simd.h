@@ -0,0 +1,45 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef CHECKHEADER_SLIB_GRAPHICS_SIMD
+#define CHECKHEADER_SLIB_GRAPHICS_SIMD
+
+#include "slib/graphics/definition.h"
+
+/*
+	SIMD kernels of the pixel processing are compiled for SSE4.1 and AVX2 on x64,
+	and selected at runtime by `_priv_Graphics_getSimdLevel()`.
+*/
+
+#if defined(SLIB_ARCH_IS_X64) && (defined(SLIB_COMPILER_IS_VC) || defined(SLIB_COMPILER_IS_GCC))
+#	define PRIV_GRAPHICS_SUPPORT_SIMD
+#	include <immintrin.h>
+#	if defined(SLIB_COMPILER_IS_VC)
+#		include <intrin.h>
+#		define PRIV_GRAPHICS_SSE41_FUNC
+#		define PRIV_GRAPHICS_AVX2_FUNC
+#	else
+#		include <cpuid.h>
+#		define PRIV_GRAPHICS_SSE41_FUNC __attribute__((target("sse4.1")))
+#		define PRIV_GRAPHICS_AVX2_FUNC __attribute__((target("avx2")))
+#	endif
+#endif
+
+namespace slib
+{
+
+#if defined(PRIV_GRAPHICS_SUPPORT_SIMD)
+	// 0: none, 1: SSE4.1, 2: AVX2
+	sl_uint32 _priv_Graphics_getSimdLevel();
+#endif
+
+}
+
+#endif
@@ -11,7 +11,7 @@
 #include "slib/graphics/image.h"
 
 #include "slib/core/file.h"
-#include "slib/core/scoped.h"
+#include "slib/core/function.h"
 
 #include <stdio.h>
 #include <setjmp.h>
@@ -39,21 +39,100 @@ namespace slib
 		longjmp(err->setjmp_buffer, 1);
 	}
 
-	Ref<Image> Image::loadJPEG(const void* content, sl_size size)
+	class _priv_ImageJpeg_Decoder
 	{
+	public:
 		jpeg_decompress_struct cinfo;
 		_slib_image_ext_jpeg_error_mgr jerr;
-		cinfo.err = jpeg_std_error(&(jerr.pub));
-		jerr.pub.error_exit = _slib_image_jpeg_error_exit;
-
-		Ref<Image> ret;
+		Memory row;
+		// image being decoded. kept in this object for the same reason as `_priv_ImageJpeg_Encoder::bufOutput`
+		Ref<Image> image;
+
+	public:
+		_priv_ImageJpeg_Decoder()
+		{
+			cinfo.err = jpeg_std_error(&(jerr.pub));
+			jerr.pub.error_exit = _slib_image_jpeg_error_exit;
+			jpeg_create_decompress(&cinfo);
+		}
 
-		if (setjmp(jerr.setjmp_buffer)) {
+		~_priv_ImageJpeg_Decoder()
+		{
 			jpeg_destroy_decompress(&cinfo);
-			return sl_null;
 		}
 
-		jpeg_create_decompress(&cinfo);
+	};
+
+	class _priv_ImageJpeg_Encoder
+	{
+	public:
+		jpeg_compress_struct cinfo;
+		_slib_image_ext_jpeg_error_mgr jerr;
+		Memory row;
+		// output buffer, reused by the next encoding
+		unsigned char* buf;
+		unsigned long sizeBuf;
+		// destination of `jpeg_mem_dest`. kept in this object (not in the locals of the encoding function),
+		// because the locals modified after `setjmp` are indeterminate after `longjmp`
+		unsigned char* bufOutput;
+		unsigned long sizeOutput;
+
+	public:
+		_priv_ImageJpeg_Encoder()
+		{
+			cinfo.err = jpeg_std_error(&(jerr.pub));
+			jerr.pub.error_exit = _slib_image_jpeg_error_exit;
+			jpeg_create_compress(&cinfo);
+			buf = sl_null;
+			sizeBuf = 0;
+			bufOutput = sl_null;
+			sizeOutput = 0;
+		}
+
+		~_priv_ImageJpeg_Encoder()
+		{
+			jpeg_destroy_compress(&cinfo);
+			if (buf) {
+				free(buf);
+			}
+		}
+
+	};
+
+	_priv_ImageJpeg_Decoder* _priv_ImageJpeg_createDecoder()
+	{
+		return new _priv_ImageJpeg_Decoder;
+	}
+
+	void _priv_ImageJpeg_freeDecoder(_priv_ImageJpeg_Decoder* decoder)
+	{
+		delete decoder;
+	}
+
+	_priv_ImageJpeg_Encoder* _priv_ImageJpeg_createEncoder()
+	{
+		return new _priv_ImageJpeg_Encoder;
+	}
+
+	void _priv_ImageJpeg_freeEncoder(_priv_ImageJpeg_Encoder* encoder)
+	{
+		delete encoder;
+	}
+
+	/*
+		width, height: the decoded image is scaled down in the DCT domain (1/2, 1/4, 1/8), as long as it is not smaller than this size
+		maxMemory: bytes of the decoded pixels. scaled down in the DCT domain to fit, or fails
+		allocator: allocates the pixel buffer (optional)
+	*/
+	Ref<Image> _priv_ImageJpeg_decode(_priv_ImageJpeg_Decoder* decoder, const void* content, sl_size size, sl_uint32 width, sl_uint32 height, sl_size maxMemory, const Function<Memory(sl_size)>& allocator)
+	{
+		jpeg_decompress_struct& cinfo = decoder->cinfo;
+
+		if (setjmp(decoder->jerr.setjmp_buffer)) {
+			jpeg_abort_decompress(&cinfo);
+			decoder->image.setNull();
+			return sl_null;
+		}
 
 		jpeg_mem_src(&cinfo, (unsigned char*)content, (sl_uint32)size);
 
@@ -61,72 +140,122 @@ namespace slib
 
 		cinfo.out_color_space = JCS_RGB;
 
+		cinfo.scale_num = 1;
+		cinfo.scale_denom = 1;
+		sl_uint32 denom = 1;
+		for (;;) {
+			jpeg_calc_output_dimensions(&cinfo);
+			sl_uint32 next = denom << 1;
+			if (next > 8) {
+				break;
+			}
+			sl_bool flagScale = sl_false;
+			if (maxMemory && (sl_uint64)(cinfo.output_width) * cinfo.output_height * 4 > maxMemory) {
+				flagScale = sl_true;
+			} else if (width && height) {
+				sl_uint32 w = (cinfo.image_width + next - 1) / next;
+				sl_uint32 h = (cinfo.image_height + next - 1) / next;
+				if (w >= width && h >= height) {
+					flagScale = sl_true;
+				}
+			}
+			if (!flagScale) {
+				break;
+			}
+			denom = next;
+			cinfo.scale_denom = denom;
+		}
+
+		sl_uint32 widthOutput = cinfo.output_width;
+		sl_uint32 heightOutput = cinfo.output_height;
+		sl_size sizeOutput = (sl_size)widthOutput * heightOutput * 4;
+		if (!sizeOutput || (maxMemory && sizeOutput > maxMemory)) {
+			jpeg_abort_decompress(&cinfo);
+			return sl_null;
+		}
+
+		if (decoder->row.getSize() < widthOutput * 3) {
+			decoder->row = Memory::create(widthOutput * 3);
+		}
+		sl_uint8* row = (sl_uint8*)(decoder->row.getData());
+		if (!row) {
+			jpeg_abort_decompress(&cinfo);
+			return sl_null;
+		}
+		if (allocator.isNotNull()) {
+			Memory mem = allocator(sizeOutput);
+			if (mem.isNotNull()) {
+				decoder->image = Image::createStatic(widthOutput, heightOutput, (Color*)(mem.getData()), widthOutput, mem.ref.get());
+			}
+		} else {
+			decoder->image = Image::create(widthOutput, heightOutput);
+		}
+		Image* ret = decoder->image.get();
+		if (!ret) {
+			jpeg_abort_decompress(&cinfo);
+			return sl_null;
+		}
+
 		jpeg_start_decompress(&cinfo);
 
-		sl_uint32 width = cinfo.output_width;
-		sl_uint32 height = cinfo.output_height;
-		ret = Image::create(width, height);
-		if (ret.isNotNull()) {
-			JSAMPROW row_pointer[1];
-			SLIB_SCOPED_BUFFER(sl_uint8, 4096, row, width*3);
-			if (row) {
-				row_pointer[0] = (JSAMPROW)(row);
-				Color* pixels = ret->getColors();
-				sl_uint32 stride = ret->getStride();
-				while (cinfo.output_scanline < height) {
-					jpeg_read_scanlines(&cinfo, row_pointer, 1);
-					sl_uint8* p = row;
-					for (sl_uint32 i = 0; i < width; i++) {
-						pixels[i].r = *(p++);
-						pixels[i].g = *(p++);
-						pixels[i].b = *(p++);
-						pixels[i].a = 255;
-					}
-					pixels += stride;
-				}
+		JSAMPROW row_pointer[1];
+		row_pointer[0] = (JSAMPROW)(row);
+		Color* pixels = ret->getColors();
+		sl_int32 stride = ret->getStride();
+		while (cinfo.output_scanline < heightOutput) {
+			jpeg_read_scanlines(&cinfo, row_pointer, 1);
+			sl_uint8* p = row;
+			for (sl_uint32 i = 0; i < widthOutput; i++) {
+				pixels[i].r = *(p++);
+				pixels[i].g = *(p++);
+				pixels[i].b = *(p++);
+				pixels[i].a = 255;
 			}
+			pixels += stride;
 		}
 
 		jpeg_finish_decompress(&cinfo);
-		jpeg_destroy_decompress(&cinfo);
 
-		return ret;
+		Ref<Image> image = Move(decoder->image);
+		return image;
 	}
 
-	Memory Image::saveJPEG(const Ref<Image>& image, float quality)
+	Memory _priv_ImageJpeg_encode(_priv_ImageJpeg_Encoder* encoder, const Ref<Image>& image, float quality)
 	{
 		if (image.isNull()) {
 			return sl_null;
 		}
 
-		Memory ret;
-		
-		jpeg_compress_struct cinfo;
-		_slib_image_ext_jpeg_error_mgr jerr;
-
-		cinfo.err = jpeg_std_error(&(jerr.pub));
-		jerr.pub.error_exit = _slib_image_jpeg_error_exit;
+		jpeg_compress_struct& cinfo = encoder->cinfo;
 
-		unsigned char* buf = sl_null;
-		unsigned long size = 0;
+		encoder->bufOutput = encoder->buf;
+		encoder->sizeOutput = encoder->sizeBuf;
 
-		jpeg_create_compress(&cinfo);
-
-		if (setjmp(jerr.setjmp_buffer)) {
-			jpeg_destroy_compress(&cinfo);
-			if (buf) {
-				free(buf);
+		if (setjmp(encoder->jerr.setjmp_buffer)) {
+			jpeg_abort_compress(&cinfo);
+			if (encoder->bufOutput && encoder->bufOutput != encoder->buf) {
+				free(encoder->bufOutput);
 			}
+			encoder->bufOutput = sl_null;
 			return sl_null;
 		}
 
-		jpeg_mem_dest(&cinfo, &buf, &size);
+		jpeg_mem_dest(&cinfo, &(encoder->bufOutput), &(encoder->sizeOutput));
 
 		sl_uint32 width = image->getWidth();
 		sl_uint32 height = image->getHeight();
-		sl_uint32 stride = image->getStride();
+		sl_int32 stride = image->getStride();
 		Color* pixels = image->getColors();
 
+		if (encoder->row.getSize() < width * 3) {
+			encoder->row = Memory::create(width * 3);
+		}
+		sl_uint8* row = (sl_uint8*)(encoder->row.getData());
+		if (!row) {
+			jpeg_abort_compress(&cinfo);
+			return sl_null;
+		}
+
 		cinfo.image_width = (JDIMENSION)width;
 		cinfo.image_height = (JDIMENSION)height;
 		cinfo.input_components = 3;
@@ -145,38 +274,56 @@ namespace slib
 
 		jpeg_start_compress(&cinfo, 1);
 
-		
-		SLIB_SCOPED_BUFFER(sl_uint8, 4096, row, width*3);
-		if (row) {
-			JSAMPROW row_pointer[1];
-			row_pointer[0] = (JSAMPROW)(row);
-			while (cinfo.next_scanline < height) {
-				sl_uint8* p = row;
-				for (sl_uint32 i = 0; i < width; i++) {
-					*(p++) = pixels[i].r;
-					*(p++) = pixels[i].g;
-					*(p++) = pixels[i].b;
-				}
-				jpeg_write_scanlines(&cinfo, row_pointer, 1);
-				pixels += stride;
+		JSAMPROW row_pointer[1];
+		row_pointer[0] = (JSAMPROW)(row);
+		while (cinfo.next_scanline < height) {
+			sl_uint8* p = row;
+			for (sl_uint32 i = 0; i < width; i++) {
+				*(p++) = pixels[i].r;
+				*(p++) = pixels[i].g;
+				*(p++) = pixels[i].b;
 			}
+			jpeg_write_scanlines(&cinfo, row_pointer, 1);
+			pixels += stride;
 		}
 
 		jpeg_finish_compress(&cinfo);
 
-		if (row && buf) {
-			ret = Memory::create(buf, size);
-		}
+		unsigned char* buf = encoder->bufOutput;
+		unsigned long size = encoder->sizeOutput;
+		encoder->bufOutput = sl_null;
 
-		jpeg_destroy_compress(&cinfo);
+		Memory ret = Memory::create(buf, size);
 
-		if (buf) {
-			free(buf);
+		// keeps the (grown) output buffer for the next encoding
+		if (buf != encoder->buf) {
+			if (encoder->buf) {
+				free(encoder->buf);
+			}
+			encoder->buf = buf;
+			encoder->sizeBuf = size;
 		}
 
 		return ret;
 	}
 
+	Ref<Image> Image::loadJPEG(const void* content, sl_size size)
+	{
+		return loadJPEG(content, size, 0, 0);
+	}
+
+	Ref<Image> Image::loadJPEG(const void* content, sl_size size, sl_uint32 width, sl_uint32 height)
+	{
+		_priv_ImageJpeg_Decoder decoder;
+		return _priv_ImageJpeg_decode(&decoder, content, size, width, height, 0, sl_null);
+	}
+
+	Memory Image::saveJPEG(const Ref<Image>& image, float quality)
+	{
+		_priv_ImageJpeg_Encoder encoder;
+		return _priv_ImageJpeg_encode(&encoder, image, quality);
+	}
+
 	Memory Image::saveJPEG(float quality)
 	{
 		return saveJPEG(this, quality);
@@ -0,0 +1,355 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "slib/graphics/image_pipeline.h"
+
+#include "slib/core/event.h"
+#include "slib/core/system.h"
+
+namespace slib
+{
+
+	_priv_ImageJpeg_Decoder* _priv_ImageJpeg_createDecoder();
+	void _priv_ImageJpeg_freeDecoder(_priv_ImageJpeg_Decoder* decoder);
+	_priv_ImageJpeg_Encoder* _priv_ImageJpeg_createEncoder();
+	void _priv_ImageJpeg_freeEncoder(_priv_ImageJpeg_Encoder* encoder);
+	Ref<Image> _priv_ImageJpeg_decode(_priv_ImageJpeg_Decoder* decoder, const void* content, sl_size size, sl_uint32 width, sl_uint32 height, sl_size maxMemory, const Function<Memory(sl_size)>& allocator);
+	Memory _priv_ImageJpeg_encode(_priv_ImageJpeg_Encoder* encoder, const Ref<Image>& image, float quality);
+	Ref<Image> _priv_ImagePng_decode(const void* content, sl_size size, sl_size maxMemory, const Function<Memory(sl_size)>& allocator);
+
+	// the workers and the calling thread take the items by the shared index, so the batch completes even if no worker is free
+	class _priv_ImagePipeline_Batch : public Referable
+	{
+	public:
+		Function<void(sl_size)> task;
+		sl_reg count;
+		sl_reg indexNext;
+		sl_reg countCompleted;
+		Ref<Event> eventCompleted;
+
+	public:
+		_priv_ImagePipeline_Batch()
+		{
+			count = 0;
+			indexNext = 0;
+			countCompleted = 0;
+		}
+
+	public:
+		void run()
+		{
+			for (;;) {
+				sl_reg index = Base::interlockedIncrement(&indexNext) - 1;
+				if (index >= count) {
+					return;
+				}
+				task((sl_size)index);
+				if (Base::interlockedIncrement(&countCompleted) == count) {
+					eventCompleted->set();
+				}
+			}
+		}
+
+	};
+
+
+	ImagePipelineParam::ImagePipelineParam()
+	{
+		countThreads = 0;
+		maxImageMemory = 0;
+		maxPooledBuffers = 16;
+	}
+
+	ImagePipelineParam::~ImagePipelineParam()
+	{
+	}
+
+
+	SLIB_DEFINE_OBJECT(ImagePipeline, Object)
+
+	ImagePipeline::ImagePipeline()
+	{
+		m_countThreads = 0;
+		m_maxImageMemory = 0;
+		m_maxPooledBuffers = 0;
+	}
+
+	ImagePipeline::~ImagePipeline()
+	{
+		{
+			ListElements<_priv_ImageJpeg_Decoder*> decoders(m_jpegDecoders);
+			for (sl_size i = 0; i < decoders.count; i++) {
+				_priv_ImageJpeg_freeDecoder(decoders[i]);
+			}
+		}
+		{
+			ListElements<_priv_ImageJpeg_Encoder*> encoders(m_jpegEncoders);
+			for (sl_size i = 0; i < encoders.count; i++) {
+				_priv_ImageJpeg_freeEncoder(encoders[i]);
+			}
+		}
+	}
+
+	Ref<ImagePipeline> ImagePipeline::create(const ImagePipelineParam& param)
+	{
+		sl_uint32 nThreads = param.countThreads;
+		if (!nThreads) {
+			nThreads = System::getProcessorsCount();
+		}
+		Ref<ThreadPool> threadPool = param.threadPool;
+		if (threadPool.isNull()) {
+			threadPool = ThreadPool::createWorkStealing(nThreads);
+			if (threadPool.isNull()) {
+				return sl_null;
+			}
+		}
+		Ref<ImagePipeline> ret = new ImagePipeline;
+		if (ret.isNotNull()) {
+			ret->m_threadPool = threadPool;
+			ret->m_countThreads = nThreads;
+			ret->m_maxImageMemory = param.maxImageMemory;
+			ret->m_maxPooledBuffers = param.maxPooledBuffers;
+		}
+		return ret;
+	}
+
+	Ref<ImagePipeline> ImagePipeline::create()
+	{
+		ImagePipelineParam param;
+		return create(param);
+	}
+
+	Ref<Image> ImagePipeline::decode(const void* content, sl_size size, sl_uint32 width, sl_uint32 height)
+	{
+		Ref<Image> ret;
+		Function<Memory(sl_size)> allocator = [this](sl_size size) {
+			return _allocateBuffer(size);
+		};
+		ImageFileType type = Image::getFileType(content, size);
+		if (type == ImageFileType::JPEG) {
+			_priv_ImageJpeg_Decoder* decoder = _takeJpegDecoder();
+			if (decoder) {
+				ret = _priv_ImageJpeg_decode(decoder, content, size, width, height, m_maxImageMemory, allocator);
+				_returnJpegDecoder(decoder);
+			}
+		} else if (type == ImageFileType::PNG) {
+			ret = _priv_ImagePng_decode(content, size, m_maxImageMemory, allocator);
+		} else {
+			ret = Image::loadSTB(content, size);
+			if (ret.isNotNull() && m_maxImageMemory) {
+				if ((sl_uint64)(ret->getWidth()) * ret->getHeight() * 4 > m_maxImageMemory) {
+					return sl_null;
+				}
+			}
+		}
+		if (ret.isNotNull()) {
+			if (width == 0 || height == 0) {
+				return ret;
+			}
+			if (ret->getWidth() != width && ret->getHeight() != height) {
+				ret = ret->scale(width, height);
+			}
+		}
+		return ret;
+	}
+
+	Ref<Image> ImagePipeline::decode(const Memory& content, sl_uint32 width, sl_uint32 height)
+	{
+		return decode(content.getData(), content.getSize(), width, height);
+	}
+
+	List< Ref<Image> > ImagePipeline::decode(const List<Memory>& _contents, sl_uint32 width, sl_uint32 height)
+	{
+		ListElements<Memory> contents(_contents);
+		List< Ref<Image> > ret = List< Ref<Image> >::create(contents.count);
+		if (ret.isNull()) {
+			return sl_null;
+		}
+		Ref<Image>* images = ret.getData();
+		_runBatch(contents.count, [this, &contents, images, width, height](sl_size index) {
+			images[index] = decode(contents[index], width, height);
+		});
+		return ret;
+	}
+
+	void ImagePipeline::decodeAsync(const Memory& content, const Function<void(Ref<Image>&)>& onComplete, sl_uint32 width, sl_uint32 height)
+	{
+		Ref<ImagePipeline> thiz = this;
+		m_threadPool->addTask([thiz, content, onComplete, width, height]() {
+			Ref<Image> image = thiz->decode(content, width, height);
+			onComplete(image);
+		});
+	}
+
+	Memory ImagePipeline::encode(const Ref<Image>& image, ImageFileType type, float quality)
+	{
+		if (image.isNull()) {
+			return sl_null;
+		}
+		if (type == ImageFileType::JPEG) {
+			Memory ret;
+			_priv_ImageJpeg_Encoder* encoder = _takeJpegEncoder();
+			if (encoder) {
+				ret = _priv_ImageJpeg_encode(encoder, image, quality);
+				_returnJpegEncoder(encoder);
+			}
+			return ret;
+		} else if (type == ImageFileType::PNG) {
+			return Image::savePNG(image);
+		}
+		return sl_null;
+	}
+
+	List<Memory> ImagePipeline::encode(const List< Ref<Image> >& _images, ImageFileType type, float quality)
+	{
+		ListElements< Ref<Image> > images(_images);
+		List<Memory> ret = List<Memory>::create(images.count);
+		if (ret.isNull()) {
+			return sl_null;
+		}
+		Memory* contents = ret.getData();
+		_runBatch(images.count, [this, &images, contents, type, quality](sl_size index) {
+			contents[index] = encode(images[index], type, quality);
+		});
+		return ret;
+	}
+
+	void ImagePipeline::encodeAsync(const Ref<Image>& image, ImageFileType type, const Function<void(Memory&)>& onComplete, float quality)
+	{
+		Ref<ImagePipeline> thiz = this;
+		m_threadPool->addTask([thiz, image, type, onComplete, quality]() {
+			Memory content = thiz->encode(image, type, quality);
+			onComplete(content);
+		});
+	}
+
+	const Ref<ThreadPool>& ImagePipeline::getThreadPool()
+	{
+		return m_threadPool;
+	}
+
+	Memory ImagePipeline::_allocateBuffer(sl_size size)
+	{
+		if (!m_maxPooledBuffers) {
+			return Memory::create(size);
+		}
+		{
+			SpinLocker lock(&m_lockBuffers);
+			Memory* buffers = m_buffers.getData();
+			sl_size n = m_buffers.getCount();
+			// the smallest idle buffer (referenced only by the pool) fitting the size
+			sl_size indexIdle = n;
+			sl_size indexFit = n;
+			for (sl_size i = 0; i < n; i++) {
+				if (buffers[i].ref->getReferenceCount() == 1) {
+					indexIdle = i;
+					sl_size sizeBuffer = buffers[i].getSize();
+					if (sizeBuffer >= size && (indexFit == n || sizeBuffer < buffers[indexFit].getSize())) {
+						indexFit = i;
+					}
+				}
+			}
+			if (indexFit < n) {
+				return buffers[indexFit];
+			}
+			if (n >= m_maxPooledBuffers) {
+				if (indexIdle == n) {
+					lock.unlock();
+					return Memory::create(size);
+				}
+				// replaces the idle buffer which is too small
+				m_buffers.removeAt_NoLock(indexIdle);
+			}
+		}
+		Memory mem = Memory::create(size);
+		if (mem.isNotNull()) {
+			SpinLocker lock(&m_lockBuffers);
+			if (m_buffers.getCount() < m_maxPooledBuffers) {
+				m_buffers.add_NoLock(mem);
+			}
+		}
+		return mem;
+	}
+
+	_priv_ImageJpeg_Decoder* ImagePipeline::_takeJpegDecoder()
+	{
+		{
+			SpinLocker lock(&m_lockCoders);
+			_priv_ImageJpeg_Decoder* decoder;
+			if (m_jpegDecoders.popBack_NoLock(&decoder)) {
+				return decoder;
+			}
+		}
+		return _priv_ImageJpeg_createDecoder();
+	}
+
+	void ImagePipeline::_returnJpegDecoder(_priv_ImageJpeg_Decoder* decoder)
+	{
+		SpinLocker lock(&m_lockCoders);
+		if (!(m_jpegDecoders.add_NoLock(decoder))) {
+			lock.unlock();
+			_priv_ImageJpeg_freeDecoder(decoder);
+		}
+	}
+
+	_priv_ImageJpeg_Encoder* ImagePipeline::_takeJpegEncoder()
+	{
+		{
+			SpinLocker lock(&m_lockCoders);
+			_priv_ImageJpeg_Encoder* encoder;
+			if (m_jpegEncoders.popBack_NoLock(&encoder)) {
+				return encoder;
+			}
+		}
+		return _priv_ImageJpeg_createEncoder();
+	}
+
+	void ImagePipeline::_returnJpegEncoder(_priv_ImageJpeg_Encoder* encoder)
+	{
+		SpinLocker lock(&m_lockCoders);
+		if (!(m_jpegEncoders.add_NoLock(encoder))) {
+			lock.unlock();
+			_priv_ImageJpeg_freeEncoder(encoder);
+		}
+	}
+
+	void ImagePipeline::_runBatch(sl_size count, const Function<void(sl_size)>& task)
+	{
+		if (!count) {
+			return;
+		}
+		Ref<_priv_ImagePipeline_Batch> batch = new _priv_ImagePipeline_Batch;
+		if (batch.isNotNull()) {
+			batch->eventCompleted = Event::create();
+		}
+		if (batch.isNull() || batch->eventCompleted.isNull()) {
+			for (sl_size i = 0; i < count; i++) {
+				task(i);
+			}
+			return;
+		}
+		batch->task = task;
+		batch->count = (sl_reg)count;
+		sl_size nWorkers = count - 1;
+		if (nWorkers > m_countThreads) {
+			nWorkers = m_countThreads;
+		}
+		for (sl_size i = 0; i < nWorkers; i++) {
+			m_threadPool->addTask([batch]() {
+				batch->run();
+			});
+		}
+		batch->run();
+		while (Base::interlockedAdd(&(batch->countCompleted), 0) < batch->count) {
+			batch->eventCompleted->wait();
+		}
+	}
+
+}
@@ -11,6 +11,7 @@
 #include "slib/graphics/image.h"
 
 #include "slib/core/file.h"
+#include "slib/core/function.h"
 
 #include "libpng/png.h"
 #include "libpng/pngstruct.h"
@@ -18,7 +19,11 @@
 namespace slib
 {
 
-	Ref<Image> Image::loadPNG(const void* content, sl_size size)
+	/*
+		maxMemory: bytes of the decoded pixels. fails on the larger image
+		allocator: allocates the pixel buffer (optional)
+	*/
+	Ref<Image> _priv_ImagePng_decode(const void* content, sl_size size, sl_size maxMemory, const Function<Memory(sl_size)>& allocator)
 	{
 		png_image image;
 		Base::resetMemory(&image, 0, sizeof(image));
@@ -29,11 +34,16 @@ namespace slib
 
 			image.format = PNG_FORMAT_RGBA;
 			sl_uint32 pitch = image.width * 4;
-			sl_uint32 size = pitch * image.height;
-
-			if (size > 0) {
-				Memory mem = Memory::create(size);
-				if (mem.isNotEmpty()) {
+			sl_size size = (sl_size)pitch * image.height;
+
+			if (size > 0 && (!maxMemory || size <= maxMemory)) {
+				Memory mem;
+				if (allocator.isNotNull()) {
+					mem = allocator(size);
+				} else {
+					mem = Memory::create(size);
+				}
+				if (mem.isNotNull()) {
 					png_bytep buffer = (png_bytep)(mem.getData());
 					if (png_image_finish_read(&image, NULL, buffer, (png_int_32)pitch, NULL)) {
 						ret = Image::createStatic(image.width, image.height, (Color*)buffer, image.width, mem.ref.get());
@@ -47,6 +57,11 @@ namespace slib
 		return ret;
 	}
 
+	Ref<Image> Image::loadPNG(const void* content, sl_size size)
+	{
+		return _priv_ImagePng_decode(content, size, 0, sl_null);
+	}
+
 	static void _slib_image_png_mem_write_callback(png_structp png_ptr, png_bytep data, png_size_t length)
 	{
 		if (png_ptr == NULL)
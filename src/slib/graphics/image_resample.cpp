@@ -0,0 +1,753 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "slib/graphics/image.h"
+
+#include "slib/core/math.h"
+#include "slib/core/scoped.h"
+
+#include "graphics_simd.h"
+
+// bits of the fractional part of the fixed-point filter weights
+#define PRIV_IMAGE_RESAMPLE_PRECISION 14
+
+/*
+	Separable resampling of the images
+
+	The filter weights of each axis are precomputed once per drawing as 16-bit fixed-point numbers.
+	The source rows are filtered horizontally into a ring of `countTaps` rows, and then the rows of the
+	ring are filtered vertically into the destination. Every source row is filtered horizontally at most once.
+	Every destination pixel of an axis uses the same count of taps, so the inner loops have no branch.
+	The horizontal taps are padded to even count (with zero weights), and the start positions are
+	shifted into the source row, so the SIMD kernels can read the taps in pairs.
+*/
+
+namespace slib
+{
+
+	static double _priv_ImageResample_bicubic(double x)
+	{
+		// Keys cubic convolution, a = -0.5
+		const double a = -0.5;
+		if (x < 0) {
+			x = -x;
+		}
+		if (x < 1) {
+			return ((a + 2) * x - (a + 3)) * x * x + 1;
+		}
+		if (x < 2) {
+			return (((x - 5) * x + 8) * x - 4) * a;
+		}
+		return 0;
+	}
+
+	static double _priv_ImageResample_sinc(double x)
+	{
+		if (x == 0) {
+			return 1;
+		}
+		x *= SLIB_PI_LONG;
+		return Math::sin(x) / x;
+	}
+
+	static double _priv_ImageResample_lanczos(double x)
+	{
+		// Lanczos-3
+		if (-3 < x && x < 3) {
+			return _priv_ImageResample_sinc(x) * _priv_ImageResample_sinc(x / 3);
+		}
+		return 0;
+	}
+
+	class _priv_ImageResample_Filter
+	{
+	public:
+		StretchMode mode;
+		sl_uint32 sizeSrc;
+		sl_uint32 sizeDst;
+		double scale;
+		double filterScale;
+		double support;
+
+	public:
+		_priv_ImageResample_Filter(sl_uint32 _sizeSrc, sl_uint32 _sizeDst, StretchMode _mode)
+		{
+			sizeSrc = _sizeSrc;
+			sizeDst = _sizeDst;
+			mode = _mode;
+			if (mode != StretchMode::Linear && mode != StretchMode::Bicubic && mode != StretchMode::Lanczos) {
+				mode = StretchMode::Box;
+			}
+			scale = (double)sizeSrc / (double)sizeDst;
+			// widens the kernel on downscaling, to filter all the source pixels
+			filterScale = scale < 1 ? 1 : scale;
+			support = (mode == StretchMode::Lanczos ? 3 : 2) * filterScale;
+		}
+
+	public:
+		// returns the count of the taps, and fills the normalized weights (if not null)
+		sl_uint32 getWeights(sl_uint32 index, sl_uint32& outStart, double* weights)
+		{
+			if (mode == StretchMode::Linear || (mode == StretchMode::Box && sizeSrc < sizeDst)) {
+				// bilinear; the corner pixels are aligned on upscaling
+				double pos;
+				if (sizeSrc < sizeDst) {
+					pos = (double)index * (double)(sizeSrc - 1) / (double)(sizeDst - 1);
+				} else {
+					pos = (double)index * scale;
+				}
+				sl_uint32 i = (sl_uint32)pos;
+				if (i + 1 >= sizeSrc) {
+					outStart = sizeSrc - 1;
+					if (weights) {
+						weights[0] = 1;
+					}
+					return 1;
+				}
+				double f = pos - (double)i;
+				outStart = i;
+				if (weights) {
+					weights[0] = 1 - f;
+					weights[1] = f;
+				}
+				return 2;
+			}
+			if (mode == StretchMode::Box) {
+				// area-average of [index * scale, (index + 1) * scale)
+				sl_uint32 i0 = (sl_uint32)((sl_uint64)index * sizeSrc / sizeDst);
+				sl_uint32 i1 = (sl_uint32)(((sl_uint64)(index + 1) * sizeSrc + sizeDst - 1) / sizeDst);
+				if (i1 > sizeSrc) {
+					i1 = sizeSrc;
+				}
+				outStart = i0;
+				if (weights) {
+					double x0 = (double)index * scale;
+					double x1 = x0 + scale;
+					for (sl_uint32 i = i0; i < i1; i++) {
+						double s = (double)i;
+						double e = s + 1;
+						if (s < x0) {
+							s = x0;
+						}
+						if (e > x1) {
+							e = x1;
+						}
+						weights[i - i0] = (e - s) / scale;
+					}
+				}
+				return i1 - i0;
+			}
+			double center = ((double)index + 0.5) * scale;
+			sl_int32 xmin = (sl_int32)(center - support + 0.5);
+			if (xmin < 0) {
+				xmin = 0;
+			}
+			sl_int32 xmax = (sl_int32)(center + support + 0.5);
+			if (xmax > (sl_int32)sizeSrc) {
+				xmax = (sl_int32)sizeSrc;
+			}
+			if (xmax <= xmin) {
+				xmax = xmin + 1;
+			}
+			outStart = (sl_uint32)xmin;
+			sl_uint32 n = (sl_uint32)(xmax - xmin);
+			if (weights) {
+				double sum = 0;
+				for (sl_uint32 k = 0; k < n; k++) {
+					double x = ((double)(xmin + (sl_int32)k) - center + 0.5) / filterScale;
+					double w;
+					if (mode == StretchMode::Bicubic) {
+						w = _priv_ImageResample_bicubic(x);
+					} else {
+						w = _priv_ImageResample_lanczos(x);
+					}
+					weights[k] = w;
+					sum += w;
+				}
+				if (sum != 0) {
+					for (sl_uint32 k = 0; k < n; k++) {
+						weights[k] /= sum;
+					}
+				}
+			}
+			return n;
+		}
+
+	};
+
+	class _priv_ImageResample_Axis
+	{
+	public:
+		sl_uint32 countTaps;
+		sl_uint32* starts;
+		// `countTaps` weights per destination pixel
+		sl_int16* weights;
+
+	public:
+		_priv_ImageResample_Axis()
+		{
+			countTaps = 0;
+			starts = sl_null;
+			weights = sl_null;
+		}
+
+		~_priv_ImageResample_Axis()
+		{
+			if (starts) {
+				Base::freeMemory(starts);
+			}
+			if (weights) {
+				Base::freeMemory(weights);
+			}
+		}
+
+	public:
+		sl_bool prepare(sl_uint32 sizeSrc, sl_uint32 sizeDst, StretchMode mode, sl_bool flagPadTaps)
+		{
+			_priv_ImageResample_Filter filter(sizeSrc, sizeDst, mode);
+			sl_uint32 n = 0;
+			sl_uint32 start;
+			sl_uint32 i;
+			for (i = 0; i < sizeDst; i++) {
+				sl_uint32 m = filter.getWeights(i, start, sl_null);
+				if (m > n) {
+					n = m;
+				}
+			}
+			if (flagPadTaps && (n & 1) && n < sizeSrc) {
+				n++;
+			}
+			countTaps = n;
+			starts = (sl_uint32*)(Base::createMemory(sizeof(sl_uint32) * sizeDst));
+			if (!starts) {
+				return sl_false;
+			}
+			weights = (sl_int16*)(Base::createMemory(sizeof(sl_int16) * sizeDst * n));
+			if (!weights) {
+				return sl_false;
+			}
+			Base::zeroMemory(weights, sizeof(sl_int16) * sizeDst * n);
+			SLIB_SCOPED_BUFFER(double, 64, w, n)
+			if (!w) {
+				return sl_false;
+			}
+			const sl_int32 one = 1 << PRIV_IMAGE_RESAMPLE_PRECISION;
+			for (i = 0; i < sizeDst; i++) {
+				sl_uint32 m = filter.getWeights(i, start, w);
+				// keeps all taps inside of the source
+				sl_uint32 shift = 0;
+				if (start + n > sizeSrc) {
+					shift = start + n - sizeSrc;
+					start -= shift;
+				}
+				starts[i] = start;
+				sl_int16* t = weights + i * n + shift;
+				double sum = 0;
+				sl_uint32 k;
+				for (k = 0; k < m; k++) {
+					sum += w[k];
+				}
+				if (sum == 0) {
+					sum = 1;
+				}
+				// rounds the cumulative sums, so the weights sum to exactly 1 (flat areas keep their colors),
+				// and the rounding error is spread over the taps (each tap is off by less than 1)
+				double acc = 0;
+				sl_int32 prev = 0;
+				for (k = 0; k < m; k++) {
+					acc += w[k];
+					sl_int32 cur = k + 1 < m ? (sl_int32)(Math::floor(acc / sum * one + 0.5)) : one;
+					t[k] = (sl_int16)(cur - prev);
+					prev = cur;
+				}
+			}
+			return sl_true;
+		}
+
+	};
+
+	SLIB_INLINE static sl_uint8 _priv_ImageResample_clamp(sl_int32 v)
+	{
+		v >>= PRIV_IMAGE_RESAMPLE_PRECISION;
+		if (v < 0) {
+			return 0;
+		}
+		if (v > 255) {
+			return 255;
+		}
+		return (sl_uint8)v;
+	}
+
+	static void _priv_ImageResample_horizontal(Color* dst, const Color* src, sl_uint32 width, const _priv_ImageResample_Axis& axis)
+	{
+		sl_uint32 n = axis.countTaps;
+		const sl_int16* w = axis.weights;
+		for (sl_uint32 x = 0; x < width; x++) {
+			const Color* s = src + axis.starts[x];
+			sl_int32 r = 1 << (PRIV_IMAGE_RESAMPLE_PRECISION - 1);
+			sl_int32 g = r;
+			sl_int32 b = r;
+			sl_int32 a = r;
+			for (sl_uint32 k = 0; k < n; k++) {
+				sl_int32 f = w[k];
+				r += s[k].r * f;
+				g += s[k].g * f;
+				b += s[k].b * f;
+				a += s[k].a * f;
+			}
+			dst[x].r = _priv_ImageResample_clamp(r);
+			dst[x].g = _priv_ImageResample_clamp(g);
+			dst[x].b = _priv_ImageResample_clamp(b);
+			dst[x].a = _priv_ImageResample_clamp(a);
+			w += n;
+		}
+	}
+
+	// `rows`: the rows of the taps, `x`: the first pixel to filter
+	static void _priv_ImageResample_vertical(Color* dst, const Color* const* rows, sl_uint32 x, sl_uint32 width, const sl_int16* w, sl_uint32 n)
+	{
+		for (; x < width; x++) {
+			sl_int32 r = 1 << (PRIV_IMAGE_RESAMPLE_PRECISION - 1);
+			sl_int32 g = r;
+			sl_int32 b = r;
+			sl_int32 a = r;
+			for (sl_uint32 k = 0; k < n; k++) {
+				const Color* s = rows[k] + x;
+				sl_int32 f = w[k];
+				r += s->r * f;
+				g += s->g * f;
+				b += s->b * f;
+				a += s->a * f;
+			}
+			dst[x].r = _priv_ImageResample_clamp(r);
+			dst[x].g = _priv_ImageResample_clamp(g);
+			dst[x].b = _priv_ImageResample_clamp(b);
+			dst[x].a = _priv_ImageResample_clamp(a);
+		}
+	}
+
+	static void _priv_ImageResample_blend(Color* dst, const Color* src, sl_uint32 width)
+	{
+		for (sl_uint32 x = 0; x < width; x++) {
+			dst[x].blend_PA_NPA(src[x]);
+		}
+	}
+
+#if defined(PRIV_GRAPHICS_SUPPORT_SIMD)
+	/*
+		Horizontal: the bytes of two pixels are shuffled into (r0 r1 g0 g1 b0 b1 a0 a1), widened to 16 bits,
+		and PMADDWD multiplies them with the weight pair (w0 w1) and adds the products of each channel.
+		Vertical: the same bytes of two rows are interleaved, so PMADDWD applies the weights of two rows at once.
+		Blending: x / 255 is computed as (x * 0x8081) >> 23, which is exact for 16-bit x.
+	*/
+
+	PRIV_GRAPHICS_SSE41_FUNC static void _priv_ImageResample_horizontal_SSE41(Color* dst, const Color* src, sl_uint32 width, const _priv_ImageResample_Axis& axis)
+	{
+		sl_uint32 n = axis.countTaps;
+		const sl_int16* w = axis.weights;
+		__m128i mask = _mm_setr_epi8(0, 4, 1, 5, 2, 6, 3, 7, 8, 12, 9, 13, 10, 14, 11, 15);
+		__m128i zero = _mm_setzero_si128();
+		__m128i round = _mm_set1_epi32(1 << (PRIV_IMAGE_RESAMPLE_PRECISION - 1));
+		for (sl_uint32 x = 0; x < width; x++) {
+			const Color* s = src + axis.starts[x];
+			__m128i sum = round;
+			sl_uint32 k = 0;
+			for (; k + 4 <= n; k += 4) {
+				__m128i v = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(s + k)), mask);
+				__m128i w01 = _mm_set1_epi32((sl_uint16)(w[k]) | ((sl_uint32)(sl_uint16)(w[k + 1]) << 16));
+				__m128i w23 = _mm_set1_epi32((sl_uint16)(w[k + 2]) | ((sl_uint32)(sl_uint16)(w[k + 3]) << 16));
+				sum = _mm_add_epi32(sum, _mm_madd_epi16(_mm_unpacklo_epi8(v, zero), w01));
+				sum = _mm_add_epi32(sum, _mm_madd_epi16(_mm_unpackhi_epi8(v, zero), w23));
+			}
+			for (; k + 2 <= n; k += 2) {
+				__m128i v = _mm_shuffle_epi8(_mm_loadl_epi64((const __m128i*)(s + k)), mask);
+				__m128i w01 = _mm_set1_epi32((sl_uint16)(w[k]) | ((sl_uint32)(sl_uint16)(w[k + 1]) << 16));
+				sum = _mm_add_epi32(sum, _mm_madd_epi16(_mm_unpacklo_epi8(v, zero), w01));
+			}
+			if (k < n) {
+				__m128i v = _mm_cvtepu8_epi32(_mm_cvtsi32_si128(*((const sl_int32*)(s + k))));
+				sum = _mm_add_epi32(sum, _mm_mullo_epi32(v, _mm_set1_epi32(w[k])));
+			}
+			sum = _mm_srai_epi32(sum, PRIV_IMAGE_RESAMPLE_PRECISION);
+			sum = _mm_packs_epi32(sum, sum);
+			*((sl_int32*)(dst + x)) = _mm_cvtsi128_si32(_mm_packus_epi16(sum, sum));
+			w += n;
+		}
+	}
+
+	PRIV_GRAPHICS_SSE41_FUNC static void _priv_ImageResample_vertical_SSE41(Color* dst, const Color* const* rows, sl_uint32 x, sl_uint32 width, const sl_int16* w, sl_uint32 n)
+	{
+		__m128i zero = _mm_setzero_si128();
+		__m128i round = _mm_set1_epi32(1 << (PRIV_IMAGE_RESAMPLE_PRECISION - 1));
+		for (; x + 4 <= width; x += 4) {
+			__m128i s0 = round;
+			__m128i s1 = round;
+			__m128i s2 = round;
+			__m128i s3 = round;
+			sl_uint32 k = 0;
+			for (; k + 2 <= n; k += 2) {
+				__m128i v0 = _mm_loadu_si128((const __m128i*)(rows[k] + x));
+				__m128i v1 = _mm_loadu_si128((const __m128i*)(rows[k + 1] + x));
+				__m128i f = _mm_set1_epi32((sl_uint16)(w[k]) | ((sl_uint32)(sl_uint16)(w[k + 1]) << 16));
+				__m128i l0 = _mm_unpacklo_epi8(v0, zero);
+				__m128i l1 = _mm_unpacklo_epi8(v1, zero);
+				__m128i h0 = _mm_unpackhi_epi8(v0, zero);
+				__m128i h1 = _mm_unpackhi_epi8(v1, zero);
+				s0 = _mm_add_epi32(s0, _mm_madd_epi16(_mm_unpacklo_epi16(l0, l1), f));
+				s1 = _mm_add_epi32(s1, _mm_madd_epi16(_mm_unpackhi_epi16(l0, l1), f));
+				s2 = _mm_add_epi32(s2, _mm_madd_epi16(_mm_unpacklo_epi16(h0, h1), f));
+				s3 = _mm_add_epi32(s3, _mm_madd_epi16(_mm_unpackhi_epi16(h0, h1), f));
+			}
+			if (k < n) {
+				__m128i v0 = _mm_loadu_si128((const __m128i*)(rows[k] + x));
+				__m128i f = _mm_set1_epi32((sl_uint16)(w[k]));
+				__m128i l0 = _mm_unpacklo_epi8(v0, zero);
+				__m128i h0 = _mm_unpackhi_epi8(v0, zero);
+				s0 = _mm_add_epi32(s0, _mm_madd_epi16(_mm_unpacklo_epi16(l0, zero), f));
+				s1 = _mm_add_epi32(s1, _mm_madd_epi16(_mm_unpackhi_epi16(l0, zero), f));
+				s2 = _mm_add_epi32(s2, _mm_madd_epi16(_mm_unpacklo_epi16(h0, zero), f));
+				s3 = _mm_add_epi32(s3, _mm_madd_epi16(_mm_unpackhi_epi16(h0, zero), f));
+			}
+			s0 = _mm_srai_epi32(s0, PRIV_IMAGE_RESAMPLE_PRECISION);
+			s1 = _mm_srai_epi32(s1, PRIV_IMAGE_RESAMPLE_PRECISION);
+			s2 = _mm_srai_epi32(s2, PRIV_IMAGE_RESAMPLE_PRECISION);
+			s3 = _mm_srai_epi32(s3, PRIV_IMAGE_RESAMPLE_PRECISION);
+			_mm_storeu_si128((__m128i*)(dst + x), _mm_packus_epi16(_mm_packs_epi32(s0, s1), _mm_packs_epi32(s2, s3)));
+		}
+		if (x < width) {
+			_priv_ImageResample_vertical(dst, rows, x, width, w, n);
+		}
+	}
+
+	PRIV_GRAPHICS_SSE41_FUNC static void _priv_ImageResample_blend_SSE41(Color* dst, const Color* src, sl_uint32 width)
+	{
+		__m128i zero = _mm_setzero_si128();
+		__m128i c255 = _mm_set1_epi16(255);
+		__m128i div = _mm_set1_epi16((short)0x8081);
+		sl_uint32 x = 0;
+		for (; x + 4 <= width; x += 4) {
+			__m128i s = _mm_loadu_si128((const __m128i*)(src + x));
+			__m128i d = _mm_loadu_si128((const __m128i*)(dst + x));
+			__m128i sl = _mm_unpacklo_epi8(s, zero);
+			__m128i sh = _mm_unpackhi_epi8(s, zero);
+			__m128i al = _mm_shufflehi_epi16(_mm_shufflelo_epi16(sl, 0xFF), 0xFF);
+			__m128i ah = _mm_shufflehi_epi16(_mm_shufflelo_epi16(sh, 0xFF), 0xFF);
+			// the alpha of the result: src.a * 255 + dst.a * (255 - src.a)
+			sl = _mm_blend_epi16(sl, c255, 0x88);
+			sh = _mm_blend_epi16(sh, c255, 0x88);
+			__m128i rl = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(d, zero), _mm_sub_epi16(c255, al)), _mm_mullo_epi16(sl, al));
+			__m128i rh = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(d, zero), _mm_sub_epi16(c255, ah)), _mm_mullo_epi16(sh, ah));
+			rl = _mm_srli_epi16(_mm_mulhi_epu16(rl, div), 7);
+			rh = _mm_srli_epi16(_mm_mulhi_epu16(rh, div), 7);
+			_mm_storeu_si128((__m128i*)(dst + x), _mm_packus_epi16(rl, rh));
+		}
+		if (x < width) {
+			_priv_ImageResample_blend(dst + x, src + x, width - x);
+		}
+	}
+
+	PRIV_GRAPHICS_AVX2_FUNC static void _priv_ImageResample_horizontal_AVX2(Color* dst, const Color* src, sl_uint32 width, const _priv_ImageResample_Axis& axis)
+	{
+		sl_uint32 n = axis.countTaps;
+		const sl_int16* w = axis.weights;
+		__m256i mask = _mm256_setr_epi8(0, 4, 1, 5, 2, 6, 3, 7, 8, 12, 9, 13, 10, 14, 11, 15, 0, 4, 1, 5, 2, 6, 3, 7, 8, 12, 9, 13, 10, 14, 11, 15);
+		__m256i zero = _mm256_setzero_si256();
+		__m256i indexLow = _mm256_setr_epi32(0, 0, 0, 0, 2, 2, 2, 2);
+		__m256i indexHigh = _mm256_setr_epi32(1, 1, 1, 1, 3, 3, 3, 3);
+		__m128i mask128 = _mm256_castsi256_si128(mask);
+		__m128i zero128 = _mm_setzero_si128();
+		__m128i round = _mm_set1_epi32(1 << (PRIV_IMAGE_RESAMPLE_PRECISION - 1));
+		for (sl_uint32 x = 0; x < width; x++) {
+			const Color* s = src + axis.starts[x];
+			sl_uint32 k = 0;
+			__m128i sum = round;
+			if (n >= 8) {
+				__m256i sum256 = zero;
+				for (; k + 8 <= n; k += 8) {
+					// lane 0: pixels 0-3, lane 1: pixels 4-7
+					__m256i v = _mm256_shuffle_epi8(_mm256_loadu_si256((const __m256i*)(s + k)), mask);
+					// weight pairs: (w0 w1) (w2 w3) (w4 w5) (w6 w7)
+					__m256i f = _mm256_castsi128_si256(_mm_loadu_si128((const __m128i*)(w + k)));
+					sum256 = _mm256_add_epi32(sum256, _mm256_madd_epi16(_mm256_unpacklo_epi8(v, zero), _mm256_permutevar8x32_epi32(f, indexLow)));
+					sum256 = _mm256_add_epi32(sum256, _mm256_madd_epi16(_mm256_unpackhi_epi8(v, zero), _mm256_permutevar8x32_epi32(f, indexHigh)));
+				}
+				sum = _mm_add_epi32(sum, _mm_add_epi32(_mm256_castsi256_si128(sum256), _mm256_extracti128_si256(sum256, 1)));
+			}
+			for (; k + 4 <= n; k += 4) {
+				__m128i v = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(s + k)), mask128);
+				__m128i w01 = _mm_set1_epi32((sl_uint16)(w[k]) | ((sl_uint32)(sl_uint16)(w[k + 1]) << 16));
+				__m128i w23 = _mm_set1_epi32((sl_uint16)(w[k + 2]) | ((sl_uint32)(sl_uint16)(w[k + 3]) << 16));
+				sum = _mm_add_epi32(sum, _mm_madd_epi16(_mm_unpacklo_epi8(v, zero128), w01));
+				sum = _mm_add_epi32(sum, _mm_madd_epi16(_mm_unpackhi_epi8(v, zero128), w23));
+			}
+			for (; k + 2 <= n; k += 2) {
+				__m128i v = _mm_shuffle_epi8(_mm_loadl_epi64((const __m128i*)(s + k)), mask128);
+				__m128i w01 = _mm_set1_epi32((sl_uint16)(w[k]) | ((sl_uint32)(sl_uint16)(w[k + 1]) << 16));
+				sum = _mm_add_epi32(sum, _mm_madd_epi16(_mm_unpacklo_epi8(v, zero128), w01));
+			}
+			if (k < n) {
+				__m128i v = _mm_cvtepu8_epi32(_mm_cvtsi32_si128(*((const sl_int32*)(s + k))));
+				sum = _mm_add_epi32(sum, _mm_mullo_epi32(v, _mm_set1_epi32(w[k])));
+			}
+			sum = _mm_srai_epi32(sum, PRIV_IMAGE_RESAMPLE_PRECISION);
+			sum = _mm_packs_epi32(sum, sum);
+			*((sl_int32*)(dst + x)) = _mm_cvtsi128_si32(_mm_packus_epi16(sum, sum));
+			w += n;
+		}
+	}
+
+	PRIV_GRAPHICS_AVX2_FUNC static void _priv_ImageResample_vertical_AVX2(Color* dst, const Color* const* rows, sl_uint32 x, sl_uint32 width, const sl_int16* w, sl_uint32 n)
+	{
+		__m256i zero = _mm256_setzero_si256();
+		__m256i round = _mm256_set1_epi32(1 << (PRIV_IMAGE_RESAMPLE_PRECISION - 1));
+		for (; x + 8 <= width; x += 8) {
+			__m256i s0 = round;
+			__m256i s1 = round;
+			__m256i s2 = round;
+			__m256i s3 = round;
+			sl_uint32 k = 0;
+			for (; k + 2 <= n; k += 2) {
+				__m256i v0 = _mm256_loadu_si256((const __m256i*)(rows[k] + x));
+				__m256i v1 = _mm256_loadu_si256((const __m256i*)(rows[k + 1] + x));
+				__m256i f = _mm256_set1_epi32((sl_uint16)(w[k]) | ((sl_uint32)(sl_uint16)(w[k + 1]) << 16));
+				__m256i l0 = _mm256_unpacklo_epi8(v0, zero);
+				__m256i l1 = _mm256_unpacklo_epi8(v1, zero);
+				__m256i h0 = _mm256_unpackhi_epi8(v0, zero);
+				__m256i h1 = _mm256_unpackhi_epi8(v1, zero);
+				s0 = _mm256_add_epi32(s0, _mm256_madd_epi16(_mm256_unpacklo_epi16(l0, l1), f));
+				s1 = _mm256_add_epi32(s1, _mm256_madd_epi16(_mm256_unpackhi_epi16(l0, l1), f));
+				s2 = _mm256_add_epi32(s2, _mm256_madd_epi16(_mm256_unpacklo_epi16(h0, h1), f));
+				s3 = _mm256_add_epi32(s3, _mm256_madd_epi16(_mm256_unpackhi_epi16(h0, h1), f));
+			}
+			if (k < n) {
+				__m256i v0 = _mm256_loadu_si256((const __m256i*)(rows[k] + x));
+				__m256i f = _mm256_set1_epi32((sl_uint16)(w[k]));
+				__m256i l0 = _mm256_unpacklo_epi8(v0, zero);
+				__m256i h0 = _mm256_unpackhi_epi8(v0, zero);
+				s0 = _mm256_add_epi32(s0, _mm256_madd_epi16(_mm256_unpacklo_epi16(l0, zero), f));
+				s1 = _mm256_add_epi32(s1, _mm256_madd_epi16(_mm256_unpackhi_epi16(l0, zero), f));
+				s2 = _mm256_add_epi32(s2, _mm256_madd_epi16(_mm256_unpacklo_epi16(h0, zero), f));
+				s3 = _mm256_add_epi32(s3, _mm256_madd_epi16(_mm256_unpackhi_epi16(h0, zero), f));
+			}
+			s0 = _mm256_srai_epi32(s0, PRIV_IMAGE_RESAMPLE_PRECISION);
+			s1 = _mm256_srai_epi32(s1, PRIV_IMAGE_RESAMPLE_PRECISION);
+			s2 = _mm256_srai_epi32(s2, PRIV_IMAGE_RESAMPLE_PRECISION);
+			s3 = _mm256_srai_epi32(s3, PRIV_IMAGE_RESAMPLE_PRECISION);
+			// the in-lane packing restores the order of the in-lane unpacking
+			_mm256_storeu_si256((__m256i*)(dst + x), _mm256_packus_epi16(_mm256_packs_epi32(s0, s1), _mm256_packs_epi32(s2, s3)));
+		}
+		if (x < width) {
+			_priv_ImageResample_vertical(dst, rows, x, width, w, n);
+		}
+	}
+
+	PRIV_GRAPHICS_AVX2_FUNC static void _priv_ImageResample_blend_AVX2(Color* dst, const Color* src, sl_uint32 width)
+	{
+		__m256i zero = _mm256_setzero_si256();
+		__m256i c255 = _mm256_set1_epi16(255);
+		__m256i div = _mm256_set1_epi16((short)0x8081);
+		sl_uint32 x = 0;
+		for (; x + 8 <= width; x += 8) {
+			__m256i s = _mm256_loadu_si256((const __m256i*)(src + x));
+			__m256i d = _mm256_loadu_si256((const __m256i*)(dst + x));
+			__m256i sl = _mm256_unpacklo_epi8(s, zero);
+			__m256i sh = _mm256_unpackhi_epi8(s, zero);
+			__m256i al = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(sl, 0xFF), 0xFF);
+			__m256i ah = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(sh, 0xFF), 0xFF);
+			sl = _mm256_blend_epi16(sl, c255, 0x88);
+			sh = _mm256_blend_epi16(sh, c255, 0x88);
+			__m256i rl = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpacklo_epi8(d, zero), _mm256_sub_epi16(c255, al)), _mm256_mullo_epi16(sl, al));
+			__m256i rh = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpackhi_epi8(d, zero), _mm256_sub_epi16(c255, ah)), _mm256_mullo_epi16(sh, ah));
+			rl = _mm256_srli_epi16(_mm256_mulhi_epu16(rl, div), 7);
+			rh = _mm256_srli_epi16(_mm256_mulhi_epu16(rh, div), 7);
+			_mm256_storeu_si256((__m256i*)(dst + x), _mm256_packus_epi16(rl, rh));
+		}
+		if (x < width) {
+			_priv_ImageResample_blend(dst + x, src + x, width - x);
+		}
+	}
+
+	sl_uint32 _priv_Graphics_getSimdLevel()
+	{
+		static sl_int32 level = -1;
+		if (level < 0) {
+			sl_int32 l = 0;
+#if defined(SLIB_COMPILER_IS_VC)
+			int info[4];
+			__cpuid(info, 1);
+			int ecx = info[2];
+			if (ecx & (1 << 19)) {
+				l = 1;
+				// OSXSAVE (bit 27), AVX (bit 28)
+				if ((ecx & (1 << 27)) && (ecx & (1 << 28))) {
+					if ((_xgetbv(0) & 6) == 6) {
+						__cpuidex(info, 7, 0);
+						if (info[1] & (1 << 5)) {
+							l = 2;
+						}
+					}
+				}
+			}
+#else
+			unsigned int eax, ebx, ecx, edx;
+			if (__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+				if (ecx & (1 << 19)) {
+					l = 1;
+					if ((ecx & (1 << 27)) && (ecx & (1 << 28))) {
+						unsigned int xcr0, xcr0High;
+						__asm__ __volatile__ ("xgetbv" : "=a"(xcr0), "=d"(xcr0High) : "c"(0));
+						if ((xcr0 & 6) == 6) {
+							__cpuid_count(7, 0, eax, ebx, ecx, edx);
+							if (ebx & (1 << 5)) {
+								l = 2;
+							}
+						}
+					}
+				}
+			}
+#endif
+			level = l;
+		}
+		return (sl_uint32)level;
+	}
+#endif
+
+	class _priv_ImageResample_Kernels
+	{
+	public:
+		void (*horizontal)(Color* dst, const Color* src, sl_uint32 width, const _priv_ImageResample_Axis& axis);
+		void (*vertical)(Color* dst, const Color* const* rows, sl_uint32 x, sl_uint32 width, const sl_int16* w, sl_uint32 n);
+		void (*blend)(Color* dst, const Color* src, sl_uint32 width);
+
+	public:
+		_priv_ImageResample_Kernels()
+		{
+			horizontal = &_priv_ImageResample_horizontal;
+			vertical = &_priv_ImageResample_vertical;
+			blend = &_priv_ImageResample_blend;
+#if defined(PRIV_GRAPHICS_SUPPORT_SIMD)
+			sl_uint32 level = _priv_Graphics_getSimdLevel();
+			if (level >= 2) {
+				horizontal = &_priv_ImageResample_horizontal_AVX2;
+				vertical = &_priv_ImageResample_vertical_AVX2;
+				blend = &_priv_ImageResample_blend_AVX2;
+			} else if (level == 1) {
+				horizontal = &_priv_ImageResample_horizontal_SSE41;
+				vertical = &_priv_ImageResample_vertical_SSE41;
+				blend = &_priv_ImageResample_blend_SSE41;
+			}
+#endif
+		}
+
+	};
+
+	void _priv_Image_blendSrcAlpha(Color* dst, const Color* src, sl_uint32 width)
+	{
+		_priv_ImageResample_Kernels kernels;
+		kernels.blend(dst, src, width);
+	}
+
+	void _priv_Image_resample(ImageDesc& dst, const ImageDesc& src, BlendMode blend, StretchMode stretch)
+	{
+		sl_uint32 sw = src.width;
+		sl_uint32 sh = src.height;
+		sl_uint32 dw = dst.width;
+		sl_uint32 dh = dst.height;
+		sl_bool flagX = sw != dw;
+		sl_bool flagY = sh != dh;
+
+		_priv_ImageResample_Axis ax, ay;
+		if (flagX) {
+			if (!(ax.prepare(sw, dw, stretch, sl_true))) {
+				return;
+			}
+		}
+		if (flagY) {
+			if (!(ay.prepare(sh, dh, stretch, sl_false))) {
+				return;
+			}
+		}
+
+		_priv_ImageResample_Kernels kernels;
+		sl_bool flagBlend = blend != BlendMode::Copy;
+		SLIB_SCOPED_BUFFER(Color, 1024, line, flagBlend ? dw : 0)
+		if (flagBlend && !line) {
+			return;
+		}
+
+		sl_uint32 y;
+		if (!flagY) {
+			Color* colorsDst = dst.colors;
+			const Color* colorsSrc = src.colors;
+			for (y = 0; y < dh; y++) {
+				if (flagBlend) {
+					kernels.horizontal(line, colorsSrc, dw, ax);
+					kernels.blend(colorsDst, line, dw);
+				} else {
+					kernels.horizontal(colorsDst, colorsSrc, dw, ax);
+				}
+				colorsDst += dst.stride;
+				colorsSrc += src.stride;
+			}
+			return;
+		}
+
+		sl_uint32 n = ay.countTaps;
+		SLIB_SCOPED_BUFFER(const Color*, 64, rows, n)
+		if (!rows) {
+			return;
+		}
+		// ring of the horizontally filtered rows: the source row `r` is stored in the slot `r % n`
+		Color* bufMid = sl_null;
+		if (flagX) {
+			bufMid = (Color*)(Base::createMemory(sizeof(Color) * dw * n));
+			if (!bufMid) {
+				return;
+			}
+		}
+
+		Color* colorsDst = dst.colors;
+		const sl_int16* w = ay.weights;
+		// the rows of [rowNext - n, rowNext) are in the ring
+		sl_uint32 rowNext = 0;
+		for (y = 0; y < dh; y++) {
+			sl_uint32 start = ay.starts[y];
+			sl_uint32 k;
+			if (bufMid) {
+				if (start > rowNext || start + n < rowNext) {
+					rowNext = start;
+				}
+				for (; rowNext < start + n; rowNext++) {
+					kernels.horizontal(bufMid + (sl_reg)(rowNext % n) * dw, src.colors + (sl_reg)rowNext * src.stride, dw, ax);
+				}
+				for (k = 0; k < n; k++) {
+					rows[k] = bufMid + (sl_reg)((start + k) % n) * dw;
+				}
+			} else {
+				for (k = 0; k < n; k++) {
+					rows[k] = src.colors + (sl_reg)(start + k) * src.stride;
+				}
+			}
+			if (flagBlend) {
+				kernels.vertical(line, rows, 0, dw, w, n);
+				kernels.blend(colorsDst, line, dw);
+			} else {
+				kernels.vertical(colorsDst, rows, 0, dw, w, n);
+			}
+			colorsDst += dst.stride;
+			w += n;
+		}
+
+		if (bufMid) {
+			Base::freeMemory(bufMid);
+		}
+	}
+
+}
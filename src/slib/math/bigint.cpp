@@ -197,6 +197,235 @@ namespace slib
 		return of;
 	}
 
+/*
+	Limbs: the multiplication kernels work on the machine words (64-bit on 64-bit platforms).
+	The elements (32-bit) are converted to the limbs before the operation, and converted back after.
+*/
+#if defined(SLIB_ARCH_IS_64BIT)
+	typedef sl_uint64 _cbigint_limb;
+#	define CBIGINT_LIMB_BITS 64
+#else
+	typedef sl_uint32 _cbigint_limb;
+#	define CBIGINT_LIMB_BITS 32
+#endif
+#define CBIGINT_ELEMENTS_PER_LIMB (CBIGINT_LIMB_BITS / 32)
+// in limbs. below this, the schoolbook multiplication is faster
+#define CBIGINT_KARATSUBA_THRESHOLD (1024 / CBIGINT_LIMB_BITS)
+
+	// returns the low limb of (a * b + c + d), and the high limb in `o`
+	SLIB_INLINE static _cbigint_limb _cbigint_limb_muladd(_cbigint_limb a, _cbigint_limb b, _cbigint_limb c, _cbigint_limb d, _cbigint_limb& o) noexcept
+	{
+#if defined(SLIB_ARCH_IS_64BIT)
+#	if defined(SLIB_COMPILER_IS_GCC) && defined(__SIZEOF_INT128__)
+		// compiled to `mulx` when BMI2 is available
+		unsigned __int128 m = (unsigned __int128)a * b + c + d;
+		o = (sl_uint64)(m >> 64);
+		return (sl_uint64)m;
+#	else
+		sl_uint64 h, l;
+		Math::mul64(a, b, h, l);
+		l += c;
+		h += (l < c);
+		l += d;
+		h += (l < d);
+		o = h;
+		return l;
+#	endif
+#else
+		sl_uint64 m = (sl_uint64)a * b + c + d;
+		o = (sl_uint32)(m >> 32);
+		return (sl_uint32)m;
+#endif
+	}
+
+	static sl_size _cbigint_get_limbs_count(sl_size nElements) noexcept
+	{
+		return (nElements + CBIGINT_ELEMENTS_PER_LIMB - 1) / CBIGINT_ELEMENTS_PER_LIMB;
+	}
+
+	static void _cbigint_to_limbs(_cbigint_limb* limbs, sl_size nLimbs, const sl_uint32* elements, sl_size nElements) noexcept
+	{
+#if CBIGINT_ELEMENTS_PER_LIMB == 2
+		for (sl_size i = 0; i < nLimbs; i++) {
+			sl_size k = i << 1;
+			_cbigint_limb l = k < nElements ? elements[k] : 0;
+			if (k + 1 < nElements) {
+				l |= ((_cbigint_limb)(elements[k + 1])) << 32;
+			}
+			limbs[i] = l;
+		}
+#else
+		for (sl_size i = 0; i < nLimbs; i++) {
+			limbs[i] = i < nElements ? elements[i] : 0;
+		}
+#endif
+	}
+
+	static void _cbigint_from_limbs(sl_uint32* elements, sl_size nElements, const _cbigint_limb* limbs, sl_size nLimbs) noexcept
+	{
+		for (sl_size i = 0; i < nElements; i++) {
+			sl_size k = i / CBIGINT_ELEMENTS_PER_LIMB;
+			elements[i] = k < nLimbs ? (sl_uint32)(limbs[k] >> ((i % CBIGINT_ELEMENTS_PER_LIMB) * 32)) : 0;
+		}
+	}
+
+	// c = a + b (na >= nb), returns carry
+	static _cbigint_limb _cbigint_add_limbs(_cbigint_limb* c, const _cbigint_limb* a, sl_size na, const _cbigint_limb* b, sl_size nb) noexcept
+	{
+		_cbigint_limb carry = 0;
+		sl_size i = 0;
+		for (; i < nb; i++) {
+			_cbigint_limb s = a[i] + carry;
+			carry = s < carry;
+			_cbigint_limb t = s + b[i];
+			carry += t < s;
+			c[i] = t;
+		}
+		for (; i < na; i++) {
+			_cbigint_limb s = a[i] + carry;
+			carry = s < carry;
+			c[i] = s;
+		}
+		return carry;
+	}
+
+	// c = a - b (na >= nb), returns borrow
+	static _cbigint_limb _cbigint_sub_limbs(_cbigint_limb* c, const _cbigint_limb* a, sl_size na, const _cbigint_limb* b, sl_size nb) noexcept
+	{
+		_cbigint_limb borrow = 0;
+		sl_size i = 0;
+		for (; i < nb; i++) {
+			_cbigint_limb s = a[i] - borrow;
+			borrow = a[i] < borrow;
+			borrow += s < b[i];
+			c[i] = s - b[i];
+		}
+		for (; i < na; i++) {
+			_cbigint_limb s = a[i] - borrow;
+			borrow = a[i] < borrow;
+			c[i] = s;
+		}
+		return borrow;
+	}
+
+	// out[na + nb] = a * b, out is not overlapped with a, b
+	static void _cbigint_mul_limbs_basecase(_cbigint_limb* out, const _cbigint_limb* a, sl_size na, const _cbigint_limb* b, sl_size nb) noexcept
+	{
+		Base::zeroMemory(out, (na + nb) * sizeof(_cbigint_limb));
+		for (sl_size ib = 0; ib < nb; ib++) {
+			_cbigint_limb o = 0;
+			_cbigint_limb m = b[ib];
+			_cbigint_limb* c = out + ib;
+			for (sl_size ia = 0; ia < na; ia++) {
+				c[ia] = _cbigint_limb_muladd(a[ia], m, c[ia], o, o);
+			}
+			c[na] = o;
+		}
+	}
+
+	// size of the work buffer used by `_cbigint_mul_limbs_karatsuba(n)`
+	static sl_size _cbigint_get_karatsuba_work_size(sl_size n) noexcept
+	{
+		sl_size size = 0;
+		while (n >= CBIGINT_KARATSUBA_THRESHOLD) {
+			sl_size k = n - n / 2;
+			size += 4 * (k + 1);
+			n = k + 1;
+		}
+		return size;
+	}
+
+	/*
+		out[2n] = a[n] * b[n]
+		(a0 + a1*W) * (b0 + b1*W) = a0*b0 + ((a0+a1)*(b0+b1) - a0*b0 - a1*b1)*W + a1*b1*W^2
+	*/
+	static void _cbigint_mul_limbs_karatsuba(_cbigint_limb* out, const _cbigint_limb* a, const _cbigint_limb* b, sl_size n, _cbigint_limb* work) noexcept
+	{
+		if (n < CBIGINT_KARATSUBA_THRESHOLD) {
+			_cbigint_mul_limbs_basecase(out, a, n, b, n);
+			return;
+		}
+		sl_size h = n / 2;
+		sl_size k = n - h;
+		_cbigint_limb* sa = work;
+		_cbigint_limb* sb = sa + (k + 1);
+		_cbigint_limb* z1 = sb + (k + 1);
+		_cbigint_limb* next = z1 + 2 * (k + 1);
+		_cbigint_mul_limbs_karatsuba(out, a, b, h, next);
+		_cbigint_mul_limbs_karatsuba(out + 2 * h, a + h, b + h, k, next);
+		sa[k] = _cbigint_add_limbs(sa, a + h, k, a, h);
+		sb[k] = _cbigint_add_limbs(sb, b + h, k, b, h);
+		_cbigint_mul_limbs_karatsuba(z1, sa, sb, k + 1, next);
+		_cbigint_sub_limbs(z1, z1, 2 * (k + 1), out, 2 * h);
+		_cbigint_sub_limbs(z1, z1, 2 * (k + 1), out + 2 * h, 2 * k);
+		// the middle term fits in (h + 2k) limbs
+		_cbigint_add_limbs(out + h, out + h, h + 2 * k, z1, Math::min(2 * (k + 1), h + 2 * k));
+	}
+
+	// out[na + nb] = a * b, work: 2 * min(na, nb) + _cbigint_get_karatsuba_work_size(min(na, nb))
+	static void _cbigint_mul_limbs(_cbigint_limb* out, const _cbigint_limb* a, sl_size na, const _cbigint_limb* b, sl_size nb, _cbigint_limb* work) noexcept
+	{
+		if (na < nb) {
+			Swap(a, b);
+			Swap(na, nb);
+		}
+		if (nb < CBIGINT_KARATSUBA_THRESHOLD) {
+			_cbigint_mul_limbs_basecase(out, a, na, b, nb);
+			return;
+		}
+		if (na == nb) {
+			_cbigint_mul_limbs_karatsuba(out, a, b, na, work);
+			return;
+		}
+		// multiplies by the slices of `a` in the size of `b`
+		Base::zeroMemory(out, (na + nb) * sizeof(_cbigint_limb));
+		_cbigint_limb* t = work;
+		for (sl_size i = 0; i < na; i += nb) {
+			sl_size n = Math::min(nb, na - i);
+			if (n == nb) {
+				_cbigint_mul_limbs_karatsuba(t, a + i, b, nb, work + 2 * nb);
+			} else {
+				_cbigint_mul_limbs_basecase(t, b, nb, a + i, n);
+			}
+			_cbigint_add_limbs(out + i, out + i, na + nb - i, t, n + nb);
+		}
+	}
+
+	/*
+		Montgomery multiplication (CIOS): r = a * b * R^-1 mod m,  R = W^n
+			a, b < m. r can be overlapped with a, b
+			t: n + 2 limbs
+	*/
+	static void _cbigint_mont_mul_limbs(_cbigint_limb* r, const _cbigint_limb* a, const _cbigint_limb* b, const _cbigint_limb* m, sl_size n, _cbigint_limb mi, _cbigint_limb* t) noexcept
+	{
+		Base::zeroMemory(t, (n + 2) * sizeof(_cbigint_limb));
+		for (sl_size i = 0; i < n; i++) {
+			_cbigint_limb o = 0;
+			_cbigint_limb bi = b[i];
+			sl_size j;
+			for (j = 0; j < n; j++) {
+				t[j] = _cbigint_limb_muladd(a[j], bi, t[j], o, o);
+			}
+			_cbigint_limb s = t[n] + o;
+			t[n + 1] = s < o;
+			t[n] = s;
+			_cbigint_limb u = t[0] * mi;
+			_cbigint_limb_muladd(u, m[0], t[0], 0, o);
+			for (j = 1; j < n; j++) {
+				t[j - 1] = _cbigint_limb_muladd(u, m[j], t[j], o, o);
+			}
+			s = t[n] + o;
+			t[n - 1] = s;
+			t[n] = t[n + 1] + (s < o);
+		}
+		// r = t - m, if t >= m (selected without branch)
+		_cbigint_limb borrow = _cbigint_sub_limbs(r, t, n, m, n);
+		_cbigint_limb mask = (_cbigint_limb)0 - (borrow & (t[n] ^ 1));
+		for (sl_size j = 0; j < n; j++) {
+			r[j] = (t[j] & mask) | (r[j] & ~mask);
+		}
+	}
+
 
 	// returns remainder
 	SLIB_INLINE static sl_uint32 _cbigint_div_uint32(sl_uint32* q, const sl_uint32* a, sl_size n, sl_uint32 b, sl_uint32 o) noexcept
@@ -1427,37 +1656,33 @@ namespace slib
 		} else {
 			nd = getMostSignificantElements();
 		}
-		sl_size n = na + nb;
-		SLIB_SCOPED_BUFFER(sl_uint64, STACK_BUFFER_SIZE, out, n);
-		if (!out) {
+		sl_size nla = _cbigint_get_limbs_count(na);
+		sl_size nlb = _cbigint_get_limbs_count(nb);
+		sl_size nlMin = Math::min(nla, nlb);
+		sl_size nlOut = nla + nlb;
+		sl_size nWork = 2 * nlMin + _cbigint_get_karatsuba_work_size(nlMin);
+		SLIB_SCOPED_BUFFER(_cbigint_limb, STACK_BUFFER_SIZE, limbs, nla + nlb + nlOut + nWork);
+		if (!limbs) {
 			return sl_false;
 		}
-		Base::zeroMemory(out, 8 * n);
-		for (sl_size ib = 0; ib < nb; ib++) {
-			for (sl_size ia = 0; ia < na; ia++) {
-				sl_uint64 c = a.elements[ia];
-				c *= b.elements[ib];
-				out[ia + ib] += (sl_uint32)c;
-				out[ia + ib + 1] += (sl_uint32)(c >> 32);
-			}
-		}
-		sl_uint32 o = 0;
-		sl_size i;
-		sl_size m = 0;
-		for (i = 0; i < n; i++) {
-			sl_uint64 c = out[i] + o;
-			sl_uint32 t = (sl_uint32)c;
-			out[i] = t;
-			if (t) {
-				m = i;
+		_cbigint_limb* la = limbs;
+		_cbigint_limb* lb = la + nla;
+		_cbigint_limb* out = lb + nlb;
+		_cbigint_to_limbs(la, nla, a.elements, na);
+		_cbigint_to_limbs(lb, nlb, b.elements, nb);
+		_cbigint_mul_limbs(out, la, nla, lb, nlb, out + nlOut);
+		sl_size n = na + nb;
+		sl_size m = n;
+		while (m > 1) {
+			sl_size k = m - 1;
+			if ((out[k / CBIGINT_ELEMENTS_PER_LIMB] >> ((k % CBIGINT_ELEMENTS_PER_LIMB) * 32)) & 0xFFFFFFFF) {
+				break;
 			}
-			o = (sl_uint32)(c >> 32);
+			m--;
 		}
-		if (growLength(m + 1)) {
-			for (i = 0; i <= m; i++) {
-				elements[i] = (sl_uint32)(out[i]);
-			}
-			for (; i < nd; i++) {
+		if (growLength(m)) {
+			_cbigint_from_limbs(elements, m, out, nlOut);
+			for (sl_size i = m; i < nd; i++) {
 				elements[i] = 0;
 			}
 			return sl_true;
@@ -2002,165 +2227,13 @@ namespace slib
 		return pow(*this, E);
 	}
 
-/*
-	Montgomery multiplication: A = A * B * R^-1 mod M
-*/
-	static sl_bool _cbigint_mont_mul(CBigInt& A, const CBigInt& B, const CBigInt& M, sl_uint32 MI) noexcept
-	{
-		sl_size nM = M.length;
-		sl_size nB = Math::min(nM, B.length);
-		
-		sl_size nOut = nM * 2 + 1;
-		SLIB_SCOPED_BUFFER(sl_uint32, STACK_BUFFER_SIZE, out, nOut);
-		if (!out) {
-			return sl_false;
-		}
-		Base::zeroMemory(out, nOut * 4);
-		for (sl_size i = 0; i < nM; i++) {
-			// T = (T + cB*B + cM*M) / 2^(32*nM)
-			sl_uint32 cB = i < A.length ? A.elements[i] : 0;
-			sl_uint32 cM = (out[0] + cB * B.elements[0]) * MI;
-			_cbigint_muladd_uint32(out, out, nOut, B.elements, nB, cB, 0);
-			_cbigint_muladd_uint32(out, out, nOut, M.elements, nM, cM, 0);
-			*out = cB;
-			nOut--;
-			out++;
-		}
-		if (!A.setValueFromElements(out, nM + 1)) {
-			return sl_false;
-		}
-		if (A.compareAbs(M) >= 0) {
-			if (!A.subAbs(A, M)) {
-				return sl_false;
-			}
-		}
-		return sl_true;
-	}
-
-/*
-	Montgomery reduction: A = A * R^-1 mod M
-*/
-	SLIB_INLINE static sl_bool _cbigint_mont_reduction(CBigInt& A, const CBigInt& M, sl_uint32 MI) noexcept
+	sl_bool CBigInt::pow_montgomery(const CBigInt& A, const CBigInt& E, const CBigInt& M) noexcept
 	{
-		CBIGINT_UINT32(o, 1);
-		return _cbigint_mont_mul(A, o, M, MI);
-	}
-
-	sl_bool CBigInt::pow_montgomery(const CBigInt& A, const CBigInt& inE, const CBigInt& inM) noexcept
-	{
-		CBigInt M;
-		M.copyFrom(inM);
-		if (!M.compact()) {
-			return sl_false;
-		}
-		sl_size nM = M.getMostSignificantElements();
-		if (nM == 0) {
-			return sl_false;
-		}
-		if (M.sign < 0) {
-			return sl_false;
-		}
-		const CBigInt* pE;
-		CBigInt _t_E;
-		if (&inE == this) {
-			pE = &_t_E;
-			if (!_t_E.copyFrom(inE)) {
-				return sl_false;
-			}
-		} else {
-			pE = &inE;
-		}
-		const CBigInt& E = *pE;
-		sl_size nE = E.getMostSignificantElements();
-		if (nE == 0) {
-			if (!setValue((sl_uint32)1)) {
-				return sl_false;
-			}
-			sign = 1;
-			return sl_true;
-		}
-		if (E.sign < 0) {
-			return sl_false;
-		}
-		sl_size nA = A.getMostSignificantElements();
-		if (nA == 0) {
-			setZero();
-			return sl_true;
-		}
-
-		// MI = -(M0^-1) mod (2^32)
-		sl_uint32 MI;
-		// initialize montgomery
-		{
-			sl_uint32 M0 = M.elements[0];
-			sl_uint32 K = M0;
-			K += ((M0 + 2) & 4) << 1;
-			for (sl_uint32 i = 32; i >= 8; i /= 2) {
-				K *= (2 - (M0 * K));
-			}
-			MI = 0 - K;
-		}
-
-		// pre-compute R^2 mod M
-		// R = 2^(nM*32)
-		CBigInt R2;
-		{
-			if (!R2.setValue((sl_uint32)1)) {
-				return sl_false;
-			}
-			if (!R2.shiftLeft(nM * 64)) {
-				return sl_false;
-			}
-			if (!CBigInt::divAbs(R2, M, sl_null, &R2)) {
-				return sl_false;
-			}
-		}
-
-		sl_bool flagNegative = A.sign < 0;
-		// T = A * R^2 * R^-1 mod M = A * R mod M
-		CBigInt T;
-		if (!CBigInt::divAbs(A, M, sl_null, &T)) {
-			return sl_false;
-		}
-		if (!_cbigint_mont_mul(T, R2, M, MI)) {
-			return sl_false;
-		}
-
-		// C = R^2 * R^-1 mod M = R mod M
-		if (!copyFrom(R2)) {
-			return sl_false;
-		}
-		if (!_cbigint_mont_reduction(*this, M, MI)) {
-			return sl_false;
-		}
-
-		sl_size nbE = E.getMostSignificantBits();
-		for (sl_size ib = 0; ib < nbE; ib++) {
-			sl_size ke = ib >> 5;
-			sl_uint32 kb = (sl_uint32)(ib & 31);
-			if (((E.elements[ke]) >> kb) & 1) {
-				// C = C * T * R^-1 mod M
-				if (!_cbigint_mont_mul(*this, T, M, MI)) {
-					return sl_false;
-				}
-			}
-			// T = T * T * R^-1 mod M
-			if (!_cbigint_mont_mul(T, T, M, MI)) {
-				return sl_false;
-			}
-		}
-		if (!_cbigint_mont_reduction(*this, M, MI)) {
+		Ref<CBigIntMontgomery> context = CBigIntMontgomery::create(M);
+		if (context.isNull()) {
 			return sl_false;
 		}
-		if (flagNegative && (E.elements[0] & 1) != 0) {
-			sign = -1;
-			if (!add(M)) {
-				return sl_false;
-			}
-		} else {
-			sign = 1;
-		}
-		return sl_true;
+		return context->pow(*this, A, E);
 	}
 
 	sl_bool CBigInt::pow_montgomery(const CBigInt& E, const CBigInt& M) noexcept
@@ -4778,4 +4851,255 @@ namespace slib
 		return BigInt::shiftRight(a, n);
 	}
 
+
+	SLIB_DEFINE_ROOT_OBJECT(CBigIntMontgomery)
+
+	CBigIntMontgomery::CBigIntMontgomery() noexcept
+	{
+		m_nLimbs = 0;
+		m_MI = 0;
+	}
+
+	CBigIntMontgomery::~CBigIntMontgomery() noexcept
+	{
+	}
+
+	Ref<CBigIntMontgomery> CBigIntMontgomery::create(const CBigInt& M) noexcept
+	{
+		if (M.sign < 0) {
+			return sl_null;
+		}
+		sl_size nM = M.getMostSignificantElements();
+		if (nM == 0 || !(M.elements[0] & 1)) {
+			return sl_null;
+		}
+		Ref<CBigIntMontgomery> ret = new CBigIntMontgomery;
+		if (ret.isNull()) {
+			return sl_null;
+		}
+		if (!(ret->m_M.setValueFromElements(M.elements, nM))) {
+			return sl_null;
+		}
+		sl_size n = _cbigint_get_limbs_count(nM);
+		Memory mem = Memory::create(3 * n * sizeof(_cbigint_limb));
+		if (mem.isNull()) {
+			return sl_null;
+		}
+		_cbigint_limb* m = (_cbigint_limb*)(mem.getData());
+		_cbigint_limb* rm = m + n;
+		_cbigint_limb* r2 = rm + n;
+		_cbigint_to_limbs(m, n, M.elements, nM);
+
+		// MI = -(M0^-1) mod W: Newton's iteration doubles the correct bits (5 bits initially)
+		_cbigint_limb M0 = m[0];
+		_cbigint_limb K = (3 * M0) ^ 2;
+		for (sl_uint32 i = 5; i < CBIGINT_LIMB_BITS; i *= 2) {
+			K *= 2 - M0 * K;
+		}
+		_cbigint_limb MI = 0 - K;
+
+		// R^2 mod M,  R = W^n
+		{
+			CBigInt R2;
+			if (!(R2.setValue((sl_uint32)1))) {
+				return sl_null;
+			}
+			if (!(R2.shiftLeft(n * CBIGINT_LIMB_BITS * 2))) {
+				return sl_null;
+			}
+			if (!(CBigInt::divAbs(R2, ret->m_M, sl_null, &R2))) {
+				return sl_null;
+			}
+			_cbigint_to_limbs(r2, n, R2.elements, Math::min(R2.length, n * CBIGINT_ELEMENTS_PER_LIMB));
+		}
+		// R mod M = R^2 * R^-1 mod M
+		{
+			SLIB_SCOPED_BUFFER(_cbigint_limb, 256, t, 2 * n + 2);
+			if (!t) {
+				return sl_null;
+			}
+			_cbigint_limb* one = t + n + 2;
+			Base::zeroMemory(one, n * sizeof(_cbigint_limb));
+			one[0] = 1;
+			_cbigint_mont_mul_limbs(rm, r2, one, m, n, MI, t);
+		}
+
+		ret->m_nLimbs = n;
+		ret->m_limbs = mem;
+		ret->m_MI = MI;
+		return ret;
+	}
+
+	Ref<CBigIntMontgomery> CBigIntMontgomery::create(const BigInt& M) noexcept
+	{
+		CBigInt* m = M.ref.get();
+		if (m) {
+			return create(*m);
+		}
+		return sl_null;
+	}
+
+	const CBigInt& CBigIntMontgomery::getModulus() const noexcept
+	{
+		return m_M;
+	}
+
+	sl_bool CBigIntMontgomery::isModulus(const BigInt& M) const noexcept
+	{
+		CBigInt* m = M.ref.get();
+		if (m) {
+			return m->compare(m_M) == 0;
+		}
+		return sl_false;
+	}
+
+	sl_bool CBigIntMontgomery::pow(CBigInt& C, const CBigInt& A, const CBigInt& E) const noexcept
+	{
+		sl_size n = m_nLimbs;
+		if (!n) {
+			return sl_false;
+		}
+		if (E.sign < 0) {
+			return sl_false;
+		}
+		sl_size nbE = E.getMostSignificantBits();
+		if (nbE == 0) {
+			if (!(C.setValue((sl_uint32)1))) {
+				return sl_false;
+			}
+			C.sign = 1;
+			return sl_true;
+		}
+		sl_size nA = A.getMostSignificantElements();
+		if (nA == 0) {
+			C.setZero();
+			return sl_true;
+		}
+		sl_bool flagNegative = A.sign < 0;
+		sl_bool flagOddE = (E.elements[0] & 1) != 0;
+
+		// window size by the bits of the exponent
+		sl_uint32 w;
+		if (nbE > 671) {
+			w = 6;
+		} else if (nbE > 239) {
+			w = 5;
+		} else if (nbE > 79) {
+			w = 4;
+		} else if (nbE > 23) {
+			w = 3;
+		} else {
+			w = 1;
+		}
+		sl_size nTable = (sl_size)1 << w;
+
+		sl_size nLimbs = n * (nTable + 3) + 2;
+		SLIB_SCOPED_BUFFER(_cbigint_limb, STACK_BUFFER_SIZE, limbs, nLimbs);
+		if (!limbs) {
+			return sl_false;
+		}
+		const _cbigint_limb* m = (const _cbigint_limb*)(m_limbs.getData());
+		const _cbigint_limb* rm = m + n;
+		const _cbigint_limb* r2 = rm + n;
+		_cbigint_limb MI = (_cbigint_limb)m_MI;
+		_cbigint_limb* table = limbs;
+		_cbigint_limb* x = table + n * nTable;
+		_cbigint_limb* sel = x + n;
+		_cbigint_limb* t = sel + n;
+
+		// a = (|A| mod M) * R mod M
+		_cbigint_limb* a = table + n;
+		if (A.compareAbs(m_M) >= 0) {
+			CBigInt T;
+			if (!(CBigInt::divAbs(A, m_M, sl_null, &T))) {
+				return sl_false;
+			}
+			_cbigint_to_limbs(a, n, T.elements, Math::min(T.length, n * CBIGINT_ELEMENTS_PER_LIMB));
+		} else {
+			_cbigint_to_limbs(a, n, A.elements, nA);
+		}
+		_cbigint_mont_mul_limbs(a, a, r2, m, n, MI, t);
+
+		// table[i] = a^i * R mod M
+		Base::copyMemory(table, rm, n * sizeof(_cbigint_limb));
+		for (sl_size i = 2; i < nTable; i++) {
+			_cbigint_mont_mul_limbs(table + i * n, table + (i - 1) * n, a, m, n, MI, t);
+		}
+
+		Base::copyMemory(x, rm, n * sizeof(_cbigint_limb));
+		sl_size nWindows = (nbE + w - 1) / w;
+		for (sl_size iw = nWindows; iw > 0; iw--) {
+			if (iw != nWindows) {
+				for (sl_uint32 k = 0; k < w; k++) {
+					_cbigint_mont_mul_limbs(x, x, x, m, n, MI, t);
+				}
+			}
+			sl_size pos = (iw - 1) * w;
+			sl_uint32 bits = 0;
+			for (sl_uint32 k = 0; k < w; k++) {
+				sl_size ib = pos + k;
+				sl_size ie = ib >> 5;
+				if (ie < E.length) {
+					bits |= ((E.elements[ie] >> (ib & 31)) & 1) << k;
+				}
+			}
+			if (w == 1) {
+				// short (public) exponent
+				if (bits) {
+					_cbigint_mont_mul_limbs(x, x, a, m, n, MI, t);
+				}
+			} else {
+				// reads all the entries, not to leak the window by the memory access
+				Base::zeroMemory(sel, n * sizeof(_cbigint_limb));
+				for (sl_size i = 0; i < nTable; i++) {
+					_cbigint_limb mask = (_cbigint_limb)0 - (_cbigint_limb)(i == bits);
+					const _cbigint_limb* e = table + i * n;
+					for (sl_size j = 0; j < n; j++) {
+						sel[j] |= e[j] & mask;
+					}
+				}
+				_cbigint_mont_mul_limbs(x, x, sel, m, n, MI, t);
+			}
+		}
+
+		// C = x * R^-1 mod M
+		Base::zeroMemory(sel, n * sizeof(_cbigint_limb));
+		sel[0] = 1;
+		_cbigint_mont_mul_limbs(x, x, sel, m, n, MI, t);
+
+		sl_size nC = n * CBIGINT_ELEMENTS_PER_LIMB;
+		if (!(C.growLength(nC))) {
+			return sl_false;
+		}
+		_cbigint_from_limbs(C.elements, C.length, x, n);
+		if (flagNegative && flagOddE) {
+			C.sign = -1;
+			if (!(C.add(m_M))) {
+				return sl_false;
+			}
+		} else {
+			C.sign = 1;
+		}
+		return sl_true;
+	}
+
+	BigInt CBigIntMontgomery::pow(const BigInt& A, const BigInt& E) const noexcept
+	{
+		CBigInt* a = A.ref._ptr;
+		CBigInt* e = E.ref._ptr;
+		if (!e || e->isZero()) {
+			return BigInt::fromInt32(1);
+		}
+		if (a) {
+			CBigInt* r = new CBigInt;
+			if (r) {
+				if (pow(*r, *a, *e)) {
+					return r;
+				}
+				delete r;
+			}
+		}
+		return sl_null;
+	}
+
 }
@@ -11,6 +11,7 @@
 #include "slib/media/audio_data.h"
 
 #include "slib/media/audio_util.h"
+#include "slib/media/audio_resampler.h"
 #include "slib/core/endian.h"
 
 namespace slib
@@ -397,6 +398,61 @@ namespace slib
 		}
 	}
 
+	static sl_bool _priv_AudioData_isNativeSampleType(AudioSampleType type, AudioSampleType native, AudioSampleType nativeLE, AudioSampleType nativeBE)
+	{
+		if (type == native) {
+			return sl_true;
+		}
+		if (Endian::isLE()) {
+			return type == nativeLE;
+		} else {
+			return type == nativeBE;
+		}
+	}
+
+	// vectorized paths of `AudioUtil::convertSamples()` for the same channel layout
+	static sl_bool _priv_AudioData_convertPlanes(sl_size count, AudioFormat format_in, sl_uint8* data_in, sl_uint8* data_in1, AudioFormat format_out, sl_uint8* data_out, sl_uint8* data_out1)
+	{
+		sl_uint32 nChannels = AudioFormats::getChannelsCount(format_in);
+		if (nChannels != AudioFormats::getChannelsCount(format_out)) {
+			return sl_false;
+		}
+		sl_uint32 nPlanes = 1;
+		if (nChannels == 2) {
+			if (AudioFormats::isNonInterleaved(format_in) != AudioFormats::isNonInterleaved(format_out)) {
+				return sl_false;
+			}
+			if (AudioFormats::isNonInterleaved(format_in)) {
+				nPlanes = 2;
+			} else {
+				count *= 2;
+			}
+		}
+		AudioSampleType type_in = AudioFormats::getSampleType(format_in);
+		AudioSampleType type_out = AudioFormats::getSampleType(format_out);
+		if (_priv_AudioData_isNativeSampleType(type_in, AudioSampleType::Int16, AudioSampleType::Int16LE, AudioSampleType::Int16BE) && _priv_AudioData_isNativeSampleType(type_out, AudioSampleType::Float, AudioSampleType::FloatLE, AudioSampleType::FloatBE)) {
+			if ((((sl_size)data_in | (sl_size)data_in1) & 1) || (((sl_size)data_out | (sl_size)data_out1) & 3)) {
+				return sl_false;
+			}
+			AudioUtil::convertSamples(count, (sl_int16*)data_in, (float*)data_out);
+			if (nPlanes == 2) {
+				AudioUtil::convertSamples(count, (sl_int16*)data_in1, (float*)data_out1);
+			}
+			return sl_true;
+		}
+		if (_priv_AudioData_isNativeSampleType(type_in, AudioSampleType::Float, AudioSampleType::FloatLE, AudioSampleType::FloatBE) && _priv_AudioData_isNativeSampleType(type_out, AudioSampleType::Int16, AudioSampleType::Int16LE, AudioSampleType::Int16BE)) {
+			if ((((sl_size)data_in | (sl_size)data_in1) & 3) || (((sl_size)data_out | (sl_size)data_out1) & 1)) {
+				return sl_false;
+			}
+			AudioUtil::convertSamples(count, (float*)data_in, (sl_int16*)data_out);
+			if (nPlanes == 2) {
+				AudioUtil::convertSamples(count, (float*)data_in1, (sl_int16*)data_out1);
+			}
+			return sl_true;
+		}
+		return sl_false;
+	}
+
 	void AudioData::copySamplesFrom(const AudioData& other, sl_size countSamples) const
 	{
 		if (format == AudioFormat::None) {
@@ -415,16 +471,16 @@ namespace slib
 			return;
 		}
 		
-		sl_uint8* data_in = (sl_uint8*)data;
-		sl_uint8* data_in1 = (sl_uint8*)data1;
-		if (AudioFormats::isNonInterleaved(format) && !data_in1) {
-			data_in1 = data_in + getSizeForChannel();
+		sl_uint8* data_in = (sl_uint8*)(other.data);
+		sl_uint8* data_in1 = (sl_uint8*)(other.data1);
+		if (AudioFormats::isNonInterleaved(other.format) && !data_in1) {
+			data_in1 = data_in + other.getSizeForChannel();
 		}
 		
-		sl_uint8* data_out = (sl_uint8*)(other.data);
-		sl_uint8* data_out1 = (sl_uint8*)(other.data1);
-		if (AudioFormats::isNonInterleaved(other.format) && !data_out1) {
-			data_out1 = data_out + other.getSizeForChannel();
+		sl_uint8* data_out = (sl_uint8*)data;
+		sl_uint8* data_out1 = (sl_uint8*)data1;
+		if (AudioFormats::isNonInterleaved(format) && !data_out1) {
+			data_out1 = data_out + getSizeForChannel();
 		}
 		
 		if (format == other.format) {
@@ -439,7 +495,11 @@ namespace slib
 			return;
 		}
 		
-		_priv_AudioData_copySamples(countSamples, format, data_in, data_in1, other.format, data_out, data_out1);
+		if (_priv_AudioData_convertPlanes(countSamples, other.format, data_in, data_in1, format, data_out, data_out1)) {
+			return;
+		}
+		
+		_priv_AudioData_copySamples(countSamples, other.format, data_in, data_in1, format, data_out, data_out1);
 	}
 
 	void AudioData::copySamplesFrom(const AudioData& other) const
@@ -447,4 +507,18 @@ namespace slib
 		copySamplesFrom(other, count);
 	}
 
+	sl_size AudioData::copySamplesFrom(const AudioData& other, AudioResampler* resampler) const
+	{
+		if (resampler) {
+			return resampler->process(other, *this);
+		}
+		if (count < other.count) {
+			copySamplesFrom(other, count);
+			return count;
+		} else {
+			copySamplesFrom(other, other.count);
+			return other.count;
+		}
+	}
+
 }
@@ -0,0 +1,490 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "slib/media/audio_resampler.h"
+
+#include "slib/media/audio_util.h"
+#include "slib/core/math.h"
+
+#if defined(SLIB_ARCH_IS_X64)
+#	define PRIV_AUDIO_SUPPORT_SSE2
+#	include <emmintrin.h>
+#endif
+
+#define PRIV_AUDIO_RESAMPLER_MAX_CHANNELS 8
+#define PRIV_AUDIO_RESAMPLER_MAX_FILTERS 256
+#define PRIV_AUDIO_RESAMPLER_CHUNK 1024
+
+namespace slib
+{
+
+	static double _priv_AudioResampler_besselI0(double x)
+	{
+		double sum = 1;
+		double term = 1;
+		double q = x * x / 4;
+		for (sl_uint32 k = 1; k < 64; k++) {
+			term *= q / (double)(k * k);
+			sum += term;
+			if (term < sum * 1e-12) {
+				break;
+			}
+		}
+		return sum;
+	}
+
+	// count of taps is multiple of 8
+	static float _priv_AudioResampler_dot(const float* x, const float* h, sl_uint32 n)
+	{
+#if defined(PRIV_AUDIO_SUPPORT_SSE2)
+		__m128 s0 = _mm_setzero_ps();
+		__m128 s1 = _mm_setzero_ps();
+		for (sl_uint32 i = 0; i < n; i += 8) {
+			s0 = _mm_add_ps(s0, _mm_mul_ps(_mm_loadu_ps(x + i), _mm_load_ps(h + i)));
+			s1 = _mm_add_ps(s1, _mm_mul_ps(_mm_loadu_ps(x + i + 4), _mm_load_ps(h + i + 4)));
+		}
+		s0 = _mm_add_ps(s0, s1);
+		s0 = _mm_add_ps(s0, _mm_movehl_ps(s0, s0));
+		s0 = _mm_add_ss(s0, _mm_shuffle_ps(s0, s0, 1));
+		return _mm_cvtss_f32(s0);
+#else
+		float s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+		for (sl_uint32 i = 0; i < n; i += 4) {
+			s0 += x[i] * h[i];
+			s1 += x[i + 1] * h[i + 1];
+			s2 += x[i + 2] * h[i + 2];
+			s3 += x[i + 3] * h[i + 3];
+		}
+		return (s0 + s1) + (s2 + s3);
+#endif
+	}
+
+	static AudioFormat _priv_AudioResampler_getFloatFormat(sl_uint32 nChannels)
+	{
+		if (nChannels == 1) {
+			return AudioFormat::Float_Mono;
+		} else {
+			return AudioFormat::Float_Stereo_NonInterleaved;
+		}
+	}
+
+	// `data` of `audio` is moved by `offset` samples
+	static void _priv_AudioResampler_offsetData(AudioData& audio, sl_size offset)
+	{
+		if (AudioFormats::isNonInterleaved(audio.format)) {
+			sl_size n = (offset * AudioFormats::getBitsPerSample(audio.format)) >> 3;
+			if (!(audio.data1)) {
+				audio.data1 = (sl_uint8*)(audio.data) + audio.getSizeForChannel();
+			}
+			audio.data = (sl_uint8*)(audio.data) + n;
+			audio.data1 = (sl_uint8*)(audio.data1) + n;
+		} else {
+			audio.data = (sl_uint8*)(audio.data) + ((offset * AudioFormats::getBitsPerSample(audio.format) * AudioFormats::getChannelsCount(audio.format)) >> 3);
+		}
+		audio.count -= offset;
+	}
+
+
+	AudioResamplerParam::AudioResamplerParam()
+	{
+		samplesPerSecondInput = 0;
+		samplesPerSecondOutput = 0;
+		channelsCount = 1;
+		quality = AudioResampleQuality::Medium;
+	}
+
+	AudioResamplerParam::~AudioResamplerParam()
+	{
+	}
+
+
+	SLIB_DEFINE_OBJECT(AudioResampler, Object)
+
+	AudioResampler::AudioResampler()
+	{
+		m_nSamplesPerSecondInput = 0;
+		m_nSamplesPerSecondOutput = 0;
+		m_nChannels = 0;
+
+		m_countPhases = 1;
+		m_step = 1;
+		m_phase = 0;
+
+		m_countFilters = 0;
+		m_countTaps = 0;
+
+		m_capacityInput = 0;
+		m_countInput = 0;
+		m_posInput = 0;
+	}
+
+	AudioResampler::~AudioResampler()
+	{
+	}
+
+	Ref<AudioResampler> AudioResampler::create(const AudioResamplerParam& param)
+	{
+		sl_uint32 rateIn = param.samplesPerSecondInput;
+		sl_uint32 rateOut = param.samplesPerSecondOutput;
+		sl_uint32 nChannels = param.channelsCount;
+		if (!rateIn || !rateOut || nChannels < 1 || nChannels > PRIV_AUDIO_RESAMPLER_MAX_CHANNELS) {
+			return sl_null;
+		}
+
+		sl_uint32 a = rateIn;
+		sl_uint32 b = rateOut;
+		while (b) {
+			sl_uint32 t = a % b;
+			a = b;
+			b = t;
+		}
+		sl_uint32 nPhases = rateOut / a;
+		sl_uint32 step = rateIn / a;
+		sl_uint32 nFilters = nPhases;
+		if (nFilters > PRIV_AUDIO_RESAMPLER_MAX_FILTERS) {
+			nFilters = PRIV_AUDIO_RESAMPLER_MAX_FILTERS;
+		}
+
+		sl_uint32 halfTaps;
+		double rolloff;
+		double beta;
+		switch (param.quality) {
+			case AudioResampleQuality::Fast:
+				halfTaps = 8;
+				rolloff = 0.85;
+				beta = 5.0;
+				break;
+			case AudioResampleQuality::High:
+				halfTaps = 32;
+				rolloff = 0.95;
+				beta = 9.5;
+				break;
+			default:
+				halfTaps = 16;
+				rolloff = 0.91;
+				beta = 7.0;
+				break;
+		}
+		// the kernel is widened by the decimation ratio, to cut below the output Nyquist frequency
+		double ratio = 1;
+		if (nPhases < step) {
+			ratio = (double)nPhases / (double)step;
+		}
+		double cutoff = 0.5 * ratio * rolloff;
+		sl_uint32 half = (sl_uint32)(Math::ceil(halfTaps / ratio));
+		half = (half + 3) & ~3u;
+		sl_uint32 nTaps = half * 2;
+
+		Memory filters = Memory::create(sizeof(float) * nTaps * (nFilters + 1) + 16);
+		if (filters.isNull()) {
+			return sl_null;
+		}
+		float* h = (float*)((((sl_size)(filters.getData())) + 15) & ~((sl_size)15));
+		double i0Beta = _priv_AudioResampler_besselI0(beta);
+		for (sl_uint32 iFilter = 0; iFilter <= nFilters; iFilter++) {
+			double frac = (double)iFilter / (double)nFilters;
+			double sum = 0;
+			for (sl_uint32 k = 0; k < nTaps; k++) {
+				// distance from the output position to the tap, in the input samples
+				double x = (double)k - (double)half + 1 - frac;
+				double r = x / (double)half;
+				double v = 0;
+				if (r > -1 && r < 1) {
+					double w = _priv_AudioResampler_besselI0(beta * Math::sqrt(1 - r * r)) / i0Beta;
+					double t = 2 * cutoff * x;
+					if (t == 0) {
+						v = 2 * cutoff;
+					} else {
+						v = Math::sin(SLIB_PI_LONG * t) / (SLIB_PI_LONG * x);
+					}
+					v *= w;
+				}
+				h[k] = (float)v;
+				sum += v;
+			}
+			// unity gain for DC
+			if (sum != 0) {
+				for (sl_uint32 k = 0; k < nTaps; k++) {
+					h[k] = (float)(h[k] / sum);
+				}
+			}
+			h += nTaps;
+		}
+
+		Memory output = Memory::create(sizeof(float) * PRIV_AUDIO_RESAMPLER_CHUNK * (nChannels + 2));
+		if (output.isNull()) {
+			return sl_null;
+		}
+
+		Ref<AudioResampler> ret = new AudioResampler;
+		if (ret.isNotNull()) {
+			ret->m_nSamplesPerSecondInput = rateIn;
+			ret->m_nSamplesPerSecondOutput = rateOut;
+			ret->m_nChannels = nChannels;
+			ret->m_countPhases = nPhases;
+			ret->m_step = step;
+			ret->m_filters = filters;
+			ret->m_countFilters = nFilters;
+			ret->m_countTaps = nTaps;
+			ret->m_output = output;
+			ret->reset();
+		}
+		return ret;
+	}
+
+	sl_uint32 AudioResampler::getSamplesCountPerSecondInput() const
+	{
+		return m_nSamplesPerSecondInput;
+	}
+
+	sl_uint32 AudioResampler::getSamplesCountPerSecondOutput() const
+	{
+		return m_nSamplesPerSecondOutput;
+	}
+
+	sl_uint32 AudioResampler::getChannelsCount() const
+	{
+		return m_nChannels;
+	}
+
+	sl_size AudioResampler::getOutputCount(sl_size countInput) const
+	{
+		sl_size end = m_countInput + countInput;
+		if (m_posInput + m_countTaps > end) {
+			return 0;
+		}
+		// outputs k = 0, 1, ...  while (m_phase + k * m_step) / m_countPhases <= end - m_countTaps - m_posInput
+		sl_uint64 n = (sl_uint64)(end - m_countTaps - m_posInput) * m_countPhases + (m_countPhases - 1 - m_phase);
+		return (sl_size)(n / m_step + 1);
+	}
+
+	sl_size AudioResampler::process(const AudioData& input, const AudioData& output)
+	{
+		sl_uint32 nChannelsIn = 0;
+		if (input.format != AudioFormat::None && input.count) {
+			nChannelsIn = AudioFormats::getChannelsCount(input.format);
+			if (!_appendInput(input.count)) {
+				return 0;
+			}
+			float* base = (float*)(m_input.getData());
+			if (nChannelsIn == m_nChannels || (nChannelsIn <= 2 && m_nChannels <= 2)) {
+				// `copySamplesFrom()` converts the format and mono/stereo
+				AudioData history;
+				history.format = _priv_AudioResampler_getFloatFormat(m_nChannels);
+				history.count = input.count;
+				history.data = base + m_countInput;
+				history.data1 = base + m_capacityInput + m_countInput;
+				history.copySamplesFrom(input);
+			} else {
+				float* planesIn[2];
+				planesIn[0] = (float*)(m_output.getData()) + PRIV_AUDIO_RESAMPLER_CHUNK * m_nChannels;
+				planesIn[1] = planesIn[0] + PRIV_AUDIO_RESAMPLER_CHUNK;
+				AudioData temp;
+				temp.format = _priv_AudioResampler_getFloatFormat(nChannelsIn);
+				temp.data = planesIn[0];
+				temp.data1 = planesIn[1];
+				temp.count = PRIV_AUDIO_RESAMPLER_CHUNK;
+				AudioData src = input;
+				sl_size offset = 0;
+				while (offset < input.count) {
+					sl_size n = input.count - offset;
+					if (n > PRIV_AUDIO_RESAMPLER_CHUNK) {
+						n = PRIV_AUDIO_RESAMPLER_CHUNK;
+					}
+					temp.copySamplesFrom(src, n);
+					float* planesOut[PRIV_AUDIO_RESAMPLER_MAX_CHANNELS];
+					for (sl_uint32 i = 0; i < m_nChannels; i++) {
+						planesOut[i] = base + m_capacityInput * i + m_countInput + offset;
+					}
+					AudioUtil::mixChannels(n, planesIn, nChannelsIn, planesOut, m_nChannels);
+					_priv_AudioResampler_offsetData(src, n);
+					offset += n;
+				}
+			}
+			m_countInput += input.count;
+		}
+
+		sl_size nTotal = 0;
+		if (output.format != AudioFormat::None && output.count) {
+			sl_uint32 nChannelsOut = AudioFormats::getChannelsCount(output.format);
+			float* planes[PRIV_AUDIO_RESAMPLER_MAX_CHANNELS];
+			float* base = (float*)(m_output.getData());
+			for (sl_uint32 i = 0; i < m_nChannels; i++) {
+				planes[i] = base + PRIV_AUDIO_RESAMPLER_CHUNK * i;
+			}
+			sl_bool flagMix = !(nChannelsOut == m_nChannels || (nChannelsOut <= 2 && m_nChannels <= 2));
+			float* planesMixed[2];
+			planesMixed[0] = base + PRIV_AUDIO_RESAMPLER_CHUNK * m_nChannels;
+			planesMixed[1] = planesMixed[0] + PRIV_AUDIO_RESAMPLER_CHUNK;
+			AudioData temp;
+			if (flagMix) {
+				temp.format = _priv_AudioResampler_getFloatFormat(nChannelsOut);
+				temp.data = planesMixed[0];
+				temp.data1 = planesMixed[1];
+			} else {
+				temp.format = _priv_AudioResampler_getFloatFormat(m_nChannels);
+				temp.data = planes[0];
+				temp.data1 = m_nChannels > 1 ? planes[1] : sl_null;
+			}
+			AudioData dst = output;
+			while (nTotal < output.count) {
+				sl_size n = output.count - nTotal;
+				if (n > PRIV_AUDIO_RESAMPLER_CHUNK) {
+					n = PRIV_AUDIO_RESAMPLER_CHUNK;
+				}
+				n = _resample(planes, n);
+				if (!n) {
+					break;
+				}
+				if (flagMix) {
+					AudioUtil::mixChannels(n, planes, m_nChannels, planesMixed, nChannelsOut);
+				}
+				temp.count = n;
+				dst.copySamplesFrom(temp, n);
+				_priv_AudioResampler_offsetData(dst, n);
+				nTotal += n;
+			}
+		}
+
+		_removeConsumedInput();
+		return nTotal;
+	}
+
+	sl_size AudioResampler::process(const float* const* input, sl_size countInput, float* const* output, sl_size countOutput)
+	{
+		if (countInput) {
+			if (!_appendInput(countInput)) {
+				return 0;
+			}
+			float* base = (float*)(m_input.getData());
+			for (sl_uint32 i = 0; i < m_nChannels; i++) {
+				Base::copyMemory(base + m_capacityInput * i + m_countInput, input[i], sizeof(float) * countInput);
+			}
+			m_countInput += countInput;
+		}
+		sl_size n = _resample(output, countOutput);
+		_removeConsumedInput();
+		return n;
+	}
+
+	void AudioResampler::reset()
+	{
+		m_phase = 0;
+		m_posInput = 0;
+		m_countInput = 0;
+		// the first output is aligned to the first input sample
+		sl_size nPadding = m_countTaps / 2 - 1;
+		if (_appendInput(nPadding)) {
+			float* base = (float*)(m_input.getData());
+			for (sl_uint32 i = 0; i < m_nChannels; i++) {
+				Base::zeroMemory(base + m_capacityInput * i, sizeof(float) * nPadding);
+			}
+			m_countInput = nPadding;
+		}
+	}
+
+	sl_bool AudioResampler::_appendInput(sl_size count)
+	{
+		sl_size n = m_countInput + count;
+		if (n <= m_capacityInput) {
+			return sl_true;
+		}
+		sl_size capacity = m_capacityInput * 2;
+		if (capacity < n) {
+			capacity = n;
+		}
+		if (capacity < 4096) {
+			capacity = 4096;
+		}
+		Memory mem = Memory::create(sizeof(float) * capacity * m_nChannels);
+		if (mem.isNull()) {
+			return sl_false;
+		}
+		if (m_countInput) {
+			float* src = (float*)(m_input.getData());
+			float* dst = (float*)(mem.getData());
+			for (sl_uint32 i = 0; i < m_nChannels; i++) {
+				Base::copyMemory(dst + capacity * i, src + m_capacityInput * i, sizeof(float) * m_countInput);
+			}
+		}
+		m_input = mem;
+		m_capacityInput = capacity;
+		return sl_true;
+	}
+
+	sl_size AudioResampler::_resample(float* const* output, sl_size count)
+	{
+		const float* filters = (const float*)((((sl_size)(m_filters.getData())) + 15) & ~((sl_size)15));
+		const float* base = (const float*)(m_input.getData());
+		sl_uint32 nTaps = m_countTaps;
+		sl_uint32 nPhases = m_countPhases;
+		sl_uint32 nFilters = m_countFilters;
+		sl_uint32 step = m_step;
+		sl_uint32 phase = m_phase;
+		sl_size pos = m_posInput;
+		sl_size end = m_countInput;
+		sl_size capacity = m_capacityInput;
+		sl_uint32 nChannels = m_nChannels;
+		sl_size k = 0;
+		if (nFilters == nPhases) {
+			for (; k < count && pos + nTaps <= end; k++) {
+				const float* h = filters + (sl_size)phase * nTaps;
+				for (sl_uint32 i = 0; i < nChannels; i++) {
+					output[i][k] = _priv_AudioResampler_dot(base + capacity * i + pos, h, nTaps);
+				}
+				phase += step;
+				pos += phase / nPhases;
+				phase %= nPhases;
+			}
+		} else {
+			for (; k < count && pos + nTaps <= end; k++) {
+				sl_uint64 t = (sl_uint64)phase * nFilters;
+				sl_uint32 index = (sl_uint32)(t / nPhases);
+				float a = (float)(t % nPhases) / (float)nPhases;
+				const float* h0 = filters + (sl_size)index * nTaps;
+				const float* h1 = h0 + nTaps;
+				for (sl_uint32 i = 0; i < nChannels; i++) {
+					const float* x = base + capacity * i + pos;
+					float v0 = _priv_AudioResampler_dot(x, h0, nTaps);
+					float v1 = _priv_AudioResampler_dot(x, h1, nTaps);
+					output[i][k] = v0 + (v1 - v0) * a;
+				}
+				phase += step;
+				pos += phase / nPhases;
+				phase %= nPhases;
+			}
+		}
+		m_phase = phase;
+		m_posInput = pos;
+		return k;
+	}
+
+	void AudioResampler::_removeConsumedInput()
+	{
+		sl_size pos = m_posInput;
+		if (!pos) {
+			return;
+		}
+		if (pos > m_countInput) {
+			// skipped the samples not received yet
+			pos = m_countInput;
+		}
+		sl_size n = m_countInput - pos;
+		if (n) {
+			float* base = (float*)(m_input.getData());
+			for (sl_uint32 i = 0; i < m_nChannels; i++) {
+				Base::moveMemory(base + m_capacityInput * i, base + m_capacityInput * i + pos, sizeof(float) * n);
+			}
+		}
+		m_countInput = n;
+		m_posInput -= pos;
+	}
+
+}
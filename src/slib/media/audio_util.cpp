@@ -10,6 +10,13 @@
 
 #include "slib/media/audio_util.h"
 
+#if defined(SLIB_ARCH_IS_X64)
+#	define PRIV_AUDIO_SUPPORT_SSE2
+#	include <emmintrin.h>
+#endif
+
+#define PRIV_AUDIO_MIX_SQRT_HALF 0.70710678f
+
 #define AUDIO_UTIL_DEF_CONVERT_SAMPLES(TYPE_IN, TYPE_OUT) \
 	void AudioUtil::convertSamples(sl_size count, const TYPE_IN* in, TYPE_OUT* out) \
 	{ \
@@ -37,7 +44,6 @@ namespace slib
 	AUDIO_UTIL_DEF_CONVERT_SAMPLES(sl_int16, sl_uint8)
 	AUDIO_UTIL_DEF_CONVERT_SAMPLES(sl_int16, sl_int16)
 	AUDIO_UTIL_DEF_CONVERT_SAMPLES(sl_int16, sl_uint16)
-	AUDIO_UTIL_DEF_CONVERT_SAMPLES(sl_int16, float)
 
 	AUDIO_UTIL_DEF_CONVERT_SAMPLES(sl_uint16, sl_int8)
 	AUDIO_UTIL_DEF_CONVERT_SAMPLES(sl_uint16, sl_uint8)
@@ -47,8 +53,217 @@ namespace slib
 
 	AUDIO_UTIL_DEF_CONVERT_SAMPLES(float, sl_int8)
 	AUDIO_UTIL_DEF_CONVERT_SAMPLES(float, sl_uint8)
-	AUDIO_UTIL_DEF_CONVERT_SAMPLES(float, sl_int16)
 	AUDIO_UTIL_DEF_CONVERT_SAMPLES(float, sl_uint16)
 	AUDIO_UTIL_DEF_CONVERT_SAMPLES(float, float)
 
+	void AudioUtil::convertSamples(sl_size count, const sl_int16* in, float* out)
+	{
+		sl_size i = 0;
+#if defined(PRIV_AUDIO_SUPPORT_SSE2)
+		__m128 scale = _mm_set1_ps(1.0f / 32768.0f);
+		for (; i + 8 <= count; i += 8) {
+			__m128i s = _mm_loadu_si128((__m128i*)(in + i));
+			__m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(s, s), 16);
+			__m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(s, s), 16);
+			_mm_storeu_ps(out + i, _mm_mul_ps(_mm_cvtepi32_ps(lo), scale));
+			_mm_storeu_ps(out + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), scale));
+		}
+#endif
+		for (; i < count; i++) {
+			convertSample(in[i], out[i]);
+		}
+	}
+
+	void AudioUtil::convertSamples(sl_size count, const float* in, sl_int16* out)
+	{
+		sl_size i = 0;
+#if defined(PRIV_AUDIO_SUPPORT_SSE2)
+		// truncation and saturation are same as `convertSample()`
+		__m128 scale = _mm_set1_ps(32768.0f);
+		for (; i + 8 <= count; i += 8) {
+			__m128i lo = _mm_cvttps_epi32(_mm_mul_ps(_mm_loadu_ps(in + i), scale));
+			__m128i hi = _mm_cvttps_epi32(_mm_mul_ps(_mm_loadu_ps(in + i + 4), scale));
+			_mm_storeu_si128((__m128i*)(out + i), _mm_packs_epi32(lo, hi));
+		}
+#endif
+		for (; i < count; i++) {
+			convertSample(in[i], out[i]);
+		}
+	}
+
+
+	enum class _priv_AudioChannel
+	{
+		L, R, C, LFE, BC, BL, BR, SL, SR
+	};
+
+	static const _priv_AudioChannel _priv_AudioChannel_layouts[8][8] = {
+		{ _priv_AudioChannel::C },
+		{ _priv_AudioChannel::L, _priv_AudioChannel::R },
+		{ _priv_AudioChannel::L, _priv_AudioChannel::R, _priv_AudioChannel::C },
+		{ _priv_AudioChannel::L, _priv_AudioChannel::R, _priv_AudioChannel::SL, _priv_AudioChannel::SR },
+		{ _priv_AudioChannel::L, _priv_AudioChannel::R, _priv_AudioChannel::C, _priv_AudioChannel::SL, _priv_AudioChannel::SR },
+		{ _priv_AudioChannel::L, _priv_AudioChannel::R, _priv_AudioChannel::C, _priv_AudioChannel::LFE, _priv_AudioChannel::SL, _priv_AudioChannel::SR },
+		{ _priv_AudioChannel::L, _priv_AudioChannel::R, _priv_AudioChannel::C, _priv_AudioChannel::LFE, _priv_AudioChannel::BC, _priv_AudioChannel::SL, _priv_AudioChannel::SR },
+		{ _priv_AudioChannel::L, _priv_AudioChannel::R, _priv_AudioChannel::C, _priv_AudioChannel::LFE, _priv_AudioChannel::BL, _priv_AudioChannel::BR, _priv_AudioChannel::SL, _priv_AudioChannel::SR }
+	};
+
+	class _priv_AudioMixMatrix
+	{
+	public:
+		const _priv_AudioChannel* layout;
+		sl_uint32 nChannels;
+		float* column;
+		sl_uint32 stride;
+		sl_bool flagMonoInput;
+
+	public:
+		sl_bool contains(_priv_AudioChannel channel)
+		{
+			for (sl_uint32 i = 0; i < nChannels; i++) {
+				if (layout[i] == channel) {
+					return sl_true;
+				}
+			}
+			return sl_false;
+		}
+
+		// the missing channel is folded into the nearest channels of the output layout
+		void spread(_priv_AudioChannel channel, float weight)
+		{
+			for (sl_uint32 i = 0; i < nChannels; i++) {
+				if (layout[i] == channel) {
+					column[i * stride] += weight;
+					return;
+				}
+			}
+			switch (channel) {
+				case _priv_AudioChannel::C:
+					if (flagMonoInput) {
+						spread(_priv_AudioChannel::L, weight);
+						spread(_priv_AudioChannel::R, weight);
+					} else {
+						spread(_priv_AudioChannel::L, weight * PRIV_AUDIO_MIX_SQRT_HALF);
+						spread(_priv_AudioChannel::R, weight * PRIV_AUDIO_MIX_SQRT_HALF);
+					}
+					break;
+				case _priv_AudioChannel::L:
+				case _priv_AudioChannel::R:
+					spread(_priv_AudioChannel::C, weight);
+					break;
+				case _priv_AudioChannel::LFE:
+					break;
+				case _priv_AudioChannel::BC:
+					if (contains(_priv_AudioChannel::BL) && contains(_priv_AudioChannel::BR)) {
+						spread(_priv_AudioChannel::BL, weight * PRIV_AUDIO_MIX_SQRT_HALF);
+						spread(_priv_AudioChannel::BR, weight * PRIV_AUDIO_MIX_SQRT_HALF);
+					} else if (contains(_priv_AudioChannel::SL) && contains(_priv_AudioChannel::SR)) {
+						spread(_priv_AudioChannel::SL, weight * PRIV_AUDIO_MIX_SQRT_HALF);
+						spread(_priv_AudioChannel::SR, weight * PRIV_AUDIO_MIX_SQRT_HALF);
+					} else {
+						spread(_priv_AudioChannel::L, weight * PRIV_AUDIO_MIX_SQRT_HALF);
+						spread(_priv_AudioChannel::R, weight * PRIV_AUDIO_MIX_SQRT_HALF);
+					}
+					break;
+				case _priv_AudioChannel::BL:
+				case _priv_AudioChannel::SL:
+					{
+						_priv_AudioChannel other = channel == _priv_AudioChannel::BL ? _priv_AudioChannel::SL : _priv_AudioChannel::BL;
+						if (contains(other)) {
+							spread(other, weight);
+						} else {
+							spread(_priv_AudioChannel::L, weight * PRIV_AUDIO_MIX_SQRT_HALF);
+						}
+					}
+					break;
+				case _priv_AudioChannel::BR:
+				case _priv_AudioChannel::SR:
+					{
+						_priv_AudioChannel other = channel == _priv_AudioChannel::BR ? _priv_AudioChannel::SR : _priv_AudioChannel::BR;
+						if (contains(other)) {
+							spread(other, weight);
+						} else {
+							spread(_priv_AudioChannel::R, weight * PRIV_AUDIO_MIX_SQRT_HALF);
+						}
+					}
+					break;
+			}
+		}
+
+	};
+
+	sl_bool AudioUtil::getMixMatrix(sl_uint32 nChannelsIn, sl_uint32 nChannelsOut, float* matrix)
+	{
+		if (nChannelsIn < 1 || nChannelsIn > 8 || nChannelsOut < 1 || nChannelsOut > 8) {
+			return sl_false;
+		}
+		sl_uint32 nTotal = nChannelsIn * nChannelsOut;
+		sl_uint32 i, k;
+		for (i = 0; i < nTotal; i++) {
+			matrix[i] = 0;
+		}
+		_priv_AudioMixMatrix mix;
+		mix.layout = _priv_AudioChannel_layouts[nChannelsOut - 1];
+		mix.nChannels = nChannelsOut;
+		mix.stride = nChannelsIn;
+		mix.flagMonoInput = nChannelsIn == 1;
+		const _priv_AudioChannel* layoutIn = _priv_AudioChannel_layouts[nChannelsIn - 1];
+		for (k = 0; k < nChannelsIn; k++) {
+			mix.column = matrix + k;
+			mix.spread(layoutIn[k], 1.0f);
+		}
+		// keeps the output in range
+		for (i = 0; i < nChannelsOut; i++) {
+			float* row = matrix + i * nChannelsIn;
+			float sum = 0;
+			for (k = 0; k < nChannelsIn; k++) {
+				sum += row[k];
+			}
+			if (sum > 1.0f) {
+				for (k = 0; k < nChannelsIn; k++) {
+					row[k] /= sum;
+				}
+			}
+		}
+		return sl_true;
+	}
+
+	void AudioUtil::mixChannels(sl_size count, const float* const* input, sl_uint32 nChannelsIn, float* const* output, sl_uint32 nChannelsOut, const float* matrix)
+	{
+		for (sl_uint32 iOut = 0; iOut < nChannelsOut; iOut++) {
+			float* out = output[iOut];
+			const float* row = matrix + iOut * nChannelsIn;
+			sl_size i = 0;
+#if defined(PRIV_AUDIO_SUPPORT_SSE2)
+			for (; i + 4 <= count; i += 4) {
+				__m128 sum = _mm_setzero_ps();
+				for (sl_uint32 k = 0; k < nChannelsIn; k++) {
+					if (row[k] != 0) {
+						sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(input[k] + i), _mm_set1_ps(row[k])));
+					}
+				}
+				_mm_storeu_ps(out + i, sum);
+			}
+#endif
+			for (; i < count; i++) {
+				float sum = 0;
+				for (sl_uint32 k = 0; k < nChannelsIn; k++) {
+					sum += input[k][i] * row[k];
+				}
+				out[i] = sum;
+			}
+		}
+	}
+
+	sl_bool AudioUtil::mixChannels(sl_size count, const float* const* input, sl_uint32 nChannelsIn, float* const* output, sl_uint32 nChannelsOut)
+	{
+		float matrix[64];
+		if (getMixMatrix(nChannelsIn, nChannelsOut, matrix)) {
+			mixChannels(count, input, nChannelsIn, output, nChannelsOut, matrix);
+			return sl_true;
+		}
+		return sl_false;
+	}
+
+
 }
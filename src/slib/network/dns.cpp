@@ -14,6 +14,8 @@
 #include "slib/core/scoped.h"
 #include "slib/core/mio.h"
 #include "slib/core/log.h"
+#include "slib/core/system.h"
+#include "slib/core/math.h"
 
 #define PRIV_MAX_NAME SLIB_NETWORK_DNS_NAME_MAX_LENGTH
 
@@ -268,6 +270,14 @@ namespace slib
 		sl_char8* bufIn = name.getData();
 		sl_uint32 lenIn = (sl_uint32)(name.getLength());
 		sl_uint8* bufOut = (sl_uint8*)_buf;
+		if (!lenIn) {
+			// root
+			if (offset + 1 > size) {
+				return 0;
+			}
+			bufOut[offset] = 0;
+			return offset + 1;
+		}
 		if (lenIn + 2 + offset > size) {
 			return 0;
 		}
@@ -507,6 +517,50 @@ namespace slib
 		return _buildName(dname, buf, offset, size);
 	}
 
+	sl_bool DnsResponseRecord::parseData_SOA(DnsSOA& soa) const
+	{
+		if (getType() == DnsRecordType::SOA) {
+			if (_message) {
+				sl_uint32 end = _dataOffset + _dataLength;
+				sl_uint32 pos = _parseName(soa.primaryServer, _message, _dataOffset, _messageLength);
+				if (pos == 0 || pos > end) {
+					return sl_false;
+				}
+				pos = _parseName(soa.mailbox, _message, pos, _messageLength);
+				if (pos == 0 || pos + 20 > end) {
+					return sl_false;
+				}
+				soa.serial = MIO::readUint32BE(_message + pos);
+				soa.refresh = MIO::readUint32BE(_message + pos + 4);
+				soa.retry = MIO::readUint32BE(_message + pos + 8);
+				soa.expire = MIO::readUint32BE(_message + pos + 12);
+				soa.minimum = MIO::readUint32BE(_message + pos + 16);
+				return sl_true;
+			}
+		}
+		return sl_false;
+	}
+
+	sl_uint32 DnsResponseRecord::buildRecord_SOA(void* buf, sl_uint32 offset, sl_uint32 size, const DnsSOA& soa)
+	{
+		setType(DnsRecordType::SOA);
+		sl_uint8 data[PRIV_MAX_NAME * 2 + 24];
+		sl_uint32 pos = _buildName(soa.primaryServer, data, 0, sizeof(data));
+		if (pos == 0) {
+			return 0;
+		}
+		pos = _buildName(soa.mailbox, data, pos, sizeof(data));
+		if (pos == 0 || pos + 20 > sizeof(data)) {
+			return 0;
+		}
+		MIO::writeUint32BE(data + pos, soa.serial);
+		MIO::writeUint32BE(data + pos + 4, soa.refresh);
+		MIO::writeUint32BE(data + pos + 8, soa.retry);
+		MIO::writeUint32BE(data + pos + 12, soa.expire);
+		MIO::writeUint32BE(data + pos + 16, soa.minimum);
+		return buildRecord(buf, offset, size, data, (sl_uint16)(pos + 20));
+	}
+
 	String DnsResponseRecord::toString() const
 	{
 		String ret = getName() + " ";
@@ -535,6 +589,10 @@ namespace slib
 	{
 		id = 0;
 		flagQuestion = sl_false;
+		responseCode = DnsResponseCode::NoError;
+		authority.flagSOA = sl_false;
+		authority.TTL = 0;
+		negativeTTL = 0;
 	}
 
 	DnsPacket::~DnsPacket()
@@ -556,6 +614,7 @@ namespace slib
 				flagQuestion = sl_false;
 			}
 			id = header->getId();
+			responseCode = header->getResponseCode();
 			
 			sl_uint32 i, n;
 			sl_uint32 offset = sizeof(DnsHeader);
@@ -586,6 +645,7 @@ namespace slib
 				if (type == DnsRecordType::A) {
 					DnsPacket::Address item;
 					item.name = record.getName();
+					item.TTL = record.getTTL();
 					IPv4Address addr = record.parseData_A();
 					if (addr.isNotZero()) {
 						item.address = addr;
@@ -594,6 +654,7 @@ namespace slib
 				} else if (type == DnsRecordType::AAAA) {
 					DnsPacket::Address item;
 					item.name = record.getName();
+					item.TTL = record.getTTL();
 					IPv6Address addr = record.parseData_AAAA();
 					if (addr.isNotZero()) {
 						item.address = addr;
@@ -603,6 +664,7 @@ namespace slib
 					DnsPacket::Alias item;
 					item.name = record.getName();
 					item.alias = record.parseData_CNAME();
+					item.TTL = record.getTTL();
 					if (item.alias.isNotEmpty()) {
 						aliases.add(item);
 					}
@@ -620,6 +682,17 @@ namespace slib
 					if (item.pointer.isNotEmpty()) {
 						pointers.add(item);
 					}
+				} else if (type == DnsRecordType::SOA) {
+					if (!(authority.flagSOA)) {
+						DnsSOA soa;
+						if (record.parseData_SOA(soa)) {
+							authority.flagSOA = sl_true;
+							authority.name = record.getName();
+							authority.soa = soa;
+							authority.TTL = record.getTTL();
+							negativeTTL = Math::min(soa.minimum, authority.TTL);
+						}
+					}
 				}
 			}
 			
@@ -650,7 +723,7 @@ namespace slib
 		return sl_null;
 	}
 
-	Memory DnsPacket::buildHostAddressAnswerPacket(sl_uint16 id, const String& hostName, const IPv4Address& hostAddress)
+	Memory DnsPacket::buildHostAddressAnswerPacket(sl_uint16 id, const String& hostName, const IPv4Address& hostAddress, sl_uint32 TTL)
 	{
 		char buf[4096];
 		Base::zeroMemory(buf, sizeof(buf));
@@ -676,6 +749,7 @@ namespace slib
 			if (offset > 0) {
 				DnsResponseRecord recordResponse;
 				recordResponse.setName(hostName);
+				recordResponse.setTTL(TTL);
 				offset = recordResponse.buildRecord_A(buf, offset, 1024, hostAddress);
 				if (offset > 0) {
 					return Memory::create(buf, offset);
@@ -683,32 +757,54 @@ namespace slib
 			}
 			
 		} else {
-			
-			DnsHeader* header = (DnsHeader*)(buf);
-			header->setId(id);
-			header->setQuestion(sl_false); // Response
-			header->setRD(sl_false);
-			header->setOpcode(DnsOpcode::Query);
-			header->setResponseCode(DnsResponseCode::NameError);
-			header->setQuestionsCount(1);
-			header->setAnswersCount(0);
-			header->setAuthoritiesCount(0);
-			header->setAdditionalsCount(0);
-			
-			sl_uint32 offset = sizeof(DnsHeader);
-			DnsQuestionRecord recordQuestion;
-			recordQuestion.setName(hostName);
-			recordQuestion.setType(DnsRecordType::A);
-			offset = recordQuestion.buildRecord(buf, offset, 1024);
-			if (offset == 0) {
-				return Memory::create(buf, offset);
-			}
+			DnsPacket::Authority authority;
+			authority.flagSOA = sl_false;
+			return buildNegativeAnswerPacket(id, hostName, DnsResponseCode::NameError, authority);
 		}
 		
 		return sl_null;
 		
 	}
 
+	Memory DnsPacket::buildNegativeAnswerPacket(sl_uint16 id, const String& hostName, DnsResponseCode responseCode, const Authority& authority)
+	{
+		char buf[4096];
+		Base::zeroMemory(buf, sizeof(DnsHeader));
+		
+		DnsHeader* header = (DnsHeader*)(buf);
+		header->setId(id);
+		header->setQuestion(sl_false); // Response
+		header->setRD(sl_false);
+		header->setOpcode(DnsOpcode::Query);
+		header->setResponseCode(responseCode);
+		header->setQuestionsCount(1);
+		header->setAnswersCount(0);
+		header->setAuthoritiesCount(0);
+		header->setAdditionalsCount(0);
+		
+		sl_uint32 offset = sizeof(DnsHeader);
+		DnsQuestionRecord recordQuestion;
+		recordQuestion.setName(hostName);
+		recordQuestion.setType(DnsRecordType::A);
+		offset = recordQuestion.buildRecord(buf, offset, 1024);
+		if (offset > 0) {
+			if (authority.flagSOA) {
+				DnsResponseRecord recordAuthority;
+				recordAuthority.setName(authority.name);
+				recordAuthority.setTTL(authority.TTL);
+				sl_uint32 offsetAuthority = recordAuthority.buildRecord_SOA(buf, offset, sizeof(buf), authority.soa);
+				// the answer is still valid without SOA record
+				if (offsetAuthority > 0) {
+					header->setAuthoritiesCount(1);
+					offset = offsetAuthority;
+				}
+			}
+			return Memory::create(buf, offset);
+		}
+		
+		return sl_null;
+	}
+
 /*************************************************************
 				DnsClient
 *************************************************************/
@@ -824,6 +920,16 @@ namespace slib
 		flagEncryptDefaultForward = sl_false;
 
 		flagAutoStart = sl_true;
+
+		ioLoopsCount = 1;
+
+		cacheCapacity = 10000;
+		cacheMinimumTTL = 0;
+		cacheMaximumTTL = 86400;
+		cacheNegativeTTL = 60;
+		prefetchPercent = 10;
+
+		forwardTimeout = 5000;
 	}
 
 	DnsServerParam::~DnsServerParam()
@@ -841,76 +947,474 @@ namespace slib
 		IPv4Address defaultForwardAddressIp = IPv4Address(8, 8, 4, 4);
 		defaultForwardAddressIp.parse(conf.getItem("forward_dns").getString());
 		defaultForwardAddress = SocketAddress(defaultForwardAddressIp, SLIB_NETWORK_DNS_PORT);
+
+		ioLoopsCount = conf.getItem("io_loops").getUint32(1);
+
+		cacheCapacity = conf.getItem("cache_capacity").getUint32(10000);
+		cacheMinimumTTL = conf.getItem("cache_min_ttl").getUint32(0);
+		cacheMaximumTTL = conf.getItem("cache_max_ttl").getUint32(86400);
+		cacheNegativeTTL = conf.getItem("cache_negative_ttl").getUint32(60);
+		prefetchPercent = conf.getItem("prefetch_percent").getUint32(10);
 	}
 
 
-	SLIB_DEFINE_OBJECT(DnsServer, Object)
+#define TAG_SERVER "DnsServer"
 
-	DnsServer::DnsServer()
+#define PRIV_DNS_SERVER_CACHE_SHARDS 16
+// the tick counts are compared by the signed difference, so TTL should be less than 2^31 milliseconds
+#define PRIV_DNS_SERVER_CACHE_MAX_TTL 604800
+// at most the half of the 16-bit ids are used by a forwarding socket, so the random id is found by a few probes
+#define PRIV_DNS_SERVER_FORWARDER_MAX_PENDING 0x8000
+#define PRIV_DNS_SERVER_FORWARD_SWEEP_INTERVAL 1000
+
+	class _priv_DnsServer_CacheEntry
 	{
-		m_flagInit = sl_false;
-		m_flagRunning = sl_false;
+	public:
+		IPv4Address address; // zero for the negative answer
+		DnsResponseCode responseCode; // NoError (NODATA) or NameError (NXDOMAIN) for the negative answer
+		DnsPacket::Authority authority;
+		sl_uint32 timeExpire;
+		sl_uint32 timePrefetch;
+		sl_bool flagPrefetching;
+	};
 
-		m_lastForwardId = 0;
+	class _priv_DnsServer_Cache : public Referable
+	{
+	public:
+		typedef CHashMap<String, _priv_DnsServer_CacheEntry> Shard;
 
-		m_flagEncryptDefaultForward = sl_false;
-		m_flagProxy = sl_false;
-	}
+		sl_size capacityShard;
+		Shard shards[PRIV_DNS_SERVER_CACHE_SHARDS];
 
-	DnsServer::~DnsServer()
+	public:
+		_priv_DnsServer_Cache(sl_size capacity)
+		{
+			capacityShard = capacity / PRIV_DNS_SERVER_CACHE_SHARDS + 1;
+		}
+
+	public:
+		Shard& getShard(const String& key)
+		{
+			// high bits of the multiplicative hash, not to correlate with the buckets of the shard
+			sl_uint32 h = (sl_uint32)(key.getHashCode()) * 0x9E3779B1;
+			return shards[h >> 28];
+		}
+
+		// `flagPrefetch` is set to the first lookup in the prefetch period of the entry
+		sl_bool get(const String& key, sl_uint32 now, _priv_DnsServer_CacheEntry& entryOut, sl_uint32& TTL, sl_bool& flagPrefetch)
+		{
+			Shard& shard = getShard(key);
+			ObjectLocker lock(&shard);
+			Shard::NODE* node = shard.find_NoLock(key);
+			if (!node) {
+				return sl_false;
+			}
+			_priv_DnsServer_CacheEntry& entry = node->value;
+			sl_int32 remain = (sl_int32)(entry.timeExpire - now);
+			if (remain <= 0) {
+				shard.removeAt(node);
+				return sl_false;
+			}
+			entryOut = entry;
+			TTL = ((sl_uint32)remain + 999) / 1000;
+			if (!(entry.flagPrefetching) && (sl_int32)(now - entry.timePrefetch) >= 0) {
+				entry.flagPrefetching = sl_true;
+				flagPrefetch = sl_true;
+			} else {
+				flagPrefetch = sl_false;
+			}
+			return sl_true;
+		}
+
+		void put(const String& key, const IPv4Address& address, DnsResponseCode responseCode, const DnsPacket::Authority& authority, sl_uint32 TTL, sl_uint32 prefetchPercent, sl_uint32 now)
+		{
+			_priv_DnsServer_CacheEntry entry;
+			entry.address = address;
+			entry.responseCode = responseCode;
+			entry.authority = authority;
+			sl_uint32 duration = TTL * 1000;
+			entry.timeExpire = now + duration;
+			if (prefetchPercent && address.isNotZero()) {
+				entry.timePrefetch = entry.timeExpire - (sl_uint32)((sl_uint64)duration * prefetchPercent / 100);
+				entry.flagPrefetching = sl_false;
+			} else {
+				entry.timePrefetch = entry.timeExpire;
+				entry.flagPrefetching = sl_true;
+			}
+			Shard& shard = getShard(key);
+			ObjectLocker lock(&shard);
+			if (shard.getCount() >= capacityShard) {
+				if (!(shard.find_NoLock(key))) {
+					evict(shard, now);
+				}
+			}
+			shard.put_NoLock(key, entry);
+		}
+
+		// removes the expired entries, and the entries expiring sooner than the average when still full
+		void evict(Shard& shard, sl_uint32 now)
+		{
+			sl_uint64 sumRemain = 0;
+			sl_size n = 0;
+			Shard::NODE* node = shard.getFirstNode();
+			while (node) {
+				Shard::NODE* next = node->getNext();
+				sl_int32 remain = (sl_int32)(node->value.timeExpire - now);
+				if (remain <= 0) {
+					shard.removeAt(node);
+				} else {
+					sumRemain += remain;
+					n++;
+				}
+				node = next;
+			}
+			if (n < capacityShard) {
+				return;
+			}
+			sl_int32 average = (sl_int32)(sumRemain / n);
+			node = shard.getFirstNode();
+			while (node) {
+				Shard::NODE* next = node->getNext();
+				if ((sl_int32)(node->value.timeExpire - now) <= average) {
+					shard.removeAt(node);
+				}
+				node = next;
+			}
+		}
+
+	};
+
+	class _priv_DnsServer_Forwarder : public Referable
 	{
-		release();
-	}
+	public:
+		Ref<AsyncUdpSocket> socket;
+		sl_bool flagEncrypted;
+		sl_uint32 countPending;
+	};
 
-#define TAG_SERVER "DnsServer"
+	class _priv_DnsServer_ForwardElement
+	{
+	public:
+		SocketAddress clientAddress; // none for the prefetch and the background forward
+		sl_uint16 requestedId;
+		String requestedHostName;
+		sl_bool flagEncrypted;
+		SocketAddress forwardAddress;
+		sl_uint32 timeForward;
+	};
 
-	Ref<DnsServer> DnsServer::create(const DnsServerParam& param)
+	class _priv_DnsServer_Worker : public Referable
 	{
-		Ref<DnsServer> ret = new DnsServer;
-		
-		if (ret.isNotNull()) {
+	public:
+		Ref<AsyncIoLoop> ioLoop;
+		Ref<AsyncUdpSocket> udpDns;
+		Ref<AsyncUdpSocket> udpEncrypt;
+
+		// the forwarding sockets (ephemeral ports), so the answers return to this worker
+		List< Ref<_priv_DnsServer_Forwarder> > forwarders;
+		// key: (index of the forwarder << 16) | id. accessed only in the thread of `ioLoop`
+		CHashMap<sl_uint32, _priv_DnsServer_ForwardElement> mapForward;
+		sl_uint32 timeLastSweep;
+		sl_uint32 seedId;
+
+	public:
+		_priv_DnsServer_Worker()
+		{
+			timeLastSweep = System::getTickCount();
+			seedId = (Math::randomIntByTime() ^ (sl_uint32)((sl_size)this)) | 1;
+		}
+
+	public:
+		static Ref<_priv_DnsServer_Worker> create(DnsServer* server, const DnsServerParam& param, const Ref<AsyncIoLoop>& loop, sl_bool flagReusePort)
+		{
+			Ref<_priv_DnsServer_Worker> ret = new _priv_DnsServer_Worker;
+			if (ret.isNull()) {
+				return sl_null;
+			}
+			_priv_DnsServer_Worker* worker = ret.get();
+			WeakRef<DnsServer> weak = server;
 
 			AsyncUdpSocketParam up;
-			up.listener.setWeak(ret);
 			up.packetSize = 4096;
-			up.ioLoop = param.ioLoop;
+			up.ioLoop = loop;
 			up.flagAutoStart = sl_false;
-			
+			up.flagReusePort = flagReusePort;
+
 			up.bindAddress.port = param.portDns;
-			Ref<AsyncUdpSocket> socketDns = AsyncUdpSocket::create(up);
-			if (socketDns.isNull()) {
+			up.onReceiveFrom = [weak, worker](AsyncUdpSocket*, const SocketAddress& address, void* data, sl_uint32 size) {
+				Ref<DnsServer> server = weak.lock();
+				if (server.isNotNull()) {
+					server->_onReceiveQuestion(worker, sl_false, address, data, size);
+				}
+			};
+			ret->udpDns = AsyncUdpSocket::create(up);
+			if (ret->udpDns.isNull()) {
 				LogError(TAG_SERVER, "Failed to bind to port %d", param.portDns);
 				return sl_null;
 			}
-			
+
 			up.bindAddress.port = param.portEncryption;
-			Ref<AsyncUdpSocket> socketEncrypt = AsyncUdpSocket::create(up);
-			if (socketEncrypt.isNull()) {
+			up.onReceiveFrom = [weak, worker](AsyncUdpSocket*, const SocketAddress& address, void* data, sl_uint32 size) {
+				Ref<DnsServer> server = weak.lock();
+				if (server.isNotNull()) {
+					server->_onReceiveQuestion(worker, sl_true, address, data, size);
+				}
+			};
+			ret->udpEncrypt = AsyncUdpSocket::create(up);
+			if (ret->udpEncrypt.isNull()) {
 				LogError(TAG_SERVER, "Failed to bind to port %d", param.portEncryption);
+				ret->udpDns->close();
+				return sl_null;
+			}
+
+			ret->ioLoop = loop;
+			return ret;
+		}
+
+		void start()
+		{
+			udpDns->start();
+			udpEncrypt->start();
+		}
+
+		void close()
+		{
+			udpDns->close();
+			udpEncrypt->close();
+			ListLocker< Ref<_priv_DnsServer_Forwarder> > list(forwarders);
+			for (sl_size i = 0; i < list.count; i++) {
+				list[i]->socket->close();
+			}
+		}
+
+		Ref<_priv_DnsServer_Forwarder> getForwarder(DnsServer* server, sl_bool flagEncrypted, sl_uint32& outIndex)
+		{
+			{
+				ListElements< Ref<_priv_DnsServer_Forwarder> > list(forwarders);
+				for (sl_size i = 0; i < list.count; i++) {
+					_priv_DnsServer_Forwarder* forwarder = list[i].get();
+					if (forwarder->flagEncrypted == flagEncrypted && forwarder->countPending < PRIV_DNS_SERVER_FORWARDER_MAX_PENDING) {
+						outIndex = (sl_uint32)i;
+						return list[i];
+					}
+				}
+			}
+			sl_uint32 index = (sl_uint32)(forwarders.getCount());
+			if (index > 0xFFFF) {
+				return sl_null;
+			}
+			Ref<_priv_DnsServer_Forwarder> forwarder = new _priv_DnsServer_Forwarder;
+			if (forwarder.isNull()) {
+				return sl_null;
+			}
+			_priv_DnsServer_Worker* worker = this;
+			WeakRef<DnsServer> weak = server;
+			AsyncUdpSocketParam up;
+			up.packetSize = 4096;
+			up.ioLoop = ioLoop;
+			up.flagAutoStart = sl_true;
+			up.onReceiveFrom = [weak, worker, index](AsyncUdpSocket*, const SocketAddress& address, void* data, sl_uint32 size) {
+				Ref<DnsServer> server = weak.lock();
+				if (server.isNotNull()) {
+					server->_onReceiveAnswer(worker, index, address, data, size);
+				}
+			};
+			forwarder->socket = AsyncUdpSocket::create(up);
+			if (forwarder->socket.isNull()) {
+				return sl_null;
+			}
+			forwarder->flagEncrypted = flagEncrypted;
+			forwarder->countPending = 0;
+			if (!(forwarders.add(forwarder))) {
+				forwarder->socket->close();
+				return sl_null;
+			}
+			outIndex = index;
+			return forwarder;
+		}
+
+		sl_bool findForwarder(AsyncUdpSocket* socket, sl_uint32& outIndex)
+		{
+			ListLocker< Ref<_priv_DnsServer_Forwarder> > list(forwarders);
+			for (sl_size i = 0; i < list.count; i++) {
+				if (list[i]->socket == socket) {
+					outIndex = (sl_uint32)i;
+					return sl_true;
+				}
+			}
+			return sl_false;
+		}
+
+		Ref<_priv_DnsServer_Forwarder> addForward(DnsServer* server, sl_bool flagEncrypted, _priv_DnsServer_ForwardElement& fe, sl_uint32 timeout, sl_uint16& outId)
+		{
+			sl_uint32 now = System::getTickCount();
+			if (now - timeLastSweep >= PRIV_DNS_SERVER_FORWARD_SWEEP_INTERVAL) {
+				sweep(now, timeout);
+				timeLastSweep = now;
+			}
+			sl_uint32 index;
+			Ref<_priv_DnsServer_Forwarder> forwarder = getForwarder(server, flagEncrypted, index);
+			if (forwarder.isNull()) {
 				return sl_null;
 			}
+			// random ids against the spoofed answers
+			seedId ^= seedId << 13;
+			seedId ^= seedId >> 17;
+			seedId ^= seedId << 5;
+			sl_uint16 id = (sl_uint16)(seedId >> 8);
+			while (mapForward.find_NoLock((index << 16) | id)) {
+				id++;
+			}
+			fe.timeForward = now;
+			if (!(mapForward.put_NoLock((index << 16) | id, fe))) {
+				return sl_null;
+			}
+			forwarder->countPending++;
+			outId = id;
+			return forwarder;
+		}
 
-			if (socketDns.isNotNull() || socketEncrypt.isNotNull()) {
+		sl_bool takeForward(sl_uint32 index, sl_uint16 id, const SocketAddress& addressFrom, _priv_DnsServer_ForwardElement& fe)
+		{
+			CHashMap<sl_uint32, _priv_DnsServer_ForwardElement>::NODE* node = mapForward.find_NoLock((index << 16) | id);
+			if (!node) {
+				return sl_false;
+			}
+			if (node->value.forwardAddress != addressFrom) {
+				return sl_false;
+			}
+			fe = Move(node->value);
+			mapForward.removeAt(node);
+			Ref<_priv_DnsServer_Forwarder> forwarder = forwarders.getValueAt(index);
+			if (forwarder.isNotNull()) {
+				forwarder->countPending--;
+			}
+			return sl_true;
+		}
 
-				ret->m_udpDns = socketDns;
-				ret->m_udpEncrypt = socketEncrypt;
+		// discards the forwarded questions not answered in the timeout
+		void sweep(sl_uint32 now, sl_uint32 timeout)
+		{
+			ListElements< Ref<_priv_DnsServer_Forwarder> > list(forwarders);
+			CHashMap<sl_uint32, _priv_DnsServer_ForwardElement>::NODE* node = mapForward.getFirstNode();
+			while (node) {
+				CHashMap<sl_uint32, _priv_DnsServer_ForwardElement>::NODE* next = node->getNext();
+				if (now - node->value.timeForward >= timeout) {
+					sl_uint32 index = node->key >> 16;
+					if (index < list.count) {
+						list[index]->countPending--;
+					}
+					mapForward.removeAt(node);
+				}
+				node = next;
+			}
+		}
+
+	};
+
+	static String _priv_DnsServer_getCacheKey(const String& hostName, const SocketAddress& forwardAddress, const SocketAddress& defaultForwardAddress)
+	{
+		if (forwardAddress == defaultForwardAddress) {
+			return hostName.toLower();
+		}
+		return hostName.toLower() + "@" + forwardAddress.toString();
+	}
 
-				ret->m_encrypt.setKey_SHA256(param.encryptionKey);
 
-				ret->m_flagProxy = param.flagProxy;
+	SLIB_DEFINE_OBJECT(DnsServer, Object)
 
-				ret->m_defaultForwardAddress = param.defaultForwardAddress;
-				ret->m_flagEncryptDefaultForward = param.flagEncryptDefaultForward;
+	DnsServer::DnsServer()
+	{
+		m_flagInit = sl_false;
+		m_flagRunning = sl_false;
+
+		m_flagEncryptDefaultForward = sl_false;
+		m_flagProxy = sl_false;
+
+		m_cacheMinimumTTL = 0;
+		m_cacheMaximumTTL = 0;
+		m_cacheNegativeTTL = 0;
+		m_prefetchPercent = 0;
+		m_forwardTimeout = 0;
+	}
+
+	DnsServer::~DnsServer()
+	{
+		release();
+	}
 
-				ret->m_listener = param.listener;
+	Ref<DnsServer> DnsServer::create(const DnsServerParam& param)
+	{
+		Ref<DnsServer> ret = new DnsServer;
+		
+		if (ret.isNotNull()) {
 
-				ret->m_flagInit = sl_true;
-				if (param.flagAutoStart) {
-					ret->start();
+			sl_uint32 nWorkers = param.ioLoopsCount;
+			if (!nWorkers) {
+				nWorkers = System::getProcessorsCount();
+			}
+#if defined(SLIB_PLATFORM_IS_LINUX) && defined(SLIB_PLATFORM_IS_DESKTOP)
+			// kernel balances the incoming questions between the sockets sharing the port
+			if (nWorkers > 1) {
+				List< Ref<AsyncIoLoop> > loops;
+				for (sl_uint32 i = 0; i < nWorkers; i++) {
+					Ref<AsyncIoLoop> loop = AsyncIoLoop::create(sl_false);
+					if (loop.isNull()) {
+						break;
+					}
+					loops.add_NoLock(loop);
+					Ref<_priv_DnsServer_Worker> worker = _priv_DnsServer_Worker::create(ret.get(), param, loop, sl_true);
+					if (worker.isNull()) {
+						break;
+					}
+					ret->m_workers.add_NoLock(worker);
 				}
-				return ret;
+				if (ret->m_workers.getCount() == nWorkers) {
+					ret->m_ioLoops = loops;
+				} else {
+					ListElements< Ref<_priv_DnsServer_Worker> > workers(ret->m_workers);
+					for (sl_size i = 0; i < workers.count; i++) {
+						workers[i]->close();
+					}
+					ret->m_workers.setNull();
+					ListElements< Ref<AsyncIoLoop> > listLoops(loops);
+					for (sl_size i = 0; i < listLoops.count; i++) {
+						listLoops[i]->release();
+					}
+				}
+			}
+#endif
+			if (ret->m_workers.isEmpty()) {
+				Ref<_priv_DnsServer_Worker> worker = _priv_DnsServer_Worker::create(ret.get(), param, param.ioLoop, sl_false);
+				if (worker.isNull()) {
+					return sl_null;
+				}
+				ret->m_workers.add_NoLock(worker);
+			}
+
+			ret->m_encrypt.setKey_SHA256(param.encryptionKey);
+
+			ret->m_flagProxy = param.flagProxy;
+
+			ret->m_defaultForwardAddress = param.defaultForwardAddress;
+			ret->m_flagEncryptDefaultForward = param.flagEncryptDefaultForward;
 
+			if (param.cacheCapacity && !(param.flagProxy)) {
+				ret->m_cache = new _priv_DnsServer_Cache(param.cacheCapacity);
 			}
+			ret->m_cacheMaximumTTL = Math::min(param.cacheMaximumTTL, (sl_uint32)PRIV_DNS_SERVER_CACHE_MAX_TTL);
+			ret->m_cacheMinimumTTL = Math::min(param.cacheMinimumTTL, ret->m_cacheMaximumTTL);
+			ret->m_cacheNegativeTTL = Math::min(param.cacheNegativeTTL, ret->m_cacheMaximumTTL);
+			ret->m_prefetchPercent = Math::min(param.prefetchPercent, (sl_uint32)100);
+			ret->m_forwardTimeout = param.forwardTimeout;
+
+			ret->m_listener = param.listener;
+
+			ret->m_flagInit = sl_true;
+			if (param.flagAutoStart) {
+				ret->start();
+			}
+			return ret;
 			
 		}
 		return sl_null;
@@ -925,11 +1429,17 @@ namespace slib
 		m_flagInit = sl_false;
 
 		m_flagRunning = sl_false;
-		if (m_udpDns.isNotNull()) {
-			m_udpDns->close();
+		{
+			ListElements< Ref<_priv_DnsServer_Worker> > workers(m_workers);
+			for (sl_size i = 0; i < workers.count; i++) {
+				workers[i]->close();
+			}
 		}
-		if (m_udpEncrypt.isNotNull()) {
-			m_udpEncrypt->close();
+		{
+			ListElements< Ref<AsyncIoLoop> > loops(m_ioLoops);
+			for (sl_size i = 0; i < loops.count; i++) {
+				loops[i]->release();
+			}
 		}
 	}
 
@@ -942,11 +1452,17 @@ namespace slib
 		if (m_flagRunning) {
 			return;
 		}
-		if (m_udpDns.isNotNull()) {
-			m_udpDns->start();
+		{
+			ListElements< Ref<_priv_DnsServer_Worker> > workers(m_workers);
+			for (sl_size i = 0; i < workers.count; i++) {
+				workers[i]->start();
+			}
 		}
-		if (m_udpEncrypt.isNotNull()) {
-			m_udpEncrypt->start();
+		{
+			ListElements< Ref<AsyncIoLoop> > loops(m_ioLoops);
+			for (sl_size i = 0; i < loops.count; i++) {
+				loops[i]->start();
+			}
 		}
 		m_flagRunning = sl_true;
 	}
@@ -956,7 +1472,7 @@ namespace slib
 		return m_flagRunning;
 	}
 
-	void DnsServer::_processReceivedDnsQuestion(const SocketAddress& clientAddress, sl_uint16 id, const String& hostName, sl_bool flagEncryptedRequest)
+	void DnsServer::_processReceivedDnsQuestion(_priv_DnsServer_Worker* worker, const SocketAddress& clientAddress, sl_uint16 id, const String& hostName, sl_bool flagEncryptedRequest)
 	{
 		if (hostName.indexOf('.') < 0) {
 			return;
@@ -971,46 +1487,56 @@ namespace slib
 			return;
 		}
 		if (rp.forwardAddress.isInvalid()) {
-			_sendPacket(flagEncryptedRequest, clientAddress, _buildHostAddressAnswerPacket(id, hostName, rp.hostAddress, flagEncryptedRequest));
+			_sendPacket(worker, flagEncryptedRequest, clientAddress, _buildHostAddressAnswerPacket(id, hostName, rp.hostAddress, 0, flagEncryptedRequest));
 			return;
 		}
+		
+		_priv_DnsServer_CacheEntry cached;
+		sl_uint32 cachedTTL = 0;
+		sl_bool flagCached = sl_false;
+		sl_bool flagPrefetch = sl_false;
+		if (m_cache.isNotNull()) {
+			String key = _priv_DnsServer_getCacheKey(hostName, rp.forwardAddress, m_defaultForwardAddress);
+			flagCached = m_cache->get(key, System::getTickCount(), cached, cachedTTL, flagPrefetch);
+		}
+		
 		if (rp.hostAddress.isNotZero()) {
-			_sendPacket(flagEncryptedRequest, clientAddress, _buildHostAddressAnswerPacket(id, hostName, rp.hostAddress, flagEncryptedRequest));
+			_sendPacket(worker, flagEncryptedRequest, clientAddress, _buildHostAddressAnswerPacket(id, hostName, rp.hostAddress, 0, flagEncryptedRequest));
+			// forward in background to inform the listener (`cacheDnsHost`), unless the answer is cached
+			if (!flagCached || flagPrefetch) {
+				_forwardQuestion(worker, SocketAddress::none(), id, hostName, flagEncryptedRequest, rp.forwardAddress, rp.flagEncryptForward);
+			}
+			return;
 		}
 		
-		// forward DNS request
-		{
-			sl_uint16 idForward = m_lastForwardId++;
-			ForwardElement fe;
-			fe.requestedId = id;
-			fe.requestedHostName = hostName;
-			fe.flagEncrypted = flagEncryptedRequest;
-			if (rp.hostAddress.isNotZero()) {
-				fe.clientAddress.ip.setNone();
-				fe.clientAddress.port = 0;
+		if (flagCached) {
+			if (cached.address.isNotZero()) {
+				_sendPacket(worker, flagEncryptedRequest, clientAddress, _buildHostAddressAnswerPacket(id, hostName, cached.address, cachedTTL, flagEncryptedRequest));
 			} else {
-				fe.clientAddress = clientAddress;
+				cached.authority.TTL = cachedTTL;
+				_sendPacket(worker, flagEncryptedRequest, clientAddress, _buildNegativeAnswerPacket(id, hostName, cached.responseCode, cached.authority, flagEncryptedRequest));
+			}
+			if (flagPrefetch) {
+				_forwardQuestion(worker, SocketAddress::none(), id, hostName, flagEncryptedRequest, rp.forwardAddress, rp.flagEncryptForward);
 			}
-			m_mapForward.put(idForward, fe);
-			_sendPacket(rp.flagEncryptForward, rp.forwardAddress, _buildQuestionPacket(idForward, hostName, rp.flagEncryptForward));
+			return;
 		}
-
+		
+		_forwardQuestion(worker, clientAddress, id, hostName, flagEncryptedRequest, rp.forwardAddress, rp.flagEncryptForward);
 	}
 
-	void DnsServer::_processReceivedDnsAnswer(const DnsPacket& packet)
+	void DnsServer::_processReceivedDnsAnswer(_priv_DnsServer_Worker* worker, sl_uint32 indexForwarder, const SocketAddress& addressFrom, const DnsPacket& packet)
 	{
 
-		sl_uint16 idForward = packet.id;
-
-		ForwardElement fe;
-		if (m_mapForward.get(idForward, &fe)) {
-
-			m_mapForward.remove(idForward);
+		_priv_DnsServer_ForwardElement fe;
+		if (worker->takeForward(indexForwarder, packet.id, addressFrom, fe)) {
 
 			String reqNameLower = fe.requestedHostName.toLower();
 
 			IPv4Address resolvedAddress;
 			resolvedAddress.setZero();
+			// minimum TTL of the records in the answer
+			sl_uint32 resolvedTTL = PRIV_DNS_SERVER_CACHE_MAX_TTL;
 
 			CHashMap<String, IPv4Address> aliasAddresses4;
 			CHashMap<String, IPv6Address> aliasAddresses6;
@@ -1024,6 +1550,9 @@ namespace slib
 						if (address.address.isIPv4() && address.address.getIPv4().isHost()) {
 							_cacheDnsHost(address.name, address.address);
 							aliasAddresses4.put_NoLock(address.name.toLower(), address.address.getIPv4());
+							if (address.TTL < resolvedTTL) {
+								resolvedTTL = address.TTL;
+							}
 						} else if (address.address.isIPv6()) {
 							_cacheDnsHost(address.name, address.address);
 							aliasAddresses6.put_NoLock(address.name.toLower(), address.address.getIPv6());
@@ -1037,6 +1566,14 @@ namespace slib
 				}
 			}
 			// alias
+			{
+				ListElements<DnsPacket::Alias> aliases(packet.aliases);
+				for (sl_size i = 0; i < aliases.count; i++) {
+					if (aliases[i].TTL < resolvedTTL) {
+						resolvedTTL = aliases[i].TTL;
+					}
+				}
+			}
 			{
 				List<DnsPacket::Alias> aliasesProcess = packet.aliases.duplicate_NoLock();
 				sl_bool flagProcess = sl_true;
@@ -1074,22 +1611,61 @@ namespace slib
 					aliasesProcess = aliasesNoProcess;
 				}
 			}
-			if (fe.clientAddress.isValid()) {
-				_sendPacket(fe.flagEncrypted, fe.clientAddress, _buildHostAddressAnswerPacket(fe.requestedId, fe.requestedHostName, resolvedAddress, fe.flagEncrypted));
+			
+			// the failures of the server are neither cached nor answered, so that the client retries
+			sl_bool flagAnswer = resolvedAddress.isNotZero() || packet.responseCode == DnsResponseCode::NoError || packet.responseCode == DnsResponseCode::NameError;
+			sl_uint32 TTL;
+			if (resolvedAddress.isNotZero()) {
+				TTL = resolvedTTL;
+			} else {
+				TTL = m_cacheNegativeTTL;
+				if (packet.negativeTTL && packet.negativeTTL < TTL) {
+					TTL = packet.negativeTTL;
+				}
+			}
+			if (TTL > m_cacheMaximumTTL) {
+				TTL = m_cacheMaximumTTL;
+			}
+			if (TTL < m_cacheMinimumTTL) {
+				TTL = m_cacheMinimumTTL;
+			}
+			// NODATA (the host exists without A record) is answered with NoError, only NXDOMAIN with NameError
+			DnsResponseCode responseCode = resolvedAddress.isNotZero() ? DnsResponseCode::NoError : packet.responseCode;
+			DnsPacket::Authority authority;
+			authority.flagSOA = sl_false;
+			if (resolvedAddress.isZero()) {
+				authority = packet.authority;
+				authority.TTL = TTL;
+			}
+			if (flagAnswer && TTL && m_cache.isNotNull()) {
+				String key = _priv_DnsServer_getCacheKey(fe.requestedHostName, fe.forwardAddress, m_defaultForwardAddress);
+				m_cache->put(key, resolvedAddress, responseCode, authority, TTL, m_prefetchPercent, System::getTickCount());
+			}
+			if (flagAnswer && fe.clientAddress.isValid()) {
+				if (resolvedAddress.isNotZero()) {
+					_sendPacket(worker, fe.flagEncrypted, fe.clientAddress, _buildHostAddressAnswerPacket(fe.requestedId, fe.requestedHostName, resolvedAddress, TTL, fe.flagEncrypted));
+				} else {
+					_sendPacket(worker, fe.flagEncrypted, fe.clientAddress, _buildNegativeAnswerPacket(fe.requestedId, fe.requestedHostName, responseCode, authority, fe.flagEncrypted));
+				}
 			}
 		}
 	}
 
-	void DnsServer::_processReceivedProxyQuestion(const SocketAddress& clientAddress, void* data, sl_uint32 size, sl_bool flagEncryptedRequest)
+	void DnsServer::_processReceivedProxyQuestion(_priv_DnsServer_Worker* worker, const SocketAddress& clientAddress, void* data, sl_uint32 size, sl_bool flagEncryptedRequest)
 	{
 		DnsHeader* header = (DnsHeader*)data;
 
-		sl_uint16 idForward = m_lastForwardId++;
-
-		ForwardElement fe;
+		_priv_DnsServer_ForwardElement fe;
 		fe.requestedId = header->getId();
 		fe.flagEncrypted = flagEncryptedRequest;
 		fe.clientAddress = clientAddress;
+		fe.forwardAddress = m_defaultForwardAddress;
+
+		sl_uint16 idForward;
+		Ref<_priv_DnsServer_Forwarder> forwarder = worker->addForward(this, m_flagEncryptDefaultForward, fe, m_forwardTimeout, idForward);
+		if (forwarder.isNull()) {
+			return;
+		}
 
 		header->setId(idForward);
 		Memory packet = Memory::create(data, size);
@@ -1100,20 +1676,15 @@ namespace slib
 			return;
 		}
 
-		m_mapForward.put(idForward, fe);
-
-		_sendPacket(m_flagEncryptDefaultForward, m_defaultForwardAddress, packet);
+		forwarder->socket->sendTo(m_defaultForwardAddress, packet);
 
 	}
 
-	void DnsServer::_processReceivedProxyAnswer(void* data, sl_uint32 size)
+	void DnsServer::_processReceivedProxyAnswer(_priv_DnsServer_Worker* worker, sl_uint32 indexForwarder, const SocketAddress& addressFrom, void* data, sl_uint32 size)
 	{
 		DnsHeader* header = (DnsHeader*)data;
-		sl_uint16 idForward = header->getId();
-		ForwardElement fe;
-		if (m_mapForward.get(idForward, &fe)) {
-
-			m_mapForward.remove(idForward);
+		_priv_DnsServer_ForwardElement fe;
+		if (worker->takeForward(indexForwarder, header->getId(), addressFrom, fe)) {
 
 			header->setId(fe.requestedId);
 			Memory packet = Memory::create(data, size);
@@ -1124,21 +1695,35 @@ namespace slib
 				return;
 			}
 
-			_sendPacket(fe.flagEncrypted, fe.clientAddress, packet);
+			_sendPacket(worker, fe.flagEncrypted, fe.clientAddress, packet);
 		}
 	}
 
-	void DnsServer::_sendPacket(sl_bool flagEncrypted, const SocketAddress& targetAddress, const Memory& packet)
+	void DnsServer::_forwardQuestion(_priv_DnsServer_Worker* worker, const SocketAddress& clientAddress, sl_uint16 id, const String& hostName, sl_bool flagEncryptedRequest, const SocketAddress& forwardAddress, sl_bool flagEncryptForward)
+	{
+		_priv_DnsServer_ForwardElement fe;
+		fe.clientAddress = clientAddress;
+		fe.requestedId = id;
+		fe.requestedHostName = hostName;
+		fe.flagEncrypted = flagEncryptedRequest;
+		fe.forwardAddress = forwardAddress;
+		sl_uint16 idForward;
+		Ref<_priv_DnsServer_Forwarder> forwarder = worker->addForward(this, flagEncryptForward, fe, m_forwardTimeout, idForward);
+		if (forwarder.isNotNull()) {
+			Memory packet = _buildQuestionPacket(idForward, hostName, flagEncryptForward);
+			if (packet.isNotEmpty()) {
+				forwarder->socket->sendTo(forwardAddress, packet);
+			}
+		}
+	}
+
+	void DnsServer::_sendPacket(_priv_DnsServer_Worker* worker, sl_bool flagEncrypted, const SocketAddress& targetAddress, const Memory& packet)
 	{
 		if (packet.isNotEmpty()) {
-			Ref<AsyncUdpSocket> socket;
 			if (flagEncrypted) {
-				socket = m_udpEncrypt;
+				worker->udpEncrypt->sendTo(targetAddress, packet);
 			} else {
-				socket = m_udpDns;
-			}
-			if (socket.isNotNull()) {
-				socket->sendTo(targetAddress, packet);
+				worker->udpDns->sendTo(targetAddress, packet);
 			}
 		}
 	}
@@ -1152,9 +1737,18 @@ namespace slib
 		return mem;
 	}
 
-	Memory DnsServer::_buildHostAddressAnswerPacket(sl_uint16 id, const String& hostName, const IPv4Address& hostAddress, sl_bool flagEncrypt)
+	Memory DnsServer::_buildHostAddressAnswerPacket(sl_uint16 id, const String& hostName, const IPv4Address& hostAddress, sl_uint32 TTL, sl_bool flagEncrypt)
+	{
+		Memory mem = DnsPacket::buildHostAddressAnswerPacket(id, hostName, hostAddress, TTL);
+		if (flagEncrypt) {
+			return m_encrypt.encrypt_CBC_PKCS7Padding(mem);
+		}
+		return mem;
+	}
+
+	Memory DnsServer::_buildNegativeAnswerPacket(sl_uint16 id, const String& hostName, DnsResponseCode responseCode, const DnsPacket::Authority& authority, sl_bool flagEncrypt)
 	{
-		Memory mem = DnsPacket::buildHostAddressAnswerPacket(id, hostName, hostAddress);
+		Memory mem = DnsPacket::buildNegativeAnswerPacket(id, hostName, responseCode, authority);
 		if (flagEncrypt) {
 			return m_encrypt.encrypt_CBC_PKCS7Padding(mem);
 		}
@@ -1163,10 +1757,29 @@ namespace slib
 
 	void DnsServer::onReceiveFrom(AsyncUdpSocket* socket, const SocketAddress& addressFrom, void* data, sl_uint32 size)
 	{
-		sl_bool flagEncrypted = sl_false;
+		ListElements< Ref<_priv_DnsServer_Worker> > workers(m_workers);
+		for (sl_size i = 0; i < workers.count; i++) {
+			_priv_DnsServer_Worker* worker = workers[i].get();
+			if (socket == worker->udpDns) {
+				_onReceiveQuestion(worker, sl_false, addressFrom, data, size);
+				return;
+			}
+			if (socket == worker->udpEncrypt) {
+				_onReceiveQuestion(worker, sl_true, addressFrom, data, size);
+				return;
+			}
+			sl_uint32 index;
+			if (worker->findForwarder(socket, index)) {
+				_onReceiveAnswer(worker, index, addressFrom, data, size);
+				return;
+			}
+		}
+	}
+
+	void DnsServer::_onReceiveQuestion(_priv_DnsServer_Worker* worker, sl_bool flagEncrypted, const SocketAddress& addressFrom, void* data, sl_uint32 size)
+	{
 		Memory memDecrypt;
-		if (socket == m_udpEncrypt) {
-			flagEncrypted = sl_true;
+		if (flagEncrypted) {
 			memDecrypt = m_encrypt.decrypt_CBC_PKCS7Padding(data, size);
 			if (memDecrypt.isEmpty()) {
 				return;
@@ -1180,23 +1793,51 @@ namespace slib
 			}
 			DnsHeader* header = (DnsHeader*)data;
 			if (header->isQuestion()) {
-				_processReceivedProxyQuestion(addressFrom, data, size, flagEncrypted);
-			} else {
-				_processReceivedProxyAnswer(data, size);
+				_processReceivedProxyQuestion(worker, addressFrom, data, size, flagEncrypted);
 			}
 		} else {
-			char* buf = (char*)data;
 			DnsPacket packet;
-			if (packet.parsePacket(buf, size)) {
+			if (packet.parsePacket(data, size)) {
 				if (packet.flagQuestion) {
 					if (packet.questions.getCount() == 1) {
 						DnsPacket::Question& question = (packet.questions.getData())[0];
 						if (question.type == DnsRecordType::A) {
-							_processReceivedDnsQuestion(addressFrom, packet.id, question.name, flagEncrypted);
+							_processReceivedDnsQuestion(worker, addressFrom, packet.id, question.name, flagEncrypted);
 						}
 					}
-				} else {
-					_processReceivedDnsAnswer(packet);
+				}
+			}
+		}
+	}
+
+	void DnsServer::_onReceiveAnswer(_priv_DnsServer_Worker* worker, sl_uint32 indexForwarder, const SocketAddress& addressFrom, void* data, sl_uint32 size)
+	{
+		Ref<_priv_DnsServer_Forwarder> forwarder = worker->forwarders.getValueAt(indexForwarder);
+		if (forwarder.isNull()) {
+			return;
+		}
+		Memory memDecrypt;
+		if (forwarder->flagEncrypted) {
+			memDecrypt = m_encrypt.decrypt_CBC_PKCS7Padding(data, size);
+			if (memDecrypt.isEmpty()) {
+				return;
+			}
+			data = memDecrypt.getData();
+			size = (sl_uint32)(memDecrypt.getSize());
+		}
+		if (m_flagProxy) {
+			if (size < sizeof(DnsHeader)) {
+				return;
+			}
+			DnsHeader* header = (DnsHeader*)data;
+			if (!(header->isQuestion())) {
+				_processReceivedProxyAnswer(worker, indexForwarder, addressFrom, data, size);
+			}
+		} else {
+			DnsPacket packet;
+			if (packet.parsePacket(data, size)) {
+				if (!(packet.flagQuestion)) {
+					_processReceivedDnsAnswer(worker, indexForwarder, addressFrom, packet);
 				}
 			}
 		}
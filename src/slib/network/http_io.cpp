@@ -59,6 +59,11 @@ namespace slib
 		m_bufferOutput.copyFromFile(path, dispatcher);
 	}
 
+	void HttpOutputBuffer::sendFile(const Ref<File>& file, sl_uint64 offset, sl_uint64 size)
+	{
+		m_bufferOutput.sendFile(file, offset, size);
+	}
+
 	sl_uint64 HttpOutputBuffer::getOutputLength() const
 	{
 		return m_bufferOutput.getOutputLength();
@@ -16,6 +16,7 @@
 #include "slib/core/log.h"
 #include "slib/core/json.h"
 #include "slib/core/content_type.h"
+#include "slib/core/system.h"
 
 #define SERVICE_TAG "HTTP SERVICE"
 
@@ -103,6 +104,13 @@ namespace slib
 
 	Ref<AsyncIoLoop> HttpServiceContext::getAsyncIoLoop()
 	{
+		Ref<AsyncStream> io = getIO();
+		if (io.isNotNull()) {
+			Ref<AsyncIoLoop> loop = io->getIoLoop();
+			if (loop.isNotNull()) {
+				return loop;
+			}
+		}
 		Ref<HttpService> service = getService();
 		if (service.isNotNull()) {
 			return service->getAsyncIoLoop();
@@ -149,6 +157,21 @@ namespace slib
 		}
 	}
 
+	const HashMap<String, String>& HttpServiceContext::getPathParameters() const
+	{
+		return m_pathParameters;
+	}
+
+	String HttpServiceContext::getPathParameter(const String& name) const
+	{
+		return m_pathParameters.getValue_NoLock(name, String::null());
+	}
+
+	void HttpServiceContext::setPathParameter(const String& name, const String& value)
+	{
+		m_pathParameters.put_NoLock(name, value);
+	}
+
 /******************************************************
 			HttpServiceConnection
 ******************************************************/
@@ -518,12 +541,14 @@ namespace slib
 	class _priv_DefaultHttpServiceConnectionProvider : public HttpServiceConnectionProvider, public IAsyncTcpServerListener
 	{
 	public:
-		Ref<AsyncTcpServer> m_server;
-		Ref<AsyncIoLoop> m_loop;
+		CList< Ref<AsyncTcpServer> > m_servers;
+		// accepted sockets are attached to the I/O loop of the listening server
+		sl_bool m_flagSharded;
 
 	public:
 		_priv_DefaultHttpServiceConnectionProvider()
 		{
+			m_flagSharded = sl_false;
 		}
 
 		~_priv_DefaultHttpServiceConnectionProvider()
@@ -534,22 +559,43 @@ namespace slib
 	public:
 		static Ref<HttpServiceConnectionProvider> create(HttpService* service, const SocketAddress& addressListen)
 		{
-			Ref<AsyncIoLoop> loop = service->getAsyncIoLoop();
-			if (loop.isNotNull()) {
-				Ref<_priv_DefaultHttpServiceConnectionProvider> ret = new _priv_DefaultHttpServiceConnectionProvider;
-				if (ret.isNotNull()) {
-					ret->m_loop = loop;
-					ret->setService(service);
-					AsyncTcpServerParam sp;
-					sp.bindAddress = addressListen;
-					sp.listener.setWeak(ret);
-					sp.ioLoop = loop;
+			ListElements< Ref<AsyncIoLoop> > loops(service->getAsyncIoLoops());
+			if (loops.count == 0) {
+				return sl_null;
+			}
+			Ref<_priv_DefaultHttpServiceConnectionProvider> ret = new _priv_DefaultHttpServiceConnectionProvider;
+			if (ret.isNull()) {
+				return sl_null;
+			}
+			ret->setService(service);
+			AsyncTcpServerParam sp;
+			sp.bindAddress = addressListen;
+			sp.listener.setWeak(ret);
+#if defined(SLIB_PLATFORM_IS_LINUX) && defined(SLIB_PLATFORM_IS_DESKTOP)
+			// kernel balances the incoming connections between the listeners sharing the port
+			if (loops.count > 1) {
+				sp.flagReusePort = sl_true;
+				for (sl_size i = 0; i < loops.count; i++) {
+					sp.ioLoop = loops[i];
 					Ref<AsyncTcpServer> server = AsyncTcpServer::create(sp);
-					if (server.isNotNull()) {
-						ret->m_server = server;
-						return ret;
+					if (server.isNull()) {
+						break;
 					}
+					ret->m_servers.add_NoLock(server);
 				}
+				if (ret->m_servers.getCount() == loops.count) {
+					ret->m_flagSharded = sl_true;
+					return ret;
+				}
+				ret->release();
+				sp.flagReusePort = sl_false;
+			}
+#endif
+			sp.ioLoop = loops[0];
+			Ref<AsyncTcpServer> server = AsyncTcpServer::create(sp);
+			if (server.isNotNull()) {
+				ret->m_servers.add_NoLock(server);
+				return ret;
 			}
 			return sl_null;
 		}
@@ -557,16 +603,23 @@ namespace slib
 		void release()
 		{
 			ObjectLocker lock(this);
-			if (m_server.isNotNull()) {
-				m_server->close();
+			ListElements< Ref<AsyncTcpServer> > servers(m_servers);
+			for (sl_size i = 0; i < servers.count; i++) {
+				servers[i]->close();
 			}
+			m_servers.removeAll_NoLock();
 		}
 
 		void onAccept(AsyncTcpServer* socketListen, const Ref<Socket>& socketAccept, const SocketAddress& address)
 		{
 			Ref<HttpService> service = getService();
 			if (service.isNotNull()) {
-				Ref<AsyncIoLoop> loop = m_loop;
+				Ref<AsyncIoLoop> loop;
+				if (m_flagSharded) {
+					loop = socketListen->getIoLoop();
+				} else {
+					loop = service->getNextAsyncIoLoop();
+				}
 				if (loop.isNull()) {
 					return;
 				}
@@ -607,6 +660,8 @@ namespace slib
 		maxThreadsCount = 32;
 		flagProcessByThreads = sl_true;
 		
+		ioLoopsCount = 1;
+		
 		flagUseAsset = sl_false;
 		
 		maxRequestHeadersSize = 0x10000; // 64KB
@@ -615,6 +670,10 @@ namespace slib
 		flagAllowCrossOrigin = sl_false;
 		flagAlwaysRespondAcceptRangesHeader = sl_true;
 		
+		flagUseSendFile = sl_true;
+		fileCacheDuration = 10000;
+		maxCachedFiles = 256;
+		
 		flagLogDebug = sl_false;
 	}
 
@@ -630,6 +689,7 @@ namespace slib
 	HttpService::HttpService()
 	{
 		m_flagRunning = sl_true;
+		m_indexNextIoLoop = 0;
 	}
 
 	HttpService::~HttpService()
@@ -639,30 +699,47 @@ namespace slib
 
 	sl_bool HttpService::_init(const HttpServiceParam& param)
 	{
-		Ref<AsyncIoLoop> ioLoop = AsyncIoLoop::create(sl_false);
-		if (ioLoop.isNotNull()) {
-			Ref<ThreadPool> threadPool = ThreadPool::create();
-			if (threadPool.isNotNull()) {
-				threadPool->setMaximumThreadsCount(param.maxThreadsCount);
-				
-				m_ioLoop = ioLoop;
-				m_threadPool = threadPool;
-				m_param = param;
-				if (param.port) {
-					if (! (addHttpService(param.addressBind, param.port))) {
-						return sl_false;
-					}
-				}
-				if (param.processor.isNotNull()) {
-					addProcessor(param.processor);
-				}
-				
-				ioLoop->start();
-
-				return sl_true;
+		sl_uint32 nLoops = param.ioLoopsCount;
+		if (nLoops == 0) {
+			nLoops = System::getProcessorsCount();
+		}
+		List< Ref<AsyncIoLoop> > ioLoops;
+		for (sl_uint32 i = 0; i < nLoops; i++) {
+			Ref<AsyncIoLoop> ioLoop = AsyncIoLoop::create(sl_false);
+			if (ioLoop.isNull()) {
+				return sl_false;
 			}
+			ioLoops.add_NoLock(ioLoop);
 		}
-		return sl_false;
+		Ref<ThreadPool> threadPool = ThreadPool::create();
+		if (threadPool.isNull()) {
+			return sl_false;
+		}
+		threadPool->setMaximumThreadsCount(param.maxThreadsCount);
+		
+		m_ioLoop = ioLoops.getValueAt(0);
+		m_ioLoops = ioLoops;
+		m_threadPool = threadPool;
+		m_param = param;
+		if (param.port) {
+			if (! (addHttpService(param.addressBind, param.port))) {
+				return sl_false;
+			}
+		}
+		if (param.processor.isNotNull()) {
+			addProcessor(param.processor);
+		}
+		if (param.flagUseSendFile && param.fileCacheDuration) {
+			m_cachedFiles.setMaximumCount(param.maxCachedFiles);
+			m_cachedFiles.setupTimer(param.fileCacheDuration);
+		}
+		
+		ListElements< Ref<AsyncIoLoop> > loops(ioLoops);
+		for (sl_size i = 0; i < loops.count; i++) {
+			loops[i]->start();
+		}
+
+		return sl_true;
 	}
 
 	Ref<HttpService> HttpService::create(const HttpServiceParam& param)
@@ -694,9 +771,12 @@ namespace slib
 		}
 		m_connectionProviders.removeAll();
 		
-		Ref<AsyncIoLoop> ioLoop = m_ioLoop;
-		if (ioLoop.isNotNull()) {
-			ioLoop->release();
+		{
+			ListElements< Ref<AsyncIoLoop> > loops(m_ioLoops);
+			for (sl_size i = 0; i < loops.count; i++) {
+				loops[i]->release();
+			}
+			m_ioLoops.setNull();
 			m_ioLoop.setNull();
 		}
 		Ref<ThreadPool> threadPool = m_threadPool;
@@ -706,6 +786,9 @@ namespace slib
 		}
 		
 		m_connections.removeAll();
+		
+		m_cachedFiles.clearTimer();
+		m_cachedFiles.removeAll();
 	}
 
 	sl_bool HttpService::isRunning()
@@ -718,6 +801,24 @@ namespace slib
 		return m_ioLoop;
 	}
 
+	List< Ref<AsyncIoLoop> > HttpService::getAsyncIoLoops()
+	{
+		return m_ioLoops;
+	}
+
+	Ref<AsyncIoLoop> HttpService::getNextAsyncIoLoop()
+	{
+		ListElements< Ref<AsyncIoLoop> > loops(m_ioLoops);
+		if (loops.count == 0) {
+			return sl_null;
+		}
+		if (loops.count == 1) {
+			return loops[0];
+		}
+		sl_uint32 index = (sl_uint32)(Base::interlockedIncrement32((sl_int32*)&m_indexNextIoLoop));
+		return loops[index % loops.count];
+	}
+
 	Ref<ThreadPool> HttpService::getThreadPool()
 	{
 		return m_threadPool;
@@ -756,19 +857,23 @@ namespace slib
 				}
 			}
 		
-			ListElements< Ptr<IHttpServiceProcessor> > processors(m_processorsCached);
 			{
-				sl_size i = 0;
-				for (; i < processors.count; i++) {
-					PtrLocker<IHttpServiceProcessor> processor(processors[i]);
-					if (processor.isNotNull()) {
-						if (processor->onHttpRequest(context)) {
-							break;
+				// borrowed, so that the concurrent requests do not write to the reference count of the shared list
+				BorrowedRef< CList< Ptr<IHttpServiceProcessor> > > processorList(m_processorsCached.ref);
+				if (processorList.isNotNull()) {
+					ListElements< Ptr<IHttpServiceProcessor> > processors(*processorList);
+					sl_size i = 0;
+					for (; i < processors.count; i++) {
+						PtrLocker<IHttpServiceProcessor> processor(processors[i]);
+						if (processor.isNotNull()) {
+							if (processor->onHttpRequest(context)) {
+								break;
+							}
 						}
 					}
-				}
-				if (i < processors.count) {
-					break;
+					if (i < processors.count) {
+						break;
+					}
 				}
 			}
 			
@@ -828,9 +933,23 @@ namespace slib
 
 	sl_bool HttpService::processFile(const Ref<HttpServiceContext>& context, const String& path)
 	{
-		if (File::exists(path) && !(File::isDirectory(path))) {
+		Ref<File> fileSending;
+		sl_uint64 totalSize = 0;
+		if (m_param.flagUseSendFile) {
+			Ref<AsyncStream> io = context->getIO();
+			if (io.isNotNull() && io->isWritingFromFileSupported()) {
+				fileSending = _openFileForSending(path, totalSize);
+				if (fileSending.isNull()) {
+					return sl_false;
+				}
+			}
+		}
+		
+		if (fileSending.isNotNull() || (File::exists(path) && !(File::isDirectory(path)))) {
 
-			sl_uint64 totalSize = File::getSize(path);
+			if (fileSending.isNull()) {
+				totalSize = File::getSize(path);
+			}
 
 			String ext = File::getFileExtension(path);
 			
@@ -854,6 +973,11 @@ namespace slib
 				
 				if (processRangeRequest(context, totalSize, rangeHeader, start, len)) {
 
+					if (fileSending.isNotNull()) {
+						context->sendFile(fileSending, start, len);
+						return sl_true;
+					}
+					
 					Ref<AsyncFile> file = AsyncFile::openForRead(path, m_threadPool);
 					if (file.isNotNull()) {
 						file->seek(start);
@@ -866,6 +990,10 @@ namespace slib
 				}
 				
 			} else {
+				if (fileSending.isNotNull()) {
+					context->sendFile(fileSending, 0, totalSize);
+					return sl_true;
+				}
 				if (totalSize > 100000) {
 					context->copyFromFile(path, m_threadPool);
 					return sl_true;
@@ -884,6 +1012,51 @@ namespace slib
 		
 	}
 
+	class _priv_HttpService_CachedFile : public Referable
+	{
+	public:
+		Ref<File> file;
+		Time modifiedTime;
+		sl_uint64 size;
+	};
+
+	Ref<File> HttpService::_openFileForSending(const String& path, sl_uint64& outSize)
+	{
+		Time modifiedTime = File::getModifiedTime(path);
+		if (modifiedTime.isZero()) {
+			return sl_null;
+		}
+		sl_bool flagCache = m_param.fileCacheDuration > 0 && m_param.maxCachedFiles > 0;
+		if (flagCache) {
+			Ref<_priv_HttpService_CachedFile> cached;
+			if (m_cachedFiles.get(path, &cached)) {
+				if (cached->modifiedTime == modifiedTime) {
+					outSize = cached->size;
+					return cached->file;
+				}
+			}
+		}
+		if (File::isDirectory(path)) {
+			return sl_null;
+		}
+		Ref<File> file = File::openForRead(path);
+		if (file.isNull()) {
+			return sl_null;
+		}
+		sl_uint64 size = file->getSize();
+		if (flagCache) {
+			Ref<_priv_HttpService_CachedFile> cached = new _priv_HttpService_CachedFile;
+			if (cached.isNotNull()) {
+				cached->file = file;
+				cached->modifiedTime = modifiedTime;
+				cached->size = size;
+				m_cachedFiles.put(path, cached);
+			}
+		}
+		outSize = size;
+		return file;
+	}
+
 	sl_bool HttpService::processRangeRequest(const Ref<HttpServiceContext>& context, sl_uint64 totalLength, const String& range, sl_uint64& outStart, sl_uint64& outLength)
 	{
 		if (range.getLength() < 2 || !(range.startsWith("bytes="))) {
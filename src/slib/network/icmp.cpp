@@ -59,9 +59,14 @@ namespace slib
 		return checksum == 0;
 	}
 
+	sl_bool IcmpHeaderFormat::checkSize(sl_uint32 sizeContent) const
+	{
+		return sizeContent >= sizeof(IcmpHeaderFormat);
+	}
+
 	sl_bool IcmpHeaderFormat::check(sl_uint32 sizeContent) const
 	{
-		if (sizeContent < sizeof(IcmpHeaderFormat)) {
+		if (!(checkSize(sizeContent))) {
 			return sl_false;
 		}
 		if (!(checkChecksum(sizeContent))) {
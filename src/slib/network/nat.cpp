@@ -15,6 +15,25 @@
 namespace slib
 {
 
+	/*
+		Translated packets are updated by the incremental checksum (RFC 1624) instead of the full recomputation,
+		so the packets having invalid checksum are still invalid after the translation and will be dropped by the end hosts.
+	*/
+
+	static sl_uint16 _priv_NatTable_adjustUdpChecksum(sl_uint16 checksum, sl_uint16 oldPort, sl_uint16 newPort, sl_uint32 oldAddress, sl_uint32 newAddress)
+	{
+		if (!checksum) {
+			// checksum is not used
+			return 0;
+		}
+		checksum = TCP_IP::adjustChecksum32(checksum, oldAddress, newAddress);
+		checksum = TCP_IP::adjustChecksum(checksum, oldPort, newPort);
+		if (!checksum) {
+			checksum = 0xFFFF;
+		}
+		return checksum;
+	}
+
 	NatTableParam::NatTableParam()
 	{
 		targetAddress.setZero();
@@ -60,33 +79,42 @@ namespace slib
 		if (addressTarget.isZero()) {
 			return sl_false;
 		}
+		// the other fragments do not contain the transport header
+		if (!(ipHeader->isFirstFragment())) {
+			return sl_false;
+		}
 		if (ipHeader->isTCP()) {
 			TcpSegment* tcp = (TcpSegment*)(ipContent);
-			if (tcp->check(ipHeader, sizeContent)) {
+			if (tcp->checkSize(sizeContent)) {
+				IPv4Address addressSource = ipHeader->getSourceAddress();
+				sl_uint16 portSource = tcp->getSourcePort();
 				sl_uint16 targetPort;
-				if (m_mappingTcp.mapToExternalPort(SocketAddress(ipHeader->getSourceAddress(), tcp->getSourcePort()), targetPort)) {
+				if (m_mappingTcp.mapToExternalPort(SocketAddress(addressSource, portSource), targetPort)) {
 					tcp->setSourcePort(targetPort);
 					ipHeader->setSourceAddress(addressTarget);
-					tcp->updateChecksum(ipHeader, sizeContent);
-					ipHeader->updateChecksum();
+					sl_uint16 checksum = TCP_IP::adjustChecksum32(tcp->getChecksum(), addressSource.getInt(), addressTarget.getInt());
+					tcp->setChecksum(TCP_IP::adjustChecksum(checksum, portSource, targetPort));
+					ipHeader->setChecksum(TCP_IP::adjustChecksum32(ipHeader->getChecksum(), addressSource.getInt(), addressTarget.getInt()));
 					return sl_true;
 				}
 			}
 		} else if (ipHeader->isUDP()) {
 			UdpDatagram* udp = (UdpDatagram*)(ipContent);
-			if (udp->check(ipHeader, sizeContent)) {
+			if (udp->checkSize(sizeContent)) {
+				IPv4Address addressSource = ipHeader->getSourceAddress();
+				sl_uint16 portSource = udp->getSourcePort();
 				sl_uint16 targetPort;
-				if (m_mappingUdp.mapToExternalPort(SocketAddress(ipHeader->getSourceAddress(), udp->getSourcePort()), targetPort)) {
+				if (m_mappingUdp.mapToExternalPort(SocketAddress(addressSource, portSource), targetPort)) {
 					udp->setSourcePort(targetPort);
 					ipHeader->setSourceAddress(addressTarget);
-					udp->updateChecksum(ipHeader);
-					ipHeader->updateChecksum();
+					udp->setChecksum(_priv_NatTable_adjustUdpChecksum(udp->getChecksum(), portSource, targetPort, addressSource.getInt(), addressTarget.getInt()));
+					ipHeader->setChecksum(TCP_IP::adjustChecksum32(ipHeader->getChecksum(), addressSource.getInt(), addressTarget.getInt()));
 					return sl_true;
 				}
 			}
 		} else if (ipHeader->isICMP()) {
 			IcmpHeaderFormat* icmp = (IcmpHeaderFormat*)(ipContent);
-			if (icmp->check(sizeContent)) {
+			if (icmp->checkSize(sizeContent)) {
 				if (icmp->getType() == IcmpType::Echo) {
 					IcmpEchoAddress address;
 					address.ip = ipHeader->getSourceAddress();
@@ -96,8 +124,10 @@ namespace slib
 					icmp->setEchoIdentifier(m_param.icmpEchoIdentifier);
 					icmp->setEchoSequenceNumber(sn);
 					ipHeader->setSourceAddress(addressTarget);
-					icmp->updateChecksum(sizeContent);
-					ipHeader->updateChecksum();
+					// ICMP checksum does not cover the pseudo header
+					sl_uint16 checksum = TCP_IP::adjustChecksum(icmp->getChecksum(), address.identifier, m_param.icmpEchoIdentifier);
+					icmp->setChecksum(TCP_IP::adjustChecksum(checksum, address.sequenceNumber, sn));
+					ipHeader->setChecksum(TCP_IP::adjustChecksum32(ipHeader->getChecksum(), address.ip.getInt(), addressTarget.getInt()));
 					return sl_true;
 				}
 			}
@@ -114,47 +144,59 @@ namespace slib
 		if (ipHeader->getDestinationAddress() != addressTarget) {
 			return sl_false;
 		}
+		// the other fragments do not contain the transport header
+		if (!(ipHeader->isFirstFragment())) {
+			return sl_false;
+		}
 		if (ipHeader->isTCP()) {
 			TcpSegment* tcp = (TcpSegment*)(ipContent);
-			if (tcp->check(ipHeader, sizeContent)) {
+			if (tcp->checkSize(sizeContent)) {
+				sl_uint16 portTarget = tcp->getDestinationPort();
 				SocketAddress addressSource;
-				if (m_mappingTcp.mapToInternalAddress(tcp->getDestinationPort(), addressSource)) {
-					ipHeader->setDestinationAddress(addressSource.ip.getIPv4());
+				if (m_mappingTcp.mapToInternalAddress(portTarget, addressSource)) {
+					IPv4Address ipSource = addressSource.ip.getIPv4();
+					ipHeader->setDestinationAddress(ipSource);
 					tcp->setDestinationPort(addressSource.port);
-					tcp->updateChecksum(ipHeader, sizeContent);
-					ipHeader->updateChecksum();
+					sl_uint16 checksum = TCP_IP::adjustChecksum32(tcp->getChecksum(), addressTarget.getInt(), ipSource.getInt());
+					tcp->setChecksum(TCP_IP::adjustChecksum(checksum, portTarget, addressSource.port));
+					ipHeader->setChecksum(TCP_IP::adjustChecksum32(ipHeader->getChecksum(), addressTarget.getInt(), ipSource.getInt()));
 					return sl_true;
 				}
 			}
 		} else if (ipHeader->isUDP()) {
-			UdpDatagram* udp = (UdpDatagram*)(ipHeader->getContent());
-			if (udp->check(ipHeader, sizeContent)) {
+			UdpDatagram* udp = (UdpDatagram*)(ipContent);
+			if (udp->checkSize(sizeContent)) {
+				sl_uint16 portTarget = udp->getDestinationPort();
 				SocketAddress addressSource;
-				if (m_mappingUdp.mapToInternalAddress(udp->getDestinationPort(), addressSource)) {
-					ipHeader->setDestinationAddress(addressSource.ip.getIPv4());
+				if (m_mappingUdp.mapToInternalAddress(portTarget, addressSource)) {
+					IPv4Address ipSource = addressSource.ip.getIPv4();
+					ipHeader->setDestinationAddress(ipSource);
 					udp->setDestinationPort(addressSource.port);
-					udp->updateChecksum(ipHeader);
-					ipHeader->updateChecksum();
+					udp->setChecksum(_priv_NatTable_adjustUdpChecksum(udp->getChecksum(), portTarget, addressSource.port, addressTarget.getInt(), ipSource.getInt()));
+					ipHeader->setChecksum(TCP_IP::adjustChecksum32(ipHeader->getChecksum(), addressTarget.getInt(), ipSource.getInt()));
 					return sl_true;
 				}
 			}
 		} else if (ipHeader->isICMP()) {
 			IcmpHeaderFormat* icmp = (IcmpHeaderFormat*)(ipContent);
-			if (icmp->check(sizeContent)) {
+			if (icmp->checkSize(sizeContent)) {
 				IcmpType type = icmp->getType();
 				if (type == IcmpType::EchoReply) {
 					if (icmp->getEchoIdentifier() == m_param.icmpEchoIdentifier) {
+						sl_uint16 sn = icmp->getEchoSequenceNumber();
 						IcmpEchoElement element;
-						if (m_mapIcmpEchoIncoming.get(icmp->getEchoSequenceNumber(), &element)) {
+						if (m_mapIcmpEchoIncoming.get(sn, &element)) {
 							ipHeader->setDestinationAddress(element.addressSource.ip);
 							icmp->setEchoIdentifier(element.addressSource.identifier);
 							icmp->setEchoSequenceNumber(element.addressSource.sequenceNumber);
-							icmp->updateChecksum(sizeContent);
-							ipHeader->updateChecksum();
+							sl_uint16 checksum = TCP_IP::adjustChecksum(icmp->getChecksum(), m_param.icmpEchoIdentifier, element.addressSource.identifier);
+							icmp->setChecksum(TCP_IP::adjustChecksum(checksum, sn, element.addressSource.sequenceNumber));
+							ipHeader->setChecksum(TCP_IP::adjustChecksum32(ipHeader->getChecksum(), addressTarget.getInt(), element.addressSource.ip.getInt()));
 							return sl_true;
 						}
 					}
-				} else if (type == IcmpType::DestinationUnreachable || type == IcmpType::TimeExceeded) {
+				} else if ((type == IcmpType::DestinationUnreachable || type == IcmpType::TimeExceeded) && icmp->checkChecksum(sizeContent)) {
+					// error messages are rare and small, so they are fully verified and recomputed
 					IPv4Packet* ipOrig = (IPv4Packet*)(icmp->getContent());
 					sl_uint32 sizeOrig = sizeContent - sizeof(IcmpHeaderFormat);
 					if (sizeOrig == sizeof(IPv4Packet)+8 && IPv4Packet::checkHeader(ipOrig, sizeOrig) && ipOrig->getDestinationAddress() == addressTarget) {
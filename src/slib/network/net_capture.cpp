@@ -19,6 +19,16 @@
 #include "slib/network/tcpip.h"
 #include "slib/network/ethernet.h"
 
+#if defined(SLIB_PLATFORM_IS_LINUX)
+#	include <sys/socket.h>
+#	include <sys/mman.h>
+#	include <unistd.h>
+#	include <linux/if_packet.h>
+#	include <errno.h>
+#	define PRIV_NET_CAPTURE_SUPPORT_RING
+#	define PRIV_NET_CAPTURE_FANOUT_RETRY 16
+#endif
+
 #define TAG "NetCapture"
 
 #define MAX_PACKET_SIZE 65535
@@ -57,6 +67,12 @@ namespace slib
 		
 		preferedLinkDeviceType = NetworkLinkDeviceType::Ethernet;
 		
+		flagUseRingBuffer = sl_true;
+		sizeRingBlock = 0x100000; // 1MB
+		countRingBlocks = 32;
+		timeoutRingBlock = 10;
+		countFanoutThreads = 1;
+		
 		flagAutoStart = sl_true;
 	}
 	
@@ -101,6 +117,145 @@ namespace slib
 	}
 	
 	
+#if defined(PRIV_NET_CAPTURE_SUPPORT_RING)
+	/*
+		Memory-mapped receive ring (TPACKET_V3)
+	 
+		The kernel fills the packets into the blocks of the shared memory and passes the block to the user
+		when it is full or `timeoutRingBlock` is elapsed. The block is returned to the kernel after all of its
+		packets are delivered to the listener.
+	*/
+	class _priv_NetRawPacketCapture_Ring : public Referable
+	{
+	public:
+		Ref<Socket> socket;
+		sl_uint8* memory;
+		sl_uint32 sizeBlock;
+		sl_uint32 countBlocks;
+		Ref<Thread> thread;
+		sl_bool flagAttached;
+		
+	public:
+		_priv_NetRawPacketCapture_Ring()
+		{
+			memory = sl_null;
+			sizeBlock = 0;
+			countBlocks = 0;
+			flagAttached = sl_false;
+		}
+		
+		~_priv_NetRawPacketCapture_Ring()
+		{
+			if (memory) {
+				::munmap(memory, (size_t)sizeBlock * countBlocks);
+			}
+		}
+		
+	public:
+		sl_bool setup(const NetCaptureParam& param)
+		{
+			int fd = (int)(socket->getHandle());
+			int version = TPACKET_V3;
+			if (::setsockopt(fd, SOL_PACKET, PACKET_VERSION, &version, sizeof(version))) {
+				return sl_false;
+			}
+			sl_uint32 sizePage = (sl_uint32)(::getpagesize());
+			sl_uint32 _sizeBlock = param.sizeRingBlock;
+			if (_sizeBlock < sizePage) {
+				_sizeBlock = sizePage;
+			}
+			// must be multiple of page size
+			_sizeBlock = (_sizeBlock + sizePage - 1) / sizePage * sizePage;
+			sl_uint32 _countBlocks = param.countRingBlocks;
+			if (_countBlocks < 2) {
+				_countBlocks = 2;
+			}
+			sl_uint32 sizeFrame = TPACKET_ALIGNMENT << 7;
+			tpacket_req3 req;
+			Base::zeroMemory(&req, sizeof(req));
+			req.tp_block_size = _sizeBlock;
+			req.tp_block_nr = _countBlocks;
+			req.tp_frame_size = sizeFrame;
+			req.tp_frame_nr = _sizeBlock / sizeFrame * _countBlocks;
+			req.tp_retire_blk_tov = param.timeoutRingBlock;
+			if (::setsockopt(fd, SOL_PACKET, PACKET_RX_RING, &req, sizeof(req))) {
+				return sl_false;
+			}
+			flagAttached = sl_true;
+			sizeBlock = _sizeBlock;
+			countBlocks = _countBlocks;
+			void* mem = ::mmap(sl_null, (size_t)_sizeBlock * _countBlocks, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+			if (mem == MAP_FAILED) {
+				return sl_false;
+			}
+			memory = (sl_uint8*)mem;
+			return sl_true;
+		}
+		
+		// unmaps and removes the ring from the socket, so that the socket can be read by `recvfrom`
+		sl_bool detach()
+		{
+			if (memory) {
+				::munmap(memory, (size_t)sizeBlock * countBlocks);
+				memory = sl_null;
+			}
+			if (flagAttached) {
+				// the kernel frees the ring when it is requested with zero blocks (after unmapping)
+				int fd = (int)(socket->getHandle());
+				tpacket_req3 req;
+				Base::zeroMemory(&req, sizeof(req));
+				if (::setsockopt(fd, SOL_PACKET, PACKET_RX_RING, &req, sizeof(req))) {
+					return sl_false;
+				}
+				flagAttached = sl_false;
+			}
+			return sl_true;
+		}
+		
+		// creates a new fanout group with this socket
+		sl_bool createFanout(sl_uint16& outGroupId)
+		{
+			int fd = (int)(socket->getHandle());
+			int arg;
+#if defined(PACKET_FANOUT_FLAG_UNIQUEID)
+			// the kernel (4.3 or later) assigns an unused group id
+			arg = (PACKET_FANOUT_HASH | PACKET_FANOUT_FLAG_DEFRAG | PACKET_FANOUT_FLAG_UNIQUEID) << 16;
+			if (!(::setsockopt(fd, SOL_PACKET, PACKET_FANOUT, &arg, sizeof(arg)))) {
+				socklen_t len = sizeof(arg);
+				if (!(::getsockopt(fd, SOL_PACKET, PACKET_FANOUT, &arg, &len))) {
+					outGroupId = (sl_uint16)arg;
+					return sl_true;
+				}
+				return sl_false;
+			}
+#endif
+			// group ids are shared by the processes, so the ids used by other groups are skipped
+			static sl_int32 seed = 0;
+			sl_uint32 pid = (sl_uint32)(::getpid());
+			for (sl_uint32 i = 0; i < PRIV_NET_CAPTURE_FANOUT_RETRY; i++) {
+				sl_uint16 groupId = (sl_uint16)((pid ^ (pid >> 16)) + (sl_uint32)(Base::interlockedIncrement32(&seed)) * 40503);
+				if (joinFanout(groupId)) {
+					outGroupId = groupId;
+					return sl_true;
+				}
+				int err = errno;
+				if (err != EADDRINUSE && err != EINVAL) {
+					return sl_false;
+				}
+			}
+			return sl_false;
+		}
+		
+		sl_bool joinFanout(sl_uint16 groupId)
+		{
+			int fd = (int)(socket->getHandle());
+			int arg = (int)groupId | ((PACKET_FANOUT_HASH | PACKET_FANOUT_FLAG_DEFRAG) << 16);
+			return !(::setsockopt(fd, SOL_PACKET, PACKET_FANOUT, &arg, sizeof(arg)));
+		}
+		
+	};
+#endif
+	
 	class _priv_NetRawPacketCapture : public NetCapture
 	{
 	public:
@@ -110,6 +265,9 @@ namespace slib
 		sl_uint32 m_ifaceIndex;
 		Memory m_bufPacket;
 		Ref<Thread> m_thread;
+#if defined(PRIV_NET_CAPTURE_SUPPORT_RING)
+		List< Ref<_priv_NetRawPacketCapture_Ring> > m_rings;
+#endif
 		
 		sl_bool m_flagInit;
 		sl_bool m_flagRunning;
@@ -130,6 +288,24 @@ namespace slib
 		}
 		
 	public:
+		static Ref<Socket> _openSocket(const NetCaptureParam& param, NetworkLinkDeviceType deviceType, sl_uint32 iface)
+		{
+			Ref<Socket> socket;
+			if (deviceType == NetworkLinkDeviceType::Raw) {
+				socket = Socket::openPacketDatagram(NetworkLinkProtocol::All);
+			} else {
+				socket = Socket::openPacketRaw(NetworkLinkProtocol::All);
+			}
+			if (socket.isNotNull()) {
+				if (iface > 0) {
+					if (!(socket->setOption_bindToDevice(param.deviceName))) {
+						Log(TAG, "Failed to bind the network device: %s", param.deviceName);
+					}
+				}
+			}
+			return socket;
+		}
+		
 		static Ref<_priv_NetRawPacketCapture> create(const NetCaptureParam& param)
 		{
 			
@@ -142,14 +318,11 @@ namespace slib
 					return sl_null;
 				}
 			}
-			Ref<Socket> socket;
 			NetworkLinkDeviceType deviceType = param.preferedLinkDeviceType;
-			if (deviceType == NetworkLinkDeviceType::Raw) {
-				socket = Socket::openPacketDatagram(NetworkLinkProtocol::All);
-			} else {
+			if (deviceType != NetworkLinkDeviceType::Raw) {
 				deviceType = NetworkLinkDeviceType::Ethernet;
-				socket = Socket::openPacketRaw(NetworkLinkProtocol::All);
 			}
+			Ref<Socket> socket = _openSocket(param, deviceType, iface);
 			if (socket.isNotNull()) {
 				if (iface > 0) {
 					if (param.flagPromiscuous) {
@@ -157,19 +330,37 @@ namespace slib
 							Log(TAG, "Failed to set promiscuous mode to the network device: %s", deviceName);
 						}
 					}
-					if (!(socket->setOption_bindToDevice(deviceName))) {
-						Log(TAG, "Failed to bind the network device: %s", deviceName);
-					}
 				}
-				Memory mem = Memory::create(MAX_PACKET_SIZE);
-				if (mem.isNotEmpty()) {
-					Ref<_priv_NetRawPacketCapture> ret = new _priv_NetRawPacketCapture;
-					if (ret.isNotNull()) {
-						ret->_initWithParam(param);
+				Ref<_priv_NetRawPacketCapture> ret = new _priv_NetRawPacketCapture;
+				if (ret.isNotNull()) {
+					ret->_initWithParam(param);
+					ret->m_socket = socket;
+					ret->m_deviceType = deviceType;
+					ret->m_ifaceIndex = iface;
+#if defined(PRIV_NET_CAPTURE_SUPPORT_RING)
+					if (param.flagUseRingBuffer) {
+						if (ret->_createRings(param, socket)) {
+							ret->m_flagInit = sl_true;
+							if (param.flagAutoStart) {
+								ret->start();
+							}
+							return ret;
+						}
+						Log(TAG, "Failed to setup the packet ring, fallback to the receiving by system calls");
+						if (!(ret->_releaseRings())) {
+							// the ring is still attached to the first socket
+							socket = _openSocket(param, deviceType, iface);
+							if (socket.isNull()) {
+								LogError(TAG, "Failed to create Packet socket");
+								return sl_null;
+							}
+							ret->m_socket = socket;
+						}
+					}
+#endif
+					Memory mem = Memory::create(MAX_PACKET_SIZE);
+					if (mem.isNotEmpty()) {
 						ret->m_bufPacket = mem;
-						ret->m_socket = socket;
-						ret->m_deviceType = deviceType;
-						ret->m_ifaceIndex = iface;
 						ret->m_thread = Thread::create(SLIB_FUNCTION_CLASS(_priv_NetRawPacketCapture, _run, ret.get()));
 						if (ret->m_thread.isNotNull()) {
 							ret->m_flagInit = sl_true;
@@ -188,6 +379,76 @@ namespace slib
 			return sl_null;
 		}
 		
+#if defined(PRIV_NET_CAPTURE_SUPPORT_RING)
+		sl_bool _createRings(const NetCaptureParam& param, const Ref<Socket>& socketFirst)
+		{
+			sl_uint32 nThreads = param.countFanoutThreads;
+			if (nThreads < 1) {
+				nThreads = 1;
+			}
+			sl_uint16 fanoutGroupId = 0;
+			for (sl_uint32 i = 0; i < nThreads; i++) {
+				Ref<_priv_NetRawPacketCapture_Ring> ring = new _priv_NetRawPacketCapture_Ring;
+				if (ring.isNull()) {
+					return sl_false;
+				}
+				if (i) {
+					ring->socket = _openSocket(param, m_deviceType, m_ifaceIndex);
+					if (ring->socket.isNull()) {
+						return sl_false;
+					}
+				} else {
+					ring->socket = socketFirst;
+				}
+				// added before setup, so that `_releaseRings` detaches the partially created ring
+				if (!(m_rings.add_NoLock(ring))) {
+					return sl_false;
+				}
+				if (!(ring->setup(param))) {
+					return sl_false;
+				}
+				if (nThreads > 1) {
+					if (i) {
+						if (!(ring->joinFanout(fanoutGroupId))) {
+							return sl_false;
+						}
+					} else {
+						if (!(ring->createFanout(fanoutGroupId))) {
+							return sl_false;
+						}
+					}
+				}
+				ring->thread = Thread::create(SLIB_BIND_CLASS(void(), _priv_NetRawPacketCapture, _runRing, this, ring.get()));
+				if (ring->thread.isNull()) {
+					LogError(TAG, "Failed to create thread");
+					return sl_false;
+				}
+			}
+			return sl_true;
+		}
+		
+		// releases the rings created by failed `_createRings`. returns false if the first socket could not be restored
+		sl_bool _releaseRings()
+		{
+			sl_bool flagRestored = sl_true;
+			ListElements< Ref<_priv_NetRawPacketCapture_Ring> > rings(m_rings);
+			for (sl_size i = 0; i < rings.count; i++) {
+				Ref<Thread>& thread = rings[i]->thread;
+				if (thread.isNotNull()) {
+					thread->finishAndWait();
+					thread.setNull();
+				}
+				if (!(rings[i]->detach())) {
+					if (!i) {
+						flagRestored = sl_false;
+					}
+				}
+			}
+			m_rings.setNull();
+			return flagRestored;
+		}
+#endif
+		
 		void release()
 		{
 			ObjectLocker lock(this);
@@ -201,6 +462,18 @@ namespace slib
 				m_thread->finishAndWait();
 				m_thread.setNull();
 			}
+#if defined(PRIV_NET_CAPTURE_SUPPORT_RING)
+			{
+				ListElements< Ref<_priv_NetRawPacketCapture_Ring> > rings(m_rings);
+				for (sl_size i = 0; i < rings.count; i++) {
+					rings[i]->thread->finish();
+				}
+				for (sl_size i = 0; i < rings.count; i++) {
+					rings[i]->thread->finishAndWait();
+				}
+			}
+			m_rings.setNull();
+#endif
 			m_socket.setNull();
 		}
 		
@@ -214,6 +487,18 @@ namespace slib
 			if (m_flagRunning) {
 				return;
 			}
+#if defined(PRIV_NET_CAPTURE_SUPPORT_RING)
+			if (m_rings.isNotNull()) {
+				ListElements< Ref<_priv_NetRawPacketCapture_Ring> > rings(m_rings);
+				for (sl_size i = 0; i < rings.count; i++) {
+					if (!(rings[i]->thread->start())) {
+						return;
+					}
+				}
+				m_flagRunning = sl_true;
+				return;
+			}
+#endif
 			if (m_thread.isNotNull()) {
 				if (m_thread->start()) {
 					m_flagRunning = sl_true;
@@ -260,6 +545,44 @@ namespace slib
 			}
 		}
 		
+#if defined(PRIV_NET_CAPTURE_SUPPORT_RING)
+		void _runRing(_priv_NetRawPacketCapture_Ring* ring)
+		{
+			NetCapturePacket packet;
+			
+			Ref<Socket> socket = ring->socket;
+			socket->setNonBlockingMode(sl_true);
+			Ref<SocketEvent> event = SocketEvent::createRead(socket);
+			if (event.isNull()) {
+				return;
+			}
+			
+			sl_uint32 indexBlock = 0;
+			while (Thread::isNotStoppingCurrent()) {
+				tpacket_block_desc* block = (tpacket_block_desc*)(ring->memory + (sl_size)indexBlock * ring->sizeBlock);
+				if (!(__atomic_load_n(&(block->hdr.bh1.block_status), __ATOMIC_ACQUIRE) & TP_STATUS_USER)) {
+					event->wait();
+					continue;
+				}
+				sl_uint32 nPackets = block->hdr.bh1.num_pkts;
+				tpacket3_hdr* hdr = (tpacket3_hdr*)((sl_uint8*)block + block->hdr.bh1.offset_to_first_pkt);
+				for (sl_uint32 i = 0; i < nPackets; i++) {
+					packet.data = (sl_uint8*)hdr + hdr->tp_mac;
+					packet.length = hdr->tp_snaplen;
+					packet.time = (sl_int64)(hdr->tp_sec) * 1000000 + hdr->tp_nsec / 1000;
+					_onCapturePacket(&packet);
+					hdr = (tpacket3_hdr*)((sl_uint8*)hdr + hdr->tp_next_offset);
+				}
+				// return the block to the kernel
+				__atomic_store_n(&(block->hdr.bh1.block_status), (sl_uint32)TP_STATUS_KERNEL, __ATOMIC_RELEASE);
+				indexBlock++;
+				if (indexBlock >= ring->countBlocks) {
+					indexBlock = 0;
+				}
+			}
+		}
+#endif
+		
 		NetworkLinkDeviceType getLinkType()
 		{
 			return m_deviceType;
@@ -346,6 +346,7 @@ namespace slib
 		
 		flagAutoStart = sl_true;
 		flagLogError = sl_true;
+		flagReusePort = sl_false;
 	}
 
 	AsyncTcpServerParam::~AsyncTcpServerParam()
@@ -390,6 +391,9 @@ namespace slib
 			 * http://stackoverflow.com/questions/14388706/socket-options-so-reuseaddr-and-so-reuseport-how-do-they-differ-do-they-mean-t
 			 */
 			socket->setOption_ReuseAddress(sl_true);
+			if (param.flagReusePort) {
+				socket->setOption_ReusePort(sl_true);
+			}
 #endif
 
 			if (!(socket->bind(param.bindAddress))) {
@@ -535,13 +539,14 @@ namespace slib
 
 #define UDP_QUEUE_MAX_SIZE 1024000
 
-	sl_bool AsyncUdpSocketInstance::sendTo(const SocketAddress& addressTo, const Memory& data)
+	sl_bool AsyncUdpSocketInstance::sendTo(const SocketAddress& addressTo, const Memory& data, sl_uint32 segmentSize)
 	{
 		if (isOpened()) {
 			if (data.isNotEmpty()) {
 				SendRequest request;
 				request.addressTo = addressTo;
 				request.data = data;
+				request.segmentSize = segmentSize;
 				if (m_queueSendRequests.getCount() < UDP_QUEUE_MAX_SIZE) {
 					if (m_queueSendRequests.push(request)) {
 						return sl_true;
@@ -552,6 +557,25 @@ namespace slib
 		return sl_false;
 	}
 
+	void AsyncUdpSocketInstance::_sendTo(Socket* socket, const SendRequest& request)
+	{
+		sl_uint8* data = (sl_uint8*)(request.data.getData());
+		sl_size size = request.data.getSize();
+		sl_size segment = request.segmentSize;
+		if (!segment || segment > size) {
+			segment = size;
+		}
+		while (size) {
+			sl_size n = segment;
+			if (n > size) {
+				n = size;
+			}
+			socket->sendTo(request.addressTo, data, (sl_uint32)n);
+			data += n;
+			size -= n;
+		}
+	}
+
 	void AsyncUdpSocketInstance::_onReceive(const SocketAddress& address, sl_uint32 size)
 	{
 		Ref<AsyncUdpSocket> object = Ref<AsyncUdpSocket>::from(getObject());
@@ -560,6 +584,14 @@ namespace slib
 		}
 	}
 
+	void AsyncUdpSocketInstance::_onReceive(AsyncUdpDatagram* datagrams, sl_uint32 count)
+	{
+		Ref<AsyncUdpSocket> object = Ref<AsyncUdpSocket>::from(getObject());
+		if (object.isNotNull()) {
+			object->_onReceive(datagrams, count);
+		}
+	}
+
 
 	IAsyncUdpSocketListener::IAsyncUdpSocketListener()
 	{
@@ -569,13 +601,23 @@ namespace slib
 	{
 	}
 
+	void IAsyncUdpSocketListener::onReceiveFromBatch(AsyncUdpSocket* socket, AsyncUdpDatagram* datagrams, sl_uint32 count)
+	{
+		for (sl_uint32 i = 0; i < count; i++) {
+			onReceiveFrom(socket, datagrams[i].address, datagrams[i].data, datagrams[i].size);
+		}
+	}
+
 	AsyncUdpSocketParam::AsyncUdpSocketParam()
 	{
 		flagIPv6 = sl_false;
 		flagBroadcast = sl_false;
+		flagReusePort = sl_false;
 		flagAutoStart = sl_false;
 		flagLogError = sl_false;
 		packetSize = 65536;
+		batchCount = 1;
+		flagGRO = sl_false;
 	}
 
 	AsyncUdpSocketParam::~AsyncUdpSocketParam()
@@ -595,7 +637,7 @@ namespace slib
 
 	Ref<AsyncUdpSocket> AsyncUdpSocket::create(const AsyncUdpSocketParam& param)
 	{
-		if (param.packetSize < 1) {
+		if (param.packetSize < 1 || param.batchCount < 1) {
 			return sl_null;
 		}
 		
@@ -621,6 +663,9 @@ namespace slib
 			 * http://stackoverflow.com/questions/14388706/socket-options-so-reuseaddr-and-so-reuseport-how-do-they-differ-do-they-mean-t
 			 */
 			socket->setOption_ReuseAddress(sl_true);
+			if (param.flagReusePort) {
+				socket->setOption_ReusePort(sl_true);
+			}
 #endif
 			if (param.bindAddress.ip.isNotNone() || param.bindAddress.port != 0) {
 				if (!(socket->bind(param.bindAddress))) {
@@ -635,7 +680,7 @@ namespace slib
 			socket->setOption_Broadcast(sl_true);
 		}
 		
-		Ref<AsyncUdpSocketInstance> instance = _createInstance(socket, param.packetSize);
+		Ref<AsyncUdpSocketInstance> instance = _createInstance(socket, param);
 		if (instance.isNotNull()) {
 			Ref<AsyncIoLoop> loop = param.ioLoop;
 			if (loop.isNull()) {
@@ -648,10 +693,17 @@ namespace slib
 			if (ret.isNotNull()) {
 				ret->m_listener = param.listener;
 				ret->m_onReceiveFrom = param.onReceiveFrom;
+				ret->m_onReceiveFromBatch = param.onReceiveFromBatch;
 				instance->setObject(ret.get());
 				ret->setIoInstance(instance.get());
 				ret->setIoLoop(loop);
-				if (loop->attachInstance(instance.get(), AsyncIoMode::In)) {
+#if defined(SLIB_PLATFORM_IS_LINUX) && !defined(SLIB_PLATFORM_IS_ANDROID)
+				// batched sending (sendmmsg) keeps the messages on EAGAIN, and resumes on EPOLLOUT
+				AsyncIoMode mode = AsyncIoMode::InOut;
+#else
+				AsyncIoMode mode = AsyncIoMode::In;
+#endif
+				if (loop->attachInstance(instance.get(), mode)) {
 					if (param.flagAutoStart) {
 						ret->start();
 					}
@@ -729,6 +781,11 @@ namespace slib
 	}
 
 	sl_bool AsyncUdpSocket::sendTo(const SocketAddress& addressTo, const Memory& mem)
+	{
+		return sendTo(addressTo, mem, 0);
+	}
+
+	sl_bool AsyncUdpSocket::sendTo(const SocketAddress& addressTo, const Memory& mem, sl_uint32 segmentSize)
 	{
 		Ref<AsyncIoLoop> loop = getIoLoop();
 		if (loop.isNull()) {
@@ -736,7 +793,7 @@ namespace slib
 		}
 		Ref<AsyncUdpSocketInstance> instance = _getIoInstance();
 		if (instance.isNotNull()) {
-			if (instance->sendTo(addressTo, mem)) {
+			if (instance->sendTo(addressTo, mem, segmentSize)) {
 				loop->requestOrder(instance.get());
 				return sl_true;
 			}
@@ -750,12 +807,26 @@ namespace slib
 	}
 
 	void AsyncUdpSocket::_onReceive(const SocketAddress& address, void* data, sl_uint32 sizeReceived)
+	{
+		AsyncUdpDatagram datagram;
+		datagram.address = address;
+		datagram.data = data;
+		datagram.size = sizeReceived;
+		_onReceive(&datagram, 1);
+	}
+
+	void AsyncUdpSocket::_onReceive(AsyncUdpDatagram* datagrams, sl_uint32 count)
 	{
 		PtrLocker<IAsyncUdpSocketListener> listener(m_listener);
 		if (listener.isNotNull()) {
-			listener->onReceiveFrom(this, address, data, sizeReceived);
+			listener->onReceiveFromBatch(this, datagrams, count);
+		}
+		m_onReceiveFromBatch(this, datagrams, count);
+		if (m_onReceiveFrom.isNotNull()) {
+			for (sl_uint32 i = 0; i < count; i++) {
+				m_onReceiveFrom(this, datagrams[i].address, datagrams[i].data, datagrams[i].size);
+			}
 		}
-		m_onReceiveFrom(this, address, data, sizeReceived);
 	}
 
 }
@@ -97,11 +97,13 @@ namespace slib
 		
 		Ref<Socket> getSocket();
 		
-		sl_bool sendTo(const SocketAddress& address, const Memory& data);
+		sl_bool sendTo(const SocketAddress& address, const Memory& data, sl_uint32 segmentSize = 0);
 		
 	protected:
 		void _onReceive(const SocketAddress& address, sl_uint32 size);
 		
+		void _onReceive(AsyncUdpDatagram* datagrams, sl_uint32 count);
+		
 	protected:
 		AtomicRef<Socket> m_socket;
 
@@ -112,7 +114,12 @@ namespace slib
 		{
 			SocketAddress addressTo;
 			Memory data;
+			sl_uint32 segmentSize; // 0: single datagram
 		};
+		
+		// sends the segments by separated datagrams
+		static void _sendTo(Socket* socket, const SendRequest& request);
+		
 		LinkedQueue<SendRequest> m_queueSendRequests;
 		
 	};
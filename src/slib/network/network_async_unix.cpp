@@ -14,6 +14,33 @@
 
 #include "network_async.h"
 
+#if defined(SLIB_PLATFORM_IS_LINUX)
+#include <sys/sendfile.h>
+#include <errno.h>
+#endif
+
+#if defined(SLIB_PLATFORM_IS_LINUX) && !defined(SLIB_PLATFORM_IS_ANDROID)
+#define PRIV_ASYNC_UDP_SUPPORT_MMSG
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/udp.h>
+#ifndef SOL_UDP
+#define SOL_UDP 17
+#endif
+#ifndef UDP_SEGMENT
+#define UDP_SEGMENT 103
+#endif
+#ifndef UDP_GRO
+#define UDP_GRO 104
+#endif
+// limits of a GSO send on the kernel
+#define PRIV_ASYNC_UDP_GSO_MAX_SEGMENTS 64
+#define PRIV_ASYNC_UDP_GSO_MAX_SIZE 65000
+// a coalesced (GRO) message can be as large as the maximum UDP payload
+#define PRIV_ASYNC_UDP_GRO_MAX_SIZE 65536
+#define PRIV_ASYNC_UDP_CONTROL_SIZE 32
+#endif
+
 namespace slib
 {
 
@@ -63,6 +90,22 @@ namespace slib
 			setHandle(SLIB_FILE_INVALID_HANDLE);
 			m_socket.setNull();
 		}
+
+#if defined(SLIB_PLATFORM_IS_LINUX)
+		sl_bool isWritingFromFileSupported() override
+		{
+			return sl_true;
+		}
+
+		sl_bool writeFromFile(const Ref<File>& file, sl_uint64 offset, sl_uint32 size, const Function<void(AsyncStreamResult*)>& callback, Referable* userObject) override
+		{
+			Ref<AsyncStreamRequest> req = AsyncStreamRequest::createWriteFromFile(file, offset, size, userObject, callback);
+			if (req.isNotNull()) {
+				return addWriteRequest(req);
+			}
+			return sl_false;
+		}
+#endif
 		
 		void processRead(sl_bool flagError)
 		{
@@ -130,7 +173,11 @@ namespace slib
 						return;
 					}
 				}
-				if (request->data && request->size) {
+				if (request->file.isNotNull() && request->size) {
+					if (!(processWriteFromFile(socket.get(), request.get(), flagError))) {
+						return;
+					}
+				} else if (request->data && request->size) {
 					sl_uint32 size = request->size - m_sizeWritten;
 					sl_int32 n = socket->send((char*)(request->data) + m_sizeWritten, size);
 					if (n > 0) {
@@ -158,6 +205,32 @@ namespace slib
 			}
 		}
 		
+		// returns false when the request is waiting for the socket or failed
+		sl_bool processWriteFromFile(Socket* socket, AsyncStreamRequest* request, sl_bool flagError)
+		{
+#if defined(SLIB_PLATFORM_IS_LINUX)
+			sl_uint32 size = request->size - m_sizeWritten;
+			off_t offset = (off_t)(request->offsetFile + m_sizeWritten);
+			ssize_t n = ::sendfile((int)(socket->getHandle()), (int)(request->file->getHandle()), &offset, size);
+			if (n > 0) {
+				m_sizeWritten += (sl_uint32)n;
+				if (m_sizeWritten >= request->size) {
+					_onSend(request, request->size, flagError);
+				} else {
+					m_requestWriting = request;
+				}
+				return sl_true;
+			}
+			if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK) && !flagError) {
+				m_requestWriting = request;
+				return sl_false;
+			}
+#endif
+			// error, or the file is shorter than requested
+			_onSend(request, m_sizeWritten, sl_true);
+			return sl_false;
+		}
+		
 		void onOrder()
 		{
 			Ref<Socket> socket = m_socket;
@@ -300,11 +373,89 @@ namespace slib
 		return _priv_Unix_AsyncTcpServerInstance::create(socket);
 	}
 
+#if defined(PRIV_ASYNC_UDP_SUPPORT_MMSG)
+	// message headers of `recvmmsg`/`sendmmsg`
+	class _priv_Unix_UdpMessages
+	{
+	public:
+		Memory memory;
+		sockaddr_storage* addresses;
+		mmsghdr* messages;
+		iovec* vectors;
+		char* controls;
+		sl_uint32* segments;
+		sl_uint32 count;
+
+	public:
+		_priv_Unix_UdpMessages()
+		{
+			addresses = sl_null;
+			messages = sl_null;
+			vectors = sl_null;
+			controls = sl_null;
+			segments = sl_null;
+			count = 0;
+		}
+
+	public:
+		sl_bool create(sl_uint32 _count)
+		{
+			memory = Memory::create((sizeof(sockaddr_storage) + sizeof(mmsghdr) + sizeof(iovec) + PRIV_ASYNC_UDP_CONTROL_SIZE + sizeof(sl_uint32)) * _count);
+			if (memory.isNull()) {
+				return sl_false;
+			}
+			Base::zeroMemory(memory.getData(), memory.getSize());
+			addresses = (sockaddr_storage*)(memory.getData());
+			messages = (mmsghdr*)(addresses + _count);
+			vectors = (iovec*)(messages + _count);
+			controls = (char*)(vectors + _count);
+			segments = (sl_uint32*)(controls + PRIV_ASYNC_UDP_CONTROL_SIZE * _count);
+			count = _count;
+			return sl_true;
+		}
+
+	};
+#endif
+
 	class _priv_Unix_AsyncUdpSocketInstance : public AsyncUdpSocketInstance
 	{
+#if defined(PRIV_ASYNC_UDP_SUPPORT_MMSG)
+	public:
+		sl_uint32 m_packetSize;
+		sl_bool m_flagGRO;
+		sl_bool m_flagGSO;
+		_priv_Unix_UdpMessages m_messagesReceive;
+		_priv_Unix_UdpMessages m_messagesSend;
+		Array<AsyncUdpDatagram> m_datagrams;
+
+		// state of the sending messages, kept while the socket is not writable (EAGAIN)
+		Array<SendRequest> m_requestsSend; // keeps the data referenced until the messages are sent
+		sl_uint32 m_nRequestsSend;
+		sl_uint32 m_nMessagesSend; // built messages
+		sl_uint32 m_nMessagesSent;
+		// rest of the last request, not built into the messages yet
+		sockaddr_storage m_addressSend;
+		sl_uint32 m_sizeAddressSend;
+		sl_uint8* m_dataSend;
+		sl_size m_sizeSend;
+		sl_uint32 m_segmentSend;
+#endif
+		
 	public:
 		_priv_Unix_AsyncUdpSocketInstance()
 		{
+#if defined(PRIV_ASYNC_UDP_SUPPORT_MMSG)
+			m_packetSize = 0;
+			m_flagGRO = sl_false;
+			m_flagGSO = sl_true;
+			m_nRequestsSend = 0;
+			m_nMessagesSend = 0;
+			m_nMessagesSent = 0;
+			m_sizeAddressSend = 0;
+			m_dataSend = sl_null;
+			m_sizeSend = 0;
+			m_segmentSend = 0;
+#endif
 		}
 		
 		~_priv_Unix_AsyncUdpSocketInstance()
@@ -313,7 +464,7 @@ namespace slib
 		}
 		
 	public:
-		static Ref<_priv_Unix_AsyncUdpSocketInstance> create(const Ref<Socket>& socket, const Memory& buffer)
+		static Ref<_priv_Unix_AsyncUdpSocketInstance> create(const Ref<Socket>& socket, const AsyncUdpSocketParam& param)
 		{
 			Ref<_priv_Unix_AsyncUdpSocketInstance> ret;
 			if (socket.isNotNull()) {
@@ -322,9 +473,11 @@ namespace slib
 					if (handle != SLIB_FILE_INVALID_HANDLE) {
 						ret = new _priv_Unix_AsyncUdpSocketInstance();
 						if (ret.isNotNull()) {
+							if (!(ret->_initBuffers(handle, param))) {
+								return sl_null;
+							}
 							ret->m_socket = socket;
 							ret->setHandle(handle);
-							ret->m_buffer = buffer;
 							return ret;
 						}
 					}
@@ -333,6 +486,47 @@ namespace slib
 			return ret;
 		}
 		
+		sl_bool _initBuffers(sl_file handle, const AsyncUdpSocketParam& param)
+		{
+#if defined(PRIV_ASYNC_UDP_SUPPORT_MMSG)
+			sl_uint32 nBatch = param.batchCount;
+			if (nBatch > 1 || param.flagGRO) {
+				sl_uint32 sizePacket = param.packetSize;
+				if (param.flagGRO) {
+					int opt = 1;
+					m_flagGRO = ::setsockopt((int)handle, SOL_UDP, UDP_GRO, &opt, sizeof(opt)) == 0;
+					if (m_flagGRO && sizePacket < PRIV_ASYNC_UDP_GRO_MAX_SIZE) {
+						sizePacket = PRIV_ASYNC_UDP_GRO_MAX_SIZE;
+					}
+				}
+				m_buffer = Memory::create((sl_size)sizePacket * nBatch);
+				if (m_buffer.isNull()) {
+					return sl_false;
+				}
+				if (!(m_messagesReceive.create(nBatch))) {
+					return sl_false;
+				}
+				m_datagrams = Array<AsyncUdpDatagram>::create(nBatch);
+				if (m_datagrams.isNull()) {
+					return sl_false;
+				}
+				m_packetSize = sizePacket;
+			} else {
+				m_buffer = Memory::create(param.packetSize);
+			}
+			if (!(m_messagesSend.create(nBatch))) {
+				return sl_false;
+			}
+			m_requestsSend = Array<SendRequest>::create(nBatch);
+			if (m_requestsSend.isNull()) {
+				return sl_false;
+			}
+#else
+			m_buffer = Memory::create(param.packetSize);
+#endif
+			return m_buffer.isNotNull();
+		}
+		
 		void close()
 		{
 			AsyncUdpSocketInstance::close();
@@ -348,6 +542,12 @@ namespace slib
 		
 		void onEvent(EventDesc* pev)
 		{
+#if defined(PRIV_ASYNC_UDP_SUPPORT_MMSG)
+			if (pev->flagOut) {
+				// the socket became writable after EAGAIN
+				processSend();
+			}
+#endif
 			if (pev->flagIn) {
 				processReceive();
 			}
@@ -362,14 +562,18 @@ namespace slib
 			if (!(socket->isOpened())) {
 				return;
 			}
+#if defined(PRIV_ASYNC_UDP_SUPPORT_MMSG)
+			processSendMessages(socket.get());
+#else
 			while (Thread::isNotStoppingCurrent()) {
 				SendRequest request;
 				if (m_queueSendRequests.pop(&request)) {
-					socket->sendTo(request.addressTo, request.data.getData(), (sl_uint32)(request.data.getSize()));
+					_sendTo(socket.get(), request);
 				} else {
 					break;
 				}
 			}
+#endif
 		}
 		
 		void processReceive()
@@ -381,6 +585,12 @@ namespace slib
 			if (!(socket->isOpened())) {
 				return;
 			}
+#if defined(PRIV_ASYNC_UDP_SUPPORT_MMSG)
+			if (m_messagesReceive.count) {
+				processReceiveMessages(socket.get());
+				return;
+			}
+#endif
 			void* buf = m_buffer.getData();
 			sl_uint32 sizeBuf = (sl_uint32)(m_buffer.getSize());
 			while (Thread::isNotStoppingCurrent()) {
@@ -393,16 +603,268 @@ namespace slib
 				}
 			}
 		}
+		
+#if defined(PRIV_ASYNC_UDP_SUPPORT_MMSG)
+		void processReceiveMessages(Socket* socket)
+		{
+			int fd = (int)(socket->getHandle());
+			sl_uint32 nMessages = m_messagesReceive.count;
+			sl_uint8* buf = (sl_uint8*)(m_buffer.getData());
+			sl_uint32 sizePacket = m_packetSize;
+			mmsghdr* messages = m_messagesReceive.messages;
+			while (Thread::isNotStoppingCurrent()) {
+				for (sl_uint32 i = 0; i < nMessages; i++) {
+					iovec& iov = m_messagesReceive.vectors[i];
+					iov.iov_base = buf + (sl_size)sizePacket * i;
+					iov.iov_len = sizePacket;
+					msghdr& hdr = messages[i].msg_hdr;
+					hdr.msg_name = m_messagesReceive.addresses + i;
+					hdr.msg_namelen = sizeof(sockaddr_storage);
+					hdr.msg_iov = &iov;
+					hdr.msg_iovlen = 1;
+					if (m_flagGRO) {
+						hdr.msg_control = m_messagesReceive.controls + PRIV_ASYNC_UDP_CONTROL_SIZE * i;
+						hdr.msg_controllen = PRIV_ASYNC_UDP_CONTROL_SIZE;
+					} else {
+						hdr.msg_control = sl_null;
+						hdr.msg_controllen = 0;
+					}
+					hdr.msg_flags = 0;
+					messages[i].msg_len = 0;
+				}
+				int n = ::recvmmsg(fd, messages, nMessages, 0, sl_null);
+				if (n <= 0) {
+					break;
+				}
+				// a coalesced (GRO) message is split into the datagrams of `UDP_GRO` size
+				sl_uint32* segments = m_messagesReceive.segments;
+				sl_size nDatagrams = 0;
+				for (int i = 0; i < n; i++) {
+					sl_uint32 size = messages[i].msg_len;
+					sl_uint32 segment = size;
+					if (m_flagGRO) {
+						msghdr& hdr = messages[i].msg_hdr;
+						for (cmsghdr* cmsg = CMSG_FIRSTHDR(&hdr); cmsg; cmsg = CMSG_NXTHDR(&hdr, cmsg)) {
+							if (cmsg->cmsg_level == SOL_UDP && cmsg->cmsg_type == UDP_GRO) {
+								int gso = 0;
+								Base::copyMemory(&gso, CMSG_DATA(cmsg), sizeof(int));
+								if (gso > 0 && (sl_uint32)gso < size) {
+									segment = (sl_uint32)gso;
+								}
+							}
+						}
+					}
+					if (m_flagGRO && (messages[i].msg_hdr.msg_flags & MSG_TRUNC)) {
+						// drops the incomplete last datagram
+						size -= size % segment;
+						messages[i].msg_len = size;
+					}
+					segments[i] = segment;
+					if (size) {
+						nDatagrams += (size + segment - 1) / segment;
+					}
+				}
+				if (m_datagrams.getCount() < nDatagrams) {
+					m_datagrams = Array<AsyncUdpDatagram>::create(nDatagrams);
+					if (m_datagrams.isNull()) {
+						return;
+					}
+				}
+				AsyncUdpDatagram* datagrams = m_datagrams.getData();
+				sl_size k = 0;
+				for (int i = 0; i < n; i++) {
+					sl_uint32 size = messages[i].msg_len;
+					if (!size) {
+						continue;
+					}
+					SocketAddress address;
+					address.setSystemSocketAddress(m_messagesReceive.addresses + i, messages[i].msg_hdr.msg_namelen);
+					sl_uint8* data = buf + (sl_size)sizePacket * i;
+					sl_uint32 segment = segments[i];
+					while (size) {
+						sl_uint32 m = size < segment ? size : segment;
+						AsyncUdpDatagram& datagram = datagrams[k++];
+						datagram.address = address;
+						datagram.data = data;
+						datagram.size = m;
+						data += m;
+						size -= m;
+					}
+				}
+				if (k) {
+					_onReceive(datagrams, (sl_uint32)k);
+				}
+				if ((sl_uint32)n < nMessages) {
+					break;
+				}
+			}
+		}
+		
+		void processSendMessages(Socket* socket)
+		{
+			// the messages left by EAGAIN are sent first, keeping the order
+			if (!(flushMessages(socket))) {
+				return;
+			}
+			sl_bool flagIPv6 = socket->isIPv6();
+			sl_uint32 nMessages = m_messagesSend.count;
+			SendRequest* requests = m_requestsSend.getData();
+			while (Thread::isNotStoppingCurrent()) {
+				if (!m_sizeSend) {
+					SendRequest& request = requests[m_nRequestsSend];
+					if (!(m_queueSendRequests.pop(&request))) {
+						break;
+					}
+					m_nRequestsSend++;
+					SocketAddress address = request.addressTo;
+					if (flagIPv6 && address.ip.isIPv4()) {
+						address.ip = IPv6Address(address.ip.getIPv4());
+					}
+					m_sizeAddressSend = address.getSystemSocketAddress(&m_addressSend);
+					m_dataSend = (sl_uint8*)(request.data.getData());
+					m_sizeSend = m_sizeAddressSend ? request.data.getSize() : 0;
+					m_segmentSend = request.segmentSize;
+					if (!m_segmentSend || m_segmentSend >= m_sizeSend) {
+						m_segmentSend = 0;
+					}
+				}
+				while (m_sizeSend && m_nMessagesSend < nMessages) {
+					_buildMessage();
+				}
+				if (m_nMessagesSend == nMessages || m_nRequestsSend == nMessages) {
+					if (!(flushMessages(socket))) {
+						return;
+					}
+				}
+			}
+			flushMessages(socket);
+		}
+
+		// builds a message from the rest of the last request
+		void _buildMessage()
+		{
+			sl_uint32 n = m_nMessagesSend;
+			sl_size m = m_sizeSend;
+			sl_uint32 segment = m_segmentSend;
+			sl_uint32 segmentMessage = 0;
+			if (segment) {
+				if (m_flagGSO) {
+					sl_size nSegments = PRIV_ASYNC_UDP_GSO_MAX_SIZE / segment;
+					if (nSegments > PRIV_ASYNC_UDP_GSO_MAX_SEGMENTS) {
+						nSegments = PRIV_ASYNC_UDP_GSO_MAX_SEGMENTS;
+					}
+					if (nSegments < 2) {
+						nSegments = 1;
+					}
+					if (m > segment * nSegments) {
+						m = segment * nSegments;
+					}
+					if (m > segment) {
+						segmentMessage = segment;
+					}
+				} else {
+					if (m > segment) {
+						m = segment;
+					}
+				}
+			}
+			Base::copyMemory(m_messagesSend.addresses + n, &m_addressSend, m_sizeAddressSend);
+			iovec& iov = m_messagesSend.vectors[n];
+			iov.iov_base = m_dataSend;
+			iov.iov_len = m;
+			msghdr& hdr = m_messagesSend.messages[n].msg_hdr;
+			hdr.msg_name = m_messagesSend.addresses + n;
+			hdr.msg_namelen = m_sizeAddressSend;
+			hdr.msg_iov = &iov;
+			hdr.msg_iovlen = 1;
+			hdr.msg_flags = 0;
+			if (segmentMessage) {
+				char* control = m_messagesSend.controls + PRIV_ASYNC_UDP_CONTROL_SIZE * n;
+				Base::zeroMemory(control, CMSG_SPACE(sizeof(sl_uint16)));
+				hdr.msg_control = control;
+				hdr.msg_controllen = CMSG_SPACE(sizeof(sl_uint16));
+				cmsghdr* cmsg = CMSG_FIRSTHDR(&hdr);
+				cmsg->cmsg_level = SOL_UDP;
+				cmsg->cmsg_type = UDP_SEGMENT;
+				cmsg->cmsg_len = CMSG_LEN(sizeof(sl_uint16));
+				sl_uint16 gso = (sl_uint16)segmentMessage;
+				Base::copyMemory(CMSG_DATA(cmsg), &gso, sizeof(gso));
+			} else {
+				hdr.msg_control = sl_null;
+				hdr.msg_controllen = 0;
+			}
+			m_messagesSend.segments[n] = segmentMessage;
+			m_nMessagesSend = n + 1;
+			m_dataSend += m;
+			m_sizeSend -= m;
+		}
+
+		// returns false when the socket is not writable (EAGAIN). the rest of the messages are sent on the next `EPOLLOUT`
+		sl_bool flushMessages(Socket* socket)
+		{
+			int fd = (int)(socket->getHandle());
+			mmsghdr* messages = m_messagesSend.messages;
+			sl_uint32 n = m_nMessagesSend;
+			sl_uint32 i = m_nMessagesSent;
+			while (i < n) {
+				int ret = ::sendmmsg(fd, messages + i, n - i, 0);
+				if (ret > 0) {
+					i += ret;
+					continue;
+				}
+				int err = errno;
+				if (err == EAGAIN || err == EWOULDBLOCK) {
+					m_nMessagesSent = i;
+					return sl_false;
+				}
+				if (err == EINTR) {
+					continue;
+				}
+				sl_uint32 segment = m_messagesSend.segments[i];
+				if (segment && (err == EIO || err == EINVAL || err == ENOPROTOOPT)) {
+					// GSO is not supported by the device or the kernel
+					m_flagGSO = sl_false;
+					msghdr& hdr = messages[i].msg_hdr;
+					sl_uint8* data = (sl_uint8*)(hdr.msg_iov->iov_base);
+					sl_size size = hdr.msg_iov->iov_len;
+					while (size) {
+						sl_size m = size < segment ? size : segment;
+						::sendto(fd, data, m, 0, (sockaddr*)(hdr.msg_name), hdr.msg_namelen);
+						data += m;
+						size -= m;
+					}
+				}
+				i++;
+			}
+			m_nMessagesSend = 0;
+			m_nMessagesSent = 0;
+			// releases the data of the sent requests, except the last one which is still used by the next messages
+			SendRequest* requests = m_requestsSend.getData();
+			sl_uint32 nRequests = m_nRequestsSend;
+			if (m_sizeSend && nRequests) {
+				nRequests--;
+				if (nRequests) {
+					requests[0] = Move(requests[nRequests]);
+				}
+				for (sl_uint32 k = 1; k < nRequests; k++) {
+					requests[k].data.setNull();
+				}
+				m_nRequestsSend = 1;
+			} else {
+				for (sl_uint32 k = 0; k < nRequests; k++) {
+					requests[k].data.setNull();
+				}
+				m_nRequestsSend = 0;
+			}
+			return sl_true;
+		}
+#endif
 
 	};
 
-	Ref<AsyncUdpSocketInstance> AsyncUdpSocket::_createInstance(const Ref<Socket>& socket, sl_uint32 packetSize)
+	Ref<AsyncUdpSocketInstance> AsyncUdpSocket::_createInstance(const Ref<Socket>& socket, const AsyncUdpSocketParam& param)
 	{
-		Memory buffer = Memory::create(packetSize);
-		if (buffer.isNotEmpty()) {
-			return _priv_Unix_AsyncUdpSocketInstance::create(socket, buffer);
-		}
-		return sl_null;
+		return _priv_Unix_AsyncUdpSocketInstance::create(socket, param);
 	}
 }
 
@@ -553,7 +553,7 @@ namespace slib
 			while (Thread::isNotStoppingCurrent()) {
 				SendRequest request;
 				if (m_queueSendRequests.pop(&request)) {
-					socket->sendTo(request.addressTo, request.data.getData(), (sl_uint32)(request.data.getSize()));
+					_sendTo(socket.get(), request);
 				} else {
 					break;
 				}
@@ -601,9 +601,9 @@ namespace slib
 
 	};
 
-	Ref<AsyncUdpSocketInstance> AsyncUdpSocket::_createInstance(const Ref<Socket>& socket, sl_uint32 packetSize)
+	Ref<AsyncUdpSocketInstance> AsyncUdpSocket::_createInstance(const Ref<Socket>& socket, const AsyncUdpSocketParam& param)
 	{
-		Memory buffer = Memory::create(packetSize);
+		Memory buffer = Memory::create(param.packetSize);
 		if (buffer.isNotEmpty()) {
 			return _priv_Win32AsyncUdpSocketInstance::create(socket, buffer);
 		}
@@ -13,29 +13,165 @@
 #include "slib/network/icmp.h"
 #include "slib/core/mio.h"
 
+#if defined(SLIB_ARCH_IS_X64) && (defined(SLIB_COMPILER_IS_VC) || defined(SLIB_COMPILER_IS_GCC))
+#	define PRIV_TCPIP_SUPPORT_SIMD
+#	include <emmintrin.h>
+#	include <immintrin.h>
+#	if defined(SLIB_COMPILER_IS_VC)
+#		include <intrin.h>
+#		define PRIV_TCPIP_SSE2_FUNC
+#		define PRIV_TCPIP_AVX2_FUNC
+#	else
+#		include <cpuid.h>
+#		define PRIV_TCPIP_SSE2_FUNC __attribute__((target("sse2")))
+#		define PRIV_TCPIP_AVX2_FUNC __attribute__((target("avx2")))
+#	endif
+#endif
+
 namespace slib
 {
 
-	sl_uint16 TCP_IP::calculateOneComplementSum(const void* data, sl_size size, sl_uint32 add)
-	{
-		sl_uint32 sum = add;
-		sl_uint8* p = (sl_uint8*)data;
-		while (size > 1) {
-			sl_uint16 w = *((sl_uint8*)(p));
-			w = (w << 8) | *((sl_uint8*)(p + 1));
-			sum += w; // can be computed in either byte order
+	// sum of 16-bit big-endian words (`size` is even)
+	static sl_uint64 _priv_TCPIP_sumWords(const sl_uint8* p, sl_size size)
+	{
+		sl_uint64 sum = 0;
+		while (size >= 8) {
+			sum += ((sl_uint32)(p[0]) << 8) | p[1];
+			sum += ((sl_uint32)(p[2]) << 8) | p[3];
+			sum += ((sl_uint32)(p[4]) << 8) | p[5];
+			sum += ((sl_uint32)(p[6]) << 8) | p[7];
+			p += 8;
+			size -= 8;
+		}
+		while (size) {
+			sum += ((sl_uint32)(p[0]) << 8) | p[1];
 			p += 2;
 			size -= 2;
 		}
-		if (size) {
-			sl_uint16 w = *((sl_uint8*)p);
-			w = w << 8;
-			sum += w;
+		return sum;
+	}
+	
+#if defined(PRIV_TCPIP_SUPPORT_SIMD)
+	/*
+		The word sum is computed as (sum of even bytes) * 256 + (sum of odd bytes).
+		PSADBW adds the bytes into 64-bit lanes, so the accumulators never overflow.
+	*/
+	PRIV_TCPIP_SSE2_FUNC static sl_uint64 _priv_TCPIP_sumWords_SSE2(const sl_uint8* p, sl_size size)
+	{
+		__m128i zero = _mm_setzero_si128();
+		__m128i mask = _mm_set1_epi16(0x00FF);
+		__m128i sumEven = zero;
+		__m128i sumOdd = zero;
+		while (size >= 32) {
+			__m128i v0 = _mm_loadu_si128((const __m128i*)p);
+			__m128i v1 = _mm_loadu_si128((const __m128i*)(p + 16));
+			sumEven = _mm_add_epi64(sumEven, _mm_sad_epu8(_mm_and_si128(v0, mask), zero));
+			sumOdd = _mm_add_epi64(sumOdd, _mm_sad_epu8(_mm_srli_epi16(v0, 8), zero));
+			sumEven = _mm_add_epi64(sumEven, _mm_sad_epu8(_mm_and_si128(v1, mask), zero));
+			sumOdd = _mm_add_epi64(sumOdd, _mm_sad_epu8(_mm_srli_epi16(v1, 8), zero));
+			p += 32;
+			size -= 32;
+		}
+		__m128i sum = _mm_add_epi64(_mm_slli_epi64(sumEven, 8), sumOdd);
+		sum = _mm_add_epi64(sum, _mm_unpackhi_epi64(sum, sum));
+		SLIB_ALIGN(16) sl_uint64 t[2];
+		_mm_store_si128((__m128i*)t, sum);
+		return t[0] + _priv_TCPIP_sumWords(p, size);
+	}
+	
+	PRIV_TCPIP_AVX2_FUNC static sl_uint64 _priv_TCPIP_sumWords_AVX2(const sl_uint8* p, sl_size size)
+	{
+		__m256i zero = _mm256_setzero_si256();
+		__m256i mask = _mm256_set1_epi16(0x00FF);
+		__m256i sumEven = zero;
+		__m256i sumOdd = zero;
+		while (size >= 64) {
+			__m256i v0 = _mm256_loadu_si256((const __m256i*)p);
+			__m256i v1 = _mm256_loadu_si256((const __m256i*)(p + 32));
+			sumEven = _mm256_add_epi64(sumEven, _mm256_sad_epu8(_mm256_and_si256(v0, mask), zero));
+			sumOdd = _mm256_add_epi64(sumOdd, _mm256_sad_epu8(_mm256_srli_epi16(v0, 8), zero));
+			sumEven = _mm256_add_epi64(sumEven, _mm256_sad_epu8(_mm256_and_si256(v1, mask), zero));
+			sumOdd = _mm256_add_epi64(sumOdd, _mm256_sad_epu8(_mm256_srli_epi16(v1, 8), zero));
+			p += 64;
+			size -= 64;
+		}
+		if (size >= 32) {
+			__m256i v = _mm256_loadu_si256((const __m256i*)p);
+			sumEven = _mm256_add_epi64(sumEven, _mm256_sad_epu8(_mm256_and_si256(v, mask), zero));
+			sumOdd = _mm256_add_epi64(sumOdd, _mm256_sad_epu8(_mm256_srli_epi16(v, 8), zero));
+			p += 32;
+			size -= 32;
+		}
+		__m256i sum = _mm256_add_epi64(_mm256_slli_epi64(sumEven, 8), sumOdd);
+		__m128i s = _mm_add_epi64(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+		s = _mm_add_epi64(s, _mm_unpackhi_epi64(s, s));
+		SLIB_ALIGN(16) sl_uint64 t[2];
+		_mm_store_si128((__m128i*)t, s);
+		// the remaining words are added here, to avoid switching to the legacy SSE code
+		return t[0] + _priv_TCPIP_sumWords(p, size);
+	}
+	
+	static sl_bool _priv_TCPIP_isAVX2Supported()
+	{
+		static sl_int32 flagSupported = -1;
+		if (flagSupported < 0) {
+			sl_bool flag = sl_false;
+#if defined(SLIB_COMPILER_IS_VC)
+			int info[4];
+			__cpuid(info, 1);
+			// OSXSAVE (bit 27), AVX (bit 28)
+			if ((info[2] & (1 << 27)) && (info[2] & (1 << 28))) {
+				if ((_xgetbv(0) & 6) == 6) {
+					__cpuidex(info, 7, 0);
+					flag = (info[1] & (1 << 5)) != 0;
+				}
+			}
+#else
+			unsigned int eax, ebx, ecx, edx;
+			if (__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+				if ((ecx & (1 << 27)) && (ecx & (1 << 28))) {
+					unsigned int xcr0, xcr0High;
+					__asm__ __volatile__ ("xgetbv" : "=a"(xcr0), "=d"(xcr0High) : "c"(0));
+					if ((xcr0 & 6) == 6) {
+						__cpuid_count(7, 0, eax, ebx, ecx, edx);
+						flag = (ebx & (1 << 5)) != 0;
+					}
+				}
+			}
+#endif
+			flagSupported = flag ? 1 : 0;
+		}
+		return flagSupported > 0;
+	}
+#endif
+	
+
+	sl_uint16 TCP_IP::calculateOneComplementSum(const void* data, sl_size size, sl_uint32 add)
+	{
+		const sl_uint8* p = (const sl_uint8*)data;
+		sl_size sizeWords = size & ~((sl_size)1);
+		sl_uint64 sum = add;
+#if defined(PRIV_TCPIP_SUPPORT_SIMD)
+		if (sizeWords >= 64) {
+			static sl_bool flagAVX2 = _priv_TCPIP_isAVX2Supported();
+			if (flagAVX2) {
+				sum += _priv_TCPIP_sumWords_AVX2(p, sizeWords);
+			} else {
+				sum += _priv_TCPIP_sumWords_SSE2(p, sizeWords);
+			}
+		} else {
+			sum += _priv_TCPIP_sumWords(p, sizeWords);
+		}
+#else
+		sum += _priv_TCPIP_sumWords(p, sizeWords);
+#endif
+		if (size & 1) {
+			sum += (sl_uint32)(p[sizeWords]) << 8;
 		}
 		while (sum >> 16) {
 			sum = (sum >> 16) + (sum & 0xffff); // 1's complement sum
 		}
-		return sum;
+		return (sl_uint16)sum;
 	}
 	
 	// Referenced from RFC 1071
@@ -44,6 +180,29 @@ namespace slib
 		sl_uint16 sum = TCP_IP::calculateOneComplementSum(data, size);
 		return (sl_uint16)(~sum); // 1's complement
 	}
+
+	// Referenced from RFC 1624: HC' = ~(~HC + ~m + m')
+	sl_uint16 TCP_IP::adjustChecksum(sl_uint16 checksum, sl_uint16 oldValue, sl_uint16 newValue)
+	{
+		sl_uint32 sum = (sl_uint16)(~checksum);
+		sum += (sl_uint16)(~oldValue);
+		sum += newValue;
+		sum = (sum >> 16) + (sum & 0xffff);
+		sum += sum >> 16;
+		return (sl_uint16)(~sum);
+	}
+	
+	sl_uint16 TCP_IP::adjustChecksum32(sl_uint16 checksum, sl_uint32 oldValue, sl_uint32 newValue)
+	{
+		sl_uint32 sum = (sl_uint16)(~checksum);
+		sum += (sl_uint16)(~(oldValue >> 16));
+		sum += (sl_uint16)(~oldValue);
+		sum += newValue >> 16;
+		sum += newValue & 0xffff;
+		sum = (sum >> 16) + (sum & 0xffff);
+		sum += sum >> 16;
+		return (sl_uint16)(~sum);
+	}
 	
 	
 	sl_uint32 IPv4Packet::getVersion() const
@@ -394,7 +553,7 @@ namespace slib
 		return checksum == 0;
 	}
 	
-	sl_bool TcpSegment::check(IPv4Packet* ip, sl_uint32 sizeTcp) const
+	sl_bool TcpSegment::checkSize(sl_uint32 sizeTcp) const
 	{
 		if (sizeTcp < sizeof(TcpSegment)) {
 			return sl_false;
@@ -402,6 +561,14 @@ namespace slib
 		if (sizeTcp < getHeaderSize()) {
 			return sl_false;
 		}
+		return sl_true;
+	}
+	
+	sl_bool TcpSegment::check(IPv4Packet* ip, sl_uint32 sizeTcp) const
+	{
+		if (!(checkSize(sizeTcp))) {
+			return sl_false;
+		}
 		if (!(checkChecksum(ip, sizeTcp))) {
 			return sl_false;
 		}
@@ -459,7 +626,7 @@ namespace slib
 		return checksum == 0 || checksum == 0xFFFF;
 	}
 	
-	sl_bool UdpDatagram::check(IPv4Packet* ip, sl_uint32 sizeUdp) const
+	sl_bool UdpDatagram::checkSize(sl_uint32 sizeUdp) const
 	{
 		if (sizeUdp < HeaderSize) {
 			return sl_false;
@@ -467,6 +634,14 @@ namespace slib
 		if (sizeUdp != getTotalSize()) {
 			return sl_false;
 		}
+		return sl_true;
+	}
+	
+	sl_bool UdpDatagram::check(IPv4Packet* ip, sl_uint32 sizeUdp) const
+	{
+		if (!(checkSize(sizeUdp))) {
+			return sl_false;
+		}
 		if (!(checkChecksum(ip))) {
 			return sl_false;
 		}
@@ -30,8 +30,7 @@ namespace slib
 	void WebController::registerHandler(HttpMethod method, const String& path, const WebHandler& handler)
 	{
 		if (handler.isNotNull()) {
-			String sig = _getHandlerSignature(method, path);
-			m_handlers.put(sig, handler);
+			m_router.add(method, path, handler);
 		}
 	}
 
@@ -39,10 +38,16 @@ namespace slib
 	{
 		HttpMethod method = context->getMethod();
 		String path = context->getPath();
-		String sig = _getHandlerSignature(method, path);
-		WebHandler handler;
-		if (m_handlers.get(sig, &handler)) {
-			Variant ret(handler(context, method, path));
+		WebRouterMatch match;
+		if (m_router.match(method, path, match)) {
+			if (match.countParams) {
+				String* names = match.names.getData();
+				for (sl_uint32 i = 0; i < match.countParams; i++) {
+					sl_size start = match.params[i].start;
+					context->setPathParameter(names[i], path.substring(start, start + match.params[i].length));
+				}
+			}
+			Variant ret(match.handler(context, method, path));
 			if (ret.isNotNull()) {
 				if (ret.isObject()) {
 					Ref<Referable> obj = ret.getObject();
@@ -64,11 +69,6 @@ namespace slib
 		return sl_false;
 	}
 
-	String WebController::_getHandlerSignature(HttpMethod method, const String& path)
-	{
-		return HttpMethods::toString(method) + " " + path;
-	}
-
 
 	WebModule::WebModule(const String& path)
 	: m_path(path)
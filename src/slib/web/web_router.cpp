@@ -0,0 +1,444 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "slib/web/router.h"
+
+#define PRIV_WEB_ROUTER_METHODS_COUNT ((sl_uint32)(HttpMethod::TRACE) + 1)
+
+namespace slib
+{
+
+	class _priv_WebRouter_Route
+	{
+	public:
+		WebHandler handler;
+		List<String> names;
+	};
+
+	class _priv_WebRouter_Node
+	{
+	public:
+		// static part of the path (compressed)
+		String segment;
+		List<_priv_WebRouter_Node*> children;
+		// `:name`
+		_priv_WebRouter_Node* param;
+		// `*name`
+		_priv_WebRouter_Node* wildcard;
+		// indexed by HttpMethod, allocated only on terminal nodes
+		_priv_WebRouter_Route* routes;
+
+	public:
+		_priv_WebRouter_Node()
+		{
+			param = sl_null;
+			wildcard = sl_null;
+			routes = sl_null;
+		}
+
+		~_priv_WebRouter_Node()
+		{
+			ListElements<_priv_WebRouter_Node*> list(children);
+			for (sl_size i = 0; i < list.count; i++) {
+				delete list[i];
+			}
+			if (param) {
+				delete param;
+			}
+			if (wildcard) {
+				delete wildcard;
+			}
+			if (routes) {
+				delete[] routes;
+			}
+		}
+
+	public:
+		_priv_WebRouter_Node* insertStatic(const sl_char8* s, sl_size n)
+		{
+			_priv_WebRouter_Node* node = this;
+			while (n) {
+				_priv_WebRouter_Node** list = node->children.getData();
+				sl_size count = node->children.getCount();
+				_priv_WebRouter_Node* child = sl_null;
+				sl_size index = 0;
+				for (sl_size i = 0; i < count; i++) {
+					if (list[i]->segment.getData()[0] == s[0]) {
+						child = list[i];
+						index = i;
+						break;
+					}
+				}
+				if (!child) {
+					child = new _priv_WebRouter_Node;
+					child->segment = String(s, n);
+					node->children.add_NoLock(child);
+					return child;
+				}
+				const sl_char8* seg = child->segment.getData();
+				sl_size lenSeg = child->segment.getLength();
+				sl_size l = 0;
+				while (l < lenSeg && l < n && seg[l] == s[l]) {
+					l++;
+				}
+				if (l < lenSeg) {
+					// split the child at the common prefix
+					_priv_WebRouter_Node* mid = new _priv_WebRouter_Node;
+					mid->segment = String(seg, l);
+					String rest(seg + l, lenSeg - l);
+					child->segment = rest;
+					mid->children.add_NoLock(child);
+					list[index] = mid;
+					child = mid;
+				}
+				node = child;
+				s += l;
+				n -= l;
+			}
+			return node;
+		}
+
+	};
+
+	// the tree flattened into arrays (children are contiguous), for cache-friendly matching
+	class _priv_WebRouter_Table
+	{
+	public:
+		struct Node
+		{
+			sl_uint32 children; // index of first child
+			sl_uint16 countChildren;
+			sl_uint16 lenSegment;
+			sl_uint32 param; // 0: none
+			sl_uint32 wildcard; // 0: none
+			sl_uint32 routes; // 0: none
+			sl_uint32 segment; // offset in `chars`
+			// first bytes of the segment, to avoid touching `chars` for most of the nodes
+			sl_char8 prefix[8];
+		};
+		List<Node> nodes;
+		Memory chars;
+		List<const _priv_WebRouter_Route*> routes;
+
+	public:
+		static _priv_WebRouter_Table* compile(_priv_WebRouter_Node* root)
+		{
+			_priv_WebRouter_Table* table = new _priv_WebRouter_Table;
+			List<_priv_WebRouter_Node*> order;
+			List<Node> nodes;
+			List<const _priv_WebRouter_Route*> routes;
+			sl_size lenChars = 0;
+			Node empty;
+			Base::zeroMemory(&empty, sizeof(empty));
+			order.add_NoLock(root);
+			nodes.add_NoLock(empty);
+			routes.add_NoLock(sl_null);
+			sl_size i;
+			for (i = 0; i < order.getCount(); i++) {
+				_priv_WebRouter_Node* node = order.getData()[i];
+				Node c = empty;
+				sl_size lenSegment = node->segment.getLength();
+				ListElements<_priv_WebRouter_Node*> children(node->children);
+				if (lenSegment > 0xffff || children.count > 0xffff) {
+					delete table;
+					return sl_null;
+				}
+				c.segment = (sl_uint32)lenChars;
+				c.lenSegment = (sl_uint16)lenSegment;
+				Base::copyMemory(c.prefix, node->segment.getData(), SLIB_MIN(lenSegment, sizeof(c.prefix)));
+				lenChars += lenSegment;
+				c.children = (sl_uint32)(order.getCount());
+				c.countChildren = (sl_uint16)(children.count);
+				for (sl_size k = 0; k < children.count; k++) {
+					order.add_NoLock(children[k]);
+					nodes.add_NoLock(empty);
+				}
+				if (node->param) {
+					c.param = (sl_uint32)(order.getCount());
+					order.add_NoLock(node->param);
+					nodes.add_NoLock(empty);
+				}
+				if (node->wildcard) {
+					c.wildcard = (sl_uint32)(order.getCount());
+					order.add_NoLock(node->wildcard);
+					nodes.add_NoLock(empty);
+				}
+				if (node->routes) {
+					c.routes = (sl_uint32)(routes.getCount());
+					routes.add_NoLock(node->routes);
+				}
+				nodes.getData()[i] = c;
+			}
+			Memory chars = Memory::create(lenChars + 1);
+			if (chars.isNull()) {
+				delete table;
+				return sl_null;
+			}
+			sl_char8* p = (sl_char8*)(chars.getData());
+			for (i = 0; i < order.getCount(); i++) {
+				String& segment = order.getData()[i]->segment;
+				Base::copyMemory(p, segment.getData(), segment.getLength());
+				p += segment.getLength();
+			}
+			table->nodes = nodes;
+			table->chars = chars;
+			table->routes = routes;
+			return table;
+		}
+
+	public:
+		const _priv_WebRouter_Route* getRoute(const Node& node, sl_uint32 method) const
+		{
+			if (node.routes) {
+				const _priv_WebRouter_Route* list = routes.getData()[node.routes];
+				if (list[method].handler.isNotNull()) {
+					return list + method;
+				}
+				// HttpMethod::Unknown: any method
+				if (list[0].handler.isNotNull()) {
+					return list;
+				}
+			}
+			return sl_null;
+		}
+
+		SLIB_INLINE sl_bool _equalsSegment(const Node& node, const sl_char8* path, sl_size len) const
+		{
+			if (len <= sizeof(node.prefix)) {
+				return Base::equalsMemory(node.prefix, path, len);
+			}
+			return Base::equalsMemory(node.prefix, path, sizeof(node.prefix)) && Base::equalsMemory((const sl_char8*)(chars.getData()) + node.segment + sizeof(node.prefix), path + sizeof(node.prefix), len - sizeof(node.prefix));
+		}
+
+		static sl_bool matchRoute(const _priv_WebRouter_Route* route, WebRouterMatch& result)
+		{
+			if (route) {
+				result.handler = route->handler;
+				if (result.countParams) {
+					result.names = route->names;
+				}
+				return sl_true;
+			}
+			return sl_false;
+		}
+
+		sl_bool matchWildcard(const Node& node, sl_uint32 method, sl_size start, sl_size length, WebRouterMatch& result) const
+		{
+			if (node.wildcard && result.countParams < SLIB_WEB_ROUTER_MAX_PARAMS) {
+				sl_uint32 index = result.countParams;
+				result.params[index].start = start;
+				result.params[index].length = length;
+				result.countParams = index + 1;
+				if (matchRoute(getRoute(nodes.getData()[node.wildcard], method), result)) {
+					return sl_true;
+				}
+				result.countParams = index;
+			}
+			return sl_false;
+		}
+
+		sl_bool match(const Node& node, sl_uint32 method, const sl_char8* base, const sl_char8* path, sl_size len, WebRouterMatch& result) const
+		{
+			if (!len) {
+				if (matchRoute(getRoute(node, method), result)) {
+					return sl_true;
+				}
+				return matchWildcard(node, method, path - base, 0, result);
+			}
+			const Node* list = nodes.getData();
+			// static parts
+			{
+				const Node* child = list + node.children;
+				const Node* end = child + node.countChildren;
+				sl_char8 c = path[0];
+				for (; child < end; child++) {
+					if (child->prefix[0] == c) {
+						sl_size lenSeg = child->lenSegment;
+						if (lenSeg <= len && _equalsSegment(*child, path, lenSeg)) {
+							if (match(*child, method, base, path + lenSeg, len - lenSeg, result)) {
+								return sl_true;
+							}
+						}
+						break;
+					}
+				}
+			}
+			// `:name`
+			if (node.param && result.countParams < SLIB_WEB_ROUTER_MAX_PARAMS) {
+				sl_size n = 0;
+				while (n < len && path[n] != '/') {
+					n++;
+				}
+				if (n) {
+					sl_uint32 index = result.countParams;
+					result.params[index].start = path - base;
+					result.params[index].length = n;
+					result.countParams = index + 1;
+					if (match(list[node.param], method, base, path + n, len - n, result)) {
+						return sl_true;
+					}
+					result.countParams = index;
+				}
+			}
+			// `*name`
+			return matchWildcard(node, method, path - base, len, result);
+		}
+
+	};
+
+
+	WebRouterMatch::WebRouterMatch()
+	{
+		countParams = 0;
+	}
+
+	WebRouterMatch::~WebRouterMatch()
+	{
+	}
+
+
+	WebRouter::WebRouter()
+	{
+		m_root = new _priv_WebRouter_Node;
+		m_table = sl_null;
+	}
+
+	WebRouter::~WebRouter()
+	{
+		if (m_table) {
+			delete m_table;
+		}
+		delete m_root;
+	}
+
+	sl_bool WebRouter::add(HttpMethod _method, const String& pattern, const WebHandler& handler)
+	{
+		sl_uint32 method = (sl_uint32)_method;
+		if (handler.isNull() || method >= PRIV_WEB_ROUTER_METHODS_COUNT) {
+			return sl_false;
+		}
+		const sl_char8* s = pattern.getData();
+		sl_size n = pattern.getLength();
+		List<String> names;
+		WriteLocker lock(&m_lock);
+		if (m_table) {
+			delete m_table;
+			m_table = sl_null;
+		}
+		_priv_WebRouter_Node* node = m_root;
+		sl_size i = 0;
+		while (i < n) {
+			sl_char8 c = s[i];
+			if (c == ':' || c == '*') {
+				sl_size start = i + 1;
+				sl_size end = n;
+				if (c == ':') {
+					end = start;
+					while (end < n && s[end] != '/') {
+						end++;
+					}
+				}
+				if (names.getCount() >= SLIB_WEB_ROUTER_MAX_PARAMS) {
+					return sl_false;
+				}
+				names.add_NoLock(String(s + start, end - start));
+				if (c == ':') {
+					if (!(node->param)) {
+						node->param = new _priv_WebRouter_Node;
+					}
+					node = node->param;
+				} else {
+					if (!(node->wildcard)) {
+						node->wildcard = new _priv_WebRouter_Node;
+					}
+					node = node->wildcard;
+				}
+				i = end;
+			} else {
+				sl_size end = i;
+				sl_size nEscapes = 0;
+				while (end < n && s[end] != ':' && s[end] != '*') {
+					if (s[end] == '\\' && end + 1 < n) {
+						end++;
+						nEscapes++;
+					}
+					end++;
+				}
+				if (nEscapes) {
+					// `\:`, `\*` and `\\` are the literal characters
+					String segment = String::allocate(end - i - nEscapes);
+					if (segment.isNull()) {
+						return sl_false;
+					}
+					sl_char8* d = segment.getData();
+					for (sl_size k = i; k < end; k++) {
+						if (s[k] == '\\' && k + 1 < end) {
+							k++;
+						}
+						*(d++) = s[k];
+					}
+					node = node->insertStatic(segment.getData(), segment.getLength());
+				} else {
+					node = node->insertStatic(s + i, end - i);
+				}
+				i = end;
+			}
+		}
+		if (!(node->routes)) {
+			node->routes = new _priv_WebRouter_Route[PRIV_WEB_ROUTER_METHODS_COUNT];
+		}
+		_priv_WebRouter_Route& route = node->routes[method];
+		route.handler = handler;
+		route.names = names;
+		return sl_true;
+	}
+
+	sl_bool WebRouter::match(HttpMethod method, const String& path, WebRouterMatch& result) const
+	{
+		return match(method, path.getData(), path.getLength(), result);
+	}
+
+	sl_bool WebRouter::match(HttpMethod _method, const sl_char8* path, sl_size lenPath, WebRouterMatch& result) const
+	{
+		sl_uint32 method = (sl_uint32)_method;
+		if (method >= PRIV_WEB_ROUTER_METHODS_COUNT) {
+			method = 0;
+		}
+		result.countParams = 0;
+		ReadLocker lock(&m_lock);
+		while (!m_table) {
+			lock.unlock();
+			{
+				WriteLocker lockWrite(&m_lock);
+				if (!m_table) {
+					WebRouter* self = (WebRouter*)this;
+					self->m_table = _priv_WebRouter_Table::compile(m_root);
+					if (!m_table) {
+						return sl_false;
+					}
+				}
+			}
+			lock.lock(&m_lock);
+		}
+		return m_table->match(m_table->nodes.getData()[0], method, path, path, lenPath, result);
+	}
+
+	void WebRouter::removeAll()
+	{
+		WriteLocker lock(&m_lock);
+		if (m_table) {
+			delete m_table;
+			m_table = sl_null;
+		}
+		delete m_root;
+		m_root = new _priv_WebRouter_Node;
+	}
+
+}